@@ -391,6 +391,7 @@ extern "C" {
 #define FIX_DDL                 1 // Fix deadlock issues
 #define MIN_PIC_PARALLELIZATION 0 // Use the minimum amount of picture parallelization
 #define  SRM_REPORT             0 // Report SRM status
+#define SRM_LOCK_FREE           1 // Use lock-free ring queues in the system resource manager (0: mutex + semaphore muxing queues)
 #define  LAD_MG_PRINT             0 // Report LAD
 #define RC_NO_R2R               0 // This is a debugging flag for RC and makes encoder to run with no R2R in RC mode
                                   // Note that the speed might impacted significantly
@@ -113,7 +113,9 @@ typedef struct EbSvtAv1DecConfiguration {
     uint32_t threads;
 
     /* Number of frames that can be processed
-       in parallel. Default is 1 */
+       in parallel. Default is 1, maximum is 8. When greater than 1, the
+       pictures are output with a delay of up to num_p_frames - 1 calls
+       and the decoding threads value is ignored */
     uint32_t num_p_frames;
 
     // Application Specific parameters
@@ -165,6 +167,9 @@ EB_API EbErrorType svt_av1_dec_init(EbComponentType *svt_dec_component);
      * @ *data                  Buffer with data
      * @ data_size              Data size in bytes
      *
+     * Call with a NULL data and a data_size of 0 at the end of the stream
+     * to get the remaining pictures.
+     *
      *  Returns EB_ErrorNone if the coded data has been processed successfully. */
 EB_API EbErrorType svt_av1_dec_frame(EbComponentType *svt_dec_component, const uint8_t *data,
                                      const size_t data_size, uint32_t is_annexb);
@@ -99,6 +99,24 @@ typedef enum {
     // 2. call this when you got EB_BUFFERFLAG_EOS
     SVT_AV1_STREAM_INFO_FIRST_PASS_STATS_OUT = SVT_AV1_STREAM_INFO_START,
 
+    // The output is SvtAv1StageBalanceStats*
+    // Can be called at any time after svt_av1_enc_init, stage_count is 0
+    // when EbSvtAv1EncConfiguration.stage_balancing is off
+    SVT_AV1_STREAM_INFO_STAGE_BALANCE,
+
+    // The output is SvtAv1InputLayout*
+    // Can be called at any time after svt_av1_enc_init
+    SVT_AV1_STREAM_INFO_INPUT_LAYOUT,
+
+    // The output is SvtAv1MemoryReport*
+    // Can be called at any time after svt_av1_enc_set_parameter
+    SVT_AV1_STREAM_INFO_MEMORY_REPORT,
+
+    // The output is SvtAv1MemoryUsage*
+    // Can be called at any time after svt_av1_enc_init_handle, returns
+    // EB_ErrorBadParameter when the library is built with ENABLE_MEMORY_TRACKING=OFF
+    SVT_AV1_STREAM_INFO_MEMORY_USAGE,
+
     SVT_AV1_STREAM_INFO_END,
 } SVT_AV1_STREAM_INFO_ID;
 
@@ -111,6 +129,226 @@ typedef struct SvtAv1FixedBuf {
     uint64_t sz; /**< Length of the buffer, in chars */
 } SvtAv1FixedBuf; /**< alias for struct aom_fixed_buf */
 
+#define SVT_AV1_MAX_BALANCED_STAGES 16
+
+/*!\brief Worker distribution of one pipeline stage under stage balancing
+ *
+ * queue_depth and idle_workers are averaged over the last balancing window.
+ */
+typedef struct SvtAv1StageBalance {
+    const char *name; /**< Name of the stage, e.g. "enc_dec" */
+    uint32_t    max_workers; /**< Threads created for the stage */
+    uint32_t    active_workers; /**< Threads currently allowed to take work */
+    double      queue_depth; /**< Objects waiting in the input queue */
+    double      idle_workers; /**< Active threads waiting for input */
+    uint64_t    raise_count; /**< Times the stage was given a worker */
+    uint64_t    lower_count; /**< Times the stage gave a worker away */
+} SvtAv1StageBalance;
+
+typedef struct SvtAv1StageBalanceStats {
+    uint32_t           worker_budget; /**< Active threads allowed over all stages */
+    uint32_t           stage_count; /**< Valid entries of stages */
+    uint64_t           window_count; /**< Balancing windows evaluated so far */
+    SvtAv1StageBalance stages[SVT_AV1_MAX_BALANCED_STAGES];
+} SvtAv1StageBalanceStats;
+
+/*!\brief Encoder pipeline stages, in pipeline order */
+typedef enum SvtAv1PipelineStage {
+    SVT_AV1_STAGE_RESOURCE_COORDINATION,
+    SVT_AV1_STAGE_PICTURE_ANALYSIS,
+    SVT_AV1_STAGE_PICTURE_DECISION,
+    SVT_AV1_STAGE_MOTION_ESTIMATION,
+    SVT_AV1_STAGE_INITIAL_RATE_CONTROL,
+    SVT_AV1_STAGE_SOURCE_BASED_OPERATIONS,
+    SVT_AV1_STAGE_TPL_DISPENSER,
+    SVT_AV1_STAGE_PICTURE_MANAGER,
+    SVT_AV1_STAGE_INLOOP_ME,
+    SVT_AV1_STAGE_RATE_CONTROL,
+    SVT_AV1_STAGE_MODE_DECISION_CONFIGURATION,
+    SVT_AV1_STAGE_ENC_DEC,
+    SVT_AV1_STAGE_DLF,
+    SVT_AV1_STAGE_CDEF,
+    SVT_AV1_STAGE_RESTORATION,
+    SVT_AV1_STAGE_ENTROPY_CODING,
+    SVT_AV1_STAGE_PACKETIZATION,
+    SVT_AV1_STAGE_COUNT
+} SvtAv1PipelineStage;
+
+/*!\brief Counters of one pipeline stage, summed over its threads
+ *
+ * Times are in microseconds.
+ */
+typedef struct SvtAv1StageStats {
+    const char *name; /**< Name of the stage, e.g. "enc_dec" */
+    uint32_t    thread_count; /**< Consumers of the stage input queue, 0 if the stage is not built */
+    uint64_t    items; /**< Objects taken from the input queue */
+    uint64_t    busy_us; /**< Time spent processing the objects */
+    uint64_t    input_wait_us; /**< Time blocked in svt_get_full_object */
+    uint64_t    output_wait_us; /**< Time blocked in svt_get_empty_object */
+    uint32_t    queue_depth; /**< Objects currently waiting in the input queue */
+    uint32_t    max_queue_depth; /**< Most objects that waited in the input queue */
+} SvtAv1StageStats;
+
+/*!\brief Time at which each stage started on a picture
+ *
+ * stage_us[i] is in microseconds since svt_av1_enc_init, 0 if stage i did
+ * not process the picture. done_us is when packetization finished the picture.
+ */
+typedef struct SvtAv1PictureTiming {
+    uint64_t picture_number;
+    uint64_t stage_us[SVT_AV1_STAGE_COUNT];
+    uint64_t done_us;
+} SvtAv1PictureTiming;
+
+#define SVT_AV1_PICTURE_TIMING_HISTORY 64
+
+typedef struct SvtAv1PipelineStats {
+    uint64_t            elapsed_us; /**< Time since svt_av1_enc_init */
+    SvtAv1StageStats    stages[SVT_AV1_STAGE_COUNT];
+    uint32_t            picture_count; /**< Valid entries of pictures, oldest first */
+    SvtAv1PictureTiming pictures[SVT_AV1_PICTURE_TIMING_HISTORY];
+} SvtAv1PipelineStats;
+
+/*!\brief Speed control decision for one picture
+ *
+ * With EbSvtAv1EncConfiguration.speed_control_flag every output packet
+ * carries one in its metadata, as an entry of type
+ * EB_AV1_METADATA_TYPE_SPEED_CONTROL. Costs are the motion estimation and
+ * mode decision work on the picture in microseconds, summed over the threads.
+ */
+typedef struct SvtAv1SpeedControlInfo {
+    uint64_t picture_number;
+    int8_t   enc_mode; /**< Preset the picture was encoded with */
+    uint8_t  temporal_layer; /**< Temporal layer of the picture */
+    uint8_t  is_intra; /**< The picture is an intra picture */
+    uint32_t predicted_cost_us; /**< Cost predicted for enc_mode when it was picked */
+    uint32_t measured_cost_us; /**< Cost measured on the picture */
+    uint32_t work_scale_x1000; /**< Work allowed per picture relative to the configured preset, x1000 */
+    uint32_t output_fps_x1000; /**< Smoothed output frame rate when the preset was picked, x1000 */
+} SvtAv1SpeedControlInfo;
+
+/*!\brief Plane layout of the library input pictures
+ *
+ * With EbSvtAv1EncConfiguration.zero_copy_input the planes passed in
+ * EbSvtIOFormat must use this layout: luma points left_padding samples
+ * into a row of y_stride bytes and top_padding rows into an allocation of
+ * luma_size bytes, cb and cr likewise with the padding divided by the
+ * chroma subsampling and allocations of chroma_size bytes. Sizes are in
+ * 8-bit samples.
+ */
+typedef struct SvtAv1InputLayout {
+    uint32_t width; /**< Picture width the planes must hold, multiple of 8 */
+    uint32_t height; /**< Picture height the planes must hold, multiple of 8 */
+    uint32_t y_stride;
+    uint32_t cb_stride;
+    uint32_t cr_stride;
+    uint32_t left_padding;
+    uint32_t right_padding;
+    uint32_t top_padding;
+    uint32_t bot_padding;
+    uint32_t luma_size; /**< Bytes of the padded luma plane */
+    uint32_t chroma_size; /**< Bytes of each padded chroma plane */
+} SvtAv1InputLayout;
+
+/*!\brief Pictures of a pool and the estimated bytes of each */
+typedef struct SvtAv1PoolAllocation {
+    uint32_t count;
+    uint64_t picture_size;
+} SvtAv1PoolAllocation;
+
+/*!\brief Memory the encoder sized its pools for
+ *
+ * Sizes are estimates of the allocations of the library, they do not
+ * include the application or the code of the library. estimated_mb is the
+ * sum of the pools and fixed_size, the most the encoder should allocate;
+ * allocated_mb is what svt_av1_enc_init actually allocated.
+ */
+typedef struct SvtAv1MemoryReport {
+    uint32_t             memory_budget_mb; /**< 0 when no budget is set */
+    uint32_t             estimated_mb;
+    uint32_t             allocated_mb; /**< 0 before svt_av1_enc_init or without memory tracking */
+    uint32_t             look_ahead_mini_gops; /**< Mini-GOPs of look ahead, also the TPL window */
+    uint32_t             future_pictures; /**< Pictures held for scene change and temporal filtering */
+    SvtAv1PoolAllocation input;
+    SvtAv1PoolAllocation parent_pcs;
+    SvtAv1PoolAllocation me;
+    SvtAv1PoolAllocation pa_reference;
+    SvtAv1PoolAllocation reference;
+    SvtAv1PoolAllocation overlay;
+    SvtAv1PoolAllocation child_pcs; /**< Child control sets with their recon and coefficients */
+    uint64_t             fixed_size; /**< Process contexts and other allocations */
+} SvtAv1MemoryReport;
+
+/*!\brief Subsystems the allocations of the library are accounted to */
+typedef enum SvtAv1MemoryTag {
+    SVT_AV1_MEM_TAG_OTHER = 0, /**< Everything not listed below */
+    SVT_AV1_MEM_TAG_PICTURE, /**< Picture buffers: input, references, recon */
+    SVT_AV1_MEM_TAG_PCS, /**< Picture control sets, without their pictures */
+    SVT_AV1_MEM_TAG_MD, /**< Mode decision contexts */
+    SVT_AV1_MEM_TAG_ME, /**< Motion estimation contexts */
+    SVT_AV1_MEM_TAG_NEIGHBOR, /**< Neighbour arrays */
+    SVT_AV1_MEM_TAG_BITSTREAM, /**< Output bitstream buffers */
+    SVT_AV1_MEM_TAG_COUNT,
+} SvtAv1MemoryTag;
+
+/*!\brief Bytes allocated by the encoder library, per subsystem
+ *
+ * The counters cover all the encoder instances of the process. peak_bytes[]
+ * are the highest live_bytes[] of each tag seen at the end of
+ * svt_av1_enc_init, at each coded picture and at each query, peak_total the
+ * highest sum of them, so it can be lower than the sum of peak_bytes[].
+ * Allocations of the mutexes, semaphores and threads are not counted.
+ */
+typedef struct SvtAv1MemoryUsage {
+    uint64_t live_bytes[SVT_AV1_MEM_TAG_COUNT];
+    uint64_t peak_bytes[SVT_AV1_MEM_TAG_COUNT];
+    uint64_t live_total;
+    uint64_t peak_total;
+} SvtAv1MemoryUsage;
+
+/*!\brief Fields of SvtAv1EncUpdate to apply, or-ed in its flags */
+typedef enum SvtAv1EncUpdateFlag {
+    SVT_AV1_UPDATE_TARGET_BIT_RATE = 1 << 0,
+    SVT_AV1_UPDATE_QP_RANGE        = 1 << 1, /**< max_qp_allowed and min_qp_allowed */
+    SVT_AV1_UPDATE_ENC_MODE        = 1 << 2,
+    SVT_AV1_UPDATE_KEY_FRAME       = 1 << 3, /**< Code picture_number as a key frame */
+} SvtAv1EncUpdateFlag;
+
+/*!\brief Change of the configuration while encoding, see
+ * svt_av1_enc_update_parameters
+ *
+ * The change applies from the input picture picture_number, counted from 0
+ * in the order the pictures are sent. The forced key frame is that very
+ * picture; the other fields take effect with the first mini-GOP starting
+ * at or after it, so a mini-GOP is never coded with two configurations.
+ * In rate control mode 3, a target bitrate more than 1.5 times or less than
+ * half the previous one restarts the VBV buffer at its optimal level.
+ */
+typedef struct SvtAv1EncUpdate {
+    uint64_t picture_number;
+    uint32_t flags; /**< SvtAv1EncUpdateFlag of the fields set */
+    uint32_t target_bit_rate; /**< Bits per second, used by rate control modes 1 and 3 */
+    uint32_t max_qp_allowed; /**< [min_qp_allowed - 63] */
+    uint32_t min_qp_allowed; /**< [0 - max_qp_allowed], below 63 */
+    int8_t   enc_mode; /**< Not slower than the preset the encoder was initialized with */
+} SvtAv1EncUpdate;
+
+#define SVT_AV1_MAX_PENDING_UPDATES 64
+
+/**
+ * Called by the library once it no longer references the planes of an
+ * input picture sent with zero_copy_input, from a library thread.
+ * p_app_private and pts are the ones of the EbBufferHeaderType passed to
+ * svt_av1_enc_send_picture.
+ */
+typedef void (*SvtAv1InputReleaseCb)(void *release_ctx, void *p_app_private, int64_t pts);
+
+/**
+ * Process-wide pool of worker threads shared by several encoder handles,
+ * see svt_av1_executor_create. Opaque to the application.
+ */
+typedef struct SvtAv1Executor SvtAv1Executor;
+
 // Will contain the EbEncApi which will live in the EncHandle class
 // Only modifiable during config-time.
 typedef struct EbSvtAv1EncConfiguration {
@@ -163,6 +401,11 @@ typedef struct EbSvtAv1EncConfiguration {
      * In Random Access structure, the B/b pictures can refer to reference pictures
      * from both directions (past and future).
      *
+     * Low Delay disables TPL, temporal filtering and overlays. Without a
+     * first pass window (CQP), each picture goes through the pipeline as it
+     * comes: its packet is out before the next picture is needed, and the
+     * stream can end on an empty packet that only carries the EOS flag.
+     *
      * Default is 2. */
     uint8_t pred_structure;
 
@@ -505,6 +748,7 @@ typedef struct EbSvtAv1EncConfiguration {
      * 0 = Constant QP.
      * 1 = Variable Bit Rate, achieve the target bitrate at entire stream.
      * 2 = Constrained Variable Bit Rate, achieve the target bitrate at each gop
+     * 3 = Constant Bit Rate, keep the VBV buffer from overflowing at each picture
      * Default is 0. */
     uint32_t rate_control_mode;
     /* Flag to enable the scene change detection algorithm.
@@ -530,7 +774,12 @@ typedef struct EbSvtAv1EncConfiguration {
      * Default is 7000000. */
     uint32_t target_bit_rate;
 
-    /* VBV Buffer size */
+    /* VBV buffer size in bits, the unit of target_bit_rate per second. Only
+     * applicable when rate control mode is set to 3: the picture sizes and
+     * QPs are capped by the bits left in the buffer, and pictures that would
+     * overflow it are coded at the maximum QP.
+     *
+     * Default is 0, one second of the target bitrate. */
     uint32_t vbv_bufsize;
 
     /* Maxium QP value allowed for rate control use, only applicable when rate
@@ -642,6 +891,11 @@ typedef struct EbSvtAv1EncConfiguration {
     * the average speed defined in injectorFrameRate. When this parameter is set
     * to 1 it forces -inj to be 1 -inj-frm-rt to be set to the -fps.
     *
+    * A closed loop controller measures the work of each picture, and picks the
+    * preset of each picture, never slower than enc_mode, to hold the output
+    * frame rate within 5% of injector_frame_rate. Each output packet reports the
+    * decision in its metadata, see SvtAv1SpeedControlInfo.
+    *
     * Default is 0. */
     uint32_t speed_control_flag;
 
@@ -683,6 +937,116 @@ typedef struct EbSvtAv1EncConfiguration {
      * Default is -1. */
     int32_t target_socket;
 
+    /* Thread model of the multi-instance pipeline stages (picture analysis,
+     * motion estimation, TPL dispenser, in-loop ME, mode decision configuration,
+     * EncDec, deblocking, CDEF, restoration and entropy coding).
+     *
+     * 0 = one dedicated thread per stage process.
+     * 1 = the stages run as jobs on one work-stealing pool of logical_processors
+     *     workers, shared by all the stages.
+     *
+     * Default is 0. */
+    uint32_t task_scheduler;
+
+    /* Moves the dedicated threads of the multi-instance pipeline stages to
+     * the bottleneck stage at run time. The input queue occupancy and idle
+     * consumers of every stage are sampled, and threads are parked or
+     * unparked so that at most logical_processors of them take work. The
+     * decisions are reported by SVT_AV1_STREAM_INFO_STAGE_BALANCE. Ignored
+     * when task_scheduler is 1.
+     *
+     * 0 = the stage threads always take work.
+     * 1 = balance the stage threads.
+     *
+     * Default is 0. */
+    uint32_t stage_balancing;
+
+    /* NUMA placement for multi-socket systems, Linux only. The picture
+     * pools are interleaved over the nodes, the contexts of every stage
+     * thread are allocated on its node, and thread i of a multi-instance
+     * stage with n threads runs on node i * nodes / n. The single-instance
+     * stages run on the first node. Cannot be combined with target_socket.
+     *
+     * 0 = no placement, memory is placed on first touch.
+     * 1 = place threads and memory on the NUMA nodes.
+     *
+     * Default is 0. */
+    uint32_t numa_aware;
+
+    /* Shared executor created by svt_av1_executor_create, or NULL. The
+     * multi-instance pipeline stages of every handle attached to the
+     * executor run on its workers, so the thread count of the process
+     * stays bounded with the number of handles; task_scheduler is implied.
+     * The single-instance stages and source based operations keep their
+     * dedicated threads. The executor must outlive the handle.
+     * svt_av1_enc_init fails with EB_ErrorInsufficientResources once the
+     * attached handles use up the spare workers of the executor, one per
+     * stage context.
+     *
+     * Default is NULL, the handle owns its threads. */
+    SvtAv1Executor *executor;
+
+    /* Share of the executor workers given to this handle relative to the
+     * other attached handles while they all have work queued, [1-100].
+     * Ignored without executor.
+     *
+     * Default is 1. */
+    uint32_t executor_weight;
+
+    /* Reference the input planes of svt_av1_enc_send_picture instead of
+     * copying them into the library pictures. The planes must be laid out
+     * as reported by SVT_AV1_STREAM_INFO_INPUT_LAYOUT and stay untouched
+     * until input_release_cb is called for the picture: the library pads
+     * them in place and temporal filtering overwrites the luma and chroma
+     * of the filtered pictures. Only 8-bit input is referenced, 10-bit
+     * input is always copied.
+     *
+     * 0 = copy the input pictures.
+     * 1 = reference the input pictures.
+     *
+     * Default is 0. */
+    uint32_t zero_copy_input;
+
+    /* Called when a referenced input picture is released, required with
+     * zero_copy_input. input_release_ctx is passed back unchanged.
+     *
+     * Default is NULL. */
+    SvtAv1InputReleaseCb input_release_cb;
+    void *               input_release_ctx;
+
+    /* Construct the input, reference and down-scaled picture pools with
+     * the pictures of the first mini-GOP and add pictures when a pool runs
+     * empty, up to the size otherwise allocated at init. The pools do not
+     * shrink: the pictures added stay allocated until svt_av1_enc_deinit.
+     *
+     * 0 = allocate the whole pools in svt_av1_enc_init.
+     * 1 = grow the pools on demand.
+     *
+     * Default is 0. */
+    uint32_t elastic_pools;
+
+    /* Upper bound in MB of the memory the encoder allocates. The look
+     * ahead mini-GOPs, the future pictures of temporal filtering and the
+     * picture pools are reduced in this order to fit, and
+     * svt_av1_enc_set_parameter fails with EB_ErrorInsufficientResources
+     * when even the smallest pools do not fit. The sizes are estimates:
+     * with memory tracking, svt_av1_enc_init also fails with
+     * EB_ErrorInsufficientResources when what it allocated is over the
+     * budget. Both are reported by SVT_AV1_STREAM_INFO_MEMORY_REPORT.
+     *
+     * Default is 0, no budget. */
+    uint32_t memory_budget_mb;
+
+    /* Page backing of the picture buffers, on Linux. Large pages cut the
+     * TLB misses of the motion search and the prediction reads, which
+     * walk the reference planes in 2D.
+     *
+     * 0 = regular pages,
+     * 1 = 2 MiB aligned planes advised as transparent huge pages,
+     * 2 = MAP_HUGETLB planes from the reserved huge pages, 1 when none is free.
+     * Default is 0. */
+    uint32_t large_pages;
+
     // Debug tools
 
     /* Output reconstructed yuv used for debug purposes. The value is set through
@@ -690,6 +1054,14 @@ typedef struct EbSvtAv1EncConfiguration {
      *
      * Default is 0. */
     uint32_t recon_enabled;
+    /* Path of a Chrome trace-event JSON file, written by svt_av1_enc_deinit,
+     * with one event per pipeline stage invocation: thread, begin and end
+     * time, picture number and segment index. The file loads in Perfetto
+     * and chrome://tracing. The string must stay valid until
+     * svt_av1_enc_deinit.
+     *
+     * Default is NULL, no tracing. */
+    const char *trace_file;
     /* Log 2 Tile Rows and colums . 0 means no tiling,1 means that we split the dimension
         * into 2
         * Default is 0. */
@@ -794,6 +1166,23 @@ typedef struct EbSvtAv1EncConfiguration {
     uint8_t color_range;
 } EbSvtAv1EncConfiguration;
 
+/* OPTIONAL: Create an executor to share between encoder handles through
+     * EbSvtAv1EncConfiguration.executor.
+     *
+     * Parameter:
+     * @ **executor_ptr  Returned executor.
+     * @ thread_count    Worker threads, 0 for one per logical processor. More
+     *                   threads are started while workers wait on blocked
+     *                   pipeline stages. */
+EB_API EbErrorType svt_av1_executor_create(SvtAv1Executor **executor_ptr, uint32_t thread_count);
+
+/* OPTIONAL: Destroy an executor. Fails with EB_ErrorBadParameter while
+     * handles are attached, i.e. before their svt_av1_enc_deinit_handle.
+     *
+     * Parameter:
+     * @ *executor  Executor from svt_av1_executor_create. */
+EB_API EbErrorType svt_av1_executor_destroy(SvtAv1Executor *executor);
+
 /* STEP 1: Call the library to construct a Component Handle.
      *
      * Parameter:
@@ -863,6 +1252,8 @@ EB_API EbErrorType svt_av1_enc_get_packet(EbComponentType *    svt_enc_component
                                           EbBufferHeaderType **p_buffer, uint8_t pic_send_done);
 
 /* STEP 5-1: Release output buffer back into the pool.
+     * The packet and its p_buffer belong to the pools of the encoder, every packet
+     * must be released before svt_av1_enc_deinit.
      *
      * Parameter:
      * @ **p_buffer          Header pointer that contains the output packet to be released. */
@@ -885,6 +1276,46 @@ EB_API EbErrorType svt_av1_get_recon(EbComponentType *   svt_enc_component,
 EB_API EbErrorType svt_av1_enc_get_stream_info(EbComponentType *svt_enc_component,
                                                uint32_t stream_info_id, void *info);
 
+/* OPTIONAL: get the pipeline telemetry: per stage counters and the stage
+     * timestamps of the last SVT_AV1_PICTURE_TIMING_HISTORY output pictures.
+     * Can be called at any time between svt_av1_enc_init and
+     * svt_av1_enc_deinit, from any thread.
+     *
+     * Parameter:
+     * @ *svt_enc_component  Encoder handler.
+     * @ *stats              output. */
+EB_API EbErrorType svt_av1_enc_get_pipeline_stats(EbComponentType *    svt_enc_component,
+                                                  SvtAv1PipelineStats *stats);
+
+/* OPTIONAL: Change the target bitrate, the QP range or the preset, or force
+     * a key frame, while encoding. Can be called at any time between
+     * svt_av1_enc_init and svt_av1_enc_deinit, from any thread. Updates for
+     * the same picture merge, the last one sent wins for each field.
+     * Returns EB_ErrorBadParameter for a field out of range and
+     * EB_ErrorInsufficientResources when SVT_AV1_MAX_PENDING_UPDATES are
+     * already waiting for their picture.
+     *
+     * Parameter:
+     * @ *svt_enc_component  Encoder handler.
+     * @ *update             Fields to change and the picture they apply from. */
+EB_API EbErrorType svt_av1_enc_update_parameters(EbComponentType *      svt_enc_component,
+                                                 const SvtAv1EncUpdate *update);
+
+/* OPTIONAL: Get the encoder ready for a new stream once the packet with
+     * EB_BUFFERFLAG_EOS was received, keeping its threads and buffers. The
+     * stream starts over as after svt_av1_enc_init: picture numbers from 0, a
+     * key frame with a sequence header, the rate control and the
+     * configuration set by svt_av1_enc_set_parameter, without the updates.
+     * Waits for the encoder to release the last pictures, recon pictures not
+     * retrieved are dropped. Returns EB_ErrorBadParameter before the end of
+     * sequence packet, and EB_ErrorUndefined when the pictures are not
+     * released within 10 seconds; no new stream can start then, only another
+     * svt_av1_enc_reset.
+     *
+     * Parameter:
+     * @ *svt_enc_component  Encoder handler. */
+EB_API EbErrorType svt_av1_enc_reset(EbComponentType *svt_enc_component);
+
 /* STEP 6: Deinitialize encoder library.
      *
      * Parameter:
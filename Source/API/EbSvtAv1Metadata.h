@@ -29,6 +29,8 @@ typedef enum EbAv1MetadataType {
     EB_AV1_METADATA_TYPE_SCALABILITY    = 3,
     EB_AV1_METADATA_TYPE_ITUT_T35       = 4,
     EB_AV1_METADATA_TYPE_TIMECODE       = 5,
+    // Library reports on the output packets, never written to the bitstream
+    EB_AV1_METADATA_TYPE_SPEED_CONTROL = 0x10000, // SvtAv1SpeedControlInfo
 } EbAv1MetadataType;
 
 /*!\brief Metadata payload. */
@@ -16,6 +16,7 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <inttypes.h>
+#include <string.h>
 
 #include "EbSvtAv1Dec.h"
 #include "EbDecParamParser.h"
@@ -60,15 +61,15 @@ int init_pic_buffer(EbSvtIOFormat *pic_buffer, CliInput *cli, EbSvtAv1DecConfigu
     return 0;
 }
 
-int read_input_frame(DecInputContext *input, uint8_t **buffer, size_t *bytes_read,
-                     size_t *buffer_size, int64_t *pts) {
+int read_input_frame(DecInputContext *input, const uint8_t **frame, size_t *frame_size,
+                     int64_t *pts) {
     CliInput *cli = input->cli_ctx;
     switch (cli->in_file_type) {
     case FILE_TYPE_IVF:
-        return read_ivf_frame(cli->in_file, buffer, bytes_read, buffer_size, pts);
+        return read_ivf_frame(input->stream, frame, frame_size, pts);
         break;
     case FILE_TYPE_OBU:
-        return obudec_read_temporal_unit(input, buffer, bytes_read, buffer_size);
+        return obudec_read_temporal_unit(input, frame, frame_size);
         break;
     default: fprintf(stderr, "Unsupported Bitstream type. \n"); return 0;
     }
@@ -147,10 +148,13 @@ int32_t main(int32_t argc, char *argv[]) {
     cli.width       = 0;
     cli.height      = 0;
 
-    DecInputContext    input   = {NULL, NULL};
+    DecInputContext    input   = {NULL, NULL, NULL};
     ObuDecInputContext obu_ctx = {NULL, 0, 0, 0, 0};
-    input.cli_ctx              = &cli;
-    input.obu_ctx              = &obu_ctx;
+    DecInputStream     stream;
+    memset(&stream, 0, sizeof(stream));
+    input.cli_ctx = &cli;
+    input.obu_ctx = &obu_ctx;
+    input.stream  = &stream;
 
     uint64_t stop_after = 0;
     uint32_t in_frame   = 0;
@@ -163,8 +167,8 @@ int32_t main(int32_t argc, char *argv[]) {
     int               fps_frm     = 0;
     int               fps_summary = 0;
 
-    uint8_t *buf             = NULL;
-    size_t   bytes_in_buffer = 0, buffer_size = 0;
+    const uint8_t *buf             = NULL;
+    size_t         bytes_in_buffer = 0;
 
     // Initialize config
     if (!config_ptr)
@@ -208,7 +212,10 @@ int32_t main(int32_t argc, char *argv[]) {
         ((EbSvtIOFormat *)recon_buffer->p_buffer)->cb   = (uint8_t *)malloc(size >> 2);
         ((EbSvtIOFormat *)recon_buffer->p_buffer)->cr   = (uint8_t *)malloc(size >> 2);
 
-        if (!init_pic_buffer((EbSvtIOFormat *)recon_buffer->p_buffer, &cli, config_ptr)) {
+        if (dec_input_open(&input) != 0) {
+            fprintf(stderr, "Failed to open the input bitstream. \n");
+            return_error = EB_ErrorInsufficientResources;
+        } else if (!init_pic_buffer((EbSvtIOFormat *)recon_buffer->p_buffer, &cli, config_ptr)) {
             fprintf(stderr, "Decoding \n");
             EbAV1StreamInfo *stream_info = (EbAV1StreamInfo *)malloc(sizeof(EbAV1StreamInfo));
             EbAV1FrameInfo * frame_info  = (EbAV1FrameInfo *)malloc(sizeof(EbAV1FrameInfo));
@@ -217,7 +224,7 @@ int32_t main(int32_t argc, char *argv[]) {
                 fprintf(stderr, "Skipping first %" PRIu64 " frames.\n", config_ptr->skip_frames);
             uint64_t skip_frame = config_ptr->skip_frames;
             while (skip_frame) {
-                if (!read_input_frame(&input, &buf, &bytes_in_buffer, &buffer_size, NULL))
+                if (!read_input_frame(&input, &buf, &bytes_in_buffer, NULL))
                     break;
                 skip_frame--;
             }
@@ -225,7 +232,7 @@ int32_t main(int32_t argc, char *argv[]) {
             if (enable_md5)
                 md5_init(&md5_ctx);
             // Input Loop Thread
-            while (read_input_frame(&input, &buf, &bytes_in_buffer, &buffer_size, NULL)) {
+            while (read_input_frame(&input, &buf, &bytes_in_buffer, NULL)) {
                 if (!stop_after || in_frame < stop_after) {
                     dec_timer_start(&timer);
 
@@ -250,6 +257,15 @@ int32_t main(int32_t argc, char *argv[]) {
                 } else
                     break;
             }
+            /* Flush the pictures still in flight (frame parallel decoding) */
+            svt_av1_dec_frame(p_handle, NULL, 0, obu_ctx.is_annexb);
+            while (svt_av1_dec_get_picture(p_handle, recon_buffer, stream_info, frame_info) !=
+                   EB_DecNoOutputPicture) {
+                if (enable_md5)
+                    write_md5(recon_buffer, &md5_ctx);
+                if (cli.out_file != NULL)
+                    write_frame(recon_buffer, &cli);
+            }
             if (fps_summary || fps_frm) {
                 assert(dx_time > 0);
                 show_progress(in_frame, dx_time);
@@ -273,12 +289,13 @@ int32_t main(int32_t argc, char *argv[]) {
 
         free(recon_buffer->p_buffer);
         free(recon_buffer);
-        free(buf);
     } else
         fprintf(stderr, "Error in configuration. \n");
     return_error |= svt_av1_dec_deinit_handle(p_handle);
 
 fail:
+    dec_input_close(&input);
+    free(obu_ctx.buffer);
     if (cli.in_file)
         fclose(cli.in_file);
     if (cli.out_file)
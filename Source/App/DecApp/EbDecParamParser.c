@@ -58,11 +58,12 @@ static void set_num_thread(const char *value, EbSvtAv1DecConfiguration *cfg) {
 };
 static void set_num_pframes(const char *value, EbSvtAv1DecConfiguration *cfg) {
     cfg->num_p_frames = strtoul(value, NULL, 0);
-    if (cfg->num_p_frames != 1) {
-        fprintf(
-            stderr,
-            "Warning : Multi frame parallelism not supported. Setting parallel frames to 1. \n");
+    if (cfg->num_p_frames < 1) {
+        fprintf(stderr, "Warning : Setting parallel frames to 1. \n");
         cfg->num_p_frames = 1;
+    } else if (cfg->num_p_frames > 8) {
+        fprintf(stderr, "Warning : At most 8 frames in parallel. Setting parallel frames to 8. \n");
+        cfg->num_p_frames = 8;
     }
 };
 
@@ -97,7 +98,7 @@ static void show_help() {
     H0(" -h <arg>                  Input picture height \n");
     H0(" -colour-space <arg>       Input picture colour space. [400, 420, 422, 444]\n");
     H0(" -threads <arg>            Number of threads to be launched \n");
-    H0(" -parallel-frames <arg>    Number of frames to be processed in parallel \n");
+    H0(" -parallel-frames <arg>    Number of frames to be processed in parallel. [1 - 8] \n");
     H0(" -md5                      MD5 support flag \n");
     H0(" -fps-frm                  Show fps after each frame decoded\n");
     H0(" -fps-summary              Show fps summary");
@@ -13,6 +13,14 @@
 #include <stddef.h>
 #include <string.h>
 #include <assert.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#define ftello _ftelli64
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 #include "EbFileUtils.h"
 
@@ -431,194 +439,144 @@ int file_is_obu(CliInput *cli, ObuDecInputContext *obu_ctx) {
     return 1;
 }
 
-static int obudec_grow_buffer(size_t growth_amount, uint8_t **obu_buffer,
-                              size_t *obu_buffer_capacity) {
-    if (!*obu_buffer || !obu_buffer_capacity || growth_amount == 0) {
-        return -1;
-    }
+// Makes at least 'bytes' bytes available from the stream position, returns 1
+// when they are. A mapped file holds them all, a read buffer is compacted and
+// refilled in chunks of INPUT_READ_CHUNK_SIZE bytes.
+static int stream_fill(DecInputStream *stream, size_t bytes) {
+    if (stream->size - stream->position >= bytes)
+        return 1;
+    if (!stream->buffer)
+        return 0;
 
-    const size_t capacity = *obu_buffer_capacity;
-    if (SIZE_MAX - growth_amount < capacity) {
-        fprintf(stderr, "obudec: cannot grow buffer, capacity will roll over.\n");
-        return -1;
+    const size_t kept = stream->size - stream->position;
+    memmove(stream->buffer, stream->buffer + stream->position, kept);
+    stream->size     = kept;
+    stream->position = 0;
+    if (bytes > stream->buffer_capacity) {
+        const size_t capacity   = DECAPP_MAX(bytes, 2 * stream->buffer_capacity);
+        uint8_t *    new_buffer = (uint8_t *)realloc(stream->buffer, capacity);
+        if (!new_buffer) {
+            fprintf(stderr, "Failed to allocate compressed data buffer. \n");
+            return 0;
+        }
+        stream->buffer          = new_buffer;
+        stream->buffer_capacity = capacity;
     }
+    stream->data = stream->buffer;
 
-    const size_t new_capacity = capacity + growth_amount;
-
-    uint8_t *new_buffer = (uint8_t *)realloc(*obu_buffer, new_capacity);
-    if (!new_buffer) {
-        fprintf(stderr, "obudec: Failed to allocate compressed data buffer.\n");
-        return -1;
+    while (stream->size < bytes && !feof(stream->file) && !ferror(stream->file)) {
+        const size_t chunk = DECAPP_MIN(DECAPP_MAX(bytes - stream->size, INPUT_READ_CHUNK_SIZE),
+                                        stream->buffer_capacity - stream->size);
+        stream->size += fread(stream->buffer + stream->size, 1, chunk, stream->file);
     }
-
-    *obu_buffer          = new_buffer;
-    *obu_buffer_capacity = new_capacity;
-    return 0;
+    return stream->size >= bytes;
 }
 
-static int obudec_read_one_obu(FILE *f, uint8_t **obu_buffer, size_t obu_bytes_buffered,
-                               size_t *obu_buffer_capacity, size_t *obu_length,
-                               ObuHeader *obu_header, uint32_t is_annexb) {
-    if (!f || !(*obu_buffer) || !obu_buffer_capacity || !obu_length || !obu_header) {
-        return -1;
-    }
-
-    size_t bytes_read                = 0;
-    size_t obu_payload_length        = 0;
-    size_t available_buffer_capacity = *obu_buffer_capacity - obu_bytes_buffered;
-
-    if (available_buffer_capacity < OBU_MAX_HEADER_SIZE) {
-        if (obudec_grow_buffer(DECAPP_MAX(*obu_buffer_capacity, OBU_MAX_HEADER_SIZE),
-                               obu_buffer,
-                               obu_buffer_capacity) != 0) {
-            *obu_length = bytes_read;
-            return -1;
-        }
-        available_buffer_capacity += DECAPP_MAX(*obu_buffer_capacity, OBU_MAX_HEADER_SIZE);
-    }
-
-    const int status = obudec_read_obu_header_and_size(f,
-                                                       available_buffer_capacity,
-                                                       is_annexb,
-                                                       *obu_buffer + obu_bytes_buffered,
-                                                       &bytes_read,
-                                                       &obu_payload_length,
-                                                       obu_header);
-    if (status < 0)
-        return status;
-
-    if (obu_payload_length > SIZE_MAX - bytes_read)
+// Sizes the OBU at data without reading past 'available' bytes. Returns 0 on
+// success with the whole OBU size in 'obu_size'.
+static int obudec_obu_size(const uint8_t *data, size_t available, uint32_t is_annexb,
+                           ObuHeader *obu_header, uint64_t *obu_size) {
+    size_t   header_size  = 0;
+    size_t   length_size  = 0;
+    uint64_t payload_size = 0;
+    if (svt_read_obu_header((uint8_t *)data, available, &header_size, obu_header, is_annexb) !=
+            0 ||
+        uleb_decode(data + header_size, available - header_size, &payload_size, &length_size) !=
+            0)
         return -1;
-
-    if (obu_payload_length > 256 * 1024 * 1024) {
-        fprintf(stderr, "obudec: Read invalid OBU size (%u)\n", (unsigned int)obu_payload_length);
-        *obu_length = bytes_read + obu_payload_length;
-        return -1;
-    }
-
-    if (bytes_read + obu_payload_length > available_buffer_capacity &&
-        obudec_grow_buffer(DECAPP_MAX(*obu_buffer_capacity, obu_payload_length),
-                           obu_buffer,
-                           obu_buffer_capacity) != 0) {
-        *obu_length = bytes_read + obu_payload_length;
+    if (payload_size > 256 * 1024 * 1024) {
+        fprintf(stderr, "obudec: Read invalid OBU size (%u)\n", (unsigned int)payload_size);
         return -1;
     }
-
-    if (obu_payload_length > 0 &&
-        obudec_read_obu_payload(
-            f, obu_payload_length, *obu_buffer + obu_bytes_buffered + bytes_read, &bytes_read) !=
-            0) {
-        return -1;
-    }
-
-    *obu_length = bytes_read;
+    *obu_size = header_size + length_size + payload_size;
     return 0;
 }
 
-int obudec_read_temporal_unit(DecInputContext *input, uint8_t **buffer, size_t *bytes_read,
-                              size_t *buffer_size) {
-    CliInput *          cli     = input->cli_ctx;
-    FILE *              f       = cli->in_file;
+// Annex B : the frame units are handed out one by one, the temporal unit
+// size is only read to know where the next one starts.
+static int obudec_read_frame_unit(DecInputContext *input, const uint8_t **fu, size_t *fu_size) {
+    DecInputStream *    stream  = input->stream;
     ObuDecInputContext *obu_ctx = input->obu_ctx;
-    if (!f)
-        return 0;
+    uint64_t            size    = 0;
+    size_t              length  = 0;
 
-    *buffer_size = 0;
-    *bytes_read  = 0;
+    if (!obu_ctx->rem_txb_size) {
+        stream_fill(stream, OBU_MAX_LENGTH_FIELD_SIZE);
+        if (stream->position == stream->size)
+            return 0;
+        if (uleb_decode(stream->data + stream->position,
+                        stream->size - stream->position,
+                        &size,
+                        &length) != 0) {
+            fprintf(stderr, "obudec: Failure reading temporal unit header\n");
+            return 0;
+        }
+        stream->position += length;
+        /*Stores only tu size ie excluding tu header*/
+        obu_ctx->rem_txb_size = size;
+    }
 
-    if (feof(f)) {
+    stream_fill(stream, OBU_MAX_LENGTH_FIELD_SIZE);
+    if (uleb_decode(stream->data + stream->position,
+                    stream->size - stream->position,
+                    &size,
+                    &length) != 0) {
+        fprintf(stderr, "obudec: Failure reading frame header\n");
+        return 0;
+    }
+    if (size == 0 || size + length > obu_ctx->rem_txb_size)
+        return 0;
+    if (!stream_fill(stream, length + (size_t)size)) {
+        fprintf(stderr, "obudec: Failed to read full temporal unit\n");
         return 0;
     }
 
-    size_t txb_size = 0, fr_size = 0;
-    size_t obu_size                     = 0;
-    size_t length_of_temporal_unit_size = 0;
-    size_t length_of_frame_unit_size    = 0;
-
-    if (obu_ctx->is_annexb) {
-        uint64_t size                                = 0;
-        uint8_t  frheader[OBU_MAX_LENGTH_FIELD_SIZE] = {0};
+    *fu      = stream->data + stream->position + length;
+    *fu_size = (size_t)size;
+    stream->position += length + (size_t)size;
+    obu_ctx->rem_txb_size -= size + length;
+    return 1;
+}
 
-        assert(obu_ctx->bytes_buffered == 0);
+int obudec_read_temporal_unit(DecInputContext *input, const uint8_t **tu, size_t *tu_size) {
+    DecInputStream *stream = input->stream;
 
-        if (!obu_ctx->rem_txb_size) {
-            if (obudec_read_leb128(f, &frheader[0], &length_of_temporal_unit_size, &size) != 0) {
-                fprintf(stderr, "obudec: Failure reading temporal unit header\n");
-                return 0;
-            }
-            if (size == 0 && feof(f)) {
-                return 0;
-            }
-            /*Stores only tu size ie excluding tu header*/
-            obu_ctx->rem_txb_size = size;
-        }
+    *tu_size = 0;
+    if (input->obu_ctx->is_annexb)
+        return obudec_read_frame_unit(input, tu, tu_size);
 
-        if (size > UINT32_MAX || size + length_of_temporal_unit_size > UINT32_MAX) {
-            fprintf(stderr, "obudec: TU too large.\n");
-            return 0;
-        }
+    // Section 5 : the temporal unit runs to the next temporal delimiter
+    size_t size = 0;
+    while (1) {
+        // the last OBUs of the stream may be shorter than a header
+        stream_fill(stream, size + OBU_MAX_HEADER_SIZE);
+        const size_t available = stream->size - stream->position - size;
+        if (!available)
+            break;
 
-        if (obudec_read_leb128(f, &frheader[0], &length_of_frame_unit_size, &size) != 0) {
-            fprintf(stderr, "obudec: Failure reading frame header\n");
+        ObuHeader obu_header;
+        uint64_t  obu_size = 0;
+        memset(&obu_header, 0, sizeof(obu_header));
+        if (obudec_obu_size(
+                stream->data + stream->position + size, available, 0, &obu_header, &obu_size) !=
+            0) {
+            fprintf(stderr, "obudec: read_one_obu failed in TU loop\n");
             return 0;
         }
-        if (size == 0 || feof(f)) {
+        if (size && obu_header.type == OBU_TEMPORAL_DELIMITER)
+            break;
+        if (!stream_fill(stream, size + (size_t)obu_size)) {
+            fprintf(stderr, "obudec: Failure reading OBU payload.\n");
             return 0;
         }
-
-        fr_size  = (size_t)size;
-        txb_size = fr_size;
-    } else {
-        while (1) {
-            ObuHeader obu_header;
-            memset(&obu_header, 0, sizeof(obu_header));
-
-            if (obudec_read_one_obu(f,
-                                    &obu_ctx->buffer,
-                                    obu_ctx->bytes_buffered,
-                                    &obu_ctx->buffer_capacity,
-                                    &obu_size,
-                                    &obu_header,
-                                    0) != 0) {
-                fprintf(stderr, "obudec: read_one_obu failed in TU loop\n");
-                return 0;
-            }
-
-            if (obu_header.type == OBU_TEMPORAL_DELIMITER || obu_size == 0) {
-                txb_size = obu_ctx->bytes_buffered;
-                break;
-            } else {
-                obu_ctx->bytes_buffered += obu_size;
-            }
-        }
+        size += (size_t)obu_size;
     }
-
-    uint8_t *new_buffer = (uint8_t *)realloc(*buffer, txb_size);
-    if (!new_buffer) {
-        free(*buffer);
-        fprintf(stderr, "obudec: Out of memory.\n");
+    if (!size)
         return 0;
-    }
-    *buffer      = new_buffer;
-    *bytes_read  = txb_size;
-    *buffer_size = txb_size;
-
-    if (!obu_ctx->is_annexb) {
-        memcpy(*buffer, obu_ctx->buffer, txb_size);
 
-        // At this point, (obu_ctx->buffer + obu_ctx->bytes_buffered + obu_size)
-        // points to the end of the buffer.
-        memmove(obu_ctx->buffer, obu_ctx->buffer + obu_ctx->bytes_buffered, obu_size);
-        obu_ctx->bytes_buffered = obu_size;
-    } else {
-        if (!feof(f)) {
-            if (fread(*buffer, 1, fr_size, f) != fr_size) {
-                fprintf(stderr, "obudec: Failed to read full temporal unit\n");
-                return 0;
-            }
-            obu_ctx->rem_txb_size -= (fr_size + length_of_frame_unit_size);
-        }
-    }
+    *tu      = stream->data + stream->position;
+    *tu_size = size;
+    stream->position += size;
     return 1;
 }
 
@@ -653,47 +611,114 @@ int file_is_ivf(CliInput *cli) {
     return is_ivf;
 }
 
-int read_ivf_frame(FILE *infile, uint8_t **buffer, size_t *bytes_read, size_t *buffer_size,
+int read_ivf_frame(DecInputStream *stream, const uint8_t **frame, size_t *frame_size,
                    int64_t *pts) {
-    char   raw_header[IVF_FRAME_HDR_SZ] = {0};
-    size_t frame_size                   = 0;
-
-    if (fread(raw_header, IVF_FRAME_HDR_SZ, 1, infile) != 1) {
-        if (!feof(infile))
+    if (!stream_fill(stream, IVF_FRAME_HDR_SZ)) {
+        if (stream->position != stream->size)
             fprintf(stderr, "Failed to read frame size. \n");
-    } else {
-        frame_size = mem_get_le32(raw_header);
-
-        if (frame_size > 256 * 1024 * 1024) {
-            fprintf(stderr, "Read invalid frame size (%u) \n", (unsigned int)frame_size);
-            frame_size = 0;
-        }
+        return 0;
+    }
 
-        if (frame_size > *buffer_size) {
-            uint8_t *new_buffer = (uint8_t *)realloc(*buffer, 2 * frame_size);
+    size_t size = mem_get_le32(stream->data + stream->position);
+    if (size > 256 * 1024 * 1024) {
+        fprintf(stderr, "Read invalid frame size (%u) \n", (unsigned int)size);
+        return 0;
+    }
+    if (!stream_fill(stream, IVF_FRAME_HDR_SZ + size)) {
+        fprintf(stderr, "Failed to read full frame. \n");
+        return 0;
+    }
 
-            if (new_buffer) {
-                *buffer      = new_buffer;
-                *buffer_size = 2 * frame_size;
-            } else {
-                fprintf(stderr, "Failed to allocate compressed data buffer. \n");
-                frame_size = 0;
-            }
-        }
+    const uint8_t *raw_header = stream->data + stream->position;
+    if (pts) {
+        *pts = mem_get_le32(&raw_header[4]);
+        *pts += ((int64_t)mem_get_le32(&raw_header[8]) << 32);
+    }
+    *frame      = raw_header + IVF_FRAME_HDR_SZ;
+    *frame_size = size;
+    stream->position += IVF_FRAME_HDR_SZ + size;
+    return 1;
+}
 
-        if (pts) {
-            *pts = mem_get_le32(&raw_header[4]);
-            *pts += ((int64_t)mem_get_le32(&raw_header[8]) << 32);
-        }
+// Maps the whole of a regular file, returns 0 when it cannot be mapped
+static int map_input_file(DecInputStream *stream) {
+#ifdef _WIN32
+    HANDLE        file = (HANDLE)_get_osfhandle(_fileno(stream->file));
+    LARGE_INTEGER size;
+    if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &size) ||
+        !size.QuadPart || (uint64_t)size.QuadPart > (size_t)-1)
+        return 0;
+    stream->mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!stream->mapping)
+        return 0;
+    stream->data = (const uint8_t *)MapViewOfFile(stream->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!stream->data) {
+        CloseHandle(stream->mapping);
+        return 0;
     }
+    stream->size = (size_t)size.QuadPart;
+#else
+    struct stat statbuf;
+    if (fstat(fileno(stream->file), &statbuf) || !S_ISREG(statbuf.st_mode) ||
+        !statbuf.st_size || (uint64_t)statbuf.st_size > (size_t)-1)
+        return 0;
+    void *map = mmap(
+        NULL, (size_t)statbuf.st_size, PROT_READ, MAP_PRIVATE, fileno(stream->file), 0);
+    if (map == MAP_FAILED)
+        return 0;
+    madvise(map, (size_t)statbuf.st_size, MADV_SEQUENTIAL);
+    stream->data = (const uint8_t *)map;
+    stream->size = (size_t)statbuf.st_size;
+#endif
+    return 1;
+}
 
-    if (!feof(infile)) {
-        if (fread(*buffer, 1, frame_size, infile) != frame_size) {
-            fprintf(stderr, "Failed to read full frame. \n");
-            return 0;
-        }
-        *bytes_read = frame_size;
-        return 1;
+int dec_input_open(DecInputContext *input) {
+    DecInputStream *    stream  = input->stream;
+    ObuDecInputContext *obu_ctx = input->obu_ctx;
+
+    // The detection read the file up to its first frame, keeping the first
+    // OBU of a Section 5 stream in obu_ctx->buffer
+    stream->file         = input->cli_ctx->in_file;
+    const int64_t offset = ftello(stream->file);
+    if (offset >= (int64_t)obu_ctx->bytes_buffered && map_input_file(stream)) {
+        stream->position = (size_t)offset - obu_ctx->bytes_buffered;
+        if (stream->position > stream->size)
+            return -1;
+    } else {
+        stream->buffer_capacity = DECAPP_MAX(INPUT_READ_CHUNK_SIZE, obu_ctx->bytes_buffered);
+        stream->buffer          = (uint8_t *)malloc(stream->buffer_capacity);
+        if (!stream->buffer)
+            return -1;
+        if (obu_ctx->bytes_buffered)
+            memcpy(stream->buffer, obu_ctx->buffer, obu_ctx->bytes_buffered);
+        stream->data     = stream->buffer;
+        stream->size     = obu_ctx->bytes_buffered;
+        stream->position = 0;
     }
+
+    free(obu_ctx->buffer);
+    obu_ctx->buffer          = NULL;
+    obu_ctx->buffer_capacity = 0;
+    obu_ctx->bytes_buffered  = 0;
     return 0;
 }
+
+void dec_input_close(DecInputContext *input) {
+    DecInputStream *stream = input->stream;
+    if (!stream)
+        return;
+    if (stream->buffer)
+        free(stream->buffer);
+    else if (stream->data) {
+#ifdef _WIN32
+        UnmapViewOfFile(stream->data);
+        CloseHandle(stream->mapping);
+#else
+        munmap((void *)stream->data, stream->size);
+#endif
+    }
+    stream->buffer = NULL;
+    stream->data   = NULL;
+}
+
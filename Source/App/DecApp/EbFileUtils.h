@@ -28,6 +28,9 @@
 
 #define IVF_FRAME_HDR_SZ (4 + 8) /* 4 byte size + 8 byte timestamp */
 
+/* Bytes read at once from an input that cannot be mapped */
+#define INPUT_READ_CHUNK_SIZE (4 * 1024 * 1024)
+
 #define DECAPP_MIN(x, y) (((x) < (y)) ? (x) : (y))
 #define DECAPP_MAX(x, y) (((x) > (y)) ? (x) : (y))
 
@@ -77,9 +80,25 @@ typedef struct ObuDecInputContext {
     uint64_t rem_txb_size;
 } ObuDecInputContext;
 
+/* Window over the input bitstream : the whole file when it can be mapped,
+ * else a buffer refilled in large chunks (pipes). Frames and temporal units
+ * are handed out as pointers into it, valid until the next read. */
+typedef struct DecInputStream {
+    FILE *         file;
+    const uint8_t *data;
+    size_t         size; // bytes in data
+    size_t         position; // of the next frame in data
+    uint8_t *      buffer; // NULL when the file is mapped
+    size_t         buffer_capacity;
+#ifdef _WIN32
+    void *mapping;
+#endif
+} DecInputStream;
+
 typedef struct DecInputContext {
     CliInput *          cli_ctx;
     ObuDecInputContext *obu_ctx;
+    DecInputStream *    stream;
 } DecInputContext;
 
 /*!\brief OBU types. */
@@ -108,11 +127,15 @@ typedef struct {
 } ObuHeader;
 
 int file_is_obu(CliInput *cli, ObuDecInputContext *obu_ctx);
-int obudec_read_temporal_unit(DecInputContext *input, uint8_t **buffer, size_t *bytes_read,
-                              size_t *buffer_size);
+int obudec_read_temporal_unit(DecInputContext *input, const uint8_t **tu, size_t *tu_size);
 
 int file_is_ivf(CliInput *cli);
-int read_ivf_frame(FILE *infile, uint8_t **buffer, size_t *bytes_read, size_t *buffer_size,
+int read_ivf_frame(DecInputStream *stream, const uint8_t **frame, size_t *frame_size,
                    int64_t *pts);
 
+/* Opens input->stream on the detected file, at its first frame. Returns 0 on
+ * success. */
+int  dec_input_open(DecInputContext *input);
+void dec_input_close(DecInputContext *input);
+
 #endif
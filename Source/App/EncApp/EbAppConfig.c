@@ -17,6 +17,8 @@
 #include "EbAppConfig.h"
 #include "EbAppContext.h"
 #include "EbAppInputy4m.h"
+#include "EbAppInputReader.h"
+#include "EbAppOutputWriter.h"
 #ifdef _WIN32
 #include <windows.h>
 #include <io.h>
@@ -51,11 +53,15 @@
 #define INPUT_STAT_FILE_TOKEN "-input-stat-file"
 #define OUTPUT_STAT_FILE_TOKEN "-output-stat-file"
 #define STAT_FILE_TOKEN "-stat-file"
+#define TRACE_FILE_TOKEN "-trace-file"
 #define INPUT_PREDSTRUCT_FILE_TOKEN "-pred-struct-file"
 #define WIDTH_TOKEN "-w"
 #define HEIGHT_TOKEN "-h"
 #define NUMBER_OF_PICTURES_TOKEN "-n"
 #define BUFFERED_INPUT_TOKEN "-nb"
+#define INPUT_READER_TOKEN "-input-reader"
+#define INPUT_BENCHMARK_TOKEN "-input-benchmark"
+#define ASYNC_WRITER_TOKEN "-async-writer"
 #define NO_PROGRESS_TOKEN "--no-progress" // tbd if it should be removed
 #define PROGRESS_TOKEN "--progress"
 #define BASE_LAYER_SWITCH_MODE_TOKEN "-base-layer-switch-mode" // no Eval
@@ -167,6 +173,14 @@
 #define THREAD_MGMNT "-lp"
 #define UNPIN_TOKEN "-unpin"
 #define TARGET_SOCKET "-ss"
+#define TASK_SCHEDULER_TOKEN "-task-scheduler"
+#define STAGE_BALANCING_TOKEN "-stage-balancing"
+#define NUMA_TOKEN "-numa"
+#define EXECUTOR_THREADS_TOKEN "-executor-threads"
+#define EXECUTOR_WEIGHT_TOKEN "-executor-weight"
+#define ELASTIC_POOLS_TOKEN "-elastic-pools"
+#define MEMORY_BUDGET_TOKEN "-memory-budget"
+#define LARGE_PAGES_TOKEN "-large-pages"
 #define UNRESTRICTED_MOTION_VECTOR "-umv"
 #define CONFIG_FILE_COMMENT_CHAR '#'
 #define CONFIG_FILE_NEWLINE_CHAR '\n'
@@ -339,6 +353,15 @@ static void set_cfg_qp_file(const char *value, EbConfig *cfg) {
     FOPEN(cfg->qp_file, value, "r");
 };
 
+static void set_cfg_trace_file(const char *value, EbConfig *cfg) {
+    free((void *)cfg->config.trace_file);
+#ifndef _WIN32
+    cfg->config.trace_file = strdup(value);
+#else
+    cfg->config.trace_file = _strdup(value);
+#endif
+}
+
 static void set_pass(const char *value, EbConfig *cfg) { cfg->pass = strtol(value, NULL, 0); }
 
 static void set_two_pass_stats(const char *value, EbConfig *cfg) {
@@ -377,6 +400,15 @@ static void set_cfg_frames_to_be_encoded(const char *value, EbConfig *cfg) {
 static void set_buffered_input(const char *value, EbConfig *cfg) {
     cfg->buffered_input = strtol(value, NULL, 0);
 };
+static void set_input_reader(const char *value, EbConfig *cfg) {
+    cfg->input_reader_mode = (uint32_t)strtoul(value, NULL, 0);
+};
+static void set_input_benchmark(const char *value, EbConfig *cfg) {
+    cfg->input_benchmark = (EbBool)strtoul(value, NULL, 0);
+};
+static void set_async_writer(const char *value, EbConfig *cfg) {
+    cfg->async_writer = (uint32_t)strtoul(value, NULL, 0);
+};
 static void set_no_progress(const char *value, EbConfig *cfg) {
     switch (value ? *value : '1') {
     case '0': cfg->progress = 1; break; // equal to --progress 1
@@ -784,6 +816,30 @@ static void set_unpin_execution(const char *value, EbConfig *cfg) {
 static void set_target_socket(const char *value, EbConfig *cfg) {
     cfg->config.target_socket = (int32_t)strtol(value, NULL, 0);
 };
+static void set_task_scheduler(const char *value, EbConfig *cfg) {
+    cfg->config.task_scheduler = (uint32_t)strtoul(value, NULL, 0);
+};
+static void set_stage_balancing(const char *value, EbConfig *cfg) {
+    cfg->config.stage_balancing = (uint32_t)strtoul(value, NULL, 0);
+};
+static void set_numa_aware(const char *value, EbConfig *cfg) {
+    cfg->config.numa_aware = (uint32_t)strtoul(value, NULL, 0);
+};
+static void set_executor_threads(const char *value, EbConfig *cfg) {
+    cfg->executor_threads = (uint32_t)strtoul(value, NULL, 0);
+};
+static void set_executor_weight(const char *value, EbConfig *cfg) {
+    cfg->config.executor_weight = (uint32_t)strtoul(value, NULL, 0);
+};
+static void set_elastic_pools(const char *value, EbConfig *cfg) {
+    cfg->config.elastic_pools = (uint32_t)strtoul(value, NULL, 0);
+};
+static void set_memory_budget(const char *value, EbConfig *cfg) {
+    cfg->config.memory_budget_mb = (uint32_t)strtoul(value, NULL, 0);
+};
+static void set_large_pages(const char *value, EbConfig *cfg) {
+    cfg->config.large_pages = (uint32_t)strtoul(value, NULL, 0);
+};
 static void set_unrestricted_motion_vector(const char *value, EbConfig *cfg) {
     cfg->config.unrestricted_motion_vector = (EbBool)strtol(value, NULL, 0);
 };
@@ -832,6 +888,10 @@ ConfigEntry config_entry_options[] = {
     {SINGLE_INPUT, OUTPUT_RECON_LONG_TOKEN, "Recon filename", set_cfg_recon_file},
 
     {SINGLE_INPUT, STAT_FILE_TOKEN, "Stat filename", set_cfg_stat_file},
+    {SINGLE_INPUT,
+     TRACE_FILE_TOKEN,
+     "Pipeline trace filename, Chrome trace-event JSON written at the end of the encode",
+     set_cfg_trace_file},
     {SINGLE_INPUT, NULL, NULL, NULL}};
 
 ConfigEntry config_entry_global_options[] = {
@@ -852,6 +912,20 @@ ConfigEntry config_entry_global_options[] = {
      set_cfg_frames_to_be_encoded},
 
     {SINGLE_INPUT, BUFFERED_INPUT_TOKEN, "Buffer n input frames", set_buffered_input},
+    {SINGLE_INPUT,
+     INPUT_READER_TOKEN,
+     "Input reader (0: fread of each frame, 1: map regular files and read pipes ahead, 2: read "
+     "ahead on a thread) [0-2]",
+     set_input_reader},
+    {SINGLE_INPUT,
+     INPUT_BENCHMARK_TOKEN,
+     "Only read the input frames and report the input throughput [0-1]",
+     set_input_benchmark},
+    {SINGLE_INPUT,
+     ASYNC_WRITER_TOKEN,
+     "Write the bitstream and the recon on a thread with up to n outputs queued, 0 writes them "
+     "inline [0-1024]",
+     set_async_writer},
     {SINGLE_INPUT,
      PROGRESS_TOKEN,
      "Change verbosity of the output (0: no progress is printed, 1: default, 2: aomenc style "
@@ -926,6 +1000,46 @@ ConfigEntry config_entry_global_options[] = {
      "Specify  which socket the encoder runs on"
      "--unpin is overwritten to 0 when --ss is set to 0 or 1",
      set_target_socket},
+    {SINGLE_INPUT,
+     TASK_SCHEDULER_TOKEN,
+     "Run the multi-instance pipeline stages as jobs on one work-stealing pool of --lp workers "
+     "instead of dedicated threads per stage (0: OFF [default], 1: ON)",
+     set_task_scheduler},
+    {SINGLE_INPUT,
+     STAGE_BALANCING_TOKEN,
+     "Move the threads of the multi-instance pipeline stages to the bottleneck stage at run "
+     "time, with at most --lp of them taking work (0: OFF [default], 1: ON)",
+     set_stage_balancing},
+    {SINGLE_INPUT,
+     NUMA_TOKEN,
+     "Place the stage threads and their memory on the NUMA nodes and interleave the picture "
+     "pools over the nodes, Linux only. Cannot be combined with --ss (0: OFF [default], 1: ON)",
+     set_numa_aware},
+    {SINGLE_INPUT,
+     EXECUTOR_THREADS_TOKEN,
+     "Run the multi-instance pipeline stages of all the channels on one shared pool of "
+     "workers, implies --task-scheduler 1 (0: one pool per channel [default], N: N workers)",
+     set_executor_threads},
+    {SINGLE_INPUT,
+     EXECUTOR_WEIGHT_TOKEN,
+     "Share of the shared pool workers given to the channel while all the channels have work "
+     "queued, [1-100] (default is 1)",
+     set_executor_weight},
+    {SINGLE_INPUT,
+     ELASTIC_POOLS_TOKEN,
+     "Start the input and reference picture pools with one mini-GOP of pictures and grow them "
+     "when they run empty (0: allocate the pools at init [default], 1: ON)",
+     set_elastic_pools},
+    {SINGLE_INPUT,
+     MEMORY_BUDGET_TOKEN,
+     "Most memory in MB the encoder may allocate, reduces the look ahead distance and the picture "
+     "pools to fit (0: no budget [default])",
+     set_memory_budget},
+    {SINGLE_INPUT,
+     LARGE_PAGES_TOKEN,
+     "Back the picture buffers with large pages (0: OFF [default], 1: transparent huge pages, "
+     "2: reserved huge pages, 1 when none is free)",
+     set_large_pages},
     // Termination
     {SINGLE_INPUT, NULL, NULL, NULL}};
 
@@ -933,7 +1047,7 @@ ConfigEntry config_entry_rc[] = {
     // Rate Control
     {SINGLE_INPUT,
      RATE_CONTROL_ENABLE_TOKEN,
-     "Rate control mode(0 = CQP if --enable-tpl-la is set to 0, else CRF , 1 = VBR , 2 = CVBR)",
+     "Rate control mode(0 = CQP if --enable-tpl-la is set to 0, else CRF , 1 = VBR , 2 = CVBR , 3 = CBR)",
      set_rate_control_mode},
     {SINGLE_INPUT, TARGET_BIT_RATE_TOKEN, "Target Bitrate (kbps)", set_target_bit_rate},
     {SINGLE_INPUT,
@@ -969,7 +1083,7 @@ ConfigEntry config_entry_rc[] = {
      ADAPTIVE_QP_ENABLE_TOKEN,
      "Set adaptive QP level(0: OFF ,1: variance base using segments ,2: Deltaq pred efficiency)",
      set_adaptive_quantization},
-    {SINGLE_INPUT, VBV_BUFSIZE_TOKEN, "VBV buffer size", set_vbv_buf_size},
+    {SINGLE_INPUT, VBV_BUFSIZE_TOKEN, "VBV buffer size (kbits)", set_vbv_buf_size},
     {SINGLE_INPUT,
      UNDER_SHOOT_PCT_TOKEN,
      "Datarate undershoot (min) target (%)",
@@ -1313,6 +1427,7 @@ ConfigEntry config_entry[] = {
     {SINGLE_INPUT, OUTPUT_RECON_TOKEN, "ReconFile", set_cfg_recon_file},
     {SINGLE_INPUT, QP_FILE_TOKEN, "QpFile", set_cfg_qp_file},
     {SINGLE_INPUT, STAT_FILE_TOKEN, "StatFile", set_cfg_stat_file},
+    {SINGLE_INPUT, TRACE_FILE_TOKEN, "TraceFile", set_cfg_trace_file},
 
     // two pass
     {SINGLE_INPUT, PASS_TOKEN, "Pass", set_pass},
@@ -1325,6 +1440,9 @@ ConfigEntry config_entry[] = {
     // Prediction Structure
     {SINGLE_INPUT, NUMBER_OF_PICTURES_TOKEN, "FrameToBeEncoded", set_cfg_frames_to_be_encoded},
     {SINGLE_INPUT, BUFFERED_INPUT_TOKEN, "BufferedInput", set_buffered_input},
+    {SINGLE_INPUT, INPUT_READER_TOKEN, "InputReader", set_input_reader},
+    {SINGLE_INPUT, INPUT_BENCHMARK_TOKEN, "InputBenchmark", set_input_benchmark},
+    {SINGLE_INPUT, ASYNC_WRITER_TOKEN, "AsyncWriter", set_async_writer},
     {SINGLE_INPUT, PROGRESS_TOKEN, "Progress", set_progress},
     {SINGLE_INPUT, NO_PROGRESS_TOKEN, "NoProgress", set_no_progress},
     {SINGLE_INPUT, ENCMODE_TOKEN, "EncoderMode", set_enc_mode},
@@ -1472,6 +1590,14 @@ ConfigEntry config_entry[] = {
     {SINGLE_INPUT, THREAD_MGMNT, "LogicalProcessors", set_logical_processors},
     {SINGLE_INPUT, UNPIN_TOKEN, "UnpinExecution", set_unpin_execution},
     {SINGLE_INPUT, TARGET_SOCKET, "TargetSocket", set_target_socket},
+    {SINGLE_INPUT, TASK_SCHEDULER_TOKEN, "TaskScheduler", set_task_scheduler},
+    {SINGLE_INPUT, STAGE_BALANCING_TOKEN, "StageBalancing", set_stage_balancing},
+    {SINGLE_INPUT, NUMA_TOKEN, "NumaAware", set_numa_aware},
+    {SINGLE_INPUT, EXECUTOR_THREADS_TOKEN, "ExecutorThreads", set_executor_threads},
+    {SINGLE_INPUT, EXECUTOR_WEIGHT_TOKEN, "ExecutorWeight", set_executor_weight},
+    {SINGLE_INPUT, ELASTIC_POOLS_TOKEN, "ElasticPools", set_elastic_pools},
+    {SINGLE_INPUT, MEMORY_BUDGET_TOKEN, "MemoryBudget", set_memory_budget},
+    {SINGLE_INPUT, LARGE_PAGES_TOKEN, "LargePages", set_large_pages},
     // Optional Features
     {SINGLE_INPUT,
      UNRESTRICTED_MOTION_VECTOR,
@@ -1635,6 +1761,7 @@ void svt_config_dtor(EbConfig *config_ptr) {
         config_ptr->config_file = (FILE *)NULL;
     }
 
+    app_input_reader_close(config_ptr);
     if (config_ptr->input_file) {
         if (!config_ptr->input_file_is_fifo)
             fclose(config_ptr->input_file);
@@ -1676,6 +1803,7 @@ void svt_config_dtor(EbConfig *config_ptr) {
         config_ptr->stat_file = (FILE *)NULL;
     }
     free((void *)config_ptr->stats);
+    free((void *)config_ptr->config.trace_file);
     free(config_ptr);
     return;
 }
@@ -1699,6 +1827,9 @@ EbErrorType enc_channel_ctor(EncChannel *c, EncodePass pass) {
 
 void enc_channel_dctor(EncChannel *c, uint32_t inst_cnt) {
     EbAppContext *ctx = c->app_callback;
+    // the queued packets go back to the library before it is torn down
+    if (c->config)
+        app_output_writer_close(c->config);
     if (ctx && ctx->svt_encoder_handle) {
         svt_av1_enc_deinit(ctx->svt_encoder_handle);
         de_init_encoder(ctx, inst_cnt);
@@ -2050,6 +2181,27 @@ static EbErrorType verify_settings(EbConfig *config, uint32_t channel_number) {
         return_error = EB_ErrorBadParameter;
     }
 
+    if (config->input_reader_mode > APP_INPUT_READER_READ_AHEAD) {
+        fprintf(config->error_log_file,
+                "Error instance %u: Invalid InputReader [0 - 2]\n",
+                channel_number + 1);
+        return_error = EB_ErrorBadParameter;
+    }
+
+    if (config->input_reader_mode != APP_INPUT_READER_OFF && config->buffered_input != -1) {
+        fprintf(config->error_log_file,
+                "Error instance %u: InputReader can not be used with BufferedInput\n",
+                channel_number + 1);
+        return_error = EB_ErrorBadParameter;
+    }
+
+    if (config->async_writer > 1024) {
+        fprintf(config->error_log_file,
+                "Error instance %u: Invalid AsyncWriter [0 - 1024]\n",
+                channel_number + 1);
+        return_error = EB_ErrorBadParameter;
+    }
+
     if (config->config.use_qp_file == EB_TRUE && config->qp_file == NULL) {
         fprintf(config->error_log_file,
                 "Error instance %u: Could not find QP file, UseQpFile is set to 1\n",
@@ -2915,8 +3067,11 @@ EbErrorType read_command_line(int32_t argc, char *const argv[], EncChannel *chan
                 }
 
                 // Force the injector latency mode, and injector frame rate when speed control is on
-                if (c->return_error == EB_ErrorNone && config->speed_control_flag == 1)
-                    config->injector = 1;
+                if (c->return_error == EB_ErrorNone && config->speed_control_flag == 1) {
+                    config->injector                   = 1;
+                    config->config.speed_control_flag  = 1;
+                    config->config.injector_frame_rate = (int32_t)config->injector_frame_rate;
+                }
             }
             return_error = (EbErrorType)(return_error & c->return_error);
         }
@@ -116,7 +116,7 @@ extern uint32_t          app_malloc_count;
     fprintf(stderr, "Total Number of Mallocs in App: %u\n", app_malloc_count); \
     fprintf(stderr, "Total App Memory: %.2lf KB\n\n", *total_app_memory / (double)1024);
 
-#define MAX_CHANNEL_NUMBER 6U
+#define MAX_CHANNEL_NUMBER 64U
 #define MAX_NUM_TOKENS 210
 
 #ifdef _WIN32
@@ -202,10 +202,22 @@ typedef struct EbConfig {
     int32_t   buffered_input;
     uint8_t **sequence_buffer;
 
+    // Frames are handed out by input_reader, open when input_reader_mode is not 0
+    uint32_t               input_reader_mode;
+    struct AppInputReader *input_reader;
+    EbBool                 input_benchmark; // read the input without encoding it
+
+    // Outputs queued to output_writer, written inline when 0
+    uint32_t                async_writer;
+    struct AppOutputWriter *output_writer;
+
     uint32_t injector_frame_rate;
     uint32_t injector;
     uint32_t speed_control_flag;
 
+    // Workers of the executor shared by all the channels, 0 for none
+    uint32_t executor_threads;
+
     uint32_t hme_level0_column_index;
     uint32_t hme_level0_row_index;
     uint32_t hme_level1_column_index;
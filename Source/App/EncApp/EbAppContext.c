@@ -18,6 +18,8 @@
 
 #include "EbAppContext.h"
 #include "EbAppConfig.h"
+#include "EbAppInputReader.h"
+#include "EbAppOutputWriter.h"
 
 #define IS_16_BIT(bit_depth) (bit_depth == 10 ? 1 : 0)
 
@@ -168,8 +170,8 @@ EbErrorType allocate_input_buffers(EbConfig *config, EbAppContext *callback_data
                   EB_N_PTR,
                   EB_ErrorInsufficientResources);
 
-    // Allocate frame buffer for the p_buffer
-    if (config->buffered_input == -1)
+    // Allocate frame buffer for the p_buffer, the planes of the reader frames are pointed to
+    if (config->buffered_input == -1 && !config->input_reader)
         allocate_frame_buffer(config, callback_data->input_buffer_pool->p_buffer);
 
     // Assign the variables
@@ -289,6 +291,11 @@ EbErrorType init_encoder(EbConfig *config, EbAppContext *callback_data, uint32_t
     ///********************** APPLICATION INIT [START] ******************///
 
     // STEP 6: Allocate input buffers carrying the yuv frames in
+    if (config->input_reader_mode != APP_INPUT_READER_OFF) {
+        return_error = app_input_reader_open(config);
+        if (return_error != EB_ErrorNone)
+            return return_error;
+    }
     return_error = allocate_input_buffers(config, callback_data);
 
     if (return_error != EB_ErrorNone)
@@ -298,6 +305,11 @@ EbErrorType init_encoder(EbConfig *config, EbAppContext *callback_data, uint32_t
 
     if (return_error != EB_ErrorNone)
         return return_error;
+    if (config->async_writer && (config->bitstream_file || config->recon_file)) {
+        return_error = app_output_writer_open(config);
+        if (return_error != EB_ErrorNone)
+            return return_error;
+    }
     // Allocate the Sequence Buffer
     if (config->buffered_input != -1) {
         // Preload frames into the ram for a faster yuv access time
@@ -0,0 +1,337 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include "EbAppInputReader.h"
+#include "EbAppInputy4m.h"
+#include "EbAppThreads.h"
+
+#define YUV4MPEG2_IND_SIZE 9
+// Longest "FRAME" line accepted in a mapped y4m file
+#define Y4M_FRAME_LINE_MAX 256
+#ifndef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+struct AppInputReader {
+    size_t   frame_size;
+    EbBool   y4m;
+    FILE *   error_log_file;
+    uint8_t *frame; // returned by the last app_input_reader_next
+
+    // Mapped regular file
+    uint8_t *map;
+    size_t   map_size;
+    size_t   data_offset; // first frame delimiter or frame, past the y4m header
+    size_t   position; // next frame delimiter or frame
+#ifdef _WIN32
+    HANDLE mapping;
+#endif
+
+    // Read ahead thread, frames in ring[(head + i) % APP_INPUT_READ_AHEAD_FRAMES]
+    FILE *   input_file;
+    EbBool   is_pipe;
+    EbBool   first_frame; // prefixed by the bytes of the y4m probe on a pipe
+    uint8_t *y4m_buf;
+    uint8_t *ring[APP_INPUT_READ_AHEAD_FRAMES];
+    uint32_t head;
+    uint32_t count;
+    EbBool   eos; // the thread read its last frame
+    EbBool    stop;
+    AppThread thread;
+    AppMutex  lock;
+    AppCond   filled;
+    AppCond   emptied;
+};
+
+size_t app_input_frame_size(const EbConfig *config) {
+    const uint8_t color_format = config->config.encoder_color_format;
+    const size_t  luma_size    = (size_t)config->input_padded_width * config->input_padded_height;
+    if (config->config.encoder_bit_depth > 8 && config->config.compressed_ten_bit_format == 1) {
+        const size_t nbit_luma_size = (size_t)(config->input_padded_width / 4) *
+            config->input_padded_height;
+        return luma_size + nbit_luma_size +
+            2 * ((luma_size >> (3 - color_format)) + (nbit_luma_size >> (3 - color_format)));
+    }
+    const size_t read_size = luma_size << (config->config.encoder_bit_depth > 8);
+    return read_size + 2 * (read_size >> (3 - color_format));
+}
+
+/**********************************
+ * Mapped regular file
+ **********************************/
+static EbBool map_input_file(AppInputReader *reader, FILE *input_file) {
+    const int64_t offset = ftello(input_file);
+    if (offset < 0)
+        return EB_FALSE;
+#ifdef _WIN32
+    HANDLE        file = (HANDLE)_get_osfhandle(_fileno(input_file));
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || (uint64_t)size.QuadPart > (size_t)-1)
+        return EB_FALSE;
+    reader->map_size = (size_t)size.QuadPart;
+    reader->mapping  = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!reader->mapping)
+        return EB_FALSE;
+    reader->map = (uint8_t *)MapViewOfFile(reader->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!reader->map) {
+        CloseHandle(reader->mapping);
+        return EB_FALSE;
+    }
+#else
+    struct stat statbuf;
+    if (fstat(fileno(input_file), &statbuf) || !S_ISREG(statbuf.st_mode) ||
+        (uint64_t)statbuf.st_size > (size_t)-1)
+        return EB_FALSE;
+    reader->map_size = (size_t)statbuf.st_size;
+    if (!reader->map_size)
+        return EB_FALSE;
+    void *map = mmap(NULL, reader->map_size, PROT_READ, MAP_PRIVATE, fileno(input_file), 0);
+    if (map == MAP_FAILED)
+        return EB_FALSE;
+    reader->map = (uint8_t *)map;
+    madvise(reader->map, reader->map_size, MADV_SEQUENTIAL);
+#endif
+    reader->data_offset = reader->position = (size_t)offset;
+    return EB_TRUE;
+}
+
+static void unmap_input_file(AppInputReader *reader) {
+#ifdef _WIN32
+    UnmapViewOfFile(reader->map);
+    CloseHandle(reader->mapping);
+#else
+    munmap(reader->map, reader->map_size);
+#endif
+    reader->map = NULL;
+}
+
+// Offset of the frame at position past its "FRAME" line, map_size if there is no whole frame
+static size_t mapped_frame_offset(AppInputReader *reader, size_t position) {
+    if (reader->y4m) {
+        const size_t   line_max = MIN(reader->map_size - position, Y4M_FRAME_LINE_MAX);
+        const uint8_t *eol      = (const uint8_t *)memchr(reader->map + position, '\n', line_max);
+        if (!eol)
+            return reader->map_size;
+        if (memcmp(reader->map + position, "FRAME", sizeof("FRAME") - 1))
+            fprintf(reader->error_log_file,
+                    "Failed to read proper y4m frame delimeter. Read broken.\n");
+        position = (size_t)(eol + 1 - reader->map);
+    }
+    return reader->map_size - position < reader->frame_size ? reader->map_size : position;
+}
+
+static uint8_t *next_mapped_frame(AppInputReader *reader) {
+    size_t offset = reader->position < reader->map_size
+        ? mapped_frame_offset(reader, reader->position)
+        : reader->map_size;
+    if (offset == reader->map_size) {
+        // loop over the file like the fread path
+        offset = mapped_frame_offset(reader, reader->data_offset);
+        if (offset == reader->map_size)
+            return NULL;
+    }
+    reader->position = offset + reader->frame_size;
+#ifndef _WIN32
+    // have the kernel read the next frames while this one is encoded
+    const size_t page  = 4096;
+    const size_t ahead = reader->position & ~(page - 1);
+    if (ahead < reader->map_size)
+        madvise(reader->map + ahead,
+                MIN(reader->map_size - ahead, APP_INPUT_READ_AHEAD_FRAMES * reader->frame_size),
+                MADV_WILLNEED);
+#endif
+    return reader->map + offset;
+}
+
+static void release_mapped_frame(AppInputReader *reader) {
+#ifndef _WIN32
+    // the pages stay in the page cache, only the mapping of the sent frame is dropped
+    const size_t page  = 4096;
+    const size_t start = ((size_t)(reader->frame - reader->map) + page - 1) & ~(page - 1);
+    const size_t end   = ((size_t)(reader->frame - reader->map) + reader->frame_size) &
+        ~(page - 1);
+    if (end > start)
+        madvise(reader->map + start, end - start, MADV_DONTNEED);
+#else
+    (void)reader;
+#endif
+}
+
+/**********************************
+ * Read ahead thread
+ **********************************/
+static EbBool read_frame(AppInputReader *reader, uint8_t *frame) {
+    FILE * input_file = reader->input_file;
+    size_t prefix     = 0;
+    if (reader->y4m)
+        read_y4m_frame_delimiter(input_file, reader->error_log_file);
+    else if (reader->first_frame && reader->is_pipe) {
+        // 9 bytes were already buffered during the the YUV4MPEG2 header probe
+        memcpy(frame, reader->y4m_buf, YUV4MPEG2_IND_SIZE);
+        prefix = YUV4MPEG2_IND_SIZE;
+    }
+    reader->first_frame = EB_FALSE;
+    if (fread(frame + prefix, 1, reader->frame_size - prefix, input_file) ==
+        reader->frame_size - prefix)
+        return EB_TRUE;
+    if (reader->is_pipe)
+        return EB_FALSE;
+    // If we reached the end of file, loop over again
+    fseek(input_file, 0, SEEK_SET);
+    if (reader->y4m) {
+        read_and_skip_y4m_header(input_file);
+        read_y4m_frame_delimiter(input_file, reader->error_log_file);
+    }
+    return fread(frame, 1, reader->frame_size, input_file) == reader->frame_size;
+}
+
+APP_THREAD_KERNEL(read_ahead_kernel, input_ptr) {
+    AppInputReader *reader = (AppInputReader *)input_ptr;
+    for (;;) {
+        app_mutex_lock(&reader->lock);
+        while (reader->count == APP_INPUT_READ_AHEAD_FRAMES && !reader->stop)
+            app_cond_wait(&reader->emptied, &reader->lock);
+        const EbBool stop = reader->stop;
+        uint8_t *frame = reader->ring[(reader->head + reader->count) % APP_INPUT_READ_AHEAD_FRAMES];
+        app_mutex_unlock(&reader->lock);
+        if (stop)
+            break;
+
+        // the slot past the filled ones belongs to this thread until it is counted
+        const EbBool whole_frame = read_frame(reader, frame);
+        app_mutex_lock(&reader->lock);
+        if (whole_frame)
+            reader->count++;
+        else
+            reader->eos = EB_TRUE;
+        app_cond_signal(&reader->filled);
+        app_mutex_unlock(&reader->lock);
+        if (!whole_frame)
+            break;
+    }
+    return 0;
+}
+
+static EbErrorType start_read_ahead(AppInputReader *reader, EbConfig *config) {
+    reader->input_file  = config->input_file;
+    reader->is_pipe     = config->input_file == stdin || config->input_file_is_fifo;
+    reader->first_frame = EB_TRUE;
+    reader->y4m_buf     = config->y4m_buf;
+    for (int i = 0; i < APP_INPUT_READ_AHEAD_FRAMES; i++) {
+        reader->ring[i] = (uint8_t *)malloc(reader->frame_size);
+        if (!reader->ring[i])
+            return EB_ErrorInsufficientResources;
+    }
+    app_mutex_init(&reader->lock);
+    app_cond_init(&reader->filled);
+    app_cond_init(&reader->emptied);
+    if (app_thread_create(&reader->thread, read_ahead_kernel, reader)) {
+        app_cond_destroy(&reader->emptied);
+        app_cond_destroy(&reader->filled);
+        app_mutex_destroy(&reader->lock);
+        return EB_ErrorInsufficientResources;
+    }
+    return EB_ErrorNone;
+}
+
+static void stop_read_ahead(AppInputReader *reader) {
+    app_mutex_lock(&reader->lock);
+    reader->stop = EB_TRUE;
+    app_cond_signal(&reader->emptied);
+    app_mutex_unlock(&reader->lock);
+    app_thread_join(reader->thread);
+    app_cond_destroy(&reader->emptied);
+    app_cond_destroy(&reader->filled);
+    app_mutex_destroy(&reader->lock);
+}
+
+static uint8_t *next_read_ahead_frame(AppInputReader *reader) {
+    app_mutex_lock(&reader->lock);
+    while (!reader->count && !reader->eos) app_cond_wait(&reader->filled, &reader->lock);
+    uint8_t *frame = reader->count ? reader->ring[reader->head] : NULL;
+    app_mutex_unlock(&reader->lock);
+    return frame;
+}
+
+static void release_read_ahead_frame(AppInputReader *reader) {
+    app_mutex_lock(&reader->lock);
+    reader->head = (reader->head + 1) % APP_INPUT_READ_AHEAD_FRAMES;
+    reader->count--;
+    app_cond_signal(&reader->emptied);
+    app_mutex_unlock(&reader->lock);
+}
+
+/**********************************
+ * Reader
+ **********************************/
+EbErrorType app_input_reader_open(EbConfig *config) {
+    AppInputReader *reader = (AppInputReader *)calloc(1, sizeof(*reader));
+    if (!reader)
+        return EB_ErrorInsufficientResources;
+    reader->frame_size     = app_input_frame_size(config);
+    reader->y4m            = config->y4m_input;
+    reader->error_log_file = config->error_log_file;
+
+    const EbBool is_pipe = config->input_file == stdin || config->input_file_is_fifo;
+    if (config->input_reader_mode == APP_INPUT_READER_AUTO && !is_pipe &&
+        map_input_file(reader, config->input_file)) {
+        config->input_reader = reader;
+        return EB_ErrorNone;
+    }
+    // pipes, and files which can not be mapped
+    const EbErrorType return_error = start_read_ahead(reader, config);
+    if (return_error != EB_ErrorNone) {
+        for (int i = 0; i < APP_INPUT_READ_AHEAD_FRAMES; i++) free(reader->ring[i]);
+        free(reader);
+        return return_error;
+    }
+    config->input_reader = reader;
+    return EB_ErrorNone;
+}
+
+uint8_t *app_input_reader_next(AppInputReader *reader) {
+    reader->frame = reader->map ? next_mapped_frame(reader) : next_read_ahead_frame(reader);
+    return reader->frame;
+}
+
+void app_input_reader_release(AppInputReader *reader) {
+    if (!reader->frame)
+        return;
+    if (reader->map)
+        release_mapped_frame(reader);
+    else
+        release_read_ahead_frame(reader);
+    reader->frame = NULL;
+}
+
+void app_input_reader_close(EbConfig *config) {
+    AppInputReader *reader = config->input_reader;
+    if (!reader)
+        return;
+    if (reader->map)
+        unmap_input_file(reader);
+    else {
+        stop_read_ahead(reader);
+        for (int i = 0; i < APP_INPUT_READ_AHEAD_FRAMES; i++) free(reader->ring[i]);
+    }
+    free(reader);
+    config->input_reader = NULL;
+}
@@ -0,0 +1,52 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#ifndef EbAppInputReader_h
+#define EbAppInputReader_h
+
+#include "EbAppConfig.h"
+
+/* Values of --input-reader */
+typedef enum AppInputReaderMode {
+    APP_INPUT_READER_OFF        = 0, // fread of each plane on the encoding thread
+    APP_INPUT_READER_AUTO       = 1, // map regular files, read pipes ahead
+    APP_INPUT_READER_READ_AHEAD = 2, // read ahead on a thread, files as well as pipes
+} AppInputReaderMode;
+
+// Frames read ahead of the encoder by the reader thread
+#define APP_INPUT_READ_AHEAD_FRAMES 8
+
+/*********************************************************************
+ * Input Reader
+ *   Hands out the frames of the input file without copying them into
+ *   the input buffer: the planes point into the mapping of a regular
+ *   file, or into a ring of frames a thread fills ahead of the encoder
+ *   from a pipe. Frames loop over regular files like the fread path.
+ *********************************************************************/
+typedef struct AppInputReader AppInputReader;
+
+/* Opens the reader of config->input_file, positioned on the first frame */
+extern EbErrorType app_input_reader_open(EbConfig *config);
+
+/* Planes of the next frame, contiguous and frame size bytes long as
+ * read_input_frames lays them out. NULL at the end of a pipe. */
+extern uint8_t *app_input_reader_next(AppInputReader *reader);
+
+/* Gives back the frame of the last app_input_reader_next, once sent */
+extern void app_input_reader_release(AppInputReader *reader);
+
+/* Bytes of one input frame as read_input_frames reads it */
+extern size_t app_input_frame_size(const EbConfig *config);
+
+/* Stops the reader thread and unmaps the file, input_file stays open */
+extern void app_input_reader_close(EbConfig *config);
+
+#endif // EbAppInputReader_h
@@ -48,6 +48,8 @@
  ***************************************/
 void process_input_buffer(EncChannel* c);
 
+double benchmark_input_buffer(EncChannel* c);
+
 void process_output_recon_buffer(EncChannel* c);
 
 void process_output_stream_buffer(EncChannel* c, EncApp* enc_app, int32_t* frame_count);
@@ -83,6 +85,9 @@ typedef struct EncContext {
 
     EncodePass pass;
     int32_t    total_frames;
+
+    // Shared by the channels when --executor-threads is set
+    SvtAv1Executor* executor;
 } EncContext;
 
 static EbErrorType enc_context_ctor(EncApp* enc_app, EncContext* enc_context, int32_t argc,
@@ -123,11 +128,22 @@ static EbErrorType enc_context_ctor(EncApp* enc_app, EncContext* enc_context, in
     if (enc_context->channels[0].config->config.target_socket != -1)
         assign_app_thread_group(enc_context->channels[0].config->config.target_socket);
 
+    // One pool of workers for all the channels
+    if (enc_context->channels[0].config->executor_threads) {
+        return_error = svt_av1_executor_create(&enc_context->executor,
+                                               enc_context->channels[0].config->executor_threads);
+        if (return_error != EB_ErrorNone) {
+            fprintf(stderr, "Error: could not create the shared executor\n");
+            return return_error;
+        }
+    }
+
     // Init the Encoder
     for (uint32_t inst_cnt = 0; inst_cnt < num_channels; ++inst_cnt) {
         EncChannel* c = enc_context->channels + inst_cnt;
         if (c->return_error == EB_ErrorNone) {
             EbConfig* config                    = c->config;
+            config->config.executor             = enc_context->executor;
             config->config.active_channel_count = num_channels;
             config->config.channel_id           = inst_cnt;
             config->config.recon_enabled        = config->recon_file ? EB_TRUE : EB_FALSE;
@@ -153,6 +169,9 @@ static void enc_context_dctor(EncContext* enc_context) {
         EncChannel* c = enc_context->channels + inst_cnt;
         enc_channel_dctor(c, inst_cnt);
     }
+    // After the channels are deinitialized, none is attached any more
+    if (enc_context->executor)
+        svt_av1_executor_destroy(enc_context->executor);
 
     for (uint32_t warning_id = 0; warning_id < MAX_NUM_TOKENS; warning_id++)
         free(enc_context->warning[warning_id]);
@@ -163,6 +182,8 @@ static void print_summary(const EncContext* const enc_context) {
     for (uint32_t inst_cnt = 0; inst_cnt < enc_context->num_channels; ++inst_cnt) {
         const EncChannel* const c      = &enc_context->channels[inst_cnt];
         const EbConfig*         config = c->config;
+        if (config->input_benchmark)
+            continue;
         if (c->exit_cond == APP_ExitConditionFinished && c->return_error == EB_ErrorNone) {
             uint64_t frame_count    = (uint32_t)config->performance_context.frame_count;
             uint32_t max_luma_value = (config->config.encoder_bit_depth == 8) ? 255 : 1023;
@@ -277,6 +298,8 @@ static void print_summary(const EncContext* const enc_context) {
 static void print_performance(const EncContext* const enc_context) {
     for (uint32_t inst_cnt = 0; inst_cnt < enc_context->num_channels; ++inst_cnt) {
         const EncChannel* c = enc_context->channels + inst_cnt;
+        if (c->config->input_benchmark)
+            continue;
         if (c->exit_cond == APP_ExitConditionFinished && c->return_error == EB_ErrorNone) {
             EbConfig* config = c->config;
             if (config->stop_encoder == EB_FALSE) {
@@ -344,6 +367,24 @@ static void enc_channel_step(EncChannel* c, EncApp* enc_app, EncContext* enc_con
     }
 }
 
+// Reads the input of the channel without encoding it and reports the throughput
+static void enc_channel_benchmark_input(EncChannel* c, uint32_t inst_cnt) {
+    EbConfig*    config  = c->config;
+    const double seconds = benchmark_input_buffer(c);
+    const double mbytes  = (double)config->processed_byte_count / (1024 * 1024);
+    fprintf(stderr,
+            "\nChannel %u\nInput Frames:\t\t%llu\nInput Size:\t\t%.1f MB\nInput Time:\t\t%.0f "
+            "ms\nInput Speed:\t\t%.1f MB/s (%.1f fps)\n",
+            inst_cnt + 1,
+            (unsigned long long)config->processed_frame_count,
+            mbytes,
+            seconds * 1000,
+            seconds > 0 ? mbytes / seconds : 0,
+            seconds > 0 ? config->processed_frame_count / seconds : 0);
+    c->active    = EB_FALSE;
+    c->exit_cond = APP_ExitConditionFinished;
+}
+
 static const char* get_pass_name(EncodePass pass) {
     switch (pass) {
     case ENCODE_FIRST_PASS: return "Pass 1/2 ";
@@ -382,6 +423,14 @@ static EbErrorType encode(EncApp* enc_app, EncContext* enc_context) {
     }
     print_warnnings(enc_context);
 
+    for (uint32_t inst_cnt = 0; inst_cnt < num_channels; ++inst_cnt) {
+        EncChannel* c = enc_context->channels + inst_cnt;
+        if (is_active(c) && c->config->input_benchmark)
+            enc_channel_benchmark_input(c, inst_cnt);
+    }
+    if (!has_active_channel(enc_context))
+        return return_error;
+
     fprintf(stderr, "%sEncoding          ", get_pass_name(pass));
 
     while (has_active_channel(enc_context)) {
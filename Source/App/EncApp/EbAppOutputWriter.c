@@ -0,0 +1,244 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <errno.h>
+#include <sys/uio.h>
+#endif
+#include "EbAppOutputWriter.h"
+#include "EbAppThreads.h"
+
+// Packets gathered in one writev, each takes a header and a payload vector
+#define WRITEV_PACKETS_MAX 32
+
+typedef struct AppOutput {
+    uint8_t             header[APP_OUTPUT_HEADER_MAX_SIZE];
+    uint32_t            header_size;
+    EbBufferHeaderType *packet; // NULL for a recon frame
+    uint8_t *           recon; // stays with the slot, grown to the largest frame
+    size_t              recon_capacity;
+    size_t              recon_size;
+    uint64_t            offset; // of the recon frame in the file
+} AppOutput;
+
+// Outputs in queue[(head + i) % capacity], the writer owns the count first ones
+struct AppOutputWriter {
+    FILE *     bitstream_file;
+    FILE *     recon_file;
+    FILE *     error_log_file;
+    AppOutput *queue;
+    uint32_t   capacity;
+    uint32_t   head;
+    uint32_t   count;
+    EbBool     stop;
+    EbBool     failed; // reported once
+    AppThread  thread;
+    AppMutex   lock;
+    AppCond    queued;
+    AppCond    written;
+};
+
+static void output_failed(AppOutputWriter *writer) {
+    if (!writer->failed)
+        fprintf(writer->error_log_file, "Error: writing the output failed\n");
+    writer->failed = EB_TRUE;
+}
+
+#ifndef _WIN32
+static EbBool write_vectors(int fd, struct iovec *iov, int iov_count) {
+    while (iov_count) {
+        ssize_t written = writev(fd, iov, iov_count);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return EB_FALSE;
+        }
+        // skip what went out, a short write resumes inside a vector
+        while (iov_count && (size_t)written >= iov->iov_len) {
+            written -= iov->iov_len;
+            iov++;
+            iov_count--;
+        }
+        if (iov_count) {
+            iov->iov_base = (uint8_t *)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+    return EB_TRUE;
+}
+#endif
+
+// Writes the packets of queue[first, first + count) back to back
+static void write_packets(AppOutputWriter *writer, uint32_t first, uint32_t count) {
+#ifndef _WIN32
+    struct iovec iov[2 * WRITEV_PACKETS_MAX];
+    int          iov_count = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        AppOutput *output       = &writer->queue[(first + i) % writer->capacity];
+        iov[iov_count].iov_base = output->header;
+        iov[iov_count].iov_len  = output->header_size;
+        iov_count++;
+        iov[iov_count].iov_base = output->packet->p_buffer;
+        iov[iov_count].iov_len  = output->packet->n_filled_len;
+        iov_count++;
+    }
+    fflush(writer->bitstream_file);
+    if (!write_vectors(fileno(writer->bitstream_file), iov, iov_count))
+        output_failed(writer);
+#else
+    for (uint32_t i = 0; i < count; i++) {
+        AppOutput *output = &writer->queue[(first + i) % writer->capacity];
+        if (fwrite(output->header, 1, output->header_size, writer->bitstream_file) !=
+                output->header_size ||
+            fwrite(output->packet->p_buffer, 1, output->packet->n_filled_len,
+                   writer->bitstream_file) != output->packet->n_filled_len)
+            output_failed(writer);
+    }
+#endif
+    for (uint32_t i = 0; i < count; i++)
+        svt_av1_enc_release_out_buffer(&writer->queue[(first + i) % writer->capacity].packet);
+}
+
+static void write_recon(AppOutputWriter *writer, AppOutput *output) {
+    if (fseeko(writer->recon_file, (int64_t)output->offset, SEEK_SET) ||
+        fwrite(output->recon, 1, output->recon_size, writer->recon_file) != output->recon_size)
+        output_failed(writer);
+}
+
+APP_THREAD_KERNEL(output_writer_kernel, input_ptr) {
+    AppOutputWriter *writer = (AppOutputWriter *)input_ptr;
+    for (;;) {
+        app_mutex_lock(&writer->lock);
+        while (!writer->count && !writer->stop) app_cond_wait(&writer->queued, &writer->lock);
+        const uint32_t first = writer->head;
+        const uint32_t count = writer->count;
+        app_mutex_unlock(&writer->lock);
+        // on stop, what is queued is written first
+        if (!count)
+            break;
+
+        uint32_t i = 0;
+        while (i < count) {
+            AppOutput *output = &writer->queue[(first + i) % writer->capacity];
+            if (!output->packet) {
+                write_recon(writer, output);
+                i++;
+                continue;
+            }
+            uint32_t packets = 1;
+            while (i + packets < count && packets < WRITEV_PACKETS_MAX &&
+                   writer->queue[(first + i + packets) % writer->capacity].packet)
+                packets++;
+            write_packets(writer, first + i, packets);
+            i += packets;
+        }
+
+        app_mutex_lock(&writer->lock);
+        writer->head = (writer->head + count) % writer->capacity;
+        writer->count -= count;
+        app_cond_signal(&writer->written);
+        app_mutex_unlock(&writer->lock);
+    }
+    return 0;
+}
+
+// Slot past the queued outputs, it belongs to the encoding loop until queued
+static AppOutput *reserve_output(AppOutputWriter *writer) {
+    app_mutex_lock(&writer->lock);
+    while (writer->count == writer->capacity) app_cond_wait(&writer->written, &writer->lock);
+    AppOutput *output = &writer->queue[(writer->head + writer->count) % writer->capacity];
+    app_mutex_unlock(&writer->lock);
+    return output;
+}
+
+static void queue_output(AppOutputWriter *writer) {
+    app_mutex_lock(&writer->lock);
+    writer->count++;
+    app_cond_signal(&writer->queued);
+    app_mutex_unlock(&writer->lock);
+}
+
+EbErrorType app_output_writer_open(EbConfig *config) {
+    AppOutputWriter *writer = (AppOutputWriter *)calloc(1, sizeof(*writer));
+    if (!writer)
+        return EB_ErrorInsufficientResources;
+    writer->capacity = config->async_writer;
+    writer->queue    = (AppOutput *)calloc(writer->capacity, sizeof(*writer->queue));
+    if (!writer->queue) {
+        free(writer);
+        return EB_ErrorInsufficientResources;
+    }
+    writer->bitstream_file = config->bitstream_file;
+    writer->recon_file     = config->recon_file;
+    writer->error_log_file = config->error_log_file;
+    app_mutex_init(&writer->lock);
+    app_cond_init(&writer->queued);
+    app_cond_init(&writer->written);
+    if (app_thread_create(&writer->thread, output_writer_kernel, writer)) {
+        app_cond_destroy(&writer->written);
+        app_cond_destroy(&writer->queued);
+        app_mutex_destroy(&writer->lock);
+        free(writer->queue);
+        free(writer);
+        return EB_ErrorInsufficientResources;
+    }
+    config->output_writer = writer;
+    return EB_ErrorNone;
+}
+
+void app_output_writer_packet(AppOutputWriter *writer, const uint8_t *header,
+                              uint32_t header_size, EbBufferHeaderType *packet) {
+    AppOutput *output = reserve_output(writer);
+    memcpy(output->header, header, header_size);
+    output->header_size = header_size;
+    output->packet      = packet;
+    queue_output(writer);
+}
+
+void app_output_writer_recon(AppOutputWriter *writer, const uint8_t *frame, size_t size,
+                             uint64_t offset) {
+    AppOutput *output = reserve_output(writer);
+    if (output->recon_capacity < size) {
+        uint8_t *recon = (uint8_t *)realloc(output->recon, size);
+        if (!recon) {
+            output_failed(writer);
+            return;
+        }
+        output->recon          = recon;
+        output->recon_capacity = size;
+    }
+    memcpy(output->recon, frame, size);
+    output->recon_size = size;
+    output->offset     = offset;
+    output->packet     = NULL;
+    queue_output(writer);
+}
+
+void app_output_writer_close(EbConfig *config) {
+    AppOutputWriter *writer = config->output_writer;
+    if (!writer)
+        return;
+    app_mutex_lock(&writer->lock);
+    writer->stop = EB_TRUE;
+    app_cond_signal(&writer->queued);
+    app_mutex_unlock(&writer->lock);
+    app_thread_join(writer->thread);
+    app_cond_destroy(&writer->written);
+    app_cond_destroy(&writer->queued);
+    app_mutex_destroy(&writer->lock);
+    for (uint32_t i = 0; i < writer->capacity; i++) free(writer->queue[i].recon);
+    free(writer->queue);
+    free(writer);
+    config->output_writer = NULL;
+}
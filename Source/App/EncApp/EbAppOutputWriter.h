@@ -0,0 +1,43 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#ifndef EbAppOutputWriter_h
+#define EbAppOutputWriter_h
+
+#include "EbAppConfig.h"
+
+// Largest header written in front of a packet: ivf stream and frame headers
+#define APP_OUTPUT_HEADER_MAX_SIZE 44
+
+/*********************************************************************
+ * Output Writer
+ *   Writes the packets and the recon frames on a thread, so a slow disk
+ *   does not hold the encoding loop. Up to --async-writer outputs are
+ *   queued; the packets queued back to back are written with one writev
+ *   and released to the library once on disk.
+ *********************************************************************/
+typedef struct AppOutputWriter AppOutputWriter;
+
+extern EbErrorType app_output_writer_open(EbConfig *config);
+
+/* Queues header then the payload of packet for the bitstream file, the
+ * packet is released by the writer. Blocks while the queue is full. */
+extern void app_output_writer_packet(AppOutputWriter *writer, const uint8_t *header,
+                                     uint32_t header_size, EbBufferHeaderType *packet);
+
+/* Queues a copy of the recon frame, written at offset of the recon file */
+extern void app_output_writer_recon(AppOutputWriter *writer, const uint8_t *frame, size_t size,
+                                    uint64_t offset);
+
+/* Writes what is queued, releases the packets and stops the thread */
+extern void app_output_writer_close(EbConfig *config);
+
+#endif // EbAppOutputWriter_h
@@ -21,6 +21,8 @@
 #include "EbAppConfig.h"
 #include "EbSvtAv1ErrorCodes.h"
 #include "EbAppInputy4m.h"
+#include "EbAppInputReader.h"
+#include "EbAppOutputWriter.h"
 #include "EbTime.h"
 /***************************************
  * Macros
@@ -189,7 +191,7 @@ void log_error_output(FILE *error_log_file, uint32_t error_code) {
         break;
 
     case EB_ENC_EC_ERROR2:
-        fprintf(error_log_file, "Error: copy_payload: output buffer too small!\n");
+        fprintf(error_log_file, "Error: packetization: output buffer too small or out of memory!\n");
         break;
 
     case EB_ENC_EC_ERROR3: fprintf(error_log_file, "Error: encode_sb: Unknown mode type!\n"); break;
@@ -634,6 +636,40 @@ void log_error_output(FILE *error_log_file, uint32_t error_code) {
     return;
 }
 
+// Points the planes of the input buffer into a frame laid out as read_input_frames reads it
+static uint32_t set_input_planes(EbConfig *config, uint8_t is_16bit, EbSvtIOFormat *input_ptr,
+                                 uint8_t *frame) {
+    const uint8_t color_format = config->config.encoder_color_format;
+    if (is_16bit && config->config.compressed_ten_bit_format == 1) {
+        // Determine size of each plane
+        const size_t luma_8bit_size = config->input_padded_width * config->input_padded_height;
+        const size_t chroma_8bit_size = luma_8bit_size >> (3 - color_format);
+        const size_t luma_2bit_size   = luma_8bit_size / 4; //4-2bit pixels into 1 byte
+        const size_t chroma_2bit_size = luma_2bit_size >> (3 - color_format);
+
+        input_ptr->luma     = frame;
+        input_ptr->cb       = frame + luma_8bit_size;
+        input_ptr->cr       = frame + luma_8bit_size + chroma_8bit_size;
+        input_ptr->luma_ext = frame + luma_8bit_size + 2 * chroma_8bit_size;
+        input_ptr->cb_ext   = frame + luma_8bit_size + 2 * chroma_8bit_size + luma_2bit_size;
+        input_ptr->cr_ext   = frame + luma_8bit_size + 2 * chroma_8bit_size + luma_2bit_size +
+            chroma_2bit_size;
+
+        return (uint32_t)(luma_8bit_size + luma_2bit_size +
+                          2 * (chroma_8bit_size + chroma_2bit_size));
+    }
+    //Normal unpacked mode:yuv420p10le yuv422p10le yuv444p10le
+    const size_t luma_size = (config->input_padded_width * config->input_padded_height)
+        << is_16bit;
+    const size_t chroma_size = luma_size >> (3 - color_format);
+
+    input_ptr->luma = frame;
+    input_ptr->cb   = frame + luma_size;
+    input_ptr->cr   = frame + luma_size + chroma_size;
+
+    return (uint32_t)(luma_size + 2 * chroma_size);
+}
+
 void read_input_frames(EbConfig *config, uint8_t is_16bit, EbBufferHeaderType *header_ptr) {
     const uint32_t input_padded_width  = config->input_padded_width;
     const uint32_t input_padded_height = config->input_padded_height;
@@ -647,7 +683,17 @@ void read_input_frames(EbConfig *config, uint8_t is_16bit, EbBufferHeaderType *h
     input_ptr->cr_stride = input_padded_width >> subsampling_x;
     input_ptr->cb_stride = input_padded_width >> subsampling_x;
 
-    if (config->buffered_input == -1) {
+    if (config->input_reader) {
+        // No copy, the planes point into the mapped file or the read ahead frame
+        uint8_t *frame = app_input_reader_next(config->input_reader);
+        if (!frame) {
+            // end of the pipe, the frames to encode are known now
+            config->frames_to_be_encoded = config->frames_encoded;
+            header_ptr->n_filled_len     = 0;
+            return;
+        }
+        header_ptr->n_filled_len = set_input_planes(config, is_16bit, input_ptr, frame);
+    } else if (config->buffered_input == -1) {
         uint64_t read_size;
         if (is_16bit == 0 || (is_16bit == 1 && config->config.compressed_ten_bit_format == 0)) {
             read_size = (uint64_t)SIZE_OF_ONE_FRAME_IN_BYTES(
@@ -750,61 +796,11 @@ void read_input_frames(EbConfig *config, uint8_t is_16bit, EbBufferHeaderType *h
         }
 
     } else {
-        if (is_16bit && config->config.compressed_ten_bit_format == 1) {
-            // Determine size of each plane
-            const size_t luma_8bit_size   = input_padded_width * input_padded_height;
-            const size_t chroma_8bit_size = luma_8bit_size >> (3 - color_format);
-            const size_t luma_2bit_size   = luma_8bit_size / 4; //4-2bit pixels into 1 byte
-            const size_t chroma_2bit_size = luma_2bit_size >> (3 - color_format);
-
-            input_ptr            = (EbSvtIOFormat *)header_ptr->p_buffer;
-            input_ptr->y_stride  = input_padded_width;
-            input_ptr->cr_stride = input_padded_width >> subsampling_x;
-            input_ptr->cb_stride = input_padded_width >> subsampling_x;
-
-            input_ptr->luma =
-                config->sequence_buffer[config->processed_frame_count % config->buffered_input];
-            input_ptr->cb =
-                config->sequence_buffer[config->processed_frame_count % config->buffered_input] +
-                luma_8bit_size;
-            input_ptr->cr =
-                config->sequence_buffer[config->processed_frame_count % config->buffered_input] +
-                luma_8bit_size + chroma_8bit_size;
-
-            input_ptr->luma_ext =
-                config->sequence_buffer[config->processed_frame_count % config->buffered_input] +
-                luma_8bit_size + 2 * chroma_8bit_size;
-            input_ptr->cb_ext =
-                config->sequence_buffer[config->processed_frame_count % config->buffered_input] +
-                luma_8bit_size + 2 * chroma_8bit_size + luma_2bit_size;
-            input_ptr->cr_ext =
-                config->sequence_buffer[config->processed_frame_count % config->buffered_input] +
-                luma_8bit_size + 2 * chroma_8bit_size + luma_2bit_size + chroma_2bit_size;
-
-            header_ptr->n_filled_len = (uint32_t)(luma_8bit_size + luma_2bit_size +
-                                                  2 * (chroma_8bit_size + chroma_2bit_size));
-        } else {
-            //Normal unpacked mode:yuv420p10le yuv422p10le yuv444p10le
-            const size_t luma_size   = (input_padded_width * input_padded_height) << is_16bit;
-            const size_t chroma_size = luma_size >> (3 - color_format);
-
-            input_ptr = (EbSvtIOFormat *)header_ptr->p_buffer;
-
-            input_ptr->y_stride  = input_padded_width;
-            input_ptr->cr_stride = input_padded_width >> subsampling_x;
-            input_ptr->cb_stride = input_padded_width >> subsampling_x;
-
-            input_ptr->luma =
-                config->sequence_buffer[config->processed_frame_count % config->buffered_input];
-            input_ptr->cb =
-                config->sequence_buffer[config->processed_frame_count % config->buffered_input] +
-                luma_size;
-            input_ptr->cr =
-                config->sequence_buffer[config->processed_frame_count % config->buffered_input] +
-                luma_size + chroma_size;
-
-            header_ptr->n_filled_len = (uint32_t)(luma_size + 2 * chroma_size);
-        }
+        header_ptr->n_filled_len = set_input_planes(
+            config,
+            is_16bit,
+            input_ptr,
+            config->sequence_buffer[config->processed_frame_count % config->buffered_input]);
     }
 
     return;
@@ -944,8 +940,10 @@ void process_input_buffer(EncChannel *channel) {
             header_ptr->flags    = 0;
             header_ptr->metadata = NULL;
 
-            // Send the picture
+            // Send the picture, copied by the library before it returns
             svt_av1_enc_send_picture(component_handle, header_ptr);
+            if (config->input_reader)
+                app_input_reader_release(config->input_reader);
         }
 
         if ((config->processed_frame_count == (uint64_t)config->frames_to_be_encoded) ||
@@ -969,6 +967,56 @@ void process_input_buffer(EncChannel *channel) {
     channel->exit_cond_input = return_value;
 }
 
+//************************************/
+// benchmark_input_buffer
+// Reads the frames to be encoded like
+// process_input_buffer and copies them
+// once as the library would, without
+// encoding them. Returns the seconds spent
+/************************************/
+double benchmark_input_buffer(EncChannel *channel) {
+    EbConfig *          config     = channel->config;
+    EbBufferHeaderType *header_ptr = channel->app_callback->input_buffer_pool;
+    const uint8_t       is_16bit   = (uint8_t)(config->config.encoder_bit_depth > 8);
+    EbSvtIOFormat       copy;
+    uint64_t            start_seconds, start_useconds, finish_seconds, finish_useconds;
+
+    // stands in for the picture buffer of the library
+    memset(&copy, 0, sizeof(copy));
+    uint8_t *frame = (uint8_t *)malloc(app_input_frame_size(config));
+    if (!frame)
+        return 0;
+    set_input_planes(config, is_16bit, &copy, frame);
+
+    app_svt_av1_get_time(&start_seconds, &start_useconds);
+    while (keep_running && (config->frames_to_be_encoded < 0 ||
+                            config->processed_frame_count <
+                                (uint64_t)config->frames_to_be_encoded)) {
+        read_input_frames(config, is_16bit, header_ptr);
+        if (!header_ptr->n_filled_len)
+            break;
+        const EbSvtIOFormat *input_ptr = (EbSvtIOFormat *)header_ptr->p_buffer;
+        memcpy(copy.luma, input_ptr->luma, copy.cb - copy.luma);
+        memcpy(copy.cb, input_ptr->cb, copy.cr - copy.cb);
+        if (copy.luma_ext) {
+            memcpy(copy.cr, input_ptr->cr, copy.luma_ext - copy.cr);
+            memcpy(copy.luma_ext, input_ptr->luma_ext, copy.cb_ext - copy.luma_ext);
+            memcpy(copy.cb_ext, input_ptr->cb_ext, copy.cr_ext - copy.cb_ext);
+            memcpy(copy.cr_ext, input_ptr->cr_ext, copy.cr_ext - copy.cb_ext);
+        } else
+            memcpy(copy.cr, input_ptr->cr, copy.cr - copy.cb);
+        if (config->input_reader)
+            app_input_reader_release(config->input_reader);
+
+        config->processed_byte_count += header_ptr->n_filled_len;
+        config->frames_encoded = (int32_t)(++config->processed_frame_count);
+    }
+    app_svt_av1_get_time(&finish_seconds, &finish_useconds);
+    free(frame);
+    return app_svt_av1_compute_overall_elapsed_time(
+        start_seconds, start_useconds, finish_seconds, finish_useconds);
+}
+
 #define LONG_ENCODE_FRAME_ENCODE 4000
 #define SPEED_MEASUREMENT_INTERVAL 2000
 #define START_STEADY_STATE 1000
@@ -994,8 +1042,8 @@ static __inline void mem_put_le16(void *vmem, int32_t val) {
     mem[1] = (uint8_t)((val >> 8) & 0xff);
 }
 
-static void write_ivf_stream_header(EbConfig *config) {
-    char header[IVF_STREAM_HEADER_SIZE];
+// Fills the ivf stream header, returns its size
+static uint32_t write_ivf_stream_header(EbConfig *config, uint8_t *header) {
     header[0] = 'D';
     header[1] = 'K';
     header[2] = 'I';
@@ -1019,14 +1067,11 @@ static void write_ivf_stream_header(EbConfig *config) {
     mem_put_le32(header + 24, 0); // length
     mem_put_le32(header + 28, 0); // unused
     //config->performance_context.byte_count += 32;
-    if (config->bitstream_file)
-        fwrite(header, 1, IVF_STREAM_HEADER_SIZE, config->bitstream_file);
-
-    return;
+    return IVF_STREAM_HEADER_SIZE;
 }
 
-static void write_ivf_frame_header(EbConfig *config, uint32_t byte_count) {
-    char    header[IVF_FRAME_HEADER_SIZE];
+// Fills the ivf frame header, returns its size
+static uint32_t write_ivf_frame_header(EbConfig *config, uint32_t byte_count, uint8_t *header) {
     int32_t write_location = 0;
 
     mem_put_le32(&header[write_location], (int32_t)byte_count);
@@ -1039,9 +1084,7 @@ static void write_ivf_frame_header(EbConfig *config, uint32_t byte_count) {
 
     config->ivf_count++;
     fflush(stdout);
-
-    if (config->bitstream_file)
-        fwrite(header, 1, IVF_FRAME_HEADER_SIZE, config->bitstream_file);
+    return IVF_FRAME_HEADER_SIZE;
 }
 double get_psnr(double sse, double max) {
     double psnr;
@@ -1159,7 +1202,9 @@ void process_output_stream_buffer(EncChannel *channel, EncApp *enc_app, int32_t
         } else if (stream_status != EB_NoErrorEmptyQueue) {
             uint32_t flags = header_ptr->flags;
             is_alt_ref     = (flags & EB_BUFFERFLAG_IS_ALT_REF);
-            if (!(flags & EB_BUFFERFLAG_IS_ALT_REF))
+            // A low delay stream can end on an empty packet that only carries the EOS
+            const EbBool eos_only = header_ptr->n_filled_len == 0;
+            if (!(flags & EB_BUFFERFLAG_IS_ALT_REF) && !eos_only)
                 ++(config->performance_context.frame_count);
             *total_latency += (uint64_t)header_ptr->n_tick_count;
             *max_latency = (header_ptr->n_tick_count > *max_latency) ? header_ptr->n_tick_count
@@ -1183,27 +1228,37 @@ void process_output_stream_buffer(EncChannel *channel, EncApp *enc_app, int32_t
                     finish_s_time,
                     finish_u_time);
 
-            // Write Stream Data to file
-            if (stream_file) {
+            // Write Stream Data to file, or have the writer thread write it
+            uint8_t  ivf_header[APP_OUTPUT_HEADER_MAX_SIZE];
+            uint32_t ivf_header_size = 0;
+            if (stream_file && !eos_only) {
                 if (config->performance_context.frame_count == 1 &&
                     !(flags & EB_BUFFERFLAG_IS_ALT_REF)) {
-                    write_ivf_stream_header(config);
+                    ivf_header_size = write_ivf_stream_header(config, ivf_header);
+                }
+                ivf_header_size += write_ivf_frame_header(
+                    config, header_ptr->n_filled_len, ivf_header + ivf_header_size);
+                if (!config->output_writer) {
+                    fwrite(ivf_header, 1, ivf_header_size, stream_file);
+                    fwrite(header_ptr->p_buffer, 1, header_ptr->n_filled_len, stream_file);
                 }
-                write_ivf_frame_header(config, header_ptr->n_filled_len);
-                fwrite(header_ptr->p_buffer, 1, header_ptr->n_filled_len, stream_file);
             }
 
             config->performance_context.byte_count += header_ptr->n_filled_len;
 
-            if (config->config.stat_report && !(flags & EB_BUFFERFLAG_IS_ALT_REF))
+            if (config->config.stat_report && !(flags & EB_BUFFERFLAG_IS_ALT_REF) && !eos_only)
                 process_output_statistics_buffer(header_ptr, config);
 
             // Update Output Port Activity State
             *port_state  = (flags & EB_BUFFERFLAG_EOS) ? APP_PortInactive : *port_state;
             return_value = (flags & EB_BUFFERFLAG_EOS) ? APP_ExitConditionFinished
                                                        : APP_ExitConditionNone;
-            // Release the output buffer
-            svt_av1_enc_release_out_buffer(&header_ptr);
+            // Release the output buffer, once written when the writer thread writes it
+            if (stream_file && config->output_writer)
+                app_output_writer_packet(
+                    config->output_writer, ivf_header, ivf_header_size, header_ptr);
+            else
+                svt_av1_enc_release_out_buffer(&header_ptr);
 
             if (flags & EB_BUFFERFLAG_EOS) {
                 if (config->config.rc_firstpass_stats_out) {
@@ -1229,6 +1284,28 @@ void process_output_stream_buffer(EncChannel *channel, EncApp *enc_app, int32_t
                         }
                     }
                 }
+                if (config->config.stage_balancing) {
+                    SvtAv1StageBalanceStats stage_balance;
+                    if (svt_av1_enc_get_stream_info(component_handle,
+                                                    SVT_AV1_STREAM_INFO_STAGE_BALANCE,
+                                                    &stage_balance) == EB_ErrorNone &&
+                        stage_balance.stage_count) {
+                        fprintf(stderr,
+                                "\nStage balancing: %u workers, %llu windows\n",
+                                stage_balance.worker_budget,
+                                (unsigned long long)stage_balance.window_count);
+                        for (uint32_t i = 0; i < stage_balance.stage_count; i++) {
+                            const SvtAv1StageBalance *stage = &stage_balance.stages[i];
+                            fprintf(stderr,
+                                    "%-28s active %2u/%-2u raised %llu lowered %llu\n",
+                                    stage->name,
+                                    stage->active_workers,
+                                    stage->max_workers,
+                                    (unsigned long long)stage->raise_count,
+                                    (unsigned long long)stage->lower_count);
+                        }
+                    }
+                }
             }
 
             ++*frame_count;
@@ -1293,6 +1370,14 @@ void process_output_recon_buffer(EncChannel *channel) {
         log_error_output(config->error_log_file, header_ptr->flags);
         channel->exit_cond_recon = APP_ExitConditionError;
         return;
+    } else if (recon_status != EB_NoErrorEmptyQueue && config->output_writer) {
+        // copied to the writer queue, written at the offset of its frame
+        app_output_writer_recon(config->output_writer,
+                                header_ptr->p_buffer,
+                                header_ptr->n_filled_len,
+                                header_ptr->pts * header_ptr->n_filled_len);
+        return_value = (header_ptr->flags & EB_BUFFERFLAG_EOS) ? APP_ExitConditionFinished
+                                                               : APP_ExitConditionNone;
     } else if (recon_status != EB_NoErrorEmptyQueue) {
         //Sets the File position to the beginning of the file.
         rewind(config->recon_file);
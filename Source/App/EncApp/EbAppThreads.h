@@ -0,0 +1,72 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#ifndef EbAppThreads_h
+#define EbAppThreads_h
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+/*********************************************************************
+ * Threads of the app: the input reader and the output writer each run
+ * one thread exchanging buffers with the encoding loop through a ring
+ * under a mutex and two condition variables.
+ *********************************************************************/
+#ifdef _WIN32
+typedef HANDLE             AppThread;
+typedef CRITICAL_SECTION   AppMutex;
+typedef CONDITION_VARIABLE AppCond;
+
+#define APP_THREAD_KERNEL(name, arg) static DWORD WINAPI name(LPVOID arg)
+
+static __inline void app_mutex_init(AppMutex *m) { InitializeCriticalSection(m); }
+static __inline void app_mutex_destroy(AppMutex *m) { DeleteCriticalSection(m); }
+static __inline void app_mutex_lock(AppMutex *m) { EnterCriticalSection(m); }
+static __inline void app_mutex_unlock(AppMutex *m) { LeaveCriticalSection(m); }
+static __inline void app_cond_init(AppCond *c) { InitializeConditionVariable(c); }
+static __inline void app_cond_destroy(AppCond *c) { (void)c; }
+static __inline void app_cond_wait(AppCond *c, AppMutex *m) {
+    SleepConditionVariableCS(c, m, INFINITE);
+}
+static __inline void app_cond_signal(AppCond *c) { WakeConditionVariable(c); }
+static __inline int  app_thread_create(AppThread *t, LPTHREAD_START_ROUTINE kernel, void *arg) {
+    *t = CreateThread(NULL, 0, kernel, arg, 0, NULL);
+    return *t ? 0 : -1;
+}
+static __inline void app_thread_join(AppThread t) {
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
+}
+#else
+typedef pthread_t       AppThread;
+typedef pthread_mutex_t AppMutex;
+typedef pthread_cond_t  AppCond;
+
+#define APP_THREAD_KERNEL(name, arg) static void *name(void *arg)
+
+static __inline void app_mutex_init(AppMutex *m) { pthread_mutex_init(m, NULL); }
+static __inline void app_mutex_destroy(AppMutex *m) { pthread_mutex_destroy(m); }
+static __inline void app_mutex_lock(AppMutex *m) { pthread_mutex_lock(m); }
+static __inline void app_mutex_unlock(AppMutex *m) { pthread_mutex_unlock(m); }
+static __inline void app_cond_init(AppCond *c) { pthread_cond_init(c, NULL); }
+static __inline void app_cond_destroy(AppCond *c) { pthread_cond_destroy(c); }
+static __inline void app_cond_wait(AppCond *c, AppMutex *m) { pthread_cond_wait(c, m); }
+static __inline void app_cond_signal(AppCond *c) { pthread_cond_signal(c); }
+static __inline int  app_thread_create(AppThread *t, void *(*kernel)(void *), void *arg) {
+    return pthread_create(t, NULL, kernel, arg);
+}
+static __inline void app_thread_join(AppThread t) { pthread_join(t, NULL); }
+#endif
+
+#endif // EbAppThreads_h
@@ -0,0 +1,96 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#include "EbThreads.h"
+#include "EbUtility.h"
+#include "EbNuma.h"
+#include "EbArena.h"
+
+// The chunk header takes the first SVT_ARENA_ALIGN bytes of the chunk
+#define CHUNK_DATA(c) ((uint8_t *)(c) + SVT_ARENA_ALIGN)
+
+static SVT_THREAD_LOCAL EbArena *alloc_arena;
+
+EbArena *svt_set_alloc_arena(EbArena *arena) {
+    EbArena *prev = alloc_arena;
+    alloc_arena   = arena;
+    return prev;
+}
+
+EbArena *svt_get_alloc_arena(void) { return alloc_arena; }
+
+static void svt_arena_dctor(EbPtr p) {
+    EbArena *     obj   = (EbArena *)p;
+    EbArenaChunk *chunk = obj->head;
+    while (chunk) {
+        EbArenaChunk *next = chunk->next;
+        svt_large_page_free(chunk);
+        chunk = next;
+    }
+}
+
+EbErrorType svt_arena_ctor(EbArena *arena, size_t chunk_size) {
+    arena->dctor       = svt_arena_dctor;
+    arena->chunk_size  = chunk_size;
+    arena->large_pages = svt_get_large_pages();
+    arena->numa_node   = svt_numa_get_alloc_node();
+    arena->tag         = svt_mem_get_tag();
+    return EB_ErrorNone;
+}
+
+static EbArenaChunk *arena_chunk_new(EbArena *arena, size_t size) {
+    const size_t          bytes = SVT_ARENA_ALIGN + MAX(arena->chunk_size, size);
+    const SvtAv1MemoryTag tag   = svt_mem_set_tag(arena->tag);
+    EbArenaChunk *        chunk = (EbArenaChunk *)svt_large_page_malloc(bytes, arena->large_pages);
+    svt_mem_set_tag(tag);
+    if (!chunk)
+        return NULL;
+    svt_numa_bind(chunk, bytes, arena->numa_node);
+    chunk->next = NULL;
+    chunk->end  = (uint8_t *)chunk + bytes;
+    return chunk;
+}
+
+void *svt_arena_alloc(EbArena *arena, size_t size) {
+    size = (size + SVT_ARENA_ALIGN - 1) & ~(size_t)(SVT_ARENA_ALIGN - 1);
+    if (!arena->chunk || (size_t)(arena->chunk->end - arena->cur) < size) {
+        // Reuse the chunk kept by a rewind, or insert a new one after the current
+        EbArenaChunk *next = arena->chunk ? arena->chunk->next : arena->head;
+        if (!next || (size_t)(next->end - CHUNK_DATA(next)) < size) {
+            EbArenaChunk *chunk = arena_chunk_new(arena, size);
+            if (!chunk)
+                return NULL;
+            chunk->next = next;
+            if (arena->chunk)
+                arena->chunk->next = chunk;
+            else
+                arena->head = chunk;
+            next = chunk;
+        }
+        arena->chunk = next;
+        arena->cur   = CHUNK_DATA(next);
+    }
+    void *block = arena->cur;
+    arena->cur += size;
+    return block;
+}
+
+EbArenaMark svt_arena_mark(const EbArena *arena) {
+    EbArenaMark mark;
+    mark.chunk = arena->chunk;
+    mark.cur   = arena->cur;
+    return mark;
+}
+
+void svt_arena_rewind(EbArena *arena, EbArenaMark mark) {
+    arena->chunk = mark.chunk;
+    arena->cur   = mark.cur;
+}
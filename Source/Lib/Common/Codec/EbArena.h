@@ -0,0 +1,75 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#ifndef EbArena_h
+#define EbArena_h
+
+#include "EbDefinitions.h"
+#include "EbObject.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Default chunk size, one large page */
+#define SVT_ARENA_CHUNK_SIZE SVT_LARGE_PAGE_SIZE
+/* Alignment of the blocks, one cache line */
+#define SVT_ARENA_ALIGN 64
+
+typedef struct EbArenaChunk {
+    struct EbArenaChunk *next;
+    uint8_t *            end;
+} EbArenaChunk;
+
+/* Position of an arena, see svt_arena_rewind */
+typedef struct EbArenaMark {
+    EbArenaChunk *chunk;
+    uint8_t *     cur;
+} EbArenaMark;
+
+/*********************************************************************
+ * Arena
+ *   Bump allocator carving SVT_ARENA_ALIGN aligned blocks, in allocation
+ *   order, out of a list of large chunks. Blocks are not freed one by
+ *   one: the dctor releases the chunks, svt_arena_rewind gives back
+ *   everything allocated after a mark and keeps the chunks for reuse.
+ *   An arena is used by one thread at a time.
+ *********************************************************************/
+typedef struct EbArena {
+    EbDctor         dctor;
+    EbArenaChunk *  head;
+    EbArenaChunk *  chunk; // chunk being carved, NULL before the first block
+    uint8_t *       cur;
+    size_t          chunk_size;
+    EbLargePages    large_pages; // of the allocating thread at ctor time
+    int32_t         numa_node; // of the allocating thread at ctor time
+    SvtAv1MemoryTag tag; // of the allocating thread at ctor time
+} EbArena;
+
+extern EbErrorType svt_arena_ctor(EbArena *arena, size_t chunk_size);
+
+/* Uninitialized block of size bytes, NULL when a chunk can't be allocated */
+extern void *svt_arena_alloc(EbArena *arena, size_t size);
+
+extern EbArenaMark svt_arena_mark(const EbArena *arena);
+
+/* Frees the blocks allocated after mark in O(1) */
+extern void svt_arena_rewind(EbArena *arena, EbArenaMark mark);
+
+/* Arena the picture buffers allocated by the calling thread are carved
+ * from, NULL (the heap) by default. Returns the previous arena. */
+extern EbArena *svt_set_alloc_arena(EbArena *arena);
+extern EbArena *svt_get_alloc_arena(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // EbArena_h
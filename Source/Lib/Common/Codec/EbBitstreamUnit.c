@@ -31,6 +31,7 @@ static void output_bitstream_unit_dctor(EbPtr p) {
  **********************************/
 EbErrorType output_bitstream_unit_ctor(OutputBitstreamUnit *bitstream_ptr, uint32_t buffer_size) {
     bitstream_ptr->dctor = output_bitstream_unit_dctor;
+    svt_mem_set_tag(SVT_AV1_MEM_TAG_BITSTREAM);
     if (buffer_size) {
         bitstream_ptr->size = buffer_size;
         EB_MALLOC_ARRAY(bitstream_ptr->buffer_begin_av1, bitstream_ptr->size);
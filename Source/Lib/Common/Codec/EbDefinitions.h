@@ -1940,12 +1940,6 @@ static const EbWarpedMotionParams default_warp_params = {
 
 #define MAX_BITS_PER_FRAME            8000000
 
-#define SC_FRAMES_TO_IGNORE     1000 // The speed control algorith starts after SC_FRAMES_TO_IGNORE number frames.
-#define SC_FRAMES_INTERVAL_SPEED      60 // The speed control Interval To Check the speed
-#define SC_FRAMES_INTERVAL_T1         60 // The speed control Interval Threshold1
-#define SC_FRAMES_INTERVAL_T2        180 // The speed control Interval Threshold2
-#define SC_FRAMES_INTERVAL_T3        120 // The speed control Interval Threshold3
-
 #define LAST_BWD_FRAME     8
 #define LAST_ALT_FRAME    16
 
@@ -2119,7 +2113,6 @@ typedef enum EbIntraRefreshType
 
 #define MAX_SUPPORTED_MODES 13
 
-#define SPEED_CONTROL_INIT_MOD ENC_M4;
 /** The EB_TUID type is used to identify a TU within a CU.
 */
 typedef enum EbTuSize
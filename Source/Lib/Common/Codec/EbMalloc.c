@@ -8,11 +8,16 @@
 * Media Patent License 1.0 was not distributed with this source code in the
 * PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
 */
+#include <assert.h>
 #include <stdint.h>
 #include <limits.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
 
 #include "EbMalloc.h"
 #include "EbThreads.h"
+#include "EbNuma.h"
 #define LOG_TAG "SvtMalloc"
 #include "EbLog.h"
 
@@ -343,3 +348,312 @@ void svt_remove_mem_entry(void* ptr, EbPtrType type) {
     }
 }
 #endif
+
+#if SVT_MEM_TRACKING
+// Large blocks go to the node hinted by the allocating thread, e.g. the
+// contexts of a stage to the node its threads run on. svt_mem_free unbinds
+// them with the size of the header.
+static void* mem_place(void* ptr, size_t size) {
+    svt_numa_bind(ptr, size, svt_numa_get_alloc_node());
+    return ptr;
+}
+
+/* Tagged accounting. Each block of svt_mem_* starts with a MemHeader right
+ * before the returned pointer, so a free finds the size and the tag without
+ * a lookup. The counters are striped per thread, the peaks are sampled. */
+#define MEM_MAGIC 0x5356544du
+#define MEM_STRIPES 16
+
+typedef enum MemKind { MEM_HEAP, MEM_ALIGNED, MEM_LARGE_PAGES } MemKind;
+
+typedef struct MemHeader {
+    uint64_t size;
+    uint16_t tag;
+    uint16_t kind;
+    uint32_t check; // MEM_MAGIC ^ size, to catch the blocks of other allocators in debug builds
+} MemHeader;
+
+// Monotonic counters, live = allocated - freed summed over the stripes
+typedef struct MemStripe {
+    volatile uint64_t allocated[SVT_AV1_MEM_TAG_COUNT];
+    volatile uint64_t freed[SVT_AV1_MEM_TAG_COUNT];
+} MemStripe;
+
+DECLARE_ALIGNED(64, static MemStripe, mem_stripes[MEM_STRIPES]);
+static volatile uint64_t           mem_peak[SVT_AV1_MEM_TAG_COUNT + 1];
+static volatile uint32_t           mem_next_stripe;
+static SVT_THREAD_LOCAL MemStripe* mem_stripe;
+static SVT_THREAD_LOCAL uint32_t   mem_tag = SVT_AV1_MEM_TAG_OTHER;
+
+SvtAv1MemoryTag svt_mem_set_tag(SvtAv1MemoryTag tag) {
+    const SvtAv1MemoryTag prev = (SvtAv1MemoryTag)mem_tag;
+    mem_tag                    = tag;
+    return prev;
+}
+
+SvtAv1MemoryTag svt_mem_get_tag(void) { return (SvtAv1MemoryTag)mem_tag; }
+
+// Threads are given the stripes in turn at their first allocation or free
+static MemStripe* mem_thread_stripe(void) {
+    if (!mem_stripe)
+        mem_stripe = &mem_stripes[svt_atomic_fetch_add_u32(&mem_next_stripe, 1) % MEM_STRIPES];
+    return mem_stripe;
+}
+
+static uint64_t mem_live(uint32_t tag) {
+    uint64_t allocated = 0, freed = 0;
+    // freed first: a concurrent free can not make the result negative
+    for (int i = 0; i < MEM_STRIPES; i++) freed += svt_atomic_load_u64(&mem_stripes[i].freed[tag]);
+    for (int i = 0; i < MEM_STRIPES; i++)
+        allocated += svt_atomic_load_u64(&mem_stripes[i].allocated[tag]);
+    return allocated > freed ? allocated - freed : 0;
+}
+
+static void mem_raise_peak(uint32_t index, uint64_t live) {
+    uint64_t peak = svt_atomic_load_u64(&mem_peak[index]);
+    while (live > peak && !svt_atomic_cas_u64(&mem_peak[index], peak, live))
+        peak = svt_atomic_load_u64(&mem_peak[index]);
+}
+
+void svt_mem_sample_peak(void) {
+    uint64_t total = 0;
+    for (uint32_t tag = 0; tag < SVT_AV1_MEM_TAG_COUNT; tag++) {
+        const uint64_t live = mem_live(tag);
+        mem_raise_peak(tag, live);
+        total += live;
+    }
+    mem_raise_peak(SVT_AV1_MEM_TAG_COUNT, total);
+}
+
+// Header and counters of a new block, returns the buffer at offset bytes from base
+static void* mem_track(void* base, size_t offset, size_t size, MemKind kind, uint32_t tag) {
+    if (!base)
+        return NULL;
+    uint8_t* const ptr = (uint8_t*)base + offset;
+    MemHeader*     h   = (MemHeader*)ptr - 1;
+    h->size      = size;
+    h->tag       = (uint16_t)tag;
+    h->kind      = (uint16_t)kind;
+    h->check     = MEM_MAGIC ^ (uint32_t)size;
+    svt_atomic_fetch_add_u64(&mem_thread_stripe()->allocated[tag], size);
+    return ptr;
+}
+
+// Header of a block of svt_mem_*, the only blocks svt_mem_free and svt_mem_realloc take
+static MemHeader* mem_header(void* ptr) {
+    MemHeader* h = (MemHeader*)ptr - 1;
+    assert(h->check == (MEM_MAGIC ^ (uint32_t)h->size));
+    return h;
+}
+
+static void mem_untrack(MemHeader* h) {
+    svt_atomic_fetch_add_u64(&mem_thread_stripe()->freed[h->tag], h->size);
+    h->check = 0;
+}
+
+void* svt_mem_malloc(size_t size) {
+    void* base = malloc(size + sizeof(MemHeader));
+    return mem_place(mem_track(base, sizeof(MemHeader), size, MEM_HEAP, mem_tag), size);
+}
+
+void* svt_mem_calloc(size_t count, size_t size) {
+    if (size && count > (SIZE_MAX - sizeof(MemHeader)) / size)
+        return NULL;
+    void* base = calloc(1, count * size + sizeof(MemHeader));
+    return mem_place(mem_track(base, sizeof(MemHeader), count * size, MEM_HEAP, mem_tag),
+                     count * size);
+}
+
+void* svt_mem_aligned_malloc(size_t size) {
+    void* base;
+#ifdef _WIN32
+    base = _aligned_malloc(size + ALVALUE, ALVALUE);
+#else
+    if (posix_memalign(&base, ALVALUE, size + ALVALUE) != 0)
+        base = NULL;
+#endif
+    return mem_place(mem_track(base, ALVALUE, size, MEM_ALIGNED, mem_tag), size);
+}
+
+void* svt_mem_realloc(void* ptr, size_t size) {
+    if (!ptr)
+        return svt_mem_malloc(size);
+    MemHeader* h = mem_header(ptr);
+    if (h->kind != MEM_HEAP) {
+        void* p = svt_mem_malloc(size);
+        if (p) {
+            memcpy(p, ptr, size < h->size ? size : (size_t)h->size);
+            svt_mem_free(ptr, EB_A_PTR);
+        }
+        return p;
+    }
+    MemHeader      old  = *h;
+    void* const    base = realloc(h, size + sizeof(MemHeader));
+    if (!base)
+        return NULL;
+    // the block keeps its tag
+    mem_untrack(&old);
+    return mem_track(base, sizeof(MemHeader), size, MEM_HEAP, old.tag);
+}
+
+static void large_page_release(void* ptr);
+
+void svt_mem_free(void* ptr, EbPtrType type) {
+    (void)type;
+    if (!ptr)
+        return;
+    MemHeader*    h    = mem_header(ptr);
+    const MemKind kind = (MemKind)h->kind;
+    if (kind != MEM_LARGE_PAGES)
+        svt_numa_unbind(ptr, (size_t)h->size);
+    mem_untrack(h);
+    if (kind == MEM_HEAP)
+        free(h);
+    else if (kind == MEM_ALIGNED)
+#ifdef _WIN32
+        _aligned_free((uint8_t*)ptr - ALVALUE);
+#else
+        free((uint8_t*)ptr - ALVALUE);
+#endif
+    else
+        large_page_release(ptr);
+}
+
+EbErrorType svt_mem_get_usage(SvtAv1MemoryUsage* usage) {
+    svt_mem_sample_peak();
+    usage->live_total = 0;
+    for (uint32_t tag = 0; tag < SVT_AV1_MEM_TAG_COUNT; tag++) {
+        usage->live_bytes[tag] = mem_live(tag);
+        usage->peak_bytes[tag] = svt_atomic_load_u64(&mem_peak[tag]);
+        usage->live_total += usage->live_bytes[tag];
+    }
+    usage->peak_total = svt_atomic_load_u64(&mem_peak[SVT_AV1_MEM_TAG_COUNT]);
+    // the frees between the sample and the reads lower the live bytes only
+    return EB_ErrorNone;
+}
+#else
+/* Without tracking the blocks come straight from the C library. Their size
+ * is not known at free, so they are not placed on a NUMA node. */
+SvtAv1MemoryTag svt_mem_set_tag(SvtAv1MemoryTag tag) { return tag; }
+
+SvtAv1MemoryTag svt_mem_get_tag(void) { return SVT_AV1_MEM_TAG_OTHER; }
+
+void svt_mem_sample_peak(void) {}
+
+void* svt_mem_malloc(size_t size) { return malloc(size); }
+
+void* svt_mem_calloc(size_t count, size_t size) {
+    return calloc(count, size);
+}
+
+void* svt_mem_aligned_malloc(size_t size) {
+    void* ptr;
+#ifdef _WIN32
+    ptr = _aligned_malloc(size, ALVALUE);
+#else
+    if (posix_memalign(&ptr, ALVALUE, size) != 0)
+        ptr = NULL;
+#endif
+    return ptr;
+}
+
+void* svt_mem_realloc(void* ptr, size_t size) { return realloc(ptr, size); }
+
+void svt_mem_free(void* ptr, EbPtrType type) {
+#ifdef _WIN32
+    if (type == EB_A_PTR) {
+        _aligned_free(ptr);
+        return;
+    }
+#else
+    (void)type;
+#endif
+    free(ptr);
+}
+
+EbErrorType svt_mem_get_usage(SvtAv1MemoryUsage* usage) {
+    (void)usage;
+    return EB_ErrorBadParameter;
+}
+
+#define mem_track(base, offset, size, kind, tag) \
+    ((base) ? (void*)((uint8_t*)(base) + (offset)) : NULL)
+#endif // SVT_MEM_TRACKING
+
+static SVT_THREAD_LOCAL EbLargePages large_pages = SVT_LARGE_PAGES_OFF;
+
+void svt_set_large_pages(EbLargePages mode) { large_pages = mode; }
+
+EbLargePages svt_get_large_pages(void) { return large_pages; }
+
+/* Kept in the ALVALUE bytes before the buffer, with the MemHeader, the
+ * buffer stays ALVALUE aligned */
+typedef struct LargePageHeader {
+    size_t map_size; // length of the MAP_HUGETLB mapping, 0 for the heap
+    size_t size; // of the buffer, for svt_numa_unbind
+} LargePageHeader;
+
+void* svt_large_page_malloc(size_t size, EbLargePages mode) {
+    void*  base = NULL;
+    size_t total = size + ALVALUE;
+    size_t map_size = 0;
+#ifdef __linux__
+    if (mode == SVT_LARGE_PAGES_HUGETLB && size >= SVT_LARGE_PAGE_SIZE) {
+        map_size = (total + SVT_LARGE_PAGE_SIZE - 1) & ~(SVT_LARGE_PAGE_SIZE - 1);
+        base = mmap(NULL, map_size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base == MAP_FAILED) {
+            base = NULL;
+            map_size = 0;
+        }
+    }
+    if (!base && mode != SVT_LARGE_PAGES_OFF && size >= SVT_LARGE_PAGE_SIZE) {
+        if (posix_memalign(&base, SVT_LARGE_PAGE_SIZE, total) != 0)
+            return NULL;
+        madvise(base, total, MADV_HUGEPAGE);
+    }
+#else
+    (void)mode;
+#endif
+    if (!base) {
+#ifdef _WIN32
+        base = _aligned_malloc(total, ALVALUE);
+#else
+        if (posix_memalign(&base, ALVALUE, total) != 0)
+            base = NULL;
+#endif
+        if (!base)
+            return NULL;
+    }
+    ((LargePageHeader*)base)->map_size = map_size;
+    ((LargePageHeader*)base)->size     = size;
+    return mem_track(base, ALVALUE, size, MEM_LARGE_PAGES, mem_tag);
+}
+
+static void large_page_release(void* ptr) {
+    void* base = (uint8_t*)ptr - ALVALUE;
+#ifdef __linux__
+    if (((LargePageHeader*)base)->map_size) {
+        munmap(base, ((LargePageHeader*)base)->map_size);
+        return;
+    }
+#endif
+    // The pages of the heap block are reused by other blocks
+    svt_numa_unbind(ptr, ((LargePageHeader*)base)->size);
+#ifdef _WIN32
+    _aligned_free(base);
+#else
+    free(base);
+#endif
+}
+
+void svt_large_page_free(void* ptr) {
+    if (!ptr)
+        return;
+#if SVT_MEM_TRACKING
+    MemHeader* h = mem_header(ptr);
+    assert(h->kind == MEM_LARGE_PAGES);
+    mem_untrack(h);
+#endif
+    large_page_release(ptr);
+}
@@ -16,12 +16,41 @@
 #include "EbSvtAv1Enc.h"
 #include "EbDefinitions.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #ifndef NDEBUG
 #define DEBUG_MEMORY_USAGE
 #endif
 
+/* Accounting of the allocations per tag, on unless the build sets
+ * SVT_MEM_TRACKING=0 (ENABLE_MEMORY_TRACKING=OFF in CMake) */
+#ifndef SVT_MEM_TRACKING
+#define SVT_MEM_TRACKING 1
+#endif
+
 void svt_print_alloc_fail(const char* file, int line);
 
+/* Allocations accounted to the tag of the calling thread. The blocks must
+ * be released with svt_mem_free and resized with svt_mem_realloc, which
+ * take no other blocks; type tells the aligned ones. */
+void* svt_mem_malloc(size_t size);
+void* svt_mem_calloc(size_t count, size_t size);
+void* svt_mem_realloc(void* ptr, size_t size);
+void* svt_mem_aligned_malloc(size_t size);
+void  svt_mem_free(void* ptr, EbPtrType type);
+
+/* Tag the following allocations of the calling thread are accounted to,
+ * SVT_AV1_MEM_TAG_OTHER by default. Returns the previous tag. */
+SvtAv1MemoryTag svt_mem_set_tag(SvtAv1MemoryTag tag);
+SvtAv1MemoryTag svt_mem_get_tag(void);
+/* Raises the peaks to the live bytes. The allocations do not, the peaks
+ * are the highest live bytes of the calls. */
+void svt_mem_sample_peak(void);
+/* EB_ErrorBadParameter when the build does not track the allocations */
+EbErrorType svt_mem_get_usage(SvtAv1MemoryUsage* usage);
+
 #ifdef DEBUG_MEMORY_USAGE
 void svt_print_memory_usage(void);
 void svt_increase_component_count(void);
@@ -74,7 +103,7 @@ void svt_remove_mem_entry(void* ptr, EbPtrType type);
 
 #define EB_NO_THROW_MALLOC(pointer, size)                \
     do {                                                 \
-        void* malloced_p = malloc(size);                 \
+        void* malloced_p = svt_mem_malloc(size);         \
         EB_NO_THROW_ADD_MEM(malloced_p, size, EB_N_PTR); \
         pointer = malloced_p;                            \
     } while (0)
@@ -87,7 +116,7 @@ void svt_remove_mem_entry(void* ptr, EbPtrType type);
 
 #define EB_NO_THROW_CALLOC(pointer, count, size)             \
     do {                                                     \
-        pointer = calloc(count, size);                       \
+        pointer = svt_mem_calloc(count, size);               \
         EB_NO_THROW_ADD_MEM(pointer, count* size, EB_C_PTR); \
     } while (0)
 
@@ -100,22 +129,22 @@ void svt_remove_mem_entry(void* ptr, EbPtrType type);
 #define EB_FREE(pointer)                        \
     do {                                        \
         EB_REMOVE_MEM_ENTRY(pointer, EB_N_PTR); \
-        free(pointer);                          \
+        svt_mem_free(pointer, EB_N_PTR);        \
         pointer = NULL;                         \
     } while (0)
 
 #define EB_MALLOC_ARRAY(pa, count) \
     do { EB_MALLOC(pa, sizeof(*(pa)) * (count)); } while (0)
 
-#define EB_REALLOC_ARRAY(pa, count)            \
-    do {                                       \
-        size_t size = sizeof(*(pa)) * (count); \
-        void*  p    = realloc(pa, size);       \
-        if (p) {                               \
-            EB_REMOVE_MEM_ENTRY(pa, EB_N_PTR); \
-        }                                      \
-        EB_ADD_MEM(p, size, EB_N_PTR);         \
-        pa = p;                                \
+#define EB_REALLOC_ARRAY(pa, count)              \
+    do {                                         \
+        size_t size = sizeof(*(pa)) * (count);   \
+        void*  p    = svt_mem_realloc(pa, size); \
+        if (p) {                                 \
+            EB_REMOVE_MEM_ENTRY(pa, EB_N_PTR);   \
+        }                                        \
+        EB_ADD_MEM(p, size, EB_N_PTR);           \
+        pa = p;                                  \
     } while (0)
 
 #define EB_CALLOC_ARRAY(pa, count) \
@@ -155,34 +184,18 @@ void svt_remove_mem_entry(void* ptr, EbPtrType type);
         EB_FREE_ARRAY(p2d);        \
     } while (0)
 
-#ifdef _WIN32
-#define EB_MALLOC_ALIGNED(pointer, size)          \
-    do {                                          \
-        pointer = _aligned_malloc(size, ALVALUE); \
-        EB_ADD_MEM(pointer, size, EB_A_PTR);      \
-    } while (0)
-
-#define EB_FREE_ALIGNED(pointer)                \
+#define EB_MALLOC_ALIGNED(pointer, size)        \
     do {                                        \
-        EB_REMOVE_MEM_ENTRY(pointer, EB_A_PTR); \
-        _aligned_free(pointer);                 \
-        pointer = NULL;                         \
-    } while (0)
-#else
-#define EB_MALLOC_ALIGNED(pointer, size)                            \
-    do {                                                            \
-        if (posix_memalign((void**)&(pointer), ALVALUE, size) != 0) \
-            return EB_ErrorInsufficientResources;                   \
-        EB_ADD_MEM(pointer, size, EB_A_PTR);                        \
+        pointer = svt_mem_aligned_malloc(size); \
+        EB_ADD_MEM(pointer, size, EB_A_PTR);    \
     } while (0)
 
 #define EB_FREE_ALIGNED(pointer)                \
     do {                                        \
         EB_REMOVE_MEM_ENTRY(pointer, EB_A_PTR); \
-        free(pointer);                          \
+        svt_mem_free(pointer, EB_A_PTR);        \
         pointer = NULL;                         \
     } while (0)
-#endif
 
 #define EB_MALLOC_ALIGNED_ARRAY(pa, count) EB_MALLOC_ALIGNED(pa, sizeof(*(pa)) * (count))
 
@@ -194,4 +207,40 @@ void svt_remove_mem_entry(void* ptr, EbPtrType type);
 
 #define EB_FREE_ALIGNED_ARRAY(pa) EB_FREE_ALIGNED(pa)
 
+/* Large page backing of the picture buffers, Linux only */
+#define SVT_LARGE_PAGE_SIZE ((size_t)2 << 20)
+
+typedef enum EbLargePages {
+    SVT_LARGE_PAGES_OFF     = 0, // regular pages
+    SVT_LARGE_PAGES_THP     = 1, // 2 MiB aligned, madvise(MADV_HUGEPAGE)
+    SVT_LARGE_PAGES_HUGETLB = 2, // MAP_HUGETLB, SVT_LARGE_PAGES_THP when no huge page is free
+} EbLargePages;
+
+/* Large page mode of the picture buffers allocated by the calling thread,
+ * SVT_LARGE_PAGES_OFF by default */
+void         svt_set_large_pages(EbLargePages mode);
+EbLargePages svt_get_large_pages(void);
+
+/* ALVALUE aligned allocation in large pages. Allocations smaller than
+ * SVT_LARGE_PAGE_SIZE and SVT_LARGE_PAGES_OFF use regular pages. Must be
+ * released with svt_large_page_free, returns NULL on failure. */
+void* svt_large_page_malloc(size_t size, EbLargePages mode);
+void  svt_large_page_free(void* ptr);
+
+#define EB_MALLOC_LARGE_PAGES(pointer, size, mode)         \
+    do {                                                   \
+        pointer = svt_large_page_malloc(size, mode);       \
+        EB_ADD_MEM(pointer, size, EB_A_PTR);               \
+    } while (0)
+
+#define EB_FREE_LARGE_PAGES(pointer)            \
+    do {                                        \
+        EB_REMOVE_MEM_ENTRY(pointer, EB_A_PTR); \
+        svt_large_page_free(pointer);           \
+        pointer = NULL;                         \
+    } while (0)
+
+#ifdef __cplusplus
+}
+#endif
 #endif //EbMalloc_h
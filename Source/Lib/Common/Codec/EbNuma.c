@@ -0,0 +1,165 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#include "EbThreads.h"
+#include "EbNuma.h"
+
+static SVT_THREAD_LOCAL int32_t alloc_node = SVT_NUMA_NODE_ANY;
+
+void svt_numa_set_alloc_node(int32_t node) { alloc_node = node; }
+
+int32_t svt_numa_get_alloc_node(void) { return alloc_node; }
+
+#if defined(__linux__) && HAVE_NUMA
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+// From linux/mempolicy.h, which is not always installed
+#define NUMA_MPOL_DEFAULT 0
+#define NUMA_MPOL_PREFERRED 1
+#define NUMA_MPOL_MF_MOVE (1 << 1)
+
+#define NUMA_MAX_NODES 64
+
+static pthread_once_t numa_once = PTHREAD_ONCE_INIT;
+static uint32_t       numa_count = 1;
+static uint32_t       numa_node_id[NUMA_MAX_NODES];
+static cpu_set_t      numa_node_cpus[NUMA_MAX_NODES];
+static uint32_t       numa_bound; // set once a range was bound, svt_numa_unbind has work
+
+/**************************************
+ * numa_read_list
+ *   Reads a sysfs list such as "0-3,8-11" and calls set for every
+ *   entry. Returns the number of entries.
+ **************************************/
+static uint32_t numa_read_list(const char *path, void (*set)(uint32_t, void *), void *data) {
+    char  line[4096];
+    FILE *fin = fopen(path, "r");
+    if (!fin)
+        return 0;
+    char *p = fgets(line, sizeof(line), fin);
+    fclose(fin);
+    if (!p)
+        return 0;
+    uint32_t count = 0;
+    while (*p >= '0' && *p <= '9') {
+        const uint32_t first = (uint32_t)strtoul(p, &p, 10);
+        uint32_t       last  = first;
+        if (*p == '-')
+            last = (uint32_t)strtoul(p + 1, &p, 10);
+        for (uint32_t i = first; i <= last; i++, count++) set(i, data);
+        if (*p == ',')
+            p++;
+    }
+    return count;
+}
+
+static void numa_set_node(uint32_t node_id, void *data) {
+    uint32_t *count = (uint32_t *)data;
+    if (*count < NUMA_MAX_NODES)
+        numa_node_id[(*count)++] = node_id;
+}
+
+static void numa_set_cpu(uint32_t cpu, void *data) {
+    if (cpu < CPU_SETSIZE)
+        CPU_SET(cpu, (cpu_set_t *)data);
+}
+
+static void numa_init(void) {
+    char     path[128];
+    uint32_t count = 0;
+    numa_read_list("/sys/devices/system/node/online", numa_set_node, &count);
+    for (uint32_t i = 0; i < count; i++) {
+        CPU_ZERO(&numa_node_cpus[i]);
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", numa_node_id[i]);
+        numa_read_list(path, numa_set_cpu, &numa_node_cpus[i]);
+    }
+    // The node mask of mbind covers NUMA_MAX_NODES ids
+    for (uint32_t i = 0; i < count; i++)
+        if (numa_node_id[i] >= NUMA_MAX_NODES)
+            count = 0;
+    numa_count = count > 1 ? count : 1;
+}
+
+uint32_t svt_numa_node_count(void) {
+    pthread_once(&numa_once, numa_init);
+    return numa_count;
+}
+
+// Whole pages of [ptr, ptr + size): the pages it shares with its neighbours
+// are left alone. Returns EB_FALSE when there are none.
+static EbBool numa_page_range(void *ptr, size_t size, uintptr_t *start, uintptr_t *end) {
+    const uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+    *start                    = ((uintptr_t)ptr + page_size - 1) & ~(page_size - 1);
+    *end                      = ((uintptr_t)ptr + size) & ~(page_size - 1);
+    return *end > *start;
+}
+
+void svt_numa_bind(void *ptr, size_t size, int32_t node) {
+    uintptr_t start, end;
+    if (!ptr || node < 0 || size < NUMA_MIN_BIND_SIZE || svt_numa_node_count() < 2 ||
+        !numa_page_range(ptr, size, &start, &end))
+        return;
+    const uint32_t mask_bits = 8 * sizeof(unsigned long);
+    const uint32_t node_id   = numa_node_id[(uint32_t)node % numa_count];
+    unsigned long  node_mask[NUMA_MAX_NODES / (8 * sizeof(unsigned long))] = {0};
+
+    node_mask[node_id / mask_bits] |= 1UL << (node_id % mask_bits);
+    svt_atomic_store_u32(&numa_bound, 1);
+    // On failure, e.g. without CAP_SYS_NICE for shared pages, the pages stay on first touch
+    syscall(SYS_mbind,
+            (void *)start,
+            (unsigned long)(end - start),
+            NUMA_MPOL_PREFERRED,
+            node_mask,
+            (unsigned long)NUMA_MAX_NODES + 1,
+            NUMA_MPOL_MF_MOVE);
+}
+
+void svt_numa_unbind(void *ptr, size_t size) {
+    uintptr_t start, end;
+    if (!ptr || size < NUMA_MIN_BIND_SIZE || !svt_atomic_load_u32(&numa_bound) ||
+        !numa_page_range(ptr, size, &start, &end))
+        return;
+    syscall(SYS_mbind, (void *)start, (unsigned long)(end - start), NUMA_MPOL_DEFAULT, NULL, 0, 0);
+}
+
+void svt_numa_bind_thread(EbHandle thread_handle, int32_t node) {
+    if (!thread_handle || node < 0 || svt_numa_node_count() < 2)
+        return;
+    pthread_setaffinity_np(*((pthread_t *)thread_handle),
+                           sizeof(cpu_set_t),
+                           &numa_node_cpus[(uint32_t)node % numa_count]);
+}
+
+#else
+
+uint32_t svt_numa_node_count(void) { return 1; }
+
+void svt_numa_bind(void *ptr, size_t size, int32_t node) {
+    (void)ptr;
+    (void)size;
+    (void)node;
+}
+
+void svt_numa_unbind(void *ptr, size_t size) {
+    (void)ptr;
+    (void)size;
+}
+
+void svt_numa_bind_thread(EbHandle thread_handle, int32_t node) {
+    (void)thread_handle;
+    (void)node;
+}
+
+#endif
@@ -0,0 +1,57 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#ifndef EbNuma_h
+#define EbNuma_h
+
+#include "EbDefinitions.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Allocation node hints */
+#define SVT_NUMA_NODE_ANY -1 // no placement, first touch
+#define SVT_NUMA_NODE_INTERLEAVE -2 // objects of a pool spread over the nodes
+
+/* Allocations smaller than this are left to first touch */
+#define NUMA_MIN_BIND_SIZE (64 * 1024)
+
+/*********************************************************************
+ * NUMA placement
+ *   Nodes are numbered 0 to svt_numa_node_count() - 1 over the online
+ *   nodes. Without NUMA support (HAVE_NUMA, Linux only) there is one
+ *   node and placement does nothing.
+ *********************************************************************/
+extern uint32_t svt_numa_node_count(void);
+
+/* Prefers node for the whole pages of [ptr, ptr + size), the edge pages
+ * shared with other blocks are left alone; pages already touched move.
+ * Does nothing for SVT_NUMA_NODE_ANY, small sizes or one node. The owner
+ * calls svt_numa_unbind before the block goes back to the allocator. */
+extern void svt_numa_bind(void *ptr, size_t size, int32_t node);
+
+/* Gives the pages bound by svt_numa_bind back the default policy */
+extern void svt_numa_unbind(void *ptr, size_t size);
+
+/* Runs thread_handle on the logical processors of node */
+extern void svt_numa_bind_thread(EbHandle thread_handle, int32_t node);
+
+/* Node hint of the allocations of the calling thread, SVT_NUMA_NODE_ANY
+ * by default. The system resource manager resolves
+ * SVT_NUMA_NODE_INTERLEAVE per object. */
+extern void    svt_numa_set_alloc_node(int32_t node);
+extern int32_t svt_numa_get_alloc_node(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // EbNuma_h
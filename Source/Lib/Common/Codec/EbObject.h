@@ -55,28 +55,33 @@ typedef void (*EbDctor)(void* pobj);
 //trick: to support zero param constructor
 #define EB_VA_ARGS(...) , ##__VA_ARGS__
 
-#define EB_NO_THROW_NEW(pobj, ctor, ...)              \
-    do {                                              \
-        EbErrorType err;                              \
-        size_t      size = sizeof(*pobj);             \
-        EB_NO_THROW_CALLOC(pobj, 1, size);            \
-        if (pobj) {                                   \
-            err = ctor(pobj EB_VA_ARGS(__VA_ARGS__)); \
-            if (err != EB_ErrorNone)                  \
-                EB_DELETE_UNCHECKED(pobj);            \
-        }                                             \
+// A ctor may call svt_mem_set_tag, the tag is restored once it returns
+#define EB_NO_THROW_NEW(pobj, ctor, ...)                      \
+    do {                                                      \
+        EbErrorType           err;                            \
+        size_t                size       = sizeof(*pobj);     \
+        const SvtAv1MemoryTag eb_new_tag = svt_mem_get_tag(); \
+        EB_NO_THROW_CALLOC(pobj, 1, size);                    \
+        if (pobj) {                                           \
+            err = ctor(pobj EB_VA_ARGS(__VA_ARGS__));         \
+            svt_mem_set_tag(eb_new_tag);                      \
+            if (err != EB_ErrorNone)                          \
+                EB_DELETE_UNCHECKED(pobj);                    \
+        }                                                     \
     } while (0)
 
-#define EB_NEW(pobj, ctor, ...)                   \
-    do {                                          \
-        EbErrorType err;                          \
-        size_t      size = sizeof(*pobj);         \
-        EB_CALLOC(pobj, 1, size);                 \
-        err = ctor(pobj EB_VA_ARGS(__VA_ARGS__)); \
-        if (err != EB_ErrorNone) {                \
-            EB_DELETE_UNCHECKED(pobj);            \
-            return err;                           \
-        }                                         \
+#define EB_NEW(pobj, ctor, ...)                               \
+    do {                                                      \
+        EbErrorType           err;                            \
+        size_t                size       = sizeof(*pobj);     \
+        const SvtAv1MemoryTag eb_new_tag = svt_mem_get_tag(); \
+        EB_CALLOC(pobj, 1, size);                             \
+        err = ctor(pobj EB_VA_ARGS(__VA_ARGS__));             \
+        svt_mem_set_tag(eb_new_tag);                          \
+        if (err != EB_ErrorNone) {                            \
+            EB_DELETE_UNCHECKED(pobj);                        \
+            return err;                                       \
+        }                                                     \
     } while (0)
 
 #define EB_DELETE(pobj)                \
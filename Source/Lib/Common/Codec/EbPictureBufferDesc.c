@@ -13,19 +13,57 @@
 #include <stdlib.h>
 
 #include "EbPictureBufferDesc.h"
+#include "EbNuma.h"
+#include "EbArena.h"
+
+// Zeroed picture buffer, on the node hinted by the allocating thread as
+// every svt_mem_* block
+#define PICTURE_BUFFER_CALLOC(pa, count)                \
+    do {                                                \
+        EB_MALLOC_ALIGNED(pa, sizeof(*(pa)) * (count)); \
+        memset(pa, 0, sizeof(*(pa)) * (count));         \
+    } while (0)
+
+// Same as PICTURE_BUFFER_CALLOC, carved from the arena or in the large pages
+// selected for the descriptor
+#define PICTURE_PLANE_CALLOC(desc, pa, count)                                        \
+    do {                                                                             \
+        if ((desc)->arena) {                                                         \
+            pa = svt_arena_alloc((desc)->arena, sizeof(*(pa)) * (count));            \
+            if (!(pa))                                                               \
+                return EB_ErrorInsufficientResources;                                \
+            memset(pa, 0, sizeof(*(pa)) * (count));                                  \
+        } else if ((desc)->large_pages != SVT_LARGE_PAGES_OFF) {                     \
+            EB_MALLOC_LARGE_PAGES(pa, sizeof(*(pa)) * (count), (desc)->large_pages); \
+            svt_numa_bind(pa, sizeof(*(pa)) * (count), svt_numa_get_alloc_node());   \
+            memset(pa, 0, sizeof(*(pa)) * (count));                                  \
+        } else                                                                       \
+            PICTURE_BUFFER_CALLOC(pa, count);                                        \
+    } while (0)
+
+// The arena releases its blocks itself
+#define PICTURE_PLANE_FREE(desc, pa)                         \
+    do {                                                     \
+        if ((desc)->arena)                                   \
+            pa = NULL;                                       \
+        else if ((desc)->large_pages != SVT_LARGE_PAGES_OFF) \
+            EB_FREE_LARGE_PAGES(pa);                         \
+        else                                                 \
+            EB_FREE_ALIGNED_ARRAY(pa);                       \
+    } while (0)
 
 static void svt_picture_buffer_desc_dctor(EbPtr p) {
     EbPictureBufferDesc *obj = (EbPictureBufferDesc *)p;
     if (obj->buffer_enable_mask & PICTURE_BUFFER_DESC_Y_FLAG) {
-        EB_FREE_ALIGNED_ARRAY(obj->buffer_y);
+        PICTURE_PLANE_FREE(obj, obj->buffer_y);
         EB_FREE_ALIGNED_ARRAY(obj->buffer_bit_inc_y);
     }
     if (obj->buffer_enable_mask & PICTURE_BUFFER_DESC_Cb_FLAG) {
-        EB_FREE_ALIGNED_ARRAY(obj->buffer_cb);
+        PICTURE_PLANE_FREE(obj, obj->buffer_cb);
         EB_FREE_ALIGNED_ARRAY(obj->buffer_bit_inc_cb);
     }
     if (obj->buffer_enable_mask & PICTURE_BUFFER_DESC_Cb_FLAG) {
-        EB_FREE_ALIGNED_ARRAY(obj->buffer_cr);
+        PICTURE_PLANE_FREE(obj, obj->buffer_cr);
         EB_FREE_ALIGNED_ARRAY(obj->buffer_bit_inc_cr);
     }
 }
@@ -48,6 +86,7 @@ EbErrorType svt_picture_buffer_desc_ctor(EbPictureBufferDesc *pictureBufferDescP
         (picture_buffer_desc_init_data_ptr->color_format == EB_YUV444 ? 1 : 2) - 1;
 
     pictureBufferDescPtr->dctor = svt_picture_buffer_desc_dctor;
+    svt_mem_set_tag(SVT_AV1_MEM_TAG_PICTURE);
 
     if (picture_buffer_desc_init_data_ptr->bit_depth > EB_8BIT &&
         picture_buffer_desc_init_data_ptr->bit_depth <= EB_16BIT &&
@@ -88,35 +127,40 @@ EbErrorType svt_picture_buffer_desc_ctor(EbPictureBufferDesc *pictureBufferDescP
     }
     pictureBufferDescPtr->buffer_enable_mask =
         picture_buffer_desc_init_data_ptr->buffer_enable_mask;
+    pictureBufferDescPtr->large_pages = svt_get_large_pages();
+    pictureBufferDescPtr->arena       = svt_get_alloc_arena();
 
     // Allocate the Picture Buffers (luma & chroma)
     if (picture_buffer_desc_init_data_ptr->buffer_enable_mask & PICTURE_BUFFER_DESC_Y_FLAG) {
-        EB_CALLOC_ALIGNED_ARRAY(pictureBufferDescPtr->buffer_y,
-                                pictureBufferDescPtr->luma_size * bytes_per_pixel);
+        PICTURE_PLANE_CALLOC(pictureBufferDescPtr,
+                             pictureBufferDescPtr->buffer_y,
+                             pictureBufferDescPtr->luma_size * bytes_per_pixel);
         pictureBufferDescPtr->buffer_bit_inc_y = 0;
         if (picture_buffer_desc_init_data_ptr->split_mode == EB_TRUE) {
-            EB_CALLOC_ALIGNED_ARRAY(pictureBufferDescPtr->buffer_bit_inc_y,
-                                    pictureBufferDescPtr->luma_size * bytes_per_pixel);
+            PICTURE_BUFFER_CALLOC(pictureBufferDescPtr->buffer_bit_inc_y,
+                                  pictureBufferDescPtr->luma_size * bytes_per_pixel);
         }
     }
 
     if (picture_buffer_desc_init_data_ptr->buffer_enable_mask & PICTURE_BUFFER_DESC_Cb_FLAG) {
-        EB_CALLOC_ALIGNED_ARRAY(pictureBufferDescPtr->buffer_cb,
-                                pictureBufferDescPtr->chroma_size * bytes_per_pixel);
+        PICTURE_PLANE_CALLOC(pictureBufferDescPtr,
+                             pictureBufferDescPtr->buffer_cb,
+                             pictureBufferDescPtr->chroma_size * bytes_per_pixel);
         pictureBufferDescPtr->buffer_bit_inc_cb = 0;
         if (picture_buffer_desc_init_data_ptr->split_mode == EB_TRUE) {
-            EB_CALLOC_ALIGNED_ARRAY(pictureBufferDescPtr->buffer_bit_inc_cb,
-                                    pictureBufferDescPtr->chroma_size * bytes_per_pixel);
+            PICTURE_BUFFER_CALLOC(pictureBufferDescPtr->buffer_bit_inc_cb,
+                                  pictureBufferDescPtr->chroma_size * bytes_per_pixel);
         }
     }
 
     if (picture_buffer_desc_init_data_ptr->buffer_enable_mask & PICTURE_BUFFER_DESC_Cr_FLAG) {
-        EB_CALLOC_ALIGNED_ARRAY(pictureBufferDescPtr->buffer_cr,
-                                pictureBufferDescPtr->chroma_size * bytes_per_pixel);
+        PICTURE_PLANE_CALLOC(pictureBufferDescPtr,
+                             pictureBufferDescPtr->buffer_cr,
+                             pictureBufferDescPtr->chroma_size * bytes_per_pixel);
         pictureBufferDescPtr->buffer_bit_inc_cr = 0;
         if (picture_buffer_desc_init_data_ptr->split_mode == EB_TRUE) {
-            EB_CALLOC_ALIGNED_ARRAY(pictureBufferDescPtr->buffer_bit_inc_cr,
-                                    pictureBufferDescPtr->chroma_size * bytes_per_pixel);
+            PICTURE_BUFFER_CALLOC(pictureBufferDescPtr->buffer_bit_inc_cr,
+                                  pictureBufferDescPtr->chroma_size * bytes_per_pixel);
         }
     }
 
@@ -126,11 +170,11 @@ EbErrorType svt_picture_buffer_desc_ctor(EbPictureBufferDesc *pictureBufferDescP
 static void svt_recon_picture_buffer_desc_dctor(EbPtr p) {
     EbPictureBufferDesc *obj = (EbPictureBufferDesc *)p;
     if (obj->buffer_enable_mask & PICTURE_BUFFER_DESC_Y_FLAG)
-        EB_FREE_ALIGNED_ARRAY(obj->buffer_y);
+        PICTURE_PLANE_FREE(obj, obj->buffer_y);
     if (obj->buffer_enable_mask & PICTURE_BUFFER_DESC_Cb_FLAG)
-        EB_FREE_ALIGNED_ARRAY(obj->buffer_cb);
+        PICTURE_PLANE_FREE(obj, obj->buffer_cb);
     if (obj->buffer_enable_mask & PICTURE_BUFFER_DESC_Cb_FLAG)
-        EB_FREE_ALIGNED_ARRAY(obj->buffer_cr);
+        PICTURE_PLANE_FREE(obj, obj->buffer_cr);
 }
 /*****************************************
  * svt_recon_picture_buffer_desc_ctor
@@ -148,6 +192,7 @@ EbErrorType svt_recon_picture_buffer_desc_ctor(EbPictureBufferDesc *pictureBuffe
     uint32_t bytes_per_pixel = (picture_buffer_desc_init_data_ptr->bit_depth == EB_8BIT) ? 1 : 2;
 
     pictureBufferDescPtr->dctor = svt_recon_picture_buffer_desc_dctor;
+    svt_mem_set_tag(SVT_AV1_MEM_TAG_PICTURE);
     // Set the Picture Buffer Static variables
     pictureBufferDescPtr->max_width    = picture_buffer_desc_init_data_ptr->max_width;
     pictureBufferDescPtr->max_height   = picture_buffer_desc_init_data_ptr->max_height;
@@ -175,19 +220,24 @@ EbErrorType svt_recon_picture_buffer_desc_ctor(EbPictureBufferDesc *pictureBuffe
 
     pictureBufferDescPtr->buffer_enable_mask =
         picture_buffer_desc_init_data_ptr->buffer_enable_mask;
+    pictureBufferDescPtr->large_pages = svt_get_large_pages();
+    pictureBufferDescPtr->arena       = svt_get_alloc_arena();
 
     // Allocate the Picture Buffers (luma & chroma)
     if (picture_buffer_desc_init_data_ptr->buffer_enable_mask & PICTURE_BUFFER_DESC_Y_FLAG) {
-        EB_CALLOC_ALIGNED_ARRAY(pictureBufferDescPtr->buffer_y,
-                                pictureBufferDescPtr->luma_size * bytes_per_pixel);
+        PICTURE_PLANE_CALLOC(pictureBufferDescPtr,
+                             pictureBufferDescPtr->buffer_y,
+                             pictureBufferDescPtr->luma_size * bytes_per_pixel);
     }
     if (picture_buffer_desc_init_data_ptr->buffer_enable_mask & PICTURE_BUFFER_DESC_Cb_FLAG) {
-        EB_CALLOC_ALIGNED_ARRAY(pictureBufferDescPtr->buffer_cb,
-                                pictureBufferDescPtr->chroma_size * bytes_per_pixel);
+        PICTURE_PLANE_CALLOC(pictureBufferDescPtr,
+                             pictureBufferDescPtr->buffer_cb,
+                             pictureBufferDescPtr->chroma_size * bytes_per_pixel);
     }
     if (picture_buffer_desc_init_data_ptr->buffer_enable_mask & PICTURE_BUFFER_DESC_Cr_FLAG) {
-        EB_CALLOC_ALIGNED_ARRAY(pictureBufferDescPtr->buffer_cr,
-                                pictureBufferDescPtr->chroma_size * bytes_per_pixel);
+        PICTURE_PLANE_CALLOC(pictureBufferDescPtr,
+                             pictureBufferDescPtr->buffer_cr,
+                             pictureBufferDescPtr->chroma_size * bytes_per_pixel);
     }
     return EB_ErrorNone;
 }
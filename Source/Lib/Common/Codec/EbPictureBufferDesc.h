@@ -67,8 +67,10 @@ typedef struct EbPictureBufferDesc {
     uint32_t chroma_size; // Size of the chroma buffers
     EbBool   packed_flag; // Indicates if sample buffers are packed or not
 
-    EbBool   film_grain_flag; // Indicates if film grain parameters are present for the frame
-    uint32_t buffer_enable_mask;
+    EbBool          film_grain_flag; // Indicates if film grain parameters are present for the frame
+    uint32_t        buffer_enable_mask;
+    EbLargePages    large_pages; // Page backing of buffer_y/cb/cr
+    struct EbArena *arena; // Arena buffer_y/cb/cr are carved from, NULL for the heap
 
     EbBool
         is_16bit_pipeline; // internal bit-depth: when equals 1 internal bit-depth is 16bits regardless of the input bit-depth
@@ -0,0 +1,244 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#include <string.h>
+
+#include "EbStageBalancer.h"
+#include "EbTime.h"
+
+/**************************************
+ * Sampling period, and number of samples
+ * per balancing window (~64ms). The period
+ * doubles while no stage has a backlog, up
+ * to BALANCE_IDLE_PERIOD_MS
+ **************************************/
+#define BALANCE_SAMPLE_PERIOD_MS 2
+#define BALANCE_IDLE_PERIOD_MS 128
+#define BALANCE_WINDOW_SAMPLES 32
+
+/**************************************
+ * A stage is a bottleneck once at least one object waits on average,
+ * a donor once at least half a thread waits on average
+ **************************************/
+#define BALANCE_MIN_QUEUE_DEPTH 1.0
+#define BALANCE_MIN_IDLE_COUNT 0.5
+
+static uint32_t balancer_active_total(const EbStageBalancer *balancer_ptr) {
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < balancer_ptr->stage_count; ++i)
+        total += balancer_ptr->stage_array[i].active_count;
+    return total;
+}
+
+/**************************************
+ * balancer_initial_distribution
+ *   Shares the budget in proportion to the process counts, at least
+ *   one thread per stage
+ **************************************/
+static void balancer_initial_distribution(EbStageBalancer *balancer_ptr) {
+    uint64_t max_total = 0;
+    uint32_t total;
+
+    for (uint32_t i = 0; i < balancer_ptr->stage_count; ++i)
+        max_total += balancer_ptr->stage_array[i].max_count;
+    for (uint32_t i = 0; i < balancer_ptr->stage_count; ++i) {
+        EbBalancedStage *stage = &balancer_ptr->stage_array[i];
+        stage->active_count    = max_total <= balancer_ptr->worker_budget
+               ? stage->max_count
+               : (uint32_t)(stage->max_count * (uint64_t)balancer_ptr->worker_budget / max_total);
+        if (stage->active_count < 1)
+            stage->active_count = 1;
+    }
+    // Rounding: trim the largest stages, then hand the rest to the stages
+    // furthest from their process count
+    total = balancer_active_total(balancer_ptr);
+    while (total > balancer_ptr->worker_budget) {
+        EbBalancedStage *largest = NULL;
+        for (uint32_t i = 0; i < balancer_ptr->stage_count; ++i) {
+            EbBalancedStage *stage = &balancer_ptr->stage_array[i];
+            if (stage->active_count > 1 && (!largest || stage->active_count > largest->active_count))
+                largest = stage;
+        }
+        if (!largest)
+            break;
+        largest->active_count--;
+        total--;
+    }
+    while (total < balancer_ptr->worker_budget) {
+        EbBalancedStage *furthest = NULL;
+        for (uint32_t i = 0; i < balancer_ptr->stage_count; ++i) {
+            EbBalancedStage *stage = &balancer_ptr->stage_array[i];
+            if (stage->active_count < stage->max_count &&
+                (!furthest ||
+                 stage->max_count - stage->active_count >
+                     furthest->max_count - furthest->active_count))
+                furthest = stage;
+        }
+        if (!furthest)
+            break;
+        furthest->active_count++;
+        total++;
+    }
+}
+
+/* Returns EB_TRUE when an object waits in the input queue of a stage */
+static EbBool balancer_sample(EbStageBalancer *balancer_ptr) {
+    EbBool backlog = EB_FALSE;
+    for (uint32_t i = 0; i < balancer_ptr->stage_count; ++i) {
+        EbBalancedStage *stage         = &balancer_ptr->stage_array[i];
+        const uint32_t   pending_count = svt_system_resource_full_pending_count(
+            stage->resource_ptr);
+        stage->queue_sum += pending_count;
+        stage->idle_sum += svt_system_resource_full_waiting_count(stage->resource_ptr);
+        if (pending_count)
+            backlog = EB_TRUE;
+    }
+    return backlog;
+}
+
+/**************************************
+ * balancer_decide
+ *   Moves at most one thread per window, which keeps the distribution
+ *   from oscillating on short bursts
+ **************************************/
+static void balancer_decide(EbStageBalancer *balancer_ptr) {
+    EbBalancedStage *bottleneck = NULL;
+    EbBalancedStage *donor      = NULL;
+    double           max_pressure = 0, max_idle = 0;
+
+    svt_block_on_mutex(balancer_ptr->stats_mutex);
+    for (uint32_t i = 0; i < balancer_ptr->stage_count; ++i) {
+        EbBalancedStage *stage = &balancer_ptr->stage_array[i];
+        stage->queue_depth     = (double)stage->queue_sum / balancer_ptr->sample_count;
+        stage->idle_count      = (double)stage->idle_sum / balancer_ptr->sample_count;
+        stage->queue_sum       = 0;
+        stage->idle_sum        = 0;
+        const double pressure  = stage->queue_depth / stage->active_count;
+        if (stage->active_count < stage->max_count &&
+            stage->queue_depth >= BALANCE_MIN_QUEUE_DEPTH && pressure > max_pressure) {
+            max_pressure = pressure;
+            bottleneck   = stage;
+        }
+    }
+    if (bottleneck && balancer_active_total(balancer_ptr) >= balancer_ptr->worker_budget) {
+        for (uint32_t i = 0; i < balancer_ptr->stage_count; ++i) {
+            EbBalancedStage *stage = &balancer_ptr->stage_array[i];
+            if (stage != bottleneck && stage->active_count > 1 &&
+                stage->idle_count >= BALANCE_MIN_IDLE_COUNT && stage->idle_count > max_idle) {
+                max_idle = stage->idle_count;
+                donor    = stage;
+            }
+        }
+        if (!donor)
+            bottleneck = NULL;
+    }
+    if (donor) {
+        donor->active_count--;
+        donor->lower_count++;
+        svt_system_resource_set_active_consumers(donor->resource_ptr, donor->active_count);
+    }
+    if (bottleneck) {
+        bottleneck->active_count++;
+        bottleneck->raise_count++;
+        svt_system_resource_set_active_consumers(bottleneck->resource_ptr,
+                                                 bottleneck->active_count);
+    }
+    balancer_ptr->window_count++;
+    balancer_ptr->sample_count = 0;
+    svt_release_mutex(balancer_ptr->stats_mutex);
+}
+
+static void *stage_balancer_kernel(void *input_ptr) {
+    EbStageBalancer *balancer_ptr = (EbStageBalancer *)input_ptr;
+    uint32_t         period_ms    = BALANCE_SAMPLE_PERIOD_MS;
+
+    for (;;) {
+        // Posted by the dctor, which does not wait for the period to end
+        svt_block_on_semaphore_timeout(balancer_ptr->quit_semaphore, period_ms);
+        if (svt_atomic_load_u32(&balancer_ptr->quit))
+            break;
+        // An idle encoder, e.g. waiting for input, is sampled less and less
+        if (balancer_sample(balancer_ptr))
+            period_ms = BALANCE_SAMPLE_PERIOD_MS;
+        else if (period_ms < BALANCE_IDLE_PERIOD_MS)
+            period_ms *= 2;
+        if (++balancer_ptr->sample_count == BALANCE_WINDOW_SAMPLES)
+            balancer_decide(balancer_ptr);
+    }
+    return NULL;
+}
+
+static void svt_stage_balancer_dctor(EbPtr p) {
+    EbStageBalancer *obj = (EbStageBalancer *)p;
+
+    svt_atomic_store_u32(&obj->quit, 1);
+    if (obj->quit_semaphore)
+        svt_post_semaphore(obj->quit_semaphore);
+    EB_DESTROY_THREAD(obj->thread_handle);
+    // Let every thread take work again, e.g. to drain on shutdown
+    for (uint32_t i = 0; i < obj->stage_count; ++i)
+        svt_system_resource_set_active_consumers(obj->stage_array[i].resource_ptr,
+                                                 obj->stage_array[i].max_count);
+    EB_DESTROY_MUTEX(obj->stats_mutex);
+    EB_DESTROY_SEMAPHORE(obj->quit_semaphore);
+}
+
+EbErrorType svt_stage_balancer_ctor(EbStageBalancer *balancer_ptr, uint32_t worker_budget,
+                                    const EbBalancedStageInit *stage_init_array,
+                                    uint32_t                   stage_count) {
+    balancer_ptr->dctor = svt_stage_balancer_dctor;
+    if (stage_count > SVT_AV1_MAX_BALANCED_STAGES)
+        return EB_ErrorBadParameter;
+    for (uint32_t i = 0; i < stage_count; ++i) {
+        if (!stage_init_array[i].resource_ptr->full_queue->ring_queue)
+            return EB_ErrorBadParameter;
+    }
+    EB_CREATE_MUTEX(balancer_ptr->stats_mutex);
+    EB_CREATE_SEMAPHORE(balancer_ptr->quit_semaphore, 0, 1);
+
+    balancer_ptr->stage_count   = stage_count;
+    balancer_ptr->worker_budget = worker_budget < stage_count ? stage_count : worker_budget;
+    for (uint32_t i = 0; i < stage_count; ++i) {
+        EbBalancedStage *stage = &balancer_ptr->stage_array[i];
+        stage->name            = stage_init_array[i].name;
+        stage->resource_ptr    = stage_init_array[i].resource_ptr;
+        stage->max_count       = stage_init_array[i].process_count;
+    }
+    balancer_initial_distribution(balancer_ptr);
+    for (uint32_t i = 0; i < stage_count; ++i)
+        svt_system_resource_set_active_consumers(balancer_ptr->stage_array[i].resource_ptr,
+                                                 balancer_ptr->stage_array[i].active_count);
+
+    balancer_ptr->thread_handle = svt_create_thread(stage_balancer_kernel, balancer_ptr);
+    EB_ADD_MEM(balancer_ptr->thread_handle, 1, EB_THREAD);
+    return EB_ErrorNone;
+}
+
+void svt_stage_balancer_get_stats(EbStageBalancer *        balancer_ptr,
+                                  SvtAv1StageBalanceStats *stats_ptr) {
+    memset(stats_ptr, 0, sizeof(*stats_ptr));
+    svt_block_on_mutex(balancer_ptr->stats_mutex);
+    stats_ptr->worker_budget = balancer_ptr->worker_budget;
+    stats_ptr->stage_count   = balancer_ptr->stage_count;
+    stats_ptr->window_count  = balancer_ptr->window_count;
+    for (uint32_t i = 0; i < balancer_ptr->stage_count; ++i) {
+        const EbBalancedStage *stage = &balancer_ptr->stage_array[i];
+        SvtAv1StageBalance *   out   = &stats_ptr->stages[i];
+        out->name                    = stage->name;
+        out->max_workers             = stage->max_count;
+        out->active_workers          = stage->active_count;
+        out->queue_depth             = stage->queue_depth;
+        out->idle_workers            = stage->idle_count;
+        out->raise_count             = stage->raise_count;
+        out->lower_count             = stage->lower_count;
+    }
+    svt_release_mutex(balancer_ptr->stats_mutex);
+}
@@ -0,0 +1,91 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#ifndef EbStageBalancer_h
+#define EbStageBalancer_h
+
+#include "EbDefinitions.h"
+#include "EbObject.h"
+#include "EbThreads.h"
+#include "EbSystemResourceManager.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************************************************************
+ * BalancedStage
+ *   A pipeline stage whose process_count threads consume the full
+ *   queue of resource_ptr, consumer fifo i belonging to thread i.
+ *********************************************************************/
+typedef struct EbBalancedStageInit {
+    const char *      name;
+    EbSystemResource *resource_ptr;
+    uint32_t          process_count;
+} EbBalancedStageInit;
+
+typedef struct EbBalancedStage {
+    const char *      name;
+    EbSystemResource *resource_ptr;
+    uint32_t          max_count;
+    uint32_t          active_count;
+    // queue_sum, idle_sum - accumulated samples of the current window
+    uint64_t queue_sum;
+    uint64_t idle_sum;
+    double   queue_depth;
+    double   idle_count;
+    uint64_t raise_count;
+    uint64_t lower_count;
+} EbBalancedStage;
+
+/*********************************************************************
+ * StageBalancer
+ *   Monitor thread that samples, every few milliseconds while a stage
+ *   has a backlog and less often while none has, the objects waiting in
+ *   the input queue of every stage and the stage threads blocked on it.
+ *   At the end of each window the stage with the most backlog per
+ *   active thread gets one more thread, taken from the budget or from
+ *   the stage with the most idle threads. The other threads stay parked
+ *   in svt_get_full_object (svt_system_resource_set_active_consumers),
+ *   so that at most worker_budget threads take work.
+ *********************************************************************/
+typedef struct EbStageBalancer {
+    EbDctor         dctor;
+    EbHandle        thread_handle;
+    EbHandle        stats_mutex;
+    EbHandle        quit_semaphore;
+    EbBalancedStage stage_array[SVT_AV1_MAX_BALANCED_STAGES];
+    uint32_t        stage_count;
+    uint32_t        worker_budget;
+    uint32_t        sample_count;
+    uint64_t        window_count;
+    volatile uint32_t quit;
+} EbStageBalancer;
+
+/*********************************************************************
+ * svt_stage_balancer_ctor
+ *   Distributes worker_budget (raised to one thread per stage) over
+ *   the stages in proportion to their process_count, then starts the
+ *   monitor thread. The stage resources must use the lock-free queues
+ *   and outlive the balancer.
+ *********************************************************************/
+extern EbErrorType svt_stage_balancer_ctor(EbStageBalancer *balancer_ptr, uint32_t worker_budget,
+                                           const EbBalancedStageInit *stage_init_array,
+                                           uint32_t                   stage_count);
+
+/* Copies the current distribution and the last window averages */
+extern void svt_stage_balancer_get_stats(EbStageBalancer *        balancer_ptr,
+                                         SvtAv1StageBalanceStats *stats_ptr);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // EbStageBalancer_h
@@ -11,10 +11,15 @@
 */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "EbSystemResourceManager.h"
 #include "EbDefinitions.h"
 #include "EbThreads.h"
+#include "EbTaskScheduler.h"
+#include "EbTime.h"
+#include "EbNuma.h"
+#include "EbTrace.h"
 #if SRM_REPORT
 #include "EbLog.h"
 #endif
@@ -86,6 +91,29 @@ static EbErrorType svt_fifo_pop_front(EbFifo *fifoPtr, EbObjectWrapper **wrapper
     return return_error;
 }
 
+// Consumer fifo the calling stage thread last took an object from, its
+// svt_get_empty_object waits are accounted there. Never set on the
+// application threads: the fifos they consume go with their handle.
+static SVT_THREAD_LOCAL EbBool  stage_thread          = EB_FALSE;
+static SVT_THREAD_LOCAL EbFifo *current_consumer_fifo = NULL;
+
+void svt_system_resource_stage_begin(void) { stage_thread = EB_TRUE; }
+
+void svt_system_resource_stage_end(void) {
+    stage_thread          = EB_FALSE;
+    current_consumer_fifo = NULL;
+}
+
+/**************************************
+ * svt_fifo_quit_requested
+ *   quit_signal is polled without the lockout mutex on the lock-free path
+ **************************************/
+static EbBool svt_fifo_quit_requested(const EbFifo *fifo_ptr) {
+    return *(volatile const EbBool *)&fifo_ptr->quit_signal;
+}
+
+static void svt_ring_queue_signal(EbRingQueue *ring_ptr);
+
 static EbErrorType svt_fifo_shutdown(EbFifo *fifo_ptr) {
     EbErrorType return_error = EB_ErrorNone;
 
@@ -94,12 +122,167 @@ static EbErrorType svt_fifo_shutdown(EbFifo *fifo_ptr) {
     fifo_ptr->quit_signal = EB_TRUE;
     // Release Mutex
     svt_release_mutex(fifo_ptr->lockout_mutex);
-    //Wake up the waiting process if any
-    svt_post_semaphore(fifo_ptr->counting_semaphore);
+    //Wake up the waiting process if any, hooked consumers never wait
+    if (fifo_ptr->queue_ptr->consumer_hook)
+        return return_error;
+    if (svt_atomic_cas_u32(&fifo_ptr->gate_parked, 1, 0))
+        svt_post_semaphore(fifo_ptr->counting_semaphore);
+    if (fifo_ptr->queue_ptr->ring_queue)
+        svt_ring_queue_signal(fifo_ptr->queue_ptr->ring_queue);
+    else
+        svt_post_semaphore(fifo_ptr->counting_semaphore);
 
     return return_error;
 }
 
+/**************************************
+ * Number of times a consumer polls the ring
+ * before parking on the semaphore
+ **************************************/
+#define RING_SPIN_COUNT 256
+
+static void svt_ring_queue_dctor(EbPtr p) {
+    EbRingQueue *obj = (EbRingQueue *)p;
+    EB_DESTROY_SEMAPHORE(obj->park_semaphore);
+    EB_FREE_ARRAY(obj->cell_array);
+}
+
+/**************************************
+ * svt_ring_queue_ctor
+ **************************************/
+static EbErrorType svt_ring_queue_ctor(EbRingQueue *ring_ptr, uint32_t object_total_count,
+                                       uint32_t process_total_count) {
+    uint64_t capacity = 1;
+
+    ring_ptr->dctor = svt_ring_queue_dctor;
+
+    // The ring holds every object of the resource, rounded up to a power of two
+    while (capacity < object_total_count) capacity <<= 1;
+    ring_ptr->mask = capacity - 1;
+
+    EB_MALLOC_ARRAY(ring_ptr->cell_array, capacity);
+    for (uint64_t i = 0; i < capacity; ++i) {
+        ring_ptr->cell_array[i].sequence    = i;
+        ring_ptr->cell_array[i].wrapper_ptr = NULL;
+    }
+
+    ring_ptr->spin_count = svt_get_online_processor_count() > 1 ? RING_SPIN_COUNT : 0;
+
+    // Every object plus one shutdown token per process can be pending at once
+    EB_CREATE_SEMAPHORE(
+        ring_ptr->park_semaphore, 0, object_total_count + process_total_count);
+
+    return EB_ErrorNone;
+}
+
+/**************************************
+ * svt_ring_queue_signal
+ *   Adds one token and wakes up a parked consumer if there is one
+ **************************************/
+static void svt_ring_queue_signal(EbRingQueue *ring_ptr) {
+    const int32_t count = svt_atomic_fetch_add_i32(&ring_ptr->available_count, 1) + 1;
+    if (count <= 0)
+        svt_post_semaphore(ring_ptr->park_semaphore);
+    else {
+        int32_t max_count = svt_atomic_load_i32(&ring_ptr->max_available_count);
+        while (count > max_count &&
+               !svt_atomic_cas_i32(&ring_ptr->max_available_count, max_count, count))
+            max_count = svt_atomic_load_i32(&ring_ptr->max_available_count);
+    }
+}
+
+/**************************************
+ * svt_ring_queue_try_wait
+ *   Takes one token if any is available, never blocks
+ **************************************/
+static EbBool svt_ring_queue_try_wait(EbRingQueue *ring_ptr) {
+    int32_t count = svt_atomic_load_i32(&ring_ptr->available_count);
+    while (count > 0) {
+        if (svt_atomic_cas_i32(&ring_ptr->available_count, count, count - 1))
+            return EB_TRUE;
+        count = svt_atomic_load_i32(&ring_ptr->available_count);
+    }
+    return EB_FALSE;
+}
+
+/**************************************
+ * svt_ring_queue_wait
+ *   Takes one token, spinning briefly before parking the thread
+ **************************************/
+static void svt_ring_queue_wait(EbRingQueue *ring_ptr) {
+    for (uint32_t spin = 0; spin < ring_ptr->spin_count; ++spin) {
+        if (svt_ring_queue_try_wait(ring_ptr))
+            return;
+        svt_cpu_pause();
+    }
+    if (svt_atomic_fetch_add_i32(&ring_ptr->available_count, -1) <= 0) {
+        svt_task_scheduler_block_begin();
+        svt_block_on_semaphore(ring_ptr->park_semaphore);
+        svt_task_scheduler_block_end();
+    }
+}
+
+/**************************************
+ * svt_ring_queue_push
+ **************************************/
+static void svt_ring_queue_push(EbRingQueue *ring_ptr, EbObjectWrapper *wrapper_ptr) {
+    EbRingCell *cell;
+    uint64_t    pos = svt_atomic_load_u64(&ring_ptr->enqueue_pos);
+
+    for (;;) {
+        cell                 = &ring_ptr->cell_array[pos & ring_ptr->mask];
+        const uint64_t seq   = svt_atomic_load_u64(&cell->sequence);
+        const int64_t  delta = (int64_t)(seq - pos);
+        if (delta == 0) {
+            if (svt_atomic_cas_u64(&ring_ptr->enqueue_pos, pos, pos + 1))
+                break;
+        } else if (delta < 0) {
+            // The ring can hold every object, so it only looks full while
+            // a consumer is still handing the cell back
+            svt_cpu_pause();
+        }
+        pos = svt_atomic_load_u64(&ring_ptr->enqueue_pos);
+    }
+
+    cell->wrapper_ptr = wrapper_ptr;
+    svt_atomic_store_u64(&cell->sequence, pos + 1);
+
+    svt_ring_queue_signal(ring_ptr);
+}
+
+/**************************************
+ * svt_ring_queue_pop
+ *   Must be called with a token taken. Returns NULL only when
+ *   fifo_ptr is shut down while waiting for the cell to be published.
+ **************************************/
+static EbObjectWrapper *svt_ring_queue_pop(EbRingQueue *ring_ptr, const EbFifo *fifo_ptr) {
+    EbRingCell *     cell;
+    EbObjectWrapper *wrapper_ptr;
+    uint64_t         pos = svt_atomic_load_u64(&ring_ptr->dequeue_pos);
+
+    for (;;) {
+        cell                 = &ring_ptr->cell_array[pos & ring_ptr->mask];
+        const uint64_t seq   = svt_atomic_load_u64(&cell->sequence);
+        const int64_t  delta = (int64_t)(seq - (pos + 1));
+        if (delta == 0) {
+            if (svt_atomic_cas_u64(&ring_ptr->dequeue_pos, pos, pos + 1))
+                break;
+        } else if (delta < 0) {
+            // A producer claimed the cell but has not published it yet,
+            // or the token was a shutdown notification
+            if (svt_fifo_quit_requested(fifo_ptr))
+                return NULL;
+            svt_yield_thread();
+        }
+        pos = svt_atomic_load_u64(&ring_ptr->dequeue_pos);
+    }
+
+    wrapper_ptr = cell->wrapper_ptr;
+    svt_atomic_store_u64(&cell->sequence, pos + ring_ptr->mask + 1);
+
+    return wrapper_ptr;
+}
+
 static void svt_circular_buffer_dctor(EbPtr p) {
     EbCircularBuffer *obj = (EbCircularBuffer *)p;
     EB_FREE(obj->array_ptr);
@@ -194,6 +377,7 @@ void svt_muxing_queue_dctor(EbPtr p) {
     EB_DELETE_PTR_ARRAY(obj->process_fifo_ptr_array, obj->process_total_count);
     EB_DELETE(obj->object_queue);
     EB_DELETE(obj->process_queue);
+    EB_DELETE(obj->ring_queue);
     EB_DESTROY_MUTEX(obj->lockout_mutex);
 }
 
@@ -201,20 +385,30 @@ void svt_muxing_queue_dctor(EbPtr p) {
  * svt_muxing_queue_ctor
  **************************************/
 static EbErrorType svt_muxing_queue_ctor(EbMuxingQueue *queue_ptr, uint32_t object_total_count,
-                                         uint32_t process_total_count) {
+                                         uint32_t process_total_count, EbBool lock_free) {
     uint32_t    process_index;
     EbErrorType return_error = EB_ErrorNone;
 
-    queue_ptr->dctor               = svt_muxing_queue_dctor;
-    queue_ptr->process_total_count = process_total_count;
+    queue_ptr->dctor                = svt_muxing_queue_dctor;
+    queue_ptr->process_total_count  = process_total_count;
+    queue_ptr->active_process_count = process_total_count;
 
     // Lockout Mutex
     EB_CREATE_MUTEX(queue_ptr->lockout_mutex);
 
-    // Construct Object Circular Buffer
-    EB_NEW(queue_ptr->object_queue, svt_circular_buffer_ctor, object_total_count);
-    // Construct Process Circular Buffer
-    EB_NEW(queue_ptr->process_queue, svt_circular_buffer_ctor, queue_ptr->process_total_count);
+    if (lock_free) {
+        // Construct the lock-free Ring
+        EB_NEW(queue_ptr->ring_queue,
+               svt_ring_queue_ctor,
+               object_total_count,
+               queue_ptr->process_total_count);
+    } else {
+        // Construct Object Circular Buffer
+        EB_NEW(queue_ptr->object_queue, svt_circular_buffer_ctor, object_total_count);
+        // Construct Process Circular Buffer
+        EB_NEW(
+            queue_ptr->process_queue, svt_circular_buffer_ctor, queue_ptr->process_total_count);
+    }
     // Construct the Process Fifos
     EB_ALLOC_PTR_ARRAY(queue_ptr->process_fifo_ptr_array, queue_ptr->process_total_count);
 
@@ -226,6 +420,7 @@ static EbErrorType svt_muxing_queue_ctor(EbMuxingQueue *queue_ptr, uint32_t obje
                (EbObjectWrapper *)NULL,
                (EbObjectWrapper *)NULL,
                queue_ptr);
+        queue_ptr->process_fifo_ptr_array[process_index]->process_index = process_index;
     }
 
     return return_error;
@@ -271,7 +466,14 @@ static EbErrorType svt_muxing_queue_object_push_back(EbMuxingQueue *  queue_ptr,
                                                      EbObjectWrapper *object_ptr) {
     EbErrorType return_error = EB_ErrorNone;
 
+    if (queue_ptr->ring_queue) {
+        svt_ring_queue_push(queue_ptr->ring_queue, object_ptr);
+        return return_error;
+    }
+
     svt_circular_buffer_push_back(queue_ptr->object_queue, object_ptr);
+    if (queue_ptr->object_queue->current_count > queue_ptr->max_object_count)
+        queue_ptr->max_object_count = queue_ptr->object_queue->current_count;
 
     svt_muxing_queue_assignation(queue_ptr);
 
@@ -314,6 +516,11 @@ static EbFifo *svt_muxing_queue_get_fifo(EbMuxingQueue *queue_ptr, uint32_t inde
 EbErrorType svt_object_release_enable(EbObjectWrapper *wrapper_ptr) {
     EbErrorType return_error = EB_ErrorNone;
 
+    if (wrapper_ptr->system_resource_ptr->empty_queue->ring_queue) {
+        *(volatile EbBool *)&wrapper_ptr->release_enable = EB_TRUE;
+        return return_error;
+    }
+
     svt_block_on_mutex(wrapper_ptr->system_resource_ptr->empty_queue->lockout_mutex);
 
     wrapper_ptr->release_enable = EB_TRUE;
@@ -340,6 +547,11 @@ EbErrorType svt_object_release_enable(EbObjectWrapper *wrapper_ptr) {
 EbErrorType svt_object_release_disable(EbObjectWrapper *wrapper_ptr) {
     EbErrorType return_error = EB_ErrorNone;
 
+    if (wrapper_ptr->system_resource_ptr->empty_queue->ring_queue) {
+        *(volatile EbBool *)&wrapper_ptr->release_enable = EB_FALSE;
+        return return_error;
+    }
+
     svt_block_on_mutex(wrapper_ptr->system_resource_ptr->empty_queue->lockout_mutex);
 
     wrapper_ptr->release_enable = EB_FALSE;
@@ -366,6 +578,11 @@ EbErrorType svt_object_release_disable(EbObjectWrapper *wrapper_ptr) {
 EbErrorType svt_object_inc_live_count(EbObjectWrapper *wrapper_ptr, uint32_t increment_number) {
     EbErrorType return_error = EB_ErrorNone;
 
+    if (wrapper_ptr->system_resource_ptr->empty_queue->ring_queue) {
+        svt_atomic_fetch_add_u32(&wrapper_ptr->live_count, increment_number);
+        return return_error;
+    }
+
     svt_block_on_mutex(wrapper_ptr->system_resource_ptr->empty_queue->lockout_mutex);
 
     wrapper_ptr->live_count += increment_number;
@@ -412,7 +629,10 @@ static void svt_system_resource_dctor(EbPtr p) {
     EbSystemResource *obj = (EbSystemResource *)p;
     EB_DELETE(obj->full_queue);
     EB_DELETE(obj->empty_queue);
-    EB_DELETE_PTR_ARRAY(obj->wrapper_ptr_pool, obj->object_total_count);
+    EB_DELETE_PTR_ARRAY(obj->wrapper_ptr_pool, obj->constructed_count);
+    EB_DESTROY_MUTEX(obj->grow_mutex);
+    EB_DESTROY_SEMAPHORE(obj->drain_semaphore);
+    EB_FREE(obj->object_init_data_copy);
 }
 
 /*********************************************************************
@@ -440,11 +660,11 @@ static void svt_system_resource_dctor(EbPtr p) {
  *   object_destroyer
  *     object destroyer, will call dctor if this is null
  *********************************************************************/
-EbErrorType svt_system_resource_ctor(EbSystemResource *resource_ptr, uint32_t object_total_count,
-                                     uint32_t  producer_process_total_count,
-                                     uint32_t  consumer_process_total_count,
-                                     EbCreator object_creator, EbPtr object_init_data_ptr,
-                                     EbDctor object_destroyer) {
+static EbErrorType svt_system_resource_ctor_internal(
+    EbSystemResource *resource_ptr, uint32_t initial_count, uint32_t object_total_count,
+    uint32_t producer_process_total_count, uint32_t consumer_process_total_count,
+    EbCreator object_creator, EbPtr object_init_data_ptr, EbDctor object_destroyer,
+    EbBool lock_free) {
     uint32_t    wrapper_index;
     EbErrorType return_error = EB_ErrorNone;
     resource_ptr->dctor      = svt_system_resource_dctor;
@@ -454,34 +674,40 @@ EbErrorType svt_system_resource_ctor(EbSystemResource *resource_ptr, uint32_t ob
     // Allocate array for wrapper pointers
     EB_ALLOC_PTR_ARRAY(resource_ptr->wrapper_ptr_pool, resource_ptr->object_total_count);
 
-    // Initialize each wrapper
-    for (wrapper_index = 0; wrapper_index < resource_ptr->object_total_count; ++wrapper_index) {
+    // Initialize each wrapper, on the next node when interleaving
+    const int32_t alloc_node = svt_numa_get_alloc_node();
+    for (wrapper_index = 0; wrapper_index < initial_count; ++wrapper_index) {
+        if (alloc_node == SVT_NUMA_NODE_INTERLEAVE)
+            svt_numa_set_alloc_node(wrapper_index % svt_numa_node_count());
         EB_NEW(resource_ptr->wrapper_ptr_pool[wrapper_index],
                svt_object_wrapper_ctor,
                resource_ptr,
                object_creator,
                object_init_data_ptr,
                object_destroyer);
+        resource_ptr->constructed_count = wrapper_index + 1;
 #if SRM_REPORT
         resource_ptr->wrapper_ptr_pool[wrapper_index]->pic_number = 99999999;
 #endif
 
     }
+    svt_numa_set_alloc_node(alloc_node);
 
     // Initialize the Empty Queue
     EB_NEW(resource_ptr->empty_queue,
            svt_muxing_queue_ctor,
            resource_ptr->object_total_count,
-           producer_process_total_count);
+           producer_process_total_count,
+           lock_free);
     // Fill the Empty Fifo with every ObjectWrapper
-    for (wrapper_index = 0; wrapper_index < resource_ptr->object_total_count; ++wrapper_index) {
+    for (wrapper_index = 0; wrapper_index < initial_count; ++wrapper_index) {
         svt_muxing_queue_object_push_back(resource_ptr->empty_queue,
                                           resource_ptr->wrapper_ptr_pool[wrapper_index]);
     }
 
 #if SRM_REPORT
     //at init time, the SRM is full
-    resource_ptr->empty_queue->curr_count = resource_ptr->object_total_count;
+    resource_ptr->empty_queue->curr_count = initial_count;
     resource_ptr->empty_queue->log = 0;
 #endif
     // Initialize the Full Queue
@@ -489,14 +715,119 @@ EbErrorType svt_system_resource_ctor(EbSystemResource *resource_ptr, uint32_t ob
         EB_NEW(resource_ptr->full_queue,
                svt_muxing_queue_ctor,
                resource_ptr->object_total_count,
-               consumer_process_total_count);
+               consumer_process_total_count,
+               lock_free);
     } else {
         resource_ptr->full_queue = (EbMuxingQueue *)NULL;
     }
+    EB_CREATE_SEMAPHORE(resource_ptr->drain_semaphore, 0, object_total_count);
 
     return return_error;
 }
 
+EbErrorType svt_system_resource_ctor_mode(EbSystemResource *resource_ptr,
+                                          uint32_t          object_total_count,
+                                          uint32_t          producer_process_total_count,
+                                          uint32_t          consumer_process_total_count,
+                                          EbCreator object_creator, EbPtr object_init_data_ptr,
+                                          EbDctor object_destroyer, EbBool lock_free) {
+    return svt_system_resource_ctor_internal(resource_ptr,
+                                             object_total_count,
+                                             object_total_count,
+                                             producer_process_total_count,
+                                             consumer_process_total_count,
+                                             object_creator,
+                                             object_init_data_ptr,
+                                             object_destroyer,
+                                             lock_free);
+}
+
+EbErrorType svt_system_resource_ctor_elastic(
+    EbSystemResource *resource_ptr, uint32_t initial_count, uint32_t object_total_count,
+    uint32_t producer_process_total_count, uint32_t consumer_process_total_count,
+    EbCreator object_creator, EbPtr object_init_data_ptr, size_t object_init_data_size,
+    EbDctor object_destroyer) {
+    EbErrorType return_error;
+
+    if (initial_count < 1)
+        initial_count = 1;
+    if (initial_count > object_total_count)
+        initial_count = object_total_count;
+    return_error = svt_system_resource_ctor_internal(resource_ptr,
+                                                    initial_count,
+                                                    object_total_count,
+                                                    producer_process_total_count,
+                                                    consumer_process_total_count,
+                                                    object_creator,
+                                                    object_init_data_ptr,
+                                                    object_destroyer,
+                                                    SRM_LOCK_FREE ? EB_TRUE : EB_FALSE);
+    if (return_error != EB_ErrorNone || initial_count == object_total_count)
+        return return_error;
+
+    // Keep what is needed to construct the remaining objects on demand
+    if (object_init_data_size) {
+        EB_MALLOC(resource_ptr->object_init_data_copy, object_init_data_size);
+        memcpy(resource_ptr->object_init_data_copy, object_init_data_ptr, object_init_data_size);
+        object_init_data_ptr = resource_ptr->object_init_data_copy;
+    }
+    EB_CREATE_MUTEX(resource_ptr->grow_mutex);
+    resource_ptr->object_creator                    = object_creator;
+    resource_ptr->object_init_data_ptr              = object_init_data_ptr;
+    resource_ptr->object_destroyer                  = object_destroyer;
+    resource_ptr->large_pages                       = svt_get_large_pages();
+    resource_ptr->empty_queue->elastic_resource_ptr = resource_ptr;
+    return EB_ErrorNone;
+}
+
+/*********************************************************************
+ * svt_system_resource_grow
+ *   Constructs one more object of an elastic resource and hands it out
+ *   directly. Returns NULL once object_total_count is reached or when
+ *   the construction fails, the caller then waits on the empty queue.
+ *********************************************************************/
+static EbObjectWrapper *svt_system_resource_grow(EbSystemResource *resource_ptr) {
+    EbObjectWrapper *wrapper_ptr = NULL;
+
+    if (svt_atomic_load_u32(&resource_ptr->constructed_count) >= resource_ptr->object_total_count)
+        return NULL;
+    svt_block_on_mutex(resource_ptr->grow_mutex);
+    if (resource_ptr->constructed_count < resource_ptr->object_total_count) {
+        // Constructed by a worker thread, with the pages chosen at init
+        const EbLargePages large_pages = svt_get_large_pages();
+        svt_set_large_pages(resource_ptr->large_pages);
+        EB_NO_THROW_NEW(wrapper_ptr,
+                        svt_object_wrapper_ctor,
+                        resource_ptr,
+                        resource_ptr->object_creator,
+                        resource_ptr->object_init_data_ptr,
+                        resource_ptr->object_destroyer);
+        svt_set_large_pages(large_pages);
+        if (wrapper_ptr) {
+            resource_ptr->wrapper_ptr_pool[resource_ptr->constructed_count] = wrapper_ptr;
+            svt_atomic_store_u32(&resource_ptr->constructed_count,
+                                 resource_ptr->constructed_count + 1);
+        }
+    }
+    svt_release_mutex(resource_ptr->grow_mutex);
+    return wrapper_ptr;
+}
+
+EbErrorType svt_system_resource_ctor(EbSystemResource *resource_ptr, uint32_t object_total_count,
+                                     uint32_t  producer_process_total_count,
+                                     uint32_t  consumer_process_total_count,
+                                     EbCreator object_creator, EbPtr object_init_data_ptr,
+                                     EbDctor object_destroyer) {
+    return svt_system_resource_ctor_mode(resource_ptr,
+                                         object_total_count,
+                                         producer_process_total_count,
+                                         consumer_process_total_count,
+                                         object_creator,
+                                         object_init_data_ptr,
+                                         object_destroyer,
+                                         SRM_LOCK_FREE ? EB_TRUE : EB_FALSE);
+}
+
 EbFifo *svt_system_resource_get_producer_fifo(const EbSystemResource *resource_ptr,
                                               uint32_t                index) {
     return svt_muxing_queue_get_fifo(resource_ptr->empty_queue, index);
@@ -507,6 +838,149 @@ EbFifo *svt_system_resource_get_consumer_fifo(const EbSystemResource *resource_p
     return svt_muxing_queue_get_fifo(resource_ptr->full_queue, index);
 }
 
+EbErrorType svt_system_resource_set_consumer_hook(EbSystemResource *resource_ptr,
+                                                  EbConsumerHook hook, void *hook_ctx) {
+    if (!resource_ptr->full_queue->ring_queue)
+        return EB_ErrorBadParameter;
+    resource_ptr->full_queue->consumer_hook_ctx = hook_ctx;
+    resource_ptr->full_queue->consumer_hook     = hook;
+    return EB_ErrorNone;
+}
+
+void svt_system_resource_set_release_hook(EbSystemResource *resource_ptr, EbReleaseHook hook,
+                                          void *hook_ctx) {
+    resource_ptr->release_hook_ctx = hook_ctx;
+    resource_ptr->release_hook     = hook;
+}
+
+uint32_t svt_system_resource_full_pending_count(const EbSystemResource *resource_ptr) {
+    int32_t count;
+    if (!resource_ptr->full_queue->ring_queue)
+        return 0;
+    count = svt_atomic_load_i32(&resource_ptr->full_queue->ring_queue->available_count);
+    return count > 0 ? (uint32_t)count : 0;
+}
+
+EbBool svt_system_resource_shutdown_requested(const EbSystemResource *resource_ptr) {
+    if (!resource_ptr->full_queue || !resource_ptr->full_queue->process_total_count)
+        return EB_FALSE;
+    return svt_fifo_quit_requested(resource_ptr->full_queue->process_fifo_ptr_array[0]);
+}
+
+uint32_t svt_system_resource_full_waiting_count(const EbSystemResource *resource_ptr) {
+    int32_t count;
+    if (!resource_ptr->full_queue->ring_queue)
+        return 0;
+    count = svt_atomic_load_i32(&resource_ptr->full_queue->ring_queue->available_count);
+    return count < 0 ? (uint32_t)-count : 0;
+}
+
+uint32_t svt_system_resource_empty_count(const EbSystemResource *resource_ptr) {
+    EbMuxingQueue *queue_ptr = resource_ptr->empty_queue;
+    uint32_t       count;
+    if (queue_ptr->ring_queue) {
+        const int32_t available = svt_atomic_load_i32(&queue_ptr->ring_queue->available_count);
+        return available > 0 ? (uint32_t)available : 0;
+    }
+    // Objects not handed out yet, then the ones assigned to the fifos of
+    // the producers
+    svt_block_on_mutex(queue_ptr->lockout_mutex);
+    count = queue_ptr->object_queue->current_count;
+    for (uint32_t i = 0; i < queue_ptr->process_total_count; i++) {
+        EbFifo *fifo_ptr = queue_ptr->process_fifo_ptr_array[i];
+        svt_block_on_mutex(fifo_ptr->lockout_mutex);
+        for (const EbObjectWrapper *wrapper_ptr = fifo_ptr->first_ptr; wrapper_ptr;
+             wrapper_ptr = wrapper_ptr->next_ptr)
+            count++;
+        svt_release_mutex(fifo_ptr->lockout_mutex);
+    }
+    svt_release_mutex(queue_ptr->lockout_mutex);
+    return count;
+}
+
+EbErrorType svt_system_resource_wait_drained(EbSystemResource *resource_ptr,
+                                             uint32_t          timeout_ms) {
+    const uint64_t deadline_ns  = svt_av1_get_time_ns() + (uint64_t)timeout_ms * 1000000;
+    EbErrorType    return_error = EB_ErrorNone;
+
+    // Full barrier, see svt_system_resource_notify_drain()
+    svt_atomic_fetch_add_u32(&resource_ptr->drain_requested, 1);
+    // The semaphore may hold posts of an earlier drain, count again on wake up
+    while (svt_system_resource_empty_count(resource_ptr) !=
+           svt_atomic_load_u32(&resource_ptr->constructed_count)) {
+        const uint64_t now_ns = svt_av1_get_time_ns();
+        if (now_ns >= deadline_ns) {
+            return_error = EB_ErrorSemaphoreUnresponsive;
+            break;
+        }
+        svt_block_on_semaphore_timeout(resource_ptr->drain_semaphore,
+                                       (uint32_t)((deadline_ns - now_ns + 999999) / 1000000));
+    }
+    svt_atomic_fetch_add_u32(&resource_ptr->drain_requested, (uint32_t)-1);
+    return return_error;
+}
+
+EbErrorType svt_post_signal_object(EbFifo *empty_fifo_ptr, EbHandle semaphore) {
+    EbObjectWrapper *wrapper_ptr;
+    EbErrorType      return_error = svt_get_empty_object(empty_fifo_ptr, &wrapper_ptr);
+    if (return_error != EB_ErrorNone)
+        return return_error;
+    wrapper_ptr->signal_semaphore = semaphore;
+    return svt_post_full_object(wrapper_ptr);
+}
+
+EbErrorType svt_release_signal_object(EbObjectWrapper *wrapper_ptr) {
+    EbHandle semaphore = wrapper_ptr->signal_semaphore;
+
+    wrapper_ptr->signal_semaphore = NULL;
+    svt_release_object(wrapper_ptr);
+    return svt_post_semaphore(semaphore);
+}
+
+void svt_system_resource_get_consumer_stats(const EbSystemResource *resource_ptr,
+                                            EbConsumerStats *       stats_ptr) {
+    const EbMuxingQueue *queue_ptr = resource_ptr->full_queue;
+
+    memset(stats_ptr, 0, sizeof(*stats_ptr));
+    stats_ptr->consumer_count = queue_ptr->process_total_count;
+    for (uint32_t i = 0; i < queue_ptr->process_total_count; i++) {
+        const EbFifo *fifo_ptr = queue_ptr->process_fifo_ptr_array[i];
+        const uint64_t busy_ns = fifo_ptr->busy_ns, empty_wait_ns = fifo_ptr->empty_wait_ns;
+        stats_ptr->item_count += fifo_ptr->item_count;
+        // busy_ns covers the empty waits of the thread
+        stats_ptr->busy_ns += busy_ns > empty_wait_ns ? busy_ns - empty_wait_ns : 0;
+        stats_ptr->full_wait_ns += fifo_ptr->full_wait_ns;
+        stats_ptr->empty_wait_ns += empty_wait_ns;
+    }
+    if (queue_ptr->ring_queue) {
+        stats_ptr->queue_depth     = svt_system_resource_full_pending_count(resource_ptr);
+        stats_ptr->max_queue_depth = (uint32_t)queue_ptr->ring_queue->max_available_count;
+    } else {
+        stats_ptr->queue_depth     = queue_ptr->object_queue->current_count;
+        stats_ptr->max_queue_depth = queue_ptr->max_object_count;
+    }
+}
+
+EbErrorType svt_system_resource_set_active_consumers(EbSystemResource *resource_ptr,
+                                                     uint32_t          active_count) {
+    EbMuxingQueue *queue_ptr = resource_ptr->full_queue;
+    if (!queue_ptr->ring_queue)
+        return EB_ErrorBadParameter;
+    if (active_count < 1)
+        active_count = 1;
+    if (active_count > queue_ptr->process_total_count)
+        active_count = queue_ptr->process_total_count;
+    // Full barrier: the count is stored before gate_parked is read, see svt_fifo_gate_wait()
+    svt_atomic_exchange_u32(&queue_ptr->active_process_count, active_count);
+    // Wake up the consumers parked by a lower count
+    for (uint32_t i = 0; i < active_count; i++) {
+        EbFifo *fifo_ptr = queue_ptr->process_fifo_ptr_array[i];
+        if (svt_atomic_cas_u32(&fifo_ptr->gate_parked, 1, 0))
+            svt_post_semaphore(fifo_ptr->counting_semaphore);
+    }
+    return EB_ErrorNone;
+}
+
 EbErrorType svt_shutdown_process(const EbSystemResource *resource_ptr) {
     //not fully constructed
     if (!resource_ptr || !resource_ptr->full_queue)
@@ -554,6 +1028,14 @@ static EbErrorType svt_release_process(EbFifo *process_fifo_ptr) {
 EbErrorType svt_post_full_object(EbObjectWrapper *object_ptr) {
     EbErrorType return_error = EB_ErrorNone;
 
+    if (object_ptr->system_resource_ptr->full_queue->ring_queue) {
+        EbMuxingQueue *queue_ptr = object_ptr->system_resource_ptr->full_queue;
+        svt_ring_queue_push(queue_ptr->ring_queue, object_ptr);
+        if (queue_ptr->consumer_hook)
+            queue_ptr->consumer_hook(queue_ptr->consumer_hook_ctx);
+        return return_error;
+    }
+
     svt_block_on_mutex(object_ptr->system_resource_ptr->full_queue->lockout_mutex);
 
     svt_muxing_queue_object_push_back(object_ptr->system_resource_ptr->full_queue, object_ptr);
@@ -563,6 +1045,15 @@ EbErrorType svt_post_full_object(EbObjectWrapper *object_ptr) {
     return return_error;
 }
 
+/* Wakes svt_system_resource_wait_drained once the last object is back.
+ * The full barriers of the release and of the waiter order the count
+ * against drain_requested. */
+static void svt_system_resource_notify_drain(EbSystemResource *resource_ptr) {
+    if (svt_atomic_load_u32(&resource_ptr->drain_requested) &&
+        svt_system_resource_empty_count(resource_ptr) == resource_ptr->constructed_count)
+        svt_post_semaphore(resource_ptr->drain_semaphore);
+}
+
 /*********************************************************************
  * EbSystemResourceReleaseObject
  *   Queues an empty EbObjectWrapper to the SystemResource. This
@@ -573,8 +1064,46 @@ EbErrorType svt_post_full_object(EbObjectWrapper *object_ptr) {
  *   object_ptr
  *      pointer to EbObjectWrapper to be released.
  *********************************************************************/
+/*********************************************************************
+ * svt_release_object_lock_free
+ *   live_count is decremented with a CAS loop; the thread that moves it
+ *   from 0 to EB_ObjectWrapperReleasedValue is the one that recycles it.
+ *********************************************************************/
+static EbErrorType svt_release_object_lock_free(EbObjectWrapper *object_ptr) {
+    EbMuxingQueue *queue_ptr = object_ptr->system_resource_ptr->empty_queue;
+    uint32_t       live_count;
+    uint32_t       next_count;
+
+    do {
+        live_count = svt_atomic_load_u32(&object_ptr->live_count);
+        next_count = (live_count == 0) ? live_count : live_count - 1;
+    } while (!svt_atomic_cas_u32(&object_ptr->live_count, live_count, next_count));
+
+    if (next_count == 0 && *(volatile EbBool *)&object_ptr->release_enable == EB_TRUE &&
+        svt_atomic_cas_u32(&object_ptr->live_count, 0, EB_ObjectWrapperReleasedValue)) {
+#if SRM_REPORT
+        object_ptr->pic_number = 99999999;
+        //increment the fullness
+        svt_atomic_fetch_add_u32(&queue_ptr->curr_count, 1);
+        if (queue_ptr->log)
+            SVT_LOG("SRM fullness+: %i/%i\n", queue_ptr->curr_count, object_ptr->system_resource_ptr->object_total_count);
+#endif
+        if (object_ptr->system_resource_ptr->release_hook)
+            object_ptr->system_resource_ptr->release_hook(
+                object_ptr->system_resource_ptr->release_hook_ctx, object_ptr->object_ptr);
+        svt_ring_queue_push(queue_ptr->ring_queue, object_ptr);
+        svt_system_resource_notify_drain(object_ptr->system_resource_ptr);
+    }
+
+    return EB_ErrorNone;
+}
+
 EbErrorType svt_release_object(EbObjectWrapper *object_ptr) {
     EbErrorType return_error = EB_ErrorNone;
+    EbBool      recycled     = EB_FALSE;
+
+    if (object_ptr->system_resource_ptr->empty_queue->ring_queue)
+        return svt_release_object_lock_free(object_ptr);
 
     svt_block_on_mutex(object_ptr->system_resource_ptr->empty_queue->lockout_mutex);
 
@@ -585,6 +1114,17 @@ EbErrorType svt_release_object(EbObjectWrapper *object_ptr) {
     if ((object_ptr->release_enable == EB_TRUE) && (object_ptr->live_count == 0)) {
         // Set live_count to EB_ObjectWrapperReleasedValue
         object_ptr->live_count = EB_ObjectWrapperReleasedValue;
+        recycled               = EB_TRUE;
+
+        if (object_ptr->system_resource_ptr->release_hook) {
+            // The hook may re-enter the resource (e.g. to get an empty
+            // object), so it runs unlocked; the wrapper is owned by no one
+            // until it is pushed below.
+            svt_release_mutex(object_ptr->system_resource_ptr->empty_queue->lockout_mutex);
+            object_ptr->system_resource_ptr->release_hook(
+                object_ptr->system_resource_ptr->release_hook_ctx, object_ptr->object_ptr);
+            svt_block_on_mutex(object_ptr->system_resource_ptr->empty_queue->lockout_mutex);
+        }
 
         svt_muxing_queue_object_push_front(object_ptr->system_resource_ptr->empty_queue,
                                            object_ptr);
@@ -599,6 +1139,9 @@ EbErrorType svt_release_object(EbObjectWrapper *object_ptr) {
     }
 
     svt_release_mutex(object_ptr->system_resource_ptr->empty_queue->lockout_mutex);
+    // Counting takes the lockout mutexes
+    if (recycled)
+        svt_system_resource_notify_drain(object_ptr->system_resource_ptr);
 
     return return_error;
 }
@@ -612,7 +1155,7 @@ EbErrorType dump_srm_content(EbSystemResource *resource_ptr, uint8_t log)
     EbErrorType return_error = EB_ErrorNone;
     if (log) {
         SVT_LOG("SRM content:\n\n");
-        for (uint32_t wrapper_index = 0; wrapper_index < resource_ptr->object_total_count; ++wrapper_index) {
+        for (uint32_t wrapper_index = 0; wrapper_index < resource_ptr->constructed_count; ++wrapper_index) {
             SVT_LOG("%lld ", resource_ptr->wrapper_ptr_pool[wrapper_index]->pic_number);
         }
     }
@@ -635,9 +1178,44 @@ EbErrorType dump_srm_content(EbSystemResource *resource_ptr, uint8_t log)
  *      Double pointer used to pass the pointer to the empty
  *      EbObjectWrapper pointer.
  *********************************************************************/
-EbErrorType svt_get_empty_object(EbFifo *empty_fifo_ptr, EbObjectWrapper **wrapper_dbl_ptr) {
+static EbErrorType svt_get_empty_object_wait(EbFifo *          empty_fifo_ptr,
+                                             EbObjectWrapper **wrapper_dbl_ptr) {
     EbErrorType return_error = EB_ErrorNone;
 
+    EbSystemResource *elastic_ptr = empty_fifo_ptr->queue_ptr->elastic_resource_ptr;
+
+    if (empty_fifo_ptr->queue_ptr->ring_queue) {
+        EbRingQueue *ring_ptr = empty_fifo_ptr->queue_ptr->ring_queue;
+        EbBool       token    = EB_FALSE;
+        if (elastic_ptr) {
+            token = svt_ring_queue_try_wait(ring_ptr);
+            if (!token && (*wrapper_dbl_ptr = svt_system_resource_grow(elastic_ptr)) != NULL)
+                return return_error;
+        }
+        if (!token)
+            svt_ring_queue_wait(ring_ptr);
+        *wrapper_dbl_ptr = svt_ring_queue_pop(ring_ptr, empty_fifo_ptr);
+#if SRM_REPORT
+        //decrement the fullness
+        svt_atomic_fetch_add_u32(&empty_fifo_ptr->queue_ptr->curr_count, (uint32_t)-1);
+        if (empty_fifo_ptr->queue_ptr->log)
+            printf("SRM fullness-: %i/%i\n", empty_fifo_ptr->queue_ptr->curr_count, (*wrapper_dbl_ptr)->system_resource_ptr->object_total_count);
+#endif
+        // The object is owned by the caller from here on
+        (*wrapper_dbl_ptr)->live_count     = 0;
+        (*wrapper_dbl_ptr)->release_enable = EB_TRUE;
+        return return_error;
+    }
+
+    if (elastic_ptr) {
+        EbBool empty;
+        svt_block_on_mutex(empty_fifo_ptr->queue_ptr->lockout_mutex);
+        empty = svt_circular_buffer_empty_check(empty_fifo_ptr->queue_ptr->object_queue);
+        svt_release_mutex(empty_fifo_ptr->queue_ptr->lockout_mutex);
+        if (empty && (*wrapper_dbl_ptr = svt_system_resource_grow(elastic_ptr)) != NULL)
+            return return_error;
+    }
+
     // Queue the Fifo requesting the empty fifo
     svt_release_process(empty_fifo_ptr);
 
@@ -669,6 +1247,39 @@ EbErrorType svt_get_empty_object(EbFifo *empty_fifo_ptr, EbObjectWrapper **wrapp
     return return_error;
 }
 
+EbErrorType svt_get_empty_object(EbFifo *empty_fifo_ptr, EbObjectWrapper **wrapper_dbl_ptr) {
+    EbFifo *    consumer_fifo_ptr = current_consumer_fifo;
+    EbErrorType return_error;
+
+    if (!consumer_fifo_ptr)
+        return svt_get_empty_object_wait(empty_fifo_ptr, wrapper_dbl_ptr);
+    const uint64_t enter_ns = svt_av1_get_time_ns();
+    return_error            = svt_get_empty_object_wait(empty_fifo_ptr, wrapper_dbl_ptr);
+    consumer_fifo_ptr->empty_wait_ns += svt_av1_get_time_ns() - enter_ns;
+    return return_error;
+}
+
+/**************************************
+ * svt_fifo_gate_wait
+ *   Parks the consumer while its index is not below the active
+ *   process count of the queue. Whoever clears gate_parked posts
+ *   counting_semaphore exactly once. Setting gate_parked and storing
+ *   the count are full barriers, so either the consumer sees the new
+ *   count or svt_system_resource_set_active_consumers sees it parked.
+ **************************************/
+static void svt_fifo_gate_wait(EbFifo *fifo_ptr) {
+    volatile uint32_t *active_ptr = &fifo_ptr->queue_ptr->active_process_count;
+    while (fifo_ptr->process_index >= svt_atomic_load_u32(active_ptr) &&
+           !svt_fifo_quit_requested(fifo_ptr)) {
+        svt_atomic_cas_u32(&fifo_ptr->gate_parked, 0, 1);
+        if ((fifo_ptr->process_index < svt_atomic_load_u32(active_ptr) ||
+             svt_fifo_quit_requested(fifo_ptr)) &&
+            svt_atomic_cas_u32(&fifo_ptr->gate_parked, 1, 0))
+            break;
+        svt_block_on_semaphore(fifo_ptr->counting_semaphore);
+    }
+}
+
 /*********************************************************************
  * EbSystemResourceGetFullObject
  *   Dequeues an full EbObjectWrapper from the SystemResource. This
@@ -684,9 +1295,34 @@ EbErrorType svt_get_empty_object(EbFifo *empty_fifo_ptr, EbObjectWrapper **wrapp
  *      Double pointer used to pass the pointer to the full
  *      EbObjectWrapper pointer.
  *********************************************************************/
-EbErrorType svt_get_full_object(EbFifo *full_fifo_ptr, EbObjectWrapper **wrapper_dbl_ptr) {
+static EbErrorType svt_get_full_object_wait(EbFifo *          full_fifo_ptr,
+                                            EbObjectWrapper **wrapper_dbl_ptr) {
     EbErrorType return_error = EB_ErrorNone;
 
+    if (full_fifo_ptr->queue_ptr->ring_queue) {
+        EbRingQueue *ring_ptr = full_fifo_ptr->queue_ptr->ring_queue;
+        *wrapper_dbl_ptr      = NULL;
+        if (full_fifo_ptr->queue_ptr->consumer_hook) {
+            // Hooked consumers are scheduled per posted object, never block
+            if (svt_fifo_quit_requested(full_fifo_ptr))
+                return EB_NoErrorFifoShutdown;
+            // The job is scheduled again while objects are pending
+            if (svt_task_scheduler_yield_requested())
+                return EB_NoErrorEmptyQueue;
+            if (!svt_ring_queue_try_wait(ring_ptr))
+                return EB_NoErrorEmptyQueue;
+            *wrapper_dbl_ptr = svt_ring_queue_pop(ring_ptr, full_fifo_ptr);
+            return *wrapper_dbl_ptr ? return_error : EB_NoErrorFifoShutdown;
+        }
+        svt_fifo_gate_wait(full_fifo_ptr);
+        if (!svt_fifo_quit_requested(full_fifo_ptr)) {
+            svt_ring_queue_wait(ring_ptr);
+            if (!svt_fifo_quit_requested(full_fifo_ptr))
+                *wrapper_dbl_ptr = svt_ring_queue_pop(ring_ptr, full_fifo_ptr);
+        }
+        return *wrapper_dbl_ptr ? return_error : EB_NoErrorFifoShutdown;
+    }
+
     // Queue the Fifo requesting the full fifo
     svt_release_process(full_fifo_ptr);
 
@@ -720,10 +1356,20 @@ static EbBool svt_fifo_peak_front(EbFifo *fifoPtr) {
         return EB_FALSE;
 }
 
-EbErrorType svt_get_full_object_non_blocking(EbFifo *          full_fifo_ptr,
-                                             EbObjectWrapper **wrapper_dbl_ptr) {
+static EbErrorType svt_get_full_object_try(EbFifo *          full_fifo_ptr,
+                                           EbObjectWrapper **wrapper_dbl_ptr) {
     EbErrorType return_error = EB_ErrorNone;
     EbBool      fifo_empty;
+
+    if (full_fifo_ptr->queue_ptr->ring_queue) {
+        EbRingQueue *ring_ptr = full_fifo_ptr->queue_ptr->ring_queue;
+        //if the fifo is shutting down, we will not give any buffer to caller
+        if (!svt_fifo_quit_requested(full_fifo_ptr) && svt_ring_queue_try_wait(ring_ptr))
+            *wrapper_dbl_ptr = svt_ring_queue_pop(ring_ptr, full_fifo_ptr);
+        else
+            *wrapper_dbl_ptr = (EbObjectWrapper *)NULL;
+        return return_error;
+    }
     // Queue the Fifo requesting the full fifo
     svt_release_process(full_fifo_ptr);
 
@@ -740,9 +1386,48 @@ EbErrorType svt_get_full_object_non_blocking(EbFifo *          full_fifo_ptr,
     svt_release_mutex(full_fifo_ptr->lockout_mutex);
 
     if (fifo_empty == EB_FALSE)
-        svt_get_full_object(full_fifo_ptr, wrapper_dbl_ptr);
+        svt_get_full_object_wait(full_fifo_ptr, wrapper_dbl_ptr);
     else
         *wrapper_dbl_ptr = (EbObjectWrapper *)NULL;
 
     return return_error;
 }
+
+/* Both ways of getting a full object keep the same consumer telemetry */
+static EbErrorType svt_get_full_object_counted(EbFifo *          full_fifo_ptr,
+                                               EbObjectWrapper **wrapper_dbl_ptr,
+                                               EbBool            blocking) {
+    const uint64_t enter_ns = svt_av1_get_time_ns();
+
+    // The previous object is done
+    svt_trace_end();
+    if (full_fifo_ptr->last_return_ns)
+        full_fifo_ptr->busy_ns += enter_ns - full_fifo_ptr->last_return_ns;
+    const EbErrorType return_error = blocking
+        ? svt_get_full_object_wait(full_fifo_ptr, wrapper_dbl_ptr)
+        : svt_get_full_object_try(full_fifo_ptr, wrapper_dbl_ptr);
+    const uint64_t    return_ns    = svt_av1_get_time_ns();
+
+    full_fifo_ptr->full_wait_ns += return_ns - enter_ns;
+    if (*wrapper_dbl_ptr) {
+        full_fifo_ptr->item_count++;
+        full_fifo_ptr->last_return_ns = return_ns;
+        if (stage_thread)
+            current_consumer_fifo = full_fifo_ptr;
+    } else {
+        // Shut down, a hooked consumer returning to the scheduler or an
+        // empty queue: the consumer is not busy with an object
+        full_fifo_ptr->last_return_ns = 0;
+        current_consumer_fifo         = NULL;
+    }
+    return return_error;
+}
+
+EbErrorType svt_get_full_object(EbFifo *full_fifo_ptr, EbObjectWrapper **wrapper_dbl_ptr) {
+    return svt_get_full_object_counted(full_fifo_ptr, wrapper_dbl_ptr, EB_TRUE);
+}
+
+EbErrorType svt_get_full_object_non_blocking(EbFifo *          full_fifo_ptr,
+                                             EbObjectWrapper **wrapper_dbl_ptr) {
+    return svt_get_full_object_counted(full_fifo_ptr, wrapper_dbl_ptr, EB_FALSE);
+}
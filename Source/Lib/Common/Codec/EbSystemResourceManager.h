@@ -53,6 +53,10 @@ typedef struct EbObjectWrapper {
     //   only in the implemenation of a single-linked Fifo.
     struct EbObjectWrapper *next_ptr;
 
+    // signal_semaphore - set on an object that carries no data but asks its
+    //   consumer for an action, see svt_post_signal_object. NULL otherwise.
+    EbHandle signal_semaphore;
+
 #if SRM_REPORT
     uint64_t  pic_number;
 #endif
@@ -89,6 +93,25 @@ typedef struct EbFifo {
     // queue_ptr - pointer to MuxingQueue that the EbFifo is
     //   associated with.
     struct EbMuxingQueue *queue_ptr;
+
+    // process_index - index of the Fifo in its MuxingQueue
+    uint32_t process_index;
+
+    // gate_parked - set while the consumer waits on counting_semaphore
+    //   because its index is not below active_process_count (lock-free only)
+    volatile uint32_t gate_parked;
+
+    // Consumer telemetry, only written by the thread using the fifo:
+    //   item_count - objects taken from the full queue
+    //   busy_ns - time spent between svt_get_full_object calls
+    //   full_wait_ns - time blocked in svt_get_full_object
+    //   empty_wait_ns - time blocked in svt_get_empty_object, on any
+    //     resource, by the thread after it last took an object here
+    volatile uint64_t item_count;
+    volatile uint64_t busy_ns;
+    volatile uint64_t full_wait_ns;
+    volatile uint64_t empty_wait_ns;
+    uint64_t          last_return_ns;
 } EbFifo;
 
 /*********************************************************************
@@ -103,9 +126,63 @@ typedef struct EbCircularBuffer {
     uint32_t current_count;
 } EbCircularBuffer;
 
+/*********************************************************************
+     * RingQueue
+     *   Bounded lock-free multi-producer/multi-consumer queue of
+     *   EbObjectWrapper pointers. Each cell carries a sequence number
+     *   that tells producers and consumers whether the cell is free or
+     *   published, so neither side takes a lock. available_count is a
+     *   lightweight semaphore: a consumer first takes a token from it
+     *   (spinning briefly, then parking on park_semaphore), which
+     *   guarantees that a published cell is waiting to be dequeued.
+     *********************************************************************/
+typedef struct EbRingCell {
+    volatile uint64_t sequence;
+    EbObjectWrapper * wrapper_ptr;
+} EbRingCell;
+
+#define SRM_CACHE_LINE_SIZE 64
+
+typedef struct EbRingQueue {
+    EbDctor     dctor;
+    EbRingCell *cell_array;
+    uint64_t    mask;
+    EbHandle    park_semaphore;
+    // spin_count - polls before parking; 0 on single processor systems
+    //   where spinning only delays the producer.
+    uint32_t spin_count;
+    // producer and consumer positions are kept on separate cache lines
+    uint8_t           pad0[SRM_CACHE_LINE_SIZE];
+    volatile uint64_t enqueue_pos;
+    uint8_t           pad1[SRM_CACHE_LINE_SIZE - sizeof(uint64_t)];
+    volatile uint64_t dequeue_pos;
+    uint8_t           pad2[SRM_CACHE_LINE_SIZE - sizeof(uint64_t)];
+    // available_count - number of published objects not yet claimed;
+    //   negative values count the consumers parked on park_semaphore.
+    volatile int32_t available_count;
+    // max_available_count - high-water mark of available_count
+    volatile int32_t max_available_count;
+    uint8_t          pad3[SRM_CACHE_LINE_SIZE - 2 * sizeof(int32_t)];
+} EbRingQueue;
+
 /*********************************************************************
      * MuxingQueue
+     *   When ring_queue is set the queue is lock-free: objects are
+     *   handed to whichever process fifo asks first and the circular
+     *   buffers and lockout_mutex are not used on the data path.
+     *
+     *   consumer_hook, when set on a lock-free full queue, is called
+     *   after every posted object and the consumers no longer block:
+     *   svt_get_full_object returns EB_NoErrorEmptyQueue instead.
+     *
+     *   active_process_count limits the consumers of a lock-free full
+     *   queue: a process whose index is not below it parks before taking
+     *   the next object, until the count is raised again.
      *********************************************************************/
+typedef void (*EbConsumerHook)(void *hook_ctx);
+
+typedef void (*EbReleaseHook)(void *hook_ctx, EbPtr object_ptr);
+
 typedef struct EbMuxingQueue {
     EbDctor           dctor;
     EbHandle          lockout_mutex;
@@ -113,6 +190,15 @@ typedef struct EbMuxingQueue {
     EbCircularBuffer *process_queue;
     uint32_t          process_total_count;
     EbFifo **         process_fifo_ptr_array;
+    EbRingQueue *     ring_queue;
+    EbConsumerHook    consumer_hook;
+    void *            consumer_hook_ctx;
+    volatile uint32_t active_process_count;
+    // max_object_count - high-water mark of object_queue (muxing queues)
+    uint32_t max_object_count;
+    // elastic_resource_ptr - set on the empty queue of an elastic resource,
+    //   which constructs a new object instead of blocking when it is empty
+    struct EbSystemResource *elastic_resource_ptr;
 
 #if SRM_REPORT
     uint32_t         curr_count; //run time fullness
@@ -144,6 +230,27 @@ typedef struct EbSystemResource {
 
     // The full FIFO contains a queue of completed buffers
     EbMuxingQueue *full_queue;
+
+    // release_hook - called with the object of a wrapper that is about to
+    //   be recycled (its last reference was released), outside of any lock.
+    EbReleaseHook release_hook;
+    void *        release_hook_ctx;
+
+    // constructed_count - objects constructed so far, wrapper_ptr_pool is
+    //   filled up to it. Below object_total_count only for the elastic
+    //   resources, which keep what they need to construct more objects.
+    volatile uint32_t constructed_count;
+    EbHandle          grow_mutex;
+    EbCreator         object_creator;
+    EbPtr             object_init_data_ptr;
+    EbPtr             object_init_data_copy;
+    EbDctor           object_destroyer;
+    EbLargePages      large_pages; // page backing hint of the constructing thread
+
+    // drain_semaphore - posted by svt_release_object while drain_requested
+    //   is set, every time the resource gets its last object back
+    EbHandle          drain_semaphore;
+    volatile uint32_t drain_requested;
 } EbSystemResource;
 
 /*********************************************************************
@@ -227,6 +334,37 @@ extern EbErrorType svt_system_resource_ctor(EbSystemResource *resource_ptr,
                                             EbCreator object_ctor, EbPtr object_init_data_ptr,
                                             EbDctor object_destroyer);
 
+/*********************************************************************
+     * svt_system_resource_ctor_mode
+     *   Same as svt_system_resource_ctor, with an explicit choice of the
+     *   queue implementation instead of the SRM_LOCK_FREE default.
+     *
+     *   lock_free
+     *     EB_TRUE to use lock-free ring queues, EB_FALSE to use the
+     *     mutex and semaphore protected muxing queues.
+     *********************************************************************/
+extern EbErrorType svt_system_resource_ctor_mode(
+    EbSystemResource *resource_ptr, uint32_t object_total_count,
+    uint32_t producer_process_total_count, uint32_t consumer_process_total_count,
+    EbCreator object_ctor, EbPtr object_init_data_ptr, EbDctor object_destroyer, EbBool lock_free);
+
+/*********************************************************************
+     * svt_system_resource_ctor_elastic
+     *   Same as svt_system_resource_ctor, but only initial_count objects
+     *   are constructed. svt_get_empty_object constructs another one,
+     *   up to object_total_count, instead of blocking on the empty queue.
+     *
+     *   object_init_data_size
+     *     size of the block at object_init_data_ptr, which is copied as
+     *     objects are constructed after the call. 0 to keep the pointer,
+     *     which must then stay valid for the lifetime of the resource.
+     *********************************************************************/
+extern EbErrorType svt_system_resource_ctor_elastic(
+    EbSystemResource *resource_ptr, uint32_t initial_count, uint32_t object_total_count,
+    uint32_t producer_process_total_count, uint32_t consumer_process_total_count,
+    EbCreator object_ctor, EbPtr object_init_data_ptr, size_t object_init_data_size,
+    EbDctor object_destroyer);
+
 /*********************************************************************
      * svt_system_resource_get_producer_fifo
      *   get producer fifo
@@ -251,6 +389,114 @@ EbFifo *svt_system_resource_get_producer_fifo(const EbSystemResource *resource_p
      */
 EbFifo *svt_system_resource_get_consumer_fifo(const EbSystemResource *resource_ptr, uint32_t index);
 
+/*********************************************************************
+     * svt_system_resource_set_consumer_hook
+     *   Installs hook on the full queue: hook(hook_ctx) is called every
+     *   time an object is posted, and svt_get_full_object stops blocking
+     *   (see EbMuxingQueue). Only supported by the lock-free queues.
+     */
+extern EbErrorType svt_system_resource_set_consumer_hook(EbSystemResource *resource_ptr,
+                                                         EbConsumerHook hook, void *hook_ctx);
+
+/*********************************************************************
+     * svt_system_resource_set_release_hook
+     *   Installs hook on the empty queue: hook(hook_ctx, object) is called
+     *   by svt_release_object when the last reference to an object is
+     *   dropped, before the wrapper is handed back to the producers.
+     */
+extern void svt_system_resource_set_release_hook(EbSystemResource *resource_ptr,
+                                                 EbReleaseHook hook, void *hook_ctx);
+
+/*********************************************************************
+     * svt_system_resource_full_pending_count
+     *   Number of posted objects not yet taken by a consumer. Only exact
+     *   for the lock-free queues, the muxing queues report 0.
+     */
+extern uint32_t svt_system_resource_full_pending_count(const EbSystemResource *resource_ptr);
+
+/*********************************************************************
+     * svt_system_resource_shutdown_requested
+     *   True once svt_shutdown_process was called on the resource.
+     */
+extern EbBool svt_system_resource_shutdown_requested(const EbSystemResource *resource_ptr);
+
+/*********************************************************************
+     * svt_system_resource_full_waiting_count
+     *   Number of consumers blocked on the empty full queue, i.e. idle.
+     *   Consumers parked by svt_system_resource_set_active_consumers are
+     *   not counted. Only exact for the lock-free queues, the muxing
+     *   queues report 0.
+     */
+extern uint32_t svt_system_resource_full_waiting_count(const EbSystemResource *resource_ptr);
+
+/*********************************************************************
+     * svt_system_resource_empty_count
+     *   Number of objects back in the empty queue, constructed_count once
+     *   every object was released. Exact only while no object is being
+     *   taken or released.
+     */
+extern uint32_t svt_system_resource_empty_count(const EbSystemResource *resource_ptr);
+
+/*********************************************************************
+     * svt_system_resource_wait_drained
+     *   Blocks until every object constructed is back in the empty queue.
+     *   Fails with EB_ErrorSemaphoreUnresponsive after timeout_ms.
+     */
+extern EbErrorType svt_system_resource_wait_drained(EbSystemResource *resource_ptr,
+                                                    uint32_t          timeout_ms);
+
+/*********************************************************************
+     * svt_post_signal_object
+     *   Posts an object that carries no data to the consumers of the
+     *   resource of empty_fifo_ptr. The consumer that gets it checks
+     *   signal_semaphore before reading the object, runs the action the
+     *   caller asked for, and acknowledges with svt_release_signal_object,
+     *   which posts semaphore.
+     */
+extern EbErrorType svt_post_signal_object(EbFifo *empty_fifo_ptr, EbHandle semaphore);
+extern EbErrorType svt_release_signal_object(EbObjectWrapper *wrapper_ptr);
+
+/*********************************************************************
+     * svt_system_resource_get_consumer_stats
+     *   Sums the telemetry of the consumer fifos and reports the
+     *   current and maximum number of objects waiting in the full
+     *   queue. The counters are read without synchronisation and may
+     *   lag by one update.
+     */
+typedef struct EbConsumerStats {
+    uint32_t consumer_count;
+    uint64_t item_count;
+    uint64_t busy_ns;
+    uint64_t full_wait_ns;
+    uint64_t empty_wait_ns;
+    uint32_t queue_depth;
+    uint32_t max_queue_depth;
+} EbConsumerStats;
+
+extern void svt_system_resource_get_consumer_stats(const EbSystemResource *resource_ptr,
+                                                   EbConsumerStats *       stats_ptr);
+
+/*********************************************************************
+     * svt_system_resource_stage_begin / svt_system_resource_stage_end
+     *   Bracket the kernel of a stage on the thread running it. Only
+     *   between the two are the svt_get_empty_object waits of the thread
+     *   accounted to the consumer fifo it last took an object from, the
+     *   empty_wait_ns of EbConsumerStats. The application threads calling
+     *   the API are never stage threads.
+     */
+extern void svt_system_resource_stage_begin(void);
+extern void svt_system_resource_stage_end(void);
+
+/*********************************************************************
+     * svt_system_resource_set_active_consumers
+     *   Lets only the consumers with an index below active_count take
+     *   objects from the full queue; the others park before their next
+     *   svt_get_full_object. active_count is clamped to
+     *   [1, consumer count]. Only supported by the lock-free queues.
+     */
+extern EbErrorType svt_system_resource_set_active_consumers(EbSystemResource *resource_ptr,
+                                                            uint32_t          active_count);
+
 /*********************************************************************
      * EbSystemResourceGetEmptyObject
      *   Dequeues an empty EbObjectWrapper from the SystemResource.  The
@@ -336,7 +582,7 @@ extern EbErrorType svt_shutdown_process(const EbSystemResource *resource_ptr);
 #define EB_GET_FULL_OBJECT(full_fifo_ptr, wrapper_dbl_ptr)                     \
     do {                                                                       \
         EbErrorType err = svt_get_full_object(full_fifo_ptr, wrapper_dbl_ptr); \
-        if (err == EB_NoErrorFifoShutdown)                                     \
+        if (err == EB_NoErrorFifoShutdown || err == EB_NoErrorEmptyQueue)     \
             return NULL;                                                       \
     } while (0)
 
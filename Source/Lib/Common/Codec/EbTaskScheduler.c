@@ -0,0 +1,620 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#include <stdlib.h>
+
+#include "EbTaskScheduler.h"
+#include "EbTime.h"
+#include "EbLog.h"
+
+// Worker of the scheduler the calling thread belongs to, NULL outside the pool
+static SVT_THREAD_LOCAL EbTaskWorker *current_worker = NULL;
+
+/**************************************
+ * Worker deque
+ *   Bounded Chase-Lev deque. The capacity covers every task that can be
+ *   pending at once, so the owner never has to grow it.
+ **************************************/
+static EbBool task_worker_push(EbTaskWorker *worker_ptr, EbTask *task_ptr) {
+    const uint64_t mask   = worker_ptr->scheduler->mask;
+    const uint64_t bottom = worker_ptr->bottom;
+    const uint64_t top    = svt_atomic_load_u64(&worker_ptr->top);
+
+    if (bottom - top > mask)
+        return EB_FALSE;
+    worker_ptr->task_array[bottom & mask] = task_ptr;
+    // Publishes the task with a full barrier, see task_worker_park()
+    svt_atomic_fetch_add_u64(&worker_ptr->bottom, 1);
+    return EB_TRUE;
+}
+
+static EbTask *task_worker_pop(EbTaskWorker *worker_ptr) {
+    const uint64_t bottom = svt_atomic_fetch_add_u64(&worker_ptr->bottom, (uint64_t)-1) - 1;
+    const uint64_t top    = svt_atomic_load_u64(&worker_ptr->top);
+    EbTask *       task_ptr;
+
+    if ((int64_t)(bottom - top) < 0) {
+        svt_atomic_store_u64(&worker_ptr->bottom, bottom + 1);
+        return NULL;
+    }
+    task_ptr = worker_ptr->task_array[bottom & worker_ptr->scheduler->mask];
+    if (bottom != top)
+        return task_ptr;
+    // Last task, race the thieves for it
+    if (!svt_atomic_cas_u64(&worker_ptr->top, top, top + 1))
+        task_ptr = NULL;
+    svt_atomic_store_u64(&worker_ptr->bottom, bottom + 1);
+    return task_ptr;
+}
+
+static EbTask *task_worker_steal(EbTaskWorker *victim_ptr) {
+    const uint64_t top    = svt_atomic_load_u64(&victim_ptr->top);
+    const uint64_t bottom = svt_atomic_load_u64(&victim_ptr->bottom);
+    EbTask *       task_ptr;
+
+    if ((int64_t)(bottom - top) <= 0)
+        return NULL;
+    task_ptr = ((EbTask *volatile *)victim_ptr->task_array)[top & victim_ptr->scheduler->mask];
+    return svt_atomic_cas_u64(&victim_ptr->top, top, top + 1) ? task_ptr : NULL;
+}
+
+/**************************************
+ * Injection queue
+ *   Tasks submitted from threads outside the pool
+ **************************************/
+static EbBool task_inject_push(EbTaskScheduler *scheduler_ptr, EbTask *task_ptr) {
+    EbBool pushed = EB_FALSE;
+
+    svt_block_on_mutex(scheduler_ptr->inject_mutex);
+    if (scheduler_ptr->inject_tail - scheduler_ptr->inject_head <= scheduler_ptr->mask) {
+        scheduler_ptr->inject_array[scheduler_ptr->inject_tail++ & scheduler_ptr->mask] = task_ptr;
+        svt_atomic_fetch_add_i32(&scheduler_ptr->inject_count, 1);
+        pushed = EB_TRUE;
+    }
+    svt_release_mutex(scheduler_ptr->inject_mutex);
+    return pushed;
+}
+
+static EbTask *task_inject_pop(EbTaskScheduler *scheduler_ptr) {
+    EbTask *task_ptr = NULL;
+
+    if (svt_atomic_load_i32(&scheduler_ptr->inject_count) <= 0)
+        return NULL;
+    svt_block_on_mutex(scheduler_ptr->inject_mutex);
+    if (scheduler_ptr->inject_head != scheduler_ptr->inject_tail) {
+        task_ptr = scheduler_ptr->inject_array[scheduler_ptr->inject_head++ & scheduler_ptr->mask];
+        svt_atomic_fetch_add_i32(&scheduler_ptr->inject_count, -1);
+    }
+    svt_release_mutex(scheduler_ptr->inject_mutex);
+    return task_ptr;
+}
+
+/**************************************
+ * Group queues
+ *   Served in weighted fair order, see EbTaskGroup
+ **************************************/
+static EbTask *task_group_pop(EbTaskScheduler *scheduler_ptr, EbTaskGroup **group_dbl_ptr) {
+    EbTask *     task_ptr = NULL;
+    EbTaskGroup *best_ptr = NULL;
+
+    if (svt_atomic_load_i32(&scheduler_ptr->group_pending_count) <= 0)
+        return NULL;
+    svt_block_on_mutex(scheduler_ptr->group_mutex);
+    for (EbTaskGroup *group_ptr = scheduler_ptr->group_list; group_ptr;
+         group_ptr = group_ptr->next_ptr) {
+        if (group_ptr->head != group_ptr->tail &&
+            (!best_ptr ||
+             svt_atomic_load_u64(&group_ptr->vtime) < svt_atomic_load_u64(&best_ptr->vtime)))
+            best_ptr = group_ptr;
+    }
+    if (best_ptr) {
+        task_ptr = best_ptr->task_array[best_ptr->head++ & scheduler_ptr->mask];
+        scheduler_ptr->group_min_vtime = svt_atomic_load_u64(&best_ptr->vtime);
+        svt_atomic_fetch_add_u32(&best_ptr->active_count, 1);
+        svt_atomic_fetch_add_i32(&scheduler_ptr->group_pending_count, -1);
+        *group_dbl_ptr = best_ptr;
+    }
+    svt_release_mutex(scheduler_ptr->group_mutex);
+    return task_ptr;
+}
+
+static void task_group_run(EbTaskWorker *worker_ptr, EbTaskGroup *group_ptr, EbTask *task_ptr) {
+    worker_ptr->current_group = group_ptr;
+    worker_ptr->task_start_ns = svt_av1_get_time_ns();
+    task_ptr->fn(task_ptr->arg);
+    const uint64_t run_ns     = svt_av1_get_time_ns() - worker_ptr->task_start_ns;
+    worker_ptr->current_group = NULL;
+    svt_atomic_fetch_add_u64(&group_ptr->vtime, run_ns / group_ptr->weight);
+    svt_atomic_fetch_add_u64(&group_ptr->run_ns, run_ns);
+    // Last access, the group may be destroyed once it is idle
+    svt_block_on_mutex(worker_ptr->scheduler->group_mutex);
+    if (svt_atomic_fetch_add_u32(&group_ptr->active_count, (uint32_t)-1) == 1 && group_ptr->closing)
+        svt_post_semaphore(group_ptr->idle_semaphore);
+    svt_release_mutex(worker_ptr->scheduler->group_mutex);
+}
+
+/**************************************
+ * Worker parking
+ *   sleeper_count counts the parked workers that no one has claimed yet.
+ *   A waker claims one by decrementing it and then posts the semaphore.
+ **************************************/
+static EbBool task_claim_sleeper(EbTaskScheduler *scheduler_ptr) {
+    int32_t count = svt_atomic_load_i32(&scheduler_ptr->sleeper_count);
+    while (count > 0) {
+        if (svt_atomic_cas_i32(&scheduler_ptr->sleeper_count, count, count - 1))
+            return EB_TRUE;
+        count = svt_atomic_load_i32(&scheduler_ptr->sleeper_count);
+    }
+    return EB_FALSE;
+}
+
+static EbBool task_wake_one(EbTaskScheduler *scheduler_ptr) {
+    if (!task_claim_sleeper(scheduler_ptr))
+        return EB_FALSE;
+    svt_post_semaphore(scheduler_ptr->wake_semaphore);
+    return EB_TRUE;
+}
+
+// Workers neither parked nor blocked inside a task
+static int32_t task_running_count(EbTaskScheduler *scheduler_ptr) {
+    return (int32_t)svt_atomic_load_u32(&scheduler_ptr->started_count) -
+        svt_atomic_fetch_add_i32(&scheduler_ptr->blocked_count, 0) -
+        svt_atomic_fetch_add_i32(&scheduler_ptr->sleeper_count, 0);
+}
+
+static EbBool task_available(EbTaskScheduler *scheduler_ptr) {
+    const uint32_t started_count = svt_atomic_load_u32(&scheduler_ptr->started_count);
+
+    if (svt_atomic_load_i32(&scheduler_ptr->inject_count) > 0 ||
+        svt_atomic_load_i32(&scheduler_ptr->group_pending_count) > 0)
+        return EB_TRUE;
+    for (uint32_t i = 0; i < started_count; ++i) {
+        EbTaskWorker *worker_ptr = &scheduler_ptr->worker_array[i];
+        if ((int64_t)(svt_atomic_load_u64(&worker_ptr->bottom) -
+                      svt_atomic_load_u64(&worker_ptr->top)) > 0)
+            return EB_TRUE;
+    }
+    return EB_FALSE;
+}
+
+/* An idle worker rechecks for work after registering as a sleeper, so a
+ * task pushed before the registration is found here and one pushed after
+ * it sees the sleeper. A surplus worker parks even if work is pending. */
+static void task_worker_park(EbTaskScheduler *scheduler_ptr, EbBool surplus) {
+    svt_atomic_fetch_add_i32(&scheduler_ptr->sleeper_count, 1);
+    if (svt_atomic_load_u32(&scheduler_ptr->quit) || (!surplus && task_available(scheduler_ptr))) {
+        // Take the registration back unless a waker claimed it already
+        if (task_claim_sleeper(scheduler_ptr))
+            return;
+    }
+    svt_block_on_semaphore(scheduler_ptr->wake_semaphore);
+}
+
+static EbTask *task_worker_find(EbTaskWorker *worker_ptr, EbTaskGroup **group_dbl_ptr) {
+    EbTaskScheduler *scheduler_ptr = worker_ptr->scheduler;
+    EbTask *         task_ptr      = task_worker_pop(worker_ptr);
+    uint32_t         started_count;
+
+    if (task_ptr)
+        return task_ptr;
+    task_ptr = task_inject_pop(scheduler_ptr);
+    if (task_ptr)
+        return task_ptr;
+    task_ptr = task_group_pop(scheduler_ptr, group_dbl_ptr);
+    if (task_ptr)
+        return task_ptr;
+
+    // Steal, starting from a pseudo random victim
+    started_count = svt_atomic_load_u32(&scheduler_ptr->started_count);
+    // A new worker can run before its spawner has counted it
+    if (started_count <= worker_ptr->index)
+        started_count = worker_ptr->index + 1;
+    worker_ptr->steal_seed = worker_ptr->steal_seed * 1103515245 + 12345;
+    for (uint32_t i = 0, start = (worker_ptr->steal_seed >> 16) % started_count; i < started_count;
+         ++i) {
+        const uint32_t victim = (start + i) % started_count;
+        if (victim == worker_ptr->index)
+            continue;
+        task_ptr = task_worker_steal(&scheduler_ptr->worker_array[victim]);
+        if (task_ptr)
+            return task_ptr;
+    }
+    return NULL;
+}
+
+static void *task_worker_kernel(void *input_ptr) {
+    EbTaskWorker *   worker_ptr    = (EbTaskWorker *)input_ptr;
+    EbTaskScheduler *scheduler_ptr = worker_ptr->scheduler;
+
+    current_worker = worker_ptr;
+    for (;;) {
+        // Spare workers started for blocked tasks step back once those resume
+        const EbBool surplus   = task_running_count(scheduler_ptr) > (int32_t)scheduler_ptr->worker_count;
+        EbTaskGroup *group_ptr = NULL;
+        EbTask *     task_ptr  = surplus ? NULL : task_worker_find(worker_ptr, &group_ptr);
+
+        if (task_ptr) {
+            if (group_ptr)
+                task_group_run(worker_ptr, group_ptr, task_ptr);
+            else
+                task_ptr->fn(task_ptr->arg);
+            continue;
+        }
+        if (svt_atomic_load_u32(&scheduler_ptr->quit))
+            break;
+        task_worker_park(scheduler_ptr, surplus);
+    }
+    current_worker = NULL;
+    return NULL;
+}
+
+/* Fails once max_worker_count threads run, or when the thread cannot be
+ * created */
+static EbBool task_spawn_worker(EbTaskScheduler *scheduler_ptr) {
+    EbBool spawned = EB_FALSE;
+
+    svt_block_on_mutex(scheduler_ptr->spawn_mutex);
+    const uint32_t index = scheduler_ptr->started_count;
+    if (index < scheduler_ptr->max_worker_count && !scheduler_ptr->quit) {
+        EbTaskWorker *worker_ptr = &scheduler_ptr->worker_array[index];
+        // Deques are allocated on demand, most spare workers are never started
+        EB_NO_THROW_MALLOC(worker_ptr->task_array, sizeof(EbTask *) * (scheduler_ptr->mask + 1));
+        if (worker_ptr->task_array)
+            worker_ptr->thread_handle = svt_create_thread(task_worker_kernel, worker_ptr);
+        EB_NO_THROW_ADD_MEM(worker_ptr->thread_handle, 1, EB_THREAD);
+        if (worker_ptr->thread_handle) {
+            if (scheduler_ptr->thread_init)
+                scheduler_ptr->thread_init(worker_ptr->thread_handle);
+            svt_atomic_fetch_add_u32(&scheduler_ptr->started_count, 1);
+            spawned = EB_TRUE;
+        }
+    }
+    svt_release_mutex(scheduler_ptr->spawn_mutex);
+    return spawned;
+}
+
+static void svt_task_scheduler_dctor(EbPtr p) {
+    EbTaskScheduler *obj = (EbTaskScheduler *)p;
+
+    if (obj->spawn_mutex) {
+        svt_block_on_mutex(obj->spawn_mutex);
+        svt_atomic_store_u32(&obj->quit, 1);
+        svt_release_mutex(obj->spawn_mutex);
+        for (uint32_t i = 0; i < obj->started_count; ++i)
+            svt_post_semaphore(obj->wake_semaphore);
+        for (uint32_t i = 0; i < obj->started_count; ++i)
+            EB_DESTROY_THREAD(obj->worker_array[i].thread_handle);
+    }
+    if (obj->worker_array) {
+        for (uint32_t i = 0; i < obj->max_worker_count; ++i)
+            EB_FREE_ARRAY(obj->worker_array[i].task_array);
+    }
+    EB_FREE_ARRAY(obj->worker_array);
+    EB_FREE_ARRAY(obj->inject_array);
+    EB_DESTROY_SEMAPHORE(obj->wake_semaphore);
+    EB_DESTROY_MUTEX(obj->group_mutex);
+    EB_DESTROY_MUTEX(obj->inject_mutex);
+    EB_DESTROY_MUTEX(obj->spawn_mutex);
+}
+
+/**************************************
+ * svt_task_scheduler_ctor
+ **************************************/
+EbErrorType svt_task_scheduler_ctor(EbTaskScheduler *scheduler_ptr, uint32_t worker_count,
+                                    uint32_t max_spare_count, uint32_t queue_capacity,
+                                    EbTaskThreadInit thread_init) {
+    uint64_t capacity = 1;
+
+    scheduler_ptr->dctor            = svt_task_scheduler_dctor;
+    scheduler_ptr->worker_count     = worker_count ? worker_count : 1;
+    scheduler_ptr->max_worker_count = scheduler_ptr->worker_count + max_spare_count;
+    scheduler_ptr->thread_init      = thread_init;
+    scheduler_ptr->queue_capacity   = queue_capacity;
+
+    while (capacity < queue_capacity) capacity <<= 1;
+    scheduler_ptr->mask = capacity - 1;
+
+    EB_CALLOC_ARRAY(scheduler_ptr->worker_array, scheduler_ptr->max_worker_count);
+    for (uint32_t i = 0; i < scheduler_ptr->max_worker_count; ++i) {
+        EbTaskWorker *worker_ptr = &scheduler_ptr->worker_array[i];
+        worker_ptr->scheduler    = scheduler_ptr;
+        worker_ptr->index        = i;
+        worker_ptr->steal_seed   = i + 1;
+    }
+    EB_MALLOC_ARRAY(scheduler_ptr->inject_array, capacity);
+    EB_CREATE_MUTEX(scheduler_ptr->inject_mutex);
+    EB_CREATE_MUTEX(scheduler_ptr->group_mutex);
+    EB_CREATE_SEMAPHORE(scheduler_ptr->wake_semaphore, 0, 2 * scheduler_ptr->max_worker_count);
+    EB_CREATE_MUTEX(scheduler_ptr->spawn_mutex);
+
+    for (uint32_t i = 0; i < scheduler_ptr->worker_count; ++i) {
+        if (!task_spawn_worker(scheduler_ptr))
+            return EB_ErrorInsufficientResources;
+    }
+
+    return EB_ErrorNone;
+}
+
+void svt_task_scheduler_submit(EbTaskScheduler *scheduler_ptr, EbTask *task_ptr) {
+    EbTaskWorker *worker_ptr = current_worker;
+    EbBool        pushed     = worker_ptr && worker_ptr->scheduler == scheduler_ptr &&
+        task_worker_push(worker_ptr, task_ptr);
+
+    if (!pushed)
+        pushed = task_inject_push(scheduler_ptr, task_ptr);
+    // The clients keep the pending tasks within the queue capacity
+    assert(pushed);
+    if (!pushed) {
+        SVT_ERROR("task scheduler: more tasks pending than the queue capacity %u\n",
+                  scheduler_ptr->queue_capacity);
+        return;
+    }
+    if (task_running_count(scheduler_ptr) < (int32_t)scheduler_ptr->worker_count)
+        task_wake_one(scheduler_ptr);
+}
+
+EbErrorType svt_task_scheduler_reserve(EbTaskScheduler *scheduler_ptr, uint32_t spare_count,
+                                       uint32_t queue_count) {
+    const uint32_t max_spare_count = scheduler_ptr->max_worker_count - scheduler_ptr->worker_count;
+    EbErrorType    return_error    = EB_ErrorNone;
+
+    svt_block_on_mutex(scheduler_ptr->spawn_mutex);
+    if (spare_count > max_spare_count - scheduler_ptr->reserved_spare_count ||
+        queue_count > scheduler_ptr->queue_capacity - scheduler_ptr->reserved_queue_count)
+        return_error = EB_ErrorInsufficientResources;
+    else {
+        scheduler_ptr->reserved_spare_count += spare_count;
+        scheduler_ptr->reserved_queue_count += queue_count;
+    }
+    svt_release_mutex(scheduler_ptr->spawn_mutex);
+    return return_error;
+}
+
+void svt_task_scheduler_unreserve(EbTaskScheduler *scheduler_ptr, uint32_t spare_count,
+                                  uint32_t queue_count) {
+    svt_block_on_mutex(scheduler_ptr->spawn_mutex);
+    assert(scheduler_ptr->reserved_spare_count >= spare_count &&
+           scheduler_ptr->reserved_queue_count >= queue_count);
+    scheduler_ptr->reserved_spare_count -= spare_count;
+    scheduler_ptr->reserved_queue_count -= queue_count;
+    svt_release_mutex(scheduler_ptr->spawn_mutex);
+}
+
+uint32_t svt_task_scheduler_thread_count(EbTaskScheduler *scheduler_ptr) {
+    return svt_atomic_load_u32(&scheduler_ptr->started_count);
+}
+
+/**************************************
+ * Managed blocking
+ *   A worker about to block hands its core over to a parked worker, or
+ *   to a new spare one, so queued tasks keep running. Without it the
+ *   pool could deadlock with every worker waiting for an object that
+ *   only a queued task would release. There is always a spare worker
+ *   left as long as the clients reserve one per task that may block.
+ **************************************/
+void svt_task_scheduler_block_begin(void) {
+    EbTaskWorker *   worker_ptr = current_worker;
+    EbTaskScheduler *scheduler_ptr;
+
+    if (!worker_ptr)
+        return;
+    scheduler_ptr = worker_ptr->scheduler;
+    svt_atomic_fetch_add_i32(&scheduler_ptr->blocked_count, 1);
+    if (task_running_count(scheduler_ptr) < (int32_t)scheduler_ptr->worker_count &&
+        !task_wake_one(scheduler_ptr) && !task_spawn_worker(scheduler_ptr) &&
+        !svt_atomic_load_u32(&scheduler_ptr->quit))
+        SVT_ERROR("task scheduler: no spare worker left for a blocked task, %u started\n",
+                  svt_atomic_load_u32(&scheduler_ptr->started_count));
+}
+
+void svt_task_scheduler_block_end(void) {
+    EbTaskWorker *worker_ptr = current_worker;
+
+    if (worker_ptr)
+        svt_atomic_fetch_add_i32(&worker_ptr->scheduler->blocked_count, -1);
+}
+
+EbBool svt_task_scheduler_yield_requested(void) {
+    EbTaskWorker *worker_ptr = current_worker;
+
+    if (!worker_ptr || !worker_ptr->current_group ||
+        svt_atomic_load_i32(&worker_ptr->scheduler->group_pending_count) <= 0)
+        return EB_FALSE;
+    return svt_av1_get_time_ns() - worker_ptr->task_start_ns > TASK_GROUP_QUANTUM_NS;
+}
+
+/**************************************
+ * Task groups
+ **************************************/
+void svt_task_group_submit(EbTaskGroup *group_ptr, EbTask *task_ptr) {
+    EbTaskScheduler *scheduler_ptr = group_ptr->scheduler;
+    EbBool           pushed        = EB_FALSE;
+
+    svt_block_on_mutex(scheduler_ptr->group_mutex);
+    if (group_ptr->tail - group_ptr->head <= scheduler_ptr->mask) {
+        if (group_ptr->head == group_ptr->tail) {
+            // No credit for the time the group had nothing queued
+            uint64_t vtime = svt_atomic_load_u64(&group_ptr->vtime);
+            while (vtime < scheduler_ptr->group_min_vtime &&
+                   !svt_atomic_cas_u64(&group_ptr->vtime, vtime, scheduler_ptr->group_min_vtime))
+                vtime = svt_atomic_load_u64(&group_ptr->vtime);
+        }
+        group_ptr->task_array[group_ptr->tail++ & scheduler_ptr->mask] = task_ptr;
+        svt_atomic_fetch_add_i32(&scheduler_ptr->group_pending_count, 1);
+        pushed = EB_TRUE;
+    }
+    svt_release_mutex(scheduler_ptr->group_mutex);
+    // The clients keep the pending tasks within the queue capacity
+    assert(pushed);
+    if (!pushed) {
+        SVT_ERROR("task group: more tasks pending than the queue capacity %u\n",
+                  scheduler_ptr->queue_capacity);
+        return;
+    }
+    if (task_running_count(scheduler_ptr) < (int32_t)scheduler_ptr->worker_count)
+        task_wake_one(scheduler_ptr);
+}
+
+static void svt_task_group_dctor(EbPtr p) {
+    EbTaskGroup *    obj           = (EbTaskGroup *)p;
+    EbTaskScheduler *scheduler_ptr = obj->scheduler;
+
+    if (scheduler_ptr) {
+        svt_block_on_mutex(scheduler_ptr->group_mutex);
+        for (EbTaskGroup **link_ptr = &scheduler_ptr->group_list; *link_ptr;
+             link_ptr               = &(*link_ptr)->next_ptr) {
+            if (*link_ptr == obj) {
+                *link_ptr = obj->next_ptr;
+                break;
+            }
+        }
+        obj->closing      = EB_TRUE;
+        const EbBool busy = svt_atomic_load_u32(&obj->active_count) != 0;
+        svt_release_mutex(scheduler_ptr->group_mutex);
+        if (busy) {
+            svt_block_on_semaphore(obj->idle_semaphore);
+            // The last task posts with the mutex held, wait until it is out
+            svt_block_on_mutex(scheduler_ptr->group_mutex);
+            svt_release_mutex(scheduler_ptr->group_mutex);
+        }
+    }
+    EB_FREE_ARRAY(obj->task_array);
+    EB_DESTROY_SEMAPHORE(obj->idle_semaphore);
+}
+
+/**************************************
+ * svt_task_group_ctor
+ **************************************/
+EbErrorType svt_task_group_ctor(EbTaskGroup *group_ptr, EbTaskScheduler *scheduler_ptr,
+                                uint32_t weight) {
+    group_ptr->dctor  = svt_task_group_dctor;
+    group_ptr->weight = weight ? weight : 1;
+    EB_MALLOC_ARRAY(group_ptr->task_array, scheduler_ptr->mask + 1);
+    EB_CREATE_SEMAPHORE(group_ptr->idle_semaphore, 0, 1);
+
+    svt_block_on_mutex(scheduler_ptr->group_mutex);
+    group_ptr->scheduler      = scheduler_ptr;
+    group_ptr->vtime          = scheduler_ptr->group_min_vtime;
+    group_ptr->next_ptr       = scheduler_ptr->group_list;
+    scheduler_ptr->group_list = group_ptr;
+    svt_release_mutex(scheduler_ptr->group_mutex);
+    return EB_ErrorNone;
+}
+
+/**************************************
+ * Kernel jobs
+ **************************************/
+/* Ends a run counted in scheduled_count. Last access to the job once it is
+ * stopped, returns the stopped state seen */
+static EbBool kernel_job_release_run(EbKernelJob *job_ptr) {
+    svt_block_on_mutex(job_ptr->context_mutex);
+    // Read after the count, against the order of svt_kernel_job_stop()
+    const uint32_t count   = svt_atomic_fetch_add_u32(&job_ptr->scheduled_count, (uint32_t)-1);
+    const EbBool   stopped = svt_atomic_load_u32(&job_ptr->stopped) != 0;
+    if (count == 1 && stopped)
+        svt_post_semaphore(job_ptr->stop_semaphore);
+    svt_release_mutex(job_ptr->context_mutex);
+    return stopped;
+}
+
+static void svt_kernel_job_schedule(void *p) {
+    EbKernelJob *job_ptr = (EbKernelJob *)p;
+    uint32_t     count   = svt_atomic_load_u32(&job_ptr->scheduled_count);
+
+    while (count < job_ptr->context_count && !svt_atomic_load_u32(&job_ptr->stopped)) {
+        if (svt_atomic_cas_u32(&job_ptr->scheduled_count, count, count + 1)) {
+            // Checked again after counting the run, see svt_kernel_job_stop()
+            if (svt_atomic_load_u32(&job_ptr->stopped))
+                kernel_job_release_run(job_ptr);
+            else if (job_ptr->group_ptr)
+                svt_task_group_submit(job_ptr->group_ptr, &job_ptr->task);
+            else
+                svt_task_scheduler_submit(job_ptr->scheduler_ptr, &job_ptr->task);
+            return;
+        }
+        count = svt_atomic_load_u32(&job_ptr->scheduled_count);
+    }
+}
+
+static void svt_kernel_job_run(void *p) {
+    EbKernelJob *job_ptr = (EbKernelJob *)p;
+    EbPtr        context_ptr;
+
+    // scheduled_count never exceeds context_count, so a context is free
+    svt_block_on_mutex(job_ptr->context_mutex);
+    context_ptr = job_ptr->free_context_array[--job_ptr->free_context_count];
+    svt_release_mutex(job_ptr->context_mutex);
+
+    if (!svt_atomic_load_u32(&job_ptr->stopped)) {
+        svt_system_resource_stage_begin();
+        job_ptr->kernel(context_ptr);
+        svt_system_resource_stage_end();
+    }
+
+    svt_block_on_mutex(job_ptr->context_mutex);
+    job_ptr->free_context_array[job_ptr->free_context_count++] = context_ptr;
+    svt_release_mutex(job_ptr->context_mutex);
+
+    if (kernel_job_release_run(job_ptr))
+        return;
+    // An object posted after the kernel found the queue empty, while every
+    // run was still counted as scheduled, has not scheduled one of its own.
+    // Also resumes a run that gave up its time slice.
+    if (svt_system_resource_full_pending_count(job_ptr->input_resource_ptr) &&
+        !svt_system_resource_shutdown_requested(job_ptr->input_resource_ptr))
+        svt_kernel_job_schedule(job_ptr);
+}
+
+void svt_kernel_job_stop(EbKernelJob *job_ptr) {
+    // Full barrier against the check in svt_kernel_job_schedule()
+    svt_atomic_fetch_add_u32(&job_ptr->stopped, 1);
+    // Every run released from now on sees stopped, the last one posts
+    while (svt_atomic_load_u32(&job_ptr->scheduled_count))
+        svt_block_on_semaphore(job_ptr->stop_semaphore);
+    // The last run posts with the mutex held, wait until it is out
+    svt_block_on_mutex(job_ptr->context_mutex);
+    svt_release_mutex(job_ptr->context_mutex);
+}
+
+static void svt_kernel_job_dctor(EbPtr p) {
+    EbKernelJob *obj = (EbKernelJob *)p;
+    EB_FREE_ARRAY(obj->free_context_array);
+    EB_DESTROY_SEMAPHORE(obj->stop_semaphore);
+    EB_DESTROY_MUTEX(obj->context_mutex);
+}
+
+/**************************************
+ * svt_kernel_job_ctor
+ **************************************/
+EbErrorType svt_kernel_job_ctor(EbKernelJob *job_ptr, EbTaskScheduler *scheduler_ptr,
+                                EbTaskGroup *group_ptr, EbSystemResource *input_resource_ptr,
+                                EbKernelFn kernel, EbPtr *context_ptr_array,
+                                uint32_t context_count) {
+    job_ptr->dctor              = svt_kernel_job_dctor;
+    job_ptr->scheduler_ptr      = scheduler_ptr;
+    job_ptr->group_ptr          = group_ptr;
+    job_ptr->input_resource_ptr = input_resource_ptr;
+    job_ptr->kernel             = kernel;
+    job_ptr->task.fn            = svt_kernel_job_run;
+    job_ptr->task.arg           = job_ptr;
+    job_ptr->context_ptr_array  = context_ptr_array;
+    job_ptr->context_count      = context_count;
+
+    EB_CREATE_MUTEX(job_ptr->context_mutex);
+    EB_CREATE_SEMAPHORE(job_ptr->stop_semaphore, 0, context_count);
+    EB_MALLOC_ARRAY(job_ptr->free_context_array, context_count);
+    for (uint32_t i = 0; i < context_count; ++i)
+        job_ptr->free_context_array[i] = context_ptr_array[i];
+    job_ptr->free_context_count = context_count;
+
+    return svt_system_resource_set_consumer_hook(
+        input_resource_ptr, svt_kernel_job_schedule, job_ptr);
+}
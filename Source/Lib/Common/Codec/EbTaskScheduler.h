@@ -0,0 +1,241 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#ifndef EbTaskScheduler_h
+#define EbTaskScheduler_h
+
+#include "EbDefinitions.h"
+#include "EbObject.h"
+#include "EbThreads.h"
+#include "EbSystemResourceManager.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************************************************************
+ * Task
+ *   A unit of work run by the scheduler. The same task may be submitted
+ *   several times; every submission results in one call of fn.
+ *********************************************************************/
+typedef void (*EbTaskFn)(void *arg);
+
+typedef struct EbTask {
+    EbTaskFn fn;
+    void *   arg;
+} EbTask;
+
+/* Called once for every thread the scheduler creates, e.g. to pin it */
+typedef void (*EbTaskThreadInit)(EbHandle thread_handle);
+
+struct EbTaskGroup;
+
+/*********************************************************************
+ * TaskWorker
+ *   One pool thread and its bounded Chase-Lev deque. The owner pushes
+ *   and pops at the bottom, idle workers steal from the top.
+ *********************************************************************/
+typedef struct EbTaskWorker {
+    struct EbTaskScheduler *scheduler;
+    EbHandle                thread_handle;
+    EbTask **               task_array;
+    uint32_t                index;
+    uint32_t                steal_seed;
+    // current_group - group of the running task, NULL for ungrouped tasks
+    struct EbTaskGroup *current_group;
+    uint64_t            task_start_ns;
+    uint8_t             pad0[SRM_CACHE_LINE_SIZE];
+    volatile uint64_t   top;
+    uint8_t             pad1[SRM_CACHE_LINE_SIZE - sizeof(uint64_t)];
+    volatile uint64_t   bottom;
+    uint8_t             pad2[SRM_CACHE_LINE_SIZE - sizeof(uint64_t)];
+} EbTaskWorker;
+
+/*********************************************************************
+ * TaskScheduler
+ *   Work-stealing pool shared by all the kernels of an encoder.
+ *   worker_count threads run tasks; when a task blocks inside the
+ *   system resource manager (svt_task_scheduler_block_begin/end) a
+ *   parked worker is woken, or a spare one is started, so that the
+ *   number of running workers stays at worker_count. Spare workers
+ *   park again once the blocked ones resume.
+ *
+ *   Tasks submitted from threads outside the pool go through the
+ *   mutex protected inject_array. Grouped tasks go through the queue of
+ *   their group, see EbTaskGroup.
+ *
+ *   The queues are not grown: the clients of a scheduler keep the
+ *   pending tasks within queue_capacity. When several clients share it,
+ *   each one reserves its share of the spare workers and of the queue
+ *   capacity with svt_task_scheduler_reserve.
+ *********************************************************************/
+typedef struct EbTaskScheduler {
+    EbDctor          dctor;
+    EbTaskWorker *   worker_array;
+    uint32_t         worker_count;
+    uint32_t         max_worker_count;
+    uint64_t         mask;
+    EbTaskThreadInit thread_init;
+    EbHandle         spawn_mutex;
+    EbHandle         inject_mutex;
+    EbTask **        inject_array;
+    uint64_t         inject_head;
+    uint64_t         inject_tail;
+    EbHandle         wake_semaphore;
+    // started_count - threads created so far, only grows
+    volatile uint32_t started_count;
+    volatile int32_t  inject_count;
+    // sleeper_count - workers parked on wake_semaphore
+    volatile int32_t sleeper_count;
+    // blocked_count - workers blocked inside a task
+    volatile int32_t  blocked_count;
+    volatile uint32_t quit;
+    // group_mutex - guards group_list, the group queues and group_min_vtime
+    EbHandle            group_mutex;
+    struct EbTaskGroup *group_list;
+    uint64_t            group_min_vtime;
+    volatile int32_t    group_pending_count;
+    // reserved_spare_count, reserved_queue_count - shares taken by the
+    //   clients, guarded by spawn_mutex
+    uint32_t queue_capacity;
+    uint32_t reserved_spare_count;
+    uint32_t reserved_queue_count;
+} EbTaskScheduler;
+
+/*********************************************************************
+ * svt_task_scheduler_ctor
+ *   worker_count
+ *     number of workers running tasks at any time.
+ *   max_spare_count
+ *     extra workers that may be started while tasks are blocked.
+ *   queue_capacity
+ *     upper bound on the number of tasks pending at any time, submitting
+ *     more is a usage error.
+ *   thread_init
+ *     optional callback applied to every created thread.
+ *********************************************************************/
+extern EbErrorType svt_task_scheduler_ctor(EbTaskScheduler *scheduler_ptr, uint32_t worker_count,
+                                           uint32_t max_spare_count, uint32_t queue_capacity,
+                                           EbTaskThreadInit thread_init);
+
+/* Queues task on the calling worker's deque, or on the injection queue
+ * when called from a thread that does not belong to the pool */
+extern void svt_task_scheduler_submit(EbTaskScheduler *scheduler_ptr, EbTask *task_ptr);
+
+/* Reserves spare_count spare workers and queue_count pending tasks for
+ * one client, i.e. the number of its tasks that may block at once and
+ * that may be pending at once. Fails with EB_ErrorInsufficientResources
+ * when the budget given at construction would be exceeded */
+extern EbErrorType svt_task_scheduler_reserve(EbTaskScheduler *scheduler_ptr, uint32_t spare_count,
+                                              uint32_t queue_count);
+extern void svt_task_scheduler_unreserve(EbTaskScheduler *scheduler_ptr, uint32_t spare_count,
+                                         uint32_t queue_count);
+
+/* Number of threads created by the scheduler so far */
+extern uint32_t svt_task_scheduler_thread_count(EbTaskScheduler *scheduler_ptr);
+
+/* Bracket a blocking wait of the calling thread. No-op outside the pool */
+extern void svt_task_scheduler_block_begin(void);
+extern void svt_task_scheduler_block_end(void);
+
+/* Time slice of a grouped task while other grouped tasks are waiting */
+#define TASK_GROUP_QUANTUM_NS 2000000
+
+/*********************************************************************
+ * TaskGroup
+ *   Tasks of one client of a shared scheduler, e.g. one encoder handle.
+ *   Groups are served in weighted fair order: a worker out of local work
+ *   takes the oldest task of the pending group with the smallest
+ *   virtual time, and every run advances the virtual time of its group
+ *   by run_ns / weight. A group whose queue was empty restarts at the
+ *   virtual time of the group served last, so idle groups build up no
+ *   credit. Long running tasks poll svt_task_scheduler_yield_requested.
+ *
+ *   The group must be idle (no task queued or submitted any more) when
+ *   it is destroyed; the dctor blocks on idle_semaphore until the running
+ *   ones finish.
+ *********************************************************************/
+typedef struct EbTaskGroup {
+    EbDctor             dctor;
+    EbTaskScheduler *   scheduler;
+    struct EbTaskGroup *next_ptr;
+    uint32_t            weight;
+    EbTask **           task_array;
+    uint64_t            head;
+    uint64_t            tail;
+    volatile uint64_t   vtime;
+    volatile uint64_t   run_ns;
+    // active_count - tasks of the group taken by a worker and not finished,
+    //   updated under the group_mutex of the scheduler
+    volatile uint32_t active_count;
+    // closing - set by the dctor, the last running task posts idle_semaphore
+    EbBool   closing;
+    EbHandle idle_semaphore;
+} EbTaskGroup;
+
+extern EbErrorType svt_task_group_ctor(EbTaskGroup *group_ptr, EbTaskScheduler *scheduler_ptr,
+                                       uint32_t weight);
+
+/* Queues task on the group queue */
+extern void svt_task_group_submit(EbTaskGroup *group_ptr, EbTask *task_ptr);
+
+/* True when the grouped task of the calling worker used up its time
+ * slice and other grouped tasks are waiting */
+extern EbBool svt_task_scheduler_yield_requested(void);
+
+/*********************************************************************
+ * KernelJob
+ *   Runs a pipeline kernel (the void *kernel(void *) loop of a process)
+ *   as a scheduler task instead of on dedicated threads. The job is
+ *   attached to the full queue of the resource the kernel consumes;
+ *   every posted object schedules one run of the kernel, up to one run
+ *   per context. A run borrows a free context and calls the kernel,
+ *   which drains the queue and returns once it is empty, or once its
+ *   time slice is up when the job belongs to a group.
+ *
+ *   The resource must use the lock-free queues.
+ *********************************************************************/
+typedef void *(*EbKernelFn)(void *);
+
+typedef struct EbKernelJob {
+    EbDctor           dctor;
+    EbTaskScheduler * scheduler_ptr;
+    EbTaskGroup *     group_ptr;
+    EbSystemResource *input_resource_ptr;
+    EbKernelFn        kernel;
+    EbTask            task;
+    EbPtr *           context_ptr_array;
+    uint32_t          context_count;
+    EbHandle          context_mutex;
+    EbPtr *           free_context_array;
+    uint32_t          free_context_count;
+    // scheduled_count - runs queued or in progress, at most context_count
+    volatile uint32_t scheduled_count;
+    volatile uint32_t stopped;
+    // stop_semaphore - posted under context_mutex by the last run released
+    //   once the job is stopped
+    EbHandle stop_semaphore;
+} EbKernelJob;
+
+/* group_ptr, when set, queues the runs on that group of scheduler_ptr */
+extern EbErrorType svt_kernel_job_ctor(EbKernelJob *job_ptr, EbTaskScheduler *scheduler_ptr,
+                                       EbTaskGroup *group_ptr, EbSystemResource *input_resource_ptr,
+                                       EbKernelFn kernel, EbPtr *context_ptr_array,
+                                       uint32_t context_count);
+
+/* No run is scheduled any more; waits for the queued and running ones.
+ * Needed before destroying the job while its scheduler keeps running. */
+extern void svt_kernel_job_stop(EbKernelJob *job_ptr);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // EbTaskScheduler_h
@@ -38,6 +38,7 @@
 #include <fcntl.h>
 #include <pthread.h>
 #include <semaphore.h>
+#include <time.h>
 #include <unistd.h>
 #endif // _WIN32
 #ifdef __APPLE__
@@ -257,6 +258,41 @@ EbErrorType svt_block_on_semaphore(EbHandle semaphore_handle) {
     return return_error;
 }
 
+/***************************************
+ * svt_block_on_semaphore_timeout
+ ***************************************/
+EbErrorType svt_block_on_semaphore_timeout(EbHandle semaphore_handle, uint32_t timeout_ms) {
+    EbErrorType return_error;
+
+#ifdef _WIN32
+    return_error = WaitForSingleObject((HANDLE)semaphore_handle, timeout_ms)
+        ? EB_ErrorSemaphoreUnresponsive
+        : EB_ErrorNone;
+#elif defined(__APPLE__)
+    return_error = dispatch_semaphore_wait(
+                       (dispatch_semaphore_t)semaphore_handle,
+                       dispatch_time(DISPATCH_TIME_NOW, (int64_t)timeout_ms * NSEC_PER_MSEC))
+        ? EB_ErrorSemaphoreUnresponsive
+        : EB_ErrorNone;
+#else
+    struct timespec deadline;
+    int             ret;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+    do {
+        ret = sem_timedwait((sem_t *)semaphore_handle, &deadline);
+    } while (ret == -1 && errno == EINTR);
+    return_error = ret ? EB_ErrorSemaphoreUnresponsive : EB_ErrorNone;
+#endif
+
+    return return_error;
+}
+
 /***************************************
  * svt_destroy_semaphore
  ***************************************/
@@ -360,6 +396,31 @@ void atomic_set_u32(AtomicVarU32 *var, uint32_t in) {
     svt_release_mutex(var->mutex);
 }
 
+/****************************************
+ * svt_yield_thread
+ ****************************************/
+void svt_yield_thread(void) {
+#ifdef _WIN32
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+/****************************************
+ * svt_get_online_processor_count
+ ****************************************/
+uint32_t svt_get_online_processor_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO sysinfo;
+    GetSystemInfo(&sysinfo);
+    return sysinfo.dwNumberOfProcessors;
+#else
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (uint32_t)count : 1;
+#endif
+}
+
 #if FIX_DDL
 /*
     create condition variable
@@ -430,4 +491,19 @@ EbErrorType svt_wait_cond_var(CondVar *cond_var, int32_t input)
 #endif
     return return_error;
 }
+/*
+    free a condition variable, no thread must be waiting on it
+*/
+EbErrorType svt_free_cond_var(CondVar *cond_var)
+{
+    EbErrorType return_error;
+#ifdef _WIN32
+    DeleteCriticalSection(&cond_var->cs);
+    return_error = EB_ErrorNone;
+#else
+    return_error = pthread_cond_destroy(&cond_var->m_cond);
+    return_error |= pthread_mutex_destroy(&cond_var->m_mutex);
+#endif
+    return return_error;
+}
 #endif
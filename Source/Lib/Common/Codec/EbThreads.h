@@ -45,6 +45,10 @@ extern EbErrorType svt_post_semaphore(EbHandle semaphore_handle);
 
 extern EbErrorType svt_block_on_semaphore(EbHandle semaphore_handle);
 
+/* Fails with EB_ErrorSemaphoreUnresponsive when the semaphore was not
+ * posted within timeout_ms */
+extern EbErrorType svt_block_on_semaphore_timeout(EbHandle semaphore_handle, uint32_t timeout_ms);
+
 extern EbErrorType svt_destroy_semaphore(EbHandle semaphore_handle);
 
 /**************************************
@@ -122,6 +126,156 @@ extern uint64_t *        total_lib_memory; // library Memory malloc'd
 
 void atomic_set_u32(AtomicVarU32 *var, uint32_t in);
 
+/**************************************
+     * Lock-free atomics
+     *   Thin wrappers over the compiler intrinsics. Loads have acquire,
+     *   stores have release and read-modify-write operations have full
+     *   barrier semantics. The cas functions return EB_TRUE on success.
+     **************************************/
+#if defined(_MSC_VER)
+#include <intrin.h>
+// x86 and x64 loads have acquire and stores release semantics in hardware, only
+// the compiler has to be held back. Elsewhere (ARM) the interlocked functions
+// give the ordering.
+#if defined(_M_IX86) || defined(_M_X64)
+static INLINE uint32_t svt_atomic_load_u32(volatile uint32_t *p) {
+    uint32_t v = *p;
+    _ReadWriteBarrier();
+    return v;
+}
+static INLINE void svt_atomic_store_u32(volatile uint32_t *p, uint32_t v) {
+    _ReadWriteBarrier();
+    *p = v;
+}
+static INLINE int32_t svt_atomic_load_i32(volatile int32_t *p) {
+    int32_t v = *p;
+    _ReadWriteBarrier();
+    return v;
+}
+#else
+static INLINE uint32_t svt_atomic_load_u32(volatile uint32_t *p) {
+    return (uint32_t)_InterlockedCompareExchange((volatile long *)p, 0, 0);
+}
+static INLINE void svt_atomic_store_u32(volatile uint32_t *p, uint32_t v) {
+    _InterlockedExchange((volatile long *)p, (long)v);
+}
+static INLINE int32_t svt_atomic_load_i32(volatile int32_t *p) {
+    return (int32_t)_InterlockedCompareExchange((volatile long *)p, 0, 0);
+}
+#endif
+static INLINE uint32_t svt_atomic_fetch_add_u32(volatile uint32_t *p, uint32_t v) {
+    return (uint32_t)_InterlockedExchangeAdd((volatile long *)p, (long)v);
+}
+static INLINE uint32_t svt_atomic_exchange_u32(volatile uint32_t *p, uint32_t v) {
+    return (uint32_t)_InterlockedExchange((volatile long *)p, (long)v);
+}
+static INLINE EbBool svt_atomic_cas_u32(volatile uint32_t *p, uint32_t expected, uint32_t desired) {
+    return (uint32_t)_InterlockedCompareExchange((volatile long *)p, (long)desired, (long)expected) ==
+        expected;
+}
+static INLINE int32_t svt_atomic_fetch_add_i32(volatile int32_t *p, int32_t v) {
+    return (int32_t)_InterlockedExchangeAdd((volatile long *)p, (long)v);
+}
+static INLINE EbBool svt_atomic_cas_i32(volatile int32_t *p, int32_t expected, int32_t desired) {
+    return _InterlockedCompareExchange((volatile long *)p, desired, expected) == expected;
+}
+// A volatile 64 bit access is split in two on 32 bit x86 and has no
+// ordering on ARM, the interlocked functions are atomic and full barriers.
+// 32 bit x86 only has the 64 bit compare exchange.
+static INLINE uint64_t svt_atomic_load_u64(volatile uint64_t *p) {
+    return (uint64_t)_InterlockedCompareExchange64((volatile __int64 *)p, 0, 0);
+}
+#if defined(_M_IX86)
+static INLINE uint64_t svt_atomic_exchange_add_u64(volatile uint64_t *p, uint64_t v,
+                                                   EbBool add) {
+    __int64 old = (__int64)svt_atomic_load_u64(p);
+    __int64 seen;
+    while ((seen = _InterlockedCompareExchange64(
+                (volatile __int64 *)p, (__int64)(add ? (uint64_t)old + v : v), old)) != old)
+        old = seen;
+    return (uint64_t)old;
+}
+static INLINE void svt_atomic_store_u64(volatile uint64_t *p, uint64_t v) {
+    svt_atomic_exchange_add_u64(p, v, EB_FALSE);
+}
+static INLINE uint64_t svt_atomic_fetch_add_u64(volatile uint64_t *p, uint64_t v) {
+    return svt_atomic_exchange_add_u64(p, v, EB_TRUE);
+}
+#else
+static INLINE void svt_atomic_store_u64(volatile uint64_t *p, uint64_t v) {
+    _InterlockedExchange64((volatile __int64 *)p, (__int64)v);
+}
+static INLINE uint64_t svt_atomic_fetch_add_u64(volatile uint64_t *p, uint64_t v) {
+    return (uint64_t)_InterlockedExchangeAdd64((volatile __int64 *)p, (__int64)v);
+}
+#endif
+static INLINE EbBool svt_atomic_cas_u64(volatile uint64_t *p, uint64_t expected, uint64_t desired) {
+    return (uint64_t)_InterlockedCompareExchange64(
+               (volatile __int64 *)p, (__int64)desired, (__int64)expected) == expected;
+}
+static INLINE void svt_cpu_pause(void) { YieldProcessor(); }
+#else
+static INLINE uint32_t svt_atomic_load_u32(volatile uint32_t *p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+static INLINE void svt_atomic_store_u32(volatile uint32_t *p, uint32_t v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+static INLINE uint32_t svt_atomic_fetch_add_u32(volatile uint32_t *p, uint32_t v) {
+    return __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST);
+}
+static INLINE uint32_t svt_atomic_exchange_u32(volatile uint32_t *p, uint32_t v) {
+    return __atomic_exchange_n(p, v, __ATOMIC_SEQ_CST);
+}
+static INLINE EbBool svt_atomic_cas_u32(volatile uint32_t *p, uint32_t expected, uint32_t desired) {
+    return __atomic_compare_exchange_n(
+        p, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+static INLINE int32_t svt_atomic_load_i32(volatile int32_t *p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+static INLINE int32_t svt_atomic_fetch_add_i32(volatile int32_t *p, int32_t v) {
+    return __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST);
+}
+static INLINE EbBool svt_atomic_cas_i32(volatile int32_t *p, int32_t expected, int32_t desired) {
+    return __atomic_compare_exchange_n(
+        p, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+static INLINE uint64_t svt_atomic_load_u64(volatile uint64_t *p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+static INLINE void svt_atomic_store_u64(volatile uint64_t *p, uint64_t v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+static INLINE uint64_t svt_atomic_fetch_add_u64(volatile uint64_t *p, uint64_t v) {
+    return __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST);
+}
+static INLINE EbBool svt_atomic_cas_u64(volatile uint64_t *p, uint64_t expected, uint64_t desired) {
+    return __atomic_compare_exchange_n(
+        p, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+static INLINE void svt_cpu_pause(void) {
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+#endif
+
+/* Give up the remainder of the time slice to another ready thread */
+extern void svt_yield_thread(void);
+
+/* Storage class of per-thread variables */
+#if defined(_MSC_VER)
+#define SVT_THREAD_LOCAL __declspec(thread)
+#else
+#define SVT_THREAD_LOCAL __thread
+#endif
+
+/* Number of processors currently online in the calling process' group */
+extern uint32_t svt_get_online_processor_count(void);
+
 #if FIX_DDL
 /*
  Condition variable
@@ -140,6 +294,7 @@ typedef struct CondVar {
 EbErrorType svt_set_cond_var(CondVar *cond_var, int32_t newval);
 EbErrorType svt_wait_cond_var(CondVar *cond_var, int32_t input);
 EbErrorType svt_create_cond_var(CondVar *cond_var);
+EbErrorType svt_free_cond_var(CondVar *cond_var);
 #endif
 
 #ifdef __cplusplus
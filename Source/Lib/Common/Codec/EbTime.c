@@ -55,3 +55,22 @@ void svt_av1_get_time(uint64_t *const seconds, uint64_t *const useconds) {
     *useconds = curr_time.tv_usec;
 #endif
 }
+
+uint64_t svt_av1_get_time_ns(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER        counter;
+    if (!frequency.QuadPart)
+        QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)((double)counter.QuadPart * 1000000000.0 / (double)frequency.QuadPart);
+#elif defined(CLOCK_MONOTONIC) && !defined(OLD_MACOS)
+    struct timespec curr_time;
+    clock_gettime(CLOCK_MONOTONIC, &curr_time);
+    return (uint64_t)curr_time.tv_sec * 1000000000 + curr_time.tv_nsec;
+#else
+    struct timeval curr_time;
+    gettimeofday(&curr_time, NULL);
+    return (uint64_t)curr_time.tv_sec * 1000000000 + (uint64_t)curr_time.tv_usec * 1000;
+#endif
+}
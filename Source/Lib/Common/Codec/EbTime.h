@@ -23,6 +23,8 @@ double svt_av1_compute_overall_elapsed_time_ms(const uint64_t start_seconds,
                                                const uint64_t finish_seconds,
                                                const uint64_t finish_useconds);
 void   svt_av1_get_time(uint64_t *const seconds, uint64_t *const useconds);
+// Monotonic time in nanoseconds, for measuring intervals
+uint64_t svt_av1_get_time_ns(void);
 
 #ifdef __cplusplus
 }
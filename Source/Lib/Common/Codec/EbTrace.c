@@ -0,0 +1,212 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "EbTrace.h"
+#include "EbTime.h"
+#define LOG_TAG "SvtTrace"
+#include "EbLog.h"
+
+// Events of the calling thread for its latest tracer, which is told
+// apart from a later tracer at the same address by its id. The address
+// of current_trace_thread also identifies the thread.
+static SVT_THREAD_LOCAL EbTraceThread *current_trace_thread = NULL;
+static SVT_THREAD_LOCAL uint64_t       current_tracer_id    = 0;
+static SVT_THREAD_LOCAL EbBool         current_event_open   = EB_FALSE;
+
+static volatile uint64_t tracer_id_count = 0;
+
+/**************************************
+ * trace_thread_get
+ *   Finds or registers the events of the calling thread. Registration
+ *   happens once per thread and tracer, under thread_mutex.
+ **************************************/
+static EbTraceThread *trace_thread_get(EbTracer *tracer_ptr) {
+    EbTraceThread *thread_ptr;
+    if (current_tracer_id == tracer_ptr->tracer_id)
+        return current_trace_thread;
+
+    const void *owner_ptr = (const void *)&current_trace_thread;
+    svt_block_on_mutex(tracer_ptr->thread_mutex);
+    for (thread_ptr = tracer_ptr->thread_list; thread_ptr; thread_ptr = thread_ptr->next_ptr)
+        if (thread_ptr->owner_ptr == owner_ptr)
+            break;
+    if (!thread_ptr) {
+        thread_ptr = (EbTraceThread *)calloc(1, sizeof(*thread_ptr));
+        if (thread_ptr) {
+            thread_ptr->owner_ptr    = owner_ptr;
+            thread_ptr->thread_index = tracer_ptr->thread_count++;
+            thread_ptr->next_ptr     = tracer_ptr->thread_list;
+            tracer_ptr->thread_list  = thread_ptr;
+        }
+    }
+    svt_release_mutex(tracer_ptr->thread_mutex);
+    if (thread_ptr) {
+        current_trace_thread = thread_ptr;
+        current_tracer_id    = tracer_ptr->tracer_id;
+    }
+    return thread_ptr;
+}
+
+static void trace_thread_close(EbTraceThread *thread_ptr, uint64_t end_ns) {
+    EbTraceEvent *event_ptr =
+        &thread_ptr->last_block_ptr->event_array[thread_ptr->last_block_count];
+    event_ptr->end_ns  = end_ns;
+    current_event_open = EB_FALSE;
+    thread_ptr->last_block_count++;
+    // Publish the event, and the block link before it
+    svt_atomic_store_u64(&thread_ptr->event_count, thread_ptr->event_count + 1);
+}
+
+void svt_trace_begin(EbTracer *tracer_ptr, uint32_t name_index, uint64_t picture_number,
+                     uint32_t segment_index) {
+    if (!tracer_ptr)
+        return;
+    const uint64_t now_ns = svt_av1_get_time_ns();
+    if (current_event_open)
+        trace_thread_close(current_trace_thread, now_ns);
+    EbTraceThread *thread_ptr = trace_thread_get(tracer_ptr);
+    if (!thread_ptr)
+        return;
+    if (svt_atomic_fetch_add_u64(&tracer_ptr->event_count, 1) >= tracer_ptr->max_event_count) {
+        svt_atomic_fetch_add_u64(&tracer_ptr->dropped_count, 1);
+        return;
+    }
+    if (!thread_ptr->last_block_ptr ||
+        thread_ptr->last_block_count == TRACE_BLOCK_EVENT_COUNT) {
+        EbTraceBlock *block_ptr = (EbTraceBlock *)malloc(sizeof(*block_ptr));
+        if (!block_ptr) {
+            svt_atomic_fetch_add_u64(&tracer_ptr->dropped_count, 1);
+            return;
+        }
+        block_ptr->next_ptr = NULL;
+        if (thread_ptr->last_block_ptr)
+            thread_ptr->last_block_ptr->next_ptr = block_ptr;
+        else
+            thread_ptr->first_block_ptr = block_ptr;
+        thread_ptr->last_block_ptr   = block_ptr;
+        thread_ptr->last_block_count = 0;
+    }
+    EbTraceEvent *event_ptr =
+        &thread_ptr->last_block_ptr->event_array[thread_ptr->last_block_count];
+    event_ptr->begin_ns       = now_ns;
+    event_ptr->picture_number = picture_number;
+    event_ptr->segment_index  = segment_index;
+    event_ptr->name_index     = name_index;
+    if (thread_ptr->event_count &&
+        name_index != thread_ptr->first_block_ptr->event_array[0].name_index)
+        thread_ptr->mixed_names = EB_TRUE;
+    current_event_open = EB_TRUE;
+}
+
+void svt_trace_end(void) {
+    if (current_event_open)
+        trace_thread_close(current_trace_thread, svt_av1_get_time_ns());
+}
+
+static double trace_time_us(const EbTracer *tracer_ptr, uint64_t time_ns) {
+    return time_ns > tracer_ptr->start_ns ? (time_ns - tracer_ptr->start_ns) / 1000.0 : 0;
+}
+
+static const char *trace_name(const EbTracer *tracer_ptr, uint32_t name_index) {
+    return name_index < tracer_ptr->name_count ? tracer_ptr->name_array[name_index] : "unknown";
+}
+
+EbErrorType svt_tracer_write_json(EbTracer *tracer_ptr, const char *file_name) {
+    FILE *file_ptr = NULL;
+    FOPEN(file_ptr, file_name, "w");
+    if (!file_ptr) {
+        SVT_ERROR("could not open the trace file %s\n", file_name);
+        return EB_ErrorBadParameter;
+    }
+    fprintf(file_ptr, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file_ptr,
+            "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"SVT-AV1\"}}");
+
+    svt_block_on_mutex(tracer_ptr->thread_mutex);
+    for (const EbTraceThread *thread_ptr = tracer_ptr->thread_list; thread_ptr;
+         thread_ptr = thread_ptr->next_ptr) {
+        uint64_t            event_count = svt_atomic_load_u64(
+            (volatile uint64_t *)&thread_ptr->event_count);
+        const EbTraceBlock *block_ptr   = thread_ptr->first_block_ptr;
+
+        if (!event_count)
+            continue;
+        // Threads running a single kernel are named after it
+        if (thread_ptr->mixed_names)
+            fprintf(file_ptr,
+                    ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                    "\"args\":{\"name\":\"worker %u\"}}",
+                    thread_ptr->thread_index,
+                    thread_ptr->thread_index);
+        else
+            fprintf(file_ptr,
+                    ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                    "\"args\":{\"name\":\"%s %u\"}}",
+                    thread_ptr->thread_index,
+                    trace_name(tracer_ptr, block_ptr->event_array[0].name_index),
+                    thread_ptr->thread_index);
+        for (uint64_t i = 0; i < event_count; i++) {
+            const EbTraceEvent *event_ptr = &block_ptr->event_array[i % TRACE_BLOCK_EVENT_COUNT];
+            const double        begin_us  = trace_time_us(tracer_ptr, event_ptr->begin_ns);
+            fprintf(file_ptr,
+                    ",\n{\"name\":\"%s\",\"cat\":\"svt\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                    "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"picture\":%llu,\"segment\":%u}}",
+                    trace_name(tracer_ptr, event_ptr->name_index),
+                    thread_ptr->thread_index,
+                    begin_us,
+                    trace_time_us(tracer_ptr, event_ptr->end_ns) - begin_us,
+                    (unsigned long long)event_ptr->picture_number,
+                    event_ptr->segment_index);
+            if (i % TRACE_BLOCK_EVENT_COUNT == TRACE_BLOCK_EVENT_COUNT - 1)
+                block_ptr = block_ptr->next_ptr;
+        }
+    }
+    svt_release_mutex(tracer_ptr->thread_mutex);
+
+    fprintf(file_ptr, "\n]}\n");
+    fclose(file_ptr);
+    if (tracer_ptr->dropped_count)
+        SVT_WARN("trace limit reached, %llu events were not recorded\n",
+                 (unsigned long long)tracer_ptr->dropped_count);
+    return EB_ErrorNone;
+}
+
+static void svt_tracer_dctor(EbPtr p) {
+    EbTracer *     obj        = (EbTracer *)p;
+    EbTraceThread *thread_ptr = obj->thread_list;
+    while (thread_ptr) {
+        EbTraceThread *next_thread_ptr = thread_ptr->next_ptr;
+        EbTraceBlock * block_ptr       = thread_ptr->first_block_ptr;
+        while (block_ptr) {
+            EbTraceBlock *next_block_ptr = block_ptr->next_ptr;
+            free(block_ptr);
+            block_ptr = next_block_ptr;
+        }
+        free(thread_ptr);
+        thread_ptr = next_thread_ptr;
+    }
+    EB_DESTROY_MUTEX(obj->thread_mutex);
+}
+
+EbErrorType svt_tracer_ctor(EbTracer *tracer_ptr, const char *const *name_array,
+                            uint32_t name_count, uint64_t max_event_count) {
+    tracer_ptr->dctor = svt_tracer_dctor;
+    EB_CREATE_MUTEX(tracer_ptr->thread_mutex);
+    tracer_ptr->name_array      = name_array;
+    tracer_ptr->name_count      = name_count;
+    tracer_ptr->max_event_count = max_event_count;
+    tracer_ptr->start_ns        = svt_av1_get_time_ns();
+    tracer_ptr->tracer_id       = svt_atomic_fetch_add_u64(&tracer_id_count, 1) + 1;
+    return EB_ErrorNone;
+}
@@ -0,0 +1,100 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#ifndef EbTrace_h
+#define EbTrace_h
+
+#include "EbDefinitions.h"
+#include "EbObject.h"
+#include "EbThreads.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRACE_BLOCK_EVENT_COUNT 4096
+
+typedef struct EbTraceEvent {
+    uint64_t begin_ns;
+    uint64_t end_ns;
+    uint64_t picture_number;
+    uint32_t segment_index;
+    uint32_t name_index;
+} EbTraceEvent;
+
+typedef struct EbTraceBlock {
+    struct EbTraceBlock *next_ptr;
+    EbTraceEvent         event_array[TRACE_BLOCK_EVENT_COUNT];
+} EbTraceBlock;
+
+/*********************************************************************
+ * TraceThread
+ *   Events of one thread. Only the owner thread writes; event_count
+ *   publishes the closed events to the writer.
+ *********************************************************************/
+typedef struct EbTraceThread {
+    struct EbTraceThread *next_ptr;
+    const void *          owner_ptr;
+    uint32_t              thread_index;
+    EbTraceBlock *        first_block_ptr;
+    EbTraceBlock *        last_block_ptr;
+    uint32_t              last_block_count;
+    EbBool                mixed_names;
+    volatile uint64_t     event_count;
+} EbTraceThread;
+
+/*********************************************************************
+ * Tracer
+ *   Records one complete event (name, picture, segment, begin and end
+ *   time) per traced call, in per-thread buffers that grow without
+ *   locks. An event starts at svt_trace_begin and ends at the next
+ *   svt_trace_begin or svt_trace_end of the same thread; the system
+ *   resource manager ends it when the thread asks for its next input.
+ *   Recording stops at max_event_count events. A thread must not hold
+ *   an open event when its tracer is destroyed.
+ *********************************************************************/
+typedef struct EbTracer {
+    EbDctor              dctor;
+    EbHandle             thread_mutex;
+    EbTraceThread *      thread_list;
+    uint32_t             thread_count;
+    const char *const *  name_array;
+    uint32_t             name_count;
+    uint64_t             tracer_id;
+    uint64_t             start_ns;
+    uint64_t             max_event_count;
+    volatile uint64_t    event_count;
+    volatile uint64_t    dropped_count;
+} EbTracer;
+
+/* name_array must outlive the tracer */
+extern EbErrorType svt_tracer_ctor(EbTracer *tracer_ptr, const char *const *name_array,
+                                   uint32_t name_count, uint64_t max_event_count);
+
+/* Does nothing when tracer_ptr is NULL */
+extern void svt_trace_begin(EbTracer *tracer_ptr, uint32_t name_index, uint64_t picture_number,
+                            uint32_t segment_index);
+
+/* Ends the open event of the calling thread, if any */
+extern void svt_trace_end(void);
+
+/*********************************************************************
+ * svt_tracer_write_json
+ *   Writes the closed events as Chrome trace-event JSON, which loads
+ *   in chrome://tracing and in Perfetto. Safe while threads record;
+ *   events closed afterwards are not written.
+ *********************************************************************/
+extern EbErrorType svt_tracer_write_json(EbTracer *tracer_ptr, const char *file_name);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // EbTrace_h
@@ -0,0 +1,361 @@
+/*
+* Copyright(c) 2019 Netflix, Inc.
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+// SUMMARY
+//   Contains the frame parallel decoding functions
+
+/**************************************
+ * Includes
+ **************************************/
+#include <stdlib.h>
+
+#include "EbDefinitions.h"
+#include "EbSvtAv1Dec.h"
+#include "EbDecHandle.h"
+#include "EbDecMemInit.h"
+#include "EbDecPicMgr.h"
+#include "EbObuParse.h"
+#include "EbDecParseFrame.h"
+#include "EbDecFrameParallel.h"
+#include "EbRestoration.h"
+
+#ifdef _WIN32
+#include <windows.h>
+extern uint8_t        num_groups;
+extern GROUP_AFFINITY group_affinity;
+extern EbBool         alternate_groups;
+#elif defined(__linux__)
+extern cpu_set_t group_affinity;
+#endif
+
+int svt_dec_out_pic(EbDecHandle *dec_handle_ptr, EbDecPicBuf *pic_buf, uint32_t wd, uint32_t ht,
+                    AomFilmGrain *film_grain_ptr, EbBufferHeaderType *p_buffer);
+
+static void *dec_frm_prll_kernel(void *input_ptr) {
+    DecFrmPrllSlot *slot = (DecFrmPrllSlot *)input_ptr;
+    EbDecHandle *   frm  = slot->dec_handle_ptr;
+
+    while (1) {
+        svt_block_on_semaphore(slot->start_semaphore);
+        if (slot->ctxt->exit_flag)
+            break;
+
+        EbErrorType status = decode_deferred_frame(frm);
+        if (status != EB_ErrorNone)
+            assert(0);
+
+        /* Unblock the waiters even if the frame did not publish its rows */
+        dec_pic_signal_parse_done(frm->cur_pic_buf[0]);
+        dec_pic_signal_rows(frm->cur_pic_buf[0], DEC_PIC_ALL_ROWS);
+
+        svt_set_cond_var(&slot->busy, 0);
+    }
+    return NULL;
+}
+
+EbErrorType dec_frm_prll_init(EbDecHandle *dec_handle_ptr) {
+    DecFrmPrllCtxt *ctxt;
+    int32_t         num_slots = dec_handle_ptr->num_frms_prll;
+
+    EB_MALLOC_DEC(DecFrmPrllCtxt *, ctxt, sizeof(DecFrmPrllCtxt), EB_N_PTR);
+    memset(ctxt, 0, sizeof(DecFrmPrllCtxt));
+    EB_MALLOC_DEC(DecFrmPrllSlot *, ctxt->slots, num_slots * sizeof(DecFrmPrllSlot), EB_N_PTR);
+    memset(ctxt->slots, 0, num_slots * sizeof(DecFrmPrllSlot));
+
+    ctxt->dec_handle_ptr = dec_handle_ptr;
+    ctxt->num_slots      = num_slots;
+
+    for (int32_t i = 0; i < num_slots; i++) {
+        DecFrmPrllSlot *slot = &ctxt->slots[i];
+        EbDecHandle *   frm;
+
+        EB_MALLOC_DEC(EbDecHandle *, frm, sizeof(EbDecHandle), EB_N_PTR);
+        memset(frm, 0, sizeof(EbDecHandle));
+        frm->dec_cnt       = -1;
+        frm->num_frms_prll = 1;
+        frm->dec_config    = dec_handle_ptr->dec_config;
+        /* Tiles of a slot are decoded by its frame thread only */
+        frm->dec_config.threads      = 1;
+        frm->dec_config.num_p_frames = 1;
+        frm->is_16bit_pipeline       = dec_handle_ptr->is_16bit_pipeline;
+        frm->frm_prll_ctxt           = ctxt;
+
+        slot->ctxt           = ctxt;
+        slot->dec_handle_ptr = frm;
+        if (svt_create_cond_var(&slot->busy) != EB_ErrorNone)
+            return EB_ErrorInsufficientResources;
+        EB_CREATE_SEMAPHORE(slot->start_semaphore, 0, 1);
+        if (slot->start_semaphore == NULL)
+            return EB_ErrorInsufficientResources;
+        EB_CREATE_THREAD(slot->frame_thread, dec_frm_prll_kernel, slot);
+        if (slot->frame_thread == NULL)
+            return EB_ErrorInsufficientResources;
+    }
+
+    dec_handle_ptr->frm_prll_ctxt = ctxt;
+    return EB_ErrorNone;
+}
+
+/* Wait for the frame of the slot and drop the pictures it held */
+static void dec_frm_prll_retire(DecFrmPrllSlot *slot) {
+    svt_wait_cond_var(&slot->busy, 1);
+    for (int32_t i = 0; i < slot->num_held_pics; i++) dec_pic_mgr_release_pic(slot->held_pics[i]);
+    slot->num_held_pics = 0;
+}
+
+void dec_frm_prll_retire_all(DecFrmPrllCtxt *ctxt) {
+    for (int32_t i = 0; i < ctxt->num_slots; i++) dec_frm_prll_retire(&ctxt->slots[i]);
+}
+
+/* Load the decoder state left by the previous frame into the slot */
+static EbErrorType dec_frm_prll_sync_in(EbDecHandle *frm, EbDecHandle *api) {
+    frm->dec_config              = api->dec_config;
+    frm->dec_config.threads      = 1;
+    frm->dec_config.num_p_frames = 1;
+    frm->is_16bit_pipeline       = api->is_16bit_pipeline;
+    frm->seq_header              = api->seq_header;
+    frm->seq_header_done         = api->seq_header_done;
+    frm->pv_pic_mgr              = api->pv_pic_mgr;
+
+    if (frm->seq_header_done && !frm->mem_init_done) {
+        EbErrorType status = dec_mem_init(frm);
+        if (status != EB_ErrorNone)
+            return status;
+    }
+
+    frm->frame_header        = api->frame_header;
+    frm->seen_frame_header   = api->seen_frame_header;
+    frm->show_existing_frame = api->show_existing_frame;
+    frm->show_frame          = api->show_frame;
+    frm->showable_frame      = api->showable_frame;
+    frm->prev_frame          = api->prev_frame;
+    frm->cur_pic_buf[0]      = api->cur_pic_buf[0];
+    frm->cm                  = api->cm;
+    frm->sf_identity         = api->sf_identity;
+    for (int32_t i = 0; i < REF_FRAMES; i++) {
+        frm->remapped_ref_idx[i]   = api->remapped_ref_idx[i];
+        frm->ref_scale_factors[i]  = api->ref_scale_factors[i];
+        frm->ref_frame_map[i]      = api->ref_frame_map[i];
+        frm->next_ref_frame_map[i] = NULL;
+    }
+    return EB_ErrorNone;
+}
+
+/* Carry the state of the parsed frame over to the next one */
+static void dec_frm_prll_sync_out(EbDecHandle *api, EbDecHandle *frm) {
+    api->dec_config.max_color_format = frm->dec_config.max_color_format;
+    api->seq_header                  = frm->seq_header;
+    api->seq_header_done             = frm->seq_header_done;
+    api->pv_pic_mgr                  = frm->pv_pic_mgr;
+    api->frame_header                = frm->frame_header;
+    api->seen_frame_header           = frm->seen_frame_header;
+    api->show_existing_frame         = frm->show_existing_frame;
+    api->show_frame                  = frm->show_frame;
+    api->showable_frame              = frm->showable_frame;
+    api->prev_frame                  = frm->prev_frame;
+    api->cur_pic_buf[0]              = frm->cur_pic_buf[0];
+    api->cm                          = frm->cm;
+    api->sf_identity                 = frm->sf_identity;
+    for (int32_t i = 0; i < REF_FRAMES; i++) {
+        api->remapped_ref_idx[i]   = frm->remapped_ref_idx[i];
+        api->ref_scale_factors[i]  = frm->ref_scale_factors[i];
+        api->ref_frame_map[i]      = frm->ref_frame_map[i];
+        api->next_ref_frame_map[i] = frm->next_ref_frame_map[i];
+        frm->next_ref_frame_map[i] = NULL;
+    }
+}
+
+/* Hand the tiles of the parsed frame to the frame thread of the slot */
+static EbErrorType dec_frm_prll_post(DecFrmPrllSlot *slot, const uint8_t *frame_start,
+                                     size_t frame_size) {
+    EbDecHandle *  frm             = slot->dec_handle_ptr;
+    MainParseCtxt *main_parse_ctxt = (MainParseCtxt *)frm->pv_main_parse_ctxt;
+    TilesInfo *    tiles_info      = &frm->frame_header.tiles_info;
+    int32_t        num_tiles       = tiles_info->tile_cols * tiles_info->tile_rows;
+
+    /* The caller's buffer is only valid during the call : keep a copy */
+    if (slot->data_size < frame_size) {
+        uint8_t *data = (uint8_t *)realloc(slot->data, frame_size);
+        if (data == NULL)
+            return EB_ErrorInsufficientResources;
+        slot->data      = data;
+        slot->data_size = frame_size;
+    }
+    svt_memcpy(slot->data, frame_start, frame_size);
+    for (int32_t tile_num = 0; tile_num < num_tiles; tile_num++) {
+        ParseTileData *parse_tile_data = &main_parse_ctxt->parse_tile_data[tile_num];
+        parse_tile_data->data          = slot->data + (parse_tile_data->data - frame_start);
+        parse_tile_data->data_end      = slot->data + (parse_tile_data->data_end - frame_start);
+    }
+
+    /* Current and reference pictures stay valid until the slot is retired */
+    dec_pic_mgr_hold_pic(frm->cur_pic_buf[0]);
+    slot->held_pics[slot->num_held_pics++] = frm->cur_pic_buf[0];
+    for (int32_t i = 0; i < REF_FRAMES; i++) {
+        if (frm->ref_frame_map[i] == NULL)
+            continue;
+        dec_pic_mgr_hold_pic(frm->ref_frame_map[i]);
+        slot->held_pics[slot->num_held_pics++] = frm->ref_frame_map[i];
+    }
+
+    svt_set_cond_var(&slot->busy, 1);
+    svt_post_semaphore(slot->start_semaphore);
+
+    /* Super-res upscaling allocates from the decoder memory map, which only
+       the thread calling the API may do : drain the frame */
+    if (!av1_superres_unscaled(&frm->frame_header.frame_size))
+        svt_wait_cond_var(&slot->busy, 1);
+    return EB_ErrorNone;
+}
+
+static void dec_frm_prll_push_out(DecFrmPrllCtxt *ctxt, DecFrmPrllOutPic *out_pic) {
+    if (ctxt->num_out_pics == ctxt->num_slots) {
+        /* The application does not pull the pictures : drop the oldest */
+        dec_pic_mgr_release_pic(ctxt->out_pics[ctxt->out_head].pic_buf);
+        ctxt->out_head = (ctxt->out_head + 1) % DEC_MAX_NUM_FRM_PRLL;
+        ctxt->num_out_pics--;
+    }
+    int32_t tail = (ctxt->out_head + ctxt->num_out_pics) % DEC_MAX_NUM_FRM_PRLL;
+    ctxt->out_pics[tail] = *out_pic;
+    ctxt->num_out_pics++;
+}
+
+EbErrorType dec_frm_prll_decode(DecFrmPrllCtxt *ctxt, const uint8_t *data, size_t data_size,
+                                uint32_t is_annexb) {
+    EbDecHandle *    api          = ctxt->dec_handle_ptr;
+    EbErrorType      return_error = EB_ErrorNone;
+    uint8_t *        data_start   = (uint8_t *)data;
+    uint8_t *        data_end     = (uint8_t *)data + data_size;
+    DecFrmPrllOutPic out_pic;
+
+    /* An empty call signals the end of the stream */
+    ctxt->flush = (data == NULL || data_size == 0);
+    if (ctxt->flush)
+        return EB_ErrorNone;
+
+    out_pic.pic_buf        = NULL;
+    api->seen_frame_header = 0;
+
+    while (data_start < data_end) {
+        DecFrmPrllSlot *slot = &ctxt->slots[ctxt->next_slot];
+        EbDecHandle *   frm  = slot->dec_handle_ptr;
+        ctxt->next_slot      = (ctxt->next_slot + 1) % ctxt->num_slots;
+
+        dec_frm_prll_retire(slot);
+        return_error = dec_frm_prll_sync_in(frm, api);
+        if (return_error != EB_ErrorNone)
+            break;
+
+        api->dec_cnt++;
+        frm->dec_cnt            = api->dec_cnt;
+        frm->frm_decode_pending = EB_FALSE;
+
+        uint8_t *frame_start = data_start;
+        uint64_t frame_size  = data_end - data_start;
+        return_error         = decode_multiple_obu(frm, &data_start, frame_size, is_annexb);
+
+        if (return_error != EB_ErrorNone)
+            assert(0);
+
+        dec_frm_prll_sync_out(api, frm);
+
+        if (frm->frm_decode_pending) {
+            EbErrorType status = dec_frm_prll_post(slot, frame_start, data_start - frame_start);
+            if (status != EB_ErrorNone)
+                return status;
+        } else if (!frm->show_existing_frame && frm->cur_pic_buf[0]) {
+            /* Nothing left to decode, do not block the readers */
+            dec_pic_signal_parse_done(frm->cur_pic_buf[0]);
+            dec_pic_signal_rows(frm->cur_pic_buf[0], DEC_PIC_ALL_ROWS);
+        }
+
+        if (api->show_frame && api->cur_pic_buf[0]) {
+            dec_pic_mgr_release_pic(out_pic.pic_buf);
+            dec_pic_mgr_hold_pic(api->cur_pic_buf[0]);
+            out_pic.pic_buf           = api->cur_pic_buf[0];
+            out_pic.wd                = api->frame_header.frame_size.superres_upscaled_width;
+            out_pic.ht                = api->frame_header.frame_size.frame_height;
+            out_pic.film_grain_params = api->cur_pic_buf[0]->film_grain_params;
+        }
+
+        dec_pic_mgr_update_ref_pic(api,
+                                   (EB_ErrorNone == return_error) ? 1 : 0,
+                                   api->frame_header.refresh_frame_flags);
+    }
+
+    /* One picture per call, as the serial decoder outputs */
+    if (out_pic.pic_buf)
+        dec_frm_prll_push_out(ctxt, &out_pic);
+
+    return return_error;
+}
+
+int dec_frm_prll_get_picture(DecFrmPrllCtxt *ctxt, EbBufferHeaderType *p_buffer) {
+    if (ctxt->num_out_pics == 0)
+        return 0;
+
+    DecFrmPrllOutPic *out_pic = &ctxt->out_pics[ctxt->out_head];
+    /* Keep up to num_p_frames pictures in flight unless flushing */
+    if (!ctxt->flush && ctxt->num_out_pics < ctxt->num_slots &&
+        !dec_pic_rows_ready(out_pic->pic_buf, DEC_PIC_ALL_ROWS))
+        return 0;
+
+    dec_pic_wait_rows(out_pic->pic_buf, DEC_PIC_ALL_ROWS);
+    int ret = svt_dec_out_pic(ctxt->dec_handle_ptr,
+                              out_pic->pic_buf,
+                              out_pic->wd,
+                              out_pic->ht,
+                              &out_pic->film_grain_params,
+                              p_buffer);
+    dec_pic_mgr_release_pic(out_pic->pic_buf);
+    ctxt->out_head = (ctxt->out_head + 1) % DEC_MAX_NUM_FRM_PRLL;
+    ctxt->num_out_pics--;
+    return ret;
+}
+
+/* New sequence resolution : the picture manager, shared by all the slots,
+   reallocates its buffers as they are reused */
+EbErrorType dec_frm_prll_seq_changed(EbDecHandle *dec_handle_ptr) {
+    DecFrmPrllCtxt *ctxt = dec_handle_ptr->frm_prll_ctxt;
+
+    dec_frm_prll_retire_all(ctxt);
+    EbErrorType return_error = dec_pic_mgr_init(dec_handle_ptr);
+    if (return_error != EB_ErrorNone)
+        return return_error;
+
+    ctxt->dec_handle_ptr->pv_pic_mgr = dec_handle_ptr->pv_pic_mgr;
+    for (int32_t i = 0; i < ctxt->num_slots; i++) {
+        ctxt->slots[i].dec_handle_ptr->pv_pic_mgr    = dec_handle_ptr->pv_pic_mgr;
+        ctxt->slots[i].dec_handle_ptr->mem_init_done = 0;
+    }
+    return EB_ErrorNone;
+}
+
+void dec_frm_prll_deinit(DecFrmPrllCtxt *ctxt) {
+    dec_frm_prll_retire_all(ctxt);
+    while (ctxt->num_out_pics) {
+        dec_pic_mgr_release_pic(ctxt->out_pics[ctxt->out_head].pic_buf);
+        ctxt->out_head = (ctxt->out_head + 1) % DEC_MAX_NUM_FRM_PRLL;
+        ctxt->num_out_pics--;
+    }
+
+    ctxt->exit_flag = EB_TRUE;
+    for (int32_t i = 0; i < ctxt->num_slots; i++) {
+        DecFrmPrllSlot *slot = &ctxt->slots[i];
+        svt_post_semaphore(slot->start_semaphore);
+        EB_DESTROY_THREAD(slot->frame_thread);
+        EB_DESTROY_SEMAPHORE(slot->start_semaphore);
+        if (slot->dec_handle_ptr)
+            svt_free_cond_var(&slot->busy);
+        free(slot->data);
+        slot->data = NULL;
+    }
+}
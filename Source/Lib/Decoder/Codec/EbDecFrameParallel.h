@@ -0,0 +1,87 @@
+/*
+* Copyright(c) 2019 Netflix, Inc.
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#ifndef EbDecFrameParallel_h
+#define EbDecFrameParallel_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "EbDecHandle.h"
+
+/* Frame parallel decoding.
+   The API handle owns num_p_frames slots. Each slot is a decoder handle
+   holding the state of one frame. The thread calling the API parses the
+   frame headers in order, one slot per frame, and hands the tiles of the
+   frame to the slot's frame thread. Inter prediction waits on the rows
+   published by the reference pictures (EbDecPicBuf rows_done). The rows
+   are published while padding, after the filters of the whole frame. */
+
+/* Picture waiting in the output queue */
+typedef struct DecFrmPrllOutPic {
+    EbDecPicBuf *pic_buf;
+    uint32_t     wd;
+    uint32_t     ht;
+    /* Film grain is copied : a show_existing_frame can reload the params */
+    AomFilmGrain film_grain_params;
+} DecFrmPrllOutPic;
+
+typedef struct DecFrmPrllSlot {
+    struct DecFrmPrllCtxt *ctxt;
+    /* Decoder state of the frame in this slot */
+    EbDecHandle *dec_handle_ptr;
+    EbHandle frame_thread;
+    /* Posted by the API thread when a frame is ready to be decoded */
+    EbHandle start_semaphore;
+    /* 1 while the frame thread decodes the slot's frame */
+    CondVar busy;
+    /* Pictures held until the frame is retired : current and references */
+    EbDecPicBuf *held_pics[REF_FRAMES + 1];
+    int32_t      num_held_pics;
+    /* Copy of the frame OBUs, the tile data points into it */
+    uint8_t *data;
+    size_t   data_size;
+} DecFrmPrllSlot;
+
+typedef struct DecFrmPrllCtxt {
+    /* API handle */
+    EbDecHandle *   dec_handle_ptr;
+    DecFrmPrllSlot *slots;
+    int32_t         num_slots;
+    int32_t         next_slot;
+    EbBool          exit_flag;
+
+    /* Output queue in display order */
+    DecFrmPrllOutPic out_pics[DEC_MAX_NUM_FRM_PRLL];
+    int32_t          out_head;
+    int32_t          num_out_pics;
+    /* End of stream signalled, output the remaining pictures */
+    EbBool flush;
+} DecFrmPrllCtxt;
+
+EbErrorType dec_frm_prll_init(EbDecHandle *dec_handle_ptr);
+
+void dec_frm_prll_deinit(DecFrmPrllCtxt *ctxt);
+
+EbErrorType dec_frm_prll_decode(DecFrmPrllCtxt *ctxt, const uint8_t *data, size_t data_size,
+                                uint32_t is_annexb);
+
+int dec_frm_prll_get_picture(DecFrmPrllCtxt *ctxt, EbBufferHeaderType *p_buffer);
+
+EbErrorType dec_frm_prll_seq_changed(EbDecHandle *dec_handle_ptr);
+
+void dec_frm_prll_retire_all(DecFrmPrllCtxt *ctxt);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // EbDecFrameParallel_h
@@ -25,6 +25,7 @@
 #include "EbDecHandle.h"
 #include "EbDecMemInit.h"
 #include "EbDecPicMgr.h"
+#include "EbDecFrameParallel.h"
 #include "grainSynthesis.h"
 #include "EbUtility.h"
 
@@ -69,10 +70,6 @@ uint32_t lib_malloc_count    = 0;
 uint32_t lib_semaphore_count = 0;
 uint32_t lib_mutex_count     = 0;
 
-/* Track address for memory during change in resoultion*/
-EbMemoryMapEntry *memory_map_start_address;
-EbMemoryMapEntry *memory_map_end_address;
-
 void        asm_set_convolve_asm_table(void);
 void        init_intra_dc_predictors_c_internal(void);
 void        asm_set_convolve_hbd_asm_table(void);
@@ -119,8 +116,10 @@ static EbErrorType svt_dec_handle_ctor(EbDecHandle **   decHandleDblPtr,
     svt_dec_lib_malloc_count = 0;
 
     dec_handle_ptr->start_thread_process = EB_FALSE;
-    memory_map_start_address             = NULL;
-    memory_map_end_address               = NULL;
+    dec_handle_ptr->frm_prll_ctxt        = NULL;
+    dec_handle_ptr->frm_decode_pending   = EB_FALSE;
+    /* Allocated with the first sequence header, reused by the next ones */
+    dec_handle_ptr->pv_pic_mgr = NULL;
 
     return return_error;
 }
@@ -143,23 +142,17 @@ static void copy_even(uint8_t *luma, uint32_t wd, uint32_t ht, uint32_t stride,
     }
 }
 /* Copy from recon buffer to out buffer! */
-int svt_dec_out_buf(EbDecHandle *dec_handle_ptr, EbBufferHeaderType *p_buffer) {
-    EbPictureBufferDesc *recon_picture_buf = dec_handle_ptr->cur_pic_buf[0]->ps_pic_buf;
+/* Copy a decoded picture of wd x ht to the output buffer, applying film grain */
+int svt_dec_out_pic(EbDecHandle *dec_handle_ptr, EbDecPicBuf *pic_buf, uint32_t wd, uint32_t ht,
+                    AomFilmGrain *film_grain_ptr, EbBufferHeaderType *p_buffer) {
+    EbPictureBufferDesc *recon_picture_buf = pic_buf->ps_pic_buf;
     EbSvtIOFormat *      out_img           = (EbSvtIOFormat *)p_buffer->p_buffer;
 
     uint8_t *luma = NULL;
     uint8_t *cb   = NULL;
     uint8_t *cr   = NULL;
 
-    /* TODO: Should add logic for show_existing_frame */
-    if (0 == dec_handle_ptr->show_frame) {
-        assert(0 == dec_handle_ptr->show_existing_frame);
-        return 0;
-    }
-
-    uint32_t wd = dec_handle_ptr->frame_header.frame_size.superres_upscaled_width;
-    uint32_t ht = dec_handle_ptr->frame_header.frame_size.frame_height;
-    int      sx = 0, sy = 0;
+    int sx = 0, sy = 0;
     /* FilmGrain module req. even dim. for internal operation */
     int even_w = (wd & 1) ? (wd + 1) : wd;
     int even_h = (ht & 1) ? (ht + 1) : ht;
@@ -383,7 +376,6 @@ int svt_dec_out_buf(EbDecHandle *dec_handle_ptr, EbBufferHeaderType *p_buffer) {
 
     if (!dec_handle_ptr->dec_config.skip_film_grain) {
         /* Need to fill the dst buf with recon data before calling film_grain */
-        AomFilmGrain *film_grain_ptr = &dec_handle_ptr->cur_pic_buf[0]->film_grain_params;
         if (film_grain_ptr->apply_grain) {
             switch (recon_picture_buf->bit_depth) {
             case EB_8BIT: film_grain_ptr->bit_depth = 8; break;
@@ -408,6 +400,21 @@ int svt_dec_out_buf(EbDecHandle *dec_handle_ptr, EbBufferHeaderType *p_buffer) {
     return 1;
 }
 
+int svt_dec_out_buf(EbDecHandle *dec_handle_ptr, EbBufferHeaderType *p_buffer) {
+    /* TODO: Should add logic for show_existing_frame */
+    if (0 == dec_handle_ptr->show_frame) {
+        assert(0 == dec_handle_ptr->show_existing_frame);
+        return 0;
+    }
+
+    return svt_dec_out_pic(dec_handle_ptr,
+                           dec_handle_ptr->cur_pic_buf[0],
+                           dec_handle_ptr->frame_header.frame_size.superres_upscaled_width,
+                           dec_handle_ptr->frame_header.frame_size.frame_height,
+                           &dec_handle_ptr->cur_pic_buf[0]->film_grain_params,
+                           p_buffer);
+}
+
 /**********************************
 Set Default Library Params
 **********************************/
@@ -538,7 +545,7 @@ EB_API EbErrorType svt_av1_dec_init(EbComponentType *svt_dec_component) {
     CPU_FLAGS cpu_flags = 0;
 #endif
     dec_handle_ptr->dec_cnt       = -1;
-    dec_handle_ptr->num_frms_prll = 1;
+    dec_handle_ptr->num_frms_prll = AOMMAX((int32_t)dec_handle_ptr->dec_config.num_p_frames, 1);
     if (dec_handle_ptr->num_frms_prll > DEC_MAX_NUM_FRM_PRLL)
         dec_handle_ptr->num_frms_prll = DEC_MAX_NUM_FRM_PRLL;
     dec_handle_ptr->seq_header_done = 0;
@@ -569,6 +576,9 @@ EB_API EbErrorType svt_av1_dec_init(EbComponentType *svt_dec_component) {
     if (return_error != EB_ErrorNone)
         return return_error;
 
+    if (dec_handle_ptr->num_frms_prll > 1)
+        return_error = dec_frm_prll_init(dec_handle_ptr);
+
     return return_error;
 }
 
@@ -579,6 +589,16 @@ EB_API EbErrorType svt_av1_dec_frame(EbComponentType *svt_dec_component, const u
         return EB_ErrorBadParameter;
 
     EbDecHandle *dec_handle_ptr       = (EbDecHandle *)svt_dec_component->p_component_private;
+    if (dec_handle_ptr->frm_prll_ctxt)
+        return dec_frm_prll_decode(dec_handle_ptr->frm_prll_ctxt, data, data_size, is_annexb);
+
+    /* End of stream : the last picture has already been output */
+    if (data == NULL || data_size == 0) {
+        dec_handle_ptr->show_frame          = 0;
+        dec_handle_ptr->show_existing_frame = 0;
+        return EB_ErrorNone;
+    }
+
     uint8_t *    data_start           = (uint8_t *)data;
     uint8_t *    data_end             = (uint8_t *)data + data_size;
     dec_handle_ptr->seen_frame_header = 0;
@@ -629,6 +649,11 @@ EB_API EbErrorType svt_av1_dec_get_picture(EbComponentType *   svt_dec_component
         return EB_ErrorBadParameter;
 
     EbDecHandle *dec_handle_ptr = (EbDecHandle *)svt_dec_component->p_component_private;
+    if (dec_handle_ptr->frm_prll_ctxt) {
+        if (0 == dec_frm_prll_get_picture(dec_handle_ptr->frm_prll_ctxt, p_buffer))
+            return_error = EB_DecNoOutputPicture;
+        return return_error;
+    }
     /* Copy from recon pointer and return! TODO: Should remove the svt_memcpy! */
     if (0 == svt_dec_out_buf(dec_handle_ptr, p_buffer))
         return_error = EB_DecNoOutputPicture;
@@ -643,8 +668,11 @@ EB_API EbErrorType svt_av1_dec_deinit(EbComponentType *svt_dec_component) {
 
     if (!dec_handle_ptr)
         return EB_ErrorNone;
-    if (dec_handle_ptr->dec_config.threads > 1)
+    if (dec_handle_ptr->frm_prll_ctxt)
+        dec_frm_prll_deinit(dec_handle_ptr->frm_prll_ctxt);
+    else if (dec_handle_ptr->dec_config.threads > 1)
         dec_sync_all_threads(dec_handle_ptr);
+    dec_pic_mgr_deinit(dec_handle_ptr);
     if (!svt_dec_memory_map)
         return EB_ErrorNone;
 
@@ -30,13 +30,17 @@ extern "C" {
 #define DEC_PAD_VALUE (DYNIMIC_PAD_VALUE + 8)
 
 /* Maximum number of frames in parallel */
-#define DEC_MAX_NUM_FRM_PRLL 1
-/** Maximum picture buffers needed **/
-#define MAX_PIC_BUFS (REF_FRAMES + 1 + DEC_MAX_NUM_FRM_PRLL)
+#define DEC_MAX_NUM_FRM_PRLL 8
+/** Maximum picture buffers needed : references, current picture and
+    the frames in flight or waiting in the output queue in frame parallel mode.
+    The picture manager uses REF_FRAMES + 2 of them in serial mode **/
+#define MAX_PIC_BUFS (REF_FRAMES + 1 + 2 * DEC_MAX_NUM_FRM_PRLL)
 
 /** Picture Structure **/
 typedef struct EbDecPicBuf {
     uint8_t is_free;
+    /* Sequence the buffer was allocated for, see EbDecPicMgr seq_id */
+    uint32_t seq_id;
 
     size_t size;
 
@@ -80,6 +84,16 @@ typedef struct EbDecPicBuf {
     int8_t ref_deltas[REF_FRAMES];
     // 0 = ZERO_MV, MV
     int8_t mode_deltas[MAX_MODE_LF_DELTAS];
+
+    /* Decode progress, tracked when the picture is decoded by a frame
+       parallel slot. parse_done : CDF, MVs and segment map are final.
+       rows_done : number of final luma rows, DEC_PIC_ALL_ROWS once the
+       bottom padding is done too. The rows are published while padding,
+       once the filters of the whole frame are done.
+       The condition variables only exist in frame parallel mode. */
+    EbBool  track_progress;
+    CondVar parse_done;
+    CondVar rows_done;
 } EbDecPicBuf;
 
 /* Frame level buffers */
@@ -242,18 +256,22 @@ typedef struct EbDecHandle {
     // Thread Handles
     EbHandle *            decode_thread_handle_array;
     EbBool                start_thread_process;
-    EbHandle              thread_semaphore;
     struct DecThreadCtxt *thread_ctxt_pa;
 
     EbBool
         is_16bit_pipeline; // internal bit-depth: when equals 1 internal bit-depth is 16bits regardless of the input bit-depth
+
+    /* Frame parallel decoding (num_p_frames > 1). Set on the API handle and
+       on the slot handles that each hold the state of one frame in flight */
+    struct DecFrmPrllCtxt *frm_prll_ctxt;
+    /* Slot only : tiles of the parsed frame are left to the frame thread */
+    EbBool frm_decode_pending;
 } EbDecHandle;
 
 /* Thread level context data */
 typedef struct DecThreadCtxt {
     /* Unique ID for the thread */
     uint32_t thread_cnt;
-    EbHandle thread_semaphore;
     /* Pointer to the decode handle */
     EbDecHandle *dec_handle_ptr;
 
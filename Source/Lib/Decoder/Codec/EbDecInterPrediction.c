@@ -528,6 +528,15 @@ void svt_make_inter_predictor(PartitionInfo *part_info, int32_t ref, void *src,
         subpel_params.subpel_y = (mv_q4.row & SUBPEL_MASK) << SCALE_EXTRA_BITS;
     }
 
+    /* Frame parallel : wait for the reference rows read by the filter taps.
+       Warp and scaled prediction can read anywhere, wait for the whole frame. */
+    if (ref_buf->track_progress && !is_intrabc) {
+        int32_t rows = (block.y1 + AOM_INTERP_EXTEND) << ss_y;
+        if (do_warp || is_scaled || rows >= ref_buf->frame_height)
+            rows = DEC_PIC_ALL_ROWS;
+        dec_pic_wait_rows(ref_buf, AOMMAX(rows, 1));
+    }
+
     if ((!do_warp && !is_intrabc) || (is_scaled && !do_warp && !is_intrabc)) {
         extend_mc_border(src,
                          &src_stride,
@@ -332,12 +332,14 @@ static EbErrorType init_parse_context (EbDecHandle  *dec_handle_ptr) {
         (MainParseCtxt*)dec_handle_ptr->pv_main_parse_ctxt;
 
     main_parse_ctx->context_count = 0;
+    main_parse_ctx->alloc_context_count = 0;
     main_parse_ctx->tile_parse_ctxt = NULL;
 
     main_parse_ctx->parse_above_nbr4x4_ctxt = NULL;
     main_parse_ctx->parse_left_nbr4x4_ctxt = NULL;
 
     main_parse_ctx->num_tiles = 0;
+    main_parse_ctx->alloc_num_tiles = 0;
     main_parse_ctx->parse_tile_data = NULL;
 
     return return_error;
@@ -504,8 +506,10 @@ EbErrorType dec_mem_init(EbDecHandle  *dec_handle_ptr) {
     if (0 == dec_handle_ptr->seq_header_done)
         return EB_ErrorNone;
 
-    /* init module ctxts */
-    return_error |= dec_pic_mgr_init(dec_handle_ptr);
+    /* init module ctxts. Frame parallel slots share the picture manager
+       of the API handle, see dec_frm_prll_seq_changed() */
+    if (!dec_handle_ptr->frm_prll_ctxt)
+        return_error |= dec_pic_mgr_init(dec_handle_ptr);
 
     return_error |= init_parse_context(dec_handle_ptr);
 
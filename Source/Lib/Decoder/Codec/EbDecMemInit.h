@@ -21,8 +21,13 @@ extern uint32_t *        svt_dec_memory_map_index;
 extern uint64_t *        svt_dec_total_lib_memory;
 extern uint32_t          svt_dec_lib_malloc_count;
 
-extern EbMemoryMapEntry *memory_map_start_address;
-extern EbMemoryMapEntry *memory_map_end_address;
+/* Number of elements to allocate for a buffer holding alloc_size elements
+   and now needing size. The buffers reallocated during the decode grow
+   geometrically : the outgrown ones stay in the memory map until deinit,
+   so they cost at most as much as the current allocation. */
+static INLINE int32_t dec_grow_size(int32_t alloc_size, int32_t size) {
+    return size <= alloc_size ? alloc_size : AOMMAX(size, 2 * alloc_size);
+}
 
 #ifdef _WIN32
 #define EB_ALLIGN_MALLOC_DEC(type, pointer, n_elements, pointer_class)                \
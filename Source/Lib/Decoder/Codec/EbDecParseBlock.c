@@ -977,6 +977,10 @@ void motion_field_projections_row(EbDecHandle *dec_handle, int sb_row, const EbD
         motion_field_projection_row(dec_handle, LAST2_FRAME, sb_row, num_blk_mv_rows, 2);
 }
 
+static void close_motion_proj_stage(DecMtFrameData *dec_mt_frame_data) {
+    svt_set_cond_var(&dec_mt_frame_data->start_motion_proj, EB_FALSE);
+}
+
 void svt_setup_motion_field(EbDecHandle *dec_handle, DecThreadCtxt *thread_ctxt) {
     DecMtFrameData *dec_mt_frame_data =
         &dec_handle->main_frame_buf.cur_frame_bufs[0].dec_mt_frame_data;
@@ -984,11 +988,8 @@ void svt_setup_motion_field(EbDecHandle *dec_handle, DecThreadCtxt *thread_ctxt)
     EbBool do_memset = EB_TRUE;
 
     if (is_mt) {
-        volatile EbBool *start_motion_proj = &dec_mt_frame_data->start_motion_proj;
-
-        while (*start_motion_proj != EB_TRUE)
-            svt_block_on_semaphore(NULL == thread_ctxt ? dec_handle->thread_semaphore
-                                                       : thread_ctxt->thread_semaphore);
+        (void)thread_ctxt;
+        dec_mt_wait_stage(&dec_mt_frame_data->start_motion_proj);
 
         DecMtMotionProjInfo *motion_proj_info = &dec_mt_frame_data->motion_proj_info;
         do_memset                             = EB_FALSE;
@@ -1079,17 +1080,10 @@ void svt_setup_motion_field(EbDecHandle *dec_handle, DecThreadCtxt *thread_ctxt)
     }
 
     if (is_mt) {
-        svt_block_on_mutex(dec_mt_frame_data->temp_mutex);
-        dec_mt_frame_data->num_threads_header++;
-        if (dec_handle->dec_config.threads == dec_mt_frame_data->num_threads_header) {
-            dec_mt_frame_data->start_motion_proj = EB_FALSE;
-        }
-        svt_release_mutex(dec_mt_frame_data->temp_mutex);
-
-        volatile uint32_t *num_threads_header = &dec_mt_frame_data->num_threads_header;
-        while (*num_threads_header != dec_handle->dec_config.threads &&
-               (EB_FALSE == dec_mt_frame_data->end_flag))
-            ;
+        dec_mt_barrier(dec_mt_frame_data,
+                       &dec_mt_frame_data->motion_proj_barrier,
+                       dec_handle->dec_config.threads,
+                       close_motion_proj_stage);
     }
 }
 
@@ -38,6 +38,9 @@ typedef struct ParseAboveNbr4x4Ctxt {
 
     int8_t *above_comp_grp_idx;
 
+    /* Number of 4x4 columns the buffers above are allocated for */
+    int32_t alloc_mi_wide;
+
 } ParseAboveNbr4x4Ctxt;
 
 typedef struct ParseLeftNbr4x4Ctxt {
@@ -150,9 +153,15 @@ typedef struct MainParseCtxt {
     /* Curent number of instances of tile context.*/
     int32_t context_count;
 
+    /* Number of instances of tile context allocated.*/
+    int32_t alloc_context_count;
+
     /* Curent number of Tiles.*/
     int32_t num_tiles;
 
+    /* Number of Tiles parse_tile_data is allocated for.*/
+    int32_t alloc_num_tiles;
+
     /* Array of ParseTileData for each Tile */
     ParseTileData *parse_tile_data;
 } MainParseCtxt;
@@ -20,6 +20,7 @@
 #include "EbObuParse.h"
 #include "EbDecMemInit.h"
 #include "EbDecPicMgr.h"
+#include "EbDecFrameParallel.h"
 #include "EbDecRestoration.h"
 #include "EbDecParseObuUtil.h"
 #include "EbDecParseFrame.h"
@@ -42,6 +43,7 @@ void dec_av1_loop_filter_frame_mt(EbDecHandle *        dec_handle_ptr,
                                   DecThreadCtxt *thread_ctxt);
 
 EbErrorType dec_system_resource_init(EbDecHandle *dec_handle_ptr, TilesInfo *tiles_info);
+EbErrorType dec_mt_resize_frame_data(EbDecHandle *dec_handle_ptr, TilesInfo *tiles_info);
 
 /* Scan through the Tiles to find Bitstream offsets */
 void svt_av1_scan_tiles(EbDecHandle *dec_handle_ptr, TilesInfo *tiles_info, ObuHeader *obu_header,
@@ -1548,20 +1550,40 @@ static INLINE EbErrorType reallocate_parse_context_memory(EbDecHandle *  dec_han
     if (num_instances == 1)
         main_parse_ctx->context_count = num_tiles;
 
-    /* TO-DO this memory will be freed at the end of decode.
-       Can be optimized by reallocating the memory when
-       the number of tiles changes within a sequence. */
-    EB_MALLOC_DEC(
-        ParseCtxt *, main_parse_ctx->tile_parse_ctxt, sizeof(ParseCtxt) * num_ctx, EB_N_PTR);
-
-    EB_MALLOC_DEC(ParseAboveNbr4x4Ctxt *,
-                  main_parse_ctx->parse_above_nbr4x4_ctxt,
-                  sizeof(ParseAboveNbr4x4Ctxt) * num_ctx,
-                  EB_N_PTR);
-    EB_MALLOC_DEC(ParseLeftNbr4x4Ctxt *,
-                  main_parse_ctx->parse_left_nbr4x4_ctxt,
-                  sizeof(ParseLeftNbr4x4Ctxt) * num_ctx,
-                  EB_N_PTR);
+    /* The contexts only grow, so that a change of tile layout reuses
+       the ones allocated for the previous layouts */
+    if (num_ctx > main_parse_ctx->alloc_context_count) {
+        ParseAboveNbr4x4Ctxt *prev_above_ctx = main_parse_ctx->parse_above_nbr4x4_ctxt;
+        ParseLeftNbr4x4Ctxt * prev_left_ctx  = main_parse_ctx->parse_left_nbr4x4_ctxt;
+        int32_t prev_count = main_parse_ctx->alloc_context_count;
+        int32_t alloc_count = dec_grow_size(prev_count, num_ctx);
+
+        EB_MALLOC_DEC(ParseCtxt *,
+                      main_parse_ctx->tile_parse_ctxt,
+                      sizeof(ParseCtxt) * alloc_count,
+                      EB_N_PTR);
+        EB_MALLOC_DEC(ParseAboveNbr4x4Ctxt *,
+                      main_parse_ctx->parse_above_nbr4x4_ctxt,
+                      sizeof(ParseAboveNbr4x4Ctxt) * alloc_count,
+                      EB_N_PTR);
+        EB_MALLOC_DEC(ParseLeftNbr4x4Ctxt *,
+                      main_parse_ctx->parse_left_nbr4x4_ctxt,
+                      sizeof(ParseLeftNbr4x4Ctxt) * alloc_count,
+                      EB_N_PTR);
+        memset(main_parse_ctx->parse_above_nbr4x4_ctxt,
+               0,
+               sizeof(ParseAboveNbr4x4Ctxt) * alloc_count);
+        memset(main_parse_ctx->parse_left_nbr4x4_ctxt, 0, sizeof(ParseLeftNbr4x4Ctxt) * alloc_count);
+        if (prev_count) {
+            svt_memcpy(main_parse_ctx->parse_above_nbr4x4_ctxt,
+                       prev_above_ctx,
+                       sizeof(ParseAboveNbr4x4Ctxt) * prev_count);
+            svt_memcpy(main_parse_ctx->parse_left_nbr4x4_ctxt,
+                       prev_left_ctx,
+                       sizeof(ParseLeftNbr4x4Ctxt) * prev_count);
+        }
+        main_parse_ctx->alloc_context_count = alloc_count;
+    }
     int total_rows = num_instances == 1 ? 1 : tiles_info.tile_rows;
     int total_cols = num_instances == 1 ? 1 : tiles_info.tile_cols;
     for (int row = 0; row < total_rows; row++) {
@@ -1573,36 +1595,52 @@ static INLINE EbErrorType reallocate_parse_context_memory(EbDecHandle *  dec_han
             num_mi_wide         = ALIGN_POWER_OF_TWO(num_mi_wide, sb_size_log2 - MI_SIZE_LOG2);
             ParseAboveNbr4x4Ctxt *above_ctx = &main_parse_ctx->parse_above_nbr4x4_ctxt[instance];
             ParseLeftNbr4x4Ctxt * left_ctx  = &main_parse_ctx->parse_left_nbr4x4_ctxt[instance];
-            EB_MALLOC_DEC(
-                uint8_t *, above_ctx->above_tx_wd, num_mi_wide * sizeof(uint8_t), EB_N_PTR);
-            EB_MALLOC_DEC(
-                uint8_t *, above_ctx->above_part_wd, num_mi_wide * sizeof(uint8_t), EB_N_PTR);
-            EB_MALLOC_DEC(uint8_t *, left_ctx->left_tx_ht, num_mi_sb * sizeof(uint8_t), EB_N_PTR);
-            EB_MALLOC_DEC(uint8_t *, left_ctx->left_part_ht, num_mi_sb * sizeof(uint8_t), EB_N_PTR);
-            /* TODO : Optimize the size for Chroma */
-            for (int i = 0; i < num_planes; i++) {
+            if (num_mi_wide > above_ctx->alloc_mi_wide) {
+                num_mi_wide = dec_grow_size(above_ctx->alloc_mi_wide, num_mi_wide);
+                above_ctx->alloc_mi_wide = num_mi_wide;
                 EB_MALLOC_DEC(
-                    uint8_t *, above_ctx->above_ctx[i], num_mi_wide * sizeof(uint8_t), EB_N_PTR);
-                EB_MALLOC_DEC(uint16_t *,
-                              above_ctx->above_palette_colors[i],
-                              num_mi_64x64 * PALETTE_MAX_SIZE * sizeof(uint16_t),
-                              EB_N_PTR);
-
+                    uint8_t *, above_ctx->above_tx_wd, num_mi_wide * sizeof(uint8_t), EB_N_PTR);
                 EB_MALLOC_DEC(
-                    uint8_t *, left_ctx->left_ctx[i], num_mi_sb * sizeof(uint8_t), EB_N_PTR);
-                EB_MALLOC_DEC(uint16_t *,
-                              left_ctx->left_palette_colors[i],
-                              num_mi_sb * PALETTE_MAX_SIZE * sizeof(uint16_t),
+                    uint8_t *, above_ctx->above_part_wd, num_mi_wide * sizeof(uint8_t), EB_N_PTR);
+                /* TODO : Optimize the size for Chroma */
+                for (int i = 0; i < num_planes; i++) {
+                    EB_MALLOC_DEC(uint8_t *,
+                                  above_ctx->above_ctx[i],
+                                  num_mi_wide * sizeof(uint8_t),
+                                  EB_N_PTR);
+                    EB_MALLOC_DEC(uint16_t *,
+                                  above_ctx->above_palette_colors[i],
+                                  num_mi_64x64 * PALETTE_MAX_SIZE * sizeof(uint16_t),
+                                  EB_N_PTR);
+                }
+                EB_MALLOC_DEC(int8_t *,
+                              above_ctx->above_comp_grp_idx,
+                              num_mi_wide * sizeof(int8_t),
+                              EB_N_PTR);
+                EB_MALLOC_DEC(uint8_t *,
+                              above_ctx->above_seg_pred_ctx,
+                              num_mi_wide * sizeof(uint8_t),
                               EB_N_PTR);
             }
-            EB_MALLOC_DEC(
-                int8_t *, above_ctx->above_comp_grp_idx, num_mi_wide * sizeof(int8_t), EB_N_PTR);
-            EB_MALLOC_DEC(
-                uint8_t *, above_ctx->above_seg_pred_ctx, num_mi_wide * sizeof(uint8_t), EB_N_PTR);
-            EB_MALLOC_DEC(
-                int8_t *, left_ctx->left_comp_grp_idx, num_mi_sb * sizeof(int8_t), EB_N_PTR);
-            EB_MALLOC_DEC(
-                uint8_t *, left_ctx->left_seg_pred_ctx, num_mi_sb * sizeof(uint8_t), EB_N_PTR);
+            /* Left context is of one SB : allocated once per instance */
+            if (left_ctx->left_tx_ht == NULL) {
+                EB_MALLOC_DEC(
+                    uint8_t *, left_ctx->left_tx_ht, num_mi_sb * sizeof(uint8_t), EB_N_PTR);
+                EB_MALLOC_DEC(
+                    uint8_t *, left_ctx->left_part_ht, num_mi_sb * sizeof(uint8_t), EB_N_PTR);
+                for (int i = 0; i < num_planes; i++) {
+                    EB_MALLOC_DEC(
+                        uint8_t *, left_ctx->left_ctx[i], num_mi_sb * sizeof(uint8_t), EB_N_PTR);
+                    EB_MALLOC_DEC(uint16_t *,
+                                  left_ctx->left_palette_colors[i],
+                                  num_mi_sb * PALETTE_MAX_SIZE * sizeof(uint16_t),
+                                  EB_N_PTR);
+                }
+                EB_MALLOC_DEC(
+                    int8_t *, left_ctx->left_comp_grp_idx, num_mi_sb * sizeof(int8_t), EB_N_PTR);
+                EB_MALLOC_DEC(
+                    uint8_t *, left_ctx->left_seg_pred_ctx, num_mi_sb * sizeof(uint8_t), EB_N_PTR);
+            }
         }
     }
     return EB_ErrorNone;
@@ -1610,12 +1648,12 @@ static INLINE EbErrorType reallocate_parse_context_memory(EbDecHandle *  dec_han
 
 static INLINE EbErrorType reallocate_parse_tile_data(MainParseCtxt *main_parse_ctx, int num_tiles) {
     main_parse_ctx->num_tiles = num_tiles;
-    /* TO-DO this memory will be freed at the end of decode.
-       Can be optimized by reallocating the memory when
-       the number of tiles changes within a sequence. */
+    if (num_tiles <= main_parse_ctx->alloc_num_tiles)
+        return EB_ErrorNone;
+    main_parse_ctx->alloc_num_tiles = dec_grow_size(main_parse_ctx->alloc_num_tiles, num_tiles);
     EB_MALLOC_DEC(ParseTileData *,
                   main_parse_ctx->parse_tile_data,
-                  sizeof(ParseTileData) * num_tiles,
+                  sizeof(ParseTileData) * main_parse_ctx->alloc_num_tiles,
                   EB_N_PTR);
     return EB_ErrorNone;
 }
@@ -1694,39 +1732,9 @@ static void check_mt_support(EbDecHandle *dec_handle_ptr) {
     }
 
     if (do_realloc) {
-        EbMemoryMapEntry *memory_entry   = svt_dec_memory_map;
-        EbMemoryMapEntry *previous_entry = NULL;
-        if (memory_entry != memory_map_end_address) {
-            while ((EbMemoryMapEntry *)memory_entry->prev_entry != memory_map_end_address) {
-                memory_entry = (EbMemoryMapEntry *)memory_entry->prev_entry;
-            }
-            previous_entry = memory_entry;
-            memory_entry   = (EbMemoryMapEntry *)memory_entry->prev_entry;
-        }
-        do {
-            switch (memory_entry->ptr_type) {
-            case EB_N_PTR: free(memory_entry->ptr); break;
-            case EB_A_PTR:
-#ifdef _WIN32
-                _aligned_free(memory_entry->ptr);
-#else
-                free(memory_entry->ptr);
-#endif
-                break;
-            case EB_SEMAPHORE: svt_destroy_semaphore(memory_entry->ptr); break;
-            case EB_THREAD: svt_destroy_thread(memory_entry->ptr); break;
-            case EB_MUTEX: svt_destroy_mutex(memory_entry->ptr); break;
-            default: break;
-            }
-            EbMemoryMapEntry *tmp_memory_entry = memory_entry;
-            memory_entry                       = (EbMemoryMapEntry *)tmp_memory_entry->prev_entry;
-            free(tmp_memory_entry);
-        } while (memory_entry != memory_map_start_address && memory_entry);
-        if (previous_entry != NULL)
-            previous_entry->prev_entry = memory_map_start_address;
-        else
-            svt_dec_memory_map = memory_map_start_address;
-        dec_system_resource_init(dec_handle_ptr, &tiles_info);
+        /* The worker threads are kept and the buffers are reused when large
+           enough : only the job state is set up for the new layout */
+        dec_mt_resize_frame_data(dec_handle_ptr, &tiles_info);
         set_prev_frame_info(dec_handle_ptr);
         realloc_parse_memory(dec_handle_ptr);
     }
@@ -2076,8 +2084,9 @@ void read_uncompressed_header(Bitstrm *bs, EbDecHandle *dec_handle_ptr, ObuHeade
     MainParseCtxt *main_parse_ctx = (MainParseCtxt *)dec_handle_ptr->pv_main_parse_ctxt;
     if (frame_info->primary_ref_frame == PRIMARY_REF_NONE)
         reset_parse_ctx(&main_parse_ctx->init_frm_ctx, frame_info->quantization_params.base_q_idx);
-    else
-        /* Load CDF */
+    else if (!dec_handle_ptr->frm_prll_ctxt)
+        /* Load CDF, done by the frame thread once prev_frame is parsed in
+           frame parallel mode */
         main_parse_ctx->init_frm_ctx = dec_handle_ptr->prev_frame->final_frm_ctx;
 
     TilesInfo tiles_info = dec_handle_ptr->frame_header.tiles_info;
@@ -2165,7 +2174,7 @@ void read_uncompressed_header(Bitstrm *bs, EbDecHandle *dec_handle_ptr, ObuHeade
     dec_handle_ptr->showable_frame      = frame_info->showable_frame;
 
     /* TODO: Should be moved to caller */
-    if (dec_handle_ptr->dec_config.threads == 1) {
+    if (dec_handle_ptr->dec_config.threads == 1 && !dec_handle_ptr->frm_prll_ctxt) {
         if (!frame_info->show_existing_frame)
             svt_setup_motion_field(dec_handle_ptr, NULL);
     }
@@ -2204,6 +2213,99 @@ EbErrorType read_frame_header_obu(Bitstrm *bs, EbDecHandle *dec_handle_ptr, ObuH
     return status;
 }
 
+/* Single thread tile decode : parse and reconstruction are fused */
+static void parse_tiles_st(EbDecHandle *dec_handle_ptr, TilesInfo *tiles_info, int tg_start,
+                           int tg_end) {
+    MainParseCtxt *main_parse_ctxt = (MainParseCtxt *)dec_handle_ptr->pv_main_parse_ctxt;
+
+    //TO-DO assign to appropriate tile_parse_ctxt
+    ParseCtxt *parse_ctxt               = &main_parse_ctxt->tile_parse_ctxt[0];
+    parse_ctxt->seq_header              = &dec_handle_ptr->seq_header;
+    parse_ctxt->frame_header            = &dec_handle_ptr->frame_header;
+    parse_ctxt->parse_above_nbr4x4_ctxt = &main_parse_ctxt->parse_above_nbr4x4_ctxt[0];
+    parse_ctxt->parse_left_nbr4x4_ctxt  = &main_parse_ctxt->parse_left_nbr4x4_ctxt[0];
+
+    for (int tile_num = tg_start; tile_num <= tg_end; tile_num++)
+        start_parse_tile(dec_handle_ptr, parse_ctxt, tiles_info, tile_num, 0);
+}
+
+/* Loop filter, CDEF, super-res upscale, loop restoration and padding */
+static void decode_frame_post_filters(EbDecHandle *dec_handle_ptr, int is_mt) {
+    FrameHeader *frame_header = &dec_handle_ptr->frame_header;
+
+    /* PPF flags derivation */
+    EbBool no_ibc = !frame_header->allow_intrabc;
+    /* LF */
+    EbBool do_lf_flag = no_ibc &&
+        (frame_header->loop_filter_params.filter_level[0] ||
+         frame_header->loop_filter_params.filter_level[1]);
+    /* CDEF */
+    EbBool do_cdef = no_ibc &&
+        (!frame_header->coded_lossless &&
+         (frame_header->cdef_params.cdef_bits || frame_header->cdef_params.cdef_y_strength[0] ||
+          frame_header->cdef_params.cdef_uv_strength[0]));
+
+    EbBool do_upscale = no_ibc && !av1_superres_unscaled(&frame_header->frame_size);
+    /* LR */
+    //EbBool opt_lr = !do_cdef && !do_upscale;
+    LrParams *lr_param = frame_header->lr_params;
+    EbBool    do_lr    = no_ibc &&
+        (lr_param[AOM_PLANE_Y].frame_restoration_type != RESTORE_NONE ||
+         lr_param[AOM_PLANE_U].frame_restoration_type != RESTORE_NONE ||
+         lr_param[AOM_PLANE_V].frame_restoration_type != RESTORE_NONE);
+
+    if (is_mt) {
+        dec_av1_loop_filter_frame_mt(dec_handle_ptr,
+                                     dec_handle_ptr->cur_pic_buf[0]->ps_pic_buf,
+                                     dec_handle_ptr->pv_lf_ctxt,
+                                     AOM_PLANE_Y,
+                                     MAX_MB_PLANE,
+                                     NULL);
+    } else {
+        dec_av1_loop_filter_frame(dec_handle_ptr,
+                                  dec_handle_ptr->cur_pic_buf[0]->ps_pic_buf,
+                                  dec_handle_ptr->pv_lf_ctxt,
+                                  AOM_PLANE_Y,
+                                  MAX_MB_PLANE,
+                                  is_mt,
+                                  do_lf_flag);
+    }
+
+    if (!is_mt && do_lr)
+        dec_av1_loop_restoration_save_boundary_lines(dec_handle_ptr, 0);
+
+    if (is_mt) {
+        svt_cdef_frame_mt(dec_handle_ptr, NULL);
+    } else
+        svt_cdef_frame(dec_handle_ptr, do_cdef);
+
+    svt_av1_superres_upscale(&dec_handle_ptr->cm,
+                             &dec_handle_ptr->frame_header,
+                             &dec_handle_ptr->seq_header,
+                             dec_handle_ptr->cur_pic_buf[0]->ps_pic_buf,
+                             do_upscale);
+
+    if (do_upscale)
+        dec_handle_ptr->cm.frm_size.frame_width =
+            dec_handle_ptr->frame_header.frame_size.frame_width;
+
+    if (do_lr && (!is_mt || do_upscale))
+        dec_av1_loop_restoration_save_boundary_lines(dec_handle_ptr, 1);
+
+    if (is_mt) {
+        if (do_upscale)
+            svt_av1_queue_lr_jobs(dec_handle_ptr);
+        dec_mt_start_stage(
+            &dec_handle_ptr->main_frame_buf.cur_frame_bufs[0].dec_mt_frame_data.start_lr_frame);
+        dec_av1_loop_restoration_filter_frame_mt(dec_handle_ptr, NULL);
+    } else
+        dec_av1_loop_restoration_filter_frame(dec_handle_ptr, 0, /*opt_lr*/ do_lr);
+
+    if (!is_mt) {
+        pad_pic(dec_handle_ptr);
+    }
+}
+
 // Read Tile group information
 EbErrorType read_tile_group_obu(Bitstrm *bs, EbDecHandle *dec_handle_ptr, TilesInfo *tiles_info,
                                 ObuHeader *obu_header, int *is_last_tg) {
@@ -2273,26 +2375,8 @@ EbErrorType read_tile_group_obu(Bitstrm *bs, EbDecHandle *dec_handle_ptr, TilesI
     uint32_t num_threads = dec_handle_ptr->dec_config.threads;
     int      is_mt       = num_threads != 1;
 
-    /* PPF flags derivation */
-    EbBool no_ibc = !dec_handle_ptr->frame_header.allow_intrabc;
-    /* LF */
-    EbBool do_lf_flag = no_ibc &&
-        (dec_handle_ptr->frame_header.loop_filter_params.filter_level[0] ||
-         dec_handle_ptr->frame_header.loop_filter_params.filter_level[1]);
-    /* CDEF */
-    EbBool do_cdef = no_ibc &&
-        (!frame_header->coded_lossless &&
-         (frame_header->cdef_params.cdef_bits || frame_header->cdef_params.cdef_y_strength[0] ||
-          frame_header->cdef_params.cdef_uv_strength[0]));
-
-    EbBool do_upscale = no_ibc && !av1_superres_unscaled(&dec_handle_ptr->frame_header.frame_size);
-    /* LR */
-    //EbBool opt_lr = !do_cdef && !do_upscale;
-    LrParams *lr_param = dec_handle_ptr->frame_header.lr_params;
-    EbBool    do_lr    = no_ibc &&
-        (lr_param[AOM_PLANE_Y].frame_restoration_type != RESTORE_NONE ||
-         lr_param[AOM_PLANE_U].frame_restoration_type != RESTORE_NONE ||
-         lr_param[AOM_PLANE_V].frame_restoration_type != RESTORE_NONE);
+    EbBool do_upscale = !dec_handle_ptr->frame_header.allow_intrabc &&
+        !av1_superres_unscaled(&dec_handle_ptr->frame_header.frame_size);
 
     /* Set Parse Jobs */
     if (is_mt) {
@@ -2330,44 +2414,20 @@ EbErrorType read_tile_group_obu(Bitstrm *bs, EbDecHandle *dec_handle_ptr, TilesI
         dec_mt_frame_data->motion_proj_info.num_motion_proj_rows       = sb_mvs_rows;
         dec_mt_frame_data->motion_proj_info.motion_proj_row_to_process = 0;
         dec_mt_frame_data->motion_proj_info.motion_proj_init_done      = EB_FALSE;
-        dec_mt_frame_data->num_threads_header                          = 0;
 
-        svt_block_on_mutex(dec_mt_frame_data->temp_mutex);
-        dec_mt_frame_data->start_motion_proj = EB_TRUE;
-        svt_release_mutex(dec_mt_frame_data->temp_mutex);
-        svt_post_semaphore(dec_handle_ptr->thread_semaphore);
-        for (uint32_t lib_thrd = 0; lib_thrd < num_threads - 1; lib_thrd++)
-            svt_post_semaphore(dec_handle_ptr->thread_ctxt_pa[lib_thrd].thread_semaphore);
+        dec_mt_start_stage(&dec_mt_frame_data->start_motion_proj);
 
         svt_setup_motion_field(dec_handle_ptr, NULL);
 
         svt_av1_queue_parse_jobs(dec_handle_ptr, tiles_info);
 
-        svt_block_on_mutex(dec_mt_frame_data->temp_mutex);
-        dec_mt_frame_data->start_parse_frame = EB_TRUE;
-
-        dec_mt_frame_data->num_threads_cdefed = 0;
-        dec_mt_frame_data->num_threads_lred   = 0;
-
-        svt_release_mutex(dec_mt_frame_data->temp_mutex);
-        svt_post_semaphore(dec_handle_ptr->thread_semaphore);
-        for (uint32_t lib_thrd = 0; lib_thrd < num_threads - 1; lib_thrd++)
-            svt_post_semaphore(dec_handle_ptr->thread_ctxt_pa[lib_thrd].thread_semaphore);
+        dec_mt_start_stage(&dec_mt_frame_data->start_parse_frame);
 
         svt_av1_queue_lf_jobs(dec_handle_ptr);
         svt_av1_queue_cdef_jobs(dec_handle_ptr);
-        svt_block_on_mutex(dec_mt_frame_data->temp_mutex);
-
-        dec_mt_frame_data->start_lf_frame = EB_TRUE;
-        /*ToDo : Post outside mutex lock */
-        svt_post_semaphore(dec_handle_ptr->thread_semaphore);
-        for (uint32_t lib_thrd = 0; lib_thrd < num_threads - 1; lib_thrd++)
-            svt_post_semaphore(dec_handle_ptr->thread_ctxt_pa[lib_thrd].thread_semaphore);
-        dec_mt_frame_data->start_cdef_frame = EB_TRUE;
-        svt_post_semaphore(dec_handle_ptr->thread_semaphore);
-        for (uint32_t lib_thrd = 0; lib_thrd < num_threads - 1; lib_thrd++)
-            svt_post_semaphore(dec_handle_ptr->thread_ctxt_pa[lib_thrd].thread_semaphore);
-        svt_release_mutex(dec_mt_frame_data->temp_mutex);
+
+        dec_mt_start_stage(&dec_mt_frame_data->start_lf_frame);
+        dec_mt_start_stage(&dec_mt_frame_data->start_cdef_frame);
 
         if (!do_upscale)
             svt_av1_queue_lr_jobs(dec_handle_ptr);
@@ -2376,93 +2436,58 @@ EbErrorType read_tile_group_obu(Bitstrm *bs, EbDecHandle *dec_handle_ptr, TilesI
 
         decode_frame_tiles(dec_handle_ptr, NULL);
     } else {
-        //TO-DO assign to appropriate tile_parse_ctxt
-        ParseCtxt *parse_ctxt               = &main_parse_ctxt->tile_parse_ctxt[0];
-        parse_ctxt->seq_header              = &dec_handle_ptr->seq_header;
-        parse_ctxt->frame_header            = &dec_handle_ptr->frame_header;
-        parse_ctxt->parse_above_nbr4x4_ctxt = &main_parse_ctxt->parse_above_nbr4x4_ctxt[0];
-        parse_ctxt->parse_left_nbr4x4_ctxt  = &main_parse_ctxt->parse_left_nbr4x4_ctxt[0];
-
-        for (int tile_num = tg_start; tile_num <= tg_end; tile_num++) {
-            size_t tile_size;
-            if (tile_num == tg_end)
-                tile_size = obu_header->payload_size;
-            else {
-                tile_size = dec_get_bits_le(bs, tiles_info->tile_size_bytes) + 1;
-                obu_header->payload_size -= (tiles_info->tile_size_bytes + tile_size);
-            }
-
-            ParseTileData *parse_tile_data      = main_parse_ctxt->parse_tile_data;
-            parse_tile_data[tile_num].data      = get_bitsteam_buf(bs);
-            parse_tile_data[tile_num].data_end  = bs->buf_max;
-            parse_tile_data[tile_num].tile_size = tile_size;
-
-            start_parse_tile(dec_handle_ptr, parse_ctxt, tiles_info, tile_num, is_mt);
-            dec_bits_init(bs, (get_bitsteam_buf(bs) + tile_size), obu_header->payload_size);
-        }
+        svt_av1_scan_tiles(dec_handle_ptr, tiles_info, obu_header, bs, tg_start, tg_end);
+        /* Frame parallel slot : the tiles are decoded by the frame thread */
+        if (!dec_handle_ptr->frm_prll_ctxt)
+            parse_tiles_st(dec_handle_ptr, tiles_info, tg_start, tg_end);
     }
 
     if ((tg_end + 1) != num_tiles)
         return 0;
 
-    if (is_mt) {
-        dec_av1_loop_filter_frame_mt(dec_handle_ptr,
-                                     dec_handle_ptr->cur_pic_buf[0]->ps_pic_buf,
-                                     dec_handle_ptr->pv_lf_ctxt,
-                                     AOM_PLANE_Y,
-                                     MAX_MB_PLANE,
-                                     NULL);
-    } else {
-        dec_av1_loop_filter_frame(dec_handle_ptr,
-                                  dec_handle_ptr->cur_pic_buf[0]->ps_pic_buf,
-                                  dec_handle_ptr->pv_lf_ctxt,
-                                  AOM_PLANE_Y,
-                                  MAX_MB_PLANE,
-                                  is_mt,
-                                  do_lf_flag);
+    if (dec_handle_ptr->frm_prll_ctxt) {
+        dec_handle_ptr->frm_decode_pending = EB_TRUE;
+        return status;
     }
 
-    if (!is_mt && do_lr)
-        dec_av1_loop_restoration_save_boundary_lines(dec_handle_ptr, 0);
+    /* Save CDF */
+    if (frame_header->disable_frame_end_update_cdf)
+        dec_handle_ptr->cur_pic_buf[0]->final_frm_ctx = main_parse_ctxt->init_frm_ctx;
 
-    if (is_mt) {
-        svt_cdef_frame_mt(dec_handle_ptr, NULL);
-    } else
-        svt_cdef_frame(dec_handle_ptr, do_cdef);
+    decode_frame_post_filters(dec_handle_ptr, is_mt);
 
-    svt_av1_superres_upscale(&dec_handle_ptr->cm,
-                             &dec_handle_ptr->frame_header,
-                             &dec_handle_ptr->seq_header,
-                             dec_handle_ptr->cur_pic_buf[0]->ps_pic_buf,
-                             do_upscale);
+    return status;
+}
 
-    if (do_upscale)
-        dec_handle_ptr->cm.frm_size.frame_width =
-            dec_handle_ptr->frame_header.frame_size.frame_width;
+/* Decode the tiles of a frame parsed by a frame parallel slot.
+   Runs on the slot's frame thread. */
+EbErrorType decode_deferred_frame(EbDecHandle *dec_handle_ptr) {
+    MainParseCtxt *main_parse_ctxt = (MainParseCtxt *)dec_handle_ptr->pv_main_parse_ctxt;
+    FrameHeader *  frame_header    = &dec_handle_ptr->frame_header;
+    TilesInfo *    tiles_info      = &frame_header->tiles_info;
+    EbDecPicBuf *  cur_buf         = dec_handle_ptr->cur_pic_buf[0];
 
-    if (do_lr && (!is_mt || do_upscale))
-        dec_av1_loop_restoration_save_boundary_lines(dec_handle_ptr, 1);
+    /* CDF, MVs and segment map of the references must be final */
+    for (MvReferenceFrame ref = LAST_FRAME; ref <= ALTREF_FRAME; ref++)
+        dec_pic_wait_parse_done(get_ref_frame_buf(dec_handle_ptr, ref));
+    dec_pic_wait_parse_done(dec_handle_ptr->prev_frame);
 
-    if (is_mt) {
-        if (do_upscale)
-            svt_av1_queue_lr_jobs(dec_handle_ptr);
-        dec_handle_ptr->main_frame_buf.cur_frame_bufs[0].dec_mt_frame_data.start_lr_frame = EB_TRUE;
-        svt_post_semaphore(dec_handle_ptr->thread_semaphore);
-        for (uint32_t lib_thrd = 0; lib_thrd < num_threads - 1; lib_thrd++)
-            svt_post_semaphore(dec_handle_ptr->thread_ctxt_pa[lib_thrd].thread_semaphore);
-        dec_av1_loop_restoration_filter_frame_mt(dec_handle_ptr, NULL);
-    } else
-        dec_av1_loop_restoration_filter_frame(dec_handle_ptr, 0, /*opt_lr*/ do_lr);
+    /* Load CDF */
+    if (frame_header->primary_ref_frame != PRIMARY_REF_NONE)
+        main_parse_ctxt->init_frm_ctx = dec_handle_ptr->prev_frame->final_frm_ctx;
+
+    svt_setup_motion_field(dec_handle_ptr, NULL);
+
+    parse_tiles_st(dec_handle_ptr, tiles_info, 0, tiles_info->tile_cols * tiles_info->tile_rows - 1);
 
     /* Save CDF */
     if (frame_header->disable_frame_end_update_cdf)
-        dec_handle_ptr->cur_pic_buf[0]->final_frm_ctx = main_parse_ctxt->init_frm_ctx;
+        cur_buf->final_frm_ctx = main_parse_ctxt->init_frm_ctx;
+    dec_pic_signal_parse_done(cur_buf);
 
-    if (!is_mt) {
-        pad_pic(dec_handle_ptr);
-    }
+    decode_frame_post_filters(dec_handle_ptr, 0);
 
-    return status;
+    return EB_ErrorNone;
 }
 
 // Decode all OBUs in a Frame
@@ -2549,6 +2574,13 @@ EbErrorType decode_multiple_obu(EbDecHandle *dec_handle_ptr, uint8_t **data, siz
                 prev_max_frame_width != dec_handle_ptr->seq_header.max_frame_width ||
                 prev_max_frame_height != dec_handle_ptr->seq_header.max_frame_height) {
                 dec_handle_ptr->mem_init_done = 0;
+                if (dec_handle_ptr->pv_pic_mgr)
+                    dec_pic_mgr_release_refs(dec_handle_ptr);
+                if (dec_handle_ptr->frm_prll_ctxt) {
+                    status = dec_frm_prll_seq_changed(dec_handle_ptr);
+                    if (status != EB_ErrorNone)
+                        return status;
+                }
             }
             break;
         }
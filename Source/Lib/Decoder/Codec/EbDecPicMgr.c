@@ -27,6 +27,7 @@
 #include "EbDecUtils.h"
 
 #include "EbDecPicMgr.h"
+#include "EbDecFrameParallel.h"
 
 #define NUM_REF_FRAMES 8 // TODO: remove (reuse EbObuParse.h macro)
 
@@ -54,20 +55,51 @@ EbErrorType dec_pic_mgr_init(EbDecHandle *dec_handle_ptr) {
     uint32_t      mi_cols     = 2 * ((dec_handle_ptr->seq_header.max_frame_width + 7) >> 3);
     uint32_t      mi_rows     = 2 * ((dec_handle_ptr->seq_header.max_frame_height + 7) >> 3);
     int           size        = mi_cols * mi_rows;
+    /* Frame parallel slots publish their decode progress */
+    DecFrmPrllCtxt *frm_prll_ctxt = dec_handle_ptr->frm_prll_ctxt;
 
     EbErrorType return_error = EB_ErrorNone;
     int32_t     i;
 
+    if (*pps_pic_mgr != NULL) {
+        /* New sequence : the manager is reused, the buffers still held by
+           the previous sequence are released through their reference count */
+        EbDecPicMgr *ps_pic_mgr = *pps_pic_mgr;
+        ps_pic_mgr->seq_id++;
+        for (i = 0; i < ps_pic_mgr->max_pic_bufs; i++) {
+            if (ps_pic_mgr->seg_map_size < size)
+                EB_MALLOC_DEC(uint8_t *,
+                              ps_pic_mgr->as_dec_pic[i].segment_maps,
+                              size * sizeof(uint8_t),
+                              EB_N_PTR);
+            memset(ps_pic_mgr->as_dec_pic[i].segment_maps, 0, size);
+        }
+        ps_pic_mgr->seg_map_size = AOMMAX(ps_pic_mgr->seg_map_size, size);
+        return return_error;
+    }
+
     EB_MALLOC_DEC(void *, *pps_pic_mgr, sizeof(EbDecPicMgr), EB_N_PTR);
 
     EbDecPicMgr *ps_pic_mgr = *pps_pic_mgr;
 
-    for (i = 0; i < MAX_PIC_BUFS; i++) {
+    ps_pic_mgr->max_pic_bufs = frm_prll_ctxt ? REF_FRAMES + 1 + 2 * frm_prll_ctxt->num_slots
+                                             : REF_FRAMES + 2;
+    assert(ps_pic_mgr->max_pic_bufs <= MAX_PIC_BUFS);
+    ps_pic_mgr->seg_map_size = size;
+    ps_pic_mgr->seq_id       = 0;
+
+    for (i = 0; i < ps_pic_mgr->max_pic_bufs; i++) {
         ps_pic_mgr->as_dec_pic[i].ps_pic_buf = NULL;
         ps_pic_mgr->as_dec_pic[i].is_free    = 1;
         ps_pic_mgr->as_dec_pic[i].size       = 0;
         ps_pic_mgr->as_dec_pic[i].ref_count  = 0;
         ps_pic_mgr->as_dec_pic[i].mvs        = NULL;
+        ps_pic_mgr->as_dec_pic[i].seq_id     = 0;
+        ps_pic_mgr->as_dec_pic[i].track_progress = EB_FALSE;
+        if (frm_prll_ctxt &&
+            (svt_create_cond_var(&ps_pic_mgr->as_dec_pic[i].parse_done) != EB_ErrorNone ||
+             svt_create_cond_var(&ps_pic_mgr->as_dec_pic[i].rows_done) != EB_ErrorNone))
+            return EB_ErrorInsufficientResources;
         EB_MALLOC_DEC(
             uint8_t *, ps_pic_mgr->as_dec_pic[i].segment_maps, size * sizeof(uint8_t), EB_N_PTR);
         memset(ps_pic_mgr->as_dec_pic[i].segment_maps, 0, size);
@@ -78,6 +110,18 @@ EbErrorType dec_pic_mgr_init(EbDecHandle *dec_handle_ptr) {
     return return_error;
 }
 
+/* Frees the condition variables, the memory is freed with the memory map */
+void dec_pic_mgr_deinit(EbDecHandle *dec_handle_ptr) {
+    EbDecPicMgr *ps_pic_mgr = (EbDecPicMgr *)dec_handle_ptr->pv_pic_mgr;
+
+    if (ps_pic_mgr == NULL || !dec_handle_ptr->frm_prll_ctxt)
+        return;
+    for (int32_t i = 0; i < ps_pic_mgr->max_pic_bufs; i++) {
+        svt_free_cond_var(&ps_pic_mgr->as_dec_pic[i].parse_done);
+        svt_free_cond_var(&ps_pic_mgr->as_dec_pic[i].rows_done);
+    }
+}
+
 static INLINE EbErrorType mvs_8x8_memory_alloc(TemporalMvRef **mvs, FrameHeader *frame_info) {
     const int frame_mvs_stride = ROUND_POWER_OF_TWO(frame_info->mi_cols, 1);
     const int frame_mvs_rows   = ROUND_POWER_OF_TWO(frame_info->mi_rows, 1);
@@ -118,12 +162,21 @@ EbDecPicBuf *dec_pic_mgr_get_cur_pic(EbDecHandle *dec_handle_ptr) {
     EbDecPicBuf * pic_buf = NULL;
     /* TODO: Add lock and unlock for MT */
     // Find a free buffer.
-    for (i = 0; i < MAX_PIC_BUFS; i++) {
+    for (i = 0; i < ps_pic_mgr->max_pic_bufs; i++) {
         if (ps_pic_mgr->as_dec_pic[i].is_free == 1)
             break;
     }
 
-    if (i >= MAX_PIC_BUFS)
+    if (i >= ps_pic_mgr->max_pic_bufs && dec_handle_ptr->frm_prll_ctxt) {
+        /* All buffers held by frames in flight : wait for them and retry */
+        dec_frm_prll_retire_all(dec_handle_ptr->frm_prll_ctxt);
+        for (i = 0; i < ps_pic_mgr->max_pic_bufs; i++) {
+            if (ps_pic_mgr->as_dec_pic[i].is_free == 1)
+                break;
+        }
+    }
+
+    if (i >= ps_pic_mgr->max_pic_bufs)
         return NULL;
 
     uint16_t       frame_width  = frame_info->frame_size.frame_width;
@@ -135,7 +188,8 @@ EbDecPicBuf *dec_pic_mgr_get_cur_pic(EbDecHandle *dec_handle_ptr) {
                                         ((frame_height + 2 * DEC_PAD_VALUE) >> cc->subsampling_y));
     size_t         frame_size = y_size + uv_size;
 
-    if (ps_pic_mgr->as_dec_pic[i].size < frame_size) {
+    if (ps_pic_mgr->as_dec_pic[i].size < frame_size ||
+        ps_pic_mgr->as_dec_pic[i].seq_id != ps_pic_mgr->seq_id) {
         /* allocate the buffer. TODO: Should add free and allocate logic */
 
         EbPictureBufferDescInitData input_pic_buf_desc_init_data;
@@ -164,7 +218,8 @@ EbDecPicBuf *dec_pic_mgr_get_cur_pic(EbDecHandle *dec_handle_ptr) {
         if (return_error != EB_ErrorNone)
             return NULL;
 
-        ps_pic_mgr->as_dec_pic[i].size = frame_size;
+        ps_pic_mgr->as_dec_pic[i].size   = frame_size;
+        ps_pic_mgr->as_dec_pic[i].seq_id = ps_pic_mgr->seq_id;
 
         /* Memory for storing MV's at 8x8 lvl*/
         EbErrorType ret_err = mvs_8x8_memory_alloc(&ps_pic_mgr->as_dec_pic[i].mvs, frame_info);
@@ -180,6 +235,13 @@ EbDecPicBuf *dec_pic_mgr_get_cur_pic(EbDecHandle *dec_handle_ptr) {
 
     pic_buf = &ps_pic_mgr->as_dec_pic[i];
 
+    /* Frames decoded by frame parallel slots publish their progress */
+    pic_buf->track_progress = dec_handle_ptr->frm_prll_ctxt != NULL;
+    if (pic_buf->track_progress) {
+        svt_set_cond_var(&pic_buf->parse_done, 0);
+        svt_set_cond_var(&pic_buf->rows_done, 0);
+    }
+
     return pic_buf;
 }
 
@@ -191,6 +253,54 @@ static INLINE void dec_ref_count_and_rel(EbDecPicBuf *ps_pic_buf) {
     }
 }
 
+/* Extra reference taken by a frame in flight or a queued output picture.
+   Only the thread calling the API updates the reference counts. */
+void dec_pic_mgr_hold_pic(EbDecPicBuf *ps_pic_buf) {
+    if (ps_pic_buf != NULL)
+        ps_pic_buf->ref_count++;
+}
+
+void dec_pic_mgr_release_pic(EbDecPicBuf *ps_pic_buf) { dec_ref_count_and_rel(ps_pic_buf); }
+
+/* New sequence : the references of the previous one are not used anymore */
+void dec_pic_mgr_release_refs(EbDecHandle *dec_handle_ptr) {
+    for (int32_t i = 0; i < REF_FRAMES; i++) {
+        dec_ref_count_and_rel(dec_handle_ptr->ref_frame_map[i]);
+        dec_handle_ptr->ref_frame_map[i] = NULL;
+    }
+}
+
+void dec_pic_signal_parse_done(EbDecPicBuf *ps_pic_buf) {
+    if (ps_pic_buf->track_progress)
+        svt_set_cond_var(&ps_pic_buf->parse_done, 1);
+}
+
+void dec_pic_wait_parse_done(EbDecPicBuf *ps_pic_buf) {
+    if (ps_pic_buf == NULL || !ps_pic_buf->track_progress)
+        return;
+    if (!svt_atomic_load_i32(&ps_pic_buf->parse_done.val))
+        svt_wait_cond_var(&ps_pic_buf->parse_done, 0);
+}
+
+void dec_pic_signal_rows(EbDecPicBuf *ps_pic_buf, int32_t rows) {
+    if (ps_pic_buf->track_progress)
+        svt_set_cond_var(&ps_pic_buf->rows_done, rows);
+}
+
+/* Block until the first rows luma rows of the picture are final */
+void dec_pic_wait_rows(EbDecPicBuf *ps_pic_buf, int32_t rows) {
+    int32_t done;
+    if (ps_pic_buf == NULL || !ps_pic_buf->track_progress)
+        return;
+    while ((done = svt_atomic_load_i32(&ps_pic_buf->rows_done.val)) < rows)
+        svt_wait_cond_var(&ps_pic_buf->rows_done, done);
+}
+
+EbBool dec_pic_rows_ready(EbDecPicBuf *ps_pic_buf, int32_t rows) {
+    return !ps_pic_buf->track_progress ||
+        svt_atomic_load_i32(&ps_pic_buf->rows_done.val) >= rows;
+}
+
 /**
 *******************************************************************************
 *
@@ -24,8 +24,21 @@ typedef struct EbDecPicMgr {
     /* number of picture buffers */
     uint8_t num_pic_bufs;
 
+    /* number of entries of as_dec_pic in use */
+    int32_t max_pic_bufs;
+
+    /* size of the segment maps */
+    int32_t seg_map_size;
+
+    /* incremented on every new sequence, the buffers allocated for
+       a previous sequence are reallocated when reused */
+    uint32_t seq_id;
+
 } EbDecPicMgr;
 
+/* rows_done value once the whole picture, padding included, is final */
+#define DEC_PIC_ALL_ROWS INT32_MAX
+
 typedef struct RefFrameInfo {
     int32_t      map_idx; /* frame map index */
     EbDecPicBuf *pic_buf; /* frame buffer */
@@ -35,8 +48,20 @@ typedef struct RefFrameInfo {
 
 EbErrorType dec_pic_mgr_init(EbDecHandle *dec_handle_ptr);
 
+void dec_pic_mgr_deinit(EbDecHandle *dec_handle_ptr);
+
 EbDecPicBuf *dec_pic_mgr_get_cur_pic(EbDecHandle *dec_handle_ptr);
 
+void dec_pic_mgr_hold_pic(EbDecPicBuf *ps_pic_buf);
+void dec_pic_mgr_release_pic(EbDecPicBuf *ps_pic_buf);
+void dec_pic_mgr_release_refs(EbDecHandle *dec_handle_ptr);
+
+void dec_pic_signal_parse_done(EbDecPicBuf *ps_pic_buf);
+void dec_pic_wait_parse_done(EbDecPicBuf *ps_pic_buf);
+void dec_pic_signal_rows(EbDecPicBuf *ps_pic_buf, int32_t rows);
+void   dec_pic_wait_rows(EbDecPicBuf *ps_pic_buf, int32_t rows);
+EbBool dec_pic_rows_ready(EbDecPicBuf *ps_pic_buf, int32_t rows);
+
 void dec_pic_mgr_update_ref_pic(EbDecHandle *dec_handle_ptr, int32_t frame_decoded,
                                 int32_t refresh_frame_flags);
 
@@ -133,141 +133,174 @@ int32_t get_sb_row_to_process(DecMtRowInfo *sb_row_info) {
 /************************************
 * System Resource Managers & Fifos
 ************************************/
-EbErrorType dec_system_resource_init(EbDecHandle *dec_handle_ptr, TilesInfo *tiles_info) {
-    EbErrorType     return_error = EB_ErrorNone;
-    DecMtFrameData *dec_mt_frame_data =
-        &dec_handle_ptr->main_frame_buf.cur_frame_bufs[0].dec_mt_frame_data;
+/* Open a stage : wakes all the threads waiting for it */
+void dec_mt_start_stage(CondVar *stage) {
+    if (!svt_atomic_load_i32(&stage->val))
+        svt_set_cond_var(stage, EB_TRUE);
+}
 
-    memory_map_start_address = svt_dec_memory_map;
-    memset(&dec_mt_frame_data->prev_frame_info, 0, sizeof(PrevFrameMtCheck));
+void dec_mt_wait_stage(CondVar *stage) {
+    if (!svt_atomic_load_i32(&stage->val))
+        svt_wait_cond_var(stage, EB_FALSE);
+}
 
-    int32_t num_tiles = tiles_info->tile_cols * tiles_info->tile_rows;
+/* Wait for all the threads. The last thread to arrive runs last_fn before
+   the others are released. The round count is never reset, so a thread
+   late to wake up cannot miss its release. */
+void dec_mt_barrier(DecMtFrameData *dec_mt_frame_data, DecMtBarrier *barrier, uint32_t num_threads,
+                    void (*last_fn)(DecMtFrameData *)) {
+    if (EB_TRUE == dec_mt_frame_data->end_flag)
+        return;
 
-    assert(dec_handle_ptr->dec_config.threads > 1);
-#if MT_WAIT_PROFILE
-    dec_mt_frame_data->fp = fopen("profile.txt", "w"); // stdout;
-#endif
-    /************************************
-    * System Resource Managers & Fifos
-    ************************************/
+    svt_block_on_mutex(dec_mt_frame_data->temp_mutex);
+    int32_t round = svt_atomic_load_i32(&barrier->round.val);
+    EbBool  last  = ++barrier->num_arrived == num_threads;
+    if (last)
+        barrier->num_arrived = 0;
+    svt_release_mutex(dec_mt_frame_data->temp_mutex);
 
-    /* Motion Filed Projection*/
-    dec_mt_frame_data->motion_proj_info.num_motion_proj_rows = -1;
-    EB_CREATE_MUTEX(dec_mt_frame_data->motion_proj_info.motion_proj_mutex);
+    if (last) {
+        if (last_fn)
+            last_fn(dec_mt_frame_data);
+        svt_set_cond_var(&barrier->round, round + 1);
+    } else
+        svt_wait_cond_var(&barrier->round, round);
+}
+
+/* Close the stages for the next frame */
+static void dec_mt_close_all_stages(DecMtFrameData *dec_mt_frame_data) {
+    svt_set_cond_var(&dec_mt_frame_data->start_motion_proj, EB_FALSE);
+    svt_set_cond_var(&dec_mt_frame_data->start_parse_frame, EB_FALSE);
+    svt_set_cond_var(&dec_mt_frame_data->start_decode_frame, EB_FALSE);
+    svt_set_cond_var(&dec_mt_frame_data->start_lf_frame, EB_FALSE);
+    svt_set_cond_var(&dec_mt_frame_data->start_cdef_frame, EB_FALSE);
+    svt_set_cond_var(&dec_mt_frame_data->start_lr_frame, EB_FALSE);
+}
+
+/* Size the MT buffers for the current frame size and tile layout. The buffers
+   only grow, geometrically, so that a later change of frame size or tile
+   layout mostly costs a reset of the job state. The worker threads and the
+   mutexes are kept. */
+EbErrorType dec_mt_resize_frame_data(EbDecHandle *dec_handle_ptr, TilesInfo *tiles_info) {
+    DecMtFrameData *dec_mt_frame_data =
+        &dec_handle_ptr->main_frame_buf.cur_frame_bufs[0].dec_mt_frame_data;
+
+    int32_t num_tiles = tiles_info->tile_cols * tiles_info->tile_rows;
 
     int32_t  sb_size_h            = block_size_high[dec_handle_ptr->seq_header.sb_size];
     uint32_t picture_height_in_sb = (dec_handle_ptr->frame_header.frame_size.frame_height +
                                      sb_size_h - 1) /
         sb_size_h;
 
-    /************************************
-    * Contexts
-    ************************************/
-    /* Parse */
-    DecMtRowInfo *parse_tile_info = &dec_mt_frame_data->parse_tile_info;
+    /* Decode Module contexts of the threads, sized for the SB size */
+    if (dec_mt_frame_data->alloc_sb_size != dec_handle_ptr->seq_header.sb_size) {
+        uint32_t num_lib_threads = (int32_t)dec_handle_ptr->dec_config.threads - 1;
+        for (uint32_t i = 0; i < num_lib_threads; i++) {
+            EbErrorType return_error = init_dec_mod_ctxt(
+                dec_handle_ptr, (void **)&dec_handle_ptr->thread_ctxt_pa[i].dec_mod_ctxt);
+            if (return_error != EB_ErrorNone)
+                return return_error;
+        }
+        dec_mt_frame_data->alloc_sb_size = dec_handle_ptr->seq_header.sb_size;
+    }
 
-    EB_CREATE_MUTEX(parse_tile_info->sbrow_mutex);
-    parse_tile_info->num_sb_rows       = num_tiles;
-    parse_tile_info->sb_row_to_process = 0;
+    /* Parse */
+    dec_mt_frame_data->parse_tile_info.num_sb_rows = num_tiles;
 
     /* Recon */
-    EB_MALLOC_DEC(uint32_t *,
-                  dec_mt_frame_data->sb_recon_row_map,
-                  picture_height_in_sb * tiles_info->tile_cols * sizeof(uint32_t),
-                  EB_N_PTR);
-
-    DecMtRowInfo *recon_tile_info = &dec_mt_frame_data->recon_tile_info;
-    EB_CREATE_MUTEX(recon_tile_info->sbrow_mutex);
+    int32_t recon_row_map_size = picture_height_in_sb * tiles_info->tile_cols;
+    if (recon_row_map_size > dec_mt_frame_data->alloc_recon_row_map) {
+        dec_mt_frame_data->alloc_recon_row_map =
+            dec_grow_size(dec_mt_frame_data->alloc_recon_row_map, recon_row_map_size);
+        EB_MALLOC_DEC(uint32_t *,
+                      dec_mt_frame_data->sb_recon_row_map,
+                      dec_mt_frame_data->alloc_recon_row_map * sizeof(uint32_t),
+                      EB_N_PTR);
+    }
+    dec_mt_frame_data->recon_tile_info.num_sb_rows = num_tiles;
 
-    recon_tile_info->num_sb_rows       = num_tiles;
-    recon_tile_info->sb_row_to_process = 0;
     /* recon top right sync */
-    {
-        int32_t tiles_ctr;
-
-        EB_CREATE_MUTEX(dec_mt_frame_data->tile_switch_mutex);
+    if (num_tiles > dec_mt_frame_data->alloc_num_tiles) {
+        DecMtParseReconTileInfo *prev_array     = dec_mt_frame_data->parse_recon_tile_info_array;
+        int32_t                  prev_num_tiles = dec_mt_frame_data->alloc_num_tiles;
+        int32_t alloc_num_tiles = dec_grow_size(prev_num_tiles, num_tiles);
 
         EB_MALLOC_DEC(DecMtParseReconTileInfo *,
                       dec_mt_frame_data->parse_recon_tile_info_array,
-                      num_tiles * sizeof(DecMtParseReconTileInfo),
+                      alloc_num_tiles * sizeof(DecMtParseReconTileInfo),
                       EB_N_PTR);
-
-        for (tiles_ctr = 0; tiles_ctr < num_tiles; tiles_ctr++) {
-            int32_t   tile_row = tiles_ctr / tiles_info->tile_cols;
-            int32_t   tile_col = tiles_ctr % tiles_info->tile_cols;
-            int32_t   tile_num_sb_rows;
-            TileInfo *tile_info;
-
-            tile_info = &dec_mt_frame_data->parse_recon_tile_info_array[tiles_ctr].tile_info;
-
-            /* init tile info */
-            svt_tile_init(tile_info, &dec_handle_ptr->frame_header, tile_row, tile_col);
-
-            tile_num_sb_rows = ((((tile_info->mi_row_end - 1) << MI_SIZE_LOG2) >>
-                                 dec_handle_ptr->seq_header.sb_size_log2) -
-                                ((tile_info->mi_row_start << MI_SIZE_LOG2) >>
-                                 dec_handle_ptr->seq_header.sb_size_log2) +
-                                1);
-
-            dec_mt_frame_data->parse_recon_tile_info_array[tiles_ctr].tile_num_sb_rows =
-                tile_num_sb_rows;
-
-            EB_MALLOC_DEC(
-                uint32_t *,
-                dec_mt_frame_data->parse_recon_tile_info_array[tiles_ctr].sb_recon_row_parsed,
-                tile_num_sb_rows * sizeof(uint32_t),
-                EB_N_PTR);
-
-            EB_MALLOC_DEC(
-                uint32_t *,
-                dec_mt_frame_data->parse_recon_tile_info_array[tiles_ctr].sb_recon_completed_in_row,
-                tile_num_sb_rows * sizeof(uint32_t),
-                EB_N_PTR);
-
-            EB_MALLOC_DEC(
-                uint32_t *,
-                dec_mt_frame_data->parse_recon_tile_info_array[tiles_ctr].sb_recon_row_started,
-                tile_num_sb_rows * sizeof(uint32_t),
-                EB_N_PTR);
-
-            EB_CREATE_MUTEX(
-                dec_mt_frame_data->parse_recon_tile_info_array[tiles_ctr].tile_sbrow_mutex);
-
-            /* SB row queue */
-            //EB_NEW(dec_mt_frame_data->parse_recon_tile_info_array[tiles_ctr].recon_tile_sbrow_resource_ptr,
-            //    svt_system_resource_ctor,
-            //    tile_num_sb_rows, /* object_total_count */
-            //    1, /* producer procs cnt : 1 Q per cnt is created inside, so kept 1*/
-            //    1, /* consumer prcos cnt : 1 Q per cnt is created inside, so kept 1*/
-            //    &dec_mt_frame_data->parse_recon_tile_info_array[tiles_ctr].recon_tile_sbrow_producer_fifo_ptr, /* producer_fifo */
-            //    &dec_mt_frame_data->parse_recon_tile_info_array[tiles_ctr].recon_tile_sbrow_consumer_fifo_ptr, /* consumer_fifo */
-            //    EB_TRUE, /* Full Queue*/
-            //    dec_dummy_creator, // Removed in "dec_dummy_creator: unusedFunction"
-            //    &node_idx,
-            //    NULL);
+        /* The tiles allocated so far keep their row arrays and mutex */
+        if (prev_num_tiles)
+            svt_memcpy(dec_mt_frame_data->parse_recon_tile_info_array,
+                       prev_array,
+                       prev_num_tiles * sizeof(DecMtParseReconTileInfo));
+        for (int32_t tiles_ctr = prev_num_tiles; tiles_ctr < alloc_num_tiles; tiles_ctr++) {
+            DecMtParseReconTileInfo *parse_recon_tile_info =
+                &dec_mt_frame_data->parse_recon_tile_info_array[tiles_ctr];
+            parse_recon_tile_info->alloc_sb_rows = 0;
+            EB_CREATE_MUTEX(parse_recon_tile_info->tile_sbrow_mutex);
         }
+        dec_mt_frame_data->alloc_num_tiles = alloc_num_tiles;
     }
 
-    /* LF */
-    EB_MALLOC_DEC(int32_t *,
-                  dec_mt_frame_data->lf_frame_info.sb_lf_completed_in_row,
-                  picture_height_in_sb * sizeof(int32_t),
-                  EB_N_PTR);
-
-    EB_MALLOC_DEC(uint32_t *,
-                  dec_mt_frame_data->lf_row_map,
-                  picture_height_in_sb * sizeof(uint32_t),
-                  EB_N_PTR);
-
-    DecMtRowInfo *lf_sb_row_info = &dec_mt_frame_data->lf_frame_info.lf_sb_row_info;
+    for (int32_t tiles_ctr = 0; tiles_ctr < num_tiles; tiles_ctr++) {
+        int32_t                  tile_row = tiles_ctr / tiles_info->tile_cols;
+        int32_t                  tile_col = tiles_ctr % tiles_info->tile_cols;
+        int32_t                  tile_num_sb_rows;
+        DecMtParseReconTileInfo *parse_recon_tile_info =
+            &dec_mt_frame_data->parse_recon_tile_info_array[tiles_ctr];
+        TileInfo *tile_info = &parse_recon_tile_info->tile_info;
+
+        /* init tile info */
+        svt_tile_init(tile_info, &dec_handle_ptr->frame_header, tile_row, tile_col);
+
+        tile_num_sb_rows = ((((tile_info->mi_row_end - 1) << MI_SIZE_LOG2) >>
+                             dec_handle_ptr->seq_header.sb_size_log2) -
+                            ((tile_info->mi_row_start << MI_SIZE_LOG2) >>
+                             dec_handle_ptr->seq_header.sb_size_log2) +
+                            1);
+
+        parse_recon_tile_info->tile_num_sb_rows = tile_num_sb_rows;
+
+        if (tile_num_sb_rows > parse_recon_tile_info->alloc_sb_rows) {
+            parse_recon_tile_info->alloc_sb_rows =
+                dec_grow_size(parse_recon_tile_info->alloc_sb_rows, tile_num_sb_rows);
+            EB_MALLOC_DEC(uint32_t *,
+                          parse_recon_tile_info->sb_recon_row_parsed,
+                          parse_recon_tile_info->alloc_sb_rows * sizeof(uint32_t),
+                          EB_N_PTR);
+            EB_MALLOC_DEC(uint32_t *,
+                          parse_recon_tile_info->sb_recon_completed_in_row,
+                          parse_recon_tile_info->alloc_sb_rows * sizeof(uint32_t),
+                          EB_N_PTR);
+            EB_MALLOC_DEC(uint32_t *,
+                          parse_recon_tile_info->sb_recon_row_started,
+                          parse_recon_tile_info->alloc_sb_rows * sizeof(uint32_t),
+                          EB_N_PTR);
+        }
+    }
 
-    EB_CREATE_MUTEX(lf_sb_row_info->sbrow_mutex);
-    lf_sb_row_info->num_sb_rows       = picture_height_in_sb;
-    lf_sb_row_info->sb_row_to_process = 0;
+    /* LF, CDEF and LR row maps */
+    if ((int32_t)picture_height_in_sb > dec_mt_frame_data->alloc_sb_rows) {
+        dec_mt_frame_data->alloc_sb_rows =
+            dec_grow_size(dec_mt_frame_data->alloc_sb_rows, picture_height_in_sb);
+        size_t row_map_size = dec_mt_frame_data->alloc_sb_rows * sizeof(uint32_t);
+
+        EB_MALLOC_DEC(
+            int32_t *, dec_mt_frame_data->lf_frame_info.sb_lf_completed_in_row, row_map_size, EB_N_PTR);
+        EB_MALLOC_DEC(uint32_t *, dec_mt_frame_data->lf_row_map, row_map_size, EB_N_PTR);
+        EB_MALLOC_DEC(
+            uint32_t *, dec_mt_frame_data->cdef_completed_for_row_map, row_map_size, EB_N_PTR);
+        EB_MALLOC_DEC(
+            int32_t *, dec_mt_frame_data->sb_lr_completed_in_row, row_map_size, EB_N_PTR);
+        EB_MALLOC_DEC(uint32_t *, dec_mt_frame_data->lr_row_map, row_map_size, EB_N_PTR);
+    }
+    dec_mt_frame_data->lf_frame_info.lf_sb_row_info.num_sb_rows = picture_height_in_sb;
+    dec_mt_frame_data->cdef_sb_row_info.num_sb_rows             = picture_height_in_sb;
+    dec_mt_frame_data->lr_sb_row_info.num_sb_rows               = picture_height_in_sb;
 
     /* CDEF */
-    const int32_t num_planes = av1_num_planes(&dec_handle_ptr->seq_header.color_config);
-    uint32_t      mi_cols    = 2 * ((dec_handle_ptr->seq_header.max_frame_width + 7) >> 3);
+    uint32_t mi_cols = 2 * ((dec_handle_ptr->seq_header.max_frame_width + 7) >> 3);
 
     const int32_t nhfb = (mi_cols + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
     const int32_t nvfb = (dec_handle_ptr->seq_header.max_frame_height +
@@ -279,81 +312,117 @@ EbErrorType dec_system_resource_init(EbDecHandle *dec_handle_ptr, TilesInfo *til
 
     /*ToDo: Linebuff memory we can allocate min(sb_rows , threads)*/
     /*Currently we r allocating for every (64x64 +1 )rows*/
-    EB_MALLOC_DEC(
-        uint16_t ***, dec_mt_frame_data->cdef_linebuf, (nvfb + 1) * sizeof(uint16_t **), EB_N_PTR);
-    for (int32_t sb_row = 0; sb_row < (nvfb + 1); sb_row++) {
-        uint16_t **p_linebuf;
-        EB_MALLOC_DEC(uint16_t **,
-                      dec_mt_frame_data->cdef_linebuf[sb_row],
-                      num_planes * sizeof(uint16_t **),
+    if (nvfb + 1 > dec_mt_frame_data->alloc_cdef_rows ||
+        stride > dec_mt_frame_data->alloc_cdef_stride) {
+        dec_mt_frame_data->alloc_cdef_rows =
+            dec_grow_size(dec_mt_frame_data->alloc_cdef_rows, nvfb + 1);
+        dec_mt_frame_data->alloc_cdef_stride =
+            dec_grow_size(dec_mt_frame_data->alloc_cdef_stride, stride);
+        EB_MALLOC_DEC(uint16_t ***,
+                      dec_mt_frame_data->cdef_linebuf,
+                      dec_mt_frame_data->alloc_cdef_rows * sizeof(uint16_t **),
                       EB_N_PTR);
-        p_linebuf = dec_mt_frame_data->cdef_linebuf[sb_row];
-        for (int32_t pli = 0; pli < num_planes; pli++) {
-            EB_MALLOC_DEC(
-                uint16_t *, p_linebuf[pli], sizeof(uint16_t) * CDEF_VBORDER * stride, EB_N_PTR);
+        for (int32_t sb_row = 0; sb_row < dec_mt_frame_data->alloc_cdef_rows; sb_row++) {
+            uint16_t **p_linebuf;
+            EB_MALLOC_DEC(uint16_t **,
+                          dec_mt_frame_data->cdef_linebuf[sb_row],
+                          MAX_MB_PLANE * sizeof(uint16_t **),
+                          EB_N_PTR);
+            p_linebuf = dec_mt_frame_data->cdef_linebuf[sb_row];
+            for (int32_t pli = 0; pli < MAX_MB_PLANE; pli++) {
+                EB_MALLOC_DEC(uint16_t *,
+                              p_linebuf[pli],
+                              sizeof(uint16_t) * CDEF_VBORDER *
+                                  dec_mt_frame_data->alloc_cdef_stride,
+                              EB_N_PTR);
+            }
         }
+        EB_MALLOC_DEC(uint32_t *,
+                      dec_mt_frame_data->cdef_completed_in_row,
+                      (dec_mt_frame_data->alloc_cdef_rows + 1) * sizeof(uint32_t),
+                      EB_N_PTR);
     }
+    memset(dec_mt_frame_data->cdef_completed_in_row,
+           0,
+           (nvfb + 2) * //Rem here nhbf+2 u replaced with nvfb + 2
+               sizeof(uint32_t));
 
     dec_mt_frame_data->cdef_map_stride = nhfb + 2;
     /*For fbr=0, previous row cdef points some junk memory, if we allocate memory only for nvfb 64x64 blocks,
     to avoid to pointing junck memory, we allocate nvfb+1 64x64 blocks*/
-    EB_MALLOC_DEC(uint8_t *,
-                  dec_mt_frame_data->row_cdef_map,
-                  (nvfb + 1) * dec_mt_frame_data->cdef_map_stride * sizeof(uint8_t),
-                  EB_N_PTR);
-    memset(dec_mt_frame_data->row_cdef_map,
-           1,
-           (nvfb + 1) * dec_mt_frame_data->cdef_map_stride * sizeof(uint8_t));
-
-    EB_MALLOC_DEC(uint32_t *,
-                  dec_mt_frame_data->cdef_completed_in_row,
-                  (nvfb + 2) * sizeof(uint32_t),
-                  EB_N_PTR);
+    int32_t cdef_map_size = (nvfb + 1) * dec_mt_frame_data->cdef_map_stride;
+    if (cdef_map_size > dec_mt_frame_data->alloc_cdef_map) {
+        dec_mt_frame_data->alloc_cdef_map =
+            dec_grow_size(dec_mt_frame_data->alloc_cdef_map, cdef_map_size);
+        EB_MALLOC_DEC(uint8_t *,
+                      dec_mt_frame_data->row_cdef_map,
+                      dec_mt_frame_data->alloc_cdef_map * sizeof(uint8_t),
+                      EB_N_PTR);
+    }
+    memset(dec_mt_frame_data->row_cdef_map, 1, cdef_map_size * sizeof(uint8_t));
 
-    memset(dec_mt_frame_data->cdef_completed_in_row,
-           0,
-           (nvfb + 2) * //Rem here nhbf+2 u replaced with nvfb + 2
-               sizeof(uint32_t));
+    return EB_ErrorNone;
+}
 
-    EB_MALLOC_DEC(uint32_t *,
-                  dec_mt_frame_data->cdef_completed_for_row_map,
-                  picture_height_in_sb * sizeof(uint32_t),
-                  EB_N_PTR);
+/* Creates the MT resources : called once, the worker threads
+   and the buffers are kept across the changes of frame size and
+   tile layout, see dec_mt_resize_frame_data() */
+EbErrorType dec_system_resource_init(EbDecHandle *dec_handle_ptr, TilesInfo *tiles_info) {
+    DecMtFrameData *dec_mt_frame_data =
+        &dec_handle_ptr->main_frame_buf.cur_frame_bufs[0].dec_mt_frame_data;
 
-    DecMtRowInfo *cdef_sb_row_info = &dec_mt_frame_data->cdef_sb_row_info;
+    memset(&dec_mt_frame_data->prev_frame_info, 0, sizeof(PrevFrameMtCheck));
 
-    EB_CREATE_MUTEX(cdef_sb_row_info->sbrow_mutex);
+    assert(dec_handle_ptr->dec_config.threads > 1);
+#if MT_WAIT_PROFILE
+    dec_mt_frame_data->fp = fopen("profile.txt", "w"); // stdout;
+#endif
+    /************************************
+    * System Resource Managers & Fifos
+    ************************************/
 
-    cdef_sb_row_info->num_sb_rows       = picture_height_in_sb;
-    cdef_sb_row_info->sb_row_to_process = 0;
-    /* LR */
-    EB_MALLOC_DEC(int32_t *,
-                  dec_mt_frame_data->sb_lr_completed_in_row,
-                  picture_height_in_sb * sizeof(int32_t),
-                  EB_N_PTR);
+    /* Motion Filed Projection*/
+    dec_mt_frame_data->motion_proj_info.num_motion_proj_rows = -1;
+    EB_CREATE_MUTEX(dec_mt_frame_data->motion_proj_info.motion_proj_mutex);
 
-    EB_MALLOC_DEC(uint32_t *,
-                  dec_mt_frame_data->lr_row_map,
-                  picture_height_in_sb * sizeof(uint32_t),
-                  EB_N_PTR);
+    /************************************
+    * Contexts
+    ************************************/
+    EB_CREATE_MUTEX(dec_mt_frame_data->parse_tile_info.sbrow_mutex);
+    dec_mt_frame_data->parse_tile_info.sb_row_to_process = 0;
 
-    DecMtRowInfo *lr_sb_row_info = &dec_mt_frame_data->lr_sb_row_info;
+    EB_CREATE_MUTEX(dec_mt_frame_data->recon_tile_info.sbrow_mutex);
+    dec_mt_frame_data->recon_tile_info.sb_row_to_process = 0;
 
-    EB_CREATE_MUTEX(lr_sb_row_info->sbrow_mutex);
+    EB_CREATE_MUTEX(dec_mt_frame_data->tile_switch_mutex);
 
-    lr_sb_row_info->num_sb_rows       = picture_height_in_sb;
-    lr_sb_row_info->sb_row_to_process = 0;
+    EB_CREATE_MUTEX(dec_mt_frame_data->lf_frame_info.lf_sb_row_info.sbrow_mutex);
+    dec_mt_frame_data->lf_frame_info.lf_sb_row_info.sb_row_to_process = 0;
 
-    dec_mt_frame_data->temp_mutex = svt_create_mutex();
+    EB_CREATE_MUTEX(dec_mt_frame_data->cdef_sb_row_info.sbrow_mutex);
+    dec_mt_frame_data->cdef_sb_row_info.sb_row_to_process = 0;
+
+    EB_CREATE_MUTEX(dec_mt_frame_data->lr_sb_row_info.sbrow_mutex);
+    dec_mt_frame_data->lr_sb_row_info.sb_row_to_process = 0;
 
-    dec_mt_frame_data->start_motion_proj  = EB_FALSE;
-    dec_mt_frame_data->start_parse_frame  = EB_FALSE;
-    dec_mt_frame_data->start_decode_frame = EB_FALSE;
-    dec_mt_frame_data->start_lf_frame     = EB_FALSE;
-    dec_mt_frame_data->start_cdef_frame   = EB_FALSE;
-    dec_mt_frame_data->start_lr_frame     = EB_FALSE;
-    dec_mt_frame_data->num_threads_cdefed = 0;
-    dec_mt_frame_data->num_threads_lred   = 0;
+    EB_CREATE_MUTEX(dec_mt_frame_data->temp_mutex);
+
+    dec_mt_frame_data->end_flag = EB_FALSE;
+
+    /* The workers may be blocked on these */
+    if (svt_create_cond_var(&dec_mt_frame_data->start_motion_proj) ||
+        svt_create_cond_var(&dec_mt_frame_data->start_parse_frame) ||
+        svt_create_cond_var(&dec_mt_frame_data->start_decode_frame) ||
+        svt_create_cond_var(&dec_mt_frame_data->start_lf_frame) ||
+        svt_create_cond_var(&dec_mt_frame_data->start_cdef_frame) ||
+        svt_create_cond_var(&dec_mt_frame_data->start_lr_frame) ||
+        svt_create_cond_var(&dec_mt_frame_data->motion_proj_barrier.round) ||
+        svt_create_cond_var(&dec_mt_frame_data->cdef_barrier.round) ||
+        svt_create_cond_var(&dec_mt_frame_data->lr_barrier.round))
+        return EB_ErrorInsufficientResources;
+    dec_mt_frame_data->motion_proj_barrier.num_arrived = 0;
+    dec_mt_frame_data->cdef_barrier.num_arrived        = 0;
+    dec_mt_frame_data->lr_barrier.num_arrived          = 0;
 
     /************************************
     * Thread Handles
@@ -361,55 +430,44 @@ EbErrorType dec_system_resource_init(EbDecHandle *dec_handle_ptr, TilesInfo *til
 
     /* Decode Library Threads */
     uint32_t num_lib_threads = (int32_t)dec_handle_ptr->dec_config.threads - 1;
+    if (num_lib_threads > 0) {
+        DecThreadCtxt *thread_ctxt_pa;
+        EB_MALLOC_DEC(
+            DecThreadCtxt *, thread_ctxt_pa, num_lib_threads * sizeof(DecThreadCtxt), EB_N_PTR);
+        dec_handle_ptr->thread_ctxt_pa = thread_ctxt_pa;
 
-    /* Use a scratch memory so that the memory allocated within
-       init_dec_mod_ctxt reallocated when required */
-
-    DecModCtxt **dec_mod_ctxt_arr;
-    EB_MALLOC_DEC(
-        DecModCtxt **, dec_mod_ctxt_arr, num_lib_threads * sizeof(DecModCtxt *), EB_N_PTR);
-
-    for (uint32_t i = 0; i < num_lib_threads; i++) {
-        init_dec_mod_ctxt(dec_handle_ptr, (void **)&dec_mod_ctxt_arr[i]);
-    }
-
-    memory_map_end_address = svt_dec_memory_map;
-
-    if (EB_FALSE == dec_handle_ptr->start_thread_process) {
-        dec_mt_frame_data->end_flag           = EB_FALSE;
-        dec_mt_frame_data->num_threads_exited = 0;
-
-        if (num_lib_threads > 0) {
-            DecThreadCtxt *thread_ctxt_pa;
-            EB_MALLOC_DEC(
-                DecThreadCtxt *, thread_ctxt_pa, num_lib_threads * sizeof(DecThreadCtxt), EB_N_PTR);
-            dec_handle_ptr->thread_ctxt_pa = thread_ctxt_pa;
-            EB_CREATE_SEMAPHORE(dec_handle_ptr->thread_semaphore, 0, 100000);
-
-            for (uint32_t i = 0; i < num_lib_threads; i++) {
-                thread_ctxt_pa[i].thread_cnt     = i + 1;
-                thread_ctxt_pa[i].dec_handle_ptr = dec_handle_ptr;
-                thread_ctxt_pa[i].dec_mod_ctxt   = dec_mod_ctxt_arr[i];
-                EB_CREATE_SEMAPHORE(thread_ctxt_pa[i].thread_semaphore, 0, 100000);
-                int use_highbd = (dec_handle_ptr->seq_header.color_config.bit_depth > EB_8BIT ||
-                                  dec_handle_ptr->is_16bit_pipeline);
-                EB_MALLOC_DEC(uint8_t *,
-                              thread_ctxt_pa[i].dst,
-                              (MAX_SB_SIZE + 8) * RESTORATION_PROC_UNIT_SIZE * sizeof(uint8_t)
-                                  << use_highbd,
-                              EB_N_PTR);
-            }
-            EB_CREATE_THREAD_ARRAY(dec_handle_ptr->decode_thread_handle_array,
-                                   num_lib_threads,
-                                   dec_all_stage_kernel,
-                                   (void **)&thread_ctxt_pa);
-        }
-    } else {
         for (uint32_t i = 0; i < num_lib_threads; i++) {
-            dec_handle_ptr->thread_ctxt_pa[i].dec_mod_ctxt = dec_mod_ctxt_arr[i];
+            thread_ctxt_pa[i].thread_cnt     = i + 1;
+            thread_ctxt_pa[i].dec_handle_ptr = dec_handle_ptr;
+            thread_ctxt_pa[i].dec_mod_ctxt   = NULL;
+            int use_highbd = (dec_handle_ptr->seq_header.color_config.bit_depth > EB_8BIT ||
+                              dec_handle_ptr->is_16bit_pipeline);
+            EB_MALLOC_DEC(uint8_t *,
+                          thread_ctxt_pa[i].dst,
+                          (MAX_SB_SIZE + 8) * RESTORATION_PROC_UNIT_SIZE * sizeof(uint8_t)
+                              << use_highbd,
+                          EB_N_PTR);
         }
     }
-    free(dec_mod_ctxt_arr);
+
+    /* Nothing allocated yet */
+    dec_mt_frame_data->alloc_sb_size       = BLOCK_INVALID;
+    dec_mt_frame_data->alloc_num_tiles     = 0;
+    dec_mt_frame_data->alloc_recon_row_map = 0;
+    dec_mt_frame_data->alloc_sb_rows       = 0;
+    dec_mt_frame_data->alloc_cdef_rows     = 0;
+    dec_mt_frame_data->alloc_cdef_stride   = 0;
+    dec_mt_frame_data->alloc_cdef_map      = 0;
+
+    EbErrorType return_error = dec_mt_resize_frame_data(dec_handle_ptr, tiles_info);
+    if (return_error != EB_ErrorNone)
+        return return_error;
+
+    if (num_lib_threads > 0)
+        EB_CREATE_THREAD_ARRAY(dec_handle_ptr->decode_thread_handle_array,
+                               num_lib_threads,
+                               dec_all_stage_kernel,
+                               (void **)&dec_handle_ptr->thread_ctxt_pa);
     return return_error;
 }
 
@@ -477,16 +535,15 @@ EbErrorType parse_tile_job(EbDecHandle *dec_handle_ptr, int32_t tile_num) {
 void parse_frame_tiles(EbDecHandle *dec_handle_ptr, DecThreadCtxt *thread_ctxt) {
     DecMtFrameData *dec_mt_frame_data =
         &dec_handle_ptr->main_frame_buf.cur_frame_bufs[0].dec_mt_frame_data;
-    volatile EbBool *start_parse_frame = &dec_mt_frame_data->start_parse_frame;
+    CondVar *start_parse_frame = &dec_mt_frame_data->start_parse_frame;
 #if MT_WAIT_PROFILE
     FILE *            fp = dec_mt_frame_data->fp;
     struct EbDecTimer timer;
     int               th_cnt = NULL == thread_ctxt ? 0 : thread_ctxt->thread_cnt;
     dec_timer_start(&timer);
 #endif
-    while (*start_parse_frame != EB_TRUE)
-        svt_block_on_semaphore(NULL == thread_ctxt ? dec_handle_ptr->thread_semaphore
-                                                   : thread_ctxt->thread_semaphore);
+    (void)thread_ctxt;
+    dec_mt_wait_stage(start_parse_frame);
 
 #if MT_WAIT_PROFILE
     dec_display_timer("SPF", &timer, th_cnt, fp);
@@ -497,16 +554,11 @@ void parse_frame_tiles(EbDecHandle *dec_handle_ptr, DecThreadCtxt *thread_ctxt)
 #endif
         int32_t tile_num = get_sb_row_to_process(&dec_mt_frame_data->parse_tile_info);
         if (-1 != tile_num) {
-            dec_mt_frame_data->start_decode_frame = EB_TRUE;
             if (EB_ErrorNone != parse_tile_job(dec_handle_ptr, tile_num)) {
                 SVT_LOG("\nParse Issue for Tile %d", tile_num);
                 break;
             }
-            svt_post_semaphore(dec_handle_ptr->thread_semaphore);
-            for (uint32_t lib_thrd = 0; lib_thrd < dec_handle_ptr->dec_config.threads - 1;
-                 lib_thrd++) {
-                svt_post_semaphore(dec_handle_ptr->thread_ctxt_pa[lib_thrd].thread_semaphore);
-            }
+            dec_mt_start_stage(&dec_mt_frame_data->start_decode_frame);
         } else
             break;
     }
@@ -521,16 +573,14 @@ EbErrorType decode_tile_job(EbDecHandle *dec_handle_ptr, int32_t tile_num,
 void decode_frame_tiles(EbDecHandle *dec_handle_ptr, DecThreadCtxt *thread_ctxt) {
     DecMtFrameData *dec_mt_frame_data =
         &dec_handle_ptr->main_frame_buf.cur_frame_bufs[0].dec_mt_frame_data;
-    volatile EbBool *start_decode_frame = &dec_mt_frame_data->start_decode_frame;
+    CondVar *start_decode_frame = &dec_mt_frame_data->start_decode_frame;
 #if MT_WAIT_PROFILE
     FILE *            fp = dec_mt_frame_data->fp;
     struct EbDecTimer timer;
     int               th_cnt = NULL == thread_ctxt ? 0 : thread_ctxt->thread_cnt;
     dec_timer_start(&timer);
 #endif
-    while (*start_decode_frame != EB_TRUE)
-        svt_block_on_semaphore(NULL == thread_ctxt ? dec_handle_ptr->thread_semaphore
-                                                   : thread_ctxt->thread_semaphore);
+    dec_mt_wait_stage(start_decode_frame);
 
 #if MT_WAIT_PROFILE
     dec_display_timer("SDF", &timer, th_cnt, fp);
@@ -763,16 +813,15 @@ void dec_av1_loop_filter_frame_mt(EbDecHandle *dec_handle, EbPictureBufferDesc *
     DecMtFrameData *dec_mt_frame_data1 =
         &dec_handle->main_frame_buf.cur_frame_bufs[0].dec_mt_frame_data;
 
-    volatile EbBool *start_lf_frame = &dec_mt_frame_data1->start_lf_frame;
+    CondVar *start_lf_frame = &dec_mt_frame_data1->start_lf_frame;
 #if MT_WAIT_PROFILE
     FILE *            fp = dec_mt_frame_data1->fp;
     struct EbDecTimer timer;
     int               th_cnt = NULL == thread_ctxt ? 0 : thread_ctxt->thread_cnt;
     dec_timer_start(&timer);
 #endif
-    while (*start_lf_frame != EB_TRUE)
-        svt_block_on_semaphore(NULL == thread_ctxt ? dec_handle->thread_semaphore
-                                                   : thread_ctxt->thread_semaphore);
+    (void)thread_ctxt;
+    dec_mt_wait_stage(start_lf_frame);
 #if MT_WAIT_PROFILE
     dec_display_timer("SLF", &timer, th_cnt, fp);
 #endif
@@ -915,16 +964,15 @@ void svt_cdef_frame_mt(EbDecHandle *dec_handle_ptr, DecThreadCtxt *thread_ctxt)
     int32_t         curr_recon_stride[MAX_MB_PLANE];
     DecMtFrameData *dec_mt_frame_data1 =
         &dec_handle_ptr->main_frame_buf.cur_frame_bufs[0].dec_mt_frame_data;
-    volatile EbBool *start_cdef_frame = &dec_mt_frame_data1->start_cdef_frame;
+    CondVar *start_cdef_frame = &dec_mt_frame_data1->start_cdef_frame;
 #if MT_WAIT_PROFILE
     FILE *            fp = dec_mt_frame_data1->fp;
     struct EbDecTimer timer;
     int               th_cnt = NULL == thread_ctxt ? 0 : thread_ctxt->thread_cnt;
     dec_timer_start(&timer);
 #endif
-    while (*start_cdef_frame != EB_TRUE)
-        svt_block_on_semaphore(NULL == thread_ctxt ? dec_handle_ptr->thread_semaphore
-                                                   : thread_ctxt->thread_semaphore);
+    (void)thread_ctxt;
+    dec_mt_wait_stage(start_cdef_frame);
 
 #if MT_WAIT_PROFILE
     dec_display_timer("SCF", &timer, th_cnt, fp);
@@ -1055,13 +1103,11 @@ void svt_cdef_frame_mt(EbDecHandle *dec_handle_ptr, DecThreadCtxt *thread_ctxt)
     } else
         for (int32_t pli = 0; pli < num_planes; pli++) { svt_aom_free(colbuf[pli]); }
 
-    svt_block_on_mutex(dec_mt_frame_data->temp_mutex);
-    dec_mt_frame_data->num_threads_cdefed++;
-    svt_release_mutex(dec_mt_frame_data->temp_mutex);
     if (do_upscale) {
-        volatile uint32_t *num_threads_cdefed = &dec_mt_frame_data->num_threads_cdefed;
-        while (*num_threads_cdefed != dec_handle_ptr->dec_config.threads)
-            ;
+        dec_mt_barrier(dec_mt_frame_data,
+                       &dec_mt_frame_data->cdef_barrier,
+                       dec_handle_ptr->dec_config.threads,
+                       NULL);
     }
 }
 
@@ -1161,10 +1207,8 @@ void dec_av1_loop_restoration_filter_frame_mt(EbDecHandle *dec_handle, DecThread
 
     DecMtFrameData *dec_mt_frame_data =
         &dec_handle->main_frame_buf.cur_frame_bufs[0].dec_mt_frame_data;
-    volatile EbBool *start_lr_frame = &dec_mt_frame_data->start_lr_frame;
-    while (*start_lr_frame != EB_TRUE)
-        svt_block_on_semaphore(NULL == thread_ctxt ? dec_handle->thread_semaphore
-                                                   : thread_ctxt->thread_semaphore);
+    CondVar *start_lr_frame = &dec_mt_frame_data->start_lr_frame;
+    dec_mt_wait_stage(start_lr_frame);
 
     EbPictureBufferDesc *recon_picture_ptr = dec_handle->cur_pic_buf[0]->ps_pic_buf;
     const int32_t        num_planes        = av1_num_planes(&dec_handle->seq_header.color_config);
@@ -1293,22 +1337,10 @@ void dec_av1_loop_restoration_filter_frame_mt(EbDecHandle *dec_handle, DecThread
             break;
     }
 
-    svt_block_on_mutex(dec_mt_frame_data->temp_mutex);
-    dec_mt_frame_data->num_threads_lred++;
-    if (dec_handle->dec_config.threads == dec_mt_frame_data->num_threads_lred) {
-        dec_mt_frame_data->start_motion_proj  = EB_FALSE;
-        dec_mt_frame_data->start_parse_frame  = EB_FALSE;
-        dec_mt_frame_data->start_decode_frame = EB_FALSE;
-        dec_mt_frame_data->start_lf_frame     = EB_FALSE;
-        dec_mt_frame_data->start_cdef_frame   = EB_FALSE;
-        dec_mt_frame_data->start_lr_frame     = EB_FALSE;
-    }
-    svt_release_mutex(dec_mt_frame_data->temp_mutex);
-
-    volatile uint32_t *num_threads_lred = &dec_mt_frame_data->num_threads_lred;
-    while (*num_threads_lred != dec_handle->dec_config.threads &&
-           EB_FALSE == dec_mt_frame_data->end_flag)
-        ;
+    dec_mt_barrier(dec_mt_frame_data,
+                   &dec_mt_frame_data->lr_barrier,
+                   dec_handle->dec_config.threads,
+                   dec_mt_close_all_stages);
 }
 
 void *dec_all_stage_kernel(void *input_ptr) {
@@ -1317,9 +1349,6 @@ void *dec_all_stage_kernel(void *input_ptr) {
     EbDecHandle *   dec_handle_ptr = thread_ctxt->dec_handle_ptr;
     DecMtFrameData *dec_mt_frame_data =
         &dec_handle_ptr->main_frame_buf.cur_frame_bufs[0].dec_mt_frame_data;
-    volatile EbBool *start_thread = (volatile EbBool *)&dec_handle_ptr->start_thread_process;
-    while (*start_thread == EB_FALSE)
-        ;
 
     while (1) {
         /* Motion Field Projection */
@@ -1340,65 +1369,28 @@ void *dec_all_stage_kernel(void *input_ptr) {
         /*Frame LR */
         dec_av1_loop_restoration_filter_frame_mt(dec_handle_ptr, thread_ctxt);
 
-        if (EB_TRUE == dec_mt_frame_data->end_flag) {
-            svt_block_on_mutex(dec_mt_frame_data->temp_mutex);
-            dec_mt_frame_data->num_threads_exited++;
-            svt_release_mutex(dec_mt_frame_data->temp_mutex);
+        if (EB_TRUE == dec_mt_frame_data->end_flag)
             break;
-        }
     }
     return NULL;
 }
 
-static void svt_av1_sleep(const int milliseconds) {
-    if (!milliseconds)
-        return;
-#ifdef _WIN32
-    Sleep(milliseconds);
-#else
-    nanosleep(&(struct timespec){milliseconds / 1000, (milliseconds % 1000) * 1000000}, NULL);
-#endif
-}
-
 void dec_sync_all_threads(EbDecHandle *dec_handle_ptr) {
     DecMtFrameData *dec_mt_frame_data =
         &dec_handle_ptr->main_frame_buf.cur_frame_bufs[0].dec_mt_frame_data;
     dec_mt_frame_data->end_flag = EB_TRUE;
 
-    /* To make all worker exit except main thread! */
-    dec_mt_frame_data->num_threads_cdefed = 1;
-    dec_mt_frame_data->num_threads_lred   = 1;
-
-    /* To make all worker exit except main thread! */
-    dec_mt_frame_data->num_threads_header          = 1;
+    /* Run the workers through the stages to their exit point. The
+       barriers are skipped once end_flag is set. */
     dec_handle_ptr->frame_header.use_ref_frame_mvs = 0;
-    dec_mt_frame_data->start_motion_proj           = EB_TRUE;
-
-    dec_mt_frame_data->start_parse_frame = EB_TRUE;
-    svt_post_semaphore(dec_handle_ptr->thread_semaphore);
-    for (uint32_t lib_thrd = 0; lib_thrd < dec_handle_ptr->dec_config.threads - 1; lib_thrd++)
-        svt_post_semaphore(dec_handle_ptr->thread_ctxt_pa[lib_thrd].thread_semaphore);
-    dec_mt_frame_data->start_decode_frame = EB_TRUE;
-    svt_post_semaphore(dec_handle_ptr->thread_semaphore);
-    for (uint32_t lib_thrd = 0; lib_thrd < dec_handle_ptr->dec_config.threads - 1; lib_thrd++)
-        svt_post_semaphore(dec_handle_ptr->thread_ctxt_pa[lib_thrd].thread_semaphore);
-    dec_mt_frame_data->start_lf_frame = EB_TRUE;
-    svt_post_semaphore(dec_handle_ptr->thread_semaphore);
-    for (uint32_t lib_thrd = 0; lib_thrd < dec_handle_ptr->dec_config.threads - 1; lib_thrd++)
-        svt_post_semaphore(dec_handle_ptr->thread_ctxt_pa[lib_thrd].thread_semaphore);
-    dec_mt_frame_data->start_cdef_frame = EB_TRUE;
-    svt_post_semaphore(dec_handle_ptr->thread_semaphore);
-    for (uint32_t lib_thrd = 0; lib_thrd < dec_handle_ptr->dec_config.threads - 1; lib_thrd++)
-        svt_post_semaphore(dec_handle_ptr->thread_ctxt_pa[lib_thrd].thread_semaphore);
-    dec_mt_frame_data->start_lr_frame = EB_TRUE;
-    svt_post_semaphore(dec_handle_ptr->thread_semaphore);
-    for (uint32_t lib_thrd = 0; lib_thrd < dec_handle_ptr->dec_config.threads - 1; lib_thrd++)
-        svt_post_semaphore(dec_handle_ptr->thread_ctxt_pa[lib_thrd].thread_semaphore);
-
-    while (dec_mt_frame_data->num_threads_exited != dec_handle_ptr->dec_config.threads - 1)
-        svt_av1_sleep(5);
-
-    /*Destroying lib created thread's*/
+    dec_mt_start_stage(&dec_mt_frame_data->start_motion_proj);
+    dec_mt_start_stage(&dec_mt_frame_data->start_parse_frame);
+    dec_mt_start_stage(&dec_mt_frame_data->start_decode_frame);
+    dec_mt_start_stage(&dec_mt_frame_data->start_lf_frame);
+    dec_mt_start_stage(&dec_mt_frame_data->start_cdef_frame);
+    dec_mt_start_stage(&dec_mt_frame_data->start_lr_frame);
+
+    /*Destroying lib created thread's, waits for them to exit*/
     EB_DESTROY_THREAD_ARRAY(dec_handle_ptr->decode_thread_handle_array,
                             dec_handle_ptr->dec_config.threads - 1);
 }
@@ -17,6 +17,7 @@ extern "C" {
 #endif
 #include "EbDefinitions.h"
 #include "EbSystemResourceManager.h"
+#include "EbThreads.h"
 
 #define MT_WAIT_PROFILE 0
 
@@ -124,6 +125,9 @@ typedef struct DecMtParseReconTileInfo {
     /* SB row state context */
     int32_t sb_row_to_process;
 
+    /* Number of SB rows the arrays above are allocated for */
+    int32_t alloc_sb_rows;
+
 } DecMtParseReconTileInfo;
 
 typedef struct DecMtRowInfo {
@@ -167,18 +171,27 @@ typedef struct PrevFrameMtCheck {
     TilesInfo prev_tiles_info;
 } PrevFrameMtCheck;
 
+/* Frame level barrier of all the decoder threads */
+typedef struct DecMtBarrier {
+    /* Threads arrived in the current round, protected by temp_mutex */
+    uint32_t num_arrived;
+    /* Round count, bumped by the last thread to release the others */
+    CondVar round;
+} DecMtBarrier;
+
 /* MT State information for each frame in parallel */
 typedef struct DecMTFrameData {
-    uint32_t num_threads_cdefed; /*Should be Removed after PAD MT*/
-    uint32_t num_threads_lred; /*Should be Removed after PAD MT*/
-    uint32_t num_threads_exited;
-    EbBool   end_flag;
-    EbBool   start_motion_proj;
-    EbBool   start_parse_frame;
-    EbBool   start_decode_frame;
-    EbBool   start_lf_frame;
-    EbBool   start_cdef_frame;
-    EbBool   start_lr_frame;
+    DecMtBarrier cdef_barrier; /*Should be Removed after PAD MT*/
+    DecMtBarrier lr_barrier; /*Should be Removed after PAD MT*/
+    EbBool       end_flag;
+    /* Stage gates, opened by the main thread (EB_TRUE) and closed by
+       the last thread out of the frame */
+    CondVar start_motion_proj;
+    CondVar start_parse_frame;
+    CondVar start_decode_frame;
+    CondVar start_lf_frame;
+    CondVar start_cdef_frame;
+    CondVar start_lr_frame;
 
     EbHandle temp_mutex;
 
@@ -186,7 +199,7 @@ typedef struct DecMTFrameData {
 
     /* Motion Field Projection Info*/
     DecMtMotionProjInfo motion_proj_info;
-    uint32_t            num_threads_header; /*ToDo : should remove */
+    DecMtBarrier        motion_proj_barrier; /*ToDo : should remove */
 
     DecMtRowInfo parse_tile_info;
     DecMtRowInfo recon_tile_info;
@@ -241,11 +254,26 @@ typedef struct DecMTFrameData {
     int32_t sb_cols;
     int32_t sb_rows;
 
+    /* Sizes the buffers above are allocated for. They only grow, see
+       dec_mt_resize_frame_data() */
+    BlockSize alloc_sb_size;
+    int32_t   alloc_num_tiles;
+    int32_t   alloc_recon_row_map;
+    int32_t   alloc_sb_rows;
+    int32_t   alloc_cdef_rows;
+    int32_t   alloc_cdef_stride;
+    int32_t   alloc_cdef_map;
+
 #if MT_WAIT_PROFILE
     FILE *fp;
 #endif
 } DecMtFrameData;
 
+void dec_mt_start_stage(CondVar *stage);
+void dec_mt_wait_stage(CondVar *stage);
+void dec_mt_barrier(DecMtFrameData *dec_mt_frame_data, DecMtBarrier *barrier, uint32_t num_threads,
+                    void (*last_fn)(DecMtFrameData *));
+
 #ifdef __cplusplus
 }
 #endif
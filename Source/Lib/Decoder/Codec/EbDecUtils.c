@@ -21,6 +21,7 @@
 #include "EbMcp.h"
 #include "EbDecBlock.h"
 #include "EbDecMemInit.h"
+#include "EbDecPicMgr.h"
 
 EbErrorType check_add_tplmv_buf(EbDecHandle *dec_handle_ptr) {
     FrameHeader * ps_frm_hdr = &dec_handle_ptr->frame_header;
@@ -305,7 +306,12 @@ void pad_pic(EbDecHandle *dec_handle_ptr) {
                 sx,
                 sy,
                 flags);
+
+        /* Frame parallel : the rows are final once padded, the filters
+           of the whole frame are done at this point */
+        dec_pic_signal_rows(dec_handle_ptr->cur_pic_buf[0], row + row_height);
     }
+    dec_pic_signal_rows(dec_handle_ptr->cur_pic_buf[0], DEC_PIC_ALL_ROWS);
 }
 
 int inverse_recenter(int r, int v) {
@@ -78,6 +78,7 @@ int         get_qindex(SegmentationParams *seg_params, int segment_id, int base_
 void        svt_setup_motion_field(EbDecHandle *dec_handle, DecThreadCtxt *thread_ctxt);
 EbErrorType decode_multiple_obu(EbDecHandle *dec_handle_ptr, uint8_t **data, size_t data_size,
                                 uint32_t is_annexb);
+EbErrorType decode_deferred_frame(EbDecHandle *dec_handle_ptr);
 
 static INLINE int allow_intrabc(const EbDecHandle *dec_handle) {
     return (dec_handle->frame_header.frame_type == KEY_FRAME ||
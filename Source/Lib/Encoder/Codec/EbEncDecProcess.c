@@ -25,6 +25,8 @@
 #include "EbPictureDecisionProcess.h"
 #include "firstpass.h"
 #include "EbPictureAnalysisProcess.h"
+#include "EbPipelineStats.h"
+#include "EbTime.h"
 
 #define FC_SKIP_TX_SR_TH025 125 // Fast cost skip tx search threshold.
 #define FC_SKIP_TX_SR_TH010 110 // Fast cost skip tx search threshold.
@@ -9243,13 +9245,13 @@ static void recode_loop_decision_maker(PictureControlSet *pcs_ptr,
         ppcs_ptr->loop_count++;
 
         frm_hdr->quantization_params.base_q_idx = (uint8_t)CLIP3(
-                (int32_t)quantizer_to_qindex[scs_ptr->static_config.min_qp_allowed],
-                (int32_t)quantizer_to_qindex[scs_ptr->static_config.max_qp_allowed],
+                (int32_t)quantizer_to_qindex[ppcs_ptr->rc_min_qp_allowed],
+                (int32_t)quantizer_to_qindex[ppcs_ptr->rc_max_qp_allowed],
                 q);
 
         ppcs_ptr->picture_qp =
-            (uint8_t)CLIP3((int32_t)scs_ptr->static_config.min_qp_allowed,
-                    (int32_t)scs_ptr->static_config.max_qp_allowed,
+            (uint8_t)CLIP3((int32_t)ppcs_ptr->rc_min_qp_allowed,
+                    (int32_t)ppcs_ptr->rc_max_qp_allowed,
                     (frm_hdr->quantization_params.base_q_idx + 2) >> 2);
         pcs_ptr->picture_qp = ppcs_ptr->picture_qp;
 
@@ -9357,6 +9359,9 @@ void *mode_decision_kernel(void *input_ptr) {
         EncDecTasks *    enc_dec_tasks_ptr    = (EncDecTasks *)enc_dec_tasks_wrapper_ptr->object_ptr;
         PictureControlSet * pcs_ptr           = (PictureControlSet *)enc_dec_tasks_ptr->pcs_wrapper_ptr->object_ptr;
         SequenceControlSet *scs_ptr           = (SequenceControlSet *)pcs_ptr->scs_wrapper_ptr->object_ptr;
+        pipeline_stage_begin(
+            pcs_ptr->parent_pcs_ptr, SVT_AV1_STAGE_ENC_DEC, enc_dec_tasks_ptr->tile_group_index);
+        const uint64_t work_start_ns = svt_av1_get_time_ns();
 
         context_ptr->tile_group_index = enc_dec_tasks_ptr->tile_group_index;
         context_ptr->coded_sb_count   = 0;
@@ -9762,6 +9767,10 @@ void *mode_decision_kernel(void *input_ptr) {
                 pcs_ptr->txt_cnt[depth_delta][txs_idx] += context_ptr->md_context->txt_cnt[depth_delta][txs_idx];
 #endif
         pcs_ptr->enc_dec_coded_sb_count += (uint32_t)context_ptr->coded_sb_count;
+        // Work of the segment, for the cost model of the speed control
+        if (scs_ptr->static_config.speed_control_flag)
+            svt_atomic_fetch_add_u64(&pcs_ptr->parent_pcs_ptr->speed_control_work_ns,
+                                     svt_av1_get_time_ns() - work_start_ns);
         EbBool last_sb_flag = (pcs_ptr->sb_total_count_pix == pcs_ptr->enc_dec_coded_sb_count);
         svt_release_mutex(pcs_ptr->intra_mutex);
 
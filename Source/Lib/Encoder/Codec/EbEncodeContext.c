@@ -55,11 +55,15 @@ static void destroy_stats_buffer(STATS_BUFFER_CTX *stats_buf_context,
 static void encode_context_dctor(EbPtr p) {
     EncodeContext *obj = (EncodeContext *)p;
     EB_DESTROY_MUTEX(obj->total_number_of_recon_frame_mutex);
+    EB_DESTROY_MUTEX(obj->picture_timing_mutex);
+    EB_DELETE(obj->tracer_ptr);
+    EB_DELETE(obj->packet_buffer_pool);
 #if !CLN_OLD_RC
     EB_DESTROY_MUTEX(obj->hl_rate_control_historgram_queue_mutex);
     EB_DESTROY_MUTEX(obj->rate_table_update_mutex);
 #endif
-    EB_DESTROY_MUTEX(obj->sc_buffer_mutex);
+    EB_DESTROY_MUTEX(obj->speed_control_mutex);
+    EB_DESTROY_MUTEX(obj->param_update_mutex);
     EB_DESTROY_MUTEX(obj->shared_reference_mutex);
     EB_DESTROY_MUTEX(obj->stat_file_mutex);
     EB_DELETE(obj->prediction_structure_group_ptr);
@@ -97,6 +101,8 @@ EbErrorType encode_context_ctor(EncodeContext *encode_context_ptr, EbPtr object_
     CHECK_REPORT_ERROR(1, encode_context_ptr->app_callback_ptr, EB_ENC_EC_ERROR29);
 
     EB_CREATE_MUTEX(encode_context_ptr->total_number_of_recon_frame_mutex);
+    EB_CREATE_MUTEX(encode_context_ptr->picture_timing_mutex);
+    EB_NEW(encode_context_ptr->packet_buffer_pool, svt_packet_buffer_pool_ctor);
     EB_ALLOC_PTR_ARRAY(encode_context_ptr->picture_decision_reorder_queue,
                        PICTURE_DECISION_REORDER_QUEUE_MAX_DEPTH);
 
@@ -189,8 +195,9 @@ EbErrorType encode_context_ctor(EncodeContext *encode_context_ptr, EbPtr object_
     EB_CREATE_MUTEX(encode_context_ptr->rate_table_update_mutex);
 #endif
 
-    EB_CREATE_MUTEX(encode_context_ptr->sc_buffer_mutex);
-    encode_context_ptr->enc_mode                      = SPEED_CONTROL_INIT_MOD;
+    EB_CREATE_MUTEX(encode_context_ptr->speed_control_mutex);
+    encode_context_ptr->speed_control.work_scale      = 1.0;
+    EB_CREATE_MUTEX(encode_context_ptr->param_update_mutex);
     encode_context_ptr->previous_selected_ref_qp      = 32;
     encode_context_ptr->max_coded_poc_selected_ref_qp = 32;
     encode_context_ptr->recode_tolerance              = 25;
@@ -204,3 +211,160 @@ EbErrorType encode_context_ctor(EncodeContext *encode_context_ptr, EbPtr object_
                         *num_lap_buffers);
     return EB_ErrorNone;
 }
+
+void encode_context_reset(EncodeContext *encode_context_ptr) {
+    uint32_t picture_index;
+
+    encode_context_ptr->total_number_of_recon_frames  = 0;
+    encode_context_ptr->total_number_of_output_frames = 0;
+
+    for (picture_index = 0; picture_index < PICTURE_DECISION_REORDER_QUEUE_MAX_DEPTH;
+         ++picture_index) {
+        PictureDecisionReorderEntry *entry_ptr =
+            encode_context_ptr->picture_decision_reorder_queue[picture_index];
+        entry_ptr->picture_number         = picture_index;
+        entry_ptr->parent_pcs_wrapper_ptr = NULL;
+    }
+    encode_context_ptr->picture_decision_reorder_queue_head_index = 0;
+    encode_context_ptr->picture_decision_undisplayed_queue_count  = 0;
+
+    encode_context_ptr->pre_assignment_buffer_intra_count        = 0;
+    encode_context_ptr->pre_assignment_buffer_idr_count          = 0;
+    encode_context_ptr->pre_assignment_buffer_scene_change_count = 0;
+    encode_context_ptr->pre_assignment_buffer_scene_change_index = 0;
+    encode_context_ptr->pre_assignment_buffer_eos_flag           = EB_FALSE;
+    encode_context_ptr->decode_base_number                       = 0;
+    encode_context_ptr->pre_assignment_buffer_count              = 0;
+
+    // The PA references of the last pictures keep their nominal live_count
+    // when the sequence ends before their dependents come
+    for (picture_index = 0; picture_index < PICTURE_DECISION_PA_REFERENCE_QUEUE_MAX_DEPTH;
+         ++picture_index) {
+        PaReferenceQueueEntry *entry_ptr =
+            encode_context_ptr->picture_decision_pa_reference_queue[picture_index];
+        if (entry_ptr->input_object_ptr)
+            svt_release_object(entry_ptr->input_object_ptr);
+        entry_ptr->input_object_ptr = NULL;
+        entry_ptr->picture_number   = 0;
+        entry_ptr->dependent_count  = 0;
+        entry_ptr->list0.list_count = 0;
+        entry_ptr->list1.list_count = 0;
+    }
+    encode_context_ptr->picture_decision_pa_reference_queue_head_index = 0;
+    encode_context_ptr->picture_decision_pa_reference_queue_tail_index = 0;
+
+    for (picture_index = 0; picture_index < INPUT_QUEUE_MAX_DEPTH; ++picture_index)
+        encode_context_ptr->input_picture_queue[picture_index]->input_object_ptr = NULL;
+    encode_context_ptr->input_picture_queue_head_index = 0;
+    encode_context_ptr->input_picture_queue_tail_index = 0;
+
+    // Same for the references in the picture manager
+    for (picture_index = 0; picture_index < REFERENCE_QUEUE_MAX_DEPTH; ++picture_index) {
+        ReferenceQueueEntry *entry_ptr = encode_context_ptr->reference_picture_queue[picture_index];
+        if (entry_ptr->reference_object_ptr)
+            svt_release_object(entry_ptr->reference_object_ptr);
+        entry_ptr->picture_number            = ~0u;
+        entry_ptr->reference_object_ptr      = NULL;
+        entry_ptr->ref_wraper                = NULL;
+        entry_ptr->dependent_count           = 0;
+        entry_ptr->release_enable            = EB_FALSE;
+        entry_ptr->reference_available       = EB_FALSE;
+        entry_ptr->list0.list_count          = 0;
+        entry_ptr->list1.list_count          = 0;
+        entry_ptr->is_used_as_reference_flag = EB_FALSE;
+        entry_ptr->feedback_arrived          = EB_FALSE;
+
+        encode_context_ptr->dep_cnt_picture_queue[picture_index]->pic_num = ~0u;
+        encode_context_ptr->dep_cnt_picture_queue[picture_index]->is_done = 1;
+    }
+    encode_context_ptr->reference_picture_queue_head_index = 0;
+    encode_context_ptr->reference_picture_queue_tail_index = 0;
+    encode_context_ptr->dep_q_head = encode_context_ptr->dep_q_tail = 0;
+
+    for (picture_index = 0; picture_index < INITIAL_RATE_CONTROL_REORDER_QUEUE_MAX_DEPTH;
+         ++picture_index) {
+        InitialRateControlReorderEntry *entry_ptr =
+            encode_context_ptr->initial_rate_control_reorder_queue[picture_index];
+        entry_ptr->picture_number         = picture_index;
+        entry_ptr->parent_pcs_wrapper_ptr = NULL;
+    }
+    encode_context_ptr->initial_rate_control_reorder_queue_head_index = 0;
+
+    for (picture_index = 0; picture_index < PACKETIZATION_REORDER_QUEUE_MAX_DEPTH;
+         ++picture_index) {
+        PacketizationReorderEntry *entry_ptr =
+            encode_context_ptr->packetization_reorder_queue[picture_index];
+        entry_ptr->picture_number            = picture_index;
+        entry_ptr->output_stream_wrapper_ptr = NULL;
+    }
+    encode_context_ptr->packetization_reorder_queue_head_index = 0;
+
+    // GOP Counters
+    encode_context_ptr->intra_period_position = 0;
+    encode_context_ptr->pred_struct_position  = 0;
+    encode_context_ptr->elapsed_non_idr_count = 0;
+    encode_context_ptr->elapsed_non_cra_count = 0;
+    encode_context_ptr->initial_picture       = EB_TRUE;
+    encode_context_ptr->last_idr_picture      = 0;
+
+    encode_context_ptr->terminating_picture_number         = ~0u;
+    encode_context_ptr->terminating_sequence_flag_received = EB_FALSE;
+    encode_context_ptr->td_needed                          = EB_TRUE;
+
+    // The measured cost of the presets holds for the next stream, the
+    // frame rate is measured again
+    SpeedControl *sc = &encode_context_ptr->speed_control;
+    sc->update_ns = sc->out_ns = 0;
+    sc->frames_in = sc->frames_out = sc->update_frames_out = 0;
+    sc->min_in_flight = 0;
+    sc->output_fps    = 0;
+    sc->base_preset   = 0;
+    sc->work_scale    = 1.0;
+    memset(sc->credit_us, 0, sizeof(sc->credit_us));
+
+    encode_context_ptr->param_update_count = 0;
+    memset(&encode_context_ptr->param_update_pending, 0, sizeof(SvtAv1EncUpdate));
+    memset(&encode_context_ptr->rc_update, 0, sizeof(SvtAv1EncUpdate));
+    encode_context_ptr->rc_update_count   = 0;
+    encode_context_ptr->rc_update_applied = 0;
+
+    encode_context_ptr->previous_selected_ref_qp      = 32;
+    encode_context_ptr->max_coded_poc                 = 0;
+    encode_context_ptr->max_coded_poc_selected_ref_qp = 32;
+
+    encode_context_ptr->previous_mini_gop_hierarchical_levels   = 0;
+    encode_context_ptr->previous_picture_control_set_wrapper_ptr = NULL;
+    encode_context_ptr->picture_number_alt                       = 0;
+
+    memset(encode_context_ptr->dpb_list, 0, sizeof(encode_context_ptr->dpb_list));
+    encode_context_ptr->display_picture_number                  = 0;
+    encode_context_ptr->is_mini_gop_changed                     = EB_FALSE;
+    encode_context_ptr->is_i_slice_in_last_mini_gop             = EB_FALSE;
+    encode_context_ptr->i_slice_picture_number_in_last_mini_gop = 0;
+    memset(encode_context_ptr->poc_map_idx, 0, sizeof(encode_context_ptr->poc_map_idx));
+
+    // Rate control, set again from the configuration by the first picture
+    memset(&encode_context_ptr->frame_info, 0, sizeof(FrameInfo));
+    memset(&encode_context_ptr->two_pass_cfg, 0, sizeof(TwoPassCfg));
+    memset(&encode_context_ptr->rc, 0, sizeof(RATE_CONTROL));
+    memset(&encode_context_ptr->rc_cfg, 0, sizeof(RateControlCfg));
+    memset(&encode_context_ptr->gf_group, 0, sizeof(GF_GROUP));
+    memset(&encode_context_ptr->kf_cfg, 0, sizeof(KeyFrameCfg));
+    memset(&encode_context_ptr->gf_cfg, 0, sizeof(GFConfig));
+    encode_context_ptr->recode_loop      = DISALLOW_RECODE;
+    encode_context_ptr->recode_tolerance = 25;
+
+    STATS_BUFFER_CTX *stats_buf_context = &encode_context_ptr->stats_buf_context;
+    stats_buf_context->stats_in_start   = encode_context_ptr->frame_stats_buffer;
+#if FTR_VBR_MT
+    stats_buf_context->stats_in_end_write = stats_buf_context->stats_in_start;
+#endif
+    stats_buf_context->stats_in_end = stats_buf_context->stats_in_start;
+    svt_av1_twopass_zero_stats(stats_buf_context->total_left_stats);
+    svt_av1_twopass_zero_stats(stats_buf_context->total_stats);
+    // With the look ahead, the first picture points the stats buffer to the
+    // stats out when it allocates them
+    EB_FREE(encode_context_ptr->stats_out.stat);
+    encode_context_ptr->stats_out.size       = 0;
+    encode_context_ptr->stats_out.capability = 0;
+}
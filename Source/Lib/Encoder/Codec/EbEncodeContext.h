@@ -29,6 +29,8 @@
 #include "EbRateControlTables.h"
 #endif
 #include "EbObject.h"
+#include "EbTrace.h"
+#include "EbPacketBufferPool.h"
 #include "encoder.h"
 #include "firstpass.h"
 
@@ -77,6 +79,29 @@ typedef struct FirstPassStatsOut {
     size_t           capability;
 } FirstPassStatsOut;
 
+/* Presets the speed control picks from, ENC_MRS to MAX_ENC_PRESET */
+#define SPEED_CONTROL_PRESETS (MAX_ENC_PRESET - ENC_MRS + 1)
+/* Classes of pictures with their own cost: the temporal layers, then intra */
+#define SPEED_CONTROL_CLASSES (MAX_TEMPORAL_LAYERS + 1)
+
+/* State of the real-time speed control, protected by speed_control_mutex */
+typedef struct SpeedControl {
+    uint64_t update_ns; // When the last picture out before the last update came out
+    uint64_t out_ns; // When the last picture came out
+    uint64_t frames_in; // Pictures given a preset
+    uint64_t frames_out; // Pictures packetized
+    uint64_t update_frames_out; // frames_out at the last update
+    uint64_t min_in_flight; // Fewest pictures between preset pick and output seen
+    double   output_fps; // Smoothed output frame rate, 0 until measured
+    EbEncMode base_preset; // Preset of the last base layer picture
+    // Work allowed per picture, relative to the cost of the configured preset
+    double work_scale;
+    // Work the previous pictures of the class left unspent (or overspent)
+    double credit_us[SPEED_CONTROL_CLASSES];
+    // Smoothed measured cost of a picture per preset and class, 0 until measured
+    double cost_us[SPEED_CONTROL_PRESETS][SPEED_CONTROL_CLASSES];
+} SpeedControl;
+
 typedef struct EncodeContext {
     EbDctor dctor;
     // Callback Functions
@@ -84,11 +109,27 @@ typedef struct EncodeContext {
 
     EbHandle total_number_of_recon_frame_mutex;
     uint64_t total_number_of_recon_frames;
+    // Low delay: packets posted by packetization, also protected by
+    // total_number_of_recon_frame_mutex since the end of sequence may come after them
+    uint64_t total_number_of_output_frames;
+
+    // Pipeline telemetry: stage timestamps of the last pictures out of
+    // packetization, picture_timing is a ring of picture_timing_count
+    // entries ending before picture_timing_head
+    EbHandle            picture_timing_mutex;
+    uint64_t            pipeline_start_ns;
+    uint32_t            picture_timing_head;
+    uint32_t            picture_timing_count;
+    SvtAv1PictureTiming picture_timing[SVT_AV1_PICTURE_TIMING_HISTORY];
+    // Stage events for static_config.trace_file, NULL when not tracing
+    EbTracer *tracer_ptr;
 
     // Overlay input picture fifo
     EbFifo *overlay_input_picture_pool_fifo_ptr;
     // Output Buffer Fifos
     EbFifo *stream_output_fifo_ptr;
+    // Backs the p_buffer of the output stream buffers
+    EbPacketBufferPool *packet_buffer_pool;
     EbFifo *recon_output_fifo_ptr;
 
     // Picture Buffer Fifos
@@ -173,11 +214,24 @@ typedef struct EncodeContext {
 #endif
 
     // Speed Control
-    int64_t   sc_buffer;
-    int64_t   sc_frame_in;
-    int64_t   sc_frame_out;
-    EbHandle  sc_buffer_mutex;
-    EbEncMode enc_mode;
+    SpeedControl speed_control;
+    EbHandle     speed_control_mutex;
+
+    // Runtime parameter updates, queued by svt_av1_enc_update_parameters in
+    // picture number order, protected by param_update_mutex
+    EbHandle        param_update_mutex;
+    SvtAv1EncUpdate param_update_queue[SVT_AV1_MAX_PENDING_UPDATES];
+    uint32_t        param_update_count;
+    // Picture decision: updates due inside the current mini-gop, for the next one
+    SvtAv1EncUpdate param_update_pending;
+    // Picture decision: the rate control fields updated so far, stamped on
+    // the pictures with the count of updates
+    SvtAv1EncUpdate rc_update;
+    uint64_t        rc_update_count;
+    // Rate control: the update count its parameters are set for
+    uint64_t rc_update_applied;
+    // Preset in effect: static_config.enc_mode until updated, atomic
+    volatile uint32_t enc_mode;
 
     // Rate Control
     uint32_t previous_selected_ref_qp;
@@ -229,4 +283,7 @@ typedef struct EncodeContextInitData {
  **************************************/
 extern EbErrorType encode_context_ctor(EncodeContext *encode_context_ptr,
                                        EbPtr          object_init_data_ptr);
+/* Back to the state of the constructor for a new sequence, releasing the
+ * references still queued. The pipeline must be idle. */
+extern void encode_context_reset(EncodeContext *encode_context_ptr);
 #endif // EbEncodeContext_h
@@ -4345,13 +4345,36 @@ EbErrorType write_frame_header_av1(Bitstream *bitstream_ptr, SequenceControlSet
     curr_data_size += write_tile_group_header(
         data + curr_data_size, 0, 0, n_log2_tiles, tile_start_and_end_present_flag);
 
+    const uint32_t headers_size = curr_data_size - obu_header_size;
+    uint32_t       tiles_size   = 0;
+    if (!show_existing) {
+        for (int tile_idx = 0; tile_idx < tile_cnt; tile_idx++) {
+            tiles_size += pcs_ptr->entropy_coding_info[tile_idx]->entropy_coder_ptr->ec_writer.pos;
+            if (tile_idx != tile_cnt - 1 && tile_cnt > 1)
+                tiles_size += pcs_ptr->tile_size_bytes_minus_1 + 1;
+        }
+    }
+    // Only the headers move to make room for the size field, the tiles are
+    // copied once, after it
+    const uint32_t obu_payload_size  = headers_size + tiles_size;
+    const size_t   length_field_size = svt_aom_uleb_size_in_bytes(obu_payload_size);
+    // The unit is sized by the caller, a frame it cannot hold is not written
+    if ((size_t)(data - output_bitstream_ptr->buffer_begin_av1) + curr_data_size +
+            length_field_size + tiles_size >
+        output_bitstream_ptr->size)
+        return EB_ErrorInsufficientResources;
+    memmove(data + obu_header_size + length_field_size, data + obu_header_size, headers_size);
+    if (write_uleb_obu_size(obu_header_size, obu_payload_size, data) != AOM_CODEC_OK) {
+        assert(0);
+    }
+    curr_data_size += (int32_t)length_field_size;
+
     if (!show_existing) {
         // Add data from EC stream to Picture Stream.
         for (int tile_idx = 0; tile_idx < tile_cnt; tile_idx++) {
             const int32_t tile_size =
                 pcs_ptr->entropy_coding_info[tile_idx]->entropy_coder_ptr->ec_writer.pos;
             uint8_t tile_size_bytes = 0;
-            //tile_size += (tile_idx != tile_cnt - 1) ? 4 : 0;
             if (tile_idx != tile_cnt - 1 && tile_cnt > 1) {
                 tile_size_bytes = pcs_ptr->tile_size_bytes_minus_1 + 1;
                 mem_put_varsize(data + curr_data_size, tile_size_bytes, tile_size - 1);
@@ -4365,12 +4388,6 @@ EbErrorType write_frame_header_av1(Bitstream *bitstream_ptr, SequenceControlSet
             curr_data_size += (tile_size + tile_size_bytes);
         }
     }
-    const uint32_t obu_payload_size  = curr_data_size - obu_header_size;
-    const size_t   length_field_size = obu_mem_move(obu_header_size, obu_payload_size, data);
-    if (write_uleb_obu_size(obu_header_size, obu_payload_size, data) != AOM_CODEC_OK) {
-        assert(0);
-    }
-    curr_data_size += (int32_t)length_field_size;
     data += curr_data_size;
 
     output_bitstream_ptr->buffer_av1 = data;
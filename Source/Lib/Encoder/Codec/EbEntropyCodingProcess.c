@@ -20,6 +20,7 @@
 #include "EbCabacContextModel.h"
 #include "EbLog.h"
 #include "common_dsp_rtcd.h"
+#include "EbPipelineStats.h"
 #define AV1_MIN_TILE_SIZE_BYTES 1
 void svt_av1_reset_loop_restoration(PictureControlSet *piCSetPtr, uint16_t tile_idx);
 
@@ -348,6 +349,8 @@ void *entropy_coding_kernel(void *input_ptr) {
         PictureControlSet *pcs_ptr          = (PictureControlSet *)
                                          rest_results_ptr->pcs_wrapper_ptr->object_ptr;
         SequenceControlSet *scs_ptr = (SequenceControlSet *)pcs_ptr->scs_wrapper_ptr->object_ptr;
+        pipeline_stage_begin(
+            pcs_ptr->parent_pcs_ptr, SVT_AV1_STAGE_ENTROPY_CODING, rest_results_ptr->tile_index);
         // SB Constants
 
         uint8_t sb_sz = (uint8_t)scs_ptr->sb_size_pix;
@@ -20,6 +20,7 @@
 #include "EbReferenceObject.h"
 #include "EbResize.h"
 #include "common_dsp_rtcd.h"
+#include "EbPipelineStats.h"
 #if FTR_LAD_MG
 #include "EbLog.h"
 #include "EbPictureDecisionProcess.h"
@@ -101,6 +102,22 @@ EbErrorType initial_rate_control_context_ctor(EbThreadContext *  thread_context_
     return EB_ErrorNone;
 }
 
+/************************************************
+* Initial Rate Control Reset
+*  Empties the lookahead queue for a new sequence
+************************************************/
+static void initial_rate_control_reset(EbThreadContext *thread_context_ptr) {
+#if FTR_LAD_MG
+    InitialRateControlContext *context_ptr = (InitialRateControlContext *)thread_context_ptr->priv;
+    for (uint32_t picture_index = 0; picture_index < REFERENCE_QUEUE_MAX_DEPTH; ++picture_index)
+        context_ptr->lad_queue->cir_buf[picture_index]->pcs = NULL;
+    context_ptr->lad_queue->head = 0;
+    context_ptr->lad_queue->tail = 0;
+#else
+    (void)thread_context_ptr;
+#endif
+}
+
 /************************************************
 * Update BEA Information Based on Lookahead
 ** Average zzCost of Collocated SB throughout lookahead frames
@@ -781,11 +798,19 @@ void *initial_rate_control_kernel(void *input_ptr) {
         // Get Input Full Object
         EB_GET_FULL_OBJECT(context_ptr->motion_estimation_results_input_fifo_ptr,
                            &in_results_wrapper_ptr);
+        // Reset request of svt_av1_enc_reset, the pipeline is idle
+        if (in_results_wrapper_ptr->signal_semaphore) {
+            initial_rate_control_reset(thread_context_ptr);
+            svt_release_signal_object(in_results_wrapper_ptr);
+            continue;
+        }
 
         MotionEstimationResults *in_results_ptr = (MotionEstimationResults *)
                                                       in_results_wrapper_ptr->object_ptr;
         PictureParentControlSet *pcs_ptr = (PictureParentControlSet *)
                                                in_results_ptr->pcs_wrapper_ptr->object_ptr;
+        pipeline_stage_begin(
+            pcs_ptr, SVT_AV1_STAGE_INITIAL_RATE_CONTROL, in_results_ptr->segment_index);
 
         // Set the segment counter
 #if FTR_TPL_TR
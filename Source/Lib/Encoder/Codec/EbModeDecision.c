@@ -5614,10 +5614,17 @@ void intra_bc_search(PictureControlSet *pcs, ModeDecisionContext *context_ptr,
     x->errorperbit = full_lambda >> RD_EPB_SHIFT;
     x->errorperbit += (x->errorperbit == 0);
     //temp buffer for hash me
+    const EbArenaMark hash_mark = svt_arena_mark(context_ptr->scratch_arena);
     for (int xi = 0; xi < 2; xi++)
         for (int yj = 0; yj < 2; yj++)
-            x->hash_value_buffer[xi][yj] =
-                (uint32_t *)malloc(AOM_BUFFER_SIZE_FOR_BLOCK_HASH * sizeof(uint32_t));
+            x->hash_value_buffer[xi][yj] = (uint32_t *)svt_arena_alloc(
+                context_ptr->scratch_arena, AOM_BUFFER_SIZE_FOR_BLOCK_HASH * sizeof(uint32_t));
+    if (!x->hash_value_buffer[0][0] || !x->hash_value_buffer[0][1] ||
+        !x->hash_value_buffer[1][0] || !x->hash_value_buffer[1][1]) {
+        // Out of memory: no DV candidate
+        svt_arena_rewind(context_ptr->scratch_arena, hash_mark);
+        return;
+    }
 
     IntMv nearestmv, nearmv;
     svt_av1_find_best_ref_mvs_from_stack(
@@ -5734,8 +5741,7 @@ void intra_bc_search(PictureControlSet *pcs, ModeDecisionContext *context_ptr,
         (*num_dv_cand)++;
     }
 
-    for (int i = 0; i < 2; i++)
-        for (int j = 0; j < 2; j++) free(x->hash_value_buffer[i][j]);
+    svt_arena_rewind(context_ptr->scratch_arena, hash_mark);
 }
 void svt_init_mv_cost_params(MV_COST_PARAMS *mv_cost_params,
     ModeDecisionContext *context_ptr,
@@ -26,6 +26,7 @@
 #include "EbCoefficients.h"
 #include "EbCommonUtils.h"
 #include "EbResize.h"
+#include "EbPipelineStats.h"
 
 int32_t get_qzbin_factor(int32_t q, AomBitDepth bit_depth);
 void    invert_quant(int16_t *quant, int16_t *shift, int32_t d);
@@ -1063,6 +1064,7 @@ void *mode_decision_configuration_kernel(void *input_ptr) {
         PictureControlSet *pcs_ptr = (PictureControlSet *)
                                          rate_control_results_ptr->pcs_wrapper_ptr->object_ptr;
         SequenceControlSet *scs_ptr = (SequenceControlSet *)pcs_ptr->scs_wrapper_ptr->object_ptr;
+        pipeline_stage_begin(pcs_ptr->parent_pcs_ptr, SVT_AV1_STAGE_MODE_DECISION_CONFIGURATION, 0);
 
         // -------
         // Scale references if resolution of the reference is different than the input
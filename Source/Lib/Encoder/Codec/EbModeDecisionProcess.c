@@ -46,11 +46,18 @@ static void mode_decision_context_dctor(EbPtr p) {
         EB_DELETE(obj->md_blk_arr_nsq[coded_leaf_index].coeff_tmp);
     }
 #endif
+    // The candidate buffers are carved from scratch_arena, only their pictures are deleted
+    if (obj->candidate_buffer_ptr_array) {
 #if CLN_MD_CAND_BUFF
-    EB_DELETE_PTR_ARRAY(obj->candidate_buffer_ptr_array, obj->max_nics_uv);
+        for (uint32_t buffer_index = 0; buffer_index < obj->max_nics_uv; ++buffer_index) {
 #else
-    EB_DELETE_PTR_ARRAY(obj->candidate_buffer_ptr_array, MAX_NFL_BUFF);
+        for (uint32_t buffer_index = 0; buffer_index < MAX_NFL_BUFF; ++buffer_index) {
 #endif
+            ModeDecisionCandidateBuffer *buffer_ptr = obj->candidate_buffer_ptr_array[buffer_index];
+            if (buffer_ptr && buffer_ptr->dctor)
+                buffer_ptr->dctor(buffer_ptr);
+        }
+    }
     EB_FREE_ARRAY(obj->candidate_buffer_tx_depth_1->candidate_ptr);
     EB_DELETE(obj->candidate_buffer_tx_depth_1);
     EB_FREE_ARRAY(obj->candidate_buffer_tx_depth_2->candidate_ptr);
@@ -62,10 +69,6 @@ static void mode_decision_context_dctor(EbPtr p) {
         EB_FREE_ARRAY(obj->md_rate_estimation_ptr);
     EB_FREE_ARRAY(obj->fast_candidate_array);
     EB_FREE_ARRAY(obj->fast_candidate_ptr_array);
-    EB_FREE_ARRAY(obj->fast_cost_array);
-    EB_FREE_ARRAY(obj->full_cost_array);
-    EB_FREE_ARRAY(obj->full_cost_skip_ptr);
-    EB_FREE_ARRAY(obj->full_cost_merge_ptr);
     if (obj->md_local_blk_unit) {
         EB_FREE_ARRAY(obj->md_local_blk_unit[0].neigh_left_recon_16bit[0]);
         EB_FREE_ARRAY(obj->md_local_blk_unit[0].neigh_top_recon_16bit[0]);
@@ -93,6 +96,7 @@ static void mode_decision_context_dctor(EbPtr p) {
 
     EB_DELETE(obj->temp_residual_ptr);
     EB_DELETE(obj->temp_recon_ptr);
+    EB_DELETE(obj->scratch_arena);
 }
 #if CLN_MD_CAND_BUFF
 
@@ -100,6 +104,142 @@ static void mode_decision_context_dctor(EbPtr p) {
 uint8_t  get_nic_scaling_level(PdPass pd_pass, EbEncMode enc_mode ,uint8_t temporal_layer_index );
 
 #endif
+/******************************************************
+ * Mode Decision Scratch Buffers
+ *  Allocated in use order, the planes of each candidate
+ *  buffer are adjacent
+ ******************************************************/
+static EbErrorType mode_decision_scratch_ctor(ModeDecisionContext *context_ptr, uint8_t sb_size) {
+    uint32_t buffer_index;
+
+    // Transform and Quantization Buffers
+    EB_NEW(context_ptr->trans_quant_buffers_ptr, svt_trans_quant_buffers_ctor, sb_size);
+
+    EbPictureBufferDescInitData thirty_two_width_picture_buffer_desc_init_data;
+    EbPictureBufferDescInitData picture_buffer_desc_init_data;
+
+    picture_buffer_desc_init_data.max_width  = sb_size;
+    picture_buffer_desc_init_data.max_height = sb_size;
+    picture_buffer_desc_init_data.bit_depth  = context_ptr->hbd_mode_decision ? EB_10BIT : EB_8BIT;
+    picture_buffer_desc_init_data.color_format       = EB_YUV420;
+    picture_buffer_desc_init_data.buffer_enable_mask = PICTURE_BUFFER_DESC_FULL_MASK;
+    picture_buffer_desc_init_data.left_padding       = 0;
+    picture_buffer_desc_init_data.right_padding      = 0;
+    picture_buffer_desc_init_data.top_padding        = 0;
+    picture_buffer_desc_init_data.bot_padding        = 0;
+    picture_buffer_desc_init_data.split_mode         = EB_FALSE;
+
+    thirty_two_width_picture_buffer_desc_init_data.max_width    = sb_size;
+    thirty_two_width_picture_buffer_desc_init_data.max_height   = sb_size;
+    thirty_two_width_picture_buffer_desc_init_data.bit_depth    = EB_32BIT;
+    thirty_two_width_picture_buffer_desc_init_data.color_format = EB_YUV420;
+    thirty_two_width_picture_buffer_desc_init_data.buffer_enable_mask =
+        PICTURE_BUFFER_DESC_FULL_MASK;
+    thirty_two_width_picture_buffer_desc_init_data.left_padding  = 0;
+    thirty_two_width_picture_buffer_desc_init_data.right_padding = 0;
+    thirty_two_width_picture_buffer_desc_init_data.top_padding   = 0;
+    thirty_two_width_picture_buffer_desc_init_data.bot_padding   = 0;
+    thirty_two_width_picture_buffer_desc_init_data.split_mode    = EB_FALSE;
+
+    for (uint32_t txt_itr = 0; txt_itr < TX_TYPES; ++txt_itr) {
+        EB_NEW(context_ptr->recon_coeff_ptr[txt_itr],
+               svt_picture_buffer_desc_ctor,
+               (EbPtr)&thirty_two_width_picture_buffer_desc_init_data);
+        EB_NEW(context_ptr->recon_ptr[txt_itr],
+               svt_picture_buffer_desc_ctor,
+               (EbPtr)&picture_buffer_desc_init_data);
+    }
+    EB_NEW(context_ptr->residual_quant_coeff_ptr,
+           svt_picture_buffer_desc_ctor,
+           (EbPtr)&thirty_two_width_picture_buffer_desc_init_data);
+
+    EB_NEW(context_ptr->cfl_temp_prediction_ptr,
+           svt_picture_buffer_desc_ctor,
+           (EbPtr)&picture_buffer_desc_init_data);
+
+    EbPictureBufferDescInitData double_width_picture_buffer_desc_init_data;
+    double_width_picture_buffer_desc_init_data.max_width          = sb_size;
+    double_width_picture_buffer_desc_init_data.max_height         = sb_size;
+    double_width_picture_buffer_desc_init_data.bit_depth          = EB_16BIT;
+    double_width_picture_buffer_desc_init_data.color_format       = EB_YUV420;
+    double_width_picture_buffer_desc_init_data.buffer_enable_mask = PICTURE_BUFFER_DESC_FULL_MASK;
+    double_width_picture_buffer_desc_init_data.left_padding       = 0;
+    double_width_picture_buffer_desc_init_data.right_padding      = 0;
+    double_width_picture_buffer_desc_init_data.top_padding        = 0;
+    double_width_picture_buffer_desc_init_data.bot_padding        = 0;
+    double_width_picture_buffer_desc_init_data.split_mode         = EB_FALSE;
+
+    // The temp_recon_ptr and temp_residual_ptr will be shared by all candidates
+    // If you want to do something with residual or recon, you need to create one
+    EB_NEW(context_ptr->temp_recon_ptr,
+           svt_picture_buffer_desc_ctor,
+           (EbPtr)&picture_buffer_desc_init_data);
+    EB_NEW(context_ptr->temp_residual_ptr,
+           svt_picture_buffer_desc_ctor,
+           (EbPtr)&double_width_picture_buffer_desc_init_data);
+
+    // Candidate Buffers
+    EB_NEW(context_ptr->candidate_buffer_tx_depth_1,
+           mode_decision_scratch_candidate_buffer_ctor,
+           sb_size,
+           context_ptr->hbd_mode_decision ? EB_10BIT : EB_8BIT);
+
+    EB_ALLOC_PTR_ARRAY(context_ptr->candidate_buffer_tx_depth_1->candidate_ptr, 1);
+    EB_NEW(context_ptr->candidate_buffer_tx_depth_2,
+           mode_decision_scratch_candidate_buffer_ctor,
+           sb_size,
+           context_ptr->hbd_mode_decision ? EB_10BIT : EB_8BIT);
+
+    EB_ALLOC_PTR_ARRAY(context_ptr->candidate_buffer_tx_depth_2->candidate_ptr, 1);
+#if CLN_MD_CAND_BUFF
+    const uint32_t cand_buff_count   = context_ptr->max_nics_uv;
+    const uint32_t cand_buff_count_y = context_ptr->max_nics;
+#else
+    const uint32_t cand_buff_count   = MAX_NFL_BUFF;
+    const uint32_t cand_buff_count_y = MAX_NFL_BUFF_Y;
+#endif
+    EbArena *const arena = context_ptr->scratch_arena;
+
+    // Cost Arrays
+    context_ptr->fast_cost_array     = svt_arena_alloc(arena, cand_buff_count * sizeof(uint64_t));
+    context_ptr->full_cost_array     = svt_arena_alloc(arena, cand_buff_count * sizeof(uint64_t));
+    context_ptr->full_cost_skip_ptr  = svt_arena_alloc(arena, cand_buff_count * sizeof(uint64_t));
+    context_ptr->full_cost_merge_ptr = svt_arena_alloc(arena, cand_buff_count * sizeof(uint64_t));
+    context_ptr->candidate_buffer_ptr_array = svt_arena_alloc(
+        arena, cand_buff_count * sizeof(*context_ptr->candidate_buffer_ptr_array));
+    if (!context_ptr->fast_cost_array || !context_ptr->full_cost_array ||
+        !context_ptr->full_cost_skip_ptr || !context_ptr->full_cost_merge_ptr ||
+        !context_ptr->candidate_buffer_ptr_array)
+        return EB_ErrorInsufficientResources;
+    memset(context_ptr->candidate_buffer_ptr_array,
+           0,
+           cand_buff_count * sizeof(*context_ptr->candidate_buffer_ptr_array));
+
+    // Each candidate buffer is followed by its planes; the first cand_buff_count_y have luma
+    for (buffer_index = 0; buffer_index < cand_buff_count; ++buffer_index) {
+        ModeDecisionCandidateBuffer *buffer_ptr = svt_arena_alloc(arena, sizeof(*buffer_ptr));
+        if (!buffer_ptr)
+            return EB_ErrorInsufficientResources;
+        memset(buffer_ptr, 0, sizeof(*buffer_ptr));
+        context_ptr->candidate_buffer_ptr_array[buffer_index] = buffer_ptr;
+        const EbErrorType err = mode_decision_candidate_buffer_ctor(
+            buffer_ptr,
+            context_ptr->hbd_mode_decision ? EB_10BIT : EB_8BIT,
+            sb_size,
+            buffer_index < cand_buff_count_y ? PICTURE_BUFFER_DESC_FULL_MASK
+                                             : PICTURE_BUFFER_DESC_CHROMA_MASK,
+            context_ptr->temp_residual_ptr,
+            context_ptr->temp_recon_ptr,
+            &(context_ptr->fast_cost_array[buffer_index]),
+            &(context_ptr->full_cost_array[buffer_index]),
+            &(context_ptr->full_cost_skip_ptr[buffer_index]),
+            &(context_ptr->full_cost_merge_ptr[buffer_index]));
+        if (err != EB_ErrorNone)
+            return err;
+    }
+    return EB_ErrorNone;
+}
+
 /******************************************************
  * Mode Decision Context Constructor
  ******************************************************/
@@ -111,7 +251,6 @@ EbErrorType mode_decision_context_ctor(ModeDecisionContext *context_ptr, EbColor
                                        EbFifo *mode_decision_configuration_input_fifo_ptr,
                                        EbFifo *mode_decision_output_fifo_ptr,
                                        uint8_t enable_hbd_mode_decision, uint8_t cfg_palette) {
-    uint32_t buffer_index;
     uint32_t cand_index;
     uint32_t block_max_count_sb = (sb_size == MAX_SB_SIZE) ? BLOCK_MAX_COUNT_SB_128
                                                            : BLOCK_MAX_COUNT_SB_64;
@@ -119,6 +258,7 @@ EbErrorType mode_decision_context_ctor(ModeDecisionContext *context_ptr, EbColor
     (void)color_format;
 
     context_ptr->dctor             = mode_decision_context_dctor;
+    svt_mem_set_tag(SVT_AV1_MEM_TAG_MD);
     context_ptr->hbd_mode_decision = enable_hbd_mode_decision;
 
     // Input/Output System Resource Manager FIFOs
@@ -190,35 +330,6 @@ EbErrorType mode_decision_context_ctor(ModeDecisionContext *context_ptr, EbColor
             EB_MALLOC_ARRAY(context_ptr->palette_cand_array[cd].color_idx_map, MAX_PALETTE_SQUARE);
         else
             context_ptr->palette_cand_array[cd].color_idx_map = NULL;
-    // Transform and Quantization Buffers
-    EB_NEW(context_ptr->trans_quant_buffers_ptr, svt_trans_quant_buffers_ctor, sb_size);
-
-    // Cost Arrays
-#if CLN_MD_CAND_BUFF
-    EB_MALLOC_ARRAY(context_ptr->fast_cost_array,  context_ptr->max_nics_uv);
-    EB_MALLOC_ARRAY(context_ptr->full_cost_array,  context_ptr->max_nics_uv);
-    EB_MALLOC_ARRAY(context_ptr->full_cost_skip_ptr,  context_ptr->max_nics_uv);
-    EB_MALLOC_ARRAY(context_ptr->full_cost_merge_ptr,  context_ptr->max_nics_uv);
-
-#else
-    EB_MALLOC_ARRAY(context_ptr->fast_cost_array, MAX_NFL_BUFF);
-    EB_MALLOC_ARRAY(context_ptr->full_cost_array, MAX_NFL_BUFF);
-    EB_MALLOC_ARRAY(context_ptr->full_cost_skip_ptr, MAX_NFL_BUFF);
-    EB_MALLOC_ARRAY(context_ptr->full_cost_merge_ptr, MAX_NFL_BUFF);
-#endif
-    // Candidate Buffers
-    EB_NEW(context_ptr->candidate_buffer_tx_depth_1,
-           mode_decision_scratch_candidate_buffer_ctor,
-           sb_size,
-           context_ptr->hbd_mode_decision ? EB_10BIT : EB_8BIT);
-
-    EB_ALLOC_PTR_ARRAY(context_ptr->candidate_buffer_tx_depth_1->candidate_ptr, 1);
-    EB_NEW(context_ptr->candidate_buffer_tx_depth_2,
-           mode_decision_scratch_candidate_buffer_ctor,
-           sb_size,
-           context_ptr->hbd_mode_decision ? EB_10BIT : EB_8BIT);
-
-    EB_ALLOC_PTR_ARRAY(context_ptr->candidate_buffer_tx_depth_2->candidate_ptr, 1);
     context_ptr->md_local_blk_unit[0].neigh_left_recon[0]       = NULL;
     context_ptr->md_local_blk_unit[0].neigh_top_recon[0]        = NULL;
     context_ptr->md_local_blk_unit[0].neigh_left_recon_16bit[0] = NULL;
@@ -319,109 +430,12 @@ EbErrorType mode_decision_context_ctor(ModeDecisionContext *context_ptr, EbColor
     EB_MALLOC_ARRAY(context_ptr->ref_best_ref_sq_table, MAX_REF_TYPE_CAND);
     EB_MALLOC_ARRAY(context_ptr->above_txfm_context, (sb_size >> MI_SIZE_LOG2));
     EB_MALLOC_ARRAY(context_ptr->left_txfm_context, (sb_size >> MI_SIZE_LOG2));
-    EbPictureBufferDescInitData thirty_two_width_picture_buffer_desc_init_data;
-    EbPictureBufferDescInitData picture_buffer_desc_init_data;
-
-    picture_buffer_desc_init_data.max_width  = sb_size;
-    picture_buffer_desc_init_data.max_height = sb_size;
-    picture_buffer_desc_init_data.bit_depth  = context_ptr->hbd_mode_decision ? EB_10BIT : EB_8BIT;
-    picture_buffer_desc_init_data.color_format       = EB_YUV420;
-    picture_buffer_desc_init_data.buffer_enable_mask = PICTURE_BUFFER_DESC_FULL_MASK;
-    picture_buffer_desc_init_data.left_padding       = 0;
-    picture_buffer_desc_init_data.right_padding      = 0;
-    picture_buffer_desc_init_data.top_padding        = 0;
-    picture_buffer_desc_init_data.bot_padding        = 0;
-    picture_buffer_desc_init_data.split_mode         = EB_FALSE;
-
-    thirty_two_width_picture_buffer_desc_init_data.max_width    = sb_size;
-    thirty_two_width_picture_buffer_desc_init_data.max_height   = sb_size;
-    thirty_two_width_picture_buffer_desc_init_data.bit_depth    = EB_32BIT;
-    thirty_two_width_picture_buffer_desc_init_data.color_format = EB_YUV420;
-    thirty_two_width_picture_buffer_desc_init_data.buffer_enable_mask =
-        PICTURE_BUFFER_DESC_FULL_MASK;
-    thirty_two_width_picture_buffer_desc_init_data.left_padding  = 0;
-    thirty_two_width_picture_buffer_desc_init_data.right_padding = 0;
-    thirty_two_width_picture_buffer_desc_init_data.top_padding   = 0;
-    thirty_two_width_picture_buffer_desc_init_data.bot_padding   = 0;
-    thirty_two_width_picture_buffer_desc_init_data.split_mode    = EB_FALSE;
-
-    for (uint32_t txt_itr = 0; txt_itr < TX_TYPES; ++txt_itr) {
-        EB_NEW(context_ptr->recon_coeff_ptr[txt_itr],
-               svt_picture_buffer_desc_ctor,
-               (EbPtr)&thirty_two_width_picture_buffer_desc_init_data);
-        EB_NEW(context_ptr->recon_ptr[txt_itr],
-               svt_picture_buffer_desc_ctor,
-               (EbPtr)&picture_buffer_desc_init_data);
-    }
-    EB_NEW(context_ptr->residual_quant_coeff_ptr,
-           svt_picture_buffer_desc_ctor,
-           (EbPtr)&thirty_two_width_picture_buffer_desc_init_data);
-
-    EB_NEW(context_ptr->cfl_temp_prediction_ptr,
-           svt_picture_buffer_desc_ctor,
-           (EbPtr)&picture_buffer_desc_init_data);
-
-    EbPictureBufferDescInitData double_width_picture_buffer_desc_init_data;
-    double_width_picture_buffer_desc_init_data.max_width          = sb_size;
-    double_width_picture_buffer_desc_init_data.max_height         = sb_size;
-    double_width_picture_buffer_desc_init_data.bit_depth          = EB_16BIT;
-    double_width_picture_buffer_desc_init_data.color_format       = EB_YUV420;
-    double_width_picture_buffer_desc_init_data.buffer_enable_mask = PICTURE_BUFFER_DESC_FULL_MASK;
-    double_width_picture_buffer_desc_init_data.left_padding       = 0;
-    double_width_picture_buffer_desc_init_data.right_padding      = 0;
-    double_width_picture_buffer_desc_init_data.top_padding        = 0;
-    double_width_picture_buffer_desc_init_data.bot_padding        = 0;
-    double_width_picture_buffer_desc_init_data.split_mode         = EB_FALSE;
-
-    // The temp_recon_ptr and temp_residual_ptr will be shared by all candidates
-    // If you want to do something with residual or recon, you need to create one
-    EB_NEW(context_ptr->temp_recon_ptr,
-           svt_picture_buffer_desc_ctor,
-           (EbPtr)&picture_buffer_desc_init_data);
-    EB_NEW(context_ptr->temp_residual_ptr,
-           svt_picture_buffer_desc_ctor,
-           (EbPtr)&double_width_picture_buffer_desc_init_data);
-
-    // Candidate Buffers
-#if CLN_MD_CAND_BUFF
-    EB_ALLOC_PTR_ARRAY(context_ptr->candidate_buffer_ptr_array, context_ptr->max_nics_uv);
-
-    for (buffer_index = 0; buffer_index <  context_ptr->max_nics; ++buffer_index) {
-#else
-    EB_ALLOC_PTR_ARRAY(context_ptr->candidate_buffer_ptr_array, MAX_NFL_BUFF);
-    for (buffer_index = 0; buffer_index < MAX_NFL_BUFF_Y; ++buffer_index) {
-#endif
-        EB_NEW(context_ptr->candidate_buffer_ptr_array[buffer_index],
-               mode_decision_candidate_buffer_ctor,
-               context_ptr->hbd_mode_decision ? EB_10BIT : EB_8BIT,
-               sb_size,
-               PICTURE_BUFFER_DESC_FULL_MASK,
-               context_ptr->temp_residual_ptr,
-               context_ptr->temp_recon_ptr,
-               &(context_ptr->fast_cost_array[buffer_index]),
-               &(context_ptr->full_cost_array[buffer_index]),
-               &(context_ptr->full_cost_skip_ptr[buffer_index]),
-               &(context_ptr->full_cost_merge_ptr[buffer_index]));
-    }
-
-#if CLN_MD_CAND_BUFF
-    for (buffer_index = max_nics; buffer_index <  context_ptr->max_nics_uv; ++buffer_index) {
-#else
-    for (buffer_index = MAX_NFL_BUFF_Y; buffer_index < MAX_NFL_BUFF; ++buffer_index) {
-#endif
-        EB_NEW(context_ptr->candidate_buffer_ptr_array[buffer_index],
-               mode_decision_candidate_buffer_ctor,
-               context_ptr->hbd_mode_decision ? EB_10BIT : EB_8BIT,
-               sb_size,
-               PICTURE_BUFFER_DESC_CHROMA_MASK,
-               context_ptr->temp_residual_ptr,
-               context_ptr->temp_recon_ptr,
-               &(context_ptr->fast_cost_array[buffer_index]),
-               &(context_ptr->full_cost_array[buffer_index]),
-               &(context_ptr->full_cost_skip_ptr[buffer_index]),
-               &(context_ptr->full_cost_merge_ptr[buffer_index]));
-    }
-    return EB_ErrorNone;
+    // Scratch buffers, carved from the arena of the context
+    EB_NEW(context_ptr->scratch_arena, svt_arena_ctor, SVT_ARENA_CHUNK_SIZE);
+    EbArena *const    prev_arena = svt_set_alloc_arena(context_ptr->scratch_arena);
+    const EbErrorType err        = mode_decision_scratch_ctor(context_ptr, sb_size);
+    svt_set_alloc_arena(prev_arena);
+    return err;
 }
 
 /**************************************************
@@ -22,6 +22,7 @@
 #include "EbReferenceObject.h"
 #include "EbNeighborArrays.h"
 #include "EbObject.h"
+#include "EbArena.h"
 #include "EbEncInterPrediction.h"
 
 #ifdef __cplusplus
@@ -574,6 +575,10 @@ typedef struct ModeDecisionContext {
     // Transform and Quantization Buffers
     EbTransQuantBuffers * trans_quant_buffers_ptr;
     struct EncDecContext *enc_dec_context_ptr;
+    // Backs the candidate buffers, the cost arrays and the planes of the transform
+    // and recon scratch pictures. Temporary blocks are released by their user with
+    // svt_arena_rewind.
+    EbArena *scratch_arena;
 
     uint64_t *fast_cost_array;
     uint64_t *full_cost_array;
@@ -50,6 +50,7 @@ EbErrorType me_context_ctor(MeContext *object_ptr) {
     uint32_t me_candidate_index;
 #endif
     object_ptr->dctor = me_context_dctor;
+    svt_mem_set_tag(SVT_AV1_MEM_TAG_ME);
 #if FTR_TPL_TR
     EB_MALLOC(object_ptr->me_pcs, sizeof(MePcs));
 #endif
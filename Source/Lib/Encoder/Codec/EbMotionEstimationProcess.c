@@ -32,6 +32,8 @@
 #include "EbRateControlTasks.h"
 #include "firstpass.h"
 #include "EbInitialRateControlProcess.h"
+#include "EbPipelineStats.h"
+#include "EbTime.h"
 /* --32x32-
 |00||01|
 |02||03|
@@ -2140,6 +2142,9 @@ void *motion_estimation_kernel(void *input_ptr) {
         PictureParentControlSet *pcs_ptr = (PictureParentControlSet *)
                                                in_results_ptr->pcs_wrapper_ptr->object_ptr;
         SequenceControlSet * scs_ptr = (SequenceControlSet *)pcs_ptr->scs_wrapper_ptr->object_ptr;
+        pipeline_stage_begin(
+            pcs_ptr, SVT_AV1_STAGE_MOTION_ESTIMATION, in_results_ptr->segment_index);
+        const uint64_t work_start_ns = svt_av1_get_time_ns();
 #if FTR_TPL_TR
         if (in_results_ptr->task_type == TASK_TFME)
             context_ptr->me_context_ptr->me_type = ME_MCTF;
@@ -2645,6 +2650,10 @@ void *motion_estimation_kernel(void *input_ptr) {
             }
 #endif
             }
+            // Work of the segment, for the cost model of the speed control
+            if (scs_ptr->static_config.speed_control_flag)
+                svt_atomic_fetch_add_u64(&pcs_ptr->speed_control_work_ns,
+                                         svt_av1_get_time_ns() - work_start_ns);
             // Get Empty Results Object
             svt_get_empty_object(context_ptr->motion_estimation_results_output_fifo_ptr,
                                 &out_results_wrapper_ptr);
@@ -2877,6 +2886,7 @@ void *inloop_me_kernel(void *input_ptr) {
 
         in_results_ptr = (PictureManagerResults *)in_results_wrapper_ptr->object_ptr;
         PictureParentControlSet* ppcs_ptr = (PictureParentControlSet*)in_results_ptr->pcs_wrapper_ptr->object_ptr;
+        pipeline_stage_begin(ppcs_ptr, SVT_AV1_STAGE_INLOOP_ME, in_results_ptr->segment_index);
         SequenceControlSet* scs_ptr =
             (SequenceControlSet *)ppcs_ptr->scs_wrapper_ptr->object_ptr;
         uint8_t task_type = in_results_ptr->task_type;
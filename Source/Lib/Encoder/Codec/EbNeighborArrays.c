@@ -32,6 +32,7 @@ EbErrorType neighbor_array_unit_ctor32(NeighborArrayUnit32 *na_unit_ptr, uint32_
                                        uint32_t granularity_normal, uint32_t granularity_top_left,
                                        uint32_t type_mask) {
     na_unit_ptr->dctor                     = neighbor_array_unit_dctor32;
+    svt_mem_set_tag(SVT_AV1_MEM_TAG_NEIGHBOR);
     na_unit_ptr->unit_size                 = (uint8_t)(unit_size);
     na_unit_ptr->granularity_normal        = (uint8_t)(granularity_normal);
     na_unit_ptr->granularity_normal_log2   = (uint8_t)(svt_log2f(na_unit_ptr->granularity_normal));
@@ -78,6 +79,7 @@ EbErrorType neighbor_array_unit_ctor(NeighborArrayUnit *na_unit_ptr, uint32_t ma
                                      uint32_t granularity_normal, uint32_t granularity_top_left,
                                      uint32_t type_mask) {
     na_unit_ptr->dctor                     = neighbor_array_unit_dctor;
+    svt_mem_set_tag(SVT_AV1_MEM_TAG_NEIGHBOR);
     na_unit_ptr->unit_size                 = (uint8_t)(unit_size);
     na_unit_ptr->granularity_normal        = (uint8_t)(granularity_normal);
     na_unit_ptr->granularity_normal_log2   = (uint8_t)(svt_log2f(na_unit_ptr->granularity_normal));
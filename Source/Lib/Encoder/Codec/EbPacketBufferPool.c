@@ -0,0 +1,107 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#include "EbThreads.h"
+#include "EbUtility.h"
+#include "EbPacketBufferPool.h"
+
+typedef struct EbPacketBuffer {
+    EbPacketBufferPool *   pool;
+    struct EbPacketBuffer *next;
+    size_t                 capacity;
+} EbPacketBuffer;
+
+// The header takes the first bytes of the allocation, the data stays 16 bytes aligned
+#define PACKET_HEADER_SIZE 32
+#define PACKET_DATA(b) ((uint8_t *)(b) + PACKET_HEADER_SIZE)
+#define PACKET_BUFFER(d) ((EbPacketBuffer *)((uint8_t *)(d)-PACKET_HEADER_SIZE))
+
+static void svt_packet_buffer_pool_dctor(EbPtr p) {
+    EbPacketBufferPool *obj = (EbPacketBufferPool *)p;
+    while (obj->free_list) {
+        EbPacketBuffer *next = obj->free_list->next;
+        EB_FREE(obj->free_list);
+        obj->free_list = next;
+    }
+    EB_DESTROY_MUTEX(obj->mutex);
+}
+
+EbErrorType svt_packet_buffer_pool_ctor(EbPacketBufferPool *pool) {
+    pool->dctor = svt_packet_buffer_pool_dctor;
+    svt_mem_set_tag(SVT_AV1_MEM_TAG_BITSTREAM);
+    EB_CREATE_MUTEX(pool->mutex);
+    return EB_ErrorNone;
+}
+
+// Grows by half at least, in whole pages, so a slowly rising bitrate reallocates rarely
+static size_t packet_capacity(size_t capacity, size_t size) {
+    const size_t page = 4096;
+    return (MAX(size, capacity + capacity / 2) + page - 1) & ~(page - 1);
+}
+
+static EbPacketBuffer *packet_buffer_realloc(EbPacketBuffer *buf, size_t size) {
+    const size_t          capacity = packet_capacity(buf ? buf->capacity : 0, size);
+    const SvtAv1MemoryTag tag      = svt_mem_set_tag(SVT_AV1_MEM_TAG_BITSTREAM);
+    EbPacketBuffer *      p        = svt_mem_realloc(buf, PACKET_HEADER_SIZE + capacity);
+    svt_mem_set_tag(tag);
+    if (!p) {
+        svt_print_alloc_fail(__FILE__, __LINE__);
+        return NULL;
+    }
+    if (buf)
+        EB_REMOVE_MEM_ENTRY(buf, EB_N_PTR);
+    EB_ADD_MEM_ENTRY(p, EB_N_PTR, PACKET_HEADER_SIZE + capacity);
+    p->capacity = capacity;
+    return p;
+}
+
+uint8_t *svt_packet_buffer_get(EbPacketBufferPool *pool, size_t size) {
+    svt_block_on_mutex(pool->mutex);
+    EbPacketBuffer *buf = pool->free_list;
+    if (buf)
+        pool->free_list = buf->next;
+    svt_release_mutex(pool->mutex);
+
+    if (!buf || buf->capacity < size) {
+        EbPacketBuffer *p = packet_buffer_realloc(buf, size);
+        if (!p) {
+            svt_packet_buffer_release(buf ? PACKET_DATA(buf) : NULL);
+            return NULL;
+        }
+        buf = p;
+    }
+    buf->pool = pool;
+    buf->next = NULL;
+    return PACKET_DATA(buf);
+}
+
+uint8_t *svt_packet_buffer_grow(uint8_t *buffer, size_t size) {
+    EbPacketBuffer *buf = PACKET_BUFFER(buffer);
+    if (buf->capacity >= size)
+        return buffer;
+    buf = packet_buffer_realloc(buf, size);
+    return buf ? PACKET_DATA(buf) : NULL;
+}
+
+size_t svt_packet_buffer_capacity(const uint8_t *buffer) {
+    return PACKET_BUFFER(buffer)->capacity;
+}
+
+void svt_packet_buffer_release(uint8_t *buffer) {
+    if (!buffer)
+        return;
+    EbPacketBuffer *    buf  = PACKET_BUFFER(buffer);
+    EbPacketBufferPool *pool = buf->pool;
+    svt_block_on_mutex(pool->mutex);
+    buf->next       = pool->free_list;
+    pool->free_list = buf;
+    svt_release_mutex(pool->mutex);
+}
@@ -0,0 +1,56 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#ifndef EbPacketBufferPool_h
+#define EbPacketBufferPool_h
+
+#include "EbDefinitions.h"
+#include "EbObject.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct EbPacketBuffer;
+
+/*********************************************************************
+ * Packet Buffer Pool
+ *   Backs the p_buffer of the output packets. The frames are written
+ *   straight into a pooled buffer, which is handed to the application
+ *   by svt_av1_enc_get_packet and comes back to the pool of its encoder
+ *   on svt_av1_enc_release_out_buffer. Buffers keep their capacity, so
+ *   in steady state no packet allocates.
+ *********************************************************************/
+typedef struct EbPacketBufferPool {
+    EbDctor                dctor;
+    EbHandle               mutex;
+    struct EbPacketBuffer *free_list; // most recently released first
+} EbPacketBufferPool;
+
+extern EbErrorType svt_packet_buffer_pool_ctor(EbPacketBufferPool *pool);
+
+/* Buffer of at least size bytes, uninitialized, NULL on allocation failure */
+extern uint8_t *svt_packet_buffer_get(EbPacketBufferPool *pool, size_t size);
+
+/* Grows the buffer to at least size bytes keeping its content. Returns the
+ * moved buffer, NULL on allocation failure with buffer left untouched. */
+extern uint8_t *svt_packet_buffer_grow(uint8_t *buffer, size_t size);
+
+extern size_t svt_packet_buffer_capacity(const uint8_t *buffer);
+
+/* Gives the buffer back to the pool it was taken from, NULL is ignored. The
+ * pool must still exist: packets are released before svt_av1_enc_deinit */
+extern void svt_packet_buffer_release(uint8_t *buffer);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // EbPacketBufferPool_h
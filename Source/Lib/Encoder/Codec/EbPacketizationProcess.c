@@ -23,6 +23,8 @@
 #include "EbPictureDemuxResults.h"
 #include "EbLog.h"
 #include "EbSvtAv1ErrorCodes.h"
+#include "EbPipelineStats.h"
+#include "EbSpeedControl.h"
 
 /**************************************
  * Type Declarations
@@ -84,6 +86,15 @@ EbErrorType packetization_context_ctor(EbThreadContext *  thread_context_ptr,
 
     return EB_ErrorNone;
 }
+
+/* Restarts the display order of the frames for a new sequence */
+static void packetization_reset(EbThreadContext *thread_context_ptr) {
+    PacketizationContext *context_ptr = (PacketizationContext *)thread_context_ptr->priv;
+    memset(context_ptr->dpb_disp_order, 0, sizeof(context_ptr->dpb_disp_order));
+    memset(context_ptr->dpb_dec_order, 0, sizeof(context_ptr->dpb_dec_order));
+    context_ptr->tot_shown_frames            = 0;
+    context_ptr->disp_order_continuity_count = 0;
+}
 #if !CLN_OLD_RC
 void update_rc_rate_tables(PictureControlSet *pcs_ptr, SequenceControlSet *scs_ptr) {
     Dequants *const dequants = pcs_ptr->hbd_mode_decision ?
@@ -511,40 +522,50 @@ static void collect_frames_info(PacketizationContext* context_ptr, const EncodeC
     }
 }
 
+// A frame is written at p_buffer + TD_SIZE of its packet, n_filled_len
+// counts the frame bytes only until its tu is complete
 #define TD_SIZE 2
+// Sequence header, frame header and tile group header, a frame whose headers
+// do not fit is reported to the application as an encode error
+#define HEADERS_MAX_SIZE 4096
 
 //a tu start with a td, + 0 more not displable frame, + 1 display frame
 static EbErrorType encode_tu(EncodeContext *encode_context_ptr, int frames, uint32_t total_bytes,
                              EbBufferHeaderType *output_stream_ptr) {
     total_bytes += TD_SIZE;
-    if (total_bytes > output_stream_ptr->n_alloc_len) {
-        uint8_t *pbuff;
-        EB_MALLOC(pbuff, total_bytes);
-        if (!pbuff) {
-            SVT_ERROR("failed to allocate more memory in encode_tu");
-            return EB_ErrorInsufficientResources;
-        }
-        EB_MEMCPY(pbuff,
-                  output_stream_ptr->p_buffer,
-                  output_stream_ptr->n_alloc_len > total_bytes ? total_bytes
-                                                               : output_stream_ptr->n_alloc_len);
-        EB_FREE(output_stream_ptr->p_buffer);
-        output_stream_ptr->p_buffer    = pbuff;
-        output_stream_ptr->n_alloc_len = total_bytes;
+    uint8_t *pbuff = svt_packet_buffer_grow(output_stream_ptr->p_buffer, total_bytes);
+    if (!pbuff) {
+        SVT_ERROR("failed to allocate more memory in encode_tu");
+        return EB_ErrorInsufficientResources;
     }
+    output_stream_ptr->p_buffer    = pbuff;
+    output_stream_ptr->n_alloc_len = (uint32_t)svt_packet_buffer_capacity(pbuff);
     uint8_t *dst                    = output_stream_ptr->p_buffer + total_bytes;
     //we use last frame's output_stream_ptr to hold entire tu, so we need copy backward.
+    //a tu of one frame is already in place.
     for (int i = frames - 1; i >= 0; i--) {
         PacketizationReorderEntry *queue_entry_ptr = get_reorder_queue_entry(encode_context_ptr, i);
         EbObjectWrapper* wrapper = queue_entry_ptr->output_stream_wrapper_ptr;
         EbBufferHeaderType *       src_stream_ptr = (EbBufferHeaderType *)wrapper->object_ptr;
+        uint8_t *src  = src_stream_ptr->p_buffer + TD_SIZE;
         uint32_t size = src_stream_ptr->n_filled_len;
         dst -= size;
-        memmove(dst, src_stream_ptr->p_buffer, size);
+        if (dst != src)
+            memmove(dst, src, size);
         //1. The last frame is a displayable frame, others are undisplayed.
-        //2. We do not push alt ref frame since the overlay frame will carry the pts.
-        if (i != frames - 1 && !queue_entry_ptr->is_alt_ref)
-            push_undisplayed_frame(encode_context_ptr, wrapper);
+        //2. We do not push alt ref frame since the overlay frame will carry the pts,
+        //   its packet is not output and goes back to the pool. Nothing else releases
+        //   it: kept, the pool would lose a packet per overlay until the encoder stalls.
+        if (i != frames - 1) {
+            if (!queue_entry_ptr->is_alt_ref)
+                push_undisplayed_frame(encode_context_ptr, wrapper);
+            else {
+                svt_packet_buffer_release(src_stream_ptr->p_buffer);
+                src_stream_ptr->p_buffer = NULL;
+                svt_metadata_array_free(&src_stream_ptr->metadata);
+                svt_release_object(wrapper);
+            }
+        }
     }
     if (frames > 1)
         sort_undisplayed_frame(encode_context_ptr);
@@ -560,7 +581,7 @@ static EbErrorType copy_data_from_bitstream(EncodeContext *encode_context_ptr, B
     int size = bitstream_get_bytes_count(bitstream_ptr);
 
     CHECK_REPORT_ERROR((size + output_stream_ptr->n_filled_len
-                       < output_stream_ptr->n_alloc_len),
+                       <= output_stream_ptr->n_alloc_len),
                        encode_context_ptr->app_callback_ptr,
                        EB_ENC_EC_ERROR2);
 
@@ -571,10 +592,19 @@ static EbErrorType copy_data_from_bitstream(EncodeContext *encode_context_ptr, B
     return return_error;
 }
 
-static void encode_show_existing(EncodeContext *encode_context_ptr,
-                                 PacketizationReorderEntry *queue_entry_ptr,
-                                 EbBufferHeaderType        *output_stream_ptr) {
-    uint8_t* dst = output_stream_ptr->p_buffer;
+static EbErrorType encode_show_existing(EncodeContext *            encode_context_ptr,
+                                        PacketizationReorderEntry *queue_entry_ptr,
+                                        EbBufferHeaderType *       output_stream_ptr) {
+    // the packet of the shown frame is reused, its header may carry more metadata
+    uint8_t *dst = svt_packet_buffer_grow(
+        output_stream_ptr->p_buffer,
+        TD_SIZE + bitstream_get_bytes_count(queue_entry_ptr->bitstream_ptr));
+    if (!dst) {
+        SVT_ERROR("failed to allocate more memory in encode_show_existing");
+        return EB_ErrorInsufficientResources;
+    }
+    output_stream_ptr->p_buffer    = dst;
+    output_stream_ptr->n_alloc_len = (uint32_t)svt_packet_buffer_capacity(dst);
 
     encode_td_av1(dst);
     output_stream_ptr->n_filled_len = TD_SIZE;
@@ -584,6 +614,7 @@ static void encode_show_existing(EncodeContext *encode_context_ptr,
                  output_stream_ptr);
 
     output_stream_ptr->flags |= (EB_BUFFERFLAG_SHOW_EXT | EB_BUFFERFLAG_HAS_TD);
+    return EB_ErrorNone;
 }
 
 static void release_frames(EncodeContext *encode_context_ptr, int frames) {
@@ -605,10 +636,31 @@ inline static void set_eos_flag(EbBufferHeaderType *output_stream_ptr) {
     output_stream_ptr->flags |= EB_BUFFERFLAG_EOS;
 }
 
-/* Wrapper function to capture the return of EB_MALLOC */
-static inline EbErrorType malloc_p_buffer(EbBufferHeaderType *output_stream_ptr) {
-    EB_MALLOC(output_stream_ptr->p_buffer, output_stream_ptr->n_alloc_len);
-    return EB_ErrorNone;
+/* Low delay pictures leave resource coordination before the end of sequence is
+ * known, so the packet of the terminating picture is flagged when it is posted */
+static void post_low_delay_packet(EncodeContext *  encode_context_ptr,
+                                  EbObjectWrapper *output_stream_wrapper_ptr) {
+    svt_block_on_mutex(encode_context_ptr->total_number_of_recon_frame_mutex);
+    if (encode_context_ptr->total_number_of_output_frames ==
+        encode_context_ptr->terminating_picture_number)
+        set_eos_flag((EbBufferHeaderType *)output_stream_wrapper_ptr->object_ptr);
+    encode_context_ptr->total_number_of_output_frames++;
+    svt_post_full_object(output_stream_wrapper_ptr);
+    svt_release_mutex(encode_context_ptr->total_number_of_recon_frame_mutex);
+}
+
+/* Bytes written by write_metadata_av1 for all the entries */
+static size_t metadata_max_size(const SvtMetadataArrayT *metadata) {
+    size_t sz = 0;
+    if (metadata && metadata->metadata_array) {
+        for (size_t i = 0; i < metadata->sz; i++) {
+            const SvtMetadataT *current_metadata = metadata->metadata_array[i];
+            // obu header, length field and metadata type
+            if (current_metadata && current_metadata->payload)
+                sz += current_metadata->sz + 16;
+        }
+    }
+    return sz;
 }
 
 /* Realloc when bitstream pointer size is not enough to write data of size sz */
@@ -643,6 +695,12 @@ void *packetization_kernel(void *input_ptr) {
         // Get EntropyCoding Results
         EB_GET_FULL_OBJECT(context_ptr->entropy_coding_input_fifo_ptr,
                            &entropy_coding_results_wrapper_ptr);
+        // Reset request of svt_av1_enc_reset, the pipeline is idle
+        if (entropy_coding_results_wrapper_ptr->signal_semaphore) {
+            packetization_reset(thread_context_ptr);
+            svt_release_signal_object(entropy_coding_results_wrapper_ptr);
+            continue;
+        }
 
         EntropyCodingResults *entropy_coding_results_ptr =
             (EntropyCodingResults *)entropy_coding_results_wrapper_ptr->object_ptr;
@@ -650,6 +708,7 @@ void *packetization_kernel(void *input_ptr) {
                                          entropy_coding_results_ptr->pcs_wrapper_ptr->object_ptr;
         SequenceControlSet *scs_ptr = (SequenceControlSet *)pcs_ptr->scs_wrapper_ptr->object_ptr;
         EncodeContext *     encode_context_ptr = scs_ptr->encode_context_ptr;
+        pipeline_stage_begin(pcs_ptr->parent_pcs_ptr, SVT_AV1_STAGE_PACKETIZATION, 0);
         FrameHeader *    frm_hdr    = &pcs_ptr->parent_pcs_ptr->frm_hdr;
         Av1Common *const cm = pcs_ptr->parent_pcs_ptr->av1_cm;
         uint16_t            tile_cnt = cm->tiles_info.tile_rows * cm->tiles_info.tile_cols;
@@ -671,6 +730,8 @@ void *packetization_kernel(void *input_ptr) {
         EbBufferHeaderType *output_stream_ptr = (EbBufferHeaderType *)
                                                     output_stream_wrapper_ptr->object_ptr;
 
+        // A packet may still hold the reports of its last use
+        svt_metadata_array_free(&output_stream_ptr->metadata);
         output_stream_ptr->flags = 0;
         output_stream_ptr->flags |=
             (encode_context_ptr->terminating_sequence_flag_received == EB_TRUE &&
@@ -751,26 +812,44 @@ void *packetization_kernel(void *input_ptr) {
             picture_manager_results_ptr->decode_order = pcs_ptr->parent_pcs_ptr->decode_order;
             picture_manager_results_ptr->scs_wrapper_ptr = pcs_ptr->scs_wrapper_ptr;
         }
-        // Reset the Bitstream before writing to it
-        bitstream_reset(pcs_ptr->bitstream_ptr);
-
-        size_t metadata_sz = 0;
+        // The frame is written straight into its packet, sized for the largest
+        // headers, the metadata and the tiles
+        size_t max_size = TD_SIZE + HEADERS_MAX_SIZE +
+            metadata_max_size(pcs_ptr->parent_pcs_ptr->input_ptr->metadata);
+        for (uint16_t tile_idx = 0; tile_idx < tile_cnt; tile_idx++)
+            max_size += pcs_ptr->entropy_coding_info[tile_idx]->entropy_coder_ptr->ec_writer.pos + 4;
+        output_stream_ptr->p_buffer = svt_packet_buffer_get(encode_context_ptr->packet_buffer_pool,
+                                                            max_size);
+        CHECK_REPORT_ERROR(output_stream_ptr->p_buffer != NULL,
+                           encode_context_ptr->app_callback_ptr,
+                           EB_ENC_EC_ERROR2);
+        output_stream_ptr->n_alloc_len = (uint32_t)svt_packet_buffer_capacity(
+            output_stream_ptr->p_buffer);
+
+        OutputBitstreamUnit packet_bitstream_unit;
+        Bitstream           packet_bitstream;
+        memset(&packet_bitstream, 0, sizeof(Bitstream));
+        memset(&packet_bitstream_unit, 0, sizeof(OutputBitstreamUnit));
+        packet_bitstream.output_bitstream_ptr  = &packet_bitstream_unit;
+        packet_bitstream_unit.size             = output_stream_ptr->n_alloc_len - TD_SIZE;
+        packet_bitstream_unit.buffer_begin_av1 = output_stream_ptr->p_buffer + TD_SIZE;
+        output_bitstream_reset(&packet_bitstream_unit);
 
         // Code the SPS
         if (frm_hdr->frame_type == KEY_FRAME) {
-            encode_sps_av1(pcs_ptr->bitstream_ptr, scs_ptr);
+            encode_sps_av1(&packet_bitstream, scs_ptr);
             // Add CLL and MDCV meta when frame is keyframe and SPS is written
-            write_metadata_av1(pcs_ptr->bitstream_ptr,
+            write_metadata_av1(&packet_bitstream,
                                pcs_ptr->parent_pcs_ptr->input_ptr->metadata,
                                EB_AV1_METADATA_TYPE_HDR_CLL);
-            write_metadata_av1(pcs_ptr->bitstream_ptr,
+            write_metadata_av1(&packet_bitstream,
                                pcs_ptr->parent_pcs_ptr->input_ptr->metadata,
                                EB_AV1_METADATA_TYPE_HDR_MDCV);
         }
 
         if (frm_hdr->show_frame) {
             // Add HDR10+ dynamic metadata when show frame flag is enabled
-            write_metadata_av1(pcs_ptr->bitstream_ptr,
+            write_metadata_av1(&packet_bitstream,
                                pcs_ptr->parent_pcs_ptr->input_ptr->metadata,
                                EB_AV1_METADATA_TYPE_ITUT_T35);
             svt_metadata_array_free(&pcs_ptr->parent_pcs_ptr->input_ptr->metadata);
@@ -783,20 +862,15 @@ void *packetization_kernel(void *input_ptr) {
                                                   PACKETIZATION_REORDER_QUEUE_MAX_DEPTH];
             temp_entry->metadata = pcs_ptr->parent_pcs_ptr->input_ptr->metadata;
             pcs_ptr->parent_pcs_ptr->input_ptr->metadata = NULL;
-            metadata_sz = svt_metadata_size(temp_entry->metadata, EB_AV1_METADATA_TYPE_ITUT_T35);
         }
 
-        write_frame_header_av1(pcs_ptr->bitstream_ptr, scs_ptr, pcs_ptr, 0);
+        // Headers past HEADERS_MAX_SIZE leave no room for the tiles
+        CHECK_REPORT_ERROR(
+            write_frame_header_av1(&packet_bitstream, scs_ptr, pcs_ptr, 0) == EB_ErrorNone,
+            encode_context_ptr->app_callback_ptr,
+            EB_ENC_EC_ERROR2);
 
-        output_stream_ptr->n_alloc_len = (uint32_t)(
-            bitstream_get_bytes_count(pcs_ptr->bitstream_ptr) + TD_SIZE + metadata_sz);
-        malloc_p_buffer(output_stream_ptr);
-
-        assert(output_stream_ptr->p_buffer != NULL && "bit-stream memory allocation failure");
-
-        copy_data_from_bitstream(encode_context_ptr,
-                    pcs_ptr->bitstream_ptr,
-                    output_stream_ptr);
+        output_stream_ptr->n_filled_len = (uint32_t)bitstream_get_bytes_count(&packet_bitstream);
 
         if (pcs_ptr->parent_pcs_ptr->has_show_existing) {
             uint64_t                   next_picture_number = pcs_ptr->picture_number + 1;
@@ -817,7 +891,11 @@ void *packetization_kernel(void *input_ptr) {
             write_metadata_av1(queue_entry_ptr->bitstream_ptr,
                                temp_entry->metadata,
                                EB_AV1_METADATA_TYPE_ITUT_T35);
-            write_frame_header_av1(queue_entry_ptr->bitstream_ptr, scs_ptr, pcs_ptr, 1);
+            CHECK_REPORT_ERROR(
+                write_frame_header_av1(queue_entry_ptr->bitstream_ptr, scs_ptr, pcs_ptr, 1) ==
+                    EB_ErrorNone,
+                encode_context_ptr->app_callback_ptr,
+                EB_ENC_EC_ERROR2);
             svt_metadata_array_free(&temp_entry->metadata);
         }
 
@@ -868,12 +946,12 @@ void *packetization_kernel(void *input_ptr) {
             pcs_ptr->parent_pcs_ptr->data_ll_head_ptr = app_data_ll_head_temp_ptr;
         }
 
-        if (scs_ptr->static_config.speed_control_flag) {
-            // update speed control variables
-            svt_block_on_mutex(encode_context_ptr->sc_buffer_mutex);
-            encode_context_ptr->sc_frame_out++;
-            svt_release_mutex(encode_context_ptr->sc_buffer_mutex);
-        }
+        if (scs_ptr->static_config.speed_control_flag)
+            speed_control_picture_done(scs_ptr, pcs_ptr->parent_pcs_ptr, output_stream_ptr);
+
+        pipeline_picture_done(encode_context_ptr, pcs_ptr->parent_pcs_ptr);
+        // The picture still holds its buffers, a point for the memory peaks
+        svt_mem_sample_peak();
 
         // Post Rate Control Taks
         svt_post_full_object(rate_control_tasks_wrapper_ptr);
@@ -913,17 +991,29 @@ void *packetization_kernel(void *input_ptr) {
             output_stream_ptr         = (EbBufferHeaderType *)output_stream_wrapper_ptr->object_ptr;
             EbBool eos                = output_stream_ptr->flags &  EB_BUFFERFLAG_EOS;
 
-            encode_tu(encode_context_ptr, frames, total_bytes, output_stream_ptr);
+            CHECK_REPORT_ERROR(
+                encode_tu(encode_context_ptr, frames, total_bytes, output_stream_ptr) ==
+                    EB_ErrorNone,
+                encode_context_ptr->app_callback_ptr,
+                EB_ENC_EC_ERROR2);
 
             if (eos && queue_entry_ptr->has_show_existing)
                 clear_eos_flag(output_stream_ptr);
 
-            svt_post_full_object(output_stream_wrapper_ptr);
+            if (scs_ptr->low_delay_pipeline)
+                post_low_delay_packet(encode_context_ptr, output_stream_wrapper_ptr);
+            else
+                svt_post_full_object(output_stream_wrapper_ptr);
             if (queue_entry_ptr->has_show_existing) {
                 EbObjectWrapper *existed = pop_undisplayed_frame(encode_context_ptr);
                 if (existed) {
                     EbBufferHeaderType *existed_output_stream_ptr = (EbBufferHeaderType *)existed->object_ptr;
-                    encode_show_existing(encode_context_ptr, queue_entry_ptr, existed_output_stream_ptr);
+                    CHECK_REPORT_ERROR(encode_show_existing(encode_context_ptr,
+                                                            queue_entry_ptr,
+                                                            existed_output_stream_ptr) ==
+                                           EB_ErrorNone,
+                                       encode_context_ptr->app_callback_ptr,
+                                       EB_ENC_EC_ERROR2);
                     if (eos)
                         set_eos_flag(existed_output_stream_ptr);
                     svt_post_full_object(existed);
@@ -0,0 +1,105 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#include <string.h>
+
+#include "EbParameterUpdate.h"
+#include "EbThreads.h"
+
+#define RC_UPDATE_FLAGS (SVT_AV1_UPDATE_TARGET_BIT_RATE | SVT_AV1_UPDATE_QP_RANGE)
+
+/* The fields src sets override the ones of dst */
+static void merge_update(SvtAv1EncUpdate *dst, const SvtAv1EncUpdate *src) {
+    if (src->flags & SVT_AV1_UPDATE_TARGET_BIT_RATE)
+        dst->target_bit_rate = src->target_bit_rate;
+    if (src->flags & SVT_AV1_UPDATE_QP_RANGE) {
+        dst->max_qp_allowed = src->max_qp_allowed;
+        dst->min_qp_allowed = src->min_qp_allowed;
+    }
+    if (src->flags & SVT_AV1_UPDATE_ENC_MODE)
+        dst->enc_mode = src->enc_mode;
+    dst->flags |= src->flags;
+}
+
+EbErrorType param_update_push(EncodeContext *encode_context_ptr, const SvtAv1EncUpdate *update) {
+    EbErrorType      return_error = EB_ErrorNone;
+    SvtAv1EncUpdate *queue        = encode_context_ptr->param_update_queue;
+    svt_block_on_mutex(encode_context_ptr->param_update_mutex);
+    uint32_t index = encode_context_ptr->param_update_count;
+    while (index > 0 && queue[index - 1].picture_number > update->picture_number) index--;
+    if (index > 0 && queue[index - 1].picture_number == update->picture_number)
+        merge_update(&queue[index - 1], update);
+    else if (encode_context_ptr->param_update_count == SVT_AV1_MAX_PENDING_UPDATES)
+        return_error = EB_ErrorInsufficientResources;
+    else {
+        memmove(&queue[index + 1],
+                &queue[index],
+                (encode_context_ptr->param_update_count - index) * sizeof(*queue));
+        queue[index] = *update;
+        encode_context_ptr->param_update_count++;
+    }
+    svt_release_mutex(encode_context_ptr->param_update_mutex);
+    return return_error;
+}
+
+void param_update_take(EncodeContext *encode_context_ptr, PictureParentControlSet *pcs_ptr) {
+    SvtAv1EncUpdate *queue = encode_context_ptr->param_update_queue;
+    memset(&pcs_ptr->param_update, 0, sizeof(pcs_ptr->param_update));
+    // The overlay shares the number of its picture, which took the updates
+    if (pcs_ptr->is_overlay)
+        return;
+    pcs_ptr->param_update.picture_number = pcs_ptr->picture_number;
+    svt_block_on_mutex(encode_context_ptr->param_update_mutex);
+    uint32_t due = 0;
+    // Updates sent for pictures already in are due at this one
+    while (due < encode_context_ptr->param_update_count &&
+           queue[due].picture_number <= pcs_ptr->picture_number)
+        merge_update(&pcs_ptr->param_update, &queue[due++]);
+    encode_context_ptr->param_update_count -= due;
+    memmove(&queue[0], &queue[due], encode_context_ptr->param_update_count * sizeof(*queue));
+    svt_release_mutex(encode_context_ptr->param_update_mutex);
+}
+
+void param_update_mini_gop(EncodeContext *encode_context_ptr, EbObjectWrapper **pictures,
+                           uint32_t start_index, uint32_t end_index) {
+    SvtAv1EncUpdate *        pending   = &encode_context_ptr->param_update_pending;
+    SvtAv1EncUpdate *        rc_update = &encode_context_ptr->rc_update;
+    PictureParentControlSet *pcs_ptr = (PictureParentControlSet *)pictures[start_index]->object_ptr;
+    const EbSvtAv1EncConfiguration *config = &pcs_ptr->scs_ptr->static_config;
+    merge_update(pending, &pcs_ptr->param_update);
+
+    if (pending->flags & SVT_AV1_UPDATE_ENC_MODE)
+        svt_atomic_store_u32(&encode_context_ptr->enc_mode, (uint32_t)pending->enc_mode);
+    if (pending->flags & RC_UPDATE_FLAGS) {
+        SvtAv1EncUpdate update = *pending;
+        update.flags &= RC_UPDATE_FLAGS;
+        merge_update(rc_update, &update);
+        encode_context_ptr->rc_update_count++;
+    }
+    for (uint32_t index = start_index; index <= end_index; index++) {
+        pcs_ptr = (PictureParentControlSet *)pictures[index]->object_ptr;
+        pcs_ptr->rc_target_bit_rate = (rc_update->flags & SVT_AV1_UPDATE_TARGET_BIT_RATE)
+            ? rc_update->target_bit_rate
+            : config->target_bit_rate;
+        pcs_ptr->rc_max_qp_allowed = (rc_update->flags & SVT_AV1_UPDATE_QP_RANGE)
+            ? rc_update->max_qp_allowed
+            : config->max_qp_allowed;
+        pcs_ptr->rc_min_qp_allowed = (rc_update->flags & SVT_AV1_UPDATE_QP_RANGE)
+            ? rc_update->min_qp_allowed
+            : config->min_qp_allowed;
+        pcs_ptr->rc_update_id = encode_context_ptr->rc_update_count;
+    }
+
+    memset(pending, 0, sizeof(*pending));
+    for (uint32_t index = start_index + 1; index <= end_index; index++)
+        merge_update(pending,
+                     &((PictureParentControlSet *)pictures[index]->object_ptr)->param_update);
+}
@@ -0,0 +1,39 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#ifndef EbParameterUpdate_h
+#define EbParameterUpdate_h
+
+#include "EbSequenceControlSet.h"
+#include "EbPictureControlSet.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Queues a validated update until its picture is sent, merged with the one
+ * already queued for the same picture */
+EbErrorType param_update_push(EncodeContext *encode_context_ptr, const SvtAv1EncUpdate *update);
+
+/* Resource coordination: moves the updates due at the input picture to it */
+void param_update_take(EncodeContext *encode_context_ptr, PictureParentControlSet *pcs_ptr);
+
+/* Picture decision, before the pictures of a mini-gop of the pre-assignment
+ * buffer are processed: applies the updates due up to its first picture,
+ * stamps its pictures with the rate control parameters in effect, and keeps
+ * the updates due at its other pictures for the next mini-gop */
+void param_update_mini_gop(EncodeContext *encode_context_ptr, EbObjectWrapper **pictures,
+                           uint32_t start_index, uint32_t end_index);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // EbParameterUpdate_h
@@ -30,6 +30,7 @@
 #include "EbMotionEstimationContext.h"
 #include "EbPictureOperators.h"
 #include "EbResize.h"
+#include "EbPipelineStats.h"
 
 #define VARIANCE_PRECISION 16
 #define SB_LOW_VAR_TH 5
@@ -3949,6 +3950,7 @@ void *picture_analysis_kernel(void *input_ptr) {
 
         in_results_ptr = (ResourceCoordinationResults *)in_results_wrapper_ptr->object_ptr;
         pcs_ptr        = (PictureParentControlSet *)in_results_ptr->pcs_wrapper_ptr->object_ptr;
+        pipeline_stage_begin(pcs_ptr, SVT_AV1_STAGE_PICTURE_ANALYSIS, 0);
 
         // Mariana : save enhanced picture ptr, move this from here
         pcs_ptr->enhanced_unscaled_picture_ptr = pcs_ptr->enhanced_picture_ptr;
@@ -188,7 +188,6 @@ void picture_control_set_dctor(EbPtr p) {
         EB_DELETE_PTR_ARRAY(obj->md_interpolation_type_neighbor_array[depth], tile_cnt);
     }
     EB_DELETE_PTR_ARRAY(obj->sb_ptr_array, obj->sb_total_count_unscaled);
-    EB_DELETE(obj->bitstream_ptr);
     EB_DELETE_PTR_ARRAY(obj->entropy_coding_info, tile_cnt);
 #if !CLN_STRUCT
     EB_DELETE(obj->recon_picture16bit_ptr);
@@ -443,6 +442,7 @@ EbErrorType picture_control_set_ctor(PictureControlSet *object_ptr, EbPtr object
     object_ptr->tile_column_count = init_data_ptr->tile_column_count;
 
     object_ptr->dctor = picture_control_set_dctor;
+    svt_mem_set_tag(SVT_AV1_MEM_TAG_PCS);
 
     // Init Picture Init data
     input_pic_buf_desc_init_data.max_width          = init_data_ptr->picture_width;
@@ -622,9 +622,6 @@ EbErrorType picture_control_set_ctor(PictureControlSet *object_ptr, EbPtr object
                output_buffer_size / total_tile_cnt);
     }
 
-    // Packetization process Bitstream
-    EB_NEW(object_ptr->bitstream_ptr, bitstream_ctor, output_buffer_size);
-
     // GOP
     object_ptr->picture_number       = 0;
     object_ptr->temporal_layer_index = 0;
@@ -1544,6 +1541,7 @@ EbErrorType picture_parent_control_set_ctor(PictureParentControlSet *object_ptr,
     uint32_t       region_in_picture_height_index;
 
     object_ptr->dctor = picture_parent_control_set_dctor;
+    svt_mem_set_tag(SVT_AV1_MEM_TAG_PCS);
 
     object_ptr->scs_wrapper_ptr                 = (EbObjectWrapper *)NULL;
     object_ptr->input_picture_wrapper_ptr       = (EbObjectWrapper *)NULL;
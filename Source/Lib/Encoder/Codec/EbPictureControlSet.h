@@ -275,9 +275,6 @@ typedef struct PictureControlSet {
 
     struct PictureParentControlSet *parent_pcs_ptr; //The parent of this PCS.
     EbObjectWrapper *               picture_parent_control_set_wrapper_ptr;
-    // Packetization (used to encode SPS, PPS, etc)
-    Bitstream *bitstream_ptr;
-
     EbObjectWrapper *c_pcs_wrapper_ptr;
 
     // Reference Lists
@@ -1318,6 +1315,21 @@ typedef struct PictureParentControlSet {
 #if FTR_REDUCE_MVEST
     uint8_t bypass_cost_table_gen;
 #endif
+    // Time at which each SvtAv1PipelineStage first took the picture, 0 if not yet
+    volatile uint64_t stage_time_ns[SVT_AV1_STAGE_COUNT];
+    // Speed control: motion estimation and mode decision work on the picture,
+    // summed over the segments, and the decision taken for the picture
+    volatile uint64_t      speed_control_work_ns;
+    SvtAv1SpeedControlInfo speed_control_info;
+    // Runtime parameter update due at this input picture, flags 0 for none
+    SvtAv1EncUpdate param_update;
+    // Rate control parameters the picture is coded with: the configuration
+    // with the runtime updates in effect for its mini-gop. rc_update_id counts
+    // the updates, rate control reconfigures when it changes.
+    uint32_t rc_target_bit_rate;
+    uint32_t rc_max_qp_allowed;
+    uint32_t rc_min_qp_allowed;
+    uint64_t rc_update_id;
 } PictureParentControlSet;
 
 typedef struct PictureControlSetInitData {
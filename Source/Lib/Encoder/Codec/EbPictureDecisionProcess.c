@@ -32,6 +32,9 @@
 #include "common_dsp_rtcd.h"
 #include "EbResize.h"
 #include "EbMalloc.h"
+#include "EbPipelineStats.h"
+#include "EbSpeedControl.h"
+#include "EbParameterUpdate.h"
 
 #if FTR_TPL_TR
 #include "EbPictureOperators.h"
@@ -277,6 +280,7 @@ EbErrorType picture_decision_context_ctor(
     context_ptr->reset_running_avg = EB_TRUE;
     context_ptr->me_fifo_ptr = svt_system_resource_get_producer_fifo(
             enc_handle_ptr->me_pool_ptr_array[0], 0);
+    context_ptr->current_input_poc = -1;
 
 
 #if FTR_LAD_MG
@@ -287,6 +291,39 @@ EbErrorType picture_decision_context_ctor(
     return EB_ErrorNone;
 }
 
+/************************************************
+ * Picture Decision Context Reset
+ *  Back to the state of the constructor for a new sequence
+ ************************************************/
+static void picture_decision_reset(EbThreadContext *thread_context_ptr)
+{
+    PictureDecisionContext *context_ptr = (PictureDecisionContext*)thread_context_ptr->priv;
+    EbFifo    *input_fifo_ptr  = context_ptr->picture_analysis_results_input_fifo_ptr;
+    EbFifo    *output_fifo_ptr = context_ptr->picture_decision_results_output_fifo_ptr;
+    EbFifo    *me_fifo_ptr     = context_ptr->me_fifo_ptr;
+    uint32_t **ahd_running_avg_cb = context_ptr->ahd_running_avg_cb;
+    uint32_t **ahd_running_avg_cr = context_ptr->ahd_running_avg_cr;
+    uint32_t **ahd_running_avg    = context_ptr->ahd_running_avg;
+
+    memset(context_ptr, 0, sizeof(*context_ptr));
+    context_ptr->picture_analysis_results_input_fifo_ptr  = input_fifo_ptr;
+    context_ptr->picture_decision_results_output_fifo_ptr = output_fifo_ptr;
+    context_ptr->me_fifo_ptr                              = me_fifo_ptr;
+    context_ptr->ahd_running_avg_cb                       = ahd_running_avg_cb;
+    context_ptr->ahd_running_avg_cr                       = ahd_running_avg_cr;
+    context_ptr->ahd_running_avg                          = ahd_running_avg;
+
+    for (uint32_t arr_row = 0; arr_row < MAX_NUMBER_OF_REGIONS_IN_HEIGHT; arr_row++) {
+        for (uint32_t arr_col = 0; arr_col < MAX_NUMBER_OF_REGIONS_IN_WIDTH; arr_col++) {
+            ahd_running_avg_cb[arr_col][arr_row] = 0;
+            ahd_running_avg_cr[arr_col][arr_row] = 0;
+            ahd_running_avg[arr_col][arr_row] = 0;
+        }
+    }
+    context_ptr->reset_running_avg = EB_TRUE;
+    context_ptr->current_input_poc = -1;
+}
+
 static EbBool scene_transition_detector(
     PictureDecisionContext *context_ptr,
     SequenceControlSet                 *scs_ptr,
@@ -4952,6 +4989,10 @@ void initialize_overlay_frame(PictureParentControlSet     *pcs_ptr) {
 #if !CLN_OLD_RC
     pcs_ptr->target_bit_rate = pcs_ptr->alt_ref_ppcs_ptr->target_bit_rate;
 #endif
+    pcs_ptr->rc_target_bit_rate = pcs_ptr->alt_ref_ppcs_ptr->rc_target_bit_rate;
+    pcs_ptr->rc_max_qp_allowed  = pcs_ptr->alt_ref_ppcs_ptr->rc_max_qp_allowed;
+    pcs_ptr->rc_min_qp_allowed  = pcs_ptr->alt_ref_ppcs_ptr->rc_min_qp_allowed;
+    pcs_ptr->rc_update_id       = pcs_ptr->alt_ref_ppcs_ptr->rc_update_id;
     pcs_ptr->last_idr_picture = pcs_ptr->alt_ref_ppcs_ptr->last_idr_picture;
     pcs_ptr->pred_structure = pcs_ptr->alt_ref_ppcs_ptr->pred_structure;
     pcs_ptr->pred_struct_ptr = pcs_ptr->alt_ref_ppcs_ptr->pred_struct_ptr;
@@ -4999,7 +5040,9 @@ int32_t search_this_pic(PictureParentControlSet**buf, uint32_t buf_size, uint64_
 */
 EbBool is_delayed_intra(PictureParentControlSet *pcs) {
     if (pcs->idr_flag || pcs->cra_flag) {
-        if (pcs->scs_ptr->static_config.intra_period_length == 0 || pcs->end_of_sequence_flag)
+        // Low delay without future window: nothing to gather, the Intra goes out as it comes
+        if (pcs->scs_ptr->static_config.intra_period_length == 0 || pcs->end_of_sequence_flag ||
+            pcs->scs_ptr->low_delay_pipeline)
             return 0;
         else if (pcs->idr_flag || (pcs->cra_flag && pcs->pre_assignment_buffer_count < pcs->pred_struct_ptr->pred_struct_period))
             return 1;
@@ -6504,7 +6547,6 @@ void* picture_decision_kernel(void *input_ptr)
     // Dynamic GOP
     uint32_t                           mini_gop_index;
     uint32_t                           out_stride_diff64;
-    int64_t                            current_input_poc = -1;
 
     EbBool                          window_avail, frame_passthrough;
     uint32_t                           window_index;
@@ -6517,9 +6559,16 @@ void* picture_decision_kernel(void *input_ptr)
         EB_GET_FULL_OBJECT(
             context_ptr->picture_analysis_results_input_fifo_ptr,
             &in_results_wrapper_ptr);
+        // Reset request of svt_av1_enc_reset, the pipeline is idle
+        if (in_results_wrapper_ptr->signal_semaphore) {
+            picture_decision_reset(thread_context_ptr);
+            svt_release_signal_object(in_results_wrapper_ptr);
+            continue;
+        }
 
         in_results_ptr = (PictureAnalysisResults*)in_results_wrapper_ptr->object_ptr;
         pcs_ptr = (PictureParentControlSet*)in_results_ptr->pcs_wrapper_ptr->object_ptr;
+        pipeline_stage_begin(pcs_ptr, SVT_AV1_STAGE_PICTURE_DECISION, 0);
         scs_ptr = (SequenceControlSet*)pcs_ptr->scs_wrapper_ptr->object_ptr;
         encode_context_ptr = (EncodeContext*)scs_ptr->encode_context_ptr;
         loop_count++;
@@ -6672,7 +6721,7 @@ void* picture_decision_kernel(void *input_ptr)
                 // Setup the PCS & SCS
                 pcs_ptr = (PictureParentControlSet*)encode_context_ptr->pre_assignment_buffer[encode_context_ptr->pre_assignment_buffer_count]->object_ptr;
                 // Set the POC Number
-                pcs_ptr->picture_number = ++current_input_poc;
+                pcs_ptr->picture_number = ++context_ptr->current_input_poc;
 
                 pcs_ptr->pred_structure = scs_ptr->static_config.pred_structure;
 
@@ -6729,6 +6778,10 @@ void* picture_decision_kernel(void *input_ptr)
                 encode_context_ptr->pre_assignment_buffer_idr_count += pcs_ptr->idr_flag;
                 encode_context_ptr->pre_assignment_buffer_count += 1;
 
+                // A forced key frame restarts the intra period
+                if ((pcs_ptr->param_update.flags & SVT_AV1_UPDATE_KEY_FRAME) && scs_ptr->intra_period_length > 0)
+                    encode_context_ptr->intra_period_position = (uint32_t)scs_ptr->intra_period_length;
+
                 if (scs_ptr->static_config.rate_control_mode)
                 {
                     // Increment the Intra Period Position
@@ -6823,6 +6876,11 @@ void* picture_decision_kernel(void *input_ptr)
                     for (mini_gop_index = 0; mini_gop_index < context_ptr->total_number_of_mini_gops; ++mini_gop_index) {
                         pre_assignment_buffer_first_pass_flag = EB_TRUE;
                         encode_context_ptr->is_mini_gop_changed = EB_FALSE;
+                        // Runtime parameter updates take effect at the mini-gop boundary
+                        param_update_mini_gop(encode_context_ptr,
+                                              encode_context_ptr->pre_assignment_buffer,
+                                              context_ptr->mini_gop_start_index[mini_gop_index],
+                                              context_ptr->mini_gop_end_index[mini_gop_index]);
                         {
                             update_base_layer_reference_queue_dependent_count(
                                 context_ptr,
@@ -6943,6 +7001,9 @@ void* picture_decision_kernel(void *input_ptr)
                                     svt_release_object(pcs_ptr->overlay_ppcs_ptr->input_picture_wrapper_ptr);
                                     // release the pa_reference_picture
                                     svt_release_object(pcs_ptr->overlay_ppcs_ptr->pa_reference_picture_wrapper_ptr);
+                                    // release the sequence control set, held twice by each parent pcs
+                                    svt_release_object(pcs_ptr->overlay_ppcs_ptr->scs_wrapper_ptr);
+                                    svt_release_object(pcs_ptr->overlay_ppcs_ptr->scs_wrapper_ptr);
                                     // release the parent pcs
                                     svt_release_object(pcs_ptr->overlay_ppcs_ptr->p_pcs_wrapper_ptr);
                                     pcs_ptr->overlay_ppcs_ptr = NULL;
@@ -7043,15 +7104,12 @@ void* picture_decision_kernel(void *input_ptr)
                                 if (scs_ptr->static_config.pred_structure == EB_PRED_RANDOM_ACCESS) {
                                     pic_index = out_stride_diff64 - context_ptr->mini_gop_start_index[mini_gop_index];
                                 } else {
-                                    // For low delay P or low delay b case, get the the picture_index by mini_gop size
-                                    if (scs_ptr->static_config.intra_period_length >= 0) {
-                                        pic_index = (pcs_ptr->picture_number == 0) ? 0 :
-                                            (uint32_t)(((pcs_ptr->picture_number - 1) % (scs_ptr->static_config.intra_period_length+1)) % pcs_ptr->pred_struct_ptr->pred_struct_period);
-                                    } else {
-                                        // intra-period=-1 case, no gop
-                                        pic_index = (pcs_ptr->picture_number == 0) ? 0 :
-                                            (uint32_t)((pcs_ptr->picture_number - 1) % pcs_ptr->pred_struct_ptr->pred_struct_period);
-                                    }
+                                    // For low delay P or low delay b case, get the the picture_index by mini_gop size,
+                                    // counted from the last intra picture as a key frame can be forced anywhere
+                                    if (pcs_ptr->slice_type == I_SLICE)
+                                        context_ptr->last_intra_picture_number = pcs_ptr->picture_number;
+                                    pic_index = (pcs_ptr->picture_number == context_ptr->last_intra_picture_number) ? 0 :
+                                        (uint32_t)((pcs_ptr->picture_number - context_ptr->last_intra_picture_number - 1) % pcs_ptr->pred_struct_ptr->pred_struct_period);
                                 }
                                 if(scs_ptr->static_config.enable_manual_pred_struct){
                                     av1_generate_rps_ref_poc_from_user_config(pcs_ptr);
@@ -7143,6 +7201,11 @@ void* picture_decision_kernel(void *input_ptr)
                                 else
                                     pcs_ptr->sc_content_detected = context_ptr->last_i_picture_sc_detection;
 #endif
+                                // The temporal layer is known, pick the preset before the signals derive from it
+                                if (scs_ptr->static_config.speed_control_flag)
+                                    pcs_ptr->enc_mode = speed_control_pick_preset(scs_ptr, pcs_ptr);
+                                else
+                                    pcs_ptr->enc_mode = (EbEncMode)svt_atomic_load_u32(&encode_context_ptr->enc_mode);
 #if TUNE_REDESIGN_TF_CTRLS
                                 // TODO: put this in EbMotionEstimationProcess?
                                 copy_tf_params(scs_ptr, pcs_ptr);
@@ -91,6 +91,7 @@ typedef struct PictureDecisionContext {
     uint8_t  lay0_toggle; //3 way toggle 0->1->2
     uint8_t  lay1_toggle; //2 way toggle 0->1
     uint8_t  lay2_toggle; //2 way toggle 0->1
+    uint64_t last_intra_picture_number; //low delay: the intra picture the mini-gops are counted from
     EbBool
         mini_gop_toggle; //mini GOP toggling since last Key Frame  K-0-1-0-1-0-K-0-1-0-1-K-0-1.....
 #if FTR_ALIGN_SC_DETECOR
@@ -101,6 +102,7 @@ typedef struct PictureDecisionContext {
     uint8_t                  last_i_picture_sc_detection;
 #endif
     uint64_t                 key_poc;
+    int64_t                  current_input_poc; //poc of the last picture put in the pre-assignment buffer
     uint8_t                  tf_level;
     PictureParentControlSet *mg_pictures_array[1 << MAX_TEMPORAL_LAYERS];
     DepCntPicInfo            updated_links_arr
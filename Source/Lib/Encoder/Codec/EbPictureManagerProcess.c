@@ -25,6 +25,7 @@
 #include "EbSvtAv1ErrorCodes.h"
 #include "EbEntropyCoding.h"
 #include "EbLog.h"
+#include "EbPipelineStats.h"
 
 // Token buffer is only used for palette tokens.
 static INLINE unsigned int get_token_alloc(int mb_rows, int mb_cols, int sb_size_log2,
@@ -109,6 +110,13 @@ EbErrorType picture_manager_context_ctor(EbThreadContext *  thread_context_ptr,
     return EB_ErrorNone;
 }
 
+/* Restarts the decode order counts for a new sequence */
+static void picture_manager_reset(EbThreadContext *thread_context_ptr) {
+    PictureManagerContext *context_ptr = (PictureManagerContext *)thread_context_ptr->priv;
+    context_ptr->pmgr_dec_order        = 0;
+    context_ptr->ref_dec_order         = 0;
+}
+
 void copy_buffer_info(EbPictureBufferDesc *src_ptr, EbPictureBufferDesc *dst_ptr){
     dst_ptr->width = src_ptr->width;
     dst_ptr->height = src_ptr->height;
@@ -636,13 +644,18 @@ void *picture_manager_kernel(void *input_ptr) {
     // Initialization
     uint8_t                     pic_width_in_sb;
     uint8_t                     picture_height_in_sb;
-    uint64_t decode_order = 0;
     // Debug
     uint32_t loop_count = 0;
 
     for (;;) {
         // Get Input Full Object
         EB_GET_FULL_OBJECT(context_ptr->picture_input_fifo_ptr, &input_picture_demux_wrapper_ptr);
+        // Reset request of svt_av1_enc_reset, the pipeline is idle
+        if (input_picture_demux_wrapper_ptr->signal_semaphore) {
+            picture_manager_reset(thread_context_ptr);
+            svt_release_signal_object(input_picture_demux_wrapper_ptr);
+            continue;
+        }
 
         input_picture_demux_ptr =
             (PictureDemuxResults *)input_picture_demux_wrapper_ptr->object_ptr;
@@ -658,6 +671,7 @@ void *picture_manager_kernel(void *input_ptr) {
                 (PictureParentControlSet *)input_picture_demux_ptr->pcs_wrapper_ptr->object_ptr;
             scs_ptr            = (SequenceControlSet *)pcs_ptr->scs_wrapper_ptr->object_ptr;
             encode_context_ptr = scs_ptr->encode_context_ptr;
+            pipeline_stage_begin(pcs_ptr, SVT_AV1_STAGE_PICTURE_MANAGER, 0);
 
             //SVT_LOG("\nPicture Manager Process @ %d \n ", pcs_ptr->picture_number);
                 pred_position_ptr = pcs_ptr->pred_struct_ptr
@@ -830,8 +844,8 @@ void *picture_manager_kernel(void *input_ptr) {
                 (reference_queue_index != encode_context_ptr->reference_picture_queue_tail_index) &&
                 (reference_entry_ptr->picture_number != input_picture_demux_ptr->picture_number));
             // Update the last decode order
-            if(input_picture_demux_ptr->decode_order == decode_order)
-                decode_order++;
+            if(input_picture_demux_ptr->decode_order == context_ptr->ref_dec_order)
+                context_ptr->ref_dec_order++;
 
             //keep the release of SCS here because we still need the encodeContext structure here
             // Release the Reference's SequenceControlSet
@@ -868,7 +882,7 @@ void *picture_manager_kernel(void *input_ptr) {
                         (SequenceControlSet *)entry_pcs_ptr->scs_wrapper_ptr->object_ptr;
 
                     availability_flag = EB_TRUE;
-                    if (entry_pcs_ptr->decode_order != decode_order &&
+                    if (entry_pcs_ptr->decode_order != context_ptr->ref_dec_order &&
 #if FTR_VBR_MT_REMOVE_DEC_ORDER
                         (scs_ptr->enable_dec_order ))
 #else
@@ -31,6 +31,7 @@ typedef struct PictureManagerContext {
     EbFifo * recon_coef_fifo_ptr;
 #endif
     uint64_t pmgr_dec_order;
+    uint64_t ref_dec_order; //decode order of the next reference to arrive
 } PictureManagerContext;
 /***************************************
      * Extern Function Declaration
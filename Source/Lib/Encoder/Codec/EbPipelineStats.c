@@ -0,0 +1,95 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#include <string.h>
+
+#include "EbPipelineStats.h"
+#include "EbSequenceControlSet.h"
+#include "EbThreads.h"
+#include "EbTime.h"
+
+const char *const pipeline_stage_names[SVT_AV1_STAGE_COUNT] = {
+    "resource_coordination",
+    "picture_analysis",
+    "picture_decision",
+    "motion_estimation",
+    "initial_rate_control",
+    "source_based_operations",
+    "tpl_dispenser",
+    "picture_manager",
+    "inloop_me",
+    "rate_control",
+    "mode_decision_configuration",
+    "enc_dec",
+    "dlf",
+    "cdef",
+    "restoration",
+    "entropy_coding",
+    "packetization",
+};
+
+void pipeline_picture_start(PictureParentControlSet *pcs_ptr, SvtAv1PipelineStage stage) {
+    for (uint32_t i = 0; i < SVT_AV1_STAGE_COUNT; i++) pcs_ptr->stage_time_ns[i] = 0;
+    pcs_ptr->stage_time_ns[stage] = svt_av1_get_time_ns();
+}
+
+void pipeline_stage_begin(PictureParentControlSet *pcs_ptr, SvtAv1PipelineStage stage,
+                          uint32_t segment_index) {
+    if (!svt_atomic_load_u64(&pcs_ptr->stage_time_ns[stage]))
+        svt_atomic_cas_u64(&pcs_ptr->stage_time_ns[stage], 0, svt_av1_get_time_ns());
+    svt_trace_begin(pcs_ptr->scs_ptr->encode_context_ptr->tracer_ptr,
+                    stage,
+                    pcs_ptr->picture_number,
+                    segment_index);
+}
+
+void pipeline_trace_begin(EncodeContext *encode_context_ptr, SvtAv1PipelineStage stage,
+                          uint64_t picture_number, uint32_t segment_index) {
+    svt_trace_begin(encode_context_ptr->tracer_ptr, stage, picture_number, segment_index);
+}
+
+static uint64_t pipeline_time_us(const EncodeContext *encode_context_ptr, uint64_t time_ns) {
+    return time_ns > encode_context_ptr->pipeline_start_ns
+        ? (time_ns - encode_context_ptr->pipeline_start_ns) / 1000
+        : 0;
+}
+
+void pipeline_picture_done(EncodeContext *encode_context_ptr, PictureParentControlSet *pcs_ptr) {
+    const uint64_t done_ns = svt_av1_get_time_ns();
+
+    svt_block_on_mutex(encode_context_ptr->picture_timing_mutex);
+    SvtAv1PictureTiming *timing =
+        &encode_context_ptr->picture_timing[encode_context_ptr->picture_timing_head];
+    timing->picture_number = pcs_ptr->picture_number;
+    for (uint32_t i = 0; i < SVT_AV1_STAGE_COUNT; i++)
+        timing->stage_us[i] = pcs_ptr->stage_time_ns[i]
+            ? pipeline_time_us(encode_context_ptr, pcs_ptr->stage_time_ns[i])
+            : 0;
+    timing->done_us = pipeline_time_us(encode_context_ptr, done_ns);
+    encode_context_ptr->picture_timing_head = (encode_context_ptr->picture_timing_head + 1) %
+        SVT_AV1_PICTURE_TIMING_HISTORY;
+    if (encode_context_ptr->picture_timing_count < SVT_AV1_PICTURE_TIMING_HISTORY)
+        encode_context_ptr->picture_timing_count++;
+    svt_release_mutex(encode_context_ptr->picture_timing_mutex);
+}
+
+uint32_t pipeline_picture_history(EncodeContext *encode_context_ptr, SvtAv1PictureTiming *timing_array) {
+    svt_block_on_mutex(encode_context_ptr->picture_timing_mutex);
+    const uint32_t count = encode_context_ptr->picture_timing_count;
+    const uint32_t first = (encode_context_ptr->picture_timing_head +
+                            SVT_AV1_PICTURE_TIMING_HISTORY - count) %
+        SVT_AV1_PICTURE_TIMING_HISTORY;
+    for (uint32_t i = 0; i < count; i++)
+        timing_array[i] =
+            encode_context_ptr->picture_timing[(first + i) % SVT_AV1_PICTURE_TIMING_HISTORY];
+    svt_release_mutex(encode_context_ptr->picture_timing_mutex);
+    return count;
+}
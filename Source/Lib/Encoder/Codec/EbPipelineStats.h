@@ -0,0 +1,50 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#ifndef EbPipelineStats_h
+#define EbPipelineStats_h
+
+#include "EbPictureControlSet.h"
+#include "EbEncodeContext.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bound on the events of a pipeline trace, ~128MB */
+#define PIPELINE_TRACE_MAX_EVENTS (1 << 22)
+
+/* Names of the pipeline stages, indexed by SvtAv1PipelineStage */
+extern const char *const pipeline_stage_names[SVT_AV1_STAGE_COUNT];
+
+/* Clears the stage timestamps of a new picture and stamps stage */
+void pipeline_picture_start(PictureParentControlSet *pcs_ptr, SvtAv1PipelineStage stage);
+
+/* Records when stage first takes the picture; later calls are ignored,
+ * e.g. from the other segments of a multi-threaded stage. Also starts
+ * the trace event of this invocation when tracing. */
+void pipeline_stage_begin(PictureParentControlSet *pcs_ptr, SvtAv1PipelineStage stage,
+                          uint32_t segment_index);
+
+/* Starts a trace event only, for the stages that do not see the parent picture */
+void pipeline_trace_begin(EncodeContext *encode_context_ptr, SvtAv1PipelineStage stage,
+                          uint64_t picture_number, uint32_t segment_index);
+
+/* Copies the picture timestamps to the encode context history */
+void pipeline_picture_done(EncodeContext *encode_context_ptr, PictureParentControlSet *pcs_ptr);
+
+/* Copies the history, oldest first, and returns the number of entries */
+uint32_t pipeline_picture_history(EncodeContext *encode_context_ptr, SvtAv1PictureTiming *timing_array);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // EbPipelineStats_h
@@ -7906,8 +7906,14 @@ static void search_best_independent_uv_mode(PictureControlSet *  pcs_ptr,
 
     // Sort uv_mode (in terms of distortion only)
 #if CLN_MD_CAND_BUFF
-    uint32_t *uv_cand_buff_indices = (uint32_t *)malloc(context_ptr->max_nics_uv *
-                                                        sizeof(*uv_cand_buff_indices));
+    const EbArenaMark uv_mark              = svt_arena_mark(context_ptr->scratch_arena);
+    uint32_t *        uv_cand_buff_indices = (uint32_t *)svt_arena_alloc(
+        context_ptr->scratch_arena, context_ptr->max_nics_uv * sizeof(*uv_cand_buff_indices));
+    if (!uv_cand_buff_indices) {
+        // Out of memory: no independent chroma mode, as when chroma is done at the last stage
+        init_chroma_mode(context_ptr);
+        return;
+    }
     memset(uv_cand_buff_indices, 0xFF, context_ptr->max_nics_uv * sizeof(*uv_cand_buff_indices));
 
 #else
@@ -8102,7 +8108,7 @@ static void search_best_independent_uv_mode(PictureControlSet *  pcs_ptr,
     }
 
 #if CLN_MD_CAND_BUFF
-    free(uv_cand_buff_indices);
+    svt_arena_rewind(context_ptr->scratch_arena, uv_mark);
 #endif
 }
 void interintra_class_pruning_1(ModeDecisionContext *context_ptr, uint64_t best_md_stage_cost,
@@ -34,6 +34,7 @@
 #include "EbLog.h"
 #include "EbIntraPrediction.h"
 #include "EbMotionEstimation.h"
+#include "EbPipelineStats.h"
 #if TUNE_6L_4L_TPL
 static const double tpl_hl_islice_div_factor[EB_MAX_TEMPORAL_LAYERS] = { 1, 1, 1, 2, 1, 0.8 };
 static const double tpl_hl_base_frame_div_factor[EB_MAX_TEMPORAL_LAYERS] = { 1, 1, 1, 3, 1, 0.7 };
@@ -2639,6 +2640,19 @@ EbErrorType rate_control_context_ctor(EbThreadContext *  thread_context_ptr,
 
     return EB_ErrorNone;
 }
+
+/* Clears the key frame group state of the intervals for a new sequence */
+static void rate_control_reset(EbThreadContext *thread_context_ptr) {
+#if FTR_VBR_MT
+    RateControlContext *context_ptr = (RateControlContext *)thread_context_ptr->priv;
+    for (uint32_t interval_index = 0; interval_index < PARALLEL_GOP_MAX_NUMBER; interval_index++) {
+        context_ptr->rate_control_param_queue[interval_index]->kf_group_bits       = 0;
+        context_ptr->rate_control_param_queue[interval_index]->kf_group_error_left = 0;
+    }
+#else
+    (void)thread_context_ptr;
+#endif
+}
 #if !CLN_OLD_RC
 uint64_t predict_bits(EncodeContext *              encode_context_ptr,
                       HlRateControlHistogramEntry *hl_rate_control_histogram_ptr_temp, uint32_t qp,
@@ -6080,7 +6094,10 @@ static int inter_minq_8[QINDEX_RANGE] = {
     196, 197, 199, 199, 200, 201, 203, 203, 205, 206, 207, 208, 209, 210, 211, 212, 213, 214, 215,
     216, 217, 219, 220, 221, 222, 223, 225, 226, 227, 228, 230, 231, 232, 234, 235, 236, 238, 239,
     240, 242, 243, 245, 246, 248, 250, 251, 253};
-/*
+/* Best q index of the real time inter pictures per worst q index, the
+ * rtc_minq_* tables of libaom init_minq_luts(): the first q index whose q
+ * reaches 0.00000271 * q^3 - 0.00113 * q^2 + 0.70 * q of the worst q, 0 when
+ * that is 2 or less. inter_minq_* is the same curve with 0.90 * q. */
 static int rtc_minq_8[QINDEX_RANGE] = {
         0, 0, 0, 0, 0, 2, 3, 3, 4, 5, 5, 6, 7, 7, 8,
         9, 9, 10, 11, 12, 12, 13, 14, 14, 15, 16, 16, 17, 18, 18,
@@ -6100,7 +6117,6 @@ static int rtc_minq_8[QINDEX_RANGE] = {
         197, 199, 200, 201, 202, 203, 205, 206, 207, 208, 210, 211, 212, 214, 215,
         216, 218, 219, 221, 222, 224, 225, 227, 229, 230, 232, 234, 235, 237, 239,
         241};
-*/
 
 static int kf_high_motion_minq_10[QINDEX_RANGE] = {
     0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
@@ -6165,7 +6181,7 @@ static int inter_minq_10[QINDEX_RANGE] = {
     196, 197, 199, 199, 200, 201, 203, 204, 205, 206, 207, 208, 209, 210, 211, 212, 213, 214, 215,
     216, 218, 219, 220, 221, 222, 223, 225, 226, 227, 228, 230, 231, 232, 234, 235, 236, 238, 239,
     240, 242, 243, 245, 246, 248, 250, 251, 253};
-/*
+// Same fit as rtc_minq_8, with the 10 bit q
 static int rtc_minq_10[QINDEX_RANGE] = {
         0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 11,
         11, 12, 13, 13, 14, 15, 16, 16, 17, 18, 19, 19, 20, 21, 22,
@@ -6185,7 +6201,6 @@ static int rtc_minq_10[QINDEX_RANGE] = {
         198, 199, 200, 201, 202, 203, 205, 206, 207, 208, 210, 211, 212, 214, 215,
         216, 218, 219, 221, 222, 224, 225, 227, 229, 230, 232, 234, 235, 237, 239,
         241};
-*/
 
 static int kf_high_motion_minq_12[QINDEX_RANGE] = {
     0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
@@ -6250,7 +6265,7 @@ static int inter_minq_12[QINDEX_RANGE] = {
     196, 197, 199, 199, 200, 201, 203, 204, 205, 206, 207, 208, 209, 210, 211, 212, 213, 214, 215,
     216, 217, 219, 220, 221, 222, 223, 225, 226, 227, 228, 230, 231, 232, 234, 235, 236, 238, 239,
     240, 242, 243, 245, 246, 248, 250, 251, 253};
-/*
+// Same fit as rtc_minq_8, with the 12 bit q
 static int rtc_minq_12[QINDEX_RANGE] = {
         0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
         0, 0, 13, 14, 15, 16, 16, 17, 18, 19, 19, 20, 21, 22, 22,
@@ -6270,7 +6285,6 @@ static int rtc_minq_12[QINDEX_RANGE] = {
         197, 199, 200, 201, 202, 203, 205, 206, 207, 208, 210, 211, 212, 214, 215,
         216, 218, 219, 221, 222, 224, 225, 227, 229, 230, 232, 234, 235, 237, 239,
         241};
-*/
 
 static int gf_high_tpl_la = 2400;
 static int gf_low_tpl_la  = 300;
@@ -7073,7 +7087,7 @@ void set_rc_buffer_sizes(SequenceControlSet *scs_ptr) {
     EncodeContext *       encode_context_ptr = scs_ptr->encode_context_ptr;
     RATE_CONTROL *        rc                 = &encode_context_ptr->rc;
     RateControlCfg *const rc_cfg             = &encode_context_ptr->rc_cfg;
-    const int64_t         bandwidth          = scs_ptr->static_config.target_bit_rate;
+    const int64_t         bandwidth          = rc_cfg->target_bandwidth;
     const int64_t         starting           = rc_cfg->starting_buffer_level_ms;
     const int64_t         optimal            = rc_cfg->optimal_buffer_level_ms;
     const int64_t         maximum            = rc_cfg->maximum_buffer_size_ms;
@@ -7101,7 +7115,7 @@ static void av1_rc_init(SequenceControlSet *scs_ptr) {
     const uint32_t              height             = scs_ptr->seq_header.max_frame_height;
     int                         i;
 
-    if (0 /*pass == 0*/ && rc_cfg->mode == AOM_CBR) {
+    if (rc_cfg->mode == AOM_CBR) {
         rc->avg_frame_qindex[KEY_FRAME]   = rc_cfg->worst_allowed_q;
         rc->avg_frame_qindex[INTER_FRAME] = rc_cfg->worst_allowed_q;
     } else {
@@ -7471,6 +7485,18 @@ static int get_active_best_quality(PictureControlSet *pcs_ptr, const int active_
     return active_best_quality;
 }
 
+// CBR: the correction factors follow the temporal layer, there is no gf group
+static rate_factor_level cbr_rate_factor_level(const PictureParentControlSet *ppcs_ptr) {
+    if (ppcs_ptr->temporal_layer_index == ppcs_ptr->hierarchical_levels)
+        return INTER_NORMAL;
+    switch (ppcs_ptr->temporal_layer_index) {
+    case 0: return GF_ARF_STD;
+    case 1: return GF_ARF_LOW;
+    case 2: return INTER_HIGH;
+    default: return INTER_LOW;
+    }
+}
+
 static double get_rate_correction_factor(PictureParentControlSet *ppcs_ptr/*,
                                          int width, int height*/) {
     SequenceControlSet *scs_ptr            = ppcs_ptr->scs_ptr;
@@ -7481,6 +7507,8 @@ static double get_rate_correction_factor(PictureParentControlSet *ppcs_ptr/*,
 
     if (ppcs_ptr->frm_hdr.frame_type == KEY_FRAME) {
         rcf = rc->rate_correction_factors[KF_STD];
+    } else if (encode_context_ptr->rc_cfg.mode == AOM_CBR) {
+        rcf = rc->rate_correction_factors[cbr_rate_factor_level(ppcs_ptr)];
     } else {
         const rate_factor_level rf_lvl = get_rate_factor_level(&encode_context_ptr->gf_group,
                                                                ppcs_ptr->gf_group_index);
@@ -7504,6 +7532,8 @@ static void set_rate_correction_factor(PictureParentControlSet *ppcs_ptr, double
 
     if (ppcs_ptr->frm_hdr.frame_type == KEY_FRAME) {
         rc->rate_correction_factors[KF_STD] = factor;
+    } else if (encode_context_ptr->rc_cfg.mode == AOM_CBR) {
+        rc->rate_correction_factors[cbr_rate_factor_level(ppcs_ptr)] = factor;
     } else {
         const rate_factor_level rf_lvl      = get_rate_factor_level(&encode_context_ptr->gf_group,
                                                                ppcs_ptr->gf_group_index);
@@ -8156,6 +8186,306 @@ static void av1_set_target_rate(PictureControlSet *pcs_ptr, int width, int heigh
     av1_rc_set_frame_target(pcs_ptr, target_rate, width, height);
 }
 
+/******************************************************
+ * One pass CBR
+ * Leaky bucket: the channel fills the buffer with the average frame bandwidth
+ * per picture and each picture empties it of its size, a buffer under 0 is a
+ * VBV overflow. A picture is charged its target when it enters rate control
+ * and its actual size replaces the target when packetization feeds it back,
+ * so the level seen by a picture covers the pictures still in the pipeline.
+ ******************************************************/
+/* Share of the mini-gop budget per temporal layer, counted down from the top
+ * layer, in 1/16: the pictures referenced by more pictures get more bits */
+static const int cbr_layer_weight[MAX_TEMPORAL_LAYERS] = {16, 20, 26, 34, 44, 56};
+
+static void cbr_init(SequenceControlSet *scs_ptr, PictureParentControlSet *ppcs_ptr) {
+    set_rc_param(scs_ptr, ppcs_ptr);
+    svt_av1_new_framerate(scs_ptr,
+                          scs_ptr->frame_rate > 1000 ? (double)scs_ptr->frame_rate / (1 << 16)
+                                                     : (double)scs_ptr->frame_rate);
+    set_rc_buffer_sizes(scs_ptr);
+    av1_rc_init(scs_ptr);
+    scs_ptr->encode_context_ptr->rc.kf_boost = DEFAULT_KF_BOOST;
+    memset(scs_ptr->encode_context_ptr->rc.cbr_last_q,
+           0,
+           sizeof(scs_ptr->encode_context_ptr->rc.cbr_last_q));
+}
+
+// Average frame bandwidth of the target bit rate the picture is coded with. A
+// picture of the mini-gop before an update can reach rate control after the
+// update is applied, see rc_apply_update()
+static int cbr_frame_bandwidth(const SequenceControlSet *     scs_ptr,
+                               const PictureParentControlSet *ppcs_ptr) {
+    const EncodeContext *encode_context_ptr = scs_ptr->encode_context_ptr;
+    if (ppcs_ptr->rc_update_id == encode_context_ptr->rc_update_applied)
+        return encode_context_ptr->rc.avg_frame_bandwidth;
+    return (int)(ppcs_ptr->rc_target_bit_rate / scs_ptr->double_frame_rate);
+}
+
+static int cbr_iframe_target(SequenceControlSet *scs_ptr, PictureParentControlSet *ppcs_ptr) {
+    RATE_CONTROL *rc                  = &scs_ptr->encode_context_ptr->rc;
+    const int     avg_frame_bandwidth = cbr_frame_bandwidth(scs_ptr, ppcs_ptr);
+    int           target;
+    if (ppcs_ptr->picture_number == 0)
+        target = (int)AOMMIN(rc->starting_buffer_level / 2, INT_MAX);
+    else {
+        const double framerate = scs_ptr->double_frame_rate;
+        int          kf_boost  = AOMMAX(32, (int)(2 * framerate - 16));
+        if (rc->frames_since_key < framerate / 2)
+            kf_boost = (int)(kf_boost * rc->frames_since_key / (framerate / 2));
+        target = ((16 + kf_boost) * avg_frame_bandwidth) >> 4;
+    }
+    return AOMMIN(target, rc->max_frame_bandwidth);
+}
+
+static int cbr_pframe_target(SequenceControlSet *scs_ptr, PictureParentControlSet *ppcs_ptr) {
+    EncodeContext *             encode_context_ptr = scs_ptr->encode_context_ptr;
+    RATE_CONTROL *              rc                 = &encode_context_ptr->rc;
+    const RateControlCfg *const rc_cfg             = &encode_context_ptr->rc_cfg;
+    const uint32_t levels = AOMMIN(ppcs_ptr->hierarchical_levels, MAX_TEMPORAL_LAYERS - 1);
+    const uint32_t layer  = AOMMIN(ppcs_ptr->temporal_layer_index, levels);
+    const int      avg_frame_bandwidth = cbr_frame_bandwidth(scs_ptr, ppcs_ptr);
+
+    // The layers of a mini-gop of 1 << levels pictures share its budget
+    int64_t weight_sum = 0;
+    for (uint32_t l = 0; l <= levels; l++)
+        weight_sum += (int64_t)cbr_layer_weight[levels - l] << (l ? l - 1 : 0);
+    int target = (int)(((int64_t)avg_frame_bandwidth * cbr_layer_weight[levels - layer]
+                        << levels) /
+                       weight_sum);
+
+    // Steer the buffer back to its optimal level
+    const int64_t diff         = rc->optimal_buffer_level - rc->buffer_level;
+    const int64_t one_pct_bits = 1 + rc->optimal_buffer_level / 100;
+    if (diff > 0)
+        target -= (int)((int64_t)target * AOMMIN(diff / one_pct_bits, rc_cfg->under_shoot_pct) /
+                        200);
+    else if (diff < 0)
+        target += (int)((int64_t)target * AOMMIN(-diff / one_pct_bits, rc_cfg->over_shoot_pct) /
+                        200);
+    return AOMMIN(AOMMAX(AOMMAX(avg_frame_bandwidth >> 4, FRAME_OVERHEAD_BITS), target),
+                  rc->max_frame_bandwidth);
+}
+
+// Worst q from the buffer level: below the ambient q of the top layer when
+// the buffer is above its optimal level, up to the worst q allowed when it
+// gets to the critical level.
+static int cbr_active_worst_quality(PictureParentControlSet *ppcs_ptr) {
+    RATE_CONTROL *rc             = &ppcs_ptr->scs_ptr->encode_context_ptr->rc;
+    const int64_t critical_level = rc->optimal_buffer_level >> 3;
+    if (frame_is_intra_only(ppcs_ptr))
+        return rc->worst_quality;
+    // The key frame q weighs in for the first pictures after it
+    const int ambient_qp = rc->frames_since_key < 5
+        ? AOMMIN(rc->avg_frame_qindex[INTER_FRAME], rc->avg_frame_qindex[KEY_FRAME])
+        : rc->avg_frame_qindex[INTER_FRAME];
+    int active_worst_quality = AOMMIN(rc->worst_quality, ambient_qp * 5 / 4);
+    if (rc->buffer_level > rc->optimal_buffer_level) {
+        // Down by up to a third when the buffer is full
+        const int max_adjustment_down = active_worst_quality / 3;
+        if (max_adjustment_down) {
+            const int64_t buff_lvl_step = (rc->maximum_buffer_size - rc->optimal_buffer_level) /
+                max_adjustment_down;
+            if (buff_lvl_step)
+                active_worst_quality -= (int)((rc->buffer_level - rc->optimal_buffer_level) /
+                                              buff_lvl_step);
+        }
+    } else if (rc->buffer_level > critical_level) {
+        const int64_t buff_lvl_step = rc->optimal_buffer_level - critical_level;
+        active_worst_quality        = ambient_qp;
+        if (buff_lvl_step)
+            active_worst_quality += (int)((rc->worst_quality - ambient_qp) *
+                                          (rc->optimal_buffer_level - rc->buffer_level) /
+                                          buff_lvl_step);
+    } else
+        active_worst_quality = rc->worst_quality;
+    return active_worst_quality;
+}
+
+// Bits the buffer can still give the picture without underflowing: its level,
+// with the pictures in flight charged, and what the channel brings meanwhile
+static int cbr_bits_left(const RATE_CONTROL *rc, int avg_frame_bandwidth) {
+    return (int)AOMMIN(AOMMAX(rc->buffer_level + avg_frame_bandwidth, 0), INT_MAX);
+}
+
+// How many times the size estimate of the picture may miss. The correction
+// factors follow the actual sizes, but the slope of the q model does not:
+// noisy content costs more at low q than it predicts. The key frames have no
+// picture to learn from, their miss follows the mean 8x8 source variance.
+static int cbr_size_miss(const PictureParentControlSet *ppcs_ptr) {
+    if (!frame_is_intra_only(ppcs_ptr))
+        return 2;
+    uint64_t variance = 0;
+    for (uint16_t sb_index = 0; sb_index < ppcs_ptr->sb_total_count; ++sb_index)
+        for (uint32_t blk = 0; blk < 64; blk++)
+            variance += ppcs_ptr->variance[sb_index][ME_TIER_ZERO_PU_8x8_0 + blk];
+    variance /= 64 * ppcs_ptr->sb_total_count;
+    return (int)AOMMAX(2, AOMMIN(variance >> 4, 64));
+}
+
+static int cbr_pick_q(PictureParentControlSet *ppcs_ptr, int target) {
+    RATE_CONTROL *rc        = &ppcs_ptr->scs_ptr->encode_context_ptr->rc;
+    const int     bit_depth = ppcs_ptr->scs_ptr->static_config.encoder_bit_depth;
+    const int     width     = ppcs_ptr->av1_cm->frm_size.frame_width;
+    const int     height    = ppcs_ptr->av1_cm->frm_size.frame_height;
+    int           active_worst_quality = cbr_active_worst_quality(ppcs_ptr);
+    int           active_best_quality  = rc->best_quality;
+    const int     avg_frame_bandwidth  = cbr_frame_bandwidth(ppcs_ptr->scs_ptr, ppcs_ptr);
+    int *         rtc_minq;
+    ASSIGN_MINQ_TABLE(bit_depth, rtc_minq);
+
+    if (frame_is_intra_only(ppcs_ptr)) {
+        if (ppcs_ptr->picture_number > 0) {
+            active_best_quality = get_kf_active_quality_tpl(
+                rc, rc->avg_frame_qindex[KEY_FRAME], bit_depth);
+            // Allow somewhat lower kf minq with small image formats
+            if (width * height <= 352 * 288) {
+                const double q_val = svt_av1_convert_qindex_to_q(active_best_quality, bit_depth);
+                active_best_quality += svt_av1_compute_qdelta(q_val, q_val * 0.75, bit_depth);
+            }
+        }
+    } else {
+        const FrameType frame_type = rc->frames_since_key > 1 ? INTER_FRAME : KEY_FRAME;
+        active_best_quality =
+            rtc_minq[AOMMIN(rc->avg_frame_qindex[frame_type], active_worst_quality)];
+    }
+    active_best_quality  = clamp(active_best_quality, rc->best_quality, rc->worst_quality);
+    active_worst_quality = clamp(active_worst_quality, active_best_quality, rc->worst_quality);
+
+    int q = av1_rc_regulate_q(
+        ppcs_ptr, target, active_best_quality, active_worst_quality, width, height);
+    q     = AOMMIN(q, active_worst_quality);
+
+    // Below the optimal level, limit the decrease in q from the last picture
+    // of the level, as adjust_q_cbr() of libaom does
+    const int last_q = rc->cbr_last_q[frame_is_intra_only(ppcs_ptr)
+                                          ? KF_STD
+                                          : cbr_rate_factor_level(ppcs_ptr)];
+    if (last_q && rc->buffer_level < rc->optimal_buffer_level)
+        q = AOMMAX(q, last_q - AOMMIN(16, AOMMAX(1, last_q >> 3)));
+
+    // And never below the q the bits left can pay for, whatever the active
+    // range
+    const int buffer_q = av1_rc_regulate_q(ppcs_ptr,
+                                           cbr_bits_left(rc, avg_frame_bandwidth) /
+                                               cbr_size_miss(ppcs_ptr),
+                                           rc->best_quality,
+                                           rc->worst_quality,
+                                           width,
+                                           height);
+    return AOMMAX(q, buffer_q);
+}
+
+void frame_level_rc_input_picture_cbr(PictureControlSet *pcs_ptr, SequenceControlSet *scs_ptr) {
+    PictureParentControlSet *ppcs_ptr = pcs_ptr->parent_pcs_ptr;
+    RATE_CONTROL *           rc       = &scs_ptr->encode_context_ptr->rc;
+    int                      target;
+    int                      q;
+
+    if (pcs_ptr->picture_number == 0)
+        cbr_init(scs_ptr, ppcs_ptr);
+    const int avg_frame_bandwidth = cbr_frame_bandwidth(scs_ptr, ppcs_ptr);
+    if (rc->buffer_level < 0) {
+        // The pictures sent and in flight already overflow the buffer. The
+        // picture is not dropped, the pictures after it in the mini-gop may
+        // reference it: the q is clamped to the worst q allowed instead, with
+        // the smallest target charged
+        target = AOMMAX(avg_frame_bandwidth >> 4, FRAME_OVERHEAD_BITS);
+        q      = rc->worst_quality;
+    } else {
+        target = frame_is_intra_only(ppcs_ptr) ? cbr_iframe_target(scs_ptr, ppcs_ptr)
+                                               : cbr_pframe_target(scs_ptr, ppcs_ptr);
+        // Half the bits left at most, for the pictures behind it
+        target = AOMMAX(AOMMIN(target, cbr_bits_left(rc, avg_frame_bandwidth) / 2),
+                        FRAME_OVERHEAD_BITS);
+        q      = cbr_pick_q(ppcs_ptr, target);
+        rc->cbr_last_q[frame_is_intra_only(ppcs_ptr) ? KF_STD
+                                                     : cbr_rate_factor_level(ppcs_ptr)] = q;
+    }
+    rc->frames_since_key = frame_is_intra_only(ppcs_ptr) ? 0 : rc->frames_since_key + 1;
+
+    // Charge the target until the actual size is fed back
+    ppcs_ptr->this_frame_target = target;
+    rc->bits_off_target         = AOMMIN(rc->bits_off_target + avg_frame_bandwidth - target,
+                                 rc->maximum_buffer_size);
+    rc->buffer_level            = rc->bits_off_target;
+
+    ppcs_ptr->frm_hdr.quantization_params.base_q_idx = (uint8_t)q;
+    pcs_ptr->picture_qp                              = (uint8_t)((q + 2) >> 2);
+}
+
+void frame_level_rc_feedback_picture_cbr(PictureParentControlSet *ppcs_ptr,
+                                         SequenceControlSet *     scs_ptr) {
+    RATE_CONTROL *rc     = &scs_ptr->encode_context_ptr->rc;
+    const int     qindex = ppcs_ptr->frm_hdr.quantization_params.base_q_idx;
+
+    ppcs_ptr->projected_frame_size = (int)ppcs_ptr->total_num_bits;
+    av1_rc_update_rate_correction_factors(ppcs_ptr,
+                                          ppcs_ptr->av1_cm->frm_size.frame_width,
+                                          ppcs_ptr->av1_cm->frm_size.frame_height);
+    // The ambient q follows the key frames and the top layer, as the lower
+    // layers are coded below it
+    if (frame_is_intra_only(ppcs_ptr)) {
+        rc->last_q[KEY_FRAME]           = qindex;
+        rc->avg_frame_qindex[KEY_FRAME] = ROUND_POWER_OF_TWO(
+            3 * rc->avg_frame_qindex[KEY_FRAME] + qindex, 2);
+        rc->last_kf_qindex = qindex;
+    } else if (ppcs_ptr->temporal_layer_index == ppcs_ptr->hierarchical_levels) {
+        rc->last_q[INTER_FRAME]           = qindex;
+        rc->avg_frame_qindex[INTER_FRAME] = ROUND_POWER_OF_TWO(
+            3 * rc->avg_frame_qindex[INTER_FRAME] + qindex, 2);
+    }
+
+    // The actual size replaces the target charged at the input
+    rc->bits_off_target = AOMMIN(
+        rc->bits_off_target + ppcs_ptr->this_frame_target - ppcs_ptr->projected_frame_size,
+        rc->maximum_buffer_size);
+    rc->buffer_level = rc->bits_off_target;
+
+    rc->rolling_target_bits = (int)ROUND_POWER_OF_TWO_64(
+        rc->rolling_target_bits * 3 + ppcs_ptr->this_frame_target, 2);
+    rc->rolling_actual_bits = (int)ROUND_POWER_OF_TWO_64(
+        rc->rolling_actual_bits * 3 + ppcs_ptr->projected_frame_size, 2);
+    rc->total_actual_bits += ppcs_ptr->projected_frame_size;
+    rc->total_target_bits += rc->avg_frame_bandwidth;
+    rc->total_target_vs_actual = rc->total_actual_bits - rc->total_target_bits;
+}
+
+/* Sets the rate control parameters to the ones stamped on the picture by
+ * picture decision when it is the first to carry a new update. Pictures reach
+ * rate control in decode order, so the ones of the mini-gop before an update
+ * can follow the first picture it applies to: they do not undo it, the CBR
+ * model reads their own target bit rate (cbr_frame_bandwidth()) and the q
+ * clips their own QP range. */
+static void rc_apply_update(SequenceControlSet *scs_ptr, PictureParentControlSet *ppcs_ptr) {
+    EncodeContext *encode_context_ptr = scs_ptr->encode_context_ptr;
+    RATE_CONTROL * rc                 = &encode_context_ptr->rc;
+    if (ppcs_ptr->rc_update_id <= encode_context_ptr->rc_update_applied)
+        return;
+    encode_context_ptr->rc_update_applied = ppcs_ptr->rc_update_id;
+    // Without rate control the QP range only clips the picture QP
+    if (scs_ptr->static_config.rate_control_mode == 0)
+        return;
+    const int last_frame_bandwidth = rc->avg_frame_bandwidth;
+    set_rc_param(scs_ptr, ppcs_ptr);
+    svt_av1_new_framerate(scs_ptr, scs_ptr->double_frame_rate);
+    set_rc_buffer_sizes(scs_ptr);
+    rc->bits_off_target = AOMMIN(rc->bits_off_target, rc->maximum_buffer_size);
+    rc->buffer_level    = AOMMIN(rc->buffer_level, rc->maximum_buffer_size);
+    // A large change of the CBR target restarts the buffer at its optimal
+    // level and lets the q move freely, as check_reset_rc_flag() of libaom
+    // does, instead of converging from the state of the old target
+    if (encode_context_ptr->rc_cfg.mode == AOM_CBR &&
+        (rc->avg_frame_bandwidth > (3 * last_frame_bandwidth >> 1) ||
+         rc->avg_frame_bandwidth < (last_frame_bandwidth >> 1))) {
+        rc->bits_off_target = rc->optimal_buffer_level;
+        rc->buffer_level    = rc->optimal_buffer_level;
+        memset(rc->cbr_last_q, 0, sizeof(rc->cbr_last_q));
+    }
+    rc->worst_quality   = encode_context_ptr->rc_cfg.worst_allowed_q;
+    rc->best_quality    = encode_context_ptr->rc_cfg.best_allowed_q;
+}
+
 static double av1_get_compression_ratio(PictureParentControlSet *ppcs_ptr,
                                         size_t                   encoded_frame_size) {
     const int upscaled_width = ppcs_ptr->av1_cm->frm_size.superres_upscaled_width;
@@ -8490,8 +8820,8 @@ void recode_loop_update_q(PictureParentControlSet *ppcs_ptr, int *const loop, in
         *q = clamp(*q, *q_low, *q_high);
     }
 
-    *q    = (uint8_t)CLIP3((int32_t)quantizer_to_qindex[scs_ptr->static_config.min_qp_allowed],
-                        (int32_t)quantizer_to_qindex[scs_ptr->static_config.max_qp_allowed],
+    *q    = (uint8_t)CLIP3((int32_t)quantizer_to_qindex[ppcs_ptr->rc_min_qp_allowed],
+                        (int32_t)quantizer_to_qindex[ppcs_ptr->rc_max_qp_allowed],
                         *q);
     *loop = (*q != last_q);
 }
@@ -8649,6 +8979,12 @@ void *rate_control_kernel(void *input_ptr) {
         // Get RateControl Task
         EB_GET_FULL_OBJECT(context_ptr->rate_control_input_tasks_fifo_ptr,
                            &rate_control_tasks_wrapper_ptr);
+        // Reset request of svt_av1_enc_reset, the pipeline is idle
+        if (rate_control_tasks_wrapper_ptr->signal_semaphore) {
+            rate_control_reset(thread_context_ptr);
+            svt_release_signal_object(rate_control_tasks_wrapper_ptr);
+            continue;
+        }
 
         rate_control_tasks_ptr = (RateControlTasks *)rate_control_tasks_wrapper_ptr->object_ptr;
         task_type              = rate_control_tasks_ptr->task_type;
@@ -8657,6 +8993,9 @@ void *rate_control_kernel(void *input_ptr) {
         switch (task_type) {
         case RC_INPUT:
             pcs_ptr = (PictureControlSet *)rate_control_tasks_ptr->pcs_wrapper_ptr->object_ptr;
+            pipeline_stage_begin(pcs_ptr->parent_pcs_ptr,
+                                 SVT_AV1_STAGE_RATE_CONTROL,
+                                 rate_control_tasks_ptr->segment_index);
 
             // Set the segment counter
             pcs_ptr->parent_pcs_ptr->inloop_me_segments_completion_count++;
@@ -8672,6 +9011,7 @@ void *rate_control_kernel(void *input_ptr) {
             scs_ptr = (SequenceControlSet *)pcs_ptr->scs_wrapper_ptr->object_ptr;
             FrameHeader *frm_hdr                       = &pcs_ptr->parent_pcs_ptr->frm_hdr;
             pcs_ptr->parent_pcs_ptr->blk_lambda_tuning = EB_FALSE;
+            rc_apply_update(scs_ptr, pcs_ptr->parent_pcs_ptr);
 #if !TPL_KERNEL
             if (scs_ptr->in_loop_me)
 
@@ -8831,8 +9171,8 @@ void *rate_control_kernel(void *input_ptr) {
                     } else {
                         qindex += scs_ptr->static_config.key_frame_qindex_offset;
                     }
-                    qindex = CLIP3(quantizer_to_qindex[scs_ptr->static_config.min_qp_allowed],
-                        quantizer_to_qindex[scs_ptr->static_config.max_qp_allowed], qindex);
+                    qindex = CLIP3(quantizer_to_qindex[pcs_ptr->parent_pcs_ptr->rc_min_qp_allowed],
+                        quantizer_to_qindex[pcs_ptr->parent_pcs_ptr->rc_max_qp_allowed], qindex);
                     int32_t chroma_qindex = qindex;
                     if (frame_is_intra_only(pcs_ptr->parent_pcs_ptr)) {
                         chroma_qindex += scs_ptr->static_config.key_frame_chroma_qindex_offset;
@@ -8840,16 +9180,16 @@ void *rate_control_kernel(void *input_ptr) {
                         chroma_qindex += scs_ptr->static_config.chroma_qindex_offsets[pcs_ptr->temporal_layer_index];
                     }
 
-                    chroma_qindex = CLIP3(quantizer_to_qindex[scs_ptr->static_config.min_qp_allowed],
-                        quantizer_to_qindex[scs_ptr->static_config.max_qp_allowed], chroma_qindex);
+                    chroma_qindex = CLIP3(quantizer_to_qindex[pcs_ptr->parent_pcs_ptr->rc_min_qp_allowed],
+                        quantizer_to_qindex[pcs_ptr->parent_pcs_ptr->rc_max_qp_allowed], chroma_qindex);
                     frm_hdr->quantization_params.base_q_idx = qindex;
                     frm_hdr->quantization_params.delta_q_dc[1] =
                     frm_hdr->quantization_params.delta_q_dc[2] =
                     frm_hdr->quantization_params.delta_q_ac[1] =
                     frm_hdr->quantization_params.delta_q_ac[2] = (chroma_qindex - qindex);
                     pcs_ptr->picture_qp =
-                        (uint8_t)CLIP3((int32_t)scs_ptr->static_config.min_qp_allowed,
-                        (int32_t)scs_ptr->static_config.max_qp_allowed,
+                        (uint8_t)CLIP3((int32_t)pcs_ptr->parent_pcs_ptr->rc_min_qp_allowed,
+                        (int32_t)pcs_ptr->parent_pcs_ptr->rc_max_qp_allowed,
                         (frm_hdr->quantization_params.base_q_idx + 2) >> 2);
 /*
                     printf("\nSVT: Frame Type = %s, PicNumber = %lld, DecoderOrder = %lld, Temp Layer "
@@ -8896,19 +9236,19 @@ void *rate_control_kernel(void *input_ptr) {
                             (AomBitDepth)scs_ptr->static_config.encoder_bit_depth);
                     }
                     frm_hdr->quantization_params.base_q_idx = (uint8_t)CLIP3(
-                        (int32_t)quantizer_to_qindex[scs_ptr->static_config.min_qp_allowed],
-                        (int32_t)quantizer_to_qindex[scs_ptr->static_config.max_qp_allowed],
+                        (int32_t)quantizer_to_qindex[pcs_ptr->parent_pcs_ptr->rc_min_qp_allowed],
+                        (int32_t)quantizer_to_qindex[pcs_ptr->parent_pcs_ptr->rc_max_qp_allowed],
                         (int32_t)(new_qindex));
 
                     pcs_ptr->picture_qp = (uint8_t)CLIP3(
-                        (int32_t)scs_ptr->static_config.min_qp_allowed,
-                        (int32_t)scs_ptr->static_config.max_qp_allowed,
+                        (int32_t)pcs_ptr->parent_pcs_ptr->rc_min_qp_allowed,
+                        (int32_t)pcs_ptr->parent_pcs_ptr->rc_max_qp_allowed,
                         (frm_hdr->quantization_params.base_q_idx + 2) >> 2);
                 }
                 else if (pcs_ptr->parent_pcs_ptr->qp_on_the_fly == EB_TRUE) {
                     pcs_ptr->picture_qp = (uint8_t)CLIP3(
-                        (int32_t)scs_ptr->static_config.min_qp_allowed,
-                        (int32_t)scs_ptr->static_config.max_qp_allowed,
+                        (int32_t)pcs_ptr->parent_pcs_ptr->rc_min_qp_allowed,
+                        (int32_t)pcs_ptr->parent_pcs_ptr->rc_max_qp_allowed,
                         pcs_ptr->parent_pcs_ptr->picture_qp);
                     frm_hdr->quantization_params.base_q_idx =
                         quantizer_to_qindex[pcs_ptr->picture_qp];
@@ -8940,13 +9280,13 @@ void *rate_control_kernel(void *input_ptr) {
                         // VBR Qindex calculating
                         new_qindex                              = rc_pick_q_and_bounds(pcs_ptr);
                         frm_hdr->quantization_params.base_q_idx = (uint8_t)CLIP3(
-                            (int32_t)quantizer_to_qindex[scs_ptr->static_config.min_qp_allowed],
-                            (int32_t)quantizer_to_qindex[scs_ptr->static_config.max_qp_allowed],
+                            (int32_t)quantizer_to_qindex[pcs_ptr->parent_pcs_ptr->rc_min_qp_allowed],
+                            (int32_t)quantizer_to_qindex[pcs_ptr->parent_pcs_ptr->rc_max_qp_allowed],
                             (int32_t)(new_qindex));
 
                         pcs_ptr->picture_qp = (uint8_t)CLIP3(
-                            (int32_t)scs_ptr->static_config.min_qp_allowed,
-                            (int32_t)scs_ptr->static_config.max_qp_allowed,
+                            (int32_t)pcs_ptr->parent_pcs_ptr->rc_min_qp_allowed,
+                            (int32_t)pcs_ptr->parent_pcs_ptr->rc_max_qp_allowed,
                             (frm_hdr->quantization_params.base_q_idx + 2) >> 2);
 
 #if TUNE_VBR
@@ -8959,8 +9299,8 @@ void *rate_control_kernel(void *input_ptr) {
                                 (pcs_ptr->ref_slice_type_array[1][0] != I_SLICE))
                                 ref_qp = MAX(ref_qp, pcs_ptr->ref_pic_qp_array[1][0]);
                             if (ref_qp > 0 && pcs_ptr->picture_qp < ref_qp ) {
-                                pcs_ptr->picture_qp = (uint8_t)CLIP3(scs_ptr->static_config.min_qp_allowed,
-                                    scs_ptr->static_config.max_qp_allowed,
+                                pcs_ptr->picture_qp = (uint8_t)CLIP3(pcs_ptr->parent_pcs_ptr->rc_min_qp_allowed,
+                                    pcs_ptr->parent_pcs_ptr->rc_max_qp_allowed,
                                     (uint8_t)(ref_qp ));
 
                                 frm_hdr->quantization_params.base_q_idx = quantizer_to_qindex[pcs_ptr->picture_qp];
@@ -8995,8 +9335,10 @@ void *rate_control_kernel(void *input_ptr) {
                                                       rate_control_param_ptr);
                 }
 #endif
-                pcs_ptr->picture_qp = (uint8_t)CLIP3(scs_ptr->static_config.min_qp_allowed,
-                                                     scs_ptr->static_config.max_qp_allowed,
+                else if (scs_ptr->static_config.rate_control_mode == 3)
+                    frame_level_rc_input_picture_cbr(pcs_ptr, scs_ptr);
+                pcs_ptr->picture_qp = (uint8_t)CLIP3(pcs_ptr->parent_pcs_ptr->rc_min_qp_allowed,
+                                                     pcs_ptr->parent_pcs_ptr->rc_max_qp_allowed,
                                                      pcs_ptr->picture_qp);
 
                 frm_hdr->quantization_params.base_q_idx = quantizer_to_qindex[pcs_ptr->picture_qp];
@@ -9181,6 +9523,8 @@ void *rate_control_kernel(void *input_ptr) {
                     }
                 }
 #endif
+                if (scs_ptr->static_config.rate_control_mode == 3)
+                    frame_level_rc_feedback_picture_cbr(parentpicture_control_set_ptr, scs_ptr);
             }
 #if TUNE_VBR_RATE_MATCHING
         }
@@ -181,6 +181,8 @@ typedef struct {
     int rc_2_frame;
     int q_1_frame;
     int q_2_frame;
+    // CBR: q index of the last picture sent per rate factor level, 0 when none
+    int cbr_last_q[RATE_FACTOR_LEVELS];
 
     // Auto frame-scaling variables.
     //   int rf_level_maxq[RATE_FACTOR_LEVELS];
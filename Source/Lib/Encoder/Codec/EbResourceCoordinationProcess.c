@@ -21,10 +21,13 @@
 #include "EbResourceCoordinationResults.h"
 #include "EbTransforms.h"
 #include "EbTime.h"
+#include "EbSpeedControl.h"
+#include "EbParameterUpdate.h"
 #include "EbObject.h"
 #include "EbLog.h"
 #include "pass2_strategy.h"
 #include "common_dsp_rtcd.h"
+#include "EbPipelineStats.h"
 typedef struct ResourceCoordinationContext {
     EbFifo *                       input_buffer_fifo_ptr;
     EbFifo *                       resource_coordination_results_output_fifo_ptr;
@@ -41,26 +44,10 @@ typedef struct ResourceCoordinationContext {
     // Picture Number Array
     uint64_t *picture_number_array;
 
-    uint64_t average_enc_mod;
-    uint8_t  prev_enc_mod;
-    int8_t   prev_enc_mode_delta;
-    uint8_t  prev_change_cond;
-
-    int64_t previous_mode_change_buffer;
-    int64_t previous_mode_change_frame_in;
-    int64_t previous_buffer_check1;
-    int64_t previous_frame_in_check1;
-    int64_t previous_frame_in_check2;
-    int64_t previous_frame_in_check3;
-
-    uint64_t cur_speed; // speed x 1000
-    uint64_t prevs_time_seconds;
-    uint64_t prevs_timeu_seconds;
-    int64_t  prev_frame_out;
-
-    uint64_t first_in_pic_arrived_time_seconds;
-    uint64_t first_in_pic_arrived_timeu_seconds;
-    EbBool   start_flag;
+    // Sequence state, kept across the inputs
+    EbBool           end_of_sequence_flag;
+    uint32_t         input_size;
+    EbObjectWrapper *prev_pcs_wrapper_ptr;
 } ResourceCoordinationContext;
 
 static void resource_coordination_context_dctor(EbPtr p) {
@@ -112,28 +99,36 @@ EbErrorType resource_coordination_context_ctor(EbThreadContext *thread_contxt_pt
 
     EB_CALLOC_ARRAY(context_ptr->picture_number_array, context_ptr->encode_instances_total_count);
 
-    context_ptr->average_enc_mod                    = 0;
-    context_ptr->prev_enc_mod                       = 0;
-    context_ptr->prev_enc_mode_delta                = 0;
-    context_ptr->cur_speed                          = 0; // speed x 1000
-    context_ptr->previous_mode_change_buffer        = 0;
-    context_ptr->first_in_pic_arrived_time_seconds  = 0;
-    context_ptr->first_in_pic_arrived_timeu_seconds = 0;
-    context_ptr->previous_frame_in_check1           = 0;
-    context_ptr->previous_frame_in_check2           = 0;
-    context_ptr->previous_frame_in_check3           = 0;
-    context_ptr->previous_mode_change_frame_in      = 0;
-    context_ptr->prevs_time_seconds                 = 0;
-    context_ptr->prevs_timeu_seconds                = 0;
-    context_ptr->prev_frame_out                     = 0;
-    context_ptr->start_flag                         = EB_FALSE;
-
-    context_ptr->previous_buffer_check1 = 0;
-    context_ptr->prev_change_cond       = 0;
-
     return EB_ErrorNone;
 }
 
+/************************************************
+ * Resource Coordination Reset
+ *  The picture of the end of sequence input is never sent on, release what
+ *  it holds and count the pictures from 0 again. Runs first on a reset, the
+ *  other stages only wait for these objects to be back.
+ ************************************************/
+static void resource_coordination_reset(EbThreadContext *thread_context_ptr) {
+    ResourceCoordinationContext *context_ptr =
+        (ResourceCoordinationContext *)thread_context_ptr->priv;
+
+    if (context_ptr->end_of_sequence_flag && context_ptr->prev_pcs_wrapper_ptr) {
+        PictureParentControlSet *pcs_ptr =
+            (PictureParentControlSet *)context_ptr->prev_pcs_wrapper_ptr->object_ptr;
+        svt_release_object(pcs_ptr->input_picture_wrapper_ptr);
+        // PA reference: one for picture decision, one for the picture
+        svt_release_object(pcs_ptr->pa_reference_picture_wrapper_ptr);
+        svt_release_object(pcs_ptr->pa_reference_picture_wrapper_ptr);
+        svt_release_object(pcs_ptr->scs_wrapper_ptr);
+        svt_release_object(pcs_ptr->scs_wrapper_ptr);
+        svt_release_object(context_ptr->prev_pcs_wrapper_ptr);
+    }
+    context_ptr->end_of_sequence_flag = EB_FALSE;
+    context_ptr->prev_pcs_wrapper_ptr = NULL;
+    for (uint32_t i = 0; i < context_ptr->encode_instances_total_count; i++)
+        context_ptr->picture_number_array[i] = 0;
+}
+
 #if FTR_TPL_TR
 /*************************************************************************************
 tpl level control
@@ -496,183 +491,6 @@ EbErrorType signal_derivation_pre_analysis_oq_scs(SequenceControlSet * scs_ptr)
 }
 
 
-//******************************************************************************//
-// Modify the Enc mode based on the buffer Status
-// Inputs: TargetSpeed, Status of the SCbuffer
-// Output: EncMod
-//******************************************************************************//
-void speed_buffer_control(ResourceCoordinationContext *context_ptr,
-                          PictureParentControlSet *pcs_ptr, SequenceControlSet *scs_ptr) {
-    uint64_t curs_time_seconds  = 0;
-    uint64_t curs_time_useconds = 0;
-    double   overall_duration   = 0.0;
-    double   inst_duration      = 0.0;
-    int8_t   encoder_mode_delta = 0;
-    int64_t  input_frames_count = 0;
-    int8_t   change_cond        = 0;
-    int64_t  target_fps         = (scs_ptr->static_config.injector_frame_rate >> 16);
-
-    int64_t buffer_threshold_1 = SC_FRAMES_INTERVAL_T1;
-    int64_t buffer_threshold_2 = SC_FRAMES_INTERVAL_T2;
-    int64_t buffer_threshold_3 = MIN(target_fps * 3, SC_FRAMES_INTERVAL_T3);
-    svt_block_on_mutex(scs_ptr->encode_context_ptr->sc_buffer_mutex);
-
-    if (scs_ptr->encode_context_ptr->sc_frame_in == 0)
-        svt_av1_get_time(&context_ptr->first_in_pic_arrived_time_seconds,
-                         &context_ptr->first_in_pic_arrived_timeu_seconds);
-    else if (scs_ptr->encode_context_ptr->sc_frame_in == SC_FRAMES_TO_IGNORE)
-        context_ptr->start_flag = EB_TRUE;
-    // Compute duration since the start of the encode and since the previous checkpoint
-    svt_av1_get_time(&curs_time_seconds, &curs_time_useconds);
-
-    overall_duration = svt_av1_compute_overall_elapsed_time_ms(
-        context_ptr->first_in_pic_arrived_time_seconds,
-        context_ptr->first_in_pic_arrived_timeu_seconds,
-        curs_time_seconds,
-        curs_time_useconds);
-
-    inst_duration = svt_av1_compute_overall_elapsed_time_ms(context_ptr->prevs_time_seconds,
-                                                            context_ptr->prevs_timeu_seconds,
-                                                            curs_time_seconds,
-                                                            curs_time_useconds);
-
-    input_frames_count = (int64_t)overall_duration *
-        (scs_ptr->static_config.injector_frame_rate >> 16) / 1000;
-    scs_ptr->encode_context_ptr->sc_buffer = input_frames_count -
-        scs_ptr->encode_context_ptr->sc_frame_in;
-
-    encoder_mode_delta = 0;
-
-    // Check every bufferTsshold1 for the changes (previous_frame_in_check1 variable)
-    if ((scs_ptr->encode_context_ptr->sc_frame_in >
-             context_ptr->previous_frame_in_check1 + buffer_threshold_1 &&
-         scs_ptr->encode_context_ptr->sc_frame_in >= SC_FRAMES_TO_IGNORE)) {
-        // Go to a slower mode based on the fullness and changes of the buffer
-        if (scs_ptr->encode_context_ptr->sc_buffer < target_fps &&
-            (context_ptr->prev_enc_mode_delta > -1 ||
-             (context_ptr->prev_enc_mode_delta < 0 &&
-              scs_ptr->encode_context_ptr->sc_frame_in >
-                  context_ptr->previous_mode_change_frame_in + target_fps * 2))) {
-            if (context_ptr->previous_buffer_check1 >
-                scs_ptr->encode_context_ptr->sc_buffer + buffer_threshold_1) {
-                encoder_mode_delta += -1;
-                change_cond = 2;
-            } else if (context_ptr->previous_mode_change_buffer >
-                           buffer_threshold_1 + scs_ptr->encode_context_ptr->sc_buffer &&
-                       scs_ptr->encode_context_ptr->sc_buffer < buffer_threshold_1) {
-                encoder_mode_delta += -1;
-                change_cond = 4;
-            }
-        }
-
-        // Go to a faster mode based on the fullness and changes of the buffer
-        if (scs_ptr->encode_context_ptr->sc_buffer >
-            buffer_threshold_1 + context_ptr->previous_buffer_check1) {
-            encoder_mode_delta += +1;
-            change_cond = 1;
-        } else if (scs_ptr->encode_context_ptr->sc_buffer >
-                   buffer_threshold_1 + context_ptr->previous_mode_change_buffer) {
-            encoder_mode_delta += +1;
-            change_cond = 3;
-        }
-
-        // Update the encode mode based on the fullness of the buffer
-        // If previous ChangeCond was the same, double the threshold2
-        if (scs_ptr->encode_context_ptr->sc_buffer > buffer_threshold_3 &&
-            (context_ptr->prev_change_cond != 7 ||
-             scs_ptr->encode_context_ptr->sc_frame_in >
-                 context_ptr->previous_mode_change_frame_in + buffer_threshold_2 * 2) &&
-            scs_ptr->encode_context_ptr->sc_buffer > context_ptr->previous_mode_change_buffer) {
-            encoder_mode_delta += 1;
-            change_cond = 7;
-        }
-        encoder_mode_delta                    = CLIP3(-1, 1, encoder_mode_delta);
-        scs_ptr->encode_context_ptr->enc_mode = (EbEncMode)CLIP3(
-            1, MAX_ENC_PRESET, (int8_t)scs_ptr->encode_context_ptr->enc_mode + encoder_mode_delta);
-
-        // Update previous stats
-        context_ptr->previous_frame_in_check1 = scs_ptr->encode_context_ptr->sc_frame_in;
-        context_ptr->previous_buffer_check1   = scs_ptr->encode_context_ptr->sc_buffer;
-
-        if (encoder_mode_delta) {
-            context_ptr->previous_mode_change_buffer   = scs_ptr->encode_context_ptr->sc_buffer;
-            context_ptr->previous_mode_change_frame_in = scs_ptr->encode_context_ptr->sc_frame_in;
-            context_ptr->prev_enc_mode_delta           = encoder_mode_delta;
-        }
-    }
-
-    // Check every buffer_threshold_2 for the changes (previous_frame_in_check2 variable)
-    if ((scs_ptr->encode_context_ptr->sc_frame_in >
-             context_ptr->previous_frame_in_check2 + buffer_threshold_2 &&
-         scs_ptr->encode_context_ptr->sc_frame_in >= SC_FRAMES_TO_IGNORE)) {
-        encoder_mode_delta = 0;
-
-        // if no change in the encoder mode and buffer is low enough and level is not increasing, switch to a slower encoder mode
-        // If previous ChangeCond was the same, double the threshold2
-        if (scs_ptr->encode_context_ptr->sc_frame_in >
-                context_ptr->previous_mode_change_frame_in + buffer_threshold_2 &&
-            (context_ptr->prev_change_cond != 8 ||
-             scs_ptr->encode_context_ptr->sc_frame_in >
-                 context_ptr->previous_mode_change_frame_in + buffer_threshold_2 * 2) &&
-            ((scs_ptr->encode_context_ptr->sc_buffer - context_ptr->previous_mode_change_buffer <
-              (target_fps / 3)) ||
-             context_ptr->previous_mode_change_buffer == 0) &&
-            scs_ptr->encode_context_ptr->sc_buffer < buffer_threshold_3) {
-            encoder_mode_delta = -1;
-            change_cond        = 8;
-        }
-
-        encoder_mode_delta                    = CLIP3(-1, 1, encoder_mode_delta);
-        scs_ptr->encode_context_ptr->enc_mode = (EbEncMode)CLIP3(
-            1, MAX_ENC_PRESET, (int8_t)scs_ptr->encode_context_ptr->enc_mode + encoder_mode_delta);
-
-        // Update previous stats
-        context_ptr->previous_frame_in_check2 = scs_ptr->encode_context_ptr->sc_frame_in;
-
-        if (encoder_mode_delta) {
-            context_ptr->previous_mode_change_buffer   = scs_ptr->encode_context_ptr->sc_buffer;
-            context_ptr->previous_mode_change_frame_in = scs_ptr->encode_context_ptr->sc_frame_in;
-            context_ptr->prev_enc_mode_delta           = encoder_mode_delta;
-        }
-    }
-    // Check every SC_FRAMES_INTERVAL_SPEED frames for the speed calculation (previous_frame_in_check3 variable)
-    if (context_ptr->start_flag ||
-        (scs_ptr->encode_context_ptr->sc_frame_in >
-             context_ptr->previous_frame_in_check3 + SC_FRAMES_INTERVAL_SPEED &&
-         scs_ptr->encode_context_ptr->sc_frame_in >= SC_FRAMES_TO_IGNORE)) {
-        if (context_ptr->start_flag)
-            context_ptr->cur_speed = (uint64_t)(scs_ptr->encode_context_ptr->sc_frame_out - 0) *
-                1000 / (uint64_t)(overall_duration);
-        else {
-            if (inst_duration != 0)
-                context_ptr->cur_speed = (uint64_t)(scs_ptr->encode_context_ptr->sc_frame_out -
-                                                    context_ptr->prev_frame_out) *
-                    1000 / (uint64_t)(inst_duration);
-        }
-        context_ptr->start_flag = EB_FALSE;
-
-        // Update previous stats
-        context_ptr->previous_frame_in_check3 = scs_ptr->encode_context_ptr->sc_frame_in;
-        context_ptr->prevs_time_seconds       = curs_time_seconds;
-        context_ptr->prevs_timeu_seconds      = curs_time_useconds;
-        context_ptr->prev_frame_out           = scs_ptr->encode_context_ptr->sc_frame_out;
-    } else if (scs_ptr->encode_context_ptr->sc_frame_in < SC_FRAMES_TO_IGNORE &&
-               (overall_duration != 0))
-        context_ptr->cur_speed = (uint64_t)(scs_ptr->encode_context_ptr->sc_frame_out - 0) * 1000 /
-            (uint64_t)(overall_duration);
-    if (change_cond)
-        context_ptr->prev_change_cond = change_cond;
-    scs_ptr->encode_context_ptr->sc_frame_in++;
-    if (scs_ptr->encode_context_ptr->sc_frame_in >= SC_FRAMES_TO_IGNORE)
-        context_ptr->average_enc_mod += scs_ptr->encode_context_ptr->enc_mode;
-    else
-        context_ptr->average_enc_mod = 0;
-    // Set the encoder level
-    pcs_ptr->enc_mode = scs_ptr->encode_context_ptr->enc_mode;
-
-    svt_release_mutex(scs_ptr->encode_context_ptr->sc_buffer_mutex);
-    context_ptr->prev_enc_mod = scs_ptr->encode_context_ptr->enc_mode;
-}
 static EbErrorType reset_pcs_av1(PictureParentControlSet *pcs_ptr) {
     FrameHeader *frm_hdr = &pcs_ptr->frm_hdr;
     Av1Common *  cm      = pcs_ptr->av1_cm;
@@ -1056,6 +874,72 @@ extern EbErrorType first_pass_signal_derivation_pre_analysis_pcs(PictureParentCo
 extern EbErrorType first_pass_signal_derivation_pre_analysis_scs(SequenceControlSet *scs_ptr);
 
 /* Resource Coordination Kernel */
+/* Send a picture to picture analysis, end_of_sequence_flag tells whether it is the last one */
+static void post_resource_coordination_results(ResourceCoordinationContext *context_ptr,
+                                               SequenceControlSet *         scs_ptr,
+                                               EbObjectWrapper *            pcs_wrapper_ptr,
+                                               EbBool                       end_of_sequence_flag) {
+    PictureParentControlSet *ppcs_out = (PictureParentControlSet *)pcs_wrapper_ptr->object_ptr;
+
+    ppcs_out->end_of_sequence_flag = end_of_sequence_flag;
+    // since overlay frame has the end of sequence set properly, set the end of sequence to true in the alt ref picture
+    if (ppcs_out->is_overlay && end_of_sequence_flag)
+        ppcs_out->alt_ref_ppcs_ptr->end_of_sequence_flag = EB_TRUE;
+
+    reset_pcs_av1(ppcs_out);
+#if FIX_IME
+    if (scs_ptr->in_loop_me) {
+        EbObjectWrapper *ds_wrapper;
+        svt_get_empty_object(scs_ptr->encode_context_ptr->down_scaled_picture_pool_fifo_ptr,
+                             &ds_wrapper);
+        ppcs_out->down_scaled_picture_wrapper_ptr = ds_wrapper;
+    }
+#else
+    (void)scs_ptr;
+#endif
+    // Get Empty Output Results Object
+    EbObjectWrapper *output_wrapper_ptr;
+    svt_get_empty_object(context_ptr->resource_coordination_results_output_fifo_ptr,
+                         &output_wrapper_ptr);
+    ResourceCoordinationResults *out_results_ptr =
+        (ResourceCoordinationResults *)output_wrapper_ptr->object_ptr;
+    out_results_ptr->pcs_wrapper_ptr = pcs_wrapper_ptr;
+    // Post the finished Results Object
+    svt_post_full_object(output_wrapper_ptr);
+}
+
+/* Post an empty output buffer carrying the end of sequence */
+static void post_eos_buffer(EbFifo *fifo_ptr) {
+    EbObjectWrapper *wrapper_ptr;
+    svt_get_empty_object(fifo_ptr, &wrapper_ptr);
+    EbBufferHeaderType *buffer_ptr = (EbBufferHeaderType *)wrapper_ptr->object_ptr;
+    buffer_ptr->flags              = EB_BUFFERFLAG_EOS;
+    buffer_ptr->n_filled_len       = 0;
+    buffer_ptr->pts                = 0;
+    buffer_ptr->dts                = 0;
+    buffer_ptr->pic_type           = EB_AV1_INVALID_PICTURE;
+    buffer_ptr->p_app_private      = NULL;
+    svt_metadata_array_free(&buffer_ptr->metadata);
+    svt_post_full_object(wrapper_ptr);
+}
+
+/* Low delay: the pictures left before the end of sequence came. Mark the last
+ * one as the terminating picture, and send the end of sequence on an empty
+ * buffer for the outputs (packet, recon) it has already reached */
+static void signal_low_delay_eos(SequenceControlSet *scs_ptr, uint64_t picture_count) {
+    EncodeContext *encode_context_ptr = scs_ptr->encode_context_ptr;
+
+    svt_block_on_mutex(encode_context_ptr->total_number_of_recon_frame_mutex);
+    encode_context_ptr->terminating_picture_number         = picture_count - 1;
+    encode_context_ptr->terminating_sequence_flag_received = EB_TRUE;
+    if (encode_context_ptr->total_number_of_output_frames == picture_count)
+        post_eos_buffer(encode_context_ptr->stream_output_fifo_ptr);
+    if (scs_ptr->static_config.recon_enabled &&
+        encode_context_ptr->total_number_of_recon_frames == picture_count)
+        post_eos_buffer(encode_context_ptr->recon_output_fifo_ptr);
+    svt_release_mutex(encode_context_ptr->total_number_of_recon_frame_mutex);
+}
+
 /*********************************************************************************
 *
 * @brief
@@ -1097,17 +981,10 @@ void *resource_coordination_kernel(void *input_ptr) {
 
     EbObjectWrapper *            eb_input_wrapper_ptr;
     EbBufferHeaderType *         eb_input_ptr;
-    EbObjectWrapper *            output_wrapper_ptr;
-    ResourceCoordinationResults *out_results_ptr;
 
     EbObjectWrapper *input_picture_wrapper_ptr;
     EbObjectWrapper *reference_picture_wrapper_ptr;
 
-    EbBool end_of_sequence_flag = EB_FALSE;
-
-    uint32_t         input_size           = 0;
-    EbObjectWrapper *prev_pcs_wrapper_ptr = 0;
-
     for (;;) {
         // Tie instance_index to zero for now...
         uint32_t            instance_index = 0;
@@ -1115,6 +992,12 @@ void *resource_coordination_kernel(void *input_ptr) {
 
         // Get the Next svt Input Buffer [BLOCKING]
         EB_GET_FULL_OBJECT(context_ptr->input_buffer_fifo_ptr, &eb_input_wrapper_ptr);
+        // Reset request of svt_av1_enc_reset, no input follows the end of sequence
+        if (eb_input_wrapper_ptr->signal_semaphore) {
+            resource_coordination_reset(enc_contxt_ptr);
+            svt_release_signal_object(eb_input_wrapper_ptr);
+            continue;
+        }
 
         eb_input_ptr = (EbBufferHeaderType *)eb_input_wrapper_ptr->object_ptr;
 
@@ -1139,7 +1022,7 @@ void *resource_coordination_kernel(void *input_ptr) {
                 context_ptr->scs_instance_array[instance_index]->scs_ptr->max_input_pad_right;
             context_ptr->scs_instance_array[instance_index]->scs_ptr->pad_bottom =
                 context_ptr->scs_instance_array[instance_index]->scs_ptr->max_input_pad_bottom;
-            input_size = context_ptr->scs_instance_array[instance_index]
+            context_ptr->input_size = context_ptr->scs_instance_array[instance_index]
                              ->scs_ptr->seq_header.max_frame_width *
                 context_ptr->scs_instance_array[instance_index]
                     ->scs_ptr->seq_header.max_frame_height;
@@ -1182,10 +1065,6 @@ void *resource_coordination_kernel(void *input_ptr) {
             }
         }
         svt_release_mutex(context_ptr->scs_instance_array[instance_index]->config_mutex);
-        // Seque Control Set is released by Rate Control after passing through MDC->MD->ENCDEC->Packetization->RateControl,
-        // in the PictureManager after receiving the reference and in PictureManager after receiving the feedback
-        svt_object_inc_live_count(context_ptr->sequence_control_set_active_array[instance_index],
-                                  3);
 
         // Set the current SequenceControlSet
         scs_ptr = (SequenceControlSet *)context_ptr
@@ -1194,7 +1073,7 @@ void *resource_coordination_kernel(void *input_ptr) {
 
         // Init SB Params
         if (context_ptr->scs_instance_array[instance_index]->encode_context_ptr->initial_picture) {
-            derive_input_resolution(&scs_ptr->input_resolution, input_size);
+            derive_input_resolution(&scs_ptr->input_resolution, context_ptr->input_size);
 
             sb_params_init(scs_ptr);
             sb_geom_init(scs_ptr);
@@ -1280,7 +1159,7 @@ void *resource_coordination_kernel(void *input_ptr) {
              context_ptr->scs_instance_array[instance_index]->encode_context_ptr->initial_picture)
             ? 0
             : 1;
-        for (uint8_t loop_index = 0; loop_index <= has_overlay && !end_of_sequence_flag;
+        for (uint8_t loop_index = 0; loop_index <= has_overlay && !context_ptr->end_of_sequence_flag;
              loop_index++) {
             //Get a New ParentPCS where we will hold the new input_picture
             svt_get_empty_object(context_ptr->picture_control_set_fifo_ptr_array[instance_index],
@@ -1288,10 +1167,18 @@ void *resource_coordination_kernel(void *input_ptr) {
 
             // Parent PCS is released by the Rate Control after passing through MDC->MD->ENCDEC->Packetization
             svt_object_inc_live_count(pcs_wrapper_ptr, 1);
+            // Seque Control Set is released by Rate Control after passing through MDC->MD->ENCDEC->Packetization->RateControl,
+            // and in PictureManager after receiving the feedback (or in Packetization when no feedback is sent).
+            // The PictureManager counts the references on its own. Both releases happen for every parent PCS,
+            // the overlay one included, so it is held per parent PCS and not per input: an overlay dropped by
+            // Picture Decision releases it twice, and Resource Coordination Reset for the end of sequence input.
+            svt_object_inc_live_count(context_ptr->sequence_control_set_active_array[instance_index],
+                                      2);
 
             pcs_ptr = (PictureParentControlSet *)pcs_wrapper_ptr->object_ptr;
 
             pcs_ptr->p_pcs_wrapper_ptr = pcs_wrapper_ptr;
+            pipeline_picture_start(pcs_ptr, SVT_AV1_STAGE_RESOURCE_COORDINATION);
 
             pcs_ptr->sb_params_array   = scs_ptr->sb_params_array;
             pcs_ptr->sb_geom           = scs_ptr->sb_geom;
@@ -1335,15 +1222,16 @@ void *resource_coordination_kernel(void *input_ptr) {
             input_picture_wrapper_ptr     = eb_input_wrapper_ptr;
             pcs_ptr->enhanced_picture_ptr = (EbPictureBufferDesc *)eb_input_ptr->p_buffer;
             pcs_ptr->input_ptr            = eb_input_ptr;
-            end_of_sequence_flag = (pcs_ptr->input_ptr->flags & EB_BUFFERFLAG_EOS) ? EB_TRUE
-                                                                                   : EB_FALSE;
+            context_ptr->end_of_sequence_flag = (pcs_ptr->input_ptr->flags & EB_BUFFERFLAG_EOS)
+                ? EB_TRUE
+                : EB_FALSE;
             svt_av1_get_time(&pcs_ptr->start_time_seconds, &pcs_ptr->start_time_u_seconds);
 
             pcs_ptr->scs_wrapper_ptr =
                 context_ptr->sequence_control_set_active_array[instance_index];
             pcs_ptr->scs_ptr                   = scs_ptr;
             pcs_ptr->input_picture_wrapper_ptr = input_picture_wrapper_ptr;
-            pcs_ptr->end_of_sequence_flag      = end_of_sequence_flag;
+            pcs_ptr->end_of_sequence_flag      = context_ptr->end_of_sequence_flag;
 #if FTR_SCALE_FACTOR
             pcs_ptr->is_superres_none = (scs_ptr->static_config.superres_mode == SUPERRES_NONE);
 #endif
@@ -1377,10 +1265,14 @@ void *resource_coordination_kernel(void *input_ptr) {
             pcs_ptr->scene_change_flag = EB_FALSE;
             pcs_ptr->qp_on_the_fly     = EB_FALSE;
             pcs_ptr->sb_total_count    = scs_ptr->sb_total_count;
-            if (scs_ptr->static_config.speed_control_flag) {
-                speed_buffer_control(context_ptr, pcs_ptr, scs_ptr);
-            } else
-                pcs_ptr->enc_mode = (EbEncMode)scs_ptr->static_config.enc_mode;
+            // The speed control picks the preset of the picture in picture decision,
+            // once its temporal layer is known
+            if (scs_ptr->static_config.speed_control_flag)
+                pcs_ptr->enc_mode = speed_control_pre_analysis_preset(scs_ptr);
+            else
+                pcs_ptr->enc_mode = (EbEncMode)svt_atomic_load_u32(
+                    &scs_ptr->encode_context_ptr->enc_mode);
+            pcs_ptr->speed_control_work_ns = 0;
             //  If the mode of the second pass is not set from CLI, it is set to enc_mode
 
             // Pre-Analysis Signal(s) derivation
@@ -1419,10 +1311,17 @@ void *resource_coordination_kernel(void *input_ptr) {
             }
 
             // Picture Stats
-            if (loop_index == has_overlay || end_of_sequence_flag)
+            if (loop_index == has_overlay || context_ptr->end_of_sequence_flag)
                 pcs_ptr->picture_number = context_ptr->picture_number_array[instance_index]++;
             else
                 pcs_ptr->picture_number = context_ptr->picture_number_array[instance_index];
+            pipeline_trace_begin(scs_ptr->encode_context_ptr,
+                                 SVT_AV1_STAGE_RESOURCE_COORDINATION,
+                                 pcs_ptr->picture_number,
+                                 0);
+            param_update_take(scs_ptr->encode_context_ptr, pcs_ptr);
+            if (pcs_ptr->param_update.flags & SVT_AV1_UPDATE_KEY_FRAME)
+                pcs_ptr->idr_flag = EB_TRUE;
             if (pcs_ptr->picture_number == 0) {
                 if (use_input_stat(scs_ptr))
                     read_stat(scs_ptr);
@@ -1497,33 +1396,21 @@ void *resource_coordination_kernel(void *input_ptr) {
                 }
             }
 
-            // Get Empty Output Results Object
-            if (pcs_ptr->picture_number > 0 && (prev_pcs_wrapper_ptr != NULL)) {
-                PictureParentControlSet *ppcs_out = (PictureParentControlSet *)
-                                                        prev_pcs_wrapper_ptr->object_ptr;
-
-                ppcs_out->end_of_sequence_flag = end_of_sequence_flag;
-                // since overlay frame has the end of sequence set properly, set the end of sequence to true in the alt ref picture
-                if (ppcs_out->is_overlay && end_of_sequence_flag)
-                    ppcs_out->alt_ref_ppcs_ptr->end_of_sequence_flag = EB_TRUE;
-
-                reset_pcs_av1(ppcs_out);
-#if FIX_IME
-                if (scs_ptr->in_loop_me) {
-                    EbObjectWrapper *ds_wrapper;
-                    svt_get_empty_object(scs_ptr->encode_context_ptr->down_scaled_picture_pool_fifo_ptr,
-                            &ds_wrapper);
-                    ppcs_out->down_scaled_picture_wrapper_ptr = ds_wrapper;
-                }
-#endif
-                svt_get_empty_object(context_ptr->resource_coordination_results_output_fifo_ptr,
-                                     &output_wrapper_ptr);
-                out_results_ptr = (ResourceCoordinationResults *)output_wrapper_ptr->object_ptr;
-                out_results_ptr->pcs_wrapper_ptr = prev_pcs_wrapper_ptr;
-                // Post the finished Results Object
-                svt_post_full_object(output_wrapper_ptr);
+            // Low delay: the picture goes out as it comes, nothing waits for the next input
+            if (scs_ptr->low_delay_pipeline) {
+                if (context_ptr->end_of_sequence_flag)
+                    signal_low_delay_eos(scs_ptr, pcs_ptr->picture_number);
+                else
+                    post_resource_coordination_results(
+                        context_ptr, scs_ptr, pcs_wrapper_ptr, EB_FALSE);
             }
-            prev_pcs_wrapper_ptr = pcs_wrapper_ptr;
+            // Otherwise hold the picture until the next input tells whether it ends the sequence
+            else if (pcs_ptr->picture_number > 0 && (context_ptr->prev_pcs_wrapper_ptr != NULL))
+                post_resource_coordination_results(context_ptr,
+                                                   scs_ptr,
+                                                   context_ptr->prev_pcs_wrapper_ptr,
+                                                   context_ptr->end_of_sequence_flag);
+            context_ptr->prev_pcs_wrapper_ptr = pcs_wrapper_ptr;
         }
     }
 
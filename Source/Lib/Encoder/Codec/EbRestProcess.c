@@ -19,6 +19,7 @@
 #include "EbPictureDemuxResults.h"
 #include "EbReferenceObject.h"
 #include "EbPictureControlSet.h"
+#include "EbPipelineStats.h"
 
 #define DEBUG_UPSCALING 0
 
@@ -553,6 +554,8 @@ void *rest_kernel(void *input_ptr) {
         cdef_results_ptr      = (CdefResults *)cdef_results_wrapper_ptr->object_ptr;
         pcs_ptr               = (PictureControlSet *)cdef_results_ptr->pcs_wrapper_ptr->object_ptr;
         scs_ptr               = (SequenceControlSet *)pcs_ptr->scs_wrapper_ptr->object_ptr;
+        pipeline_stage_begin(
+            pcs_ptr->parent_pcs_ptr, SVT_AV1_STAGE_RESTORATION, cdef_results_ptr->segment_index);
         FrameHeader *frm_hdr  = &pcs_ptr->parent_pcs_ptr->frm_hdr;
         EbBool       is_16bit = (EbBool)(scs_ptr->static_config.encoder_bit_depth > EB_8BIT);
         Av1Common *  cm       = pcs_ptr->parent_pcs_ptr->av1_cm;
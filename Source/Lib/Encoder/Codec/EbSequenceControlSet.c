@@ -268,6 +268,8 @@ EbErrorType copy_sequence_control_set(SequenceControlSet *dst, SequenceControlSe
     dst->overlay_input_picture_buffer_init_count   = src->overlay_input_picture_buffer_init_count;
     dst->output_stream_buffer_fifo_init_count      = src->output_stream_buffer_fifo_init_count;
     dst->output_recon_buffer_fifo_init_count       = src->output_recon_buffer_fifo_init_count;
+    dst->elastic_pool_init_count                   = src->elastic_pool_init_count;
+    dst->memory_report                             = src->memory_report;
     dst->resource_coordination_fifo_init_count     = src->resource_coordination_fifo_init_count;
     dst->picture_analysis_fifo_init_count          = src->picture_analysis_fifo_init_count;
     dst->picture_decision_fifo_init_count          = src->picture_decision_fifo_init_count;
@@ -290,6 +292,7 @@ EbErrorType copy_sequence_control_set(SequenceControlSet *dst, SequenceControlSe
     dst->enc_dec_process_init_count        = src->enc_dec_process_init_count;
     dst->entropy_coding_process_init_count = src->entropy_coding_process_init_count;
     dst->total_process_init_count          = src->total_process_init_count;
+    dst->core_count                        = src->core_count;
     dst->left_padding                      = src->left_padding;
     dst->right_padding                     = src->right_padding;
     dst->top_padding                       = src->top_padding;
@@ -320,6 +323,7 @@ EbErrorType copy_sequence_control_set(SequenceControlSet *dst, SequenceControlSe
     dst->over_boundary_block_mode       = src->over_boundary_block_mode;
     dst->mfmv_enabled                   = src->mfmv_enabled;
     dst->scd_delay                      = src->scd_delay;
+    dst->low_delay_pipeline             = src->low_delay_pipeline;
     dst->in_loop_me                     = src->in_loop_me;
     dst->in_loop_ois                    = src->in_loop_ois;
     dst->enable_pic_mgr_dec_order       = src->enable_pic_mgr_dec_order;
@@ -72,6 +72,10 @@ typedef struct SequenceControlSet {
     /*!< Number of delay frames needed to implement future window
          for algorithms such as SceneChange or TemporalFiltering */
     uint32_t scd_delay;
+    /*!< Low delay prediction structure with no future window: pictures leave
+         resource coordination as they come and the end of sequence is signalled
+         on its own */
+    uint8_t low_delay_pipeline;
 #if !TUNE_REDESIGN_TF_CTRLS
     /*!< Enable the use of altrefs in the stream */
     int8_t tf_level;
@@ -197,6 +201,12 @@ typedef struct SequenceControlSet {
     uint32_t overlay_input_picture_buffer_init_count;
     uint32_t output_stream_buffer_fifo_init_count;
     uint32_t output_recon_buffer_fifo_init_count;
+    // elastic_pool_init_count - pictures constructed at init in the picture
+    //   pools that grow on demand (static_config.elastic_pools)
+    uint32_t elastic_pool_init_count;
+    // memory_report - pool sizes and estimated allocation after
+    //   static_config.memory_budget_mb is applied
+    SvtAv1MemoryReport memory_report;
 
     /*!< Inter processes fifos count */
     uint32_t resource_coordination_fifo_init_count;
@@ -233,6 +243,8 @@ typedef struct SequenceControlSet {
 #endif
     uint32_t inlme_process_init_count;
     uint32_t total_process_init_count;
+    // core_count - logical processors the process counts are derived from
+    uint32_t core_count;
     int32_t  lap_enabled;
     TWO_PASS twopass;
     double   double_frame_rate;
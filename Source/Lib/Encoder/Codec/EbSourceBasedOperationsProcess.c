@@ -30,6 +30,7 @@
 #include "EbMotionEstimation.h"
 #include "EbEncDecResults.h"
 #include "EbRateDistortionCost.h"
+#include "EbPipelineStats.h"
 
 #endif
 /**************************************
@@ -2879,6 +2880,8 @@ void *tpl_disp_kernel(void *input_ptr) {
         TplPcs* pcs_ptr = in_results_ptr->pcs_ptr;
 
         SequenceControlSet* scs_ptr = (SequenceControlSet *)pcs_ptr->scs_ptr;
+        pipeline_trace_begin(
+            scs_ptr->encode_context_ptr, SVT_AV1_STAGE_TPL_DISPENSER, pcs_ptr->picture_number, 0);
 
         int32_t frame_idx =in_results_ptr->frame_index;
 #if !TPL_SEG
@@ -3041,6 +3044,7 @@ void *source_based_operations_kernel(void *input_ptr) {
 
         in_results_ptr = (InitialRateControlResults *)in_results_wrapper_ptr->object_ptr;
         pcs_ptr        = (PictureParentControlSet *)in_results_ptr->pcs_wrapper_ptr->object_ptr;
+        pipeline_stage_begin(pcs_ptr, SVT_AV1_STAGE_SOURCE_BASED_OPERATIONS, 0);
         context_ptr->complete_sb_count = 0;
         uint32_t sb_total_count        = pcs_ptr->sb_total_count;
         uint32_t sb_index;
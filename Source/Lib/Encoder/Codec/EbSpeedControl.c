@@ -0,0 +1,187 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#include "EbSpeedControl.h"
+#include "EbSvtAv1Metadata.h"
+#include "EbThreads.h"
+#include "EbTime.h"
+#include "EbUtility.h"
+
+/* Shortest time between two updates of the work scale */
+#define SPEED_CONTROL_PERIOD_NS 250000000
+/* Fewest pictures out between two updates, for low delay */
+#define SPEED_CONTROL_MIN_FRAMES 4
+/* Relative frame rate error left uncorrected */
+#define SPEED_CONTROL_TOLERANCE 0.05
+/* Lower bound of the work scale, the fastest preset usually sits above it */
+#define SPEED_CONTROL_MIN_SCALE 0.05
+/* Cost of a preset relative to the next slower one, until both are measured */
+#define SPEED_CONTROL_PRESET_RATIO 0.75
+/* Weight of a new measurement in the smoothed cost and frame rate */
+#define SPEED_CONTROL_COST_WEIGHT 0.25
+#define SPEED_CONTROL_FPS_WEIGHT 0.5
+
+static uint32_t picture_class(const PictureParentControlSet *pcs_ptr) {
+    return pcs_ptr->slice_type == I_SLICE ? MAX_TEMPORAL_LAYERS
+                                          : MIN(pcs_ptr->temporal_layer_index, MAX_TEMPORAL_LAYERS - 1);
+}
+
+/* Cost of a picture of the class at the preset: the measured one, else the
+ * one of the nearest measured preset scaled by the default ratio per step.
+ * 0 when nothing of the class was measured yet. */
+double speed_control_predict_cost(const SpeedControl *sc, EbEncMode preset, uint32_t cls) {
+    double scale = 1.0;
+    for (int32_t d = 0; d < SPEED_CONTROL_PRESETS; d++) {
+        const int32_t slower = preset - d - ENC_MRS;
+        const int32_t faster = preset + d - ENC_MRS;
+        if (slower >= 0 && sc->cost_us[slower][cls] > 0)
+            return sc->cost_us[slower][cls] * scale;
+        if (faster < SPEED_CONTROL_PRESETS && sc->cost_us[faster][cls] > 0)
+            return sc->cost_us[faster][cls] / scale;
+        scale *= SPEED_CONTROL_PRESET_RATIO;
+    }
+    return 0;
+}
+
+/* Closed loop on the output frame rate. The rate goes inversely with the
+ * work per picture, so a rate short by more than the tolerance scales the work
+ * down by the rate error. The work only grows slowly back, and not while the
+ * pictures in flight exceed the depth of the pipeline: with a paced input the
+ * rate is then the backlog draining, not room to spend. The rate is measured
+ * over a few pictures, a mini-gop with random access as they come out in
+ * bursts.
+ * Pictures are picked well before they come out, on a short clip most of them
+ * before any rate is measured. Until then pictures piling up past two
+ * mini-gops mean the encoder is already behind its input, and the work drops
+ * with the backlog. The first rate, of pictures picked at full work, sets the
+ * scale with no damping. */
+void speed_control_update_work_scale(SpeedControl *sc, double target_fps, uint64_t min_frames) {
+    const EbBool first = sc->output_fps == 0;
+    if (first) {
+        const uint64_t depth     = 2 * min_frames + 1;
+        const uint64_t in_flight = sc->frames_in - sc->frames_out;
+        if (in_flight > depth)
+            sc->work_scale = MAX(SPEED_CONTROL_MIN_SCALE,
+                                 MIN(sc->work_scale, (double)depth / in_flight));
+    }
+    if (!sc->frames_out || sc->frames_out < sc->update_frames_out + min_frames ||
+        (!first && sc->out_ns < sc->update_ns + SPEED_CONTROL_PERIOD_NS) ||
+        sc->out_ns == sc->update_ns)
+        return;
+    // Between two pictures out, the rate does not depend on when the update runs
+    const double elapsed = (double)(sc->out_ns - sc->update_ns) / 1000000000;
+    const double fps     = (double)(sc->frames_out - sc->update_frames_out) / elapsed;
+    sc->output_fps       = sc->output_fps
+              ? SPEED_CONTROL_FPS_WEIGHT * fps + (1 - SPEED_CONTROL_FPS_WEIGHT) * sc->output_fps
+              : fps;
+    const uint64_t in_flight = sc->frames_in - sc->frames_out;
+    sc->min_in_flight = sc->min_in_flight ? MIN(sc->min_in_flight, in_flight) : in_flight;
+
+    const double ratio = sc->output_fps / target_fps;
+    if (first)
+        sc->work_scale = MIN(sc->work_scale, ratio);
+    else if (ratio < 1 - SPEED_CONTROL_TOLERANCE)
+        sc->work_scale *= MAX(0.5, ratio);
+    else if (ratio >= 1 - SPEED_CONTROL_TOLERANCE / 2 && in_flight <= sc->min_in_flight + min_frames)
+        sc->work_scale *= 1 + SPEED_CONTROL_TOLERANCE / 2;
+    sc->work_scale = CLIP3(SPEED_CONTROL_MIN_SCALE, 1.0, sc->work_scale);
+
+    sc->update_ns         = sc->out_ns;
+    sc->update_frames_out = sc->frames_out;
+}
+
+EbEncMode speed_control_pick_preset(SequenceControlSet *scs_ptr, PictureParentControlSet *pcs_ptr) {
+    if (use_output_stat(scs_ptr))
+        return pcs_ptr->enc_mode;
+    EncodeContext *encode_context_ptr = scs_ptr->encode_context_ptr;
+    SpeedControl * sc                 = &encode_context_ptr->speed_control;
+    const double   target_fps = (double)scs_ptr->static_config.injector_frame_rate / (1 << 16);
+    const EbEncMode slowest   = (EbEncMode)svt_atomic_load_u32(&encode_context_ptr->enc_mode);
+    const uint32_t  cls       = picture_class(pcs_ptr);
+    const uint64_t  min_frames =
+        scs_ptr->static_config.pred_structure == EB_PRED_RANDOM_ACCESS
+        ? (uint64_t)1 << scs_ptr->static_config.hierarchical_levels
+        : SPEED_CONTROL_MIN_FRAMES;
+
+    svt_block_on_mutex(encode_context_ptr->speed_control_mutex);
+    speed_control_update_work_scale(sc, target_fps, min_frames);
+    sc->frames_in++;
+
+    // The slowest preset whose cost fits the work allowed for the class,
+    // plus what the previous pictures of the class left. Carrying the rest
+    // over dithers between two presets when the target falls between them.
+    EbEncMode    preset = slowest;
+    const double ref    = speed_control_predict_cost(sc, slowest, cls);
+    double       cost   = ref;
+    if (ref > 0) {
+        const double target = sc->work_scale * ref + sc->credit_us[cls];
+        while (preset < MAX_ENC_PRESET && cost > target)
+            cost = speed_control_predict_cost(sc, ++preset, cls);
+        sc->credit_us[cls] = CLIP3(-ref, ref, target - cost);
+    } else {
+        // Nothing of the class measured yet, the presets are told apart by the
+        // default ratio between them
+        for (double c = 1; preset < MAX_ENC_PRESET && c > sc->work_scale;
+             c *= SPEED_CONTROL_PRESET_RATIO)
+            preset++;
+    }
+    if (cls == 0 || cls == MAX_TEMPORAL_LAYERS)
+        sc->base_preset = preset;
+
+    SvtAv1SpeedControlInfo *info = &pcs_ptr->speed_control_info;
+    info->picture_number         = pcs_ptr->picture_number;
+    info->enc_mode               = preset;
+    info->temporal_layer         = pcs_ptr->temporal_layer_index;
+    info->is_intra               = pcs_ptr->slice_type == I_SLICE;
+    info->predicted_cost_us      = (uint32_t)cost;
+    info->measured_cost_us       = 0;
+    info->work_scale_x1000       = (uint32_t)(sc->work_scale * 1000);
+    info->output_fps_x1000       = (uint32_t)(sc->output_fps * 1000);
+    svt_release_mutex(encode_context_ptr->speed_control_mutex);
+    return preset;
+}
+
+EbEncMode speed_control_pre_analysis_preset(SequenceControlSet *scs_ptr) {
+    EncodeContext *encode_context_ptr = scs_ptr->encode_context_ptr;
+    svt_block_on_mutex(encode_context_ptr->speed_control_mutex);
+    const EbEncMode preset = encode_context_ptr->speed_control.frames_in
+        ? encode_context_ptr->speed_control.base_preset
+        : (EbEncMode)svt_atomic_load_u32(&encode_context_ptr->enc_mode);
+    svt_release_mutex(encode_context_ptr->speed_control_mutex);
+    return preset;
+}
+
+void speed_control_picture_done(SequenceControlSet *scs_ptr, PictureParentControlSet *pcs_ptr,
+                                EbBufferHeaderType *output_stream_ptr) {
+    if (use_output_stat(scs_ptr))
+        return;
+    EncodeContext *         encode_context_ptr = scs_ptr->encode_context_ptr;
+    SpeedControl *          sc                 = &encode_context_ptr->speed_control;
+    SvtAv1SpeedControlInfo *info               = &pcs_ptr->speed_control_info;
+    const double measured = (double)svt_atomic_load_u64(&pcs_ptr->speed_control_work_ns) / 1000;
+    info->measured_cost_us = (uint32_t)measured;
+
+    svt_block_on_mutex(encode_context_ptr->speed_control_mutex);
+    // The frame rate is measured from the first packet on, not through the
+    // time the pipeline takes to fill
+    sc->out_ns = svt_av1_get_time_ns();
+    if (!sc->frames_out++) {
+        sc->update_ns         = sc->out_ns;
+        sc->update_frames_out = 1;
+    }
+    double *cost = &sc->cost_us[info->enc_mode - ENC_MRS][picture_class(pcs_ptr)];
+    *cost        = *cost
+               ? SPEED_CONTROL_COST_WEIGHT * measured + (1 - SPEED_CONTROL_COST_WEIGHT) * *cost
+               : measured;
+    svt_release_mutex(encode_context_ptr->speed_control_mutex);
+
+    svt_add_metadata(output_stream_ptr, EB_AV1_METADATA_TYPE_SPEED_CONTROL, (uint8_t *)info, sizeof(*info));
+}
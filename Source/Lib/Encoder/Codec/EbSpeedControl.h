@@ -0,0 +1,47 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+#ifndef EbSpeedControl_h
+#define EbSpeedControl_h
+
+#include "EbSequenceControlSet.h"
+#include "EbPictureControlSet.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Picks the preset of the picture, once its temporal layer is known, to
+ * hold the injector frame rate. Updates the work scale from the measured
+ * output frame rate first when it is due. */
+EbEncMode speed_control_pick_preset(SequenceControlSet *scs_ptr, PictureParentControlSet *pcs_ptr);
+
+/* Preset of the analysis before picture decision (filtering, TPL levels): the
+ * one picked for the last base layer picture, the one in effect until then */
+EbEncMode speed_control_pre_analysis_preset(SequenceControlSet *scs_ptr);
+
+/* Learns the cost of the packetized picture and reports the decision in
+ * the metadata of its output packet */
+void speed_control_picture_done(SequenceControlSet *scs_ptr, PictureParentControlSet *pcs_ptr,
+                                EbBufferHeaderType *output_stream_ptr);
+
+/* Cost in us of a picture of the class at the preset: the measured one, else
+ * predicted from the nearest measured preset, 0 when the class has none */
+double speed_control_predict_cost(const SpeedControl *sc, EbEncMode preset, uint32_t cls);
+
+/* Corrects the work scale from the frame rate of the pictures out since the
+ * last update, once they span min_frames */
+void speed_control_update_work_scale(SpeedControl *sc, double target_fps, uint64_t min_frames);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // EbSpeedControl_h
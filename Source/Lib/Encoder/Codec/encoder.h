@@ -114,6 +114,8 @@ typedef struct {
     // and is used as a trigger threshold for more agressive adaptation of Q. It's
     // value can range from 0-1000.
     int over_shoot_pct;
+    // Indicates the target bandwidth in bits per second.
+    int64_t target_bandwidth;
     // Indicates the maximum qindex that can be used by the quantizer i.e. the
     // worst quality qindex.
     int worst_allowed_q;
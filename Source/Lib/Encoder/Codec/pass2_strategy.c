@@ -1467,7 +1467,7 @@ static void define_gf_group(PictureParentControlSet *pcs_ptr, FIRSTPASS_STATS *t
     int tmp_q;
     // rc factor is a weight factor that corrects for local rate control drift.
     double rc_factor = 1.0;
-    int64_t bits = scs_ptr->static_config.target_bit_rate;//oxcf->target_bandwidth;
+    int64_t bits = encode_context_ptr->rc_cfg.target_bandwidth;
 
     if (bits > 0) {
       int rate_error;
@@ -2535,7 +2535,7 @@ static void av1_rc_update_framerate(SequenceControlSet *scs_ptr/*, int width, in
   int vbr_max_bits;
   const int MBs = frame_info->num_mbs;//av1_get_MBs(width, height);
 
-  rc->avg_frame_bandwidth = (int)(scs_ptr->static_config.target_bit_rate/*oxcf->target_bandwidth*/ / scs_ptr->double_frame_rate);
+  rc->avg_frame_bandwidth = (int)(encode_context_ptr->rc_cfg.target_bandwidth / scs_ptr->double_frame_rate);
   rc->min_frame_bandwidth =
       (int)(rc->avg_frame_bandwidth * encode_context_ptr->two_pass_cfg.vbrmin_section / 100);
 
@@ -2564,9 +2564,17 @@ void svt_av1_new_framerate(SequenceControlSet *scs_ptr, double framerate) {
   scs_ptr->double_frame_rate = framerate < 0.1 ? 30 : framerate;
   av1_rc_update_framerate(scs_ptr/*, scs_ptr->seq_header.max_frame_width, scs_ptr->seq_header.max_frame_height*/);
 }
-void set_rc_param(SequenceControlSet *scs_ptr) {
+/* Sets the rate control configuration, with the target bit rate and QP range
+ * the picture is coded with when ppcs_ptr is given, else the configured ones */
+void set_rc_param(SequenceControlSet *scs_ptr, const PictureParentControlSet *ppcs_ptr) {
     EncodeContext *encode_context_ptr = scs_ptr->encode_context_ptr;
     FrameInfo *frame_info = &encode_context_ptr->frame_info;
+    const uint32_t target_bit_rate =
+        ppcs_ptr ? ppcs_ptr->rc_target_bit_rate : scs_ptr->static_config.target_bit_rate;
+    const uint32_t max_qp_allowed =
+        ppcs_ptr ? ppcs_ptr->rc_max_qp_allowed : scs_ptr->static_config.max_qp_allowed;
+    const uint32_t min_qp_allowed =
+        ppcs_ptr ? ppcs_ptr->rc_min_qp_allowed : scs_ptr->static_config.min_qp_allowed;
 
     const int is_vbr = scs_ptr->static_config.rate_control_mode == 1;
     frame_info->frame_width = scs_ptr->seq_header.max_frame_width;
@@ -2579,15 +2587,29 @@ void set_rc_param(SequenceControlSet *scs_ptr) {
     encode_context_ptr->two_pass_cfg.vbrmin_section = scs_ptr->static_config.vbr_min_section_pct;
     encode_context_ptr->two_pass_cfg.vbrmax_section = scs_ptr->static_config.vbr_max_section_pct;
     encode_context_ptr->two_pass_cfg.vbrbias = scs_ptr->static_config.vbr_bias_pct;
-    encode_context_ptr->rc_cfg.mode = scs_ptr->static_config.rate_control_mode == 1 ? AOM_VBR : AOM_Q;
-    encode_context_ptr->rc_cfg.best_allowed_q = (int32_t)quantizer_to_qindex[scs_ptr->static_config.min_qp_allowed];
-    encode_context_ptr->rc_cfg.worst_allowed_q = (int32_t)quantizer_to_qindex[scs_ptr->static_config.max_qp_allowed];
+    encode_context_ptr->rc_cfg.mode = scs_ptr->static_config.rate_control_mode == 1 ? AOM_VBR :
+        scs_ptr->static_config.rate_control_mode == 3 ? AOM_CBR : AOM_Q;
+    encode_context_ptr->rc_cfg.target_bandwidth = target_bit_rate;
+    encode_context_ptr->rc_cfg.best_allowed_q = (int32_t)quantizer_to_qindex[min_qp_allowed];
+    encode_context_ptr->rc_cfg.worst_allowed_q = (int32_t)quantizer_to_qindex[max_qp_allowed];
     encode_context_ptr->rc_cfg.over_shoot_pct = scs_ptr->static_config.over_shoot_pct;
     encode_context_ptr->rc_cfg.under_shoot_pct = scs_ptr->static_config.under_shoot_pct;
     encode_context_ptr->rc_cfg.cq_level = quantizer_to_qindex[scs_ptr->static_config.qp];
     encode_context_ptr->rc_cfg.maximum_buffer_size_ms = is_vbr ? 240000 : 6000;//cfg->rc_buf_sz;
     encode_context_ptr->rc_cfg.starting_buffer_level_ms = is_vbr ? 60000 : 4000;//cfg->rc_buf_initial_sz;
     encode_context_ptr->rc_cfg.optimal_buffer_level_ms = is_vbr ? 60000 : 5000;//cfg->rc_buf_optimal_sz;
+    if (encode_context_ptr->rc_cfg.mode == AOM_CBR) {
+        // The VBV buffer, one second of the target rate by default. The
+        // picture targets steer towards a buffer nearly full, it starts lower
+        // to leave room for the first key frame.
+        const int64_t maximum_ms = scs_ptr->static_config.vbv_bufsize
+            ? (int64_t)scs_ptr->static_config.vbv_bufsize * 1000 /
+                AOMMAX(target_bit_rate, 1)
+            : 1000;
+        encode_context_ptr->rc_cfg.maximum_buffer_size_ms   = maximum_ms;
+        encode_context_ptr->rc_cfg.starting_buffer_level_ms = maximum_ms * 2 / 3;
+        encode_context_ptr->rc_cfg.optimal_buffer_level_ms  = maximum_ms * 5 / 6;
+    }
 #if FTR_VBR_MT_MINIGOP_FIX
     encode_context_ptr->gf_cfg.lag_in_frames = MAX(25, (1 << scs_ptr->static_config.hierarchical_levels) + SCD_LAD + 1);
 #else
@@ -2609,7 +2631,7 @@ void svt_av1_init_single_pass_lap(SequenceControlSet *scs_ptr) {
     EncodeContext *encode_context_ptr = scs_ptr->encode_context_ptr;
     if (!twopass->stats_buf_ctx->stats_in_end) return;
 
-    set_rc_param(scs_ptr);
+    set_rc_param(scs_ptr, NULL);
 
     // This variable monitors how far behind the second ref update is lagging.
     twopass->sr_update_lag = 1;
@@ -2645,7 +2667,7 @@ void svt_av1_init_second_pass(SequenceControlSet *scs_ptr) {
   FIRSTPASS_STATS *stats;
 
   if (!twopass->stats_buf_ctx->stats_in_end) return;
-  set_rc_param(scs_ptr);
+  set_rc_param(scs_ptr, NULL);
   stats = twopass->stats_buf_ctx->total_stats;
 
   *stats = *twopass->stats_buf_ctx->stats_in_end;
@@ -2659,7 +2681,7 @@ void svt_av1_init_second_pass(SequenceControlSet *scs_ptr) {
   // first pass.
   svt_av1_new_framerate(scs_ptr, frame_rate);
   twopass->bits_left =
-      (int64_t)(stats->duration * (int64_t)scs_ptr->static_config.target_bit_rate / 10000000.0);
+      (int64_t)(stats->duration * encode_context_ptr->rc_cfg.target_bandwidth / 10000000.0);
 
   // This variable monitors how far behind the second ref update is lagging.
   twopass->sr_update_lag = 1;
@@ -69,6 +69,7 @@ typedef struct {
 void svt_av1_init_second_pass(struct SequenceControlSet *scs_ptr);
 void svt_av1_init_single_pass_lap(struct SequenceControlSet *scs_ptr);
 void svt_av1_new_framerate(struct SequenceControlSet *scs_ptr, double framerate);
+void set_rc_param(struct SequenceControlSet *scs_ptr, const struct PictureParentControlSet *ppcs_ptr);
 
 void svt_av1_get_second_pass_params(struct PictureParentControlSet *pcs_ptr);
 
@@ -53,6 +53,12 @@
 #include "EbCdefProcess.h"
 #include "EbDlfProcess.h"
 #include "EbRateControlResults.h"
+#include "EbTaskScheduler.h"
+#include "EbStageBalancer.h"
+#include "EbPipelineStats.h"
+#include "EbParameterUpdate.h"
+#include "EbTime.h"
+#include "EbNuma.h"
 #ifdef ARCH_X86_64
 #include <immintrin.h>
 #endif
@@ -368,6 +374,99 @@ int32_t set_parent_pcs(EbSvtAv1EncConfiguration*   config, uint32_t core_count,
         return -1;
     }
 }
+/*********************************
+* Memory budget: estimated bytes of one picture of each pool, fitted on
+* the allocations of 320x240 to 1920x1080 encodes and rounded up
+*********************************/
+#define MEMORY_MB ((uint64_t)1 << 20)
+
+static void estimate_memory_report(SequenceControlSet *scs_ptr, SvtAv1MemoryReport *report) {
+    const uint64_t pixels = (uint64_t)scs_ptr->max_input_luma_width * scs_ptr->max_input_luma_height;
+    const uint32_t hbd    = scs_ptr->static_config.encoder_bit_depth > EB_8BIT;
+
+    report->memory_budget_mb    = scs_ptr->static_config.memory_budget_mb;
+    report->look_ahead_mini_gops = scs_ptr->lad_mg;
+    report->future_pictures      = scs_ptr->scd_delay;
+
+    report->input.count             = scs_ptr->input_buffer_fifo_init_count;
+    report->input.picture_size      = (pixels * 7 / 4 + (192 << 10)) << hbd;
+    if (scs_ptr->in_loop_me)
+        report->input.picture_size += pixels * 3 / 8; // down-scaled pictures
+    report->overlay.count           = scs_ptr->overlay_input_picture_buffer_init_count;
+    report->overlay.picture_size    = report->input.picture_size;
+    report->parent_pcs.count        = scs_ptr->picture_control_set_pool_init_count;
+    report->parent_pcs.picture_size = pixels / 3 + (408 << 10);
+    report->me.count                = scs_ptr->me_pool_init_count;
+    report->me.picture_size         = pixels * 9 / 8 + (24 << 10);
+    report->pa_reference.count      = scs_ptr->pa_reference_picture_buffer_init_count;
+    report->pa_reference.picture_size = pixels * 3 / 2 + (168 << 10);
+    report->reference.count         = scs_ptr->reference_picture_buffer_init_count;
+    report->reference.picture_size  = (pixels * 2 + (340 << 10)) * (hbd ? 3 : 1);
+    // A child control set with its recon and coefficients
+    report->child_pcs.count         = scs_ptr->picture_control_set_pool_init_count_child;
+    report->child_pcs.picture_size  = pixels * 58 + 12 * MEMORY_MB;
+    report->fixed_size = 8 * MEMORY_MB + scs_ptr->total_process_init_count * (2 * MEMORY_MB + pixels / 4);
+}
+
+static uint64_t memory_report_total(const SvtAv1MemoryReport *report) {
+    return report->fixed_size +
+        report->input.count * report->input.picture_size +
+        report->overlay.count * report->overlay.picture_size +
+        report->parent_pcs.count * report->parent_pcs.picture_size +
+        report->me.count * report->me.picture_size +
+        report->pa_reference.count * report->pa_reference.picture_size +
+        report->reference.count * report->reference.picture_size +
+        report->child_pcs.count * report->child_pcs.picture_size;
+}
+
+/* The picture sizes are fitted, so the budget is also checked against the
+ * bytes svt_av1_enc_init allocated, when the allocations are tracked. The
+ * counters cover the whole process: an encoder initialized at the same time
+ * by another thread is counted too. */
+static EbErrorType check_memory_budget(SequenceControlSet *scs_ptr, uint64_t init_live_total) {
+    SvtAv1MemoryReport *report = &scs_ptr->memory_report;
+    SvtAv1MemoryUsage   usage;
+    if (svt_mem_get_usage(&usage) != EB_ErrorNone)
+        return EB_ErrorNone;
+    const uint64_t allocated = usage.live_total > init_live_total
+        ? usage.live_total - init_live_total
+        : 0;
+    report->allocated_mb = (uint32_t)((allocated + MEMORY_MB - 1) / MEMORY_MB);
+    if (!report->memory_budget_mb || allocated <= report->memory_budget_mb * MEMORY_MB)
+        return EB_ErrorNone;
+    SVT_ERROR("svt_av1_enc_init allocated %u MB, over memory_budget_mb %u (estimated %u MB)\n",
+              report->allocated_mb,
+              report->memory_budget_mb,
+              report->estimated_mb);
+    return EB_ErrorInsufficientResources;
+}
+
+// Gives the pool its minimum plus the share avail / slack of the pictures above it
+static uint32_t fit_pool_count(uint32_t count, uint32_t min_count, uint64_t avail, uint64_t slack) {
+    if (count <= min_count)
+        return count;
+    return min_count + (uint32_t)((count - min_count) * avail / slack);
+}
+
+// Logs the look ahead and the static_config.tf_params overridden to fit memory_budget_mb
+static void log_memory_budget_reductions(const SequenceControlSet *scs_ptr, uint8_t lad_mg,
+                                         const uint8_t max_num_future_pics[2]) {
+    if (scs_ptr->lad_mg != lad_mg)
+        SVT_WARN("look ahead reduced from %u to %u mini-GOPs to fit memory_budget_mb %u\n",
+                 lad_mg,
+                 scs_ptr->lad_mg,
+                 scs_ptr->static_config.memory_budget_mb);
+    for (int i = 0; i < 2; i++) {
+        const TfControls *tf = &scs_ptr->static_config.tf_params_per_type[i];
+        if (tf->max_num_future_pics != max_num_future_pics[i])
+            SVT_WARN("temporal filtering of %s pictures limited from %u to %u future pictures to fit memory_budget_mb %u\n",
+                     i ? "base" : "intra",
+                     max_num_future_pics[i],
+                     tf->max_num_future_pics,
+                     scs_ptr->static_config.memory_budget_mb);
+    }
+}
+
 EbErrorType load_default_buffer_configuration_settings(
 #if FTR_LAD_MG
     EbEncHandle        *enc_handle,
@@ -558,6 +657,9 @@ EbErrorType load_default_buffer_configuration_settings(
     scs_ptr->scd_delay =
         scs_ptr->static_config.tf_level || scs_ptr->static_config.scene_change_detection ? SCD_LAD : 0;
 #endif
+    // Low delay without future window: no picture waits for the next input
+    scs_ptr->low_delay_pipeline =
+        scs_ptr->static_config.pred_structure != EB_PRED_RANDOM_ACCESS && scs_ptr->scd_delay == 0;
     // bistream buffer will be allocated at run time. app will free the buffer once written to file.
     scs_ptr->output_stream_buffer_fifo_init_count = PICTURE_DECISION_PA_REFERENCE_QUEUE_MAX_DEPTH;
 
@@ -726,6 +828,9 @@ EbErrorType load_default_buffer_configuration_settings(
         }
     }
 
+    // The elastic picture pools start with the pictures of the first mini-GOP
+    scs_ptr->elastic_pool_init_count = (1 << scs_ptr->static_config.hierarchical_levels) + 1;
+
     //#====================== Inter process Fifos ======================
     scs_ptr->resource_coordination_fifo_init_count       = 300;
     scs_ptr->picture_analysis_fifo_init_count            = 300;
@@ -747,6 +852,7 @@ EbErrorType load_default_buffer_configuration_settings(
     scs_ptr->cdef_fifo_init_count                        = 300;
     scs_ptr->rest_fifo_init_count                        = 300;
     //#====================== Processes number ======================
+    scs_ptr->core_count                                  = core_count;
     scs_ptr->total_process_init_count                    = 0;
     if (core_count > 1){
         scs_ptr->total_process_init_count += (scs_ptr->picture_analysis_process_init_count            = MAX(MIN(15, core_count >> 1), core_count / 6));
@@ -793,6 +899,85 @@ EbErrorType load_default_buffer_configuration_settings(
     }
 
     scs_ptr->total_process_init_count += 6; // single processes count
+
+    SvtAv1MemoryReport *report = &scs_ptr->memory_report;
+    estimate_memory_report(scs_ptr, report);
+    if (scs_ptr->static_config.memory_budget_mb) {
+        const uint64_t     budget     = scs_ptr->static_config.memory_budget_mb * MEMORY_MB;
+        SvtAv1MemoryReport min_report = *report;
+        min_report.input.count        = MIN(min_input, report->input.count);
+        min_report.parent_pcs.count   = MIN(min_parent, report->parent_pcs.count);
+        min_report.me.count           = MIN(min_me, report->me.count);
+        min_report.pa_reference.count = MIN(min_paref, report->pa_reference.count);
+        min_report.reference.count    = MIN(min_ref, report->reference.count);
+        min_report.overlay.count      = MIN(min_overlay, report->overlay.count);
+        min_report.child_pcs.count    = MIN(min_child, report->child_pcs.count);
+        const uint64_t min_total      = memory_report_total(&min_report);
+
+        if (min_total > budget) {
+            // Each picture held in the pipeline has an input, a parent, an ME and a PA reference picture
+            const uint64_t held_picture_size = report->input.picture_size + report->parent_pcs.picture_size +
+                report->me.picture_size + report->pa_reference.picture_size;
+            const uint32_t cut = (uint32_t)((min_total - budget + held_picture_size - 1) / held_picture_size);
+            // The reductions are logged by the caller once the pools fit
+            if (scs_ptr->lad_mg) {
+                scs_ptr->lad_mg--;
+                return load_default_buffer_configuration_settings(
+#if FTR_LAD_MG
+                    enc_handle,
+#endif
+                    scs_ptr);
+            }
+            const uint8_t max_future = (uint8_t)MAX(1, (int32_t)scs_ptr->scd_delay - (int32_t)cut);
+            EbBool        capped     = EB_FALSE;
+            for (int i = 0; i < 2; i++) {
+                TfControls *tf = &scs_ptr->static_config.tf_params_per_type[i];
+                if (tf->enabled && tf->max_num_future_pics > max_future) {
+                    tf->max_num_future_pics = max_future;
+                    tf->num_future_pics     = MIN(tf->num_future_pics, max_future);
+                    capped                  = EB_TRUE;
+                }
+            }
+            if (capped)
+                return load_default_buffer_configuration_settings(
+#if FTR_LAD_MG
+                    enc_handle,
+#endif
+                    scs_ptr);
+            report->estimated_mb = (uint32_t)((min_total + MEMORY_MB - 1) / MEMORY_MB);
+            SVT_ERROR("memory_budget_mb %u is below the %u MB needed at this resolution and preset, "
+                      "even without look ahead and with %u future pictures held\n",
+                      scs_ptr->static_config.memory_budget_mb,
+                      report->estimated_mb,
+                      scs_ptr->scd_delay);
+            return EB_ErrorInsufficientResources;
+        }
+        const uint64_t total = memory_report_total(report);
+        if (total > budget) {
+            const uint64_t avail = budget - min_total;
+            const uint64_t slack = total - min_total;
+            scs_ptr->input_buffer_fifo_init_count = fit_pool_count(
+                scs_ptr->input_buffer_fifo_init_count, min_input, avail, slack);
+            scs_ptr->picture_control_set_pool_init_count = fit_pool_count(
+                scs_ptr->picture_control_set_pool_init_count, min_parent, avail, slack);
+            scs_ptr->me_pool_init_count = fit_pool_count(
+                scs_ptr->me_pool_init_count, min_me, avail, slack);
+            scs_ptr->pa_reference_picture_buffer_init_count = fit_pool_count(
+                scs_ptr->pa_reference_picture_buffer_init_count, min_paref, avail, slack);
+            scs_ptr->reference_picture_buffer_init_count = fit_pool_count(
+                scs_ptr->reference_picture_buffer_init_count, min_ref, avail, slack);
+            scs_ptr->overlay_input_picture_buffer_init_count = fit_pool_count(
+                scs_ptr->overlay_input_picture_buffer_init_count, min_overlay, avail, slack);
+            scs_ptr->picture_control_set_pool_init_count_child = fit_pool_count(
+                scs_ptr->picture_control_set_pool_init_count_child, min_child, avail, slack);
+#if CLN_STRUCT
+            scs_ptr->enc_dec_pool_init_count = scs_ptr->picture_control_set_pool_init_count_child;
+#endif
+            scs_ptr->output_recon_buffer_fifo_init_count = scs_ptr->reference_picture_buffer_init_count;
+            estimate_memory_report(scs_ptr, report);
+        }
+    }
+    report->estimated_mb = (uint32_t)((memory_report_total(report) + MEMORY_MB - 1) / MEMORY_MB);
     SVT_LOG("Number of logical cores available: %u\nNumber of PPCS %u\n", core_count, scs_ptr->picture_control_set_pool_init_count);
 
     /******************************************************************
@@ -909,9 +1094,44 @@ void lib_svt_encoder_send_error_exit(
     EbPtr                    hComponent,
     uint32_t                 error_code);
 
+/*********************************
+* Shared executor
+*   One task scheduler for the kernel jobs of several handles,
+*   each handle queues its jobs on its own task group
+*********************************/
+// Spare workers replace the ones blocked in a stage. Shared by all the
+// handles, each one reserves one per stage context when it attaches
+#define EXECUTOR_MAX_SPARE_COUNT 1024
+// Pending tasks of all the handles, each one reserves one per stage context
+#define EXECUTOR_QUEUE_CAPACITY 4096
+
+struct SvtAv1Executor {
+    EbDctor           dctor;
+    EbTaskScheduler * scheduler_ptr;
+    // handle_count - handles whose kernel jobs use the executor
+    volatile uint32_t handle_count;
+};
+
 static void svt_enc_handle_stop_threads(EbEncHandle *enc_handle_ptr)
 {
     SequenceControlSet*  control_set_ptr = enc_handle_ptr->scs_instance_array[0]->scs_ptr;
+    // Stage balancer, unparks every stage thread
+    EB_DELETE(enc_handle_ptr->stage_balancer_ptr);
+    // Task scheduler workers, the kernel jobs return once their queues are shut down
+    EB_DELETE(enc_handle_ptr->task_scheduler_ptr);
+    // Shared executor, which keeps running: no run of the kernel jobs is left
+    if (enc_handle_ptr->executor) {
+        for (uint32_t job_index = 0; job_index < enc_handle_ptr->kernel_job_count; ++job_index)
+            if (enc_handle_ptr->kernel_job_ptr_array[job_index])
+                svt_kernel_job_stop(enc_handle_ptr->kernel_job_ptr_array[job_index]);
+        svt_task_scheduler_unreserve(enc_handle_ptr->executor->scheduler_ptr,
+                                     enc_handle_ptr->executor_context_count,
+                                     enc_handle_ptr->executor_context_count);
+        svt_atomic_fetch_add_u32(&enc_handle_ptr->executor->handle_count, (uint32_t)-1);
+        enc_handle_ptr->executor = NULL;
+    }
+    EB_DELETE(enc_handle_ptr->task_group_ptr);
+
     // Resource Coordination
     EB_DESTROY_THREAD(enc_handle_ptr->resource_coordination_thread_handle);
     EB_DESTROY_THREAD_ARRAY(enc_handle_ptr->picture_analysis_thread_handle_array,control_set_ptr->picture_analysis_process_init_count);
@@ -971,6 +1191,7 @@ static void svt_enc_handle_dctor(EbPtr p)
     EbEncHandle *enc_handle_ptr = (EbEncHandle *)p;
 
     svt_enc_handle_stop_threads(enc_handle_ptr);
+    EB_DESTROY_SEMAPHORE(enc_handle_ptr->reset_ack_semaphore);
     EB_FREE_PTR_ARRAY(enc_handle_ptr->app_callback_ptr_array, enc_handle_ptr->encode_instance_total_count);
     EB_DELETE(enc_handle_ptr->scs_pool_ptr);
     EB_DELETE_PTR_ARRAY(enc_handle_ptr->picture_parent_control_set_pool_ptr_array, enc_handle_ptr->encode_instance_total_count);
@@ -1027,6 +1248,7 @@ static void svt_enc_handle_dctor(EbPtr p)
     EB_DELETE(enc_handle_ptr->picture_manager_context_ptr);
     EB_DELETE(enc_handle_ptr->rate_control_context_ptr);
     EB_DELETE(enc_handle_ptr->packetization_context_ptr);
+    EB_DELETE_PTR_ARRAY(enc_handle_ptr->kernel_job_ptr_array, enc_handle_ptr->kernel_job_count);
     EB_DELETE_PTR_ARRAY(enc_handle_ptr->reference_picture_pool_ptr_array, enc_handle_ptr->encode_instance_total_count);
 
 }
@@ -1056,6 +1278,7 @@ static EbErrorType svt_enc_handle_ctor(
     // Initialize Sequence Control Set Instance Array
     EB_ALLOC_PTR_ARRAY(enc_handle_ptr->scs_instance_array, enc_handle_ptr->encode_instance_total_count);
     EB_NEW(enc_handle_ptr->scs_instance_array[0], svt_sequence_control_set_instance_ctor);
+    EB_CREATE_SEMAPHORE(enc_handle_ptr->reset_ack_semaphore, 0, 1);
     return EB_ErrorNone;
 }
 
@@ -1063,6 +1286,10 @@ EbErrorType svt_input_buffer_header_creator(
     EbPtr *object_dbl_ptr,
     EbPtr  object_init_data_ptr);
 
+EbErrorType svt_input_buffer_header_ref_creator(
+    EbPtr *object_dbl_ptr,
+    EbPtr  object_init_data_ptr);
+
 EbErrorType svt_output_recon_buffer_header_creator(
     EbPtr *object_dbl_ptr,
     EbPtr  object_init_data_ptr);
@@ -1176,6 +1403,42 @@ EbErrorType rest_results_creator(
     return EB_ErrorNone;
 }
 
+/*********************************
+* Picture pool constructor: the pool grows on demand
+* up to object_total_count with elastic_pools
+*********************************/
+static EbErrorType picture_pool_ctor(
+    EbSystemResource   *resource_ptr,
+    SequenceControlSet *scs_ptr,
+    uint32_t            object_total_count,
+    uint32_t            producer_process_total_count,
+    uint32_t            consumer_process_total_count,
+    EbCreator           object_creator,
+    EbPtr               object_init_data_ptr,
+    size_t              object_init_data_size,
+    EbDctor             object_destroyer)
+{
+    if (!scs_ptr->static_config.elastic_pools)
+        return svt_system_resource_ctor(
+            resource_ptr,
+            object_total_count,
+            producer_process_total_count,
+            consumer_process_total_count,
+            object_creator,
+            object_init_data_ptr,
+            object_destroyer);
+    return svt_system_resource_ctor_elastic(
+        resource_ptr,
+        scs_ptr->elastic_pool_init_count,
+        object_total_count,
+        producer_process_total_count,
+        consumer_process_total_count,
+        object_creator,
+        object_init_data_ptr,
+        object_init_data_size,
+        object_destroyer);
+}
+
 static int create_down_scaled_buf_descs(EbEncHandle *enc_handle_ptr, uint32_t instance_index)
 {
     SequenceControlSet* scs_ptr = enc_handle_ptr->scs_instance_array[instance_index]->scs_ptr;
@@ -1218,12 +1481,14 @@ static int create_down_scaled_buf_descs(EbEncHandle *enc_handle_ptr, uint32_t in
     eb_down_scale_obj_init_data.enable_quarter_luma_input = 1;//(scs_ptr->gm_level == GM_DOWN) ? 1 : 0;
     eb_down_scale_obj_init_data.enable_sixteenth_luma_input = 1;//(scs_ptr->gm_level == GM_DOWN16) ? 1 : 0;
     EB_NEW(enc_handle_ptr->down_scaled_picture_pool_ptr_array[instance_index],
-            svt_system_resource_ctor,
+            picture_pool_ctor,
+            scs_ptr,
             scs_ptr->input_buffer_fifo_init_count,
             EB_PictureDecisionProcessInitCount,
             0,
             svt_down_scaled_object_creator,
             &(eb_down_scale_obj_init_data),
+            sizeof(eb_down_scale_obj_init_data),
             NULL);
     // Set the SequenceControlSet Picture Pool Fifo Ptrs
     enc_handle_ptr->scs_instance_array[instance_index]->encode_context_ptr->down_scaled_picture_pool_fifo_ptr =
@@ -1279,12 +1544,14 @@ static int create_pa_ref_buf_descs(EbEncHandle *enc_handle_ptr, uint32_t instanc
         eb_pa_ref_obj_ect_desc_init_data_structure.sixteenth_picture_desc_init_data = sixteenth_pic_buf_desc_init_data;
         // Reference Picture Buffers
         EB_NEW(enc_handle_ptr->pa_reference_picture_pool_ptr_array[instance_index],
-            svt_system_resource_ctor,
+            picture_pool_ctor,
+            scs_ptr,
             scs_ptr->pa_reference_picture_buffer_init_count,
             EB_PictureDecisionProcessInitCount,
             0,
             svt_pa_reference_object_creator,
             &(eb_pa_ref_obj_ect_desc_init_data_structure),
+            sizeof(eb_pa_ref_obj_ect_desc_init_data_structure),
             NULL);
         // Set the SequenceControlSet Picture Pool Fifo Ptrs
         enc_handle_ptr->scs_instance_array[instance_index]->encode_context_ptr->pa_reference_picture_pool_fifo_ptr =
@@ -1344,12 +1611,14 @@ static int create_ref_buf_descs(EbEncHandle *enc_handle_ptr, uint32_t instance_i
     // Reference Picture Buffers
     EB_NEW(
             enc_handle_ptr->reference_picture_pool_ptr_array[instance_index],
-            svt_system_resource_ctor,
+            picture_pool_ctor,
+            scs_ptr,
             scs_ptr->reference_picture_buffer_init_count,//enc_handle_ptr->ref_pic_pool_total_count,
             EB_PictureManagerProcessInitCount,
             0,
             svt_reference_object_creator,
             &(eb_ref_obj_ect_desc_init_data_structure),
+            sizeof(eb_ref_obj_ect_desc_init_data_structure),
             NULL);
 
     enc_handle_ptr->scs_instance_array[instance_index]->encode_context_ptr->reference_picture_pool_fifo_ptr =
@@ -1362,6 +1631,340 @@ static int create_ref_buf_descs(EbEncHandle *enc_handle_ptr, uint32_t instance_i
     return 0;
 }
 
+/*********************************
+* Applies the EB_CREATE_THREAD affinity
+* to the task scheduler workers
+*********************************/
+static void task_thread_init(EbHandle thread_handle)
+{
+#ifdef _WIN32
+    if (num_groups == 1)
+        SetThreadAffinityMask(thread_handle, group_affinity.Mask);
+    else if (num_groups == 2 && alternate_groups) {
+        group_affinity.Group = 1 - group_affinity.Group;
+        SetThreadGroupAffinity(thread_handle, &group_affinity, NULL);
+    } else if (num_groups == 2 && !alternate_groups)
+        SetThreadGroupAffinity(thread_handle, &group_affinity, NULL);
+#elif defined(__linux__)
+    pthread_setaffinity_np(*((pthread_t *)thread_handle), sizeof(cpu_set_t), &group_affinity);
+#else
+    (void)thread_handle;
+#endif
+}
+
+/*********************************
+* Multi-instance stages: the input resource, kernel and
+* contexts of every stage
+*********************************/
+typedef struct KernelStage {
+    const char        *name;
+    EbSystemResource  *input_resource_ptr;
+    EbKernelFn         kernel;
+    EbThreadContext  **context_ptr_array;
+    uint32_t           context_count;
+} KernelStage;
+
+#define MAX_KERNEL_STAGES 10
+
+static uint32_t get_kernel_stages(EbEncHandle *enc_handle_ptr, KernelStage *stages)
+{
+    SequenceControlSet *scs_ptr = enc_handle_ptr->scs_instance_array[0]->scs_ptr;
+    const KernelStage stage_table[] = {
+        { "picture_analysis", enc_handle_ptr->resource_coordination_results_resource_ptr, picture_analysis_kernel,
+          enc_handle_ptr->picture_analysis_context_ptr_array, scs_ptr->picture_analysis_process_init_count },
+        { "motion_estimation", enc_handle_ptr->picture_decision_results_resource_ptr, motion_estimation_kernel,
+          enc_handle_ptr->motion_estimation_context_ptr_array, scs_ptr->motion_estimation_process_init_count },
+#if TPL_KERNEL
+        { "tpl_dispenser", enc_handle_ptr->tpl_disp_res_srm, tpl_disp_kernel,
+          enc_handle_ptr->tpl_disp_context_ptr_array, scs_ptr->tpl_disp_process_init_count },
+#endif
+        { "inloop_me", enc_handle_ptr->pic_mgr_res_srm, inloop_me_kernel,
+          enc_handle_ptr->inlme_context_ptr_array, scs_ptr->inlme_process_init_count },
+        { "mode_decision_configuration", enc_handle_ptr->rate_control_results_resource_ptr, mode_decision_configuration_kernel,
+          enc_handle_ptr->mode_decision_configuration_context_ptr_array, scs_ptr->mode_decision_configuration_process_init_count },
+        { "enc_dec", enc_handle_ptr->enc_dec_tasks_resource_ptr, mode_decision_kernel,
+          enc_handle_ptr->enc_dec_context_ptr_array, scs_ptr->enc_dec_process_init_count },
+        { "dlf", enc_handle_ptr->enc_dec_results_resource_ptr, dlf_kernel,
+          enc_handle_ptr->dlf_context_ptr_array, scs_ptr->dlf_process_init_count },
+        { "cdef", enc_handle_ptr->dlf_results_resource_ptr, cdef_kernel,
+          enc_handle_ptr->cdef_context_ptr_array, scs_ptr->cdef_process_init_count },
+        { "restoration", enc_handle_ptr->cdef_results_resource_ptr, rest_kernel,
+          enc_handle_ptr->rest_context_ptr_array, scs_ptr->rest_process_init_count },
+        { "entropy_coding", enc_handle_ptr->rest_results_resource_ptr, entropy_coding_kernel,
+          enc_handle_ptr->entropy_coding_context_ptr_array, scs_ptr->entropy_coding_process_init_count },
+    };
+    const uint32_t stage_count = sizeof(stage_table) / sizeof(stage_table[0]);
+
+    assert(stage_count <= MAX_KERNEL_STAGES);
+    for (uint32_t stage_index = 0; stage_index < stage_count; ++stage_index)
+        stages[stage_index] = stage_table[stage_index];
+    return stage_count;
+}
+
+/*********************************
+* Shared executor
+*********************************/
+static void svt_av1_executor_dctor(EbPtr p)
+{
+    SvtAv1Executor *executor = (SvtAv1Executor *)p;
+    EB_DELETE(executor->scheduler_ptr);
+}
+
+static EbErrorType svt_av1_executor_ctor(SvtAv1Executor *executor, uint32_t thread_count)
+{
+    executor->dctor = svt_av1_executor_dctor;
+    // No affinity: the attached handles may ask for different ones
+    EB_NEW(
+        executor->scheduler_ptr,
+        svt_task_scheduler_ctor,
+        thread_count ? thread_count : get_num_processors(),
+        EXECUTOR_MAX_SPARE_COUNT,
+        EXECUTOR_QUEUE_CAPACITY,
+        NULL);
+    return EB_ErrorNone;
+}
+
+EB_API EbErrorType svt_av1_executor_create(SvtAv1Executor **executor_ptr, uint32_t thread_count)
+{
+    if (executor_ptr == NULL)
+        return EB_ErrorBadParameter;
+    *executor_ptr = NULL;
+    svt_log_init();
+    SvtAv1Executor *executor;
+    EB_NEW(executor, svt_av1_executor_ctor, thread_count);
+    svt_increase_component_count();
+    *executor_ptr = executor;
+    return EB_ErrorNone;
+}
+
+EB_API EbErrorType svt_av1_executor_destroy(SvtAv1Executor *executor)
+{
+    if (executor == NULL)
+        return EB_ErrorBadParameter;
+    if (svt_atomic_load_u32(&executor->handle_count)) {
+        SVT_ERROR("svt_av1_executor_destroy: %u encoder handles still attached\n",
+                  svt_atomic_load_u32(&executor->handle_count));
+        return EB_ErrorBadParameter;
+    }
+    EB_DELETE(executor);
+    svt_decrease_component_count();
+    return EB_ErrorNone;
+}
+
+/*********************************
+* Creates the task scheduler and one kernel job per multi-instance
+* stage. The single instance stages keep their dedicated threads:
+* they wait on other stages outside of the system resource manager.
+* With a shared executor, the jobs are queued on a task group of
+* the executor scheduler instead.
+*********************************/
+static EbErrorType create_kernel_jobs(EbEncHandle *enc_handle_ptr)
+{
+    SequenceControlSet *scs_ptr = enc_handle_ptr->scs_instance_array[0]->scs_ptr;
+    SvtAv1Executor *executor = scs_ptr->static_config.executor;
+    EbTaskScheduler *scheduler_ptr;
+    KernelStage jobs[MAX_KERNEL_STAGES];
+    const uint32_t job_count = get_kernel_stages(enc_handle_ptr, jobs);
+    uint32_t context_total_count = 0;
+
+    for (uint32_t job_index = 0; job_index < job_count; ++job_index)
+        context_total_count += jobs[job_index].context_count;
+
+    if (executor) {
+        // Every context can hold a blocked worker and a pending task
+        if (svt_task_scheduler_reserve(
+                executor->scheduler_ptr, context_total_count, context_total_count) !=
+            EB_ErrorNone) {
+            SVT_ERROR("executor: no room left for the %u stage contexts of this handle\n",
+                      context_total_count);
+            return EB_ErrorInsufficientResources;
+        }
+        enc_handle_ptr->executor = executor;
+        enc_handle_ptr->executor_context_count = context_total_count;
+        svt_atomic_fetch_add_u32(&executor->handle_count, 1);
+        EB_NEW(
+            enc_handle_ptr->task_group_ptr,
+            svt_task_group_ctor,
+            executor->scheduler_ptr,
+            scs_ptr->static_config.executor_weight);
+        scheduler_ptr = executor->scheduler_ptr;
+    } else {
+        // Every context can hold a blocked worker, so up to context_total_count
+        // spare workers keep the pool running; at most one task per context is
+        // pending at any time.
+        EB_NEW(
+            enc_handle_ptr->task_scheduler_ptr,
+            svt_task_scheduler_ctor,
+            scs_ptr->core_count,
+            context_total_count,
+            context_total_count,
+            task_thread_init);
+        scheduler_ptr = enc_handle_ptr->task_scheduler_ptr;
+    }
+
+    EB_ALLOC_PTR_ARRAY(enc_handle_ptr->kernel_job_ptr_array, job_count);
+    enc_handle_ptr->kernel_job_count = job_count;
+    for (uint32_t job_index = 0; job_index < job_count; ++job_index) {
+        EB_NEW(
+            enc_handle_ptr->kernel_job_ptr_array[job_index],
+            svt_kernel_job_ctor,
+            scheduler_ptr,
+            enc_handle_ptr->task_group_ptr,
+            jobs[job_index].input_resource_ptr,
+            jobs[job_index].kernel,
+            (EbPtr *)jobs[job_index].context_ptr_array,
+            jobs[job_index].context_count);
+    }
+    return EB_ErrorNone;
+}
+
+/*********************************
+* Creates the stage balancer over the threads of the
+* multi-instance stages, with a budget of one running
+* thread per logical processor
+*********************************/
+static EbErrorType create_stage_balancer(EbEncHandle *enc_handle_ptr)
+{
+    SequenceControlSet *scs_ptr = enc_handle_ptr->scs_instance_array[0]->scs_ptr;
+    KernelStage         stages[MAX_KERNEL_STAGES];
+    EbBalancedStageInit stage_init_array[MAX_KERNEL_STAGES];
+    const uint32_t      stage_count = get_kernel_stages(enc_handle_ptr, stages);
+
+    for (uint32_t stage_index = 0; stage_index < stage_count; ++stage_index) {
+        stage_init_array[stage_index].name          = stages[stage_index].name;
+        stage_init_array[stage_index].resource_ptr  = stages[stage_index].input_resource_ptr;
+        stage_init_array[stage_index].process_count = stages[stage_index].context_count;
+    }
+    EB_NEW(
+        enc_handle_ptr->stage_balancer_ptr,
+        svt_stage_balancer_ctor,
+        scs_ptr->core_count,
+        stage_init_array,
+        stage_count);
+    return EB_ErrorNone;
+}
+
+/*********************************
+* NUMA mode: thread index of a stage with count
+* threads runs on node index * nodes / count, and
+* its context is allocated there
+*********************************/
+static int32_t numa_stage_node(uint32_t index, uint32_t count)
+{
+    return (int32_t)(index * svt_numa_node_count() / count);
+}
+
+static void numa_set_context_node(EbEncHandle *enc_handle_ptr, uint32_t index, uint32_t count)
+{
+    if (enc_handle_ptr->scs_instance_array[0]->scs_ptr->static_config.numa_aware)
+        svt_numa_set_alloc_node(numa_stage_node(index, count));
+}
+
+static void numa_place_threads(EbHandle *thread_handle_array, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+        svt_numa_bind_thread(thread_handle_array[i], numa_stage_node(i, count));
+}
+
+/*********************************
+* Moves the stage threads to their node. With the
+* task scheduler the workers are shared by all the
+* stages and keep the EB_CREATE_THREAD affinity
+*********************************/
+static void numa_place_stage_threads(EbEncHandle *enc_handle_ptr)
+{
+    SequenceControlSet *scs_ptr = enc_handle_ptr->scs_instance_array[0]->scs_ptr;
+    EbHandle single_thread_array[] = {
+        enc_handle_ptr->resource_coordination_thread_handle,
+        enc_handle_ptr->picture_decision_thread_handle,
+        enc_handle_ptr->initial_rate_control_thread_handle,
+        enc_handle_ptr->picture_manager_thread_handle,
+        enc_handle_ptr->rate_control_thread_handle,
+        enc_handle_ptr->packetization_thread_handle
+    };
+    for (uint32_t i = 0; i < sizeof(single_thread_array) / sizeof(single_thread_array[0]); i++)
+        svt_numa_bind_thread(single_thread_array[i], 0);
+    numa_place_threads(enc_handle_ptr->source_based_operations_thread_handle_array, scs_ptr->source_based_operations_process_init_count);
+    if (scs_ptr->static_config.task_scheduler)
+        return;
+    numa_place_threads(enc_handle_ptr->picture_analysis_thread_handle_array, scs_ptr->picture_analysis_process_init_count);
+    numa_place_threads(enc_handle_ptr->motion_estimation_thread_handle_array, scs_ptr->motion_estimation_process_init_count);
+#if TPL_KERNEL
+    numa_place_threads(enc_handle_ptr->tpl_disp_thread_handle_array, scs_ptr->tpl_disp_process_init_count);
+#endif
+    numa_place_threads(enc_handle_ptr->ime_thread_handle_array, scs_ptr->inlme_process_init_count);
+    numa_place_threads(enc_handle_ptr->mode_decision_configuration_thread_handle_array, scs_ptr->mode_decision_configuration_process_init_count);
+    numa_place_threads(enc_handle_ptr->enc_dec_thread_handle_array, scs_ptr->enc_dec_process_init_count);
+    numa_place_threads(enc_handle_ptr->dlf_thread_handle_array, scs_ptr->dlf_process_init_count);
+    numa_place_threads(enc_handle_ptr->cdef_thread_handle_array, scs_ptr->cdef_process_init_count);
+    numa_place_threads(enc_handle_ptr->rest_thread_handle_array, scs_ptr->rest_process_init_count);
+    numa_place_threads(enc_handle_ptr->entropy_coding_thread_handle_array, scs_ptr->entropy_coding_process_init_count);
+}
+
+// Plane layout of the library input pictures, see zero_copy_input
+static void init_input_layout(EbEncHandle *enc_handle_ptr)
+{
+    const SequenceControlSet  *scs_ptr = enc_handle_ptr->scs_instance_array[0]->scs_ptr;
+    const EbBufferHeaderType  *header = (EbBufferHeaderType*)
+        enc_handle_ptr->input_buffer_resource_ptr->wrapper_ptr_pool[0]->object_ptr;
+    const EbPictureBufferDesc *desc = (EbPictureBufferDesc*)header->p_buffer;
+    SvtAv1InputLayout         *layout = &enc_handle_ptr->input_layout;
+
+    layout->width = desc->max_width;
+    layout->height = desc->max_height;
+    layout->y_stride = desc->stride_y;
+    layout->cb_stride = desc->stride_cb;
+    layout->cr_stride = desc->stride_cr;
+    layout->left_padding = scs_ptr->left_padding;
+    layout->right_padding = scs_ptr->right_padding;
+    layout->top_padding = scs_ptr->top_padding;
+    layout->bot_padding = scs_ptr->bot_padding;
+    layout->luma_size = desc->luma_size;
+    layout->chroma_size = desc->chroma_size;
+}
+
+// Release hook of the input pictures: hands the planes back to the application
+static void release_input_picture(void *hook_ctx, EbPtr object_ptr)
+{
+    EbEncHandle              *enc_handle_ptr = (EbEncHandle*)hook_ctx;
+    EbSvtAv1EncConfiguration *config = &enc_handle_ptr->scs_instance_array[0]->scs_ptr->static_config;
+    EbBufferHeaderType       *header = (EbBufferHeaderType*)object_ptr;
+    EbPictureBufferDesc      *input_picture_ptr = (EbPictureBufferDesc*)header->p_buffer;
+
+    if (input_picture_ptr->buffer_y == NULL)
+        return;
+    input_picture_ptr->buffer_y = NULL;
+    input_picture_ptr->buffer_cb = NULL;
+    input_picture_ptr->buffer_cr = NULL;
+    config->input_release_cb(config->input_release_ctx, header->p_app_private, header->pts);
+    header->p_app_private = NULL;
+}
+
+/*********************************
+* Entry of the dedicated stage threads
+*********************************/
+static void *stage_thread_entry(void *input_ptr)
+{
+    EbThreadContext *thread_context_ptr = (EbThreadContext *)input_ptr;
+    svt_system_resource_stage_begin();
+    thread_context_ptr->kernel(thread_context_ptr);
+    svt_system_resource_stage_end();
+    return NULL;
+}
+
+#define EB_CREATE_STAGE_THREAD(pointer, thread_function, thread_context) \
+    do {                                                                 \
+        (thread_context)->kernel = thread_function;                      \
+        EB_CREATE_THREAD(pointer, stage_thread_entry, thread_context);   \
+    } while (0)
+
+#define EB_CREATE_STAGE_THREAD_ARRAY(pa, count, thread_function, thread_contexts) \
+    do {                                                                          \
+        EB_ALLOC_PTR_ARRAY(pa, count);                                            \
+        for (uint32_t i = 0; i < count; i++)                                      \
+            EB_CREATE_STAGE_THREAD(pa[i], thread_function, thread_contexts[i]);   \
+    } while (0)
+
 void init_fn_ptr(void);
 void svt_av1_init_wedge_masks(void);
 /**********************************
@@ -1378,6 +1981,10 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
     uint32_t max_picture_width;
     EbColorFormat color_format = enc_handle_ptr->scs_instance_array[0]->scs_ptr->static_config.encoder_color_format;
     SequenceControlSet* control_set_ptr;
+    SvtAv1MemoryUsage init_usage;
+    // live_total stays 0 without memory tracking
+    init_usage.live_total = 0;
+    svt_mem_get_usage(&init_usage);
 
     setup_common_rtcd_internal(enc_handle_ptr->scs_instance_array[0]->scs_ptr->static_config.use_cpu_flags);
     setup_rtcd_internal(enc_handle_ptr->scs_instance_array[0]->scs_ptr->static_config.use_cpu_flags);
@@ -1397,6 +2004,10 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
     svt_av1_init_me_luts();
     init_fn_ptr();
     svt_av1_init_wedge_masks();
+    // NUMA mode: the pools are shared by the threads of all the nodes
+    if (enc_handle_ptr->scs_instance_array[0]->scs_ptr->static_config.numa_aware)
+        svt_numa_set_alloc_node(SVT_NUMA_NODE_INTERLEAVE);
+    svt_set_large_pages((EbLargePages)enc_handle_ptr->scs_instance_array[0]->scs_ptr->static_config.large_pages);
     /************************************
     * Sequence Control Set
     ************************************/
@@ -1650,12 +2261,14 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
             // Overlay Input Picture Buffers
             EB_NEW(
                 enc_handle_ptr->overlay_input_picture_pool_ptr_array[instance_index],
-                svt_system_resource_ctor,
+                picture_pool_ctor,
+                enc_handle_ptr->scs_instance_array[instance_index]->scs_ptr,
                 enc_handle_ptr->scs_instance_array[instance_index]->scs_ptr->overlay_input_picture_buffer_init_count,
                 1,
                 0,
                 svt_input_buffer_header_creator,
                 enc_handle_ptr->scs_instance_array[instance_index]->scs_ptr,
+                0,
                 svt_input_buffer_header_destroyer);
            // Set the SequenceControlSet Overlay input Picture Pool Fifo Ptrs
             enc_handle_ptr->scs_instance_array[instance_index]->encode_context_ptr->overlay_input_picture_pool_fifo_ptr = svt_system_resource_get_producer_fifo(enc_handle_ptr->overlay_input_picture_pool_ptr_array[instance_index], 0);
@@ -1666,18 +2279,26 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
     * System Resource Managers & Fifos
     ************************************/
 
-    // EbBufferHeaderType Input
+    // EbBufferHeaderType Input, without picture buffers when the planes of the application are referenced
     EB_NEW(
         enc_handle_ptr->input_buffer_resource_ptr,
-        svt_system_resource_ctor,
+        picture_pool_ctor,
+        enc_handle_ptr->scs_instance_array[0]->scs_ptr,
         enc_handle_ptr->scs_instance_array[0]->scs_ptr->input_buffer_fifo_init_count,
         1,
         EB_ResourceCoordinationProcessInitCount,
-        svt_input_buffer_header_creator,
+        enc_handle_ptr->scs_instance_array[0]->scs_ptr->static_config.zero_copy_input
+            ? svt_input_buffer_header_ref_creator
+            : svt_input_buffer_header_creator,
         enc_handle_ptr->scs_instance_array[0]->scs_ptr,
+        0,
         svt_input_buffer_header_destroyer);
 
     enc_handle_ptr->input_buffer_producer_fifo_ptr = svt_system_resource_get_producer_fifo(enc_handle_ptr->input_buffer_resource_ptr, 0);
+    init_input_layout(enc_handle_ptr);
+    if (enc_handle_ptr->scs_instance_array[0]->scs_ptr->static_config.zero_copy_input)
+        svt_system_resource_set_release_hook(
+            enc_handle_ptr->input_buffer_resource_ptr, release_input_picture, enc_handle_ptr);
 
 
     // EbBufferHeaderType Output Stream
@@ -1990,6 +2611,7 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
     ************************************/
 
     // Resource Coordination Context
+    numa_set_context_node(enc_handle_ptr, 0, 1);
     EB_NEW(
         enc_handle_ptr->resource_coordination_context_ptr,
         resource_coordination_context_ctor,
@@ -1999,7 +2621,7 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
     EB_ALLOC_PTR_ARRAY(enc_handle_ptr->picture_analysis_context_ptr_array, enc_handle_ptr->scs_instance_array[0]->scs_ptr->picture_analysis_process_init_count);
 
     for (process_index = 0; process_index < enc_handle_ptr->scs_instance_array[0]->scs_ptr->picture_analysis_process_init_count; ++process_index) {
-
+        numa_set_context_node(enc_handle_ptr, process_index, enc_handle_ptr->scs_instance_array[0]->scs_ptr->picture_analysis_process_init_count);
         EB_NEW(
             enc_handle_ptr->picture_analysis_context_ptr_array[process_index],
             picture_analysis_context_ctor,
@@ -2012,6 +2634,7 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
         // Initialize the various Picture types
         instance_index = 0;
 
+        numa_set_context_node(enc_handle_ptr, 0, 1);
         EB_NEW(
             enc_handle_ptr->picture_decision_context_ptr,
             picture_decision_context_ctor,
@@ -2022,6 +2645,7 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
     EB_ALLOC_PTR_ARRAY(enc_handle_ptr->motion_estimation_context_ptr_array, enc_handle_ptr->scs_instance_array[0]->scs_ptr->motion_estimation_process_init_count);
 
     for (process_index = 0; process_index < enc_handle_ptr->scs_instance_array[0]->scs_ptr->motion_estimation_process_init_count; ++process_index) {
+        numa_set_context_node(enc_handle_ptr, process_index, enc_handle_ptr->scs_instance_array[0]->scs_ptr->motion_estimation_process_init_count);
         EB_NEW(
             enc_handle_ptr->motion_estimation_context_ptr_array[process_index],
             motion_estimation_context_ctor,
@@ -2030,6 +2654,7 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
     }
 
     // Initial Rate Control Context
+    numa_set_context_node(enc_handle_ptr, 0, 1);
     EB_NEW(
         enc_handle_ptr->initial_rate_control_context_ptr,
         initial_rate_control_context_ctor,
@@ -2038,6 +2663,7 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
     EB_ALLOC_PTR_ARRAY(enc_handle_ptr->source_based_operations_context_ptr_array, enc_handle_ptr->scs_instance_array[0]->scs_ptr->source_based_operations_process_init_count);
 
     for (process_index = 0; process_index < enc_handle_ptr->scs_instance_array[0]->scs_ptr->source_based_operations_process_init_count; ++process_index) {
+        numa_set_context_node(enc_handle_ptr, process_index, enc_handle_ptr->scs_instance_array[0]->scs_ptr->source_based_operations_process_init_count);
         EB_NEW(
             enc_handle_ptr->source_based_operations_context_ptr_array[process_index],
             source_based_operations_context_ctor,
@@ -2050,6 +2676,7 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
     EB_ALLOC_PTR_ARRAY(enc_handle_ptr->tpl_disp_context_ptr_array, enc_handle_ptr->scs_instance_array[0]->scs_ptr->tpl_disp_process_init_count);
 
     for (process_index = 0; process_index < enc_handle_ptr->scs_instance_array[0]->scs_ptr->tpl_disp_process_init_count; ++process_index) {
+        numa_set_context_node(enc_handle_ptr, process_index, enc_handle_ptr->scs_instance_array[0]->scs_ptr->tpl_disp_process_init_count);
 #if TUNE_PICT_PARALLEL
         EB_NEW(
             enc_handle_ptr->tpl_disp_context_ptr_array[process_index],
@@ -2070,6 +2697,7 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
     }
 #endif
     // Picture Manager Context
+    numa_set_context_node(enc_handle_ptr, 0, 1);
     EB_NEW(
         enc_handle_ptr->picture_manager_context_ptr,
         picture_manager_context_ctor,
@@ -2080,6 +2708,7 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
     EB_ALLOC_PTR_ARRAY(enc_handle_ptr->inlme_context_ptr_array, enc_handle_ptr->scs_instance_array[0]->scs_ptr->inlme_process_init_count);
 
     for (process_index = 0; process_index < enc_handle_ptr->scs_instance_array[0]->scs_ptr->inlme_process_init_count; ++process_index) {
+        numa_set_context_node(enc_handle_ptr, process_index, enc_handle_ptr->scs_instance_array[0]->scs_ptr->inlme_process_init_count);
         EB_NEW(
             enc_handle_ptr->inlme_context_ptr_array[process_index],
             ime_context_ctor,
@@ -2088,6 +2717,7 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
     }
 
     // Rate Control Context
+    numa_set_context_node(enc_handle_ptr, 0, 1);
     EB_NEW(
         enc_handle_ptr->rate_control_context_ptr,
         rate_control_context_ctor,
@@ -2099,6 +2729,7 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
         EB_ALLOC_PTR_ARRAY(enc_handle_ptr->mode_decision_configuration_context_ptr_array, enc_handle_ptr->scs_instance_array[0]->scs_ptr->mode_decision_configuration_process_init_count);
 
         for (process_index = 0; process_index < enc_handle_ptr->scs_instance_array[0]->scs_ptr->mode_decision_configuration_process_init_count; ++process_index) {
+            numa_set_context_node(enc_handle_ptr, process_index, enc_handle_ptr->scs_instance_array[0]->scs_ptr->mode_decision_configuration_process_init_count);
             EB_NEW(
                 enc_handle_ptr->mode_decision_configuration_context_ptr_array[process_index],
                 mode_decision_configuration_context_ctor,
@@ -2117,6 +2748,7 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
     // EncDec Contexts
     EB_ALLOC_PTR_ARRAY(enc_handle_ptr->enc_dec_context_ptr_array, enc_handle_ptr->scs_instance_array[0]->scs_ptr->enc_dec_process_init_count);
     for (process_index = 0; process_index < enc_handle_ptr->scs_instance_array[0]->scs_ptr->enc_dec_process_init_count; ++process_index) {
+        numa_set_context_node(enc_handle_ptr, process_index, enc_handle_ptr->scs_instance_array[0]->scs_ptr->enc_dec_process_init_count);
         EB_NEW(
             enc_handle_ptr->enc_dec_context_ptr_array[process_index],
             enc_dec_context_ctor,
@@ -2130,6 +2762,7 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
     EB_ALLOC_PTR_ARRAY(enc_handle_ptr->dlf_context_ptr_array, enc_handle_ptr->scs_instance_array[0]->scs_ptr->dlf_process_init_count);
 
     for (process_index = 0; process_index < enc_handle_ptr->scs_instance_array[0]->scs_ptr->dlf_process_init_count; ++process_index) {
+        numa_set_context_node(enc_handle_ptr, process_index, enc_handle_ptr->scs_instance_array[0]->scs_ptr->dlf_process_init_count);
         EB_NEW(
             enc_handle_ptr->dlf_context_ptr_array[process_index],
             dlf_context_ctor,
@@ -2141,6 +2774,7 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
     EB_ALLOC_PTR_ARRAY(enc_handle_ptr->cdef_context_ptr_array, enc_handle_ptr->scs_instance_array[0]->scs_ptr->cdef_process_init_count);
 
     for (process_index = 0; process_index < enc_handle_ptr->scs_instance_array[0]->scs_ptr->cdef_process_init_count; ++process_index) {
+        numa_set_context_node(enc_handle_ptr, process_index, enc_handle_ptr->scs_instance_array[0]->scs_ptr->cdef_process_init_count);
         EB_NEW(
             enc_handle_ptr->cdef_context_ptr_array[process_index],
             cdef_context_ctor,
@@ -2151,6 +2785,7 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
     EB_ALLOC_PTR_ARRAY(enc_handle_ptr->rest_context_ptr_array, enc_handle_ptr->scs_instance_array[0]->scs_ptr->rest_process_init_count);
 
     for (process_index = 0; process_index < enc_handle_ptr->scs_instance_array[0]->scs_ptr->rest_process_init_count; ++process_index) {
+        numa_set_context_node(enc_handle_ptr, process_index, enc_handle_ptr->scs_instance_array[0]->scs_ptr->rest_process_init_count);
         EB_NEW(
             enc_handle_ptr->rest_context_ptr_array[process_index],
             rest_context_ctor,
@@ -2163,6 +2798,7 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
     EB_ALLOC_PTR_ARRAY(enc_handle_ptr->entropy_coding_context_ptr_array, enc_handle_ptr->scs_instance_array[0]->scs_ptr->entropy_coding_process_init_count);
 
     for (process_index = 0; process_index < enc_handle_ptr->scs_instance_array[0]->scs_ptr->entropy_coding_process_init_count; ++process_index) {
+        numa_set_context_node(enc_handle_ptr, process_index, enc_handle_ptr->scs_instance_array[0]->scs_ptr->entropy_coding_process_init_count);
         EB_NEW(
             enc_handle_ptr->entropy_coding_context_ptr_array[process_index],
             entropy_coding_context_ctor,
@@ -2172,6 +2808,7 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
     }
 
     // Packetization Context
+    numa_set_context_node(enc_handle_ptr, 0, 1);
     EB_NEW(
         enc_handle_ptr->packetization_context_ptr,
         packetization_context_ctor,
@@ -2180,6 +2817,9 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
         enc_handle_ptr->scs_instance_array[0]->scs_ptr->source_based_operations_process_init_count +
             enc_handle_ptr->scs_instance_array[0]->scs_ptr->enc_dec_process_init_count);
 
+    svt_numa_set_alloc_node(SVT_NUMA_NODE_ANY);
+    svt_set_large_pages(SVT_LARGE_PAGES_OFF);
+
     /************************************
     * Thread Handles
     ************************************/
@@ -2188,86 +2828,116 @@ EB_API EbErrorType svt_av1_enc_init(EbComponentType *svt_enc_component)
         svt_set_thread_management_parameters(config_ptr);
 
     control_set_ptr = enc_handle_ptr->scs_instance_array[0]->scs_ptr;
+    enc_handle_ptr->scs_instance_array[0]->encode_context_ptr->pipeline_start_ns =
+        svt_av1_get_time_ns();
+    enc_handle_ptr->scs_instance_array[0]->encode_context_ptr->enc_mode = config_ptr->enc_mode;
+    if (config_ptr->trace_file)
+        EB_NEW(enc_handle_ptr->scs_instance_array[0]->encode_context_ptr->tracer_ptr,
+               svt_tracer_ctor,
+               pipeline_stage_names,
+               SVT_AV1_STAGE_COUNT,
+               PIPELINE_TRACE_MAX_EVENTS);
 
     // Resource Coordination
-    EB_CREATE_THREAD(enc_handle_ptr->resource_coordination_thread_handle, resource_coordination_kernel, enc_handle_ptr->resource_coordination_context_ptr);
-    EB_CREATE_THREAD_ARRAY(enc_handle_ptr->picture_analysis_thread_handle_array,control_set_ptr->picture_analysis_process_init_count,
-        picture_analysis_kernel,
-        enc_handle_ptr->picture_analysis_context_ptr_array);
+    EB_CREATE_STAGE_THREAD(enc_handle_ptr->resource_coordination_thread_handle, resource_coordination_kernel, enc_handle_ptr->resource_coordination_context_ptr);
 
     // Picture Decision
-    EB_CREATE_THREAD(enc_handle_ptr->picture_decision_thread_handle, picture_decision_kernel, enc_handle_ptr->picture_decision_context_ptr);
-
-    // Motion Estimation
-    EB_CREATE_THREAD_ARRAY(enc_handle_ptr->motion_estimation_thread_handle_array, control_set_ptr->motion_estimation_process_init_count,
-        motion_estimation_kernel,
-        enc_handle_ptr->motion_estimation_context_ptr_array);
+    EB_CREATE_STAGE_THREAD(enc_handle_ptr->picture_decision_thread_handle, picture_decision_kernel, enc_handle_ptr->picture_decision_context_ptr);
 
     // Initial Rate Control
-    EB_CREATE_THREAD(enc_handle_ptr->initial_rate_control_thread_handle, initial_rate_control_kernel, enc_handle_ptr->initial_rate_control_context_ptr);
+    EB_CREATE_STAGE_THREAD(enc_handle_ptr->initial_rate_control_thread_handle, initial_rate_control_kernel, enc_handle_ptr->initial_rate_control_context_ptr);
 
     // Source Based Oprations
-    EB_CREATE_THREAD_ARRAY(enc_handle_ptr->source_based_operations_thread_handle_array, control_set_ptr->source_based_operations_process_init_count,
+    EB_CREATE_STAGE_THREAD_ARRAY(enc_handle_ptr->source_based_operations_thread_handle_array, control_set_ptr->source_based_operations_process_init_count,
         source_based_operations_kernel,
         enc_handle_ptr->source_based_operations_context_ptr_array);
 
-#if TPL_KERNEL
-    // TPL dispenser
-    EB_CREATE_THREAD_ARRAY(enc_handle_ptr->tpl_disp_thread_handle_array, control_set_ptr->tpl_disp_process_init_count,
-            tpl_disp_kernel,//TODOOMK
-            enc_handle_ptr->tpl_disp_context_ptr_array);
-#endif
     // Picture Manager
-    EB_CREATE_THREAD(enc_handle_ptr->picture_manager_thread_handle, picture_manager_kernel, enc_handle_ptr->picture_manager_context_ptr);
-
-    // Close Loop Motion Estimation
-    EB_CREATE_THREAD_ARRAY(enc_handle_ptr->ime_thread_handle_array, control_set_ptr->inlme_process_init_count,
-            inloop_me_kernel,
-            enc_handle_ptr->inlme_context_ptr_array);
+    EB_CREATE_STAGE_THREAD(enc_handle_ptr->picture_manager_thread_handle, picture_manager_kernel, enc_handle_ptr->picture_manager_context_ptr);
 
     // Rate Control
-    EB_CREATE_THREAD(enc_handle_ptr->rate_control_thread_handle, rate_control_kernel, enc_handle_ptr->rate_control_context_ptr);
+    EB_CREATE_STAGE_THREAD(enc_handle_ptr->rate_control_thread_handle, rate_control_kernel, enc_handle_ptr->rate_control_context_ptr);
 
-    // Mode Decision Configuration Process
-    EB_CREATE_THREAD_ARRAY(enc_handle_ptr->mode_decision_configuration_thread_handle_array, control_set_ptr->mode_decision_configuration_process_init_count,
-        mode_decision_configuration_kernel,
-        enc_handle_ptr->mode_decision_configuration_context_ptr_array);
-
-
-    // EncDec Process
-    EB_CREATE_THREAD_ARRAY(enc_handle_ptr->enc_dec_thread_handle_array, control_set_ptr->enc_dec_process_init_count,
-        mode_decision_kernel,
-        enc_handle_ptr->enc_dec_context_ptr_array);
-
-    // Dlf Process
-    EB_CREATE_THREAD_ARRAY(enc_handle_ptr->dlf_thread_handle_array, control_set_ptr->dlf_process_init_count,
-        dlf_kernel,
-        enc_handle_ptr->dlf_context_ptr_array);
+    if (config_ptr->task_scheduler) {
+        return_error = create_kernel_jobs(enc_handle_ptr);
+        if (return_error != EB_ErrorNone)
+            return return_error;
+    } else {
+        // Picture Analysis
+        EB_CREATE_STAGE_THREAD_ARRAY(enc_handle_ptr->picture_analysis_thread_handle_array,control_set_ptr->picture_analysis_process_init_count,
+            picture_analysis_kernel,
+            enc_handle_ptr->picture_analysis_context_ptr_array);
 
-    // Cdef Process
-    EB_CREATE_THREAD_ARRAY(enc_handle_ptr->cdef_thread_handle_array, control_set_ptr->cdef_process_init_count,
-        cdef_kernel,
-        enc_handle_ptr->cdef_context_ptr_array);
+        // Motion Estimation
+        EB_CREATE_STAGE_THREAD_ARRAY(enc_handle_ptr->motion_estimation_thread_handle_array, control_set_ptr->motion_estimation_process_init_count,
+            motion_estimation_kernel,
+            enc_handle_ptr->motion_estimation_context_ptr_array);
 
-    // Rest Process
-    EB_CREATE_THREAD_ARRAY(enc_handle_ptr->rest_thread_handle_array, control_set_ptr->rest_process_init_count,
-        rest_kernel,
-        enc_handle_ptr->rest_context_ptr_array);
+#if TPL_KERNEL
+        // TPL dispenser
+        EB_CREATE_STAGE_THREAD_ARRAY(enc_handle_ptr->tpl_disp_thread_handle_array, control_set_ptr->tpl_disp_process_init_count,
+                tpl_disp_kernel,//TODOOMK
+                enc_handle_ptr->tpl_disp_context_ptr_array);
+#endif
 
-    // Entropy Coding Process
-    EB_CREATE_THREAD_ARRAY(enc_handle_ptr->entropy_coding_thread_handle_array, control_set_ptr->entropy_coding_process_init_count,
-        entropy_coding_kernel,
-        enc_handle_ptr->entropy_coding_context_ptr_array);
+        // Close Loop Motion Estimation
+        EB_CREATE_STAGE_THREAD_ARRAY(enc_handle_ptr->ime_thread_handle_array, control_set_ptr->inlme_process_init_count,
+                inloop_me_kernel,
+                enc_handle_ptr->inlme_context_ptr_array);
+
+        // Mode Decision Configuration Process
+        EB_CREATE_STAGE_THREAD_ARRAY(enc_handle_ptr->mode_decision_configuration_thread_handle_array, control_set_ptr->mode_decision_configuration_process_init_count,
+            mode_decision_configuration_kernel,
+            enc_handle_ptr->mode_decision_configuration_context_ptr_array);
+
+        // EncDec Process
+        EB_CREATE_STAGE_THREAD_ARRAY(enc_handle_ptr->enc_dec_thread_handle_array, control_set_ptr->enc_dec_process_init_count,
+            mode_decision_kernel,
+            enc_handle_ptr->enc_dec_context_ptr_array);
+
+        // Dlf Process
+        EB_CREATE_STAGE_THREAD_ARRAY(enc_handle_ptr->dlf_thread_handle_array, control_set_ptr->dlf_process_init_count,
+            dlf_kernel,
+            enc_handle_ptr->dlf_context_ptr_array);
+
+        // Cdef Process
+        EB_CREATE_STAGE_THREAD_ARRAY(enc_handle_ptr->cdef_thread_handle_array, control_set_ptr->cdef_process_init_count,
+            cdef_kernel,
+            enc_handle_ptr->cdef_context_ptr_array);
+
+        // Rest Process
+        EB_CREATE_STAGE_THREAD_ARRAY(enc_handle_ptr->rest_thread_handle_array, control_set_ptr->rest_process_init_count,
+            rest_kernel,
+            enc_handle_ptr->rest_context_ptr_array);
+
+        // Entropy Coding Process
+        EB_CREATE_STAGE_THREAD_ARRAY(enc_handle_ptr->entropy_coding_thread_handle_array, control_set_ptr->entropy_coding_process_init_count,
+            entropy_coding_kernel,
+            enc_handle_ptr->entropy_coding_context_ptr_array);
+
+        if (config_ptr->stage_balancing) {
+            return_error = create_stage_balancer(enc_handle_ptr);
+            if (return_error != EB_ErrorNone)
+                return return_error;
+        }
+    }
 
     // Packetization
-    EB_CREATE_THREAD(enc_handle_ptr->packetization_thread_handle, packetization_kernel, enc_handle_ptr->packetization_context_ptr);
+    EB_CREATE_STAGE_THREAD(enc_handle_ptr->packetization_thread_handle, packetization_kernel, enc_handle_ptr->packetization_context_ptr);
+
+    if (config_ptr->numa_aware)
+        numa_place_stage_threads(enc_handle_ptr);
 
 #if DISPLAY_MEMORY
     EB_MEMORY();
 #endif
     svt_print_memory_usage();
+    svt_mem_sample_peak();
 
-    return return_error;
+    if (return_error != EB_ErrorNone)
+        return return_error;
+    return check_memory_budget(enc_handle_ptr->scs_instance_array[0]->scs_ptr,
+                               init_usage.live_total);
 }
 
 /**********************************
@@ -2298,6 +2968,13 @@ EB_API EbErrorType svt_av1_enc_deinit(EbComponentType *svt_enc_component){
         svt_shutdown_process(handle->dlf_results_resource_ptr);
         svt_shutdown_process(handle->cdef_results_resource_ptr);
         svt_shutdown_process(handle->rest_results_resource_ptr);
+
+        // The pipeline is drained: the stage threads wait for input
+        EbSequenceControlSetInstance *scs_instance =
+            handle->scs_instance_array ? handle->scs_instance_array[0] : NULL;
+        if (scs_instance && scs_instance->encode_context_ptr->tracer_ptr)
+            svt_tracer_write_json(scs_instance->encode_context_ptr->tracer_ptr,
+                                  scs_instance->scs_ptr->static_config.trace_file);
     }
 
     return EB_ErrorNone;
@@ -2843,6 +3520,9 @@ void set_param_based_on_input(SequenceControlSet *scs_ptr)
         scs_ptr->static_config.enable_tpl_la = 1;
         scs_ptr->static_config.intra_refresh_type = 2;
     }
+    // Low delay: TPL propagates from future pictures, none is held back for it
+    if (scs_ptr->static_config.pred_structure != EB_PRED_RANDOM_ACCESS)
+        scs_ptr->static_config.enable_tpl_la = 0;
 
     if (scs_ptr->static_config.recode_loop > 0 &&
         (!scs_ptr->static_config.rate_control_mode || (!scs_ptr->lap_enabled && !use_input_stat(scs_ptr)))) {
@@ -2933,6 +3613,7 @@ void set_param_based_on_input(SequenceControlSet *scs_ptr)
         (scs_ptr->static_config.altref_nframes <= 1) ||
 #endif
         (scs_ptr->static_config.rate_control_mode > 0) ||
+        scs_ptr->static_config.pred_structure != EB_PRED_RANDOM_ACCESS ||
         scs_ptr->static_config.encoder_bit_depth != EB_8BIT ?
         0 : scs_ptr->static_config.enable_overlays;
     //0: ON
@@ -2995,6 +3676,9 @@ void set_param_based_on_input(SequenceControlSet *scs_ptr)
 #if FTR_USE_LAD_TPL
     uint8_t lad_mg = 1; // Specify the number of mini-gops to be used as LAD. 0: 1 mini-gop, 1: 2 mini-gops and 3: 3 mini-gops
     scs_ptr->lad_mg = MIN(2,lad_mg);// lad_mg is capped to 2 because tpl was optimised only for 1,2 and 3 mini-gops
+    // Low delay: no mini-gop is held back to look ahead
+    if (scs_ptr->static_config.pred_structure != EB_PRED_RANDOM_ACCESS)
+        scs_ptr->lad_mg = 0;
 #else
     scs_ptr->lad_mg = 0;
 #endif
@@ -3047,7 +3731,7 @@ void copy_api_from_app(
     scs_ptr->max_input_luma_height = config_struct->source_height;
     scs_ptr->frame_rate = ((EbSvtAv1EncConfiguration*)config_struct)->frame_rate;
     // SB Definitions
-    scs_ptr->static_config.pred_structure = 2; // Hardcoded(Cleanup)
+    scs_ptr->static_config.pred_structure = ((EbSvtAv1EncConfiguration*)config_struct)->pred_structure;
     scs_ptr->static_config.enable_qp_scaling_flag = 1;
     scs_ptr->max_blk_size = (uint8_t)64;
     scs_ptr->min_blk_size = (uint8_t)8;
@@ -3232,7 +3916,9 @@ void copy_api_from_app(
     scs_ptr->static_config.recode_loop         = ((EbSvtAv1EncConfiguration*)config_struct)->recode_loop;
 #if FTR_VBR_MT
 #if CLN_OLD_RC
-    if (scs_ptr->static_config.rate_control_mode && !use_output_stat(scs_ptr) && !use_input_stat(scs_ptr))
+    // CBR codes each picture as it comes, without the lookahead stats
+    if (scs_ptr->static_config.rate_control_mode && scs_ptr->static_config.rate_control_mode != 3 &&
+        !use_output_stat(scs_ptr) && !use_input_stat(scs_ptr))
 #else
     if (scs_ptr->static_config.rate_control_mode && !use_output_stat(scs_ptr) && !use_input_stat(scs_ptr) && scs_ptr->static_config.hierarchical_levels > 1)
 #endif
@@ -3290,8 +3976,54 @@ void copy_api_from_app(
         SVT_WARN("unpin 1 and ss %d is not a valid combination: unpin will be set to 0\n", scs_ptr->static_config.target_socket);
         scs_ptr->static_config.unpin = 0;
     }
+    scs_ptr->static_config.task_scheduler = ((EbSvtAv1EncConfiguration*)config_struct)->task_scheduler;
+#if !SRM_LOCK_FREE
+    if (scs_ptr->static_config.task_scheduler) {
+        SVT_WARN("task_scheduler requires the lock-free system resource queues: task_scheduler will be set to 0\n");
+        scs_ptr->static_config.task_scheduler = 0;
+    }
+#endif
+    scs_ptr->static_config.stage_balancing = ((EbSvtAv1EncConfiguration*)config_struct)->stage_balancing;
+#if !SRM_LOCK_FREE
+    if (scs_ptr->static_config.stage_balancing) {
+        SVT_WARN("stage_balancing requires the lock-free system resource queues: stage_balancing will be set to 0\n");
+        scs_ptr->static_config.stage_balancing = 0;
+    }
+#endif
+    scs_ptr->static_config.numa_aware = ((EbSvtAv1EncConfiguration*)config_struct)->numa_aware;
+#if !HAVE_NUMA
+    if (scs_ptr->static_config.numa_aware) {
+        SVT_WARN("numa_aware requires a Linux build with ENABLE_NUMA: numa_aware will be set to 0\n");
+        scs_ptr->static_config.numa_aware = 0;
+    }
+#endif
+    if (scs_ptr->static_config.numa_aware && scs_ptr->static_config.target_socket != -1) {
+        SVT_WARN("numa_aware 1 and ss %d is not a valid combination: numa_aware will be set to 0\n", scs_ptr->static_config.target_socket);
+        scs_ptr->static_config.numa_aware = 0;
+    }
+    scs_ptr->static_config.executor = ((EbSvtAv1EncConfiguration*)config_struct)->executor;
+    scs_ptr->static_config.executor_weight = ((EbSvtAv1EncConfiguration*)config_struct)->executor_weight;
+    scs_ptr->static_config.zero_copy_input = ((EbSvtAv1EncConfiguration*)config_struct)->zero_copy_input;
+    scs_ptr->static_config.elastic_pools = ((EbSvtAv1EncConfiguration*)config_struct)->elastic_pools;
+    scs_ptr->static_config.memory_budget_mb = ((EbSvtAv1EncConfiguration*)config_struct)->memory_budget_mb;
+    scs_ptr->static_config.large_pages = ((EbSvtAv1EncConfiguration*)config_struct)->large_pages;
+    scs_ptr->static_config.input_release_cb = ((EbSvtAv1EncConfiguration*)config_struct)->input_release_cb;
+    scs_ptr->static_config.input_release_ctx = ((EbSvtAv1EncConfiguration*)config_struct)->input_release_ctx;
+    if (scs_ptr->static_config.zero_copy_input && scs_ptr->static_config.encoder_bit_depth > EB_8BIT) {
+        SVT_WARN("zero_copy_input only references 8-bit input: the 10-bit input will be copied\n");
+        scs_ptr->static_config.zero_copy_input = 0;
+    }
+#if !SRM_LOCK_FREE
+    if (scs_ptr->static_config.executor) {
+        SVT_WARN("executor requires the lock-free system resource queues: the handle will use its own threads\n");
+        scs_ptr->static_config.executor = NULL;
+    }
+#endif
+    if (scs_ptr->static_config.executor)
+        scs_ptr->static_config.task_scheduler = 1;
     scs_ptr->static_config.qp = ((EbSvtAv1EncConfiguration*)config_struct)->qp;
     scs_ptr->static_config.recon_enabled = ((EbSvtAv1EncConfiguration*)config_struct)->recon_enabled;
+    scs_ptr->static_config.trace_file = ((EbSvtAv1EncConfiguration*)config_struct)->trace_file;
     scs_ptr->static_config.enable_tpl_la = ((EbSvtAv1EncConfiguration*)config_struct)->enable_tpl_la;
     // Extract frame rate from Numerator and Denominator if not 0
     if (scs_ptr->static_config.frame_rate_numerator != 0 && scs_ptr->static_config.frame_rate_denominator != 0)
@@ -3436,8 +4168,8 @@ static EbErrorType verify_settings(
         return_error = EB_ErrorBadParameter;
     }
 
-    if (config->pred_structure != 2) {
-        SVT_LOG("Error instance %u: Pred Structure must be [2]\n", channel_number + 1);
+    if (config->pred_structure > EB_PRED_RANDOM_ACCESS) {
+        SVT_LOG("Error instance %u: Pred Structure must be [0-2]\n", channel_number + 1);
         return_error = EB_ErrorBadParameter;
     }
     if (scs_ptr->max_input_luma_width % 8 && scs_ptr->static_config.compressed_ten_bit_format == 1) {
@@ -3587,13 +4319,13 @@ static EbErrorType verify_settings(
         return_error = EB_ErrorBadParameter;
     }
 #endif
-    if (config->rate_control_mode > 2) {
+    if (config->rate_control_mode > 3) {
 
-        SVT_LOG("Error Instance %u: The rate control mode must be [0 - 2] \n", channel_number + 1);
+        SVT_LOG("Error Instance %u: The rate control mode must be [0 - 3] \n", channel_number + 1);
         return_error = EB_ErrorBadParameter;
     }
-    if ((config->rate_control_mode == 3|| config->rate_control_mode == 2) && config->look_ahead_distance != (uint32_t)config->intra_period_length && config->intra_period_length >= 0) {
-        SVT_LOG("Error Instance %u: The rate control mode 2/3 LAD must be equal to intra_period \n", channel_number + 1);
+    if (config->rate_control_mode == 2 && config->look_ahead_distance != (uint32_t)config->intra_period_length && config->intra_period_length >= 0) {
+        SVT_LOG("Error Instance %u: The rate control mode 2 LAD must be equal to intra_period \n", channel_number + 1);
         return_error = EB_ErrorBadParameter;
     }
     if (config->look_ahead_distance > MAX_LAD && config->look_ahead_distance != (uint32_t)~0) {
@@ -3716,6 +4448,46 @@ static EbErrorType verify_settings(
         return_error = EB_ErrorBadParameter;
     }
 
+    if (config->task_scheduler > 1) {
+        SVT_LOG("Error instance %u: Invalid task_scheduler. task_scheduler must be [0 - 1] \n", channel_number + 1);
+        return_error = EB_ErrorBadParameter;
+    }
+
+    if (config->stage_balancing > 1) {
+        SVT_LOG("Error instance %u: Invalid stage_balancing. stage_balancing must be [0 - 1] \n", channel_number + 1);
+        return_error = EB_ErrorBadParameter;
+    }
+
+    if (config->numa_aware > 1) {
+        SVT_LOG("Error instance %u: Invalid numa_aware. numa_aware must be [0 - 1] \n", channel_number + 1);
+        return_error = EB_ErrorBadParameter;
+    }
+
+    if (config->executor && (config->executor_weight < 1 || config->executor_weight > 100)) {
+        SVT_LOG("Error instance %u: Invalid executor_weight. executor_weight must be [1 - 100] \n", channel_number + 1);
+        return_error = EB_ErrorBadParameter;
+    }
+
+    if (config->zero_copy_input > 1) {
+        SVT_LOG("Error instance %u: Invalid zero_copy_input. zero_copy_input must be [0 - 1] \n", channel_number + 1);
+        return_error = EB_ErrorBadParameter;
+    }
+
+    if (config->elastic_pools > 1) {
+        SVT_LOG("Error instance %u: Invalid elastic_pools. elastic_pools must be [0 - 1] \n", channel_number + 1);
+        return_error = EB_ErrorBadParameter;
+    }
+
+    if (config->large_pages > 2) {
+        SVT_LOG("Error instance %u: Invalid large_pages. large_pages must be [0 - 2] \n", channel_number + 1);
+        return_error = EB_ErrorBadParameter;
+    }
+
+    if (config->zero_copy_input && config->input_release_cb == NULL) {
+        SVT_LOG("Error instance %u: zero_copy_input requires input_release_cb \n", channel_number + 1);
+        return_error = EB_ErrorBadParameter;
+    }
+
 #if !TUNE_REDESIGN_TF_CTRLS
     // alt-ref frames related
     if (config->altref_strength > ALTREF_MAX_STRENGTH ) {
@@ -4143,11 +4915,23 @@ EbErrorType svt_svt_enc_init_parameter(
     config_ptr->logical_processors = 0;
     config_ptr->unpin = 1;
     config_ptr->target_socket = -1;
+    config_ptr->task_scheduler = 0;
+    config_ptr->stage_balancing = 0;
+    config_ptr->numa_aware = 0;
+    config_ptr->executor = NULL;
+    config_ptr->executor_weight = 1;
+    config_ptr->zero_copy_input = 0;
+    config_ptr->input_release_cb = NULL;
+    config_ptr->input_release_ctx = NULL;
+    config_ptr->elastic_pools = 0;
+    config_ptr->memory_budget_mb = 0;
+    config_ptr->large_pages = 0;
     config_ptr->channel_id = 0;
     config_ptr->active_channel_count = 1;
 
     // Debug info
     config_ptr->recon_enabled = 0;
+    config_ptr->trace_file = NULL;
 
     // Alt-Ref default values
     config_ptr->tf_level = DEFAULT;
@@ -4219,8 +5003,14 @@ static void print_lib_params(
         SVT_LOG("\nSVT [config]: RCMode / TargetBitrate (kbps)/ LookaheadDistance / SceneChange\t\t: VBR / %d / %d / %d ", (int)config->target_bit_rate/1000, config->look_ahead_distance, config->scene_change_detection);
     else if (config->rate_control_mode == 2)
         SVT_LOG("\nSVT [config]: RCMode / TargetBitrate (kbps)/ LookaheadDistance / SceneChange\t\t: Constraint VBR / %d / %d / %d ", (int)config->target_bit_rate/1000, config->look_ahead_distance, config->scene_change_detection);
+    else if (config->rate_control_mode == 3)
+        SVT_LOG("\nSVT [config]: RCMode / TargetBitrate (kbps)/ VBVBufSize (kbits) / SceneChange\t\t: CBR / %d / %d / %d ", (int)config->target_bit_rate/1000, (int)(config->vbv_bufsize ? config->vbv_bufsize : config->target_bit_rate)/1000, config->scene_change_detection);
     else
         SVT_LOG("\nSVT [config]: BRC Mode / %s / LookaheadDistance / SceneChange\t\t\t: %s / %d / %d / %d ", scs->static_config.enable_tpl_la ? "RF" : "QP", scs->static_config.enable_tpl_la ? "CRF" : "CQP", scs->static_config.qp, config->look_ahead_distance, config->scene_change_detection);
+    if (config->memory_budget_mb)
+        SVT_LOG("\nSVT [config]: MemoryBudget / Estimated (MB)\t\t\t\t\t\t: %u / %u", config->memory_budget_mb, scs->memory_report.estimated_mb);
+    if (config->large_pages)
+        SVT_LOG("\nSVT [config]: LargePages \t\t\t\t\t\t\t: %s", config->large_pages == 1 ? "THP" : "HugeTLB");
 #ifdef DEBUG_BUFFERS
     SVT_LOG("\nSVT [config]: INPUT / OUTPUT \t\t\t\t\t\t\t: %d / %d", scs->input_buffer_fifo_init_count, scs->output_stream_buffer_fifo_init_count);
 #if FTR_LAD_MG
@@ -4327,11 +5117,18 @@ EB_API EbErrorType svt_av1_enc_set_parameter(
         enc_handle->scs_instance_array[instance_index]->scs_ptr->max_ref_count,
         enc_handle->scs_instance_array[instance_index]->scs_ptr->max_temporal_layers);
 
+    SequenceControlSet *scs_ptr = enc_handle->scs_instance_array[instance_index]->scs_ptr;
+    const uint8_t       lad_mg  = scs_ptr->lad_mg;
+    const uint8_t       max_num_future_pics[2] = {
+        scs_ptr->static_config.tf_params_per_type[0].max_num_future_pics,
+        scs_ptr->static_config.tf_params_per_type[1].max_num_future_pics};
     return_error = load_default_buffer_configuration_settings(
 #if FTR_LAD_MG
         enc_handle,
 #endif
-        enc_handle->scs_instance_array[instance_index]->scs_ptr);
+        scs_ptr);
+    if (return_error == EB_ErrorNone)
+        log_memory_budget_reductions(scs_ptr, lad_mg, max_num_future_pics);
 
     print_lib_params(
         enc_handle->scs_instance_array[instance_index]->scs_ptr);
@@ -4623,6 +5420,49 @@ static void copy_input_buffer(
         copy_frame_buffer(sequenceControlSet, dst->p_buffer, src->p_buffer);
 }
 
+/**********************************
+* Zero copy input
+**********************************/
+static EbBool is_input_layout(const SvtAv1InputLayout *layout, const EbSvtIOFormat *input_ptr)
+{
+    return input_ptr->luma && input_ptr->cb && input_ptr->cr &&
+        input_ptr->y_stride == layout->y_stride &&
+        input_ptr->cb_stride == layout->cb_stride &&
+        input_ptr->cr_stride == layout->cr_stride;
+}
+
+// Point the library picture at the planes of the application; the buffer
+// pointers include the padding as for the library owned pictures
+static void reference_input_buffer(
+    SequenceControlSet  *scs_ptr,
+    EbBufferHeaderType  *dst,
+    EbBufferHeaderType  *src)
+{
+    EbPictureBufferDesc *input_picture_ptr = (EbPictureBufferDesc*)dst->p_buffer;
+    EbSvtIOFormat       *input_ptr = (EbSvtIOFormat*)src->p_buffer;
+    const uint32_t       ss_x = input_picture_ptr->color_format == EB_YUV444 ? 0 : 1;
+    const uint32_t       ss_y = input_picture_ptr->color_format >= EB_YUV422 ? 0 : 1;
+    const uint32_t       luma_buffer_offset =
+        input_picture_ptr->stride_y * scs_ptr->top_padding + scs_ptr->left_padding;
+    const uint32_t       chroma_buffer_offset =
+        input_picture_ptr->stride_cb * (scs_ptr->top_padding >> ss_y) + (scs_ptr->left_padding >> ss_x);
+
+    dst->n_alloc_len = src->n_alloc_len;
+    dst->n_filled_len = src->n_filled_len;
+    dst->flags = src->flags;
+    dst->pts = src->pts;
+    dst->n_tick_count = src->n_tick_count;
+    dst->size = src->size;
+    dst->qp = src->qp;
+    dst->pic_type = src->pic_type;
+    dst->p_app_private = src->p_app_private;
+    dst->metadata = NULL;
+
+    input_picture_ptr->buffer_y = input_ptr->luma - luma_buffer_offset;
+    input_picture_ptr->buffer_cb = input_ptr->cb - chroma_buffer_offset;
+    input_picture_ptr->buffer_cr = input_ptr->cr - chroma_buffer_offset;
+}
+
 /**********************************
 * Empty This Buffer
 **********************************/
@@ -4631,7 +5471,13 @@ EB_API EbErrorType svt_av1_enc_send_picture(
     EbBufferHeaderType   *p_buffer)
 {
     EbEncHandle          *enc_handle_ptr = (EbEncHandle*)svt_enc_component->p_component_private;
+    SequenceControlSet   *scs_ptr = enc_handle_ptr->scs_instance_array[0]->scs_ptr;
     EbObjectWrapper      *eb_wrapper_ptr;
+    const EbBool          reference = p_buffer != NULL && p_buffer->p_buffer != NULL &&
+        scs_ptr->static_config.zero_copy_input;
+
+    if (reference && !is_input_layout(&enc_handle_ptr->input_layout, (EbSvtIOFormat*)p_buffer->p_buffer))
+        return EB_ErrorBadParameter;
 
     // Take the buffer and put it into our internal queue structure
     svt_get_empty_object(
@@ -4642,10 +5488,16 @@ EB_API EbErrorType svt_av1_enc_send_picture(
         // Metadata is hardcoded to NULL until FFmpeg libsvtav1.c is compatible with new API
         p_buffer->metadata = NULL;
 
-        copy_input_buffer(
-            enc_handle_ptr->scs_instance_array[0]->scs_ptr,
-            (EbBufferHeaderType*)eb_wrapper_ptr->object_ptr,
-            p_buffer);
+        if (reference)
+            reference_input_buffer(
+                scs_ptr,
+                (EbBufferHeaderType*)eb_wrapper_ptr->object_ptr,
+                p_buffer);
+        else
+            copy_input_buffer(
+                scs_ptr,
+                (EbBufferHeaderType*)eb_wrapper_ptr->object_ptr,
+                p_buffer);
     }
 
     svt_post_full_object(eb_wrapper_ptr);
@@ -4711,6 +5563,8 @@ EB_API EbErrorType svt_av1_enc_get_packet(
 
         // save the wrapper pointer for the release
         (*p_buffer)->wrapper_ptr = (void*)eb_wrapper_ptr;
+        if (packet->flags & EB_BUFFERFLAG_EOS)
+            enc_handle->end_of_sequence_delivered = EB_TRUE;
     }
     else
         return_error = EB_NoErrorEmptyQueue;
@@ -4722,8 +5576,10 @@ EB_API void svt_av1_enc_release_out_buffer(
 {
     if (p_buffer && (*p_buffer)->wrapper_ptr)
     {
-        if((*p_buffer)->p_buffer)
-           EB_FREE((*p_buffer)->p_buffer);
+        // Return the bitstream buffer to the pool of its encoder
+        svt_packet_buffer_release((*p_buffer)->p_buffer);
+        (*p_buffer)->p_buffer = NULL;
+        svt_metadata_array_free(&(*p_buffer)->metadata);
         // Release out put buffer back into the pool
         svt_release_object((EbObjectWrapper  *)(*p_buffer)->wrapper_ptr);
      }
@@ -4832,7 +5688,8 @@ EbErrorType init_svt_av1_encoder_handle(
 
 static EbErrorType allocate_frame_buffer(
     SequenceControlSet       *scs_ptr,
-    EbBufferHeaderType        *input_buffer)
+    EbBufferHeaderType        *input_buffer,
+    EbBool                     reference)
 {
     EbErrorType   return_error = EB_ErrorNone;
     EbPictureBufferDescInitData input_pic_buf_desc_init_data;
@@ -4859,7 +5716,8 @@ static EbErrorType allocate_frame_buffer(
 
     input_pic_buf_desc_init_data.split_mode = is_16bit ? EB_TRUE : EB_FALSE;
 
-    input_pic_buf_desc_init_data.buffer_enable_mask = PICTURE_BUFFER_DESC_FULL_MASK;
+    // Referenced pictures get the planes of the application in svt_av1_enc_send_picture
+    input_pic_buf_desc_init_data.buffer_enable_mask = reference ? 0 : PICTURE_BUFFER_DESC_FULL_MASK;
     input_pic_buf_desc_init_data.is_16bit_pipeline = 0;
 
     if (is_16bit && config->compressed_ten_bit_format == 1)
@@ -4894,9 +5752,10 @@ static EbErrorType allocate_frame_buffer(
 /**************************************
 * EbBufferHeaderType Constructor
 **************************************/
-EbErrorType svt_input_buffer_header_creator(
+static EbErrorType input_buffer_header_create(
     EbPtr *object_dbl_ptr,
-    EbPtr  object_init_data_ptr)
+    EbPtr  object_init_data_ptr,
+    EbBool reference)
 {
     EbBufferHeaderType* input_buffer;
     SequenceControlSet        *scs_ptr = (SequenceControlSet*)object_init_data_ptr;
@@ -4909,7 +5768,8 @@ EbErrorType svt_input_buffer_header_creator(
 
     EbErrorType return_error = allocate_frame_buffer(
         scs_ptr,
-        input_buffer);
+        input_buffer,
+        reference);
     if (return_error != EB_ErrorNone)
         return return_error;
 
@@ -4918,6 +5778,20 @@ EbErrorType svt_input_buffer_header_creator(
     return EB_ErrorNone;
 }
 
+EbErrorType svt_input_buffer_header_creator(
+    EbPtr *object_dbl_ptr,
+    EbPtr  object_init_data_ptr)
+{
+    return input_buffer_header_create(object_dbl_ptr, object_init_data_ptr, EB_FALSE);
+}
+
+EbErrorType svt_input_buffer_header_ref_creator(
+    EbPtr *object_dbl_ptr,
+    EbPtr  object_init_data_ptr)
+{
+    return input_buffer_header_create(object_dbl_ptr, object_init_data_ptr, EB_TRUE);
+}
+
 void svt_input_buffer_header_destroyer(    EbPtr p)
 {
     EbBufferHeaderType *obj = (EbBufferHeaderType*)p;
@@ -4958,6 +5832,7 @@ EbErrorType svt_output_buffer_header_creator(
 void svt_output_buffer_header_destroyer(    EbPtr p)
 {
     EbBufferHeaderType* obj = (EbBufferHeaderType*)p;
+    svt_metadata_array_free(&obj->metadata);
     EB_FREE(obj);
 }
 
@@ -5018,6 +5893,281 @@ EB_API EbErrorType svt_av1_enc_get_stream_info(EbComponentType *    svt_enc_comp
         first_pass_stats->sz = context->stats_out.size * sizeof(FIRSTPASS_STATS);
         return EB_ErrorNone;
     }
+    if (stream_info_id == SVT_AV1_STREAM_INFO_STAGE_BALANCE) {
+        SvtAv1StageBalanceStats* stage_balance = (SvtAv1StageBalanceStats*)info;
+        if (enc_handle->stage_balancer_ptr)
+            svt_stage_balancer_get_stats(enc_handle->stage_balancer_ptr, stage_balance);
+        else
+            memset(stage_balance, 0, sizeof(*stage_balance));
+        return EB_ErrorNone;
+    }
+    if (stream_info_id == SVT_AV1_STREAM_INFO_INPUT_LAYOUT) {
+        *(SvtAv1InputLayout*)info = enc_handle->input_layout;
+        return EB_ErrorNone;
+    }
+    if (stream_info_id == SVT_AV1_STREAM_INFO_MEMORY_REPORT) {
+        *(SvtAv1MemoryReport*)info = enc_handle->scs_instance_array[0]->scs_ptr->memory_report;
+        return EB_ErrorNone;
+    }
+    if (stream_info_id == SVT_AV1_STREAM_INFO_MEMORY_USAGE)
+        return svt_mem_get_usage((SvtAv1MemoryUsage*)info);
     return EB_ErrorBadParameter;
 }
+
+/**********************************
+* svt_av1_enc_get_pipeline_stats get the per stage counters and
+* the latest picture timestamps from encoder
+**********************************/
+EB_API EbErrorType svt_av1_enc_get_pipeline_stats(EbComponentType *    svt_enc_component,
+                                                  SvtAv1PipelineStats *stats)
+{
+    if (svt_enc_component == NULL || stats == NULL)
+        return EB_ErrorBadParameter;
+    EbEncHandle   *enc_handle = (EbEncHandle*)svt_enc_component->p_component_private;
+    EncodeContext *context    = enc_handle->scs_instance_array[0]->encode_context_ptr;
+    // Input resource of every stage; NULL when the stage is not built
+    const struct {
+        SvtAv1PipelineStage stage;
+        EbSystemResource   *input_resource_ptr;
+    } stage_table[] = {
+        { SVT_AV1_STAGE_RESOURCE_COORDINATION, enc_handle->input_buffer_resource_ptr },
+        { SVT_AV1_STAGE_PICTURE_ANALYSIS, enc_handle->resource_coordination_results_resource_ptr },
+        { SVT_AV1_STAGE_PICTURE_DECISION, enc_handle->picture_analysis_results_resource_ptr },
+        { SVT_AV1_STAGE_MOTION_ESTIMATION, enc_handle->picture_decision_results_resource_ptr },
+        { SVT_AV1_STAGE_INITIAL_RATE_CONTROL, enc_handle->motion_estimation_results_resource_ptr },
+        { SVT_AV1_STAGE_SOURCE_BASED_OPERATIONS, enc_handle->initial_rate_control_results_resource_ptr },
+#if TPL_KERNEL
+        { SVT_AV1_STAGE_TPL_DISPENSER, enc_handle->tpl_disp_res_srm },
+#else
+        { SVT_AV1_STAGE_TPL_DISPENSER, NULL },
+#endif
+        { SVT_AV1_STAGE_PICTURE_MANAGER, enc_handle->picture_demux_results_resource_ptr },
+        { SVT_AV1_STAGE_INLOOP_ME, enc_handle->pic_mgr_res_srm },
+        { SVT_AV1_STAGE_RATE_CONTROL, enc_handle->rate_control_tasks_resource_ptr },
+        { SVT_AV1_STAGE_MODE_DECISION_CONFIGURATION, enc_handle->rate_control_results_resource_ptr },
+        { SVT_AV1_STAGE_ENC_DEC, enc_handle->enc_dec_tasks_resource_ptr },
+        { SVT_AV1_STAGE_DLF, enc_handle->enc_dec_results_resource_ptr },
+        { SVT_AV1_STAGE_CDEF, enc_handle->dlf_results_resource_ptr },
+        { SVT_AV1_STAGE_RESTORATION, enc_handle->cdef_results_resource_ptr },
+        { SVT_AV1_STAGE_ENTROPY_CODING, enc_handle->rest_results_resource_ptr },
+        { SVT_AV1_STAGE_PACKETIZATION, enc_handle->entropy_coding_results_resource_ptr },
+    };
+    const uint32_t stage_count = sizeof(stage_table) / sizeof(stage_table[0]);
+
+    memset(stats, 0, sizeof(*stats));
+    stats->elapsed_us = (svt_av1_get_time_ns() - context->pipeline_start_ns) / 1000;
+    for (uint32_t i = 0; i < stage_count; i++) {
+        SvtAv1StageStats *out = &stats->stages[stage_table[i].stage];
+        EbConsumerStats   consumer_stats;
+        out->name = pipeline_stage_names[stage_table[i].stage];
+        if (stage_table[i].input_resource_ptr == NULL)
+            continue;
+        svt_system_resource_get_consumer_stats(stage_table[i].input_resource_ptr, &consumer_stats);
+        out->thread_count    = consumer_stats.consumer_count;
+        out->items           = consumer_stats.item_count;
+        out->busy_us         = consumer_stats.busy_ns / 1000;
+        out->input_wait_us   = consumer_stats.full_wait_ns / 1000;
+        out->output_wait_us  = consumer_stats.empty_wait_ns / 1000;
+        out->queue_depth     = consumer_stats.queue_depth;
+        out->max_queue_depth = consumer_stats.max_queue_depth;
+    }
+    stats->picture_count = pipeline_picture_history(context, stats->pictures);
+    return EB_ErrorNone;
+}
+
+// Time svt_av1_enc_reset waits for the stages to release the last pictures
+#define RESET_IDLE_TIMEOUT_MS 10000
+
+/* Waits until every object of the resources is back in its pool */
+static EbErrorType pipeline_wait_drained(EbSystemResource *const *resources,
+                                         uint32_t resource_count, uint64_t deadline_ns) {
+    // A stage releasing an object may still post to a pool already checked,
+    // the pass is repeated until it finds every pool full
+    for (EbBool drained = EB_FALSE; !drained;) {
+        drained = EB_TRUE;
+        for (uint32_t i = 0; i < resource_count; i++) {
+            EbSystemResource *resource_ptr = resources[i];
+            if (resource_ptr == NULL ||
+                svt_system_resource_empty_count(resource_ptr) == resource_ptr->constructed_count)
+                continue;
+            const uint64_t now_ns = svt_av1_get_time_ns();
+            if (now_ns >= deadline_ns ||
+                svt_system_resource_wait_drained(
+                    resource_ptr, (uint32_t)((deadline_ns - now_ns + 999999) / 1000000)) !=
+                    EB_ErrorNone)
+                return EB_ErrorUndefined;
+            drained = EB_FALSE;
+        }
+    }
+    return EB_ErrorNone;
+}
+
+static EbErrorType pipeline_wait_reset_ack(EbEncHandle *enc_handle_ptr, uint64_t deadline_ns) {
+    const uint64_t now_ns = svt_av1_get_time_ns();
+    if (now_ns >= deadline_ns ||
+        svt_block_on_semaphore_timeout(enc_handle_ptr->reset_ack_semaphore,
+                                       (uint32_t)((deadline_ns - now_ns + 999999) / 1000000)) !=
+            EB_ErrorNone)
+        return EB_ErrorUndefined;
+    enc_handle_ptr->reset_ack_pending = EB_FALSE;
+    return EB_ErrorNone;
+}
+
+/* Posts a reset request to the stage reading from resource_ptr and waits for
+ * the stage to reset its context on its own thread */
+static EbErrorType pipeline_reset_stage(EbEncHandle *enc_handle_ptr, EbSystemResource *resource_ptr,
+                                        uint64_t deadline_ns) {
+    // The request of a reset that timed out is still queued, its acknowledge
+    // must not be taken for this one
+    if (enc_handle_ptr->reset_ack_pending &&
+        pipeline_wait_reset_ack(enc_handle_ptr, deadline_ns) != EB_ErrorNone)
+        return EB_ErrorUndefined;
+    // The caller is the only producer left, the request can not block
+    if (svt_system_resource_empty_count(resource_ptr) == 0)
+        return EB_ErrorUndefined;
+    svt_post_signal_object(svt_system_resource_get_producer_fifo(resource_ptr, 0),
+                           enc_handle_ptr->reset_ack_semaphore);
+    enc_handle_ptr->reset_ack_pending = EB_TRUE;
+    return pipeline_wait_reset_ack(enc_handle_ptr, deadline_ns);
+}
+
+/**********************************
+* svt_av1_enc_reset brings an encoder that
+* delivered the end of sequence back to the
+* state of svt_av1_enc_init
+**********************************/
+EB_API EbErrorType svt_av1_enc_reset(EbComponentType *svt_enc_component)
+{
+    if (svt_enc_component == NULL)
+        return EB_ErrorBadParameter;
+    EbEncHandle *enc_handle_ptr = (EbEncHandle*)svt_enc_component->p_component_private;
+    if (enc_handle_ptr == NULL || !enc_handle_ptr->end_of_sequence_delivered)
+        return EB_ErrorBadParameter;
+    EbSequenceControlSetInstance *scs_instance_ptr = enc_handle_ptr->scs_instance_array[0];
+    EncodeContext *encode_context_ptr = scs_instance_ptr->encode_context_ptr;
+
+    // Resource coordination gets the request behind the end of sequence
+    // input and releases the objects of that picture. The other stages reset
+    // once every message and picture control set is back in its pool, then
+    // the references left in their queues are released. A stage stuck on a
+    // buffer the application holds would keep the pipeline busy forever.
+    const uint64_t deadline_ns = svt_av1_get_time_ns() + (uint64_t)RESET_IDLE_TIMEOUT_MS * 1000000;
+    EbSystemResource *const stage_resources[] = {
+        enc_handle_ptr->picture_analysis_results_resource_ptr,
+        enc_handle_ptr->motion_estimation_results_resource_ptr,
+        enc_handle_ptr->picture_demux_results_resource_ptr,
+        enc_handle_ptr->rate_control_tasks_resource_ptr,
+        enc_handle_ptr->entropy_coding_results_resource_ptr,
+    };
+    // The sequence control set pool is left out: resource coordination keeps
+    // the active set
+    EbSystemResource *const in_flight_resources[] = {
+        enc_handle_ptr->resource_coordination_results_resource_ptr,
+        enc_handle_ptr->picture_analysis_results_resource_ptr,
+        enc_handle_ptr->picture_decision_results_resource_ptr,
+        enc_handle_ptr->motion_estimation_results_resource_ptr,
+        enc_handle_ptr->initial_rate_control_results_resource_ptr,
+        enc_handle_ptr->picture_demux_results_resource_ptr,
+#if TPL_KERNEL
+        enc_handle_ptr->tpl_disp_res_srm,
+#endif
+        enc_handle_ptr->pic_mgr_res_srm,
+        enc_handle_ptr->rate_control_tasks_resource_ptr,
+        enc_handle_ptr->rate_control_results_resource_ptr,
+        enc_handle_ptr->enc_dec_tasks_resource_ptr,
+        enc_handle_ptr->enc_dec_results_resource_ptr,
+        enc_handle_ptr->entropy_coding_results_resource_ptr,
+        enc_handle_ptr->dlf_results_resource_ptr,
+        enc_handle_ptr->cdef_results_resource_ptr,
+        enc_handle_ptr->rest_results_resource_ptr,
+        enc_handle_ptr->picture_parent_control_set_pool_ptr_array[0],
+        enc_handle_ptr->picture_control_set_pool_ptr_array[0],
+#if CLN_STRUCT
+        enc_handle_ptr->enc_dec_pool_ptr_array[0],
+#endif
+        enc_handle_ptr->me_pool_ptr_array[0],
+    };
+    // Kept in the queues of picture decision and picture manager
+    EbSystemResource *const kept_resources[] = {
+        enc_handle_ptr->input_buffer_resource_ptr,
+        enc_handle_ptr->reference_picture_pool_ptr_array[0],
+        enc_handle_ptr->pa_reference_picture_pool_ptr_array[0],
+        // Allocated with in_loop_me only
+        enc_handle_ptr->down_scaled_picture_pool_ptr_array
+            ? enc_handle_ptr->down_scaled_picture_pool_ptr_array[0]
+            : NULL,
+        enc_handle_ptr->overlay_input_picture_pool_ptr_array[0],
+    };
+    const uint32_t in_flight_count = sizeof(in_flight_resources) / sizeof(in_flight_resources[0]);
+    const uint32_t kept_count      = sizeof(kept_resources) / sizeof(kept_resources[0]);
+    if (pipeline_reset_stage(
+            enc_handle_ptr, enc_handle_ptr->input_buffer_resource_ptr, deadline_ns) !=
+            EB_ErrorNone ||
+        pipeline_wait_drained(in_flight_resources, in_flight_count, deadline_ns) != EB_ErrorNone)
+        return EB_ErrorUndefined;
+    // Picture decision, initial rate control, picture manager, rate control
+    // and packetization, in pipeline order
+    for (uint32_t i = 0; i < sizeof(stage_resources) / sizeof(stage_resources[0]); i++) {
+        if (pipeline_reset_stage(enc_handle_ptr, stage_resources[i], deadline_ns) != EB_ErrorNone)
+            return EB_ErrorUndefined;
+    }
+    // The requests are back in their pools too
+    if (pipeline_wait_drained(in_flight_resources, in_flight_count, deadline_ns) != EB_ErrorNone)
+        return EB_ErrorUndefined;
+
+    // Recon pictures the application did not get
+    if (scs_instance_ptr->scs_ptr->static_config.recon_enabled) {
+        EbObjectWrapper *eb_wrapper_ptr = NULL;
+        for (;;) {
+            svt_get_full_object_non_blocking(enc_handle_ptr->output_recon_buffer_consumer_fifo_ptr,
+                                             &eb_wrapper_ptr);
+            if (eb_wrapper_ptr == NULL)
+                break;
+            svt_release_object(eb_wrapper_ptr);
+        }
+    }
+
+    // The queues of picture decision and picture manager, their threads wait
+    // for input after the acknowledge. Updates queued for pictures of the
+    // sequence that did not come are dropped.
+    svt_block_on_mutex(encode_context_ptr->param_update_mutex);
+    encode_context_reset(encode_context_ptr);
+    svt_atomic_store_u32(&encode_context_ptr->enc_mode,
+                         scs_instance_ptr->scs_ptr->static_config.enc_mode);
+    svt_release_mutex(encode_context_ptr->param_update_mutex);
+    if (pipeline_wait_drained(kept_resources, kept_count, deadline_ns) != EB_ErrorNone)
+        return EB_ErrorUndefined;
+
+    enc_handle_ptr->end_of_sequence_delivered = EB_FALSE;
+    return EB_ErrorNone;
+}
+
+/**********************************
+* svt_av1_enc_update_parameters queue an update of
+* the encoder parameters from a given input picture on
+**********************************/
+EB_API EbErrorType svt_av1_enc_update_parameters(EbComponentType *      svt_enc_component,
+                                                 const SvtAv1EncUpdate *update)
+{
+    if (svt_enc_component == NULL || update == NULL)
+        return EB_ErrorBadParameter;
+    EbEncHandle        *enc_handle = (EbEncHandle*)svt_enc_component->p_component_private;
+    SequenceControlSet *scs_ptr    = enc_handle->scs_instance_array[0]->scs_ptr;
+    const uint32_t      known      = SVT_AV1_UPDATE_TARGET_BIT_RATE | SVT_AV1_UPDATE_QP_RANGE |
+        SVT_AV1_UPDATE_ENC_MODE | SVT_AV1_UPDATE_KEY_FRAME;
+    if (!update->flags || (update->flags & ~known))
+        return EB_ErrorBadParameter;
+    if ((update->flags & SVT_AV1_UPDATE_TARGET_BIT_RATE) && update->target_bit_rate == 0)
+        return EB_ErrorBadParameter;
+    if ((update->flags & SVT_AV1_UPDATE_QP_RANGE) &&
+        (update->max_qp_allowed > MAX_QP_VALUE || update->min_qp_allowed >= MAX_QP_VALUE ||
+         update->min_qp_allowed > update->max_qp_allowed))
+        return EB_ErrorBadParameter;
+    // The sequence level buffers are sized for the preset set at init, a
+    // slower one would not fit them
+    if ((update->flags & SVT_AV1_UPDATE_ENC_MODE) &&
+        (update->enc_mode < scs_ptr->static_config.enc_mode || update->enc_mode > MAX_ENC_PRESET))
+        return EB_ErrorBadParameter;
+    return param_update_push(enc_handle->scs_instance_array[0]->encode_context_ptr, update);
+}
 // clang-format on
@@ -18,10 +18,13 @@
 #include "EbSystemResourceManager.h"
 #include "EbSequenceControlSet.h"
 #include "EbObject.h"
+#include "EbTaskScheduler.h"
+#include "EbStageBalancer.h"
 
 struct _EbThreadContext {
-    EbDctor dctor;
-    EbPtr   priv;
+    EbDctor    dctor;
+    EbPtr      priv;
+    EbKernelFn kernel; // run by the dedicated thread of the stage
 };
 
 /**************************************
@@ -87,6 +90,22 @@ struct _EbEncHandle {
 
     EbHandle packetization_thread_handle;
 
+    // Task scheduler mode: the multi-instance stages run as kernel jobs
+    // on a shared pool instead of the thread arrays above
+    EbTaskScheduler *task_scheduler_ptr;
+    EbKernelJob **   kernel_job_ptr_array;
+    uint32_t         kernel_job_count;
+    // Shared executor mode: the kernel jobs are queued on task_group_ptr
+    // of the executor scheduler, task_scheduler_ptr is not used.
+    // executor_context_count - spare workers and queue slots reserved
+    SvtAv1Executor * executor;
+    EbTaskGroup *    task_group_ptr;
+    uint32_t         executor_context_count;
+
+    // Parks and unparks the threads of the multi-instance stages,
+    // when stage_balancing is set
+    EbStageBalancer *stage_balancer_ptr;
+
     // Contexts
     EbThreadContext * resource_coordination_context_ptr;
     EbThreadContext **picture_analysis_context_ptr_array;
@@ -136,8 +155,16 @@ struct _EbEncHandle {
     EbCallback **app_callback_ptr_array;
 
     EbFifo *input_buffer_producer_fifo_ptr;
+    // input_layout - planes expected by the zero_copy_input pictures
+    SvtAv1InputLayout input_layout;
     EbFifo *output_stream_buffer_consumer_fifo_ptr;
     EbFifo *output_recon_buffer_consumer_fifo_ptr;
+    // The end of sequence packet went out, svt_av1_enc_reset may run
+    EbBool end_of_sequence_delivered;
+    // reset_ack_semaphore - posted by a stage once it reset its context
+    EbHandle reset_ack_semaphore;
+    // reset_ack_pending - a reset request was posted and not acknowledged
+    EbBool reset_ack_pending;
 };
 
 #endif // EbEncHandle_h
@@ -863,6 +863,11 @@ gst_svtav1enc_dequeue_encoded_frames (GstSvtAv1Enc * svtav1enc,
     if (res == EB_ErrorMax) {
       GST_ELEMENT_ERROR (svtav1enc, LIBRARY, ENCODE, (NULL), ("encode failed"));
       return GST_FLOW_ERROR;
+    } else if (res != EB_NoErrorEmptyQueue && output_buf
+        && output_buf->n_filled_len == 0) {
+      /* a low delay stream can end on an empty packet that only carries the EOS */
+      svt_av1_enc_release_out_buffer (&output_buf);
+      output_buf = NULL;
     } else if (res != EB_NoErrorEmptyQueue && output_frames && output_buf) {
       /* if p_app_private is indeed propagated, get the frame through it
        * it's not currently the case with SVT-AV1
@@ -0,0 +1,141 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+/******************************************************************************
+ * @file ArenaTest.cc
+ *
+ * @brief Unit test of the arena allocator:
+ * - alignment and order of the blocks, blocks larger than a chunk
+ * - svt_arena_mark / svt_arena_rewind reuse of the chunks
+ * - picture buffers carved from the arena hint of the thread
+ *
+ ******************************************************************************/
+
+#include <cstring>
+#include <thread>
+#include "gtest/gtest.h"
+// workaround to eliminate the compiling warning on linux
+// The macro will conflict with definition in gtest.h
+#ifdef __USE_GNU
+#undef __USE_GNU  // defined in EbThreads.h
+#endif
+#ifdef _GNU_SOURCE
+#undef _GNU_SOURCE  // defined in EbThreads.h
+#endif
+
+#include "EbArena.h"
+#include "EbPictureBufferDesc.h"
+
+namespace {
+
+static const size_t chunk_size = 64 * 1024;
+
+TEST(ArenaTest, BlocksAreAlignedAndInOrder) {
+    EbArena arena;
+    memset(&arena, 0, sizeof(arena));
+    ASSERT_EQ(EB_ErrorNone, svt_arena_ctor(&arena, chunk_size));
+    uint8_t *prev = (uint8_t *)svt_arena_alloc(&arena, 1);
+    ASSERT_NE(nullptr, prev);
+    EXPECT_EQ(0u, (uintptr_t)prev % SVT_ARENA_ALIGN);
+    for (size_t size = 2; size < 1000; size += 37) {
+        uint8_t *p = (uint8_t *)svt_arena_alloc(&arena, size);
+        ASSERT_NE(nullptr, p);
+        EXPECT_EQ(0u, (uintptr_t)p % SVT_ARENA_ALIGN);
+        // consecutive in the same chunk
+        EXPECT_GE(p - prev, SVT_ARENA_ALIGN);
+        EXPECT_LE(p - prev, 1000 + SVT_ARENA_ALIGN);
+        memset(p, 0x5a, size);
+        prev = p;
+    }
+    // larger than a chunk
+    uint8_t *big = (uint8_t *)svt_arena_alloc(&arena, 3 * chunk_size);
+    ASSERT_NE(nullptr, big);
+    memset(big, 0x5a, 3 * chunk_size);
+    EXPECT_NE(nullptr, svt_arena_alloc(&arena, 1));
+    arena.dctor(&arena);
+}
+
+TEST(ArenaTest, RewindReusesTheChunks) {
+    EbArena arena;
+    memset(&arena, 0, sizeof(arena));
+    ASSERT_EQ(EB_ErrorNone, svt_arena_ctor(&arena, chunk_size));
+    svt_arena_alloc(&arena, 100);
+    const EbArenaMark mark  = svt_arena_mark(&arena);
+    uint8_t *         first = (uint8_t *)svt_arena_alloc(&arena, 100);
+    // spans several chunks
+    uint8_t *blocks[10];
+    for (int i = 0; i < 10; i++) blocks[i] = (uint8_t *)svt_arena_alloc(&arena, chunk_size / 3);
+    const EbArenaChunk *head = arena.head;
+
+    for (int pass = 0; pass < 3; pass++) {
+        svt_arena_rewind(&arena, mark);
+        EXPECT_EQ(first, svt_arena_alloc(&arena, 100));
+        for (int i = 0; i < 10; i++)
+            EXPECT_EQ(blocks[i], svt_arena_alloc(&arena, chunk_size / 3));
+        EXPECT_EQ(head, arena.head);
+    }
+    // a block larger than the kept chunk gets a new chunk after the current one
+    svt_arena_rewind(&arena, mark);
+    svt_arena_alloc(&arena, chunk_size - 200);
+    uint8_t *big = (uint8_t *)svt_arena_alloc(&arena, 2 * chunk_size);
+    ASSERT_NE(nullptr, big);
+    memset(big, 0x5a, 2 * chunk_size);
+    arena.dctor(&arena);
+}
+
+TEST(ArenaTest, HintIsPerThread) {
+    EbArena arena;
+    memset(&arena, 0, sizeof(arena));
+    ASSERT_EQ(EB_ErrorNone, svt_arena_ctor(&arena, chunk_size));
+    EXPECT_EQ(nullptr, svt_set_alloc_arena(&arena));
+    EbArena *other_arena = &arena;
+    std::thread([&other_arena]() { other_arena = svt_get_alloc_arena(); }).join();
+    EXPECT_EQ(nullptr, other_arena);
+    EXPECT_EQ(&arena, svt_set_alloc_arena(NULL));
+    arena.dctor(&arena);
+}
+
+TEST(ArenaTest, PictureBufferIsCarvedFromTheHint) {
+    EbPictureBufferDescInitData init_data;
+    memset(&init_data, 0, sizeof(init_data));
+    init_data.max_width          = 64;
+    init_data.max_height         = 64;
+    init_data.bit_depth          = EB_32BIT;
+    init_data.color_format       = EB_YUV420;
+    init_data.buffer_enable_mask = PICTURE_BUFFER_DESC_FULL_MASK;
+
+    EbArena arena;
+    memset(&arena, 0, sizeof(arena));
+    ASSERT_EQ(EB_ErrorNone, svt_arena_ctor(&arena, chunk_size));
+    // dirty the memory the planes will be carved from
+    const EbArenaMark mark = svt_arena_mark(&arena);
+    memset(svt_arena_alloc(&arena, chunk_size), 0xff, chunk_size);
+    svt_arena_rewind(&arena, mark);
+
+    EbPictureBufferDesc desc;
+    memset(&desc, 0, sizeof(desc));
+    svt_set_alloc_arena(&arena);
+    ASSERT_EQ(EB_ErrorNone, svt_picture_buffer_desc_ctor(&desc, &init_data));
+    svt_set_alloc_arena(NULL);
+    EXPECT_EQ(&arena, desc.arena);
+    // the planes are adjacent and zeroed
+    const size_t luma_bytes = desc.luma_size * 4;
+    EXPECT_EQ(desc.buffer_y + luma_bytes, desc.buffer_cb);
+    EXPECT_EQ(desc.buffer_cb + desc.chroma_size * 4, desc.buffer_cr);
+    EXPECT_EQ(0, desc.buffer_y[0]);
+    EXPECT_EQ(0, desc.buffer_y[luma_bytes - 1]);
+    EXPECT_EQ(0, desc.buffer_cr[desc.chroma_size * 4 - 1]);
+    desc.dctor(&desc);
+    EXPECT_EQ(nullptr, desc.buffer_y);
+    arena.dctor(&arena);
+}
+
+}  // namespace
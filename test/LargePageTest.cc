@@ -0,0 +1,177 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+/******************************************************************************
+ * @file LargePageTest.cc
+ *
+ * @brief Unit test of the large page backing of the picture buffers:
+ * - alignment, contents and release of the allocations of each mode
+ * - the mode hint of each thread and of the picture buffer descriptors
+ * - speed and dTLB misses of 2D block reads with and without large pages
+ *
+ ******************************************************************************/
+
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+// workaround to eliminate the compiling warning on linux
+// The macro will conflict with definition in gtest.h
+#ifdef __USE_GNU
+#undef __USE_GNU  // defined in EbThreads.h
+#endif
+#ifdef _GNU_SOURCE
+#undef _GNU_SOURCE  // defined in EbThreads.h
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "EbMalloc.h"
+#include "EbPictureBufferDesc.h"
+#include "EbTime.h"
+#include "random.h"
+
+namespace {
+
+static const EbLargePages all_modes[] = {
+    SVT_LARGE_PAGES_OFF, SVT_LARGE_PAGES_THP, SVT_LARGE_PAGES_HUGETLB};
+
+TEST(LargePageTest, AllocationsOfEachMode) {
+    const size_t sizes[] = {
+        1, 4096, SVT_LARGE_PAGE_SIZE - 1, SVT_LARGE_PAGE_SIZE, 3 * SVT_LARGE_PAGE_SIZE + 5};
+    for (EbLargePages mode : all_modes) {
+        for (size_t size : sizes) {
+            uint8_t *p = (uint8_t *)svt_large_page_malloc(size, mode);
+            // HUGETLB falls back when no huge page is reserved
+            ASSERT_NE(nullptr, p) << "mode " << mode << " size " << size;
+            EXPECT_EQ(0u, (uintptr_t)p % ALVALUE);
+            memset(p, 0x5a, size);
+            EXPECT_EQ(0x5a, p[0]);
+            EXPECT_EQ(0x5a, p[size - 1]);
+            svt_large_page_free(p);
+        }
+    }
+    svt_large_page_free(NULL);
+}
+
+TEST(LargePageTest, ModeIsPerThread) {
+    EXPECT_EQ(SVT_LARGE_PAGES_OFF, svt_get_large_pages());
+    svt_set_large_pages(SVT_LARGE_PAGES_THP);
+    EbLargePages other_mode = SVT_LARGE_PAGES_HUGETLB;
+    std::thread([&other_mode]() { other_mode = svt_get_large_pages(); }).join();
+    EXPECT_EQ(SVT_LARGE_PAGES_OFF, other_mode);
+    EXPECT_EQ(SVT_LARGE_PAGES_THP, svt_get_large_pages());
+    svt_set_large_pages(SVT_LARGE_PAGES_OFF);
+}
+
+TEST(LargePageTest, PictureBufferFollowsTheHint) {
+    EbPictureBufferDescInitData init_data;
+    memset(&init_data, 0, sizeof(init_data));
+    init_data.max_width = 1920;
+    init_data.max_height = 1080;
+    init_data.bit_depth = EB_8BIT;
+    init_data.color_format = EB_YUV420;
+    init_data.buffer_enable_mask = PICTURE_BUFFER_DESC_FULL_MASK;
+    init_data.left_padding = init_data.right_padding = 80;
+    init_data.top_padding = init_data.bot_padding = 80;
+
+    for (EbLargePages mode : all_modes) {
+        EbPictureBufferDesc desc;
+        memset(&desc, 0, sizeof(desc));
+        svt_set_large_pages(mode);
+        ASSERT_EQ(EB_ErrorNone, svt_picture_buffer_desc_ctor(&desc, &init_data));
+        svt_set_large_pages(SVT_LARGE_PAGES_OFF);
+        EXPECT_EQ(mode, desc.large_pages);
+        EXPECT_EQ(0u, (uintptr_t)desc.buffer_y % ALVALUE);
+        // the planes are zeroed
+        EXPECT_EQ(0, desc.buffer_y[desc.luma_size - 1]);
+        EXPECT_EQ(0, desc.buffer_cr[desc.chroma_size - 1]);
+        desc.dctor(&desc);
+    }
+}
+
+#ifdef __linux__
+// dTLB read misses of the calling thread, -1 when perf is not permitted
+static int open_dtlb_counter() {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+// Reads 64x64 blocks at random positions of 2160p sized reference planes,
+// the access pattern of the motion search, with and without large pages
+TEST(LargePageTest, DISABLED_BlockReadSpeedTest) {
+    const uint32_t plane_count = 32;
+    const uint32_t stride = 3840 + 2 * 80;
+    const uint32_t height = 2160 + 2 * 80;
+    const uint32_t block = 64;
+    const uint32_t num_blocks = 2000000;
+    const EbLargePages modes[] = {SVT_LARGE_PAGES_OFF, SVT_LARGE_PAGES_THP};
+
+    for (EbLargePages mode : modes) {
+        std::vector<uint8_t *> planes(plane_count);
+        for (uint32_t i = 0; i < plane_count; i++) {
+            planes[i] = (uint8_t *)svt_large_page_malloc(stride * height, mode);
+            ASSERT_NE(nullptr, planes[i]);
+            memset(planes[i], i, stride * height);
+        }
+        svt_av1_test_tool::SVTRandom rnd(0, 1 << 30);
+        uint64_t sum = 0;
+        int64_t misses = -1;
+#ifdef __linux__
+        const int fd = open_dtlb_counter();
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+        const uint64_t start_ns = svt_av1_get_time_ns();
+        for (uint32_t n = 0; n < num_blocks; n++) {
+            const uint32_t r = (uint32_t)rnd.random();
+            const uint8_t *p = planes[r % plane_count] +
+                               (r / plane_count % (height - block)) * stride +
+                               (r >> 20) % (stride - block);
+            for (uint32_t y = 0; y < block; y++, p += stride)
+                sum += p[0] + p[block - 1];
+        }
+        const uint64_t elapsed_ns = svt_av1_get_time_ns() - start_ns;
+#ifdef __linux__
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd, &misses, sizeof(misses)) != sizeof(misses))
+                misses = -1;
+            close(fd);
+        }
+#endif
+        printf("large_pages %d: %8.2f ms, %.1f Mblocks/s, dTLB read misses %lld (sum %llu)\n",
+               mode,
+               elapsed_ns / 1e6,
+               num_blocks * 1e3 / elapsed_ns,
+               (long long)misses,
+               (unsigned long long)sum);
+        for (uint32_t i = 0; i < plane_count; i++) svt_large_page_free(planes[i]);
+    }
+}
+
+}  // namespace
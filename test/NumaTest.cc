@@ -0,0 +1,116 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+/******************************************************************************
+ * @file NumaTest.cc
+ *
+ * @brief Unit test of the NUMA placement:
+ * - the allocation node hint of each thread
+ * - the interleaving of the objects of a system resource
+ * - binding and unbinding keep the contents of touched pages
+ *
+ ******************************************************************************/
+
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+// workaround to eliminate the compiling warning on linux
+// The macro will conflict with definition in gtest.h
+#ifdef __USE_GNU
+#undef __USE_GNU  // defined in EbThreads.h
+#endif
+#ifdef _GNU_SOURCE
+#undef _GNU_SOURCE  // defined in EbThreads.h
+#endif
+
+#include "EbSystemResourceManager.h"
+#include "EbNuma.h"
+
+namespace {
+
+typedef struct NodeObject {
+    EbDctor dctor;
+    int32_t alloc_node;
+} NodeObject;
+
+static EbErrorType node_object_creator(EbPtr *object_dbl_ptr,
+                                       EbPtr object_init_data_ptr) {
+    (void)object_init_data_ptr;
+    NodeObject *obj = (NodeObject *)calloc(1, sizeof(NodeObject));
+    if (!obj)
+        return EB_ErrorInsufficientResources;
+    obj->alloc_node = svt_numa_get_alloc_node();
+    *object_dbl_ptr = obj;
+    return EB_ErrorNone;
+}
+
+static void node_object_destroyer(EbPtr p) {
+    free(p);
+}
+
+TEST(NumaTest, AllocNodeIsPerThread) {
+    EXPECT_GE(svt_numa_node_count(), 1u);
+    EXPECT_EQ(SVT_NUMA_NODE_ANY, svt_numa_get_alloc_node());
+    svt_numa_set_alloc_node(0);
+    int32_t other_node = 0;
+    std::thread([&other_node]() {
+        other_node = svt_numa_get_alloc_node();
+    }).join();
+    EXPECT_EQ(SVT_NUMA_NODE_ANY, other_node);
+    EXPECT_EQ(0, svt_numa_get_alloc_node());
+    svt_numa_set_alloc_node(SVT_NUMA_NODE_ANY);
+}
+
+TEST(NumaTest, InterleavedResource) {
+    const uint32_t object_count = 7;
+    EbSystemResource *resource =
+        (EbSystemResource *)calloc(1, sizeof(EbSystemResource));
+    ASSERT_NE(nullptr, resource);
+
+    svt_numa_set_alloc_node(SVT_NUMA_NODE_INTERLEAVE);
+    ASSERT_EQ(EB_ErrorNone,
+              svt_system_resource_ctor(resource,
+                                       object_count,
+                                       1,
+                                       1,
+                                       node_object_creator,
+                                       NULL,
+                                       node_object_destroyer));
+    // the hint of the calling thread is restored
+    EXPECT_EQ(SVT_NUMA_NODE_INTERLEAVE, svt_numa_get_alloc_node());
+    svt_numa_set_alloc_node(SVT_NUMA_NODE_ANY);
+
+    for (uint32_t i = 0; i < object_count; i++) {
+        const NodeObject *obj =
+            (const NodeObject *)resource->wrapper_ptr_pool[i]->object_ptr;
+        EXPECT_EQ((int32_t)(i % svt_numa_node_count()), obj->alloc_node);
+    }
+    resource->dctor(resource);
+    free(resource);
+}
+
+TEST(NumaTest, BindKeepsContents) {
+    const size_t size = 4 * NUMA_MIN_BIND_SIZE + 123;
+    std::vector<uint8_t> buffer(size);
+    for (size_t i = 0; i < size; i++)
+        buffer[i] = (uint8_t)(i * 7);
+    for (uint32_t node = 0; node < svt_numa_node_count(); node++) {
+        svt_numa_bind(buffer.data() + 1, size - 1, (int32_t)node);
+        svt_numa_bind_thread(NULL, (int32_t)node);
+    }
+    svt_numa_bind(buffer.data(), size, SVT_NUMA_NODE_ANY);
+    svt_numa_unbind(buffer.data() + 1, size - 1);
+    for (size_t i = 0; i < size; i++)
+        ASSERT_EQ((uint8_t)(i * 7), buffer[i]);
+}
+
+}  // namespace
@@ -0,0 +1,129 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+/******************************************************************************
+ * @file ObjectReleaseTest.cc
+ *
+ * @brief Unit test of the object releases of an encode, with and without
+ * overlays:
+ * - the sequence control set is released as many times as it is taken
+ * - the output packets all go back to their pool, the alt-ref ones included
+ *
+ ******************************************************************************/
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+// workaround to eliminate the compiling warning on linux
+// The macro will conflict with definition in gtest.h
+#ifdef __USE_GNU
+#undef __USE_GNU  // defined in EbThreads.h
+#endif
+#ifdef _GNU_SOURCE
+#undef _GNU_SOURCE  // defined in EbThreads.h
+#endif
+
+#include "EbSvtAv1Enc.h"
+#include "EbEncHandle.h"
+
+namespace {
+
+/* Releases still to come for the objects of a pool not back in it */
+static uint32_t held_live_count(const EbSystemResource *resource_ptr) {
+    uint32_t live_count = 0;
+    for (uint32_t i = 0; i < resource_ptr->object_total_count; i++) {
+        const EbObjectWrapper *wrapper_ptr = resource_ptr->wrapper_ptr_pool[i];
+        if (wrapper_ptr && wrapper_ptr->live_count != EB_ObjectWrapperReleasedValue)
+            live_count += wrapper_ptr->live_count;
+    }
+    return live_count;
+}
+
+/* The last releases may come after the end of sequence packet, give the
+ * stages a second to get there */
+static void wait_released(uint32_t (*count)(const EbSystemResource *),
+                          const EbSystemResource *resource_ptr, uint32_t expected) {
+    for (int i = 0; i < 100 && count(resource_ptr) != expected; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+}
+
+static void encode_and_check_releases(EbBool enable_overlays) {
+    // Two mini-GOPs, the first one ends on an alt-ref with overlays
+    const uint32_t width = 176, height = 144, frame_count = 24;
+
+    EbComponentType *        handle = nullptr;
+    EbSvtAv1EncConfiguration config;
+    memset(&config, 0, sizeof(config));
+    ASSERT_EQ(EB_ErrorNone, svt_av1_enc_init_handle(&handle, nullptr, &config));
+    config.source_width    = width;
+    config.source_height   = height;
+    config.enc_mode        = MAX_ENC_PRESET;
+    config.enable_overlays = enable_overlays;
+    ASSERT_EQ(EB_ErrorNone, svt_av1_enc_set_parameter(handle, &config));
+    ASSERT_EQ(EB_ErrorNone, svt_av1_enc_init(handle));
+
+    std::vector<uint8_t> frame(width * height * 3 / 2);
+    EbSvtIOFormat        planes;
+    memset(&planes, 0, sizeof(planes));
+    planes.luma      = frame.data();
+    planes.cb        = planes.luma + width * height;
+    planes.cr        = planes.cb + width * height / 4;
+    planes.y_stride  = width;
+    planes.cb_stride = planes.cr_stride = width / 2;
+    EbBufferHeaderType input;
+    memset(&input, 0, sizeof(input));
+    input.size         = sizeof(input);
+    input.p_buffer     = (uint8_t *)&planes;
+    input.n_filled_len = (uint32_t)frame.size();
+    input.pic_type     = EB_AV1_INVALID_PICTURE;
+    for (uint32_t i = 0; i < frame_count; i++) {
+        for (uint32_t y = 0; y < height; y++)
+            for (uint32_t x = 0; x < width; x++)
+                frame[y * width + x] = (uint8_t)(x + y + 4 * i);
+        input.pts = i;
+        ASSERT_EQ(EB_ErrorNone, svt_av1_enc_send_picture(handle, &input));
+    }
+    EbBufferHeaderType eos;
+    memset(&eos, 0, sizeof(eos));
+    eos.flags = EB_BUFFERFLAG_EOS;
+    ASSERT_EQ(EB_ErrorNone, svt_av1_enc_send_picture(handle, &eos));
+
+    EbBufferHeaderType *output = nullptr;
+    for (bool done = false; !done;) {
+        ASSERT_EQ(EB_ErrorNone, svt_av1_enc_get_packet(handle, &output, 1));
+        done = (output->flags & EB_BUFFERFLAG_EOS) != 0;
+        svt_av1_enc_release_out_buffer(&output);
+    }
+
+    EbEncHandle *enc_handle = (EbEncHandle *)handle->p_component_private;
+    // The end of sequence input keeps its parent PCS, which holds the
+    // sequence control set twice
+    wait_released(held_live_count, enc_handle->scs_pool_ptr, 2);
+    EXPECT_EQ(2u, held_live_count(enc_handle->scs_pool_ptr));
+    EbSystemResource *output_pool = enc_handle->output_stream_buffer_resource_ptr_array[0];
+    wait_released(svt_system_resource_empty_count, output_pool, output_pool->constructed_count);
+    EXPECT_EQ(output_pool->constructed_count, svt_system_resource_empty_count(output_pool));
+
+    EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit(handle));
+    EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit_handle(handle));
+}
+
+TEST(ObjectReleaseTest, ReleasedWithoutOverlays) {
+    encode_and_check_releases(EB_FALSE);
+}
+
+TEST(ObjectReleaseTest, ReleasedWithOverlays) {
+    encode_and_check_releases(EB_TRUE);
+}
+
+}  // namespace
@@ -0,0 +1,116 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+/******************************************************************************
+ * @file PacketBufferPoolTest.cc
+ *
+ * @brief Unit test of the output packet buffer pool:
+ * - reuse of the released buffers, capacity of the buffers
+ * - svt_packet_buffer_grow keeping the content
+ * - release from another thread than the one getting the buffers
+ *
+ ******************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+// workaround to eliminate the compiling warning on linux
+// The macro will conflict with definition in gtest.h
+#ifdef __USE_GNU
+#undef __USE_GNU  // defined in EbThreads.h
+#endif
+#ifdef _GNU_SOURCE
+#undef _GNU_SOURCE  // defined in EbThreads.h
+#endif
+
+#include "EbPacketBufferPool.h"
+
+namespace {
+
+TEST(PacketBufferPoolTest, ReleasedBuffersAreReused) {
+    EbPacketBufferPool pool;
+    memset(&pool, 0, sizeof(pool));
+    ASSERT_EQ(EB_ErrorNone, svt_packet_buffer_pool_ctor(&pool));
+    uint8_t *a = svt_packet_buffer_get(&pool, 1000);
+    uint8_t *b = svt_packet_buffer_get(&pool, 1000);
+    ASSERT_NE(nullptr, a);
+    ASSERT_NE(nullptr, b);
+    EXPECT_NE(a, b);
+    EXPECT_GE(svt_packet_buffer_capacity(a), 1000u);
+    EXPECT_EQ(0u, (uintptr_t)a % 16);
+    memset(a, 0x5a, 1000);
+
+    // the last released buffer comes back first
+    svt_packet_buffer_release(a);
+    svt_packet_buffer_release(b);
+    EXPECT_EQ(b, svt_packet_buffer_get(&pool, 1000));
+    EXPECT_EQ(a, svt_packet_buffer_get(&pool, 10));
+    svt_packet_buffer_release(a);
+    svt_packet_buffer_release(b);
+    svt_packet_buffer_release(NULL);
+    pool.dctor(&pool);
+}
+
+TEST(PacketBufferPoolTest, GrowKeepsTheContent) {
+    EbPacketBufferPool pool;
+    memset(&pool, 0, sizeof(pool));
+    ASSERT_EQ(EB_ErrorNone, svt_packet_buffer_pool_ctor(&pool));
+    uint8_t *a = svt_packet_buffer_get(&pool, 100);
+    ASSERT_NE(nullptr, a);
+    for (int i = 0; i < 100; i++) a[i] = (uint8_t)i;
+    const size_t capacity = svt_packet_buffer_capacity(a);
+    EXPECT_EQ(a, svt_packet_buffer_grow(a, capacity));
+
+    a = svt_packet_buffer_grow(a, 10 * capacity);
+    ASSERT_NE(nullptr, a);
+    EXPECT_GE(svt_packet_buffer_capacity(a), 10 * capacity);
+    for (int i = 0; i < 100; i++) EXPECT_EQ(i, a[i]);
+    memset(a, 0x5a, 10 * capacity);
+
+    // a smaller buffer taken from the pool grows to the requested size
+    svt_packet_buffer_release(a);
+    uint8_t *b = svt_packet_buffer_get(&pool, 20 * capacity);
+    ASSERT_NE(nullptr, b);
+    EXPECT_GE(svt_packet_buffer_capacity(b), 20 * capacity);
+    memset(b, 0x5a, 20 * capacity);
+    svt_packet_buffer_release(b);
+    pool.dctor(&pool);
+}
+
+TEST(PacketBufferPoolTest, ReleaseFromAnotherThread) {
+    EbPacketBufferPool pool;
+    memset(&pool, 0, sizeof(pool));
+    ASSERT_EQ(EB_ErrorNone, svt_packet_buffer_pool_ctor(&pool));
+    const int              count = 64;
+    std::vector<uint8_t *> buffers;
+    for (int pass = 0; pass < 4; pass++) {
+        buffers.clear();
+        for (int i = 0; i < count; i++) {
+            buffers.push_back(svt_packet_buffer_get(&pool, 4096 + i));
+            ASSERT_NE(nullptr, buffers.back());
+        }
+        std::thread([&buffers]() {
+            for (uint8_t *buffer : buffers) svt_packet_buffer_release(buffer);
+        }).join();
+    }
+    // all the buffers are back in the pool, none is allocated again
+    std::vector<uint8_t *> again;
+    for (int i = 0; i < count; i++) {
+        again.push_back(svt_packet_buffer_get(&pool, 4096));
+        EXPECT_NE(buffers.end(), std::find(buffers.begin(), buffers.end(), again.back()));
+    }
+    for (uint8_t *buffer : again) svt_packet_buffer_release(buffer);
+    pool.dctor(&pool);
+}
+
+}  // namespace
@@ -0,0 +1,158 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+/******************************************************************************
+ * @file SpeedControlTest.cc
+ *
+ * @brief Unit test of the real-time speed control:
+ * - cost prediction of the presets not measured yet
+ * - correction of the work scale from the output frame rate
+ *
+ ******************************************************************************/
+
+#include <cstring>
+#include "gtest/gtest.h"
+// workaround to eliminate the compiling warning on linux
+// The macro will conflict with definition in gtest.h
+#ifdef __USE_GNU
+#undef __USE_GNU  // defined in EbThreads.h
+#endif
+#ifdef _GNU_SOURCE
+#undef _GNU_SOURCE  // defined in EbThreads.h
+#endif
+
+#include "EbSpeedControl.h"
+
+namespace {
+
+static const double ns_per_s = 1000000000.0;
+
+static void speed_control_init(SpeedControl *sc) {
+    memset(sc, 0, sizeof(*sc));
+    sc->work_scale = 1.0;
+}
+
+/* Pictures picked then out at the given rate, from the first packet on as
+ * speed_control_picture_done counts them */
+static void run_pictures(SpeedControl *sc, uint64_t frames, double fps) {
+    for (uint64_t i = 0; i < frames; i++) {
+        sc->frames_in++;
+        sc->out_ns += (uint64_t)(ns_per_s / fps);
+        if (!sc->frames_out++) {
+            sc->update_ns         = sc->out_ns;
+            sc->update_frames_out = 1;
+        }
+    }
+}
+
+TEST(SpeedControlTest, PredictCostOfClassNotMeasured) {
+    SpeedControl sc;
+    speed_control_init(&sc);
+    EXPECT_EQ(speed_control_predict_cost(&sc, (EbEncMode)4, 0), 0);
+    sc.cost_us[4 - ENC_MRS][1] = 1000;
+    EXPECT_EQ(speed_control_predict_cost(&sc, (EbEncMode)4, 0), 0);
+    EXPECT_EQ(speed_control_predict_cost(&sc, (EbEncMode)4, 1), 1000);
+}
+
+TEST(SpeedControlTest, PredictCostFromNearestMeasuredPreset) {
+    SpeedControl sc;
+    speed_control_init(&sc);
+    sc.cost_us[4 - ENC_MRS][0] = 1000;
+    // Faster presets cost less, slower ones more, by the default ratio per step
+    const double p5 = speed_control_predict_cost(&sc, (EbEncMode)5, 0);
+    const double p6 = speed_control_predict_cost(&sc, (EbEncMode)6, 0);
+    const double p3 = speed_control_predict_cost(&sc, (EbEncMode)3, 0);
+    EXPECT_LT(p5, 1000);
+    EXPECT_LT(p6, p5);
+    EXPECT_NEAR(p6 / p5, p5 / 1000, 1e-9);
+    EXPECT_NEAR(p3, 1000 * 1000 / p5, 1e-6);
+    EXPECT_DOUBLE_EQ(speed_control_predict_cost(&sc, (EbEncMode)MAX_ENC_PRESET, 0),
+                     speed_control_predict_cost(&sc, (EbEncMode)(MAX_ENC_PRESET - 1), 0) * p5 / 1000);
+
+    // A measured preset is used as is, and is the nearest one for its neighbours
+    sc.cost_us[6 - ENC_MRS][0] = 900;
+    EXPECT_EQ(speed_control_predict_cost(&sc, (EbEncMode)6, 0), 900);
+    EXPECT_EQ(speed_control_predict_cost(&sc, (EbEncMode)5, 0), p5);
+    EXPECT_LT(speed_control_predict_cost(&sc, (EbEncMode)7, 0), 900);
+}
+
+TEST(SpeedControlTest, NoUpdateBeforeEnoughPictures) {
+    SpeedControl sc;
+    speed_control_init(&sc);
+    run_pictures(&sc, 8, 10);
+    speed_control_update_work_scale(&sc, 30, 8);
+    EXPECT_EQ(sc.work_scale, 1.0);
+    EXPECT_EQ(sc.output_fps, 0);
+}
+
+TEST(SpeedControlTest, FirstUpdateCorrectsWholeError) {
+    SpeedControl sc;
+    speed_control_init(&sc);
+    // A quarter of the target rate: the first update scales the work by the
+    // full error, without waiting for the update period
+    run_pictures(&sc, 9, 7.5);
+    speed_control_update_work_scale(&sc, 30, 8);
+    EXPECT_NEAR(sc.output_fps, 7.5, 0.01);
+    EXPECT_NEAR(sc.work_scale, 0.25, 0.01);
+    EXPECT_EQ(sc.update_frames_out, 9u);
+}
+
+TEST(SpeedControlTest, LaterUpdatesAreDamped) {
+    SpeedControl sc;
+    speed_control_init(&sc);
+    run_pictures(&sc, 9, 30);
+    speed_control_update_work_scale(&sc, 30, 8);
+    EXPECT_EQ(sc.work_scale, 1.0);
+    // A rate dropping far below the target halves the work at most per update
+    for (int i = 0; i < 2; i++) {
+        const double scale = sc.work_scale;
+        run_pictures(&sc, 8, 1);
+        speed_control_update_work_scale(&sc, 30, 8);
+        EXPECT_LT(sc.work_scale, scale);
+        EXPECT_GE(sc.work_scale, scale * 0.5 - 1e-9);
+    }
+    EXPECT_LT(sc.output_fps / 30, 0.5);
+    EXPECT_NEAR(sc.work_scale, 0.5 * 15.5 / 30, 1e-3);
+}
+
+TEST(SpeedControlTest, WorkGrowsBackWhenOnTarget) {
+    SpeedControl sc;
+    speed_control_init(&sc);
+    run_pictures(&sc, 9, 15);
+    speed_control_update_work_scale(&sc, 30, 8);
+    EXPECT_NEAR(sc.work_scale, 0.5, 0.01);
+    double scale = sc.work_scale;
+    for (int i = 0; i < 10; i++) {
+        run_pictures(&sc, 16, 60);
+        speed_control_update_work_scale(&sc, 30, 8);
+        EXPECT_GT(sc.work_scale, scale);
+        scale = sc.work_scale;
+    }
+    EXPECT_LE(sc.work_scale, 1.0);
+}
+
+TEST(SpeedControlTest, BacklogLowersWorkBeforeAnyOutput) {
+    SpeedControl sc;
+    speed_control_init(&sc);
+    // Up to two mini-gops and the key frame in flight is the pipeline filling
+    sc.frames_in = 17;
+    speed_control_update_work_scale(&sc, 30, 8);
+    EXPECT_EQ(sc.work_scale, 1.0);
+    sc.frames_in = 34;
+    speed_control_update_work_scale(&sc, 30, 8);
+    EXPECT_NEAR(sc.work_scale, 0.5, 1e-9);
+    // Once out, the rate of the pictures coded at full work takes over
+    run_pictures(&sc, 9, 20);
+    speed_control_update_work_scale(&sc, 30, 8);
+    EXPECT_NEAR(sc.work_scale, 0.5, 1e-9);
+}
+
+}  // namespace
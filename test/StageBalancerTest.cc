@@ -0,0 +1,178 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+/******************************************************************************
+ * @file StageBalancerTest.cc
+ *
+ * @brief Unit test of the stage balancer:
+ * - initial distribution of the worker budget
+ * - a thread moves from an idle stage to a backlogged one
+ *
+ ******************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+// workaround to eliminate the compiling warning on linux
+// The macro will conflict with definition in gtest.h
+#ifdef __USE_GNU
+#undef __USE_GNU  // defined in EbThreads.h
+#endif
+#ifdef _GNU_SOURCE
+#undef _GNU_SOURCE  // defined in EbThreads.h
+#endif
+
+#include "EbStageBalancer.h"
+
+namespace {
+
+template <typename T>
+static T *object_new() {
+    return (T *)calloc(1, sizeof(T));
+}
+
+template <typename T>
+static void object_delete(T *obj) {
+    if (obj && obj->dctor)
+        obj->dctor(obj);
+    free(obj);
+}
+
+typedef struct TestObject {
+    EbDctor dctor;
+} TestObject;
+
+static EbErrorType test_object_creator(EbPtr *object_dbl_ptr, EbPtr) {
+    TestObject *obj = object_new<TestObject>();
+    if (!obj)
+        return EB_ErrorInsufficientResources;
+    *object_dbl_ptr = obj;
+    return EB_ErrorNone;
+}
+
+static void test_object_destroyer(EbPtr p) {
+    free(p);
+}
+
+static EbSystemResource *resource_new(uint32_t object_count,
+                                      uint32_t consumers) {
+    EbSystemResource *resource = object_new<EbSystemResource>();
+    EXPECT_EQ(EB_ErrorNone,
+              svt_system_resource_ctor_mode(resource,
+                                            object_count,
+                                            1,
+                                            consumers,
+                                            test_object_creator,
+                                            NULL,
+                                            test_object_destroyer,
+                                            EB_TRUE));
+    return resource;
+}
+
+TEST(StageBalancerTest, InitialDistribution) {
+    EbSystemResource *small = resource_new(1, 2);
+    EbSystemResource *large = resource_new(1, 6);
+    EbBalancedStageInit stages[] = {{"small", small, 2}, {"large", large, 6}};
+    SvtAv1StageBalanceStats stats;
+
+    EbStageBalancer *balancer = object_new<EbStageBalancer>();
+    ASSERT_EQ(EB_ErrorNone, svt_stage_balancer_ctor(balancer, 4, stages, 2));
+    svt_stage_balancer_get_stats(balancer, &stats);
+    EXPECT_EQ(4u, stats.worker_budget);
+    ASSERT_EQ(2u, stats.stage_count);
+    EXPECT_EQ(1u, stats.stages[0].active_workers);
+    EXPECT_EQ(3u, stats.stages[1].active_workers);
+    EXPECT_EQ(6u, stats.stages[1].max_workers);
+    object_delete(balancer);
+
+    // the budget is raised to one thread per stage
+    balancer = object_new<EbStageBalancer>();
+    ASSERT_EQ(EB_ErrorNone, svt_stage_balancer_ctor(balancer, 1, stages, 2));
+    svt_stage_balancer_get_stats(balancer, &stats);
+    EXPECT_EQ(2u, stats.worker_budget);
+    EXPECT_EQ(1u, stats.stages[0].active_workers);
+    EXPECT_EQ(1u, stats.stages[1].active_workers);
+    object_delete(balancer);
+
+    svt_shutdown_process(small);
+    svt_shutdown_process(large);
+    object_delete(small);
+    object_delete(large);
+}
+
+TEST(StageBalancerTest, MovesThreadToBacklog) {
+    const uint32_t consumers = 4;
+    EbSystemResource *busy = resource_new(32, consumers);
+    EbSystemResource *idle = resource_new(1, consumers);
+    EbBalancedStageInit stages[] = {{"busy", busy, consumers},
+                                    {"idle", idle, consumers}};
+    EbStageBalancer *balancer = object_new<EbStageBalancer>();
+    ASSERT_EQ(EB_ErrorNone, svt_stage_balancer_ctor(balancer, 4, stages, 2));
+
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> threads;
+    for (uint32_t c = 0; c < consumers; c++) {
+        EbFifo *busy_fifo = svt_system_resource_get_consumer_fifo(busy, c);
+        EbFifo *idle_fifo = svt_system_resource_get_consumer_fifo(idle, c);
+        // slow consumers keep the busy queue backlogged
+        threads.push_back(std::thread([busy_fifo]() {
+            for (;;) {
+                EbObjectWrapper *wrapper;
+                if (svt_get_full_object(busy_fifo, &wrapper) ==
+                    EB_NoErrorFifoShutdown)
+                    break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                svt_release_object(wrapper);
+            }
+        }));
+        threads.push_back(std::thread([idle_fifo]() {
+            EbObjectWrapper *wrapper;
+            while (svt_get_full_object(idle_fifo, &wrapper) !=
+                   EB_NoErrorFifoShutdown)
+                svt_release_object(wrapper);
+        }));
+    }
+    std::thread producer_thread([busy, &stop]() {
+        EbFifo *producer = svt_system_resource_get_producer_fifo(busy, 0);
+        while (!stop.load()) {
+            EbObjectWrapper *wrapper;
+            svt_get_empty_object(producer, &wrapper);
+            svt_post_full_object(wrapper);
+        }
+    });
+
+    SvtAv1StageBalanceStats stats;
+    for (uint32_t i = 0; i < 500; i++) {
+        svt_stage_balancer_get_stats(balancer, &stats);
+        if (stats.stages[1].active_workers == 1)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(3u, stats.stages[0].active_workers);
+    EXPECT_EQ(1u, stats.stages[1].active_workers);
+    EXPECT_GE(stats.stages[0].raise_count, 1u);
+    EXPECT_GE(stats.stages[1].lower_count, 1u);
+    EXPECT_GT(stats.stages[0].queue_depth, 1.0);
+
+    object_delete(balancer);
+    stop = true;
+    producer_thread.join();
+    svt_shutdown_process(busy);
+    svt_shutdown_process(idle);
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+    object_delete(busy);
+    object_delete(idle);
+}
+
+}  // namespace
@@ -0,0 +1,503 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+/******************************************************************************
+ * @file SystemResourceManagerTest.cc
+ *
+ * @brief Unit test of the system resource manager queues:
+ * - svt_get_empty_object / svt_post_full_object
+ * - svt_get_full_object / svt_get_full_object_non_blocking
+ * - svt_release_object / svt_object_inc_live_count
+ * - svt_shutdown_process
+ * - svt_system_resource_set_active_consumers
+ * - svt_system_resource_get_consumer_stats
+ *
+ * Every test runs on both the lock-free ring queues and the mutex +
+ * semaphore muxing queues. The DISABLED_ speed test compares the
+ * throughput of the two implementations.
+ *
+ ******************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+// workaround to eliminate the compiling warning on linux
+// The macro will conflict with definition in gtest.h
+#ifdef __USE_GNU
+#undef __USE_GNU  // defined in EbThreads.h
+#endif
+#ifdef _GNU_SOURCE
+#undef _GNU_SOURCE  // defined in EbThreads.h
+#endif
+
+#include "EbSystemResourceManager.h"
+#include "EbTime.h"
+
+namespace {
+
+typedef struct TestObject {
+    EbDctor  dctor;
+    uint64_t value;
+} TestObject;
+
+static EbErrorType test_object_creator(EbPtr *object_dbl_ptr,
+                                       EbPtr object_init_data_ptr) {
+    (void)object_init_data_ptr;
+    TestObject *obj = (TestObject *)calloc(1, sizeof(TestObject));
+    if (!obj)
+        return EB_ErrorInsufficientResources;
+    *object_dbl_ptr = obj;
+    return EB_ErrorNone;
+}
+
+static void test_object_destroyer(EbPtr p) {
+    free(p);
+}
+
+static void resource_dctor(EbSystemResource *resource) {
+    if (resource->dctor)
+        resource->dctor(resource);
+    free(resource);
+}
+
+static EbErrorType resource_ctor(EbSystemResource **resource_dbl_ptr,
+                                 uint32_t object_count, uint32_t producers,
+                                 uint32_t consumers, bool lock_free) {
+    EbSystemResource *resource =
+        (EbSystemResource *)calloc(1, sizeof(EbSystemResource));
+    if (!resource)
+        return EB_ErrorInsufficientResources;
+    EbErrorType err = svt_system_resource_ctor_mode(resource,
+                                                    object_count,
+                                                    producers,
+                                                    consumers,
+                                                    test_object_creator,
+                                                    NULL,
+                                                    test_object_destroyer,
+                                                    lock_free ? EB_TRUE
+                                                              : EB_FALSE);
+    if (err != EB_ErrorNone) {
+        resource_dctor(resource);
+        return err;
+    }
+    *resource_dbl_ptr = resource;
+    return EB_ErrorNone;
+}
+
+class SystemResourceTest : public ::testing::TestWithParam<bool> {
+  protected:
+    // Pushes items_per_producer values through the resource from every
+    // producer and returns the sum of everything the consumers received.
+    uint64_t run_pipeline(uint32_t object_count, uint32_t producers,
+                          uint32_t consumers, uint64_t items_per_producer,
+                          double *elapsed_ms) {
+        EbSystemResource *resource = NULL;
+        EXPECT_EQ(EB_ErrorNone,
+                  resource_ctor(&resource,
+                                object_count,
+                                producers,
+                                consumers,
+                                GetParam()));
+        if (!resource)
+            return 0;
+
+        std::atomic<uint64_t> received_sum(0);
+        std::atomic<uint64_t> received_count(0);
+        const uint64_t total = items_per_producer * producers;
+        std::vector<std::thread> threads;
+        uint64_t start_s, start_us, end_s, end_us;
+
+        svt_av1_get_time(&start_s, &start_us);
+        for (uint32_t c = 0; c < consumers; c++) {
+            EbFifo *fifo = svt_system_resource_get_consumer_fifo(resource, c);
+            threads.push_back(std::thread([fifo, &received_sum,
+                                           &received_count]() {
+                for (;;) {
+                    EbObjectWrapper *wrapper;
+                    if (svt_get_full_object(fifo, &wrapper) ==
+                        EB_NoErrorFifoShutdown)
+                        break;
+                    received_sum +=
+                        ((TestObject *)wrapper->object_ptr)->value;
+                    svt_release_object(wrapper);
+                    received_count++;
+                }
+            }));
+        }
+        for (uint32_t p = 0; p < producers; p++) {
+            EbFifo *fifo = svt_system_resource_get_producer_fifo(resource, p);
+            threads.push_back(std::thread([fifo, p, items_per_producer]() {
+                for (uint64_t i = 0; i < items_per_producer; i++) {
+                    EbObjectWrapper *wrapper;
+                    svt_get_empty_object(fifo, &wrapper);
+                    ((TestObject *)wrapper->object_ptr)->value =
+                        p * items_per_producer + i + 1;
+                    svt_post_full_object(wrapper);
+                }
+            }));
+        }
+
+        while (received_count.load() < total)
+            std::this_thread::yield();
+        svt_av1_get_time(&end_s, &end_us);
+
+        svt_shutdown_process(resource);
+        for (size_t i = 0; i < threads.size(); i++)
+            threads[i].join();
+        resource_dctor(resource);
+
+        if (elapsed_ms)
+            *elapsed_ms = svt_av1_compute_overall_elapsed_time_ms(
+                start_s, start_us, end_s, end_us);
+        return received_sum.load();
+    }
+};
+
+static uint64_t expected_sum(uint32_t producers, uint64_t items_per_producer) {
+    const uint64_t n = producers * items_per_producer;
+    return n * (n + 1) / 2;
+}
+
+TEST_P(SystemResourceTest, SingleProducerSingleConsumer) {
+    EXPECT_EQ(expected_sum(1, 10000), run_pipeline(4, 1, 1, 10000, NULL));
+}
+
+TEST_P(SystemResourceTest, MultiProducerMultiConsumer) {
+    EXPECT_EQ(expected_sum(4, 20000), run_pipeline(5, 4, 6, 20000, NULL));
+}
+
+TEST_P(SystemResourceTest, SingleObjectManyThreads) {
+    EXPECT_EQ(expected_sum(3, 5000), run_pipeline(1, 3, 3, 5000, NULL));
+}
+
+TEST_P(SystemResourceTest, LiveCountHoldsObject) {
+    EbSystemResource *resource = NULL;
+    ASSERT_EQ(EB_ErrorNone, resource_ctor(&resource, 1, 1, 1, GetParam()));
+    EbFifo *producer = svt_system_resource_get_producer_fifo(resource, 0);
+    EbFifo *consumer = svt_system_resource_get_consumer_fifo(resource, 0);
+    EbObjectWrapper *wrapper, *full;
+
+    svt_get_empty_object(producer, &wrapper);
+    svt_object_inc_live_count(wrapper, 2);
+    svt_post_full_object(wrapper);
+    svt_get_full_object(consumer, &full);
+    EXPECT_EQ(wrapper, full);
+
+    // the object only goes back to the empty queue on the last release
+    svt_release_object(full);
+    EXPECT_EQ(1u, wrapper->live_count);
+    svt_release_object(full);
+    EXPECT_EQ(EB_ObjectWrapperReleasedValue, wrapper->live_count);
+
+    svt_get_empty_object(producer, &wrapper);
+    EXPECT_EQ(full, wrapper);
+    EXPECT_EQ(0u, wrapper->live_count);
+
+    svt_object_release_disable(wrapper);
+    svt_release_object(wrapper);
+    EXPECT_EQ(0u, wrapper->live_count);
+    svt_object_release_enable(wrapper);
+    svt_release_object(wrapper);
+    EXPECT_EQ(EB_ObjectWrapperReleasedValue, wrapper->live_count);
+
+    svt_shutdown_process(resource);
+    resource_dctor(resource);
+}
+
+typedef struct ReleaseHookCtx {
+    EbSystemResource *resource;
+    uint32_t          calls;
+    EbPtr             last_object;
+    EbObjectWrapper * reacquired;
+} ReleaseHookCtx;
+
+static void release_hook(void *hook_ctx, EbPtr object_ptr) {
+    ReleaseHookCtx *ctx = (ReleaseHookCtx *)hook_ctx;
+    ctx->calls++;
+    ctx->last_object = object_ptr;
+}
+
+// The hook runs unlocked, so it may take objects from the same resource
+static void reentrant_release_hook(void *hook_ctx, EbPtr object_ptr) {
+    ReleaseHookCtx *ctx = (ReleaseHookCtx *)hook_ctx;
+    release_hook(hook_ctx, object_ptr);
+    svt_get_empty_object(svt_system_resource_get_producer_fifo(ctx->resource, 0),
+                         &ctx->reacquired);
+}
+
+TEST_P(SystemResourceTest, ReleaseHook) {
+    EbSystemResource *resource = NULL;
+    ASSERT_EQ(EB_ErrorNone, resource_ctor(&resource, 2, 1, 1, GetParam()));
+    EbFifo *producer = svt_system_resource_get_producer_fifo(resource, 0);
+    EbObjectWrapper *wrapper;
+    ReleaseHookCtx ctx = {resource, 0, NULL, NULL};
+
+    svt_system_resource_set_release_hook(resource, release_hook, &ctx);
+    svt_get_empty_object(producer, &wrapper);
+    svt_object_inc_live_count(wrapper, 2);
+
+    // only the last release recycles the object
+    svt_release_object(wrapper);
+    EXPECT_EQ(0u, ctx.calls);
+    svt_release_object(wrapper);
+    EXPECT_EQ(1u, ctx.calls);
+    EXPECT_EQ(wrapper->object_ptr, ctx.last_object);
+
+    svt_system_resource_set_release_hook(resource, reentrant_release_hook, &ctx);
+    svt_get_empty_object(producer, &wrapper);
+    svt_release_object(wrapper);
+    EXPECT_EQ(2u, ctx.calls);
+    ASSERT_TRUE(ctx.reacquired != NULL);
+
+    svt_system_resource_set_release_hook(resource, NULL, NULL);
+    svt_release_object(ctx.reacquired);
+    EXPECT_EQ(2u, ctx.calls);
+
+    svt_shutdown_process(resource);
+    resource_dctor(resource);
+}
+
+TEST_P(SystemResourceTest, NonBlockingAndShutdown) {
+    EbSystemResource *resource = NULL;
+    ASSERT_EQ(EB_ErrorNone, resource_ctor(&resource, 2, 1, 1, GetParam()));
+    EbFifo *producer = svt_system_resource_get_producer_fifo(resource, 0);
+    EbFifo *consumer = svt_system_resource_get_consumer_fifo(resource, 0);
+    EbObjectWrapper *wrapper, *full;
+
+    svt_get_full_object_non_blocking(consumer, &full);
+    EXPECT_TRUE(full == NULL);
+
+    svt_get_empty_object(producer, &wrapper);
+    svt_post_full_object(wrapper);
+    svt_get_full_object_non_blocking(consumer, &full);
+    EXPECT_EQ(wrapper, full);
+    svt_release_object(full);
+
+    // a consumer blocked on an empty queue is woken up by the shutdown
+    EbErrorType ret = EB_ErrorNone;
+    std::thread waiter([consumer, &ret]() {
+        EbObjectWrapper *w;
+        ret = svt_get_full_object(consumer, &w);
+    });
+    svt_shutdown_process(resource);
+    waiter.join();
+    EXPECT_EQ(EB_NoErrorFifoShutdown, ret);
+
+    resource_dctor(resource);
+}
+
+TEST_P(SystemResourceTest, ActiveConsumers) {
+    const uint32_t consumers = 3;
+    EbSystemResource *resource = NULL;
+    ASSERT_EQ(EB_ErrorNone,
+              resource_ctor(&resource, consumers, 1, consumers, GetParam()));
+    if (!GetParam()) {
+        // only the lock-free queues can park consumers
+        EXPECT_EQ(EB_ErrorBadParameter,
+                  svt_system_resource_set_active_consumers(resource, 1));
+        svt_shutdown_process(resource);
+        resource_dctor(resource);
+        return;
+    }
+    ASSERT_EQ(EB_ErrorNone,
+              svt_system_resource_set_active_consumers(resource, 1));
+
+    std::atomic<uint32_t> counts[consumers];
+    std::atomic<uint32_t> total(0);
+    std::atomic<bool> hold(false);
+    std::vector<std::thread> threads;
+    for (uint32_t c = 0; c < consumers; c++) {
+        counts[c] = 0;
+        EbFifo *fifo = svt_system_resource_get_consumer_fifo(resource, c);
+        threads.push_back(std::thread([fifo, c, &counts, &total, &hold]() {
+            for (;;) {
+                EbObjectWrapper *wrapper;
+                if (svt_get_full_object(fifo, &wrapper) ==
+                    EB_NoErrorFifoShutdown)
+                    break;
+                counts[c]++;
+                total++;
+                while (hold.load())
+                    std::this_thread::yield();
+                svt_release_object(wrapper);
+            }
+        }));
+    }
+    EbFifo *producer = svt_system_resource_get_producer_fifo(resource, 0);
+    EbObjectWrapper *wrapper;
+
+    // only consumer 0 takes objects
+    for (uint32_t i = 0; i < 50; i++) {
+        svt_get_empty_object(producer, &wrapper);
+        svt_post_full_object(wrapper);
+    }
+    while (total.load() < 50)
+        std::this_thread::yield();
+    EXPECT_EQ(50u, counts[0].load());
+
+    // every consumer holds the object it took, so the last objects can
+    // only be taken by the unparked consumers
+    hold = true;
+    svt_system_resource_set_active_consumers(resource, consumers);
+    for (uint32_t i = 0; i < consumers; i++) {
+        svt_get_empty_object(producer, &wrapper);
+        svt_post_full_object(wrapper);
+    }
+    while (total.load() < 50 + consumers)
+        std::this_thread::yield();
+    for (uint32_t c = 0; c < consumers; c++)
+        EXPECT_EQ(c ? 1u : 51u, counts[c].load());
+    hold = false;
+
+    // parked consumers are woken up by the shutdown
+    svt_system_resource_set_active_consumers(resource, 1);
+    svt_shutdown_process(resource);
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+    resource_dctor(resource);
+}
+
+TEST_P(SystemResourceTest, ConsumerStats) {
+    EbSystemResource *resource = NULL;
+    ASSERT_EQ(EB_ErrorNone, resource_ctor(&resource, 4, 1, 2, GetParam()));
+    EbFifo *producer = svt_system_resource_get_producer_fifo(resource, 0);
+    EbFifo *consumer = svt_system_resource_get_consumer_fifo(resource, 1);
+    EbObjectWrapper *wrapper;
+    EbConsumerStats stats;
+
+    for (uint32_t i = 0; i < 3; i++) {
+        svt_get_empty_object(producer, &wrapper);
+        svt_post_full_object(wrapper);
+    }
+    svt_system_resource_get_consumer_stats(resource, &stats);
+    EXPECT_EQ(2u, stats.consumer_count);
+    EXPECT_EQ(0u, stats.item_count);
+    EXPECT_EQ(3u, stats.queue_depth);
+    EXPECT_EQ(3u, stats.max_queue_depth);
+
+    for (uint32_t i = 0; i < 3; i++) {
+        svt_get_full_object(consumer, &wrapper);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        svt_release_object(wrapper);
+    }
+    svt_get_full_object_non_blocking(consumer, &wrapper);
+    EXPECT_EQ(NULL, wrapper);
+    svt_system_resource_get_consumer_stats(resource, &stats);
+    EXPECT_EQ(3u, stats.item_count);
+    EXPECT_EQ(0u, stats.queue_depth);
+    EXPECT_EQ(3u, stats.max_queue_depth);
+    // the time between two objects is busy time
+    EXPECT_GE(stats.busy_ns, 2000000u);
+
+    svt_shutdown_process(resource);
+    resource_dctor(resource);
+}
+
+TEST_P(SystemResourceTest, NonBlockingConsumerStats) {
+    EbSystemResource *resource = NULL;
+    ASSERT_EQ(EB_ErrorNone, resource_ctor(&resource, 4, 1, 1, GetParam()));
+    EbFifo *producer = svt_system_resource_get_producer_fifo(resource, 0);
+    EbFifo *consumer = svt_system_resource_get_consumer_fifo(resource, 0);
+    EbObjectWrapper *wrapper;
+    EbConsumerStats stats;
+
+    for (uint32_t i = 0; i < 2; i++) {
+        svt_get_empty_object(producer, &wrapper);
+        svt_post_full_object(wrapper);
+    }
+    // counted as by svt_get_full_object
+    for (uint32_t i = 0; i < 2; i++) {
+        svt_get_full_object_non_blocking(consumer, &wrapper);
+        ASSERT_NE(nullptr, wrapper);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        svt_release_object(wrapper);
+    }
+    svt_get_full_object_non_blocking(consumer, &wrapper);
+    EXPECT_EQ(NULL, wrapper);
+    svt_system_resource_get_consumer_stats(resource, &stats);
+    EXPECT_EQ(2u, stats.item_count);
+    EXPECT_GE(stats.busy_ns, 2000000u);
+
+    // an empty queue ends the busy time
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    svt_get_full_object_non_blocking(consumer, &wrapper);
+    svt_system_resource_get_consumer_stats(resource, &stats);
+    EXPECT_LT(stats.busy_ns, 4000000u);
+
+    svt_shutdown_process(resource);
+    resource_dctor(resource);
+}
+
+TEST_P(SystemResourceTest, DISABLED_SpeedTest) {
+    const uint32_t thread_counts[] = {1, 2, 4, 8};
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]);
+         i++) {
+        const uint32_t n = thread_counts[i];
+        const uint64_t items = 400000 / n;
+        double time_ms = 0;
+        EXPECT_EQ(expected_sum(n, items),
+                  run_pipeline(2 * n, n, n, items, &time_ms));
+        printf("    %s queues, %u producers x %u consumers: %8.2f ms "
+               "(%6.2f Mitems/s)\n",
+               GetParam() ? "lock-free" : "mutex    ",
+               n,
+               n,
+               time_ms,
+               (items * n) / (time_ms * 1000.0));
+    }
+}
+
+TEST(SystemResourceElastic, GrowsOnDemand) {
+    EbSystemResource *resource =
+        (EbSystemResource *)calloc(1, sizeof(EbSystemResource));
+    ASSERT_TRUE(resource != NULL);
+    ASSERT_EQ(EB_ErrorNone,
+              svt_system_resource_ctor_elastic(resource,
+                                               1,
+                                               3,
+                                               1,
+                                               1,
+                                               test_object_creator,
+                                               NULL,
+                                               0,
+                                               test_object_destroyer));
+    EbFifo *producer = svt_system_resource_get_producer_fifo(resource, 0);
+    EbObjectWrapper *wrappers[3];
+    EXPECT_EQ(1u, resource->constructed_count);
+
+    // a released object is reused before the pool grows
+    svt_get_empty_object(producer, &wrappers[0]);
+    svt_release_object(wrappers[0]);
+    svt_get_empty_object(producer, &wrappers[0]);
+    EXPECT_EQ(1u, resource->constructed_count);
+
+    // the empty pool grows instead of blocking, up to the total count
+    svt_get_empty_object(producer, &wrappers[1]);
+    svt_get_empty_object(producer, &wrappers[2]);
+    EXPECT_EQ(3u, resource->constructed_count);
+    EXPECT_NE(wrappers[0], wrappers[1]);
+    EXPECT_NE(wrappers[1], wrappers[2]);
+    EXPECT_EQ(0u, wrappers[2]->live_count);
+
+    for (int i = 0; i < 3; i++) svt_release_object(wrappers[i]);
+    svt_get_empty_object(producer, &wrappers[0]);
+    EXPECT_EQ(3u, resource->constructed_count);
+    svt_release_object(wrappers[0]);
+
+    svt_shutdown_process(resource);
+    resource_dctor(resource);
+}
+
+INSTANTIATE_TEST_CASE_P(SRM, SystemResourceTest, ::testing::Bool());
+
+}  // namespace
@@ -0,0 +1,479 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+/******************************************************************************
+ * @file TaskSchedulerTest.cc
+ *
+ * @brief Unit test of the work-stealing task scheduler:
+ * - svt_task_scheduler_submit from inside and outside the pool
+ * - svt_task_scheduler_reserve within the spare worker and queue budgets
+ * - kernel jobs chained through system resources, with a worker blocked
+ *   in svt_get_empty_object (managed blocking)
+ * - task groups: weighted fair shares, kernel jobs of several groups on
+ *   one scheduler and svt_kernel_job_stop
+ *
+ ******************************************************************************/
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "gtest/gtest.h"
+// workaround to eliminate the compiling warning on linux
+// The macro will conflict with definition in gtest.h
+#ifdef __USE_GNU
+#undef __USE_GNU  // defined in EbThreads.h
+#endif
+#ifdef _GNU_SOURCE
+#undef _GNU_SOURCE  // defined in EbThreads.h
+#endif
+
+#include "EbTaskScheduler.h"
+#include "EbTime.h"
+
+namespace {
+
+template <typename T>
+static T *object_new() {
+    return (T *)calloc(1, sizeof(T));
+}
+
+template <typename T>
+static void object_delete(T *obj) {
+    if (obj && obj->dctor)
+        obj->dctor(obj);
+    free(obj);
+}
+
+/* Every root task submits fan_out children from inside the pool */
+struct FanOut {
+    EbTaskScheduler *      scheduler;
+    EbTask                 root;
+    EbTask                 child;
+    uint32_t               fan_out;
+    std::atomic<uint32_t> *done;
+};
+
+static void child_task(void *arg) {
+    FanOut *f = (FanOut *)arg;
+    (*f->done)++;
+}
+
+static void root_task(void *arg) {
+    FanOut *f = (FanOut *)arg;
+    for (uint32_t i = 0; i < f->fan_out; i++)
+        svt_task_scheduler_submit(f->scheduler, &f->child);
+    (*f->done)++;
+}
+
+TEST(TaskSchedulerTest, SubmitFromInsideAndOutsidePool) {
+    const uint32_t roots = 64, fan_out = 16;
+    std::atomic<uint32_t> done(0);
+    EbTaskScheduler *scheduler = object_new<EbTaskScheduler>();
+    ASSERT_EQ(EB_ErrorNone,
+              svt_task_scheduler_ctor(
+                  scheduler, 4, 0, roots * (fan_out + 1), NULL));
+    EXPECT_EQ(4u, svt_task_scheduler_thread_count(scheduler));
+
+    FanOut f;
+    f.scheduler = scheduler;
+    f.root.fn = root_task;
+    f.root.arg = &f;
+    f.child.fn = child_task;
+    f.child.arg = &f;
+    f.fan_out = fan_out;
+    f.done = &done;
+    for (uint32_t i = 0; i < roots; i++)
+        svt_task_scheduler_submit(scheduler, &f.root);
+    while (done.load() < roots * (fan_out + 1))
+        std::this_thread::yield();
+
+    object_delete(scheduler);
+    EXPECT_EQ(roots * (fan_out + 1), done.load());
+}
+
+TEST(TaskSchedulerTest, ReserveWithinBudgets) {
+    EbTaskScheduler *scheduler = object_new<EbTaskScheduler>();
+    ASSERT_EQ(EB_ErrorNone,
+              svt_task_scheduler_ctor(scheduler, 1, 8, 16, NULL));
+
+    EXPECT_EQ(EB_ErrorNone, svt_task_scheduler_reserve(scheduler, 6, 6));
+    // Over the spare workers, then over the queue capacity
+    EXPECT_EQ(EB_ErrorInsufficientResources,
+              svt_task_scheduler_reserve(scheduler, 3, 3));
+    EXPECT_EQ(EB_ErrorInsufficientResources,
+              svt_task_scheduler_reserve(scheduler, 2, 11));
+    EXPECT_EQ(EB_ErrorNone, svt_task_scheduler_reserve(scheduler, 2, 10));
+    svt_task_scheduler_unreserve(scheduler, 6, 6);
+    EXPECT_EQ(EB_ErrorNone, svt_task_scheduler_reserve(scheduler, 6, 6));
+    svt_task_scheduler_unreserve(scheduler, 6, 6);
+    svt_task_scheduler_unreserve(scheduler, 2, 10);
+
+    object_delete(scheduler);
+}
+
+typedef struct TestObject {
+    EbDctor  dctor;
+    uint64_t value;
+} TestObject;
+
+static EbErrorType test_object_creator(EbPtr *object_dbl_ptr, EbPtr) {
+    TestObject *obj = object_new<TestObject>();
+    if (!obj)
+        return EB_ErrorInsufficientResources;
+    *object_dbl_ptr = obj;
+    return EB_ErrorNone;
+}
+
+static void test_object_destroyer(EbPtr p) {
+    free(p);
+}
+
+static EbSystemResource *resource_new(uint32_t object_count, uint32_t producers,
+                                      uint32_t consumers) {
+    EbSystemResource *resource = object_new<EbSystemResource>();
+    EXPECT_EQ(EB_ErrorNone,
+              svt_system_resource_ctor_mode(resource,
+                                            object_count,
+                                            producers,
+                                            consumers,
+                                            test_object_creator,
+                                            NULL,
+                                            test_object_destroyer,
+                                            EB_TRUE));
+    return resource;
+}
+
+/* Same shape as the encoder kernels: loop on EB_GET_FULL_OBJECT */
+struct StageContext {
+    EbFifo *               input_fifo;
+    EbFifo *               output_fifo;
+    std::atomic<uint64_t> *sum;
+};
+
+static void *forward_kernel(void *input_ptr) {
+    StageContext *context = (StageContext *)input_ptr;
+    for (;;) {
+        EbObjectWrapper *in, *out;
+        EB_GET_FULL_OBJECT(context->input_fifo, &in);
+        // Blocks while the single output object is in use
+        svt_get_empty_object(context->output_fifo, &out);
+        ((TestObject *)out->object_ptr)->value =
+            ((TestObject *)in->object_ptr)->value;
+        svt_release_object(in);
+        svt_post_full_object(out);
+    }
+}
+
+static void *sum_kernel(void *input_ptr) {
+    StageContext *context = (StageContext *)input_ptr;
+    for (;;) {
+        EbObjectWrapper *in;
+        EB_GET_FULL_OBJECT(context->input_fifo, &in);
+        *context->sum += ((TestObject *)in->object_ptr)->value;
+        svt_release_object(in);
+    }
+}
+
+TEST(TaskSchedulerTest, KernelJobsWithBlockedWorker) {
+    const uint32_t contexts = 3;
+    const uint64_t items = 20000;
+    std::atomic<uint64_t> sum(0);
+    EbSystemResource *input = resource_new(8, 1, contexts);
+    EbSystemResource *middle = resource_new(1, contexts, contexts);
+    EbTaskScheduler *scheduler = object_new<EbTaskScheduler>();
+    // A single worker: the pipeline only progresses if a spare worker
+    // takes over while the forward kernel waits for the middle object
+    ASSERT_EQ(EB_ErrorNone,
+              svt_task_scheduler_ctor(
+                  scheduler, 1, 2 * contexts, 2 * contexts, NULL));
+
+    StageContext forward[contexts], summing[contexts];
+    EbPtr forward_ptrs[contexts], summing_ptrs[contexts];
+    for (uint32_t i = 0; i < contexts; i++) {
+        forward[i].input_fifo = svt_system_resource_get_consumer_fifo(input, i);
+        forward[i].output_fifo =
+            svt_system_resource_get_producer_fifo(middle, i);
+        forward[i].sum = NULL;
+        summing[i].input_fifo =
+            svt_system_resource_get_consumer_fifo(middle, i);
+        summing[i].output_fifo = NULL;
+        summing[i].sum = &sum;
+        forward_ptrs[i] = &forward[i];
+        summing_ptrs[i] = &summing[i];
+    }
+    EbKernelJob *forward_job = object_new<EbKernelJob>();
+    EbKernelJob *sum_job = object_new<EbKernelJob>();
+    ASSERT_EQ(EB_ErrorNone,
+              svt_kernel_job_ctor(forward_job,
+                                  scheduler,
+                                  NULL,
+                                  input,
+                                  forward_kernel,
+                                  forward_ptrs,
+                                  contexts));
+    ASSERT_EQ(EB_ErrorNone,
+              svt_kernel_job_ctor(sum_job,
+                                  scheduler,
+                                  NULL,
+                                  middle,
+                                  sum_kernel,
+                                  summing_ptrs,
+                                  contexts));
+
+    EbFifo *producer = svt_system_resource_get_producer_fifo(input, 0);
+    for (uint64_t i = 1; i <= items; i++) {
+        EbObjectWrapper *wrapper;
+        svt_get_empty_object(producer, &wrapper);
+        ((TestObject *)wrapper->object_ptr)->value = i;
+        svt_post_full_object(wrapper);
+    }
+    while (sum.load() < items * (items + 1) / 2)
+        std::this_thread::yield();
+
+    svt_shutdown_process(input);
+    svt_shutdown_process(middle);
+    object_delete(scheduler);
+    EXPECT_EQ(items * (items + 1) / 2, sum.load());
+    EXPECT_EQ(0u, svt_system_resource_full_pending_count(middle));
+
+    object_delete(forward_job);
+    object_delete(sum_job);
+    object_delete(input);
+    object_delete(middle);
+}
+
+/* Holds the worker until opened, so that tasks queue up meanwhile */
+struct Gate {
+    std::mutex              mutex;
+    std::condition_variable changed;
+    bool                    entered;
+    bool                    open;
+};
+
+static void gate_task(void *arg) {
+    Gate *                       g = (Gate *)arg;
+    std::unique_lock<std::mutex> lock(g->mutex);
+    g->entered = true;
+    g->changed.notify_one();
+    g->changed.wait(lock, [g]() { return g->open; });
+}
+
+/* A task that burns about 200us and queues itself again on its group until
+ * the groups ran total_runs tasks. With a single worker the group picked is
+ * a function of the virtual times only, which stay put while a task runs. */
+struct BusyTask {
+    EbTaskGroup *            group;
+    BusyTask *               other;
+    EbTask                   task;
+    std::atomic<uint32_t> *  total;
+    uint32_t                 total_runs;
+    std::mutex *             mutex;
+    std::condition_variable *done;
+    std::atomic<uint32_t> *  finished;
+    uint32_t                 runs;
+    uint32_t                 unfair_runs;
+};
+
+static void busy_task(void *arg) {
+    BusyTask *b = (BusyTask *)arg;
+    // The other group has a task queued until the total is reached: the
+    // group with the smallest virtual time was picked
+    if (b->total->load() < b->total_runs && b->group->vtime > b->other->group->vtime)
+        b->unfair_runs++;
+    const uint64_t start_ns = svt_av1_get_time_ns();
+    while (svt_av1_get_time_ns() - start_ns < 200000) {
+    }
+    b->runs++;
+    if (++*b->total < b->total_runs) {
+        svt_task_group_submit(b->group, &b->task);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(*b->mutex);
+    ++*b->finished;
+    b->done->notify_one();
+}
+
+TEST(TaskSchedulerTest, GroupWeights) {
+    const uint32_t weights[2] = {1, 3};
+    const uint32_t total_runs = 400;
+    std::atomic<uint32_t> total(0), finished(0);
+    std::mutex mutex;
+    std::condition_variable done;
+    EbTaskScheduler *scheduler = object_new<EbTaskScheduler>();
+    ASSERT_EQ(EB_ErrorNone,
+              svt_task_scheduler_ctor(scheduler, 1, 0, 16, NULL));
+
+    EbTaskGroup *groups[2];
+    BusyTask busy[2];
+    for (uint32_t i = 0; i < 2; i++) {
+        groups[i] = object_new<EbTaskGroup>();
+        ASSERT_EQ(EB_ErrorNone,
+                  svt_task_group_ctor(groups[i], scheduler, weights[i]));
+    }
+    for (uint32_t i = 0; i < 2; i++) {
+        busy[i].group = groups[i];
+        busy[i].other = &busy[1 - i];
+        busy[i].task.fn = busy_task;
+        busy[i].task.arg = &busy[i];
+        busy[i].total = &total;
+        busy[i].total_runs = total_runs;
+        busy[i].mutex = &mutex;
+        busy[i].done = &done;
+        busy[i].finished = &finished;
+        busy[i].runs = 0;
+        busy[i].unfair_runs = 0;
+    }
+    // Both groups compete from their first task on
+    Gate gate;
+    gate.entered = gate.open = false;
+    EbTask gate_run = {gate_task, &gate};
+    svt_task_scheduler_submit(scheduler, &gate_run);
+    {
+        std::unique_lock<std::mutex> lock(gate.mutex);
+        gate.changed.wait(lock, [&gate]() { return gate.entered; });
+        for (uint32_t i = 0; i < 2; i++)
+            svt_task_group_submit(groups[i], &busy[i].task);
+        gate.open = true;
+        gate.changed.notify_one();
+    }
+    // Wait for the last run of both groups, they are idle then
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&finished]() { return finished.load() == 2; });
+    }
+    uint64_t vtime[2], run_ns[2];
+    for (uint32_t i = 0; i < 2; i++) {
+        vtime[i] = groups[i]->vtime;
+        run_ns[i] = groups[i]->run_ns;
+    }
+    object_delete(groups[0]);
+    object_delete(groups[1]);
+    object_delete(scheduler);
+
+    // The last task of a group may run once more after the total is reached
+    EXPECT_GE(busy[0].runs + busy[1].runs, total_runs);
+    EXPECT_LE(busy[0].runs + busy[1].runs, total_runs + 1);
+    for (uint32_t i = 0; i < 2; i++) {
+        EXPECT_EQ(0u, busy[i].unfair_runs) << "group " << i;
+        // Every run advanced the virtual time by its time over the weight
+        EXPECT_LE(vtime[i] * weights[i], run_ns[i]) << "group " << i;
+        EXPECT_GT(vtime[i] * weights[i] + busy[i].runs * weights[i], run_ns[i])
+            << "group " << i;
+    }
+    // The groups alternate at equal virtual times: both ran, the heavier
+    // one for about weights[1] / weights[0] times longer
+    EXPECT_GT(busy[0].runs, 1u);
+    EXPECT_GT(busy[1].runs, busy[0].runs);
+}
+
+/* One forward + sum pipeline of kernel jobs in its own group */
+struct GroupPipeline {
+    EbSystemResource *    input;
+    EbSystemResource *    middle;
+    EbTaskGroup *         group;
+    EbKernelJob *         forward_job;
+    EbKernelJob *         sum_job;
+    StageContext          forward[2], summing[2];
+    EbPtr                 forward_ptrs[2], summing_ptrs[2];
+    std::atomic<uint64_t> sum;
+};
+
+static void group_pipeline_init(GroupPipeline *p, EbTaskScheduler *scheduler,
+                                uint32_t weight) {
+    p->input = resource_new(8, 1, 2);
+    p->middle = resource_new(1, 2, 2);
+    p->group = object_new<EbTaskGroup>();
+    p->sum = 0;
+    ASSERT_EQ(EB_ErrorNone, svt_task_group_ctor(p->group, scheduler, weight));
+    for (uint32_t i = 0; i < 2; i++) {
+        p->forward[i].input_fifo =
+            svt_system_resource_get_consumer_fifo(p->input, i);
+        p->forward[i].output_fifo =
+            svt_system_resource_get_producer_fifo(p->middle, i);
+        p->forward[i].sum = NULL;
+        p->summing[i].input_fifo =
+            svt_system_resource_get_consumer_fifo(p->middle, i);
+        p->summing[i].output_fifo = NULL;
+        p->summing[i].sum = &p->sum;
+        p->forward_ptrs[i] = &p->forward[i];
+        p->summing_ptrs[i] = &p->summing[i];
+    }
+    p->forward_job = object_new<EbKernelJob>();
+    p->sum_job = object_new<EbKernelJob>();
+    ASSERT_EQ(EB_ErrorNone,
+              svt_kernel_job_ctor(p->forward_job,
+                                  scheduler,
+                                  p->group,
+                                  p->input,
+                                  forward_kernel,
+                                  p->forward_ptrs,
+                                  2));
+    ASSERT_EQ(EB_ErrorNone,
+              svt_kernel_job_ctor(p->sum_job,
+                                  scheduler,
+                                  p->group,
+                                  p->middle,
+                                  sum_kernel,
+                                  p->summing_ptrs,
+                                  2));
+}
+
+/* Same order as an encoder handle leaving a shared scheduler */
+static void group_pipeline_destroy(GroupPipeline *p) {
+    svt_shutdown_process(p->input);
+    svt_shutdown_process(p->middle);
+    svt_kernel_job_stop(p->forward_job);
+    svt_kernel_job_stop(p->sum_job);
+    object_delete(p->group);
+    object_delete(p->forward_job);
+    object_delete(p->sum_job);
+    object_delete(p->input);
+    object_delete(p->middle);
+}
+
+TEST(TaskSchedulerTest, KernelJobsInGroups) {
+    const uint64_t items = 5000;
+    EbTaskScheduler *scheduler = object_new<EbTaskScheduler>();
+    ASSERT_EQ(EB_ErrorNone,
+              svt_task_scheduler_ctor(scheduler, 2, 8, 64, NULL));
+    GroupPipeline pipelines[2];
+    group_pipeline_init(&pipelines[0], scheduler, 1);
+    group_pipeline_init(&pipelines[1], scheduler, 2);
+
+    std::thread feeders[2];
+    for (uint32_t g = 0; g < 2; g++) {
+        feeders[g] = std::thread([&pipelines, g, items]() {
+            EbFifo *producer =
+                svt_system_resource_get_producer_fifo(pipelines[g].input, 0);
+            for (uint64_t i = 1; i <= items; i++) {
+                EbObjectWrapper *wrapper;
+                svt_get_empty_object(producer, &wrapper);
+                ((TestObject *)wrapper->object_ptr)->value = i;
+                svt_post_full_object(wrapper);
+            }
+        });
+    }
+    for (uint32_t g = 0; g < 2; g++)
+        feeders[g].join();
+    for (uint32_t g = 0; g < 2; g++) {
+        while (pipelines[g].sum.load() < items * (items + 1) / 2)
+            std::this_thread::yield();
+    }
+
+    // The first handle leaves while the scheduler keeps running
+    group_pipeline_destroy(&pipelines[0]);
+    EXPECT_EQ(items * (items + 1) / 2, pipelines[1].sum.load());
+    group_pipeline_destroy(&pipelines[1]);
+    object_delete(scheduler);
+}
+
+}  // namespace
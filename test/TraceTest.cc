@@ -0,0 +1,127 @@
+/*
+* Copyright(c) 2021 Intel Corporation
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+/******************************************************************************
+ * @file TraceTest.cc
+ *
+ * @brief Unit test of the stage event tracer:
+ * - events recorded from several threads, written as trace-event JSON
+ * - the event limit
+ *
+ ******************************************************************************/
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+// workaround to eliminate the compiling warning on linux
+// The macro will conflict with definition in gtest.h
+#ifdef __USE_GNU
+#undef __USE_GNU  // defined in EbThreads.h
+#endif
+#ifdef _GNU_SOURCE
+#undef _GNU_SOURCE  // defined in EbThreads.h
+#endif
+
+#include "EbTrace.h"
+
+namespace {
+
+static const char *const test_names[] = {"first_stage", "second_stage"};
+
+static EbTracer *tracer_new(uint64_t max_event_count) {
+    EbTracer *tracer = (EbTracer *)calloc(1, sizeof(EbTracer));
+    EXPECT_EQ(EB_ErrorNone,
+              svt_tracer_ctor(tracer, test_names, 2, max_event_count));
+    return tracer;
+}
+
+static void tracer_delete(EbTracer *tracer) {
+    tracer->dctor(tracer);
+    free(tracer);
+}
+
+static std::string write_json(EbTracer *tracer) {
+    const char *file_name = "svt_trace_test.json";
+    EXPECT_EQ(EB_ErrorNone, svt_tracer_write_json(tracer, file_name));
+    std::ifstream file(file_name);
+    std::stringstream content;
+    content << file.rdbuf();
+    file.close();
+    remove(file_name);
+    return content.str();
+}
+
+static size_t count_of(const std::string &text, const std::string &pattern) {
+    size_t count = 0;
+    for (size_t pos = text.find(pattern); pos != std::string::npos;
+         pos = text.find(pattern, pos + 1))
+        count++;
+    return count;
+}
+
+TEST(TraceTest, EventsFromThreads) {
+    const uint32_t thread_count = 4;
+    const uint32_t events = 5000;  // more than one block per thread
+    EbTracer *tracer = tracer_new(1 << 20);
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < thread_count; t++) {
+        threads.push_back(std::thread([tracer, t, events]() {
+            for (uint32_t i = 0; i < events; i++)
+                svt_trace_begin(tracer, t & 1, i, t);
+            svt_trace_end();
+        }));
+    }
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+
+    const std::string json = write_json(tracer);
+    EXPECT_EQ(0u, json.find("{\"displayTimeUnit\""));
+    EXPECT_EQ(thread_count, count_of(json, "\"thread_name\""));
+    EXPECT_EQ(thread_count * events, count_of(json, "\"ph\":\"X\""));
+    EXPECT_EQ(thread_count * events / 2,
+              count_of(json, "\"name\":\"second_stage\",\"cat\""));
+    EXPECT_EQ(thread_count,
+              count_of(json, "\"args\":{\"picture\":4999,\"segment\""));
+    tracer_delete(tracer);
+}
+
+TEST(TraceTest, OpenEventIsNotWritten) {
+    EbTracer *tracer = tracer_new(1 << 20);
+
+    svt_trace_begin(tracer, 0, 1, 0);
+    EXPECT_EQ(0u, count_of(write_json(tracer), "\"ph\":\"X\""));
+    // the next begin ends the open event
+    svt_trace_begin(tracer, 1, 2, 0);
+    EXPECT_EQ(1u, count_of(write_json(tracer), "\"ph\":\"X\""));
+    svt_trace_end();
+    svt_trace_end();
+    EXPECT_EQ(2u, count_of(write_json(tracer), "\"ph\":\"X\""));
+    tracer_delete(tracer);
+}
+
+TEST(TraceTest, EventLimit) {
+    EbTracer *tracer = tracer_new(10);
+
+    for (uint32_t i = 0; i < 100; i++) {
+        svt_trace_begin(tracer, 0, i, 0);
+        svt_trace_end();
+    }
+    EXPECT_EQ(10u, count_of(write_json(tracer), "\"ph\":\"X\""));
+    EXPECT_EQ(90u, tracer->dropped_count);
+    tracer_delete(tracer);
+}
+
+}  // namespace
@@ -0,0 +1,334 @@
+/*
+* Copyright(c) 2019 Netflix, Inc.
+*
+* This source code is subject to the terms of the BSD 2 Clause License and
+* the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+* was not distributed with this source code in the LICENSE file, you can
+* obtain it at https://www.aomedia.org/license/software-license. If the Alliance for Open
+* Media Patent License 1.0 was not distributed with this source code in the
+* PATENTS file, you can obtain it at https://www.aomedia.org/license/patent-license.
+*/
+
+/******************************************************************************
+ * @file SvtAv1DecApiTest.cc
+ *
+ * @brief SVT-AV1 decoder api test, check the frame parallel and the multi
+ * threaded decoding against the serial decoding of streams coded by the
+ * encoder
+ *
+ ******************************************************************************/
+#include <stdlib.h>
+#include <vector>
+#include "EbSvtAv1Enc.h"
+#include "EbSvtAv1Dec.h"
+#include "gtest/gtest.h"
+#include "SvtAv1EncApiTest.h"
+
+using namespace svt_av1_test;
+
+namespace {
+
+typedef std::vector<uint8_t> Packet;
+
+/** DecodedPicture is an output picture of the decoder, planes packed */
+typedef struct {
+    uint32_t             width;
+    uint32_t             height;
+    std::vector<uint8_t> planes;
+} DecodedPicture;
+
+/** @brief Changes the default setup of encode_stream */
+typedef void (*StreamSetup)(EbSvtAv1EncConfiguration *config);
+
+/** 2x2 tiles */
+static void setup_tiles(EbSvtAv1EncConfiguration *config) {
+    config->tile_columns = 1;
+    config->tile_rows = 1;
+}
+
+/** Superblocks of 128x128, picked by the slow presets without TPL */
+static void setup_sb_128(EbSvtAv1EncConfiguration *config) {
+    config->enc_mode = 2;
+    config->enable_tpl_la = 0;
+}
+
+/** @brief encode_stream codes frame_count pictures of a moving gradient
+ * with the fastest preset, or the setup given, and returns the packets,
+ * the first one holds the sequence header */
+static std::vector<Packet> encode_stream(uint32_t width, uint32_t height,
+                                         uint32_t    frame_count,
+                                         StreamSetup setup = nullptr) {
+    std::vector<Packet> packets;
+    SvtAv1Context       context;
+    memset(&context, 0, sizeof(context));
+    EXPECT_EQ(EB_ErrorNone,
+              svt_av1_enc_init_handle(
+                  &context.enc_handle, &context, &context.enc_params));
+    context.enc_params.source_width = width;
+    context.enc_params.source_height = height;
+    context.enc_params.enc_mode = MAX_ENC_PRESET;
+    if (setup)
+        setup(&context.enc_params);
+    EXPECT_EQ(EB_ErrorNone,
+              svt_av1_enc_set_parameter(context.enc_handle,
+                                        &context.enc_params));
+    EXPECT_EQ(EB_ErrorNone, svt_av1_enc_init(context.enc_handle));
+
+    const size_t         luma_size = width * height;
+    std::vector<uint8_t> frame(luma_size * 3 / 2, 128);
+    EbSvtIOFormat        planes;
+    memset(&planes, 0, sizeof(planes));
+    planes.luma = frame.data();
+    planes.cb = planes.luma + luma_size;
+    planes.cr = planes.cb + luma_size / 4;
+    planes.y_stride = width;
+    planes.cb_stride = planes.cr_stride = width / 2;
+    EbBufferHeaderType input;
+    memset(&input, 0, sizeof(input));
+    input.size = sizeof(input);
+    input.p_buffer = (uint8_t *)&planes;
+    input.n_filled_len = (uint32_t)frame.size();
+    input.pic_type = EB_AV1_INVALID_PICTURE;
+
+    EbBufferHeaderType *output = nullptr;
+    bool                done = false;
+    for (uint32_t i = 0; i <= frame_count; i++) {
+        if (i < frame_count) {
+            for (uint32_t y = 0; y < height; y++)
+                for (uint32_t x = 0; x < width; x++)
+                    frame[y * width + x] = (uint8_t)((x + 2 * y + 3 * i) & 255);
+            input.pts = i;
+            EXPECT_EQ(EB_ErrorNone,
+                      svt_av1_enc_send_picture(context.enc_handle, &input));
+        } else {
+            EbBufferHeaderType eos;
+            memset(&eos, 0, sizeof(eos));
+            eos.flags = EB_BUFFERFLAG_EOS;
+            EXPECT_EQ(EB_ErrorNone,
+                      svt_av1_enc_send_picture(context.enc_handle, &eos));
+        }
+        while (!done &&
+               svt_av1_enc_get_packet(
+                   context.enc_handle, &output, i == frame_count) ==
+                   EB_ErrorNone) {
+            done = (output->flags & EB_BUFFERFLAG_EOS) != 0;
+            if (output->n_filled_len)
+                packets.push_back(
+                    Packet(output->p_buffer,
+                           output->p_buffer + output->n_filled_len));
+            svt_av1_enc_release_out_buffer(&output);
+        }
+    }
+    EXPECT_TRUE(done);
+
+    EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit(context.enc_handle));
+    EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit_handle(context.enc_handle));
+    return packets;
+}
+
+/** @brief get_picture appends the next output picture of the decoder,
+ * returns false when there is none */
+static bool get_picture(EbComponentType *handle, EbBufferHeaderType *output,
+                        std::vector<DecodedPicture> *pictures) {
+    EbAV1StreamInfo stream_info;
+    EbAV1FrameInfo  frame_info;
+    if (svt_av1_dec_get_picture(handle, output, &stream_info, &frame_info) !=
+        EB_ErrorNone)
+        return false;
+    const EbSvtIOFormat *img = (const EbSvtIOFormat *)output->p_buffer;
+    DecodedPicture       picture;
+    picture.width = img->width;
+    picture.height = img->height;
+    for (uint32_t y = 0; y < img->height; y++)
+        picture.planes.insert(picture.planes.end(),
+                              img->luma + y * img->y_stride,
+                              img->luma + y * img->y_stride + img->width);
+    for (uint32_t y = 0; y < (img->height + 1) / 2; y++) {
+        picture.planes.insert(
+            picture.planes.end(),
+            img->cb + y * img->cb_stride,
+            img->cb + y * img->cb_stride + (img->width + 1) / 2);
+        picture.planes.insert(
+            picture.planes.end(),
+            img->cr + y * img->cr_stride,
+            img->cr + y * img->cr_stride + (img->width + 1) / 2);
+    }
+    pictures->push_back(picture);
+    return true;
+}
+
+/** @brief decode_stream decodes the packets with num_p_frames frames in
+ * parallel or with threads threads, flushes the decoder and returns the
+ * pictures in output order */
+static std::vector<DecodedPicture> decode_stream(
+    const std::vector<Packet> &packets, uint32_t num_p_frames,
+    uint32_t threads = 1) {
+    std::vector<DecodedPicture> pictures;
+    EbComponentType *           handle = nullptr;
+    EbSvtAv1DecConfiguration    config;
+    memset(&config, 0, sizeof(config));
+    EXPECT_EQ(EB_ErrorNone,
+              svt_av1_dec_init_handle(&handle, nullptr, &config));
+    if (handle == nullptr)
+        return pictures;
+    config.num_p_frames = num_p_frames;
+    config.threads = threads;
+    EXPECT_EQ(EB_ErrorNone, svt_av1_dec_set_parameter(handle, &config));
+    EXPECT_EQ(EB_ErrorNone, svt_av1_dec_init(handle));
+
+    // the decoder (re)allocates the planes to the size of the pictures
+    EbSvtIOFormat img;
+    memset(&img, 0, sizeof(img));
+    img.color_fmt = EB_YUV420;
+    img.bit_depth = EB_EIGHT_BIT;
+    EbBufferHeaderType output;
+    memset(&output, 0, sizeof(output));
+    output.p_buffer = (uint8_t *)&img;
+
+    // a picture per temporal unit, then the ones in flight after the end
+    for (const Packet &packet : packets) {
+        EXPECT_EQ(EB_ErrorNone,
+                  svt_av1_dec_frame(handle, packet.data(), packet.size(), 0));
+        get_picture(handle, &output, &pictures);
+    }
+    EXPECT_EQ(EB_ErrorNone, svt_av1_dec_frame(handle, nullptr, 0, 0));
+    while (get_picture(handle, &output, &pictures)) {
+    }
+
+    EXPECT_EQ(EB_ErrorNone, svt_av1_dec_deinit(handle));
+    EXPECT_EQ(EB_ErrorNone, svt_av1_dec_deinit_handle(handle));
+    free(img.luma);
+    free(img.cb);
+    free(img.cr);
+    return pictures;
+}
+
+static void check_same_pictures(const std::vector<DecodedPicture> &expected,
+                                const std::vector<DecodedPicture> &actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_EQ(expected[i].width, actual[i].width) << "picture " << i;
+        EXPECT_EQ(expected[i].height, actual[i].height) << "picture " << i;
+        EXPECT_TRUE(expected[i].planes == actual[i].planes)
+            << "picture " << i;
+    }
+}
+
+/** @brief frame_parallel is a api test case
+ * DecApiTest.frame_parallel checks that decoding frames in parallel outputs
+ * the pictures of the serial decoding
+ *
+ * Test strategy: <br>
+ * Code a clip with the encoder, decode it one frame at a time, then with
+ * 2, 4 and 8 frames in parallel, flushing the decoder at the end.
+ *
+ * Expected result: <br>
+ * Every coded picture is output, in the same order and with the same
+ * content for all the decodings.
+ *
+ * Test coverage:
+ * num_p_frames, svt_av1_dec_frame with no data.
+ */
+TEST(DecApiTest, frame_parallel) {
+    const uint32_t            frame_count = 20;
+    const std::vector<Packet> packets = encode_stream(176, 144, frame_count);
+
+    const std::vector<DecodedPicture> serial = decode_stream(packets, 1);
+    ASSERT_EQ(frame_count, serial.size());
+    for (uint32_t num_p_frames : {2, 4, 8}) {
+        SCOPED_TRACE(testing::Message() << num_p_frames << " frames");
+        check_same_pictures(serial, decode_stream(packets, num_p_frames));
+    }
+}
+
+/** @brief sequence_change is a api test case
+ * DecApiTest.sequence_change checks that a new sequence with other
+ * dimensions reuses the picture buffers of the decoder
+ *
+ * Test strategy: <br>
+ * Code two clips of different dimensions and decode them one after the
+ * other, one frame at a time and with 4 frames in parallel.
+ *
+ * Expected result: <br>
+ * The pictures of both sequences are output with their dimensions and the
+ * same content for both decodings.
+ *
+ * Test coverage:
+ * New sequence header in the stream, the decoder picture manager.
+ */
+TEST(DecApiTest, sequence_change) {
+    std::vector<Packet>       packets = encode_stream(176, 144, 10);
+    const std::vector<Packet> second = encode_stream(96, 64, 8);
+    packets.insert(packets.end(), second.begin(), second.end());
+
+    const std::vector<DecodedPicture> serial = decode_stream(packets, 1);
+    ASSERT_EQ(18u, serial.size());
+    EXPECT_EQ(176u, serial.front().width);
+    EXPECT_EQ(64u, serial.back().height);
+    SCOPED_TRACE("4 frames");
+    check_same_pictures(serial, decode_stream(packets, 4));
+}
+
+/** @brief multi_thread is a api test case
+ * DecApiTest.multi_thread checks that the decoding threads output the
+ * pictures of the single threaded decoding
+ *
+ * Test strategy: <br>
+ * Code a clip in 2x2 tiles with the encoder, decode it with 1 thread, then
+ * with 2 and 4 threads.
+ *
+ * Expected result: <br>
+ * Every coded picture is output, in the same order and with the same
+ * content for all the decodings.
+ *
+ * Test coverage:
+ * threads, the stages of the decoder threads: parse, recon, LF, CDEF and LR.
+ */
+TEST(DecApiTest, multi_thread) {
+    const uint32_t            frame_count = 12;
+    const std::vector<Packet> packets =
+        encode_stream(352, 288, frame_count, setup_tiles);
+
+    const std::vector<DecodedPicture> single = decode_stream(packets, 1);
+    ASSERT_EQ(frame_count, single.size());
+    for (uint32_t threads : {2, 4}) {
+        SCOPED_TRACE(testing::Message() << threads << " threads");
+        check_same_pictures(single, decode_stream(packets, 1, threads));
+    }
+}
+
+/** @brief multi_thread_layout_change is a api test case
+ * DecApiTest.multi_thread_layout_change checks that the decoding threads
+ * follow the changes of frame size, tiles and SB size
+ *
+ * Test strategy: <br>
+ * Code clips with other dimensions, tile grids and SB sizes, decode them
+ * one after the other with 1 and 4 threads.
+ *
+ * Expected result: <br>
+ * The pictures of every sequence are output with their dimensions and the
+ * same content for both decodings.
+ *
+ * Test coverage:
+ * threads, the decoder resources kept or grown across layout changes.
+ */
+TEST(DecApiTest, multi_thread_layout_change) {
+    std::vector<Packet> packets = encode_stream(176, 144, 6);
+    // more tiles and rows, then SB 128, then smaller again
+    const std::vector<Packet> sequences[] = {
+        encode_stream(352, 288, 6, setup_tiles),
+        encode_stream(176, 144, 3, setup_sb_128),
+        encode_stream(96, 64, 4),
+    };
+    for (const std::vector<Packet> &sequence : sequences)
+        packets.insert(packets.end(), sequence.begin(), sequence.end());
+
+    const std::vector<DecodedPicture> single = decode_stream(packets, 1);
+    ASSERT_EQ(19u, single.size());
+    EXPECT_EQ(352u, single[6].width);
+    EXPECT_EQ(96u, single.back().width);
+    SCOPED_TRACE("4 threads");
+    check_same_pictures(single, decode_stream(packets, 1, 4));
+}
+
+}  // namespace
@@ -17,7 +17,12 @@
  * @author Cidana-Edmond, Cidana-Ryan, Cidana-Wenyao
  *
  ******************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <vector>
 #include "EbSvtAv1Enc.h"
+#include "EbSvtAv1Metadata.h"
 #include "gtest/gtest.h"
 #include "SvtAv1EncApiTest.h"
 
@@ -201,4 +206,975 @@ TEST(EncApiTest, DISABLED_repeat_normal_setup) {
     }
 }
 
+/** @brief memory_budget is a api test case
+ * EncApiTest.memory_budget checks that svt_av1_enc_set_parameter fits the
+ * pools in memory_budget_mb and reports them
+ *
+ * Test strategy: <br>
+ * Read the memory report of a default setup, set a budget below it, a
+ * budget that reduces every pool, overlays included, and a budget no setup
+ * can fit.
+ *
+ * Expected result: <br>
+ * The budgeted estimate stays within the budget, the impossible budget is
+ * rejected with EB_ErrorInsufficientResources and reports the memory the
+ * smallest setup needs.
+ *
+ * Test coverage:
+ * svt_av1_enc_set_parameter, svt_av1_enc_get_stream_info.
+ */
+TEST(EncApiTest, memory_budget) {
+    SvtAv1Context context;
+    memset(&context, 0, sizeof(context));
+
+    ASSERT_EQ(
+        EB_ErrorNone,
+        svt_av1_enc_init_handle(&context.enc_handle, &context, &context.enc_params));
+    context.enc_params.source_width = 1280;
+    context.enc_params.source_height = 720;
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_set_parameter(context.enc_handle, &context.enc_params));
+
+    SvtAv1MemoryReport report;
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_get_stream_info(context.enc_handle,
+                                          SVT_AV1_STREAM_INFO_MEMORY_REPORT,
+                                          &report));
+    EXPECT_EQ(0u, report.memory_budget_mb);
+    EXPECT_GT(report.estimated_mb, 0u);
+    EXPECT_GT(report.reference.count, 0u);
+    EXPECT_GT(report.reference.picture_size, 0u);
+
+    const uint32_t unbounded_mb = report.estimated_mb;
+    context.enc_params.memory_budget_mb = unbounded_mb - 1;
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_set_parameter(context.enc_handle, &context.enc_params));
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_get_stream_info(context.enc_handle,
+                                          SVT_AV1_STREAM_INFO_MEMORY_REPORT,
+                                          &report));
+    EXPECT_EQ(unbounded_mb - 1, report.memory_budget_mb);
+    EXPECT_LE(report.estimated_mb, report.memory_budget_mb);
+
+    context.enc_params.memory_budget_mb = 1;
+    EXPECT_EQ(EB_ErrorInsufficientResources,
+              svt_av1_enc_set_parameter(context.enc_handle, &context.enc_params));
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_get_stream_info(context.enc_handle,
+                                          SVT_AV1_STREAM_INFO_MEMORY_REPORT,
+                                          &report));
+    EXPECT_EQ(1u, report.memory_budget_mb);
+    EXPECT_GT(report.estimated_mb, report.memory_budget_mb);
+    EXPECT_LT(report.estimated_mb, unbounded_mb);
+
+    // the overlay and child control set pools are fitted with the others
+    context.enc_params.enable_overlays = 1;
+    context.enc_params.memory_budget_mb = 0;
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_set_parameter(context.enc_handle, &context.enc_params));
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_get_stream_info(context.enc_handle,
+                                          SVT_AV1_STREAM_INFO_MEMORY_REPORT,
+                                          &report));
+    const SvtAv1MemoryReport overlays = report;
+    context.enc_params.memory_budget_mb = 1;
+    EXPECT_EQ(EB_ErrorInsufficientResources,
+              svt_av1_enc_set_parameter(context.enc_handle, &context.enc_params));
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_get_stream_info(context.enc_handle,
+                                          SVT_AV1_STREAM_INFO_MEMORY_REPORT,
+                                          &report));
+    context.enc_params.memory_budget_mb =
+        (report.estimated_mb + overlays.estimated_mb) / 2;
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_set_parameter(context.enc_handle, &context.enc_params));
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_get_stream_info(context.enc_handle,
+                                          SVT_AV1_STREAM_INFO_MEMORY_REPORT,
+                                          &report));
+    EXPECT_LE(report.estimated_mb, report.memory_budget_mb);
+    EXPECT_GT(report.overlay.count, 0u);
+    EXPECT_LE(report.overlay.count, overlays.overlay.count);
+    EXPECT_GT(report.child_pcs.count, 0u);
+    EXPECT_LE(report.child_pcs.count, overlays.child_pcs.count);
+
+    EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit_handle(context.enc_handle));
+}
+
+/** @brief memory_budget_init is a api test case
+ * EncApiTest.memory_budget_init checks that svt_av1_enc_init measures what
+ * it allocated against memory_budget_mb
+ *
+ * Test strategy: <br>
+ * Set the budget to the estimate of a default setup and initialize the
+ * encoder.
+ *
+ * Expected result: <br>
+ * svt_av1_enc_init succeeds and, with memory tracking, reports an
+ * allocated size within the budget.
+ *
+ * Test coverage:
+ * svt_av1_enc_init, svt_av1_enc_get_stream_info.
+ */
+TEST(EncApiTest, memory_budget_init) {
+    SvtAv1Context context;
+    memset(&context, 0, sizeof(context));
+
+    ASSERT_EQ(
+        EB_ErrorNone,
+        svt_av1_enc_init_handle(&context.enc_handle, &context, &context.enc_params));
+    context.enc_params.source_width = 640;
+    context.enc_params.source_height = 480;
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_set_parameter(context.enc_handle, &context.enc_params));
+    SvtAv1MemoryReport report;
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_get_stream_info(context.enc_handle,
+                                          SVT_AV1_STREAM_INFO_MEMORY_REPORT,
+                                          &report));
+    EXPECT_EQ(0u, report.allocated_mb);
+
+    context.enc_params.memory_budget_mb = report.estimated_mb;
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_set_parameter(context.enc_handle, &context.enc_params));
+    ASSERT_EQ(EB_ErrorNone, svt_av1_enc_init(context.enc_handle));
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_get_stream_info(context.enc_handle,
+                                          SVT_AV1_STREAM_INFO_MEMORY_REPORT,
+                                          &report));
+    SvtAv1MemoryUsage usage;
+    if (svt_av1_enc_get_stream_info(context.enc_handle,
+                                    SVT_AV1_STREAM_INFO_MEMORY_USAGE,
+                                    &usage) == EB_ErrorNone) {
+        EXPECT_GT(report.allocated_mb, 0u);
+    }
+    EXPECT_LE(report.allocated_mb, report.memory_budget_mb);
+
+    EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit(context.enc_handle));
+    EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit_handle(context.enc_handle));
+}
+
+/** @brief Packet of a coded picture, as the tests see it */
+struct CodedPicture {
+    int64_t  pts;
+    uint32_t size;
+    uint32_t qp;
+    uint8_t  pic_type;
+};
+
+/** @brief encode_clip sends frame_count pictures of a moving gradient, so
+ * they reference each other, then the end of sequence, and collects the
+ * pictures coded until the end of sequence packet. The pictures sent by
+ * the application thread and the packets it gets are enough for the tests
+ * on the encoder state; the content only matters for the rate, noise adds
+ * a pseudo random texture of that amplitude to make it costly. The speed
+ * control reports of the packets go to speed_control when given. */
+static std::vector<CodedPicture> encode_clip(
+    EbComponentType *handle, uint32_t width, uint32_t height, uint32_t frame_count,
+    uint32_t noise = 0, std::vector<SvtAv1SpeedControlInfo> *speed_control = nullptr) {
+    const size_t         luma_size = width * height;
+    std::vector<uint8_t> frame(luma_size * 3 / 2, 128);
+    EbSvtIOFormat        planes;
+    memset(&planes, 0, sizeof(planes));
+    planes.luma = frame.data();
+    planes.cb = planes.luma + luma_size;
+    planes.cr = planes.cb + luma_size / 4;
+    planes.y_stride = width;
+    planes.cb_stride = planes.cr_stride = width / 2;
+    EbBufferHeaderType input;
+    memset(&input, 0, sizeof(input));
+    input.size = sizeof(input);
+    input.p_buffer = (uint8_t *)&planes;
+    input.n_filled_len = (uint32_t)frame.size();
+    input.pic_type = EB_AV1_INVALID_PICTURE;
+
+    std::vector<CodedPicture> coded;
+    EbBufferHeaderType *      output = nullptr;
+    bool                      done = false;
+    uint32_t                  seed = 1;
+    for (uint32_t i = 0; i <= frame_count; i++) {
+        if (i < frame_count) {
+            for (uint32_t y = 0; y < height; y++)
+                for (uint32_t x = 0; x < width; x++) {
+                    int value = (int)((x + y + 4 * i) & 255);
+                    if (noise) {
+                        seed = seed * 1103515245 + 12345;
+                        value += (int)((seed >> 16) % (2 * noise + 1)) - (int)noise;
+                    }
+                    frame[y * width + x] = (uint8_t)std::min(std::max(value, 0), 255);
+                }
+            input.pts = i;
+            EXPECT_EQ(EB_ErrorNone, svt_av1_enc_send_picture(handle, &input));
+        } else {
+            EbBufferHeaderType eos;
+            memset(&eos, 0, sizeof(eos));
+            eos.flags = EB_BUFFERFLAG_EOS;
+            EXPECT_EQ(EB_ErrorNone, svt_av1_enc_send_picture(handle, &eos));
+        }
+        // the packets ready so far, then all of them after the end of sequence
+        while (!done &&
+               svt_av1_enc_get_packet(handle, &output, i == frame_count) == EB_ErrorNone) {
+            done = (output->flags & EB_BUFFERFLAG_EOS) != 0;
+            if (output->n_filled_len)
+                coded.push_back(
+                    {output->pts, output->n_filled_len, output->qp, (uint8_t)output->pic_type});
+            for (size_t m = 0; speed_control && output->metadata && m < output->metadata->sz;
+                 m++) {
+                const SvtMetadataT *entry = output->metadata->metadata_array[m];
+                if (entry->type != EB_AV1_METADATA_TYPE_SPEED_CONTROL)
+                    continue;
+                EXPECT_EQ(sizeof(SvtAv1SpeedControlInfo), entry->sz);
+                SvtAv1SpeedControlInfo info;
+                memcpy(&info, entry->payload, sizeof(info));
+                speed_control->push_back(info);
+            }
+            svt_av1_enc_release_out_buffer(&output);
+        }
+    }
+    EXPECT_TRUE(done);
+    return coded;
+}
+
+/** @brief encode_twice is a api test case
+ * EncApiTest.encode_twice checks that encoders run one after the other on
+ * the same application thread do not share state through that thread
+ *
+ * Test strategy: <br>
+ * Set up an encoder, encode a short clip sending the pictures and getting
+ * the packets from the test thread, release it, then do it again.
+ *
+ * Expected result: <br>
+ * Both encoders code every picture and release cleanly.
+ *
+ * Test coverage:
+ * svt_av1_enc_send_picture, svt_av1_enc_get_packet.
+ */
+TEST(EncApiTest, encode_twice) {
+    const uint32_t width = 320, height = 240, frame_count = 8;
+    for (int run = 0; run < 2; run++) {
+        SvtAv1Context context;
+        memset(&context, 0, sizeof(context));
+        ASSERT_EQ(
+            EB_ErrorNone,
+            svt_av1_enc_init_handle(&context.enc_handle, &context, &context.enc_params));
+        context.enc_params.source_width = width;
+        context.enc_params.source_height = height;
+        context.enc_params.enc_mode = MAX_ENC_PRESET;
+        ASSERT_EQ(EB_ErrorNone,
+                  svt_av1_enc_set_parameter(context.enc_handle, &context.enc_params));
+        ASSERT_EQ(EB_ErrorNone, svt_av1_enc_init(context.enc_handle));
+
+        EXPECT_EQ(frame_count,
+                  encode_clip(context.enc_handle, width, height, frame_count).size())
+            << "run " << run;
+
+        EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit(context.enc_handle));
+        EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit_handle(context.enc_handle));
+    }
+}
+
+/** @brief cbr_buffer is a api test case
+ * EncApiTest.cbr_buffer checks that the constant bitrate mode keeps the
+ * VBV buffer of a real encode from underflowing, the first key frame
+ * included
+ *
+ * Test strategy: <br>
+ * Encode a clip in rate control mode 3 with the low delay prediction
+ * structure. Run the leaky bucket on the coded sizes: the buffer starts
+ * two thirds full, gains the target bitrate per picture and loses the
+ * size of each picture.
+ *
+ * Expected result: <br>
+ * The buffer level never goes below 0 and the bitrate is within a buffer
+ * per clip duration of the target.
+ *
+ * Test coverage:
+ * rate_control_mode 3, vbv_bufsize.
+ */
+TEST(EncApiTest, cbr_buffer) {
+    const uint32_t width = 352, height = 288, frame_count = 60;
+    const uint32_t target_bit_rate = 200000;
+    SvtAv1Context  context;
+    memset(&context, 0, sizeof(context));
+
+    ASSERT_EQ(
+        EB_ErrorNone,
+        svt_av1_enc_init_handle(&context.enc_handle, &context, &context.enc_params));
+    context.enc_params.source_width = width;
+    context.enc_params.source_height = height;
+    context.enc_params.enc_mode = MAX_ENC_PRESET;
+    context.enc_params.rate_control_mode = 3;
+    context.enc_params.target_bit_rate = target_bit_rate;
+    context.enc_params.pred_structure = 0;  // low delay
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_set_parameter(context.enc_handle, &context.enc_params));
+    ASSERT_EQ(EB_ErrorNone, svt_av1_enc_init(context.enc_handle));
+
+    const std::vector<CodedPicture> coded =
+        encode_clip(context.enc_handle, width, height, frame_count, 20);
+    ASSERT_EQ(frame_count, coded.size());
+
+    const uint32_t frame_rate = context.enc_params.frame_rate;
+    const double   fps = frame_rate > 1000 ? frame_rate / 65536.0 : frame_rate;
+    // vbv_bufsize 0 is one second of the target bitrate
+    const double buffer_size = target_bit_rate;
+    double       level = buffer_size * 2 / 3, min_level = level, bits = 0;
+    for (const CodedPicture &picture : coded) {
+        level = std::min(level + target_bit_rate / fps - picture.size * 8.0, buffer_size);
+        min_level = std::min(min_level, level);
+        bits += picture.size * 8.0;
+    }
+    EXPECT_GE(min_level, 0) << "first picture " << coded[0].size * 8 << " bits";
+    const double duration = frame_count / fps;
+    EXPECT_NEAR(target_bit_rate, bits / duration, buffer_size / duration);
+
+    EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit(context.enc_handle));
+    EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit_handle(context.enc_handle));
+}
+
+/** @brief speed_control is a api test case
+ * EncApiTest.speed_control checks the presets picked to hold a frame rate
+ * the configured preset cannot reach, and their reports
+ *
+ * Test strategy: <br>
+ * Encode a clip with speed_control_flag and an injector frame rate far
+ * above the speed of the encoder, then without speed_control_flag.
+ *
+ * Expected result: <br>
+ * With speed control each packet carries the report of its picture: the
+ * work scale drops once the first pictures are out and the later pictures
+ * are coded with a faster preset than the configured one, never a slower
+ * one. Without it no packet carries a report.
+ *
+ * Test coverage:
+ * speed_control_flag, injector_frame_rate,
+ * EB_AV1_METADATA_TYPE_SPEED_CONTROL.
+ */
+TEST(EncApiTest, speed_control) {
+    const uint32_t width = 176, height = 144, frame_count = 40;
+    const int8_t   enc_mode = 6;
+    for (uint32_t flag = 0; flag < 2; flag++) {
+        SvtAv1Context context;
+        memset(&context, 0, sizeof(context));
+        ASSERT_EQ(
+            EB_ErrorNone,
+            svt_av1_enc_init_handle(&context.enc_handle, &context, &context.enc_params));
+        context.enc_params.source_width = width;
+        context.enc_params.source_height = height;
+        context.enc_params.enc_mode = enc_mode;
+        context.enc_params.hierarchical_levels = 3;
+        context.enc_params.speed_control_flag = flag;
+        context.enc_params.injector_frame_rate = 5000 << 16;
+        ASSERT_EQ(EB_ErrorNone,
+                  svt_av1_enc_set_parameter(context.enc_handle, &context.enc_params));
+        ASSERT_EQ(EB_ErrorNone, svt_av1_enc_init(context.enc_handle));
+
+        std::vector<SvtAv1SpeedControlInfo> reports;
+        const std::vector<CodedPicture>     coded =
+            encode_clip(context.enc_handle, width, height, frame_count, 0, &reports);
+        EXPECT_EQ(frame_count, coded.size());
+        EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit(context.enc_handle));
+        EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit_handle(context.enc_handle));
+        if (!flag) {
+            EXPECT_TRUE(reports.empty());
+            continue;
+        }
+
+        // A report for each picture
+        ASSERT_GE(reports.size(), (size_t)frame_count);
+        std::vector<bool> reported(frame_count, false);
+        int8_t            last_mode = MAX_ENC_PRESET;
+        for (const SvtAv1SpeedControlInfo &info : reports) {
+            ASSERT_LT(info.picture_number, frame_count);
+            reported[info.picture_number] = true;
+            EXPECT_GE(info.enc_mode, enc_mode);
+            EXPECT_LE(info.enc_mode, MAX_ENC_PRESET);
+            EXPECT_GT(info.measured_cost_us, 0u);
+            EXPECT_LE(info.work_scale_x1000, 1000u);
+            if (info.picture_number == 0) {
+                EXPECT_TRUE(info.is_intra);
+            }
+            if (info.picture_number >= frame_count - 8)
+                last_mode = std::min(last_mode, info.enc_mode);
+        }
+        EXPECT_EQ(std::vector<bool>(frame_count, true), reported);
+        EXPECT_GT(last_mode, enc_mode) << "the last mini-gop keeps the configured preset";
+    }
+}
+
+/** @brief memory_usage is a api test case
+ * EncApiTest.memory_usage checks the live and peak bytes reported per tag
+ *
+ * Test strategy: <br>
+ * Read the usage before svt_av1_enc_init, after it and from a new
+ * instance once the first one is released.
+ *
+ * Expected result: <br>
+ * The pictures, control sets, mode decision and motion estimation
+ * contexts are accounted once the encoder is initialized, the peaks are
+ * not below the live bytes and svt_av1_enc_deinit_handle releases what
+ * svt_av1_enc_init allocated.
+ *
+ * Test coverage:
+ * svt_av1_enc_get_stream_info.
+ */
+TEST(EncApiTest, memory_usage) {
+    SvtAv1Context context;
+    memset(&context, 0, sizeof(context));
+
+    ASSERT_EQ(
+        EB_ErrorNone,
+        svt_av1_enc_init_handle(&context.enc_handle, &context, &context.enc_params));
+    context.enc_params.source_width = 320;
+    context.enc_params.source_height = 240;
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_set_parameter(context.enc_handle, &context.enc_params));
+
+    SvtAv1MemoryUsage before, usage;
+    const EbErrorType usage_error = svt_av1_enc_get_stream_info(
+        context.enc_handle, SVT_AV1_STREAM_INFO_MEMORY_USAGE, &before);
+    if (usage_error == EB_ErrorBadParameter) {
+        // built with ENABLE_MEMORY_TRACKING=OFF
+        EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit_handle(context.enc_handle));
+        return;
+    }
+    ASSERT_EQ(EB_ErrorNone, usage_error);
+    ASSERT_EQ(EB_ErrorNone, svt_av1_enc_init(context.enc_handle));
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_get_stream_info(context.enc_handle,
+                                          SVT_AV1_STREAM_INFO_MEMORY_USAGE,
+                                          &usage));
+    uint64_t sum = 0;
+    for (int tag = 0; tag < SVT_AV1_MEM_TAG_COUNT; tag++) {
+        EXPECT_GE(usage.peak_bytes[tag], usage.live_bytes[tag]);
+        sum += usage.live_bytes[tag];
+    }
+    EXPECT_EQ(sum, usage.live_total);
+    EXPECT_GE(usage.peak_total, usage.live_total);
+    EXPECT_GT(usage.live_total, before.live_total);
+    EXPECT_GT(usage.live_bytes[SVT_AV1_MEM_TAG_PICTURE],
+              before.live_bytes[SVT_AV1_MEM_TAG_PICTURE]);
+    EXPECT_GT(usage.live_bytes[SVT_AV1_MEM_TAG_PCS], 0u);
+    EXPECT_GT(usage.live_bytes[SVT_AV1_MEM_TAG_MD], 0u);
+    EXPECT_GT(usage.live_bytes[SVT_AV1_MEM_TAG_ME], 0u);
+    EXPECT_GT(usage.live_bytes[SVT_AV1_MEM_TAG_NEIGHBOR], 0u);
+
+    EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit(context.enc_handle));
+    EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit_handle(context.enc_handle));
+
+    // the usage is shared by the instances: a new one set up the same way
+    // finds it back to where it was before svt_av1_enc_init
+    memset(&context, 0, sizeof(context));
+    ASSERT_EQ(
+        EB_ErrorNone,
+        svt_av1_enc_init_handle(&context.enc_handle, &context, &context.enc_params));
+    context.enc_params.source_width = 320;
+    context.enc_params.source_height = 240;
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_set_parameter(context.enc_handle, &context.enc_params));
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_get_stream_info(context.enc_handle,
+                                          SVT_AV1_STREAM_INFO_MEMORY_USAGE,
+                                          &usage));
+    EXPECT_EQ(before.live_total, usage.live_total);
+    EXPECT_GE(usage.peak_total, before.live_total + usage.live_bytes[SVT_AV1_MEM_TAG_PICTURE]);
+    EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit_handle(context.enc_handle));
+}
+
+
+/** @brief update_parameters is a api test case
+ * EncApiTest.update_parameters checks that svt_av1_enc_update_parameters
+ * validates and queues the updates, and forces a key frame at the
+ * requested picture
+ *
+ * Test strategy: <br>
+ * Send updates out of range, fill the queue, then encode a short clip with
+ * a key frame forced in the middle and no intra period.
+ *
+ * Expected result: <br>
+ * The updates out of range are rejected with EB_ErrorBadParameter, the one
+ * past SVT_AV1_MAX_PENDING_UPDATES with EB_ErrorInsufficientResources.
+ * The first picture and the forced one are the only key frames.
+ *
+ * Test coverage:
+ * svt_av1_enc_update_parameters.
+ */
+TEST(EncApiTest, update_parameters) {
+    const uint32_t width = 320, height = 240, frame_count = 24;
+    const uint64_t key_picture = 10;
+    SvtAv1Context  context;
+    memset(&context, 0, sizeof(context));
+
+    ASSERT_EQ(
+        EB_ErrorNone,
+        svt_av1_enc_init_handle(&context.enc_handle, &context, &context.enc_params));
+    context.enc_params.source_width = width;
+    context.enc_params.source_height = height;
+    context.enc_params.enc_mode = MAX_ENC_PRESET - 1;
+    context.enc_params.intra_period_length = -1;
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_set_parameter(context.enc_handle, &context.enc_params));
+    ASSERT_EQ(EB_ErrorNone, svt_av1_enc_init(context.enc_handle));
+
+    SvtAv1EncUpdate update;
+    memset(&update, 0, sizeof(update));
+    EXPECT_EQ(EB_ErrorBadParameter,
+              svt_av1_enc_update_parameters(context.enc_handle, nullptr));
+    EXPECT_EQ(EB_ErrorBadParameter,
+              svt_av1_enc_update_parameters(context.enc_handle, &update));
+    update.flags = SVT_AV1_UPDATE_TARGET_BIT_RATE;
+    EXPECT_EQ(EB_ErrorBadParameter,
+              svt_av1_enc_update_parameters(context.enc_handle, &update));
+    update.flags = SVT_AV1_UPDATE_QP_RANGE;
+    update.min_qp_allowed = 40;
+    update.max_qp_allowed = 30;
+    EXPECT_EQ(EB_ErrorBadParameter,
+              svt_av1_enc_update_parameters(context.enc_handle, &update));
+    // slower than the preset set at init
+    update.flags = SVT_AV1_UPDATE_ENC_MODE;
+    update.enc_mode = MAX_ENC_PRESET - 2;
+    EXPECT_EQ(EB_ErrorBadParameter,
+              svt_av1_enc_update_parameters(context.enc_handle, &update));
+
+    update.flags = SVT_AV1_UPDATE_KEY_FRAME;
+    update.picture_number = key_picture;
+    EXPECT_EQ(EB_ErrorNone,
+              svt_av1_enc_update_parameters(context.enc_handle, &update));
+    // updates for the same picture merge into one entry
+    update.flags = SVT_AV1_UPDATE_ENC_MODE;
+    update.enc_mode = MAX_ENC_PRESET;
+    EXPECT_EQ(EB_ErrorNone,
+              svt_av1_enc_update_parameters(context.enc_handle, &update));
+    update.flags = SVT_AV1_UPDATE_TARGET_BIT_RATE;
+    update.target_bit_rate = 1000000;
+    for (uint32_t i = 1; i < SVT_AV1_MAX_PENDING_UPDATES; i++) {
+        update.picture_number = frame_count + i;
+        EXPECT_EQ(EB_ErrorNone,
+                  svt_av1_enc_update_parameters(context.enc_handle, &update));
+    }
+    update.picture_number = frame_count + SVT_AV1_MAX_PENDING_UPDATES;
+    EXPECT_EQ(EB_ErrorInsufficientResources,
+              svt_av1_enc_update_parameters(context.enc_handle, &update));
+
+    const size_t         luma_size = width * height;
+    std::vector<uint8_t> frame(luma_size * 3 / 2, 128);
+    EbSvtIOFormat        planes;
+    memset(&planes, 0, sizeof(planes));
+    planes.luma = frame.data();
+    planes.cb = planes.luma + luma_size;
+    planes.cr = planes.cb + luma_size / 4;
+    planes.y_stride = width;
+    planes.cb_stride = planes.cr_stride = width / 2;
+    EbBufferHeaderType input;
+    memset(&input, 0, sizeof(input));
+    input.size = sizeof(input);
+    input.p_buffer = (uint8_t *)&planes;
+    input.n_filled_len = (uint32_t)frame.size();
+    input.pic_type = EB_AV1_INVALID_PICTURE;
+    for (uint32_t i = 0; i < frame_count; i++) {
+        input.pts = i;
+        ASSERT_EQ(EB_ErrorNone, svt_av1_enc_send_picture(context.enc_handle, &input));
+    }
+    EbBufferHeaderType eos;
+    memset(&eos, 0, sizeof(eos));
+    eos.flags = EB_BUFFERFLAG_EOS;
+    ASSERT_EQ(EB_ErrorNone, svt_av1_enc_send_picture(context.enc_handle, &eos));
+
+    std::vector<int64_t> key_frames;
+    EbBufferHeaderType * output = nullptr;
+    bool                 done = false;
+    while (!done &&
+           svt_av1_enc_get_packet(context.enc_handle, &output, 1) == EB_ErrorNone) {
+        done = (output->flags & EB_BUFFERFLAG_EOS) != 0;
+        if (output->pic_type == EB_AV1_KEY_PICTURE)
+            key_frames.push_back(output->pts);
+        svt_av1_enc_release_out_buffer(&output);
+    }
+    EXPECT_TRUE(done);
+    ASSERT_EQ(2u, key_frames.size());
+    EXPECT_EQ(0, key_frames[0]);
+    EXPECT_EQ((int64_t)key_picture, key_frames[1]);
+
+    EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit(context.enc_handle));
+    EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit_handle(context.enc_handle));
+}
+
+
+/** @brief encode_updated sets up an encoder with the parameters of
+ * base_params, queues update unless it is null, encodes the clip of
+ * encode_clip and returns its pictures in display order */
+static std::vector<CodedPicture> encode_updated(const EbSvtAv1EncConfiguration &base_params,
+                                                const SvtAv1EncUpdate *update,
+                                                uint32_t frame_count, uint32_t noise) {
+    SvtAv1Context context;
+    memset(&context, 0, sizeof(context));
+    std::vector<CodedPicture> coded;
+    EXPECT_EQ(
+        EB_ErrorNone,
+        svt_av1_enc_init_handle(&context.enc_handle, &context, &context.enc_params));
+    if (!context.enc_handle)
+        return coded;
+    context.enc_params = base_params;
+    if (svt_av1_enc_set_parameter(context.enc_handle, &context.enc_params) == EB_ErrorNone &&
+        svt_av1_enc_init(context.enc_handle) == EB_ErrorNone) {
+        if (update) {
+            EXPECT_EQ(EB_ErrorNone,
+                      svt_av1_enc_update_parameters(context.enc_handle, update));
+        }
+        coded = encode_clip(context.enc_handle,
+                            base_params.source_width,
+                            base_params.source_height,
+                            frame_count,
+                            noise);
+        EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit(context.enc_handle));
+    } else
+        ADD_FAILURE() << "encoder setup failed";
+    EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit_handle(context.enc_handle));
+    std::sort(coded.begin(), coded.end(), [](const CodedPicture &a, const CodedPicture &b) {
+        return a.pts < b.pts;
+    });
+    return coded;
+}
+
+/** @brief update_parameters_effect is a api test case
+ * EncApiTest.update_parameters_effect checks that the QP range, preset and
+ * target bitrate updates take effect from the requested picture on, and
+ * only from it
+ *
+ * Test strategy: <br>
+ * Encode a clip with mini-gops of 8 pictures without updates, then with a
+ * QP range update, a preset update and a bitrate update at the first
+ * picture of the third mini-gop. The pictures of the mini-gop before it
+ * are coded after picture decision took the update.
+ *
+ * Expected result: <br>
+ * The pictures before the update are coded as without it. From it on, the
+ * QP is the one of the range, the preset changes the pictures and the
+ * higher bitrate makes them larger.
+ *
+ * Test coverage:
+ * svt_av1_enc_update_parameters.
+ */
+TEST(EncApiTest, update_parameters_effect) {
+    const uint32_t frame_count = 40;
+    const uint64_t update_picture = 17;
+    SvtAv1Context  context;
+    memset(&context, 0, sizeof(context));
+    ASSERT_EQ(
+        EB_ErrorNone,
+        svt_av1_enc_init_handle(&context.enc_handle, &context, &context.enc_params));
+    EbSvtAv1EncConfiguration params = context.enc_params;
+    EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit_handle(context.enc_handle));
+    params.source_width = 320;
+    params.source_height = 240;
+    params.enc_mode = MAX_ENC_PRESET - 1;
+    params.intra_period_length = -1;
+    params.hierarchical_levels = 3;
+
+    SvtAv1EncUpdate update;
+    memset(&update, 0, sizeof(update));
+    update.picture_number = update_picture;
+
+    // constant QP: the pictures before the update are the same. The lookahead
+    // of the temporal dependency model covers the pictures after the mini-gop,
+    // the ones updated included, so it is off to compare the bitstreams.
+    const uint8_t enable_tpl_la = params.enable_tpl_la;
+    {
+        params.enable_tpl_la = 0;
+        const std::vector<CodedPicture> reference =
+            encode_updated(params, nullptr, frame_count, 0);
+        update.flags = SVT_AV1_UPDATE_QP_RANGE;
+        update.min_qp_allowed = update.max_qp_allowed = 50;
+        const std::vector<CodedPicture> coded = encode_updated(params, &update, frame_count, 0);
+        ASSERT_EQ(frame_count, reference.size());
+        ASSERT_EQ(frame_count, coded.size());
+        for (uint32_t i = 0; i < frame_count; i++) {
+            if (i < update_picture) {
+                EXPECT_EQ(reference[i].qp, coded[i].qp) << "picture " << i;
+                EXPECT_EQ(reference[i].size, coded[i].size) << "picture " << i;
+            } else
+                EXPECT_EQ(50u, coded[i].qp) << "picture " << i;
+        }
+
+        update.flags = SVT_AV1_UPDATE_ENC_MODE;
+        update.enc_mode = MAX_ENC_PRESET;
+        const std::vector<CodedPicture> faster = encode_updated(params, &update, frame_count, 0);
+        ASSERT_EQ(frame_count, faster.size());
+        uint32_t changed = 0;
+        for (uint32_t i = 0; i < frame_count; i++) {
+            if (i < update_picture)
+                EXPECT_EQ(reference[i].size, faster[i].size) << "picture " << i;
+            else
+                changed += reference[i].size != faster[i].size;
+        }
+        EXPECT_GT(changed, 0u);
+    }
+
+    // constant bitrate: the rate rises with the target from the update on
+    {
+        const uint32_t width = 352, height = 288, noise = 20;
+        params.source_width = width;
+        params.source_height = height;
+        params.enable_tpl_la = enable_tpl_la;
+        params.rate_control_mode = 3;
+        params.target_bit_rate = 100000;
+        const std::vector<CodedPicture> reference =
+            encode_updated(params, nullptr, frame_count, noise);
+        update.flags = SVT_AV1_UPDATE_TARGET_BIT_RATE;
+        update.target_bit_rate = 4 * params.target_bit_rate;
+        const std::vector<CodedPicture> coded =
+            encode_updated(params, &update, frame_count, noise);
+        ASSERT_EQ(frame_count, reference.size());
+        ASSERT_EQ(frame_count, coded.size());
+        double reference_before = 0, before = 0, reference_after = 0, after = 0;
+        for (uint32_t i = 0; i < frame_count; i++) {
+            if (i < update_picture) {
+                reference_before += reference[i].size;
+                before += coded[i].size;
+            } else {
+                reference_after += reference[i].size;
+                after += coded[i].size;
+            }
+        }
+        // the buffer model follows the packets, so the rate is not exact
+        EXPECT_NEAR(reference_before, before, reference_before / 4);
+        EXPECT_GT(after, 2 * reference_after) << "reference " << reference_after;
+    }
+}
+
+/** @brief reset is a api test case
+ * EncApiTest.reset checks that svt_av1_enc_reset starts a new stream on
+ * an encoder that delivered the end of sequence, faster than a new encoder
+ *
+ * Test strategy: <br>
+ * Encode a short clip, reset the encoder and encode the clip again, twice.
+ * Time svt_av1_enc_init and svt_av1_enc_reset.
+ *
+ * Expected result: <br>
+ * svt_av1_enc_reset is rejected with EB_ErrorBadParameter before the end
+ * of sequence packet. The streams after the reset are the same as the
+ * first one, and the reset takes less time than svt_av1_enc_init.
+ *
+ * Test coverage:
+ * svt_av1_enc_reset.
+ */
+TEST(EncApiTest, reset) {
+    const uint32_t width = 640, height = 480, frame_count = 8;
+    SvtAv1Context  context;
+    memset(&context, 0, sizeof(context));
+
+    ASSERT_EQ(
+        EB_ErrorNone,
+        svt_av1_enc_init_handle(&context.enc_handle, &context, &context.enc_params));
+    context.enc_params.source_width = width;
+    context.enc_params.source_height = height;
+    context.enc_params.enc_mode = MAX_ENC_PRESET;
+    ASSERT_EQ(EB_ErrorNone,
+              svt_av1_enc_set_parameter(context.enc_handle, &context.enc_params));
+    const auto init_start = std::chrono::steady_clock::now();
+    ASSERT_EQ(EB_ErrorNone, svt_av1_enc_init(context.enc_handle));
+    const auto init_time = std::chrono::steady_clock::now() - init_start;
+    EXPECT_EQ(EB_ErrorBadParameter, svt_av1_enc_reset(nullptr));
+    EXPECT_EQ(EB_ErrorBadParameter, svt_av1_enc_reset(context.enc_handle));
+
+    const size_t         luma_size = width * height;
+    std::vector<uint8_t> frame(luma_size * 3 / 2, 128);
+    EbSvtIOFormat        planes;
+    memset(&planes, 0, sizeof(planes));
+    planes.luma = frame.data();
+    planes.cb = planes.luma + luma_size;
+    planes.cr = planes.cb + luma_size / 4;
+    planes.y_stride = width;
+    planes.cb_stride = planes.cr_stride = width / 2;
+    EbBufferHeaderType input;
+    memset(&input, 0, sizeof(input));
+    input.size = sizeof(input);
+    input.p_buffer = (uint8_t *)&planes;
+    input.n_filled_len = (uint32_t)frame.size();
+    input.pic_type = EB_AV1_INVALID_PICTURE;
+
+    // a moving gradient, so the pictures reference each other
+    auto encode_stream = [&]() {
+        std::vector<uint8_t> stream;
+        for (uint32_t i = 0; i < frame_count; i++) {
+            for (uint32_t y = 0; y < height; y++)
+                for (uint32_t x = 0; x < width; x++)
+                    frame[y * width + x] = (uint8_t)(x + y + 4 * i);
+            input.pts = i;
+            EXPECT_EQ(EB_ErrorNone, svt_av1_enc_send_picture(context.enc_handle, &input));
+        }
+        EbBufferHeaderType eos;
+        memset(&eos, 0, sizeof(eos));
+        eos.flags = EB_BUFFERFLAG_EOS;
+        EXPECT_EQ(EB_ErrorNone, svt_av1_enc_send_picture(context.enc_handle, &eos));
+
+        EbBufferHeaderType *output = nullptr;
+        bool                done = false;
+        while (!done &&
+               svt_av1_enc_get_packet(context.enc_handle, &output, 1) == EB_ErrorNone) {
+            done = (output->flags & EB_BUFFERFLAG_EOS) != 0;
+            stream.insert(stream.end(), output->p_buffer, output->p_buffer + output->n_filled_len);
+            svt_av1_enc_release_out_buffer(&output);
+        }
+        EXPECT_TRUE(done);
+        return stream;
+    };
+
+    const std::vector<uint8_t> first = encode_stream();
+    EXPECT_FALSE(first.empty());
+    for (int i = 0; i < 2; i++) {
+        const auto reset_start = std::chrono::steady_clock::now();
+        ASSERT_EQ(EB_ErrorNone, svt_av1_enc_reset(context.enc_handle));
+        const auto reset_time = std::chrono::steady_clock::now() - reset_start;
+        EXPECT_LT(reset_time, init_time) << "reset " << i;
+        EXPECT_TRUE(encode_stream() == first) << "stream after reset " << i;
+    }
+
+    EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit(context.enc_handle));
+    EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit_handle(context.enc_handle));
+}
+
+/** @brief Input pictures referenced by the encoder, see zero_copy_input */
+struct ReferencedInput {
+    std::mutex                        mutex;
+    std::vector<std::vector<uint8_t>> pictures;
+    std::vector<uint32_t>             release_count;
+};
+
+/* Counts the releases and scribbles over the planes: the stream only stays
+ * the same if the encoder no longer reads them */
+static void release_input(void *release_ctx, void *p_app_private, int64_t pts) {
+    ReferencedInput *           input = (ReferencedInput *)release_ctx;
+    std::lock_guard<std::mutex> lock(input->mutex);
+    const size_t                index = (size_t)(uintptr_t)p_app_private;
+    EXPECT_EQ(pts, (int64_t)index);
+    if (index >= input->pictures.size())
+        return;
+    input->release_count[index]++;
+    std::vector<uint8_t> &picture = input->pictures[index];
+    for (size_t i = 0; i < picture.size(); i++)
+        picture[i] = (uint8_t)(i * 97 + 31);
+}
+
+/** @brief zero_copy_input is a api test case
+ * EncApiTest.zero_copy_input checks that the encoder hands every
+ * referenced input picture back once, after it is done with its planes
+ *
+ * Test strategy: <br>
+ * Encode a clip with the pictures copied, then the same clip with the
+ * planes laid out as reported by SVT_AV1_STREAM_INFO_INPUT_LAYOUT and
+ * referenced. The release callback overwrites the planes of the picture.
+ *
+ * Expected result: <br>
+ * The callback is called exactly once per picture, with its
+ * p_app_private and pts, and the stream is the one of the copied input.
+ *
+ * Test coverage:
+ * zero_copy_input, input_release_cb.
+ */
+TEST(EncApiTest, zero_copy_input) {
+    const uint32_t width = 320, height = 240, frame_count = 16;
+    auto pixel = [](uint32_t x, uint32_t y, uint32_t i) {
+        return (uint8_t)((x + 2 * y + 5 * i + ((x * y + i) % 7) * 9) & 255);
+    };
+
+    ReferencedInput referenced;
+    std::vector<uint8_t> streams[2];
+    for (int zero_copy = 0; zero_copy < 2; zero_copy++) {
+        SvtAv1Context context;
+        memset(&context, 0, sizeof(context));
+        ASSERT_EQ(
+            EB_ErrorNone,
+            svt_av1_enc_init_handle(&context.enc_handle, &context, &context.enc_params));
+        context.enc_params.source_width = width;
+        context.enc_params.source_height = height;
+        context.enc_params.enc_mode = MAX_ENC_PRESET;
+        context.enc_params.zero_copy_input = zero_copy;
+        context.enc_params.input_release_cb = zero_copy ? release_input : nullptr;
+        context.enc_params.input_release_ctx = &referenced;
+        ASSERT_EQ(EB_ErrorNone,
+                  svt_av1_enc_set_parameter(context.enc_handle, &context.enc_params));
+        ASSERT_EQ(EB_ErrorNone, svt_av1_enc_init(context.enc_handle));
+
+        SvtAv1InputLayout layout;
+        memset(&layout, 0, sizeof(layout));
+        ASSERT_EQ(EB_ErrorNone,
+                  svt_av1_enc_get_stream_info(
+                      context.enc_handle, SVT_AV1_STREAM_INFO_INPUT_LAYOUT, &layout));
+        if (zero_copy) {
+            referenced.pictures.assign(frame_count,
+                                       std::vector<uint8_t>(layout.luma_size +
+                                                            2 * layout.chroma_size));
+            referenced.release_count.assign(frame_count, 0);
+        }
+        std::vector<uint8_t> frame(width * height * 3 / 2);
+
+        EbBufferHeaderType *output = nullptr;
+        bool                done = false;
+        for (uint32_t i = 0; i <= frame_count; i++) {
+            if (i < frame_count) {
+                EbSvtIOFormat planes;
+                memset(&planes, 0, sizeof(planes));
+                if (zero_copy) {
+                    uint8_t *luma = referenced.pictures[i].data();
+                    uint8_t *cb = luma + layout.luma_size;
+                    uint8_t *cr = cb + layout.chroma_size;
+                    planes.luma = luma + layout.top_padding * layout.y_stride + layout.left_padding;
+                    planes.cb = cb + layout.top_padding / 2 * layout.cb_stride + layout.left_padding / 2;
+                    planes.cr = cr + layout.top_padding / 2 * layout.cr_stride + layout.left_padding / 2;
+                    planes.y_stride = layout.y_stride;
+                    planes.cb_stride = layout.cb_stride;
+                    planes.cr_stride = layout.cr_stride;
+                } else {
+                    planes.luma = frame.data();
+                    planes.cb = planes.luma + width * height;
+                    planes.cr = planes.cb + width * height / 4;
+                    planes.y_stride = width;
+                    planes.cb_stride = planes.cr_stride = width / 2;
+                }
+                for (uint32_t y = 0; y < height; y++)
+                    for (uint32_t x = 0; x < width; x++)
+                        planes.luma[y * planes.y_stride + x] = pixel(x, y, i);
+                for (uint32_t y = 0; y < height / 2; y++)
+                    for (uint32_t x = 0; x < width / 2; x++) {
+                        planes.cb[y * planes.cb_stride + x] = pixel(y, x, i);
+                        planes.cr[y * planes.cr_stride + x] = pixel(x, x, i);
+                    }
+
+                EbBufferHeaderType input;
+                memset(&input, 0, sizeof(input));
+                input.size = sizeof(input);
+                input.p_buffer = (uint8_t *)&planes;
+                input.n_filled_len = (uint32_t)frame.size();
+                input.pic_type = EB_AV1_INVALID_PICTURE;
+                input.pts = i;
+                input.p_app_private = (void *)(uintptr_t)i;
+                EXPECT_EQ(EB_ErrorNone, svt_av1_enc_send_picture(context.enc_handle, &input));
+            } else {
+                EbBufferHeaderType eos;
+                memset(&eos, 0, sizeof(eos));
+                eos.flags = EB_BUFFERFLAG_EOS;
+                EXPECT_EQ(EB_ErrorNone, svt_av1_enc_send_picture(context.enc_handle, &eos));
+            }
+            while (!done && svt_av1_enc_get_packet(
+                                context.enc_handle, &output, i == frame_count) == EB_ErrorNone) {
+                done = (output->flags & EB_BUFFERFLAG_EOS) != 0;
+                streams[zero_copy].insert(streams[zero_copy].end(),
+                                          output->p_buffer,
+                                          output->p_buffer + output->n_filled_len);
+                svt_av1_enc_release_out_buffer(&output);
+            }
+        }
+        EXPECT_TRUE(done);
+
+        EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit(context.enc_handle));
+        EXPECT_EQ(EB_ErrorNone, svt_av1_enc_deinit_handle(context.enc_handle));
+    }
+
+    for (uint32_t i = 0; i < frame_count; i++)
+        EXPECT_EQ(1u, referenced.release_count[i]) << "picture " << i;
+    EXPECT_FALSE(streams[0].empty());
+    EXPECT_TRUE(streams[0] == streams[1]);
+}
+
 }  // namespace
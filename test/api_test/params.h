@@ -637,11 +637,13 @@ static const vector<EbBool> invalid_constrained_intra = {
  *
  * 0 = Constant QP.
  * 1 = Average BitRate.
+ * 2 = Constrained Variable BitRate.
+ * 3 = Constant BitRate.
  *
  * Default is 0. */
 static const vector<uint32_t> default_rate_control_mode = {0};
-static const vector<uint32_t> valid_rate_control_mode = {0, 1, 2};
-static const vector<uint32_t> invalid_rate_control_mode = {3, 4};
+static const vector<uint32_t> valid_rate_control_mode = {0, 1, 2, 3};
+static const vector<uint32_t> invalid_rate_control_mode = {4};
 
 /* Flag to enable the scene change detection algorithm.
  *
@@ -599,6 +599,9 @@ void SvtAv1E2ETestFramework::write_compress_data(
 void SvtAv1E2ETestFramework::process_compress_data(
     const EbBufferHeaderType *data) {
     ASSERT_NE(data, nullptr);
+    // a low delay stream can end on an empty packet that only carries the EOS
+    if (data->n_filled_len == 0 && (data->flags & EB_BUFFERFLAG_EOS))
+        return;
     if (refer_dec_ == nullptr) {
         if (output_file_)
             write_compress_data(data);
@@ -714,6 +717,14 @@ void SvtAv1E2ETestFramework::get_recon_frame(const SvtAv1Context &ctxt,
             // mark the recon eos flag
             if (recon_frame.flags & EB_BUFFERFLAG_EOS)
                 is_eos = true;
+            // a low delay stream can end on an empty recon that only carries
+            // the EOS, any other recon holds a picture
+            if (recon_frame.n_filled_len == 0) {
+                recon->delete_frame(new_frame);
+                ASSERT_TRUE(is_eos)
+                    << "empty recon frame without EOS@" << recon_frame.pts;
+                break;
+            }
             transfer_frame_planes(new_frame);
             new_frame->timestamp = recon_frame.pts;
             recon->add_frame(new_frame);
@@ -18,6 +18,8 @@
  *
  ******************************************************************************/
 
+#include <chrono>
+#include <thread>
 #include "EbSvtAv1Enc.h"
 #include "gtest/gtest.h"
 #include "SvtAv1E2EFramework.h"
@@ -271,3 +273,118 @@ static const std::vector<EncTestSetting> tile_settings = {
 INSTANTIATE_TEST_CASE_P(TILETEST, TileIndependenceTest,
                         ::testing::ValuesIn(tile_settings),
                         EncTestSetting::GetSettingName);
+
+/**
+ * @brief SVT-AV1 encoder E2E test of the low delay prediction structure
+ *
+ * Test strategy:
+ * Setup SVT-AV1 encoder with low delay prediction structure and constant qp,
+ * send the input YUV data frame by frame and wait for the packet of each
+ * frame before sending the next one.
+ *
+ * Expected result:
+ * Every packet comes out before the next frame is sent, the end of stream
+ * is reported once EOS is sent.
+ *
+ * Test coverage:
+ * Low delay P and low delay B with dummy source
+ */
+class LowDelayLatencyTest : public SvtAv1E2ETestFramework {
+  protected:
+    void config_test() override {
+        enable_config = true;
+        SvtAv1E2ETestFramework::config_test();
+    }
+
+    /** wait for one packet, return nullptr if none comes in time */
+    EbBufferHeaderType *wait_packet(uint8_t pic_send_done) {
+        for (int i = 0; i < max_wait_ms; ++i) {
+            EbBufferHeaderType *enc_out = nullptr;
+            EbErrorType ret = svt_av1_enc_get_packet(
+                av1enc_ctx_.enc_handle, &enc_out, pic_send_done);
+            if (ret == EB_ErrorNone && enc_out)
+                return enc_out;
+            EXPECT_EQ(ret, EB_NoErrorEmptyQueue)
+                << "encoder return: " << ret;
+            if (ret != EB_NoErrorEmptyQueue)
+                return nullptr;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return nullptr;
+    }
+
+    void run_latency_test() {
+        uint32_t frame_count = video_src_->get_frame_count();
+        ASSERT_GT(frame_count, 0u) << "video source does not contain frame!";
+        uint32_t sent = 0;
+        uint8_t *frame = nullptr;
+        while (sent < frame_count &&
+               (frame = (uint8_t *)video_src_->get_next_frame()) != nullptr) {
+            EbBufferHeaderType *in = av1enc_ctx_.input_picture_buffer;
+            in->p_buffer = frame;
+            in->n_filled_len = video_src_->get_frame_size();
+            in->flags = 0;
+            in->p_app_private = nullptr;
+            in->pts = sent;
+            in->pic_type = EB_AV1_INVALID_PICTURE;
+            in->metadata = nullptr;
+            ASSERT_EQ(EB_ErrorNone,
+                      svt_av1_enc_send_picture(av1enc_ctx_.enc_handle, in))
+                << "svt_av1_enc_send_picture error at: " << sent;
+            sent++;
+
+            // the packet of this frame must come before the next frame
+            EbBufferHeaderType *enc_out = wait_packet(0);
+            ASSERT_NE(enc_out, nullptr) << "no packet for frame " << sent - 1;
+            EXPECT_EQ(enc_out->pts, (int64_t)sent - 1);
+            EXPECT_FALSE(enc_out->flags & EB_BUFFERFLAG_EOS);
+            svt_av1_enc_release_out_buffer(&enc_out);
+        }
+
+        EbBufferHeaderType eos;
+        memset(&eos, 0, sizeof(eos));
+        eos.flags = EB_BUFFERFLAG_EOS;
+        eos.pic_type = EB_AV1_INVALID_PICTURE;
+        ASSERT_EQ(EB_ErrorNone,
+                  svt_av1_enc_send_picture(av1enc_ctx_.enc_handle, &eos))
+            << "svt_av1_enc_send_picture EOS error";
+
+        // all the frames are out, only the (possibly empty) EOS is left
+        EbBufferHeaderType *enc_out = wait_packet(1);
+        ASSERT_NE(enc_out, nullptr) << "no EOS packet";
+        EXPECT_TRUE(enc_out->flags & EB_BUFFERFLAG_EOS);
+        EXPECT_EQ(enc_out->n_filled_len, 0u);
+        svt_av1_enc_release_out_buffer(&enc_out);
+    }
+
+    static const int max_wait_ms = 10000;
+};
+
+TEST_P(LowDelayLatencyTest, PacketPerFrameTest) {
+    config_test();
+    for (auto test_vector : enc_setting.test_vectors) {
+        init_test(test_vector);
+        run_latency_test();
+        deinit_test();
+    }
+}
+
+/* clang-format off */
+static const std::vector<TestVideoVector> low_delay_test_vectors = {
+    std::make_tuple("colorbar_480p_8_420", DUMMY_SOURCE, IMG_FMT_420, 640, 480,
+                    8, 0, 0, 30),
+};
+
+static const std::vector<EncTestSetting> low_delay_settings = {
+    {"LowDelayPTest",
+     {{"PredStructure", "0"}, {"RateControlMode", "0"}, {"EncoderMode", "8"}},
+     low_delay_test_vectors},
+    {"LowDelayBTest",
+     {{"PredStructure", "1"}, {"RateControlMode", "0"}, {"EncoderMode", "8"}},
+     low_delay_test_vectors},
+};
+/* clang-format on */
+
+INSTANTIATE_TEST_CASE_P(SvtAv1, LowDelayLatencyTest,
+                        ::testing::ValuesIn(low_delay_settings),
+                        EncTestSetting::GetSettingName);